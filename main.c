@@ -60,6 +60,35 @@
 /* WHD header file. */
 #include "whd_wlioctl.h"
 
+/* Application header files. */
+#include "band_select.h"
+#include "bench.h"
+#include "coap_client.h"
+#include "code_placement.h"
+#include "cpu_monitor.h"
+#include "func_prof.h"
+#include "link_monitor.h"
+#include "lock_prof.h"
+#include "metrics.h"
+#include "mqtt_client.h"
+#include "pcap_capture.h"
+#include "ps_bench.h"
+#include "ps_policy.h"
+#include "remote_console.h"
+#include "roam.h"
+#include "sae.h"
+#include "tcp_tune.h"
+#include "tgen.h"
+#include "traffic_trace.h"
+#include "tls_session.h"
+#include "trace.h"
+#include "twt_log.h"
+#include "twt_session.h"
+#include "udp_zc.h"
+#include "warm_boot.h"
+#include "whd_prof.h"
+#include "wl_counters.h"
+
 /* Standard C header files. */
 #include <inttypes.h>
 
@@ -94,6 +123,13 @@ static uint64_t nxs_stack[(THREAD_STACK)/sizeof(uint64_t)];
 static cy_wcm_config_t wcm_config;
 static cy_wcm_connect_params_t conn_params;
 
+/* Serializes the joins and iTWT changes, requested from the console, the
+ * PsPolicy and the Roam threads; guards conn_params and conn_profile */
+static cy_mutex_t conn_mutex;
+
+/* iTWT profile requested in the current association */
+static cy_wcm_itwt_profile_t conn_profile = CY_WCM_ITWT_PROFILE_NONE;
+
 static cy_timer_t wdt_timer_t;
 
 const char* console_delimiter_string = " ";
@@ -102,14 +138,25 @@ static char command_history_buffer[CONSOLE_COMMAND_MAX_LENGTH * CONSOLE_COMMAND_
 
 extern whd_interface_t whd_ifs[2];
 
+/* Application metrics (See metrics.c) */
+static const uint32_t connect_ms_bounds[] = { 500u, 1000u, 2000u, 4000u, 8000u, 16000u };
+static metrics_entry_t *metric_connects;
+static metrics_entry_t *metric_connect_failures;
+static metrics_entry_t *metric_connect_ms;
+static metrics_entry_t *metric_itwt_setups;
+static metrics_entry_t *metric_itwt_teardowns;
+
 
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
 cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile);
+cy_rslt_t ReassociateWifi(const uint8_t *bssid, cy_wcm_wifi_band_t band, cy_wcm_itwt_profile_t profile);
+void get_ip_string(char* buffer, uint32_t ip);
 
 int itwt_setup(int argc, char* argv[], tlv_buffer_t** data);
 int itwt_teardown(int argc, char* argv[], tlv_buffer_t** data);
+cy_rslt_t itwt_select(cy_wcm_itwt_profile_t profile);
 
 #if defined(H1CP_CLOCK_FREQ)
 #if (CYHAL_API_VERSION >= 2)
@@ -131,6 +178,36 @@ const cy_command_console_cmd_t itwt_commands_table[] =
     CMD_TABLE_END
 };
 
+/* Registration functions of the application commands tables */
+static cy_rslt_t (* const app_add_commands[])(void) =
+{
+    warm_boot_add_commands,
+    bench_add_commands,
+    cpu_monitor_add_commands,
+    func_prof_add_commands,
+    trace_add_commands,
+    lock_prof_add_commands,
+    tls_session_add_commands,
+    sae_add_commands,
+    mqtt_client_add_commands,
+    tcp_tune_add_commands,
+    coap_client_add_commands,
+    metrics_add_commands,
+    pcap_capture_add_commands,
+    twt_log_add_commands,
+    tgen_add_commands,
+    traffic_trace_add_commands,
+    ps_bench_add_commands,
+    ps_policy_add_commands,
+    link_monitor_add_commands,
+    wl_counters_add_commands,
+    whd_prof_add_commands,
+    roam_add_commands,
+    band_select_add_commands,
+    udp_zc_add_commands,
+    remote_console_add_commands,
+};
+
 
 /*******************************************************************************
 * Function Name: get_ip_string
@@ -147,7 +224,7 @@ const cy_command_console_cmd_t itwt_commands_table[] =
 *  void
 *
 *******************************************************************************/
-static void get_ip_string(char* buffer, uint32_t ip)
+void get_ip_string(char* buffer, uint32_t ip)
 {
     sprintf(buffer, "%lu.%lu.%lu.%lu",
             (unsigned long)(ip      ) & 0xFF,
@@ -176,6 +253,7 @@ static void get_ip_string(char* buffer, uint32_t ip)
 int itwt_setup(int argc, char* argv[], tlv_buffer_t** data)
 {
     cy_rslt_t result;
+    uint16_t cmd = trace_string("itwt_setup");
 
     if(argc < 1)
     {
@@ -183,11 +261,17 @@ int itwt_setup(int argc, char* argv[], tlv_buffer_t** data)
         return -1;
     }
 
+    trace_record(TRACE_EVT_CMD_START, cmd, 0);
+
+    lock_prof_get(&conn_mutex, CY_RTOS_NEVER_TIMEOUT);
+
     if(cy_wcm_is_connected_to_ap())
     {
         printf("Already connected. Disconnecting from AP!!\n");
         if((result = cy_wcm_disconnect_ap()) != CY_RSLT_SUCCESS){
             printf("Failed to disconnect from AP! Error code: 0x%08" PRIx32 "\n", result);
+            lock_prof_set(&conn_mutex);
+            trace_record(TRACE_EVT_CMD_END, cmd, result);
             return result;
         }
     }
@@ -203,9 +287,20 @@ int itwt_setup(int argc, char* argv[], tlv_buffer_t** data)
     else
     {
         printf("Invalid Profile\n");
+        lock_prof_set(&conn_mutex);
+        trace_record(TRACE_EVT_CMD_END, cmd, (uint32_t)-1);
         return -1;
     }
 
+    lock_prof_set(&conn_mutex);
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        metrics_add(metric_itwt_setups, 1);
+    }
+
+    trace_record(TRACE_EVT_CMD_END, cmd, result);
+
     return result;
 }
 
@@ -231,22 +326,91 @@ int itwt_teardown(int argc, char* argv[], tlv_buffer_t** data)
     cy_rslt_t result;
 
     whd_twt_teardown_params_t twt_params;
+    uint16_t cmd = trace_string("itwt_teardown");
+
+    trace_record(TRACE_EVT_CMD_START, cmd, 0);
 
     twt_params.negotiation_type = TWT_CTRL_NEGO_TYPE_0;
     twt_params.flow_id = 0;
     twt_params.bcast_twt_id = 0;
     twt_params.teardown_all_twt = 0;
 
-    result = whd_wifi_twt_teardown(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &twt_params);
+    lock_prof_get(&conn_mutex, CY_RTOS_NEVER_TIMEOUT);
+    result = whd_prof_twt_teardown(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &twt_params);
     if(result != CY_RSLT_SUCCESS)
     {
         printf("TWT session teardown failed! Error code: 0x%08" PRIx32 "\n", result);
     }
+    else
+    {
+        twt_session_stop();
+        conn_profile = CY_WCM_ITWT_PROFILE_NONE;
+        warm_boot_save_twt();
+        metrics_add(metric_itwt_teardowns, 1);
+    }
+    lock_prof_set(&conn_mutex);
+
+    trace_record(TRACE_EVT_CMD_END, cmd, result);
 
      return result;
 }
 
 
+/*******************************************************************************
+* Function Name: itwt_select
+********************************************************************************
+* Summary:
+* This function brings the STA to the given iTWT profile: the agreement in
+* effect is torn down for CY_WCM_ITWT_PROFILE_NONE, otherwise the AP is
+* rejoined with the profile as itwt_setup does. Nothing is done if the
+* profile is already in effect: its agreement is active, or the current
+* association requested it and the AP has not refused it, so its Accept may
+* still come. The check and the change are made with the connection mutex
+* held, so that a join of another thread cannot come in between.
+*
+* Parameters:
+*  cy_wcm_itwt_profile_t profile : iTWT profile, or CY_WCM_ITWT_PROFILE_NONE
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t itwt_select(cy_wcm_itwt_profile_t profile)
+{
+    twt_session_agreement_t agreement;
+    char *argv[] = { (char *) "itwt_setup", (char *) ((profile == CY_WCM_ITWT_PROFILE_IDLE) ? "idle" : "active") };
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    bool in_effect;
+
+    lock_prof_get(&conn_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    twt_session_get(&agreement);
+    if(profile == CY_WCM_ITWT_PROFILE_NONE)
+    {
+        in_effect = !agreement.active;
+    }
+    else if(agreement.active)
+    {
+        in_effect = (agreement.profile == profile);
+    }
+    else
+    {
+        in_effect = cy_wcm_is_connected_to_ap() && (conn_profile == profile) &&
+                    (twt_session_support() != TWT_SESSION_SUPPORT_REFUSED);
+    }
+
+    if(!in_effect)
+    {
+        result = (profile == CY_WCM_ITWT_PROFILE_NONE) ? (cy_rslt_t)itwt_teardown(0, NULL, NULL)
+                                                       : (cy_rslt_t)itwt_setup(2, argv, NULL);
+    }
+
+    lock_prof_set(&conn_mutex);
+
+    return result;
+}
+
+
 /*******************************************************************************
 * Function Name: ConnectWifi
 ********************************************************************************
@@ -254,6 +418,8 @@ int itwt_teardown(int argc, char* argv[], tlv_buffer_t** data)
 * This function initiates connection to the Wi-Fi Access Point using the 
 * specified SSID and KEY. The connection is retried a maximum of 
 * 'MAX_WIFI_CONN_RETRIES' times with interval of 500 milliseconds.
+* After a warm boot, the first attempt targets the AP cached in the warm-boot
+* block; if it fails the cache is dropped and a regular join is done.
 *
 *
 * Parameters:
@@ -274,8 +440,25 @@ cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile)
     int retry_count = 0;
     cy_wcm_ip_address_t ip_addr;
     char ipstr[IP_STR_LEN];
+    warm_boot_conn_cache_t conn_cache;
+    bool use_cache;
+    cy_time_t join_start;
+    cy_time_t join_end;
+#if WARM_BOOT_REUSE_IP
+    cy_wcm_ip_setting_t static_ip;
+#endif
+
+    lock_prof_get(&conn_mutex, CY_RTOS_NEVER_TIMEOUT);
 
     memset(&conn_params, 0, sizeof(cy_wcm_connect_params_t));
+    conn_profile = CY_WCM_ITWT_PROFILE_NONE;
+
+    use_cache = warm_boot_get_conn_cache(ssid, &conn_cache) && (conn_cache.security == (uint32_t)WIFI_SECURITY);
+    if(!use_cache && (band == CY_WCM_WIFI_BAND_ANY))
+    {
+        /* Join the band chosen for the network by predicted throughput and TWT support */
+        band = band_select_band(ssid, profile != CY_WCM_ITWT_PROFILE_NONE);
+    }
 
     printf("Connecting to Wi-Fi Network: %s\n", WIFI_SSID);
 
@@ -290,15 +473,49 @@ cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile)
         conn_params.band = band;
         conn_params.itwt_profile = profile;
 
+        if(use_cache)
+        {
+            /* Join the cached BSSID on its band instead of scanning for the SSID */
+            memcpy(conn_params.BSSID, conn_cache.bssid, CY_WCM_MAC_ADDR_LEN);
+            conn_params.band = conn_cache.band;
+#if WARM_BOOT_REUSE_IP
+            memset(&static_ip, 0, sizeof(static_ip));
+            static_ip.ip_address.version = CY_WCM_IP_VER_V4;
+            static_ip.ip_address.ip.v4   = conn_cache.ip;
+            static_ip.netmask.version    = CY_WCM_IP_VER_V4;
+            static_ip.netmask.ip.v4      = conn_cache.netmask;
+            static_ip.gateway.version    = CY_WCM_IP_VER_V4;
+            static_ip.gateway.ip.v4      = conn_cache.gateway;
+            conn_params.static_ip_settings = &static_ip;
+#endif
+        }
+
+        cy_rtos_get_time(&join_start);
+        twt_session_join_start(profile);
+        sae_join_start();
         result = cy_wcm_connect_ap(&conn_params, &ip_addr);
+        sae_join_done(result);
+        twt_session_join_done(result == CY_RSLT_SUCCESS);
+        cy_rtos_get_time(&join_end);
         cy_rtos_delay_milliseconds(500);
 
         if(result != CY_RSLT_SUCCESS)
         {
+            metrics_add(metric_connect_failures, 1);
+
+            if(use_cache)
+            {
+                printf("Connection to cached AP failed. Falling back to a regular join\n");
+                use_cache = false;
+                memset(&conn_params, 0, sizeof(cy_wcm_connect_params_t));
+                warm_boot_invalidate_connection();
+            }
+
             retry_count++;
             if (retry_count >= MAX_WIFI_CONN_RETRIES)
             {
                 printf("Exceeded max WiFi connection attempts\n");
+                lock_prof_set(&conn_mutex);
                 return CY_RSLT_ERROR;
             }
             printf("Connection to WiFi network failed. Retrying...\n");
@@ -307,12 +524,103 @@ cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile)
         else
         {
             printf("Successfully connected to Wi-Fi network '%s'.\n", ssid);
+            metrics_add(metric_connects, 1);
+            metrics_observe(metric_connect_ms, (uint32_t)(join_end - join_start));
             get_ip_string(ipstr, ip_addr.ip.v4);
             printf("IP Address %s assigned\n", ipstr);
+
+            warm_boot_save_connection(ssid, (uint32_t)WIFI_SECURITY, &ip_addr);
+            warm_boot_save_twt();
+            conn_profile = profile;
             break;
         }
     }
 
+    lock_prof_set(&conn_mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: ReassociateWifi
+********************************************************************************
+* Summary:
+* This function moves the connection to another BSSID of the network, set up
+* with the given iTWT profile so that the agreement is negotiated as part of
+* the association. A single attempt is made; the caller falls back to
+* ConnectWifi() on failure.
+*
+* Parameters:
+*  const uint8_t *bssid          : BSSID to join
+*  cy_wcm_wifi_band_t band       : band of the BSSID, or CY_WCM_WIFI_BAND_ANY
+*  cy_wcm_itwt_profile_t profile : iTWT <Profile> <none|active|idle>
+*
+* Return:
+*  cy_rslt_t : CY_RSLT_SUCCESS once connected with an IP address, else an
+*              error code indicating the failure.
+*
+*******************************************************************************/
+cy_rslt_t ReassociateWifi(const uint8_t *bssid, cy_wcm_wifi_band_t band, cy_wcm_itwt_profile_t profile)
+{
+    cy_rslt_t result;
+
+    const char *ssid = WIFI_SSID ;
+    const char *key = WIFI_KEY ;
+    cy_wcm_ip_address_t ip_addr;
+    char ipstr[IP_STR_LEN];
+    cy_time_t join_start;
+    cy_time_t join_end;
+
+    lock_prof_get(&conn_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    memset(&conn_params, 0, sizeof(cy_wcm_connect_params_t));
+    conn_profile = CY_WCM_ITWT_PROFILE_NONE;
+    memcpy(&conn_params.ap_credentials.SSID, ssid, strlen(ssid) + 1);
+    memcpy(&conn_params.ap_credentials.password, key, strlen(key) + 1);
+    conn_params.ap_credentials.security = WIFI_SECURITY;
+    memcpy(conn_params.BSSID, bssid, CY_WCM_MAC_ADDR_LEN);
+    conn_params.band = band;
+    conn_params.itwt_profile = profile;
+
+    printf("Reassociating to %02x:%02x:%02x:%02x:%02x:%02x\n", bssid[0], bssid[1], bssid[2], bssid[3], bssid[4],
+           bssid[5]);
+
+    cy_rtos_get_time(&join_start);
+    if(cy_wcm_is_connected_to_ap())
+    {
+        cy_wcm_disconnect_ap();
+    }
+
+    /* The new AP answers the agreements anew */
+    twt_session_reset_support();
+
+    twt_session_join_start(profile);
+    sae_join_start();
+    result = cy_wcm_connect_ap(&conn_params, &ip_addr);
+    sae_join_done(result);
+    twt_session_join_done(result == CY_RSLT_SUCCESS);
+    cy_rtos_get_time(&join_end);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        metrics_add(metric_connect_failures, 1);
+        printf("Reassociation failed! Error code: 0x%08" PRIx32 "\n", result);
+        lock_prof_set(&conn_mutex);
+        return result;
+    }
+
+    metrics_add(metric_connects, 1);
+    metrics_observe(metric_connect_ms, (uint32_t)(join_end - join_start));
+    get_ip_string(ipstr, ip_addr.ip.v4);
+    printf("IP Address %s assigned\n", ipstr);
+
+    warm_boot_save_connection(ssid, (uint32_t)WIFI_SECURITY, &ip_addr);
+    warm_boot_save_twt();
+    conn_profile = profile;
+
+    lock_prof_set(&conn_mutex);
+
     return CY_RSLT_SUCCESS;
 }
 
@@ -326,6 +634,7 @@ cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile)
 *    2. Initializes Wi-Fi uitlity and adds Wi-Fi commands
 *    3. Initializes iperf uitlity and adds iperf commands
 *    4. Registers itwt commands table
+*    5. Registers application commands tables
 *
 * Parameters:
 *  void
@@ -376,6 +685,17 @@ cy_rslt_t command_console_add_command(void) {
         goto error;
     }
 
+    /* Register application commands tables */
+    for (size_t i = 0; i < sizeof(app_add_commands) / sizeof(app_add_commands[0]); i++)
+    {
+        result = app_add_commands[i]();
+        if ( result != CY_RSLT_SUCCESS )
+        {
+            printf("Error in adding command console table : 0x%08" PRIx32 "\n", result);
+            goto error;
+        }
+    }
+
     return CY_RSLT_SUCCESS;
 
 error:
@@ -409,7 +729,8 @@ static void wdt_handler(cy_timer_callback_arg_t arg)
 ********************************************************************************
 * Summary:
 * The console task does the following:
-*    1. Initializes WCM and connects to configured AP
+*    1. Initializes WCM and connects to configured AP. After a warm boot,
+*       the iTWT profile that was in effect before the reset is requested again
 *    2. Starts a periodic software timer 
 *    3. Waits for user indifinitely to input commands 
 *
@@ -423,6 +744,39 @@ static void wdt_handler(cy_timer_callback_arg_t arg)
 static void console_task(cy_thread_arg_t arg)
 {
     cy_rslt_t result;
+    cy_wcm_itwt_profile_t profile = CY_WCM_ITWT_PROFILE_NONE;
+    twt_session_agreement_t agreement;
+
+    /* Start the event tracer (disabled until "trace start") */
+    trace_init();
+
+    /* Start per-thread CPU accounting */
+    result = cpu_monitor_init();
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("CPU monitor initialization failed! Error code: 0x%08" PRIx32 "\n", result);
+    }
+
+    /* Register the metrics; the exporters are started by the "metrics" command */
+    result = metrics_init();
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Metrics initialization failed! Error code: 0x%08" PRIx32 "\n", result);
+    }
+    metric_connects         = metrics_counter("wifi_connects_total", "Successful joins");
+    metric_connect_failures = metrics_counter("wifi_connect_failures_total", "Failed join attempts");
+    metric_connect_ms       = metrics_histogram("wifi_connect_ms", "Duration of successful joins",
+                                                connect_ms_bounds, sizeof(connect_ms_bounds) / sizeof(connect_ms_bounds[0]));
+    metric_itwt_setups      = metrics_counter("itwt_setups_total", "iTWT agreements set up by itwt_setup");
+    metric_itwt_teardowns   = metrics_counter("itwt_teardowns_total", "iTWT agreements torn down by itwt_teardown");
+
+    result = cy_rtos_init_mutex(&conn_mutex);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Connection mutex initialization failed! Error code: 0x%08" PRIx32 "\n", result);
+        return;
+    }
+    lock_prof_name(&conn_mutex, "conn");
 
     /* Initialize wcm */
     wcm_config.interface = CY_WCM_INTERFACE_TYPE_STA;
@@ -434,8 +788,36 @@ static void console_task(cy_thread_arg_t arg)
     }
     printf("Wi-Fi Connection Manager initialized.\n");
 
+    /* Select H2E and time SAE authentications before the first join */
+    result = sae_init(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], WIFI_SECURITY);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("SAE initialization failed! Error code: 0x%08" PRIx32 "\n", result);
+    }
+
+    /* Log the TWT frames of the negotiations, starting with the first join */
+    result = twt_log_init(whd_ifs[CY_WCM_INTERFACE_TYPE_STA]);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("TWT log initialization failed! Error code: 0x%08" PRIx32 "\n", result);
+    }
+
+    /* Set the iTWT agreement up again after the firmware roams */
+    result = roam_init(whd_ifs[CY_WCM_INTERFACE_TYPE_STA]);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Roam initialization failed! Error code: 0x%08" PRIx32 "\n", result);
+    }
+
+    /* Restore the iTWT profile that was in effect before a warm reset */
+    warm_boot_get_twt(&agreement);
+    if(warm_boot_is_warm() && agreement.active)
+    {
+        profile = agreement.profile;
+    }
+
     /* Connect to an AP for which credentials are specified */
-    ConnectWifi(CY_WCM_ITWT_PROFILE_NONE);
+    ConnectWifi(profile);
 
     command_console_add_command();
 
@@ -447,6 +829,14 @@ static void console_task(cy_thread_arg_t arg)
     while(1)
     {
         cy_rtos_delay_milliseconds(500);
+        warm_boot_update_heap_stats();
+        tcp_tune_update();
+
+        /* Predict the SPs of a newly accepted iTWT agreement */
+        if(twt_session_update(whd_ifs[CY_WCM_INTERFACE_TYPE_STA]))
+        {
+            warm_boot_save_twt();
+        }
     }
 }
 
@@ -518,6 +908,16 @@ int main(void)
            "                      TWT Demo Example                      \n"
            "************************************************************\n");
 
+#if defined(APP_CODE_PLACEMENT_PROFILE)
+    printf("Hot code in RAM: %" PRIu32 " bytes, remaining code executes from flash\n", code_placement_hot_size());
+#endif
+
+    /* Pick up the state retained across a watchdog or software reset */
+    if(warm_boot_init())
+    {
+        printf("Warm boot: reusing cached connection and iTWT state\n");
+    }
+
     result = cy_rtos_thread_create(&nxs_thread,
                                    &console_task,
                                    "ConsoleTask",
@@ -0,0 +1,352 @@
+/******************************************************************************
+* File Name:   awake_est.c
+*
+* Description: This file implements the estimator of the radio awake time.
+*              Between awake_est_start() and awake_est_stop(), every frame
+*              passed between the network stack and WHD is fed to a model of
+*              the power-save mode in effect:
+*
+*              - No power save: awake all the time.
+*              - PM1: a wakeup per DTIM beacon plus a PS-Poll exchange and
+*                the airtime of every frame.
+*              - PM2: awake until the return-to-sleep timer expires after the
+*                last frame, plus DTIM beacons while asleep.
+*              - iTWT: the SPs, plus an exchange for every frame outside
+*                them.
+*
+*              The firmware does not report its sleep time, so this is an
+*              estimate meant for comparing modes under the same load, not
+*              a measurement of current.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "awake_est.h"
+#include "twt_session.h"
+#include "whd_prof.h"
+
+/* Wi-Fi connection manager and WHD header files. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+
+/* Standard C header files. */
+#include <string.h>
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern whd_interface_t whd_ifs[2];
+
+static const char *awake_est_mode_names[AWAKE_EST_MODES] = { "no-ps", "pm1", "pm2", "itwt" };
+
+static volatile bool awake_est_active;
+static awake_est_config_t awake_est_config;
+static cy_time_t awake_est_start_ms;
+static uint32_t awake_est_frames;
+static uint32_t awake_est_frames_outside_sp;
+static uint64_t awake_est_air_bytes;
+
+/* PM2: end of the current awake window and awake time of the closed ones */
+static cy_time_t awake_est_pm2_until_ms;
+static uint32_t awake_est_pm2_awake_ms;
+
+
+/*******************************************************************************
+* Function Name: awake_est_mode_name
+********************************************************************************
+* Summary:
+* This function returns the name of a power-save mode.
+*
+*******************************************************************************/
+const char *awake_est_mode_name(awake_est_mode_t mode)
+{
+    return (mode < AWAKE_EST_MODES) ? awake_est_mode_names[mode] : "?";
+}
+
+
+/*******************************************************************************
+* Function Name: awake_est_detect
+********************************************************************************
+* Summary:
+* This function fills a model configuration from the current state of the
+* STA: the iTWT agreement if one is active, the PM mode and return-to-sleep
+* timer otherwise, the beacon and DTIM periods of the AP and the PHY rate.
+* Values that cannot be read keep their defaults.
+*
+* Parameters:
+*  awake_est_config_t *config : configuration to fill
+*
+* Return:
+*  cy_rslt_t : result of reading the PM mode
+*
+*******************************************************************************/
+cy_rslt_t awake_est_detect(awake_est_config_t *config)
+{
+    whd_interface_t ifp = whd_ifs[CY_WCM_INTERFACE_TYPE_STA];
+    twt_session_agreement_t agreement;
+    uint32_t value = 0;
+    uint32_t dtim = 1;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    memset(config, 0, sizeof(*config));
+    config->pm2_ret_ms = AWAKE_EST_DEFAULT_PM2_RET_MS;
+    config->listen_interval_ms = AWAKE_EST_DEFAULT_BEACON_MS;
+    config->rate_kbps = AWAKE_EST_DEFAULT_RATE_KBPS;
+
+    twt_session_get(&agreement);
+    if(agreement.active)
+    {
+        config->mode = AWAKE_EST_TWT;
+        config->twt_wi_us = twt_session_wake_interval_us(&agreement);
+        config->twt_wd_us = twt_session_wake_duration_us(&agreement);
+    }
+    else
+    {
+        result = whd_prof_get_ioctl_value(ifp, WLC_GET_PM, &value);
+        config->mode = (value == 1u) ? AWAKE_EST_PM1 : ((value == 2u) ? AWAKE_EST_PM2 : AWAKE_EST_NO_PS);
+    }
+
+    if((whd_prof_get_iovar_value(ifp, "pm2_sleep_ret", &value) == WHD_SUCCESS) && (value != 0u))
+    {
+        config->pm2_ret_ms = value;
+    }
+
+    /* Beacon period in TU (1024 us) */
+    if((whd_prof_get_ioctl_value(ifp, WLC_GET_BCNPRD, &value) == WHD_SUCCESS) && (value != 0u))
+    {
+        config->listen_interval_ms = (value * 1024u) / 1000u;
+    }
+    if((whd_prof_get_ioctl_value(ifp, WLC_GET_DTIMPRD, &dtim) == WHD_SUCCESS) && (dtim != 0u))
+    {
+        config->listen_interval_ms *= dtim;
+    }
+
+    /* WLC_GET_RATE reports the current TX rate in units of 500 kbit/s */
+    if((whd_prof_get_ioctl_value(ifp, WLC_GET_RATE, &value) == WHD_SUCCESS) && (value != 0u))
+    {
+        config->rate_kbps = value * 500u;
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: awake_est_start
+********************************************************************************
+* Summary:
+* This function starts an estimation window with the given model.
+*
+* Parameters:
+*  const awake_est_config_t *config : power-save model
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void awake_est_start(const awake_est_config_t *config)
+{
+    cy_time_t now;
+    uint32_t state;
+
+    cy_rtos_get_time(&now);
+
+    state = cyhal_system_critical_section_enter();
+    awake_est_config = *config;
+    awake_est_start_ms = now;
+    awake_est_frames = 0;
+    awake_est_frames_outside_sp = 0;
+    awake_est_air_bytes = 0;
+    awake_est_pm2_until_ms = now;
+    awake_est_pm2_awake_ms = 0;
+    awake_est_active = true;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: awake_est_frame
+********************************************************************************
+* Summary:
+* This function accounts for a frame sent or received. Called from the packet
+* hooks; returns immediately when no window is open.
+*
+* Parameters:
+*  uint32_t length : frame length
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void awake_est_frame(uint32_t length)
+{
+    cy_time_t now;
+    bool in_sp;
+    uint32_t state;
+
+    if(!awake_est_active)
+    {
+        return;
+    }
+
+    cy_rtos_get_time(&now);
+    in_sp = twt_session_in_sp();
+
+    state = cyhal_system_critical_section_enter();
+    awake_est_frames++;
+    awake_est_air_bytes += length + AWAKE_EST_FRAME_OVERHEAD;
+
+    if(awake_est_config.mode == AWAKE_EST_PM2)
+    {
+        /* Extend the awake window, or open a new one */
+        if((int32_t)(now - awake_est_pm2_until_ms) >= 0)
+        {
+            awake_est_pm2_awake_ms += awake_est_config.pm2_ret_ms;
+        }
+        else
+        {
+            awake_est_pm2_awake_ms += (uint32_t)(now - awake_est_pm2_until_ms) + awake_est_config.pm2_ret_ms;
+        }
+        awake_est_pm2_until_ms = now + awake_est_config.pm2_ret_ms;
+    }
+    else if((awake_est_config.mode == AWAKE_EST_TWT) && !in_sp)
+    {
+        awake_est_frames_outside_sp++;
+    }
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: awake_est_stop
+********************************************************************************
+* Summary:
+* This function closes the estimation window and computes the awake time.
+*
+* Parameters:
+*  awake_est_result_t *result : elapsed and estimated awake time
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void awake_est_stop(awake_est_result_t *result)
+{
+    const awake_est_config_t *config = &awake_est_config;
+    cy_time_t now;
+    uint64_t elapsed_us;
+    uint64_t awake_us = 0;
+    uint64_t airtime_us;
+    uint32_t listen_ms;
+    uint32_t state;
+
+    cy_rtos_get_time(&now);
+
+    state = cyhal_system_critical_section_enter();
+    awake_est_active = false;
+    cyhal_system_critical_section_exit(state);
+
+    memset(result, 0, sizeof(*result));
+    result->elapsed_ms = (uint32_t)(now - awake_est_start_ms);
+    result->frames = awake_est_frames;
+    result->frames_outside_sp = awake_est_frames_outside_sp;
+
+    elapsed_us = (uint64_t)result->elapsed_ms * 1000u;
+    airtime_us = (awake_est_air_bytes * 8000u) / ((config->rate_kbps != 0u) ? config->rate_kbps : AWAKE_EST_DEFAULT_RATE_KBPS);
+    listen_ms = (config->listen_interval_ms != 0u) ? config->listen_interval_ms : AWAKE_EST_DEFAULT_BEACON_MS;
+
+    switch(config->mode)
+    {
+        case AWAKE_EST_PM1:
+            awake_us = ((uint64_t)(result->elapsed_ms / listen_ms) * AWAKE_EST_BEACON_US) +
+                       ((uint64_t)result->frames * AWAKE_EST_PS_POLL_US) + airtime_us;
+            break;
+
+        case AWAKE_EST_PM2:
+        {
+            uint64_t window_us = (uint64_t)awake_est_pm2_awake_ms * 1000u;
+            uint64_t asleep_ms;
+
+            /* The last window may extend past the end */
+            if((int32_t)(awake_est_pm2_until_ms - now) > 0)
+            {
+                window_us -= (uint64_t)(uint32_t)(awake_est_pm2_until_ms - now) * 1000u;
+            }
+            if(window_us > elapsed_us)
+            {
+                window_us = elapsed_us;
+            }
+            asleep_ms = (elapsed_us - window_us) / 1000u;
+            awake_us = window_us + ((asleep_ms / listen_ms) * AWAKE_EST_BEACON_US);
+            break;
+        }
+
+        case AWAKE_EST_TWT:
+            if(config->twt_wi_us != 0u)
+            {
+                awake_us = ((elapsed_us / config->twt_wi_us) * config->twt_wd_us) +
+                           ((uint64_t)result->frames_outside_sp * AWAKE_EST_PS_POLL_US);
+            }
+            break;
+
+        case AWAKE_EST_NO_PS:
+        default:
+            awake_us = elapsed_us;
+            break;
+    }
+
+    result->awake_ms = (uint32_t)(((awake_us < elapsed_us) ? awake_us : elapsed_us) / 1000u);
+}
+
+
+/*******************************************************************************
+* Function Name: awake_est_running
+********************************************************************************
+* Summary:
+* This function tells whether an estimation window is open.
+*
+*******************************************************************************/
+bool awake_est_running(void)
+{
+    return awake_est_active;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/******************************************************************************
+* File Name:   awake_est.h
+*
+* Description: This file contains the declarations for the estimator of the
+*              radio awake time under the power-save mode in effect.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef AWAKE_EST_H_
+#define AWAKE_EST_H_
+
+#include "cy_result.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Radio on-time to wake up, receive a beacon and go back to sleep */
+#define AWAKE_EST_BEACON_US             (2500u)
+
+/* Radio on-time for a PS-Poll exchange, or any frame outside the schedule */
+#define AWAKE_EST_PS_POLL_US            (1500u)
+
+/* MAC/PHY overhead per frame (preamble, headers, SIFS and ACK) */
+#define AWAKE_EST_FRAME_OVERHEAD        (70u)
+
+/* Used when the AP values cannot be read */
+#define AWAKE_EST_DEFAULT_BEACON_MS     (102u)
+#define AWAKE_EST_DEFAULT_PM2_RET_MS    (200u)
+#define AWAKE_EST_DEFAULT_RATE_KBPS     (6000u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    AWAKE_EST_NO_PS = 0,   /* Always awake */
+    AWAKE_EST_PM1,         /* PS-Poll: wake for DTIM beacons, poll buffered frames */
+    AWAKE_EST_PM2,         /* Fast PS: stay awake pm2_ret_ms after each frame */
+    AWAKE_EST_TWT,         /* Awake during the SPs of the iTWT agreement */
+    AWAKE_EST_MODES
+} awake_est_mode_t;
+
+typedef struct
+{
+    awake_est_mode_t mode;
+    uint32_t         pm2_ret_ms;          /* PM2 return-to-sleep timer */
+    uint32_t         listen_interval_ms;  /* Beacon interval times DTIM period */
+    uint32_t         twt_wi_us;
+    uint32_t         twt_wd_us;
+    uint32_t         rate_kbps;           /* PHY rate for frame airtime */
+} awake_est_config_t;
+
+typedef struct
+{
+    uint32_t elapsed_ms;
+    uint32_t awake_ms;
+    uint32_t frames;
+    uint32_t frames_outside_sp;
+} awake_est_result_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+const char *awake_est_mode_name(awake_est_mode_t mode);
+cy_rslt_t awake_est_detect(awake_est_config_t *config);
+void awake_est_start(const awake_est_config_t *config);
+void awake_est_frame(uint32_t length);
+void awake_est_stop(awake_est_result_t *result);
+bool awake_est_running(void);
+
+#endif /* AWAKE_EST_H_ */
+
+/* [] END OF FILE */
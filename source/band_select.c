@@ -0,0 +1,582 @@
+/******************************************************************************
+* File Name:   band_select.c
+*
+* Description: This file implements the selection of the band of a dual-band
+*              network. The SSID is scanned and, for the strongest BSSID of
+*              each band, the throughput is predicted from the rate the link
+*              model expects at its RSSI. 'band_select probe' refines the
+*              prediction by joining each band in turn and measuring the TX
+*              rate and a short UDP burst against a tgen sink. The band with
+*              the higher predicted throughput is chosen, unless an iTWT
+*              agreement is wanted and only one band offers TWT with enough
+*              throughput. The decision is cached per SSID and used by the
+*              joins that follow.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "band_select.h"
+#include "link_monitor.h"
+#include "roam.h"
+#include "tgen.h"
+#include "twt_session.h"
+
+#include "cyabs_rtos.h"
+#include "command_console.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    bool                 valid;
+    char                 ssid[CY_WCM_MAX_SSID_LEN + 1];
+    cy_time_t            time_ms;
+    bool                 want_twt;
+    band_select_band_t   band;
+    band_select_reason_t reason;
+    band_select_probe_t  probes[BAND_SELECT_BANDS];
+} band_select_entry_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int band_select_command(int argc, char* argv[], tlv_buffer_t** data);
+
+/* Defined in main.c */
+cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile);
+cy_rslt_t ReassociateWifi(const uint8_t *bssid, cy_wcm_wifi_band_t band, cy_wcm_itwt_profile_t profile);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char *band_select_band_names[BAND_SELECT_BANDS] = { "2.4 GHz", "5 GHz" };
+
+static const char *band_select_reason_names[BAND_SELECT_REASONS] =
+{
+    "only band of the network",
+    "only band offering TWT",
+    "higher predicted throughput",
+    "similar throughput, less crowded band",
+};
+
+static band_select_entry_t band_select_cache[BAND_SELECT_CACHE_ENTRIES];
+
+#define BAND_SELECT_COMMANDS \
+    { (char *) "band_select", band_select_command, 0, NULL, NULL, (char *) "[probe <host> [port]|clear]", (char *) "Show the band chosen per SSID and why, or probe both bands" }, \
+
+const cy_command_console_cmd_t band_select_commands_table[] =
+{
+    BAND_SELECT_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: band_select_wcm_band
+********************************************************************************
+* Summary:
+* Returns the WCM band of 'band'.
+*
+*******************************************************************************/
+static cy_wcm_wifi_band_t band_select_wcm_band(band_select_band_t band)
+{
+    return (band == BAND_SELECT_5GHZ) ? CY_WCM_WIFI_BAND_5GHZ : CY_WCM_WIFI_BAND_2_4GHZ;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_predict
+********************************************************************************
+* Summary:
+* Returns the throughput predicted for a band: the share of the rate left
+* for data, scaled by the delivery ratio of the burst when probed.
+*
+*******************************************************************************/
+static uint32_t band_select_predict(const band_select_probe_t *probe)
+{
+    uint64_t kbps = ((uint64_t)probe->rate_kbps * LINK_MONITOR_MAC_EFFICIENCY_PCT) / 100u;
+
+    if(probe->probed && (probe->sent != 0u))
+    {
+        kbps = (kbps * probe->received) / probe->sent;
+    }
+
+    return (uint32_t)kbps;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_decide
+********************************************************************************
+* Summary:
+* This function predicts the throughput of each band and chooses one. When
+* an iTWT agreement is wanted and only one band offers TWT, that band is
+* chosen if it predicts BAND_SELECT_TWT_MIN_KBPS; otherwise the higher
+* predicted throughput wins, 5 GHz when within BAND_SELECT_MARGIN_PCT.
+*
+* Parameters:
+*  band_select_probe_t probes[] : per band; predicted_kbps is filled in
+*  bool want_twt                : an iTWT agreement is wanted
+*  band_select_reason_t *reason : receives the reason of the choice
+*
+* Return:
+*  band_select_band_t : chosen band, BAND_SELECT_BANDS if none is present
+*
+*******************************************************************************/
+band_select_band_t band_select_decide(band_select_probe_t probes[BAND_SELECT_BANDS], bool want_twt,
+                                      band_select_reason_t *reason)
+{
+    band_select_probe_t *low = &probes[BAND_SELECT_2_4GHZ];
+    band_select_probe_t *high = &probes[BAND_SELECT_5GHZ];
+    uint32_t best_kbps;
+
+    for(uint32_t i = 0; i < BAND_SELECT_BANDS; i++)
+    {
+        probes[i].predicted_kbps = probes[i].present ? band_select_predict(&probes[i]) : 0u;
+    }
+
+    if(!low->present || !high->present)
+    {
+        *reason = BAND_SELECT_ONLY_BAND;
+        return low->present ? BAND_SELECT_2_4GHZ : (high->present ? BAND_SELECT_5GHZ : BAND_SELECT_BANDS);
+    }
+
+    if(want_twt && (low->twt != high->twt))
+    {
+        band_select_band_t twt_band = low->twt ? BAND_SELECT_2_4GHZ : BAND_SELECT_5GHZ;
+
+        if(probes[twt_band].predicted_kbps >= BAND_SELECT_TWT_MIN_KBPS)
+        {
+            *reason = BAND_SELECT_TWT;
+            return twt_band;
+        }
+    }
+
+    best_kbps = (low->predicted_kbps > high->predicted_kbps) ? low->predicted_kbps : high->predicted_kbps;
+    if((uint32_t)abs((int32_t)(low->predicted_kbps - high->predicted_kbps)) * 100u <= best_kbps * BAND_SELECT_MARGIN_PCT)
+    {
+        *reason = BAND_SELECT_SIMILAR;
+        return BAND_SELECT_5GHZ;
+    }
+
+    *reason = BAND_SELECT_THROUGHPUT;
+    return (low->predicted_kbps > high->predicted_kbps) ? BAND_SELECT_2_4GHZ : BAND_SELECT_5GHZ;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_find
+********************************************************************************
+* Summary:
+* Returns the cache entry of 'ssid', or NULL.
+*
+*******************************************************************************/
+static band_select_entry_t *band_select_find(const char *ssid)
+{
+    for(uint32_t i = 0; i < BAND_SELECT_CACHE_ENTRIES; i++)
+    {
+        if(band_select_cache[i].valid && !strcmp(band_select_cache[i].ssid, ssid))
+        {
+            return &band_select_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_store
+********************************************************************************
+* Summary:
+* Returns the cache entry to use for 'ssid': its own, a free one or the
+* oldest one.
+*
+*******************************************************************************/
+static band_select_entry_t *band_select_store(const char *ssid)
+{
+    band_select_entry_t *entry = band_select_find(ssid);
+
+    for(uint32_t i = 0; (entry == NULL) && (i < BAND_SELECT_CACHE_ENTRIES); i++)
+    {
+        if(!band_select_cache[i].valid)
+        {
+            entry = &band_select_cache[i];
+        }
+    }
+
+    for(uint32_t i = 0; (entry == NULL) && (i < BAND_SELECT_CACHE_ENTRIES); i++)
+    {
+        if((i == 0u) || (band_select_cache[i].time_ms < entry->time_ms))
+        {
+            entry = &band_select_cache[i];
+        }
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->ssid, ssid, sizeof(entry->ssid) - 1u);
+    entry->valid = true;
+    cy_rtos_get_time(&entry->time_ms);
+
+    return entry;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_scan
+********************************************************************************
+* Summary:
+* Scans 'ssid' and fills in the strongest BSSID of each band, with its TWT
+* support and the rate the link model expects at its RSSI.
+*
+*******************************************************************************/
+static cy_rslt_t band_select_scan(const char *ssid, band_select_probe_t probes[BAND_SELECT_BANDS])
+{
+    roam_candidate_t candidates[ROAM_MAX_CANDIDATES];
+    uint32_t count = 0;
+    cy_rslt_t result;
+
+    memset(probes, 0, BAND_SELECT_BANDS * sizeof(band_select_probe_t));
+
+    result = roam_scan_ssid((const uint8_t *)ssid, candidates, &count);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        band_select_probe_t *probe = &probes[(candidates[i].channel > 14u) ? BAND_SELECT_5GHZ : BAND_SELECT_2_4GHZ];
+
+        if(probe->present && (candidates[i].rssi_dbm <= probe->rssi_dbm))
+        {
+            continue;
+        }
+
+        probe->present = true;
+        memcpy(probe->bssid, candidates[i].bssid, sizeof(probe->bssid));
+        probe->channel = candidates[i].channel;
+        probe->rssi_dbm = candidates[i].rssi_dbm;
+        probe->twt = ((candidates[i].caps & ROAM_CAP_TWT) != 0u);
+        probe->rate_kbps = link_monitor_mcs_rate_kbps(link_monitor_model_mcs(candidates[i].rssi_dbm));
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_band
+********************************************************************************
+* Summary:
+* This function returns the band to join 'ssid' on. The first time, the
+* SSID is scanned and the decision cached; it is made again from the cached
+* measurements when 'want_twt' changes.
+*
+* Parameters:
+*  const char *ssid : SSID to join
+*  bool want_twt    : an iTWT agreement is wanted
+*
+* Return:
+*  cy_wcm_wifi_band_t : CY_WCM_WIFI_BAND_ANY if the SSID was not found
+*
+*******************************************************************************/
+cy_wcm_wifi_band_t band_select_band(const char *ssid, bool want_twt)
+{
+    band_select_entry_t *entry = band_select_find(ssid);
+    band_select_probe_t probes[BAND_SELECT_BANDS];
+
+    if(entry == NULL)
+    {
+        if((band_select_scan(ssid, probes) != CY_RSLT_SUCCESS) ||
+           (!probes[BAND_SELECT_2_4GHZ].present && !probes[BAND_SELECT_5GHZ].present))
+        {
+            return CY_WCM_WIFI_BAND_ANY;
+        }
+
+        entry = band_select_store(ssid);
+        memcpy(entry->probes, probes, sizeof(entry->probes));
+    }
+    else if(entry->want_twt == want_twt)
+    {
+        return band_select_wcm_band(entry->band);
+    }
+
+    entry->want_twt = want_twt;
+    entry->band = band_select_decide(entry->probes, want_twt, &entry->reason);
+    printf("Band selection for '%s': %s, %s\n", entry->ssid, band_select_band_names[entry->band],
+           band_select_reason_names[entry->reason]);
+
+    return band_select_wcm_band(entry->band);
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_print
+********************************************************************************
+* Summary:
+* Prints the decision of a cache entry with the measurements behind it.
+*
+*******************************************************************************/
+static void band_select_print(const band_select_entry_t *entry)
+{
+    printf("'%s': %s, %s%s\n", entry->ssid, band_select_band_names[entry->band],
+           band_select_reason_names[entry->reason], entry->want_twt ? " (iTWT wanted)" : "");
+    printf("  %-7s %-17s %4s %5s %3s %3s %7s %5s %5s %7s %9s\n", "band", "bssid", "chan", "rssi", "twt", "agr",
+           "rate", "sent", "recv", "kbit/s", "predicted");
+
+    for(uint32_t i = 0; i < BAND_SELECT_BANDS; i++)
+    {
+        const band_select_probe_t *probe = &entry->probes[i];
+
+        if(!probe->present)
+        {
+            printf("  %-7s (none)\n", band_select_band_names[i]);
+            continue;
+        }
+
+        printf("%c %-7s %02x:%02x:%02x:%02x:%02x:%02x %4u %5" PRId32 " %3s %3s %7" PRIu32 " ",
+               (entry->band == (band_select_band_t)i) ? '>' : ' ', band_select_band_names[i], probe->bssid[0],
+               probe->bssid[1], probe->bssid[2], probe->bssid[3], probe->bssid[4], probe->bssid[5], probe->channel,
+               probe->rssi_dbm, probe->twt ? "yes" : "no",
+               (!probe->probed || !entry->want_twt) ? "-" : (probe->twt_accepted ? "yes" : "no"), probe->rate_kbps);
+
+        if(probe->probed)
+        {
+            printf("%5" PRIu32 " %5" PRIu32 " %7" PRIu32 " ", probe->sent, probe->received, probe->measured_kbps);
+        }
+        else
+        {
+            printf("%5s %5s %7s ", "-", "-", "-");
+        }
+
+        printf("%9" PRIu32 "\n", probe->predicted_kbps);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_probe
+********************************************************************************
+* Summary:
+* Joins the strongest BSSID of each band of the current network with the
+* iTWT profile in effect, measures the TX rate, the agreement and a UDP
+* burst to 'host', then caches the decision and stays on the chosen band.
+*
+*******************************************************************************/
+static int band_select_probe(const char *host, uint16_t port)
+{
+    cy_wcm_associated_ap_info_t ap_info;
+    twt_session_agreement_t agreement;
+    cy_wcm_itwt_profile_t profile;
+    band_select_probe_t probes[BAND_SELECT_BANDS];
+    band_select_entry_t *entry;
+    band_select_band_t joined = BAND_SELECT_BANDS;
+    tgen_config_t config;
+    char ssid[CY_WCM_MAX_SSID_LEN + 1];
+
+    if(!cy_wcm_is_connected_to_ap() || (cy_wcm_get_associated_ap_info(&ap_info) != CY_RSLT_SUCCESS))
+    {
+        printf("Not connected\n");
+        return -1;
+    }
+
+    memset(ssid, 0, sizeof(ssid));
+    memcpy(ssid, ap_info.SSID, CY_WCM_MAX_SSID_LEN);
+    twt_session_get(&agreement);
+    profile = agreement.active ? agreement.profile : CY_WCM_ITWT_PROFILE_NONE;
+
+    if((band_select_scan(ssid, probes) != CY_RSLT_SUCCESS) ||
+       (!probes[BAND_SELECT_2_4GHZ].present && !probes[BAND_SELECT_5GHZ].present))
+    {
+        printf("Scan failed\n");
+        return -1;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.profile = TGEN_BURSTY;
+    strncpy(config.hosts[0], host, TGEN_HOST_LEN - 1u);
+    config.destinations = 1;
+    config.port = port;
+    config.interval_ms = BAND_SELECT_INTERVAL_MS;
+    config.size_min = BAND_SELECT_SIZE;
+    config.size_max = BAND_SELECT_SIZE;
+    config.count = BAND_SELECT_COUNT;
+    config.burst = BAND_SELECT_BURST;
+
+    for(uint32_t i = 0; i < BAND_SELECT_BANDS; i++)
+    {
+        band_select_probe_t *probe = &probes[i];
+        link_monitor_sample_t sample;
+        tgen_result_t result;
+
+        if(!probe->present)
+        {
+            continue;
+        }
+
+        printf("Probing %s\n", band_select_band_names[i]);
+        if(ReassociateWifi(probe->bssid, band_select_wcm_band((band_select_band_t)i), profile) != CY_RSLT_SUCCESS)
+        {
+            joined = BAND_SELECT_BANDS;
+            continue;
+        }
+        joined = (band_select_band_t)i;
+        cy_rtos_delay_milliseconds(BAND_SELECT_SETTLE_MS);
+
+        if(link_monitor_sample(&sample) == CY_RSLT_SUCCESS)
+        {
+            probe->rssi_dbm = sample.rssi_dbm;
+            probe->rate_kbps = sample.rate_kbps;
+        }
+        if(profile != CY_WCM_ITWT_PROFILE_NONE)
+        {
+            for(uint32_t waited_ms = 0; (waited_ms < BAND_SELECT_TWT_ACCEPT_MS) && !twt_session_is_active() &&
+                (twt_session_support() != TWT_SESSION_SUPPORT_REFUSED); waited_ms += BAND_SELECT_TWT_POLL_MS)
+            {
+                cy_rtos_delay_milliseconds(BAND_SELECT_TWT_POLL_MS);
+            }
+            probe->twt_accepted = twt_session_is_active();
+        }
+
+        if(tgen_run(&config, &result) == 0)
+        {
+            probe->probed = true;
+            probe->sent = result.sent;
+            probe->received = result.received;
+            probe->measured_kbps = (result.duration_ms != 0u) ?
+                                   (uint32_t)(((result.bytes + result.echo_bytes) * 8u) / result.duration_ms) : 0u;
+        }
+    }
+
+    entry = band_select_store(ssid);
+    memcpy(entry->probes, probes, sizeof(entry->probes));
+    entry->want_twt = (profile != CY_WCM_ITWT_PROFILE_NONE);
+    entry->band = band_select_decide(entry->probes, entry->want_twt, &entry->reason);
+    band_select_print(entry);
+
+    /* Stay on the chosen band, or join the network again as after boot */
+    if((joined != entry->band) &&
+       (ReassociateWifi(probes[entry->band].bssid, band_select_wcm_band(entry->band), profile) != CY_RSLT_SUCCESS))
+    {
+        ConnectWifi(profile);
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_command
+********************************************************************************
+* Summary:
+* This function shows the band chosen for each SSID with the measurements
+* and the reason behind the choice, probes both bands of the current network
+* against a tgen sink, or clears the cached decisions.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int band_select_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint32_t shown = 0;
+
+    if((argc >= 3) && !strcmp(argv[1], "probe"))
+    {
+        return band_select_probe(argv[2], (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) : TGEN_DEFAULT_PORT);
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "clear"))
+    {
+        memset(band_select_cache, 0, sizeof(band_select_cache));
+        return 0;
+    }
+
+    if(argc >= 2)
+    {
+        printf("Usage: band_select [probe <host> [port]|clear]\n");
+        return -1;
+    }
+
+    for(uint32_t i = 0; i < BAND_SELECT_CACHE_ENTRIES; i++)
+    {
+        if(band_select_cache[i].valid)
+        {
+            band_select_print(&band_select_cache[i]);
+            shown++;
+        }
+    }
+
+    if(shown == 0u)
+    {
+        printf("No band decision cached\n");
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: band_select_add_commands
+********************************************************************************
+* Summary:
+* This function registers the band selection command.
+*
+*******************************************************************************/
+cy_rslt_t band_select_add_commands(void)
+{
+    return cy_command_console_add_table(band_select_commands_table);
+}
+
+
+/* [] END OF FILE */
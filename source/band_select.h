@@ -0,0 +1,129 @@
+/******************************************************************************
+* File Name:   band_select.h
+*
+* Description: This file contains the declarations for the selection of the
+*              band (2.4 GHz or 5 GHz) of a dual-band network by predicted
+*              throughput and TWT support.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef BAND_SELECT_H_
+#define BAND_SELECT_H_
+
+#include "cy_result.h"
+
+/* Wi-Fi connection manager header file. */
+#include "cy_wcm.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* SSIDs whose decision is kept */
+#define BAND_SELECT_CACHE_ENTRIES       (4u)
+
+/* Predicted throughputs closer than this count as similar; 5 GHz is then
+ * chosen as the less crowded band */
+#define BAND_SELECT_MARGIN_PCT          (10u)
+
+/* Throughput the only band offering TWT must predict to be chosen for it */
+#define BAND_SELECT_TWT_MIN_KBPS        (1000u)
+
+/* Probe: settle time after the join, then a UDP burst of BAND_SELECT_BURST
+ * packets every BAND_SELECT_INTERVAL_MS, echoed by a tgen sink */
+#define BAND_SELECT_SETTLE_MS           (1000u)
+#define BAND_SELECT_BURST               (16u)
+#define BAND_SELECT_INTERVAL_MS         (20u)
+#define BAND_SELECT_SIZE                (1400u)
+#define BAND_SELECT_COUNT               (160u)
+
+/* Probe with an iTWT profile: wait for the Accept (or the Reject) of the
+ * agreement after the settle time */
+#define BAND_SELECT_TWT_ACCEPT_MS       (2000u)
+#define BAND_SELECT_TWT_POLL_MS         (10u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    BAND_SELECT_2_4GHZ = 0,
+    BAND_SELECT_5GHZ,
+    BAND_SELECT_BANDS
+} band_select_band_t;
+
+typedef enum
+{
+    BAND_SELECT_ONLY_BAND = 0,  /* The network has BSSIDs on one band only */
+    BAND_SELECT_TWT,            /* Only this band offers TWT, and enough throughput */
+    BAND_SELECT_THROUGHPUT,     /* Higher predicted throughput */
+    BAND_SELECT_SIMILAR,        /* Similar predicted throughputs */
+    BAND_SELECT_REASONS
+} band_select_reason_t;
+
+typedef struct
+{
+    bool     present;           /* The network has a BSSID on this band */
+    uint8_t  bssid[6];          /* Strongest BSSID of the band */
+    uint8_t  channel;
+    int32_t  rssi_dbm;
+    bool     twt;               /* TWT responder, from the beacon IEs */
+    bool     twt_accepted;      /* Agreement accepted by the BSSID when probed */
+    uint32_t rate_kbps;         /* TX rate when probed, else from the link model */
+    bool     probed;            /* Joined and measured with a UDP burst */
+    uint32_t sent;
+    uint32_t received;
+    uint32_t measured_kbps;     /* Burst throughput, echoes included */
+    uint32_t predicted_kbps;
+} band_select_probe_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+band_select_band_t band_select_decide(band_select_probe_t probes[BAND_SELECT_BANDS], bool want_twt,
+                                      band_select_reason_t *reason);
+cy_wcm_wifi_band_t band_select_band(const char *ssid, bool want_twt);
+cy_rslt_t band_select_add_commands(void);
+
+#endif /* BAND_SELECT_H_ */
+
+/* [] END OF FILE */
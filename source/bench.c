@@ -0,0 +1,341 @@
+/******************************************************************************
+* File Name:   bench.c
+*
+* Description: This file implements the microbenchmark harness. Benchmarks are
+*              registered in tables, run with warmup and repetitions, and
+*              reported as min/median/percentiles in cycles of the cycle
+*              counter.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "command_console.h"
+#include "bench.h"
+#include "cycle_counter.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define BENCH_CALIBRATION_REPS          (32u)
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int bench_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const bench_case_t *bench_tables[BENCH_MAX_TABLES];
+static uint32_t bench_table_count;
+static uint32_t bench_samples[BENCH_MAX_REPS];
+
+#define BENCH_COMMANDS \
+    { (char *) "bench", bench_command, 0, NULL, NULL, (char *) "[all|<name>] [reps]", (char *) "Run microbenchmarks, or list them when no name is given" }, \
+
+const cy_command_console_cmd_t bench_commands_table[] =
+{
+    BENCH_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: bench_add_table
+********************************************************************************
+* Summary:
+* This function registers a table of benchmarks terminated by BENCH_TABLE_END.
+*
+* Parameters:
+*  const bench_case_t *table : table to register
+*
+* Return:
+*  cy_rslt_t : CY_RSLT_SUCCESS, or -1 if too many tables are registered
+*
+*******************************************************************************/
+cy_rslt_t bench_add_table(const bench_case_t *table)
+{
+    if(bench_table_count >= BENCH_MAX_TABLES)
+    {
+        return (cy_rslt_t)-1;
+    }
+
+    bench_tables[bench_table_count++] = table;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: bench_compare
+********************************************************************************
+* Summary:
+* qsort() comparator for cycle samples.
+*
+*******************************************************************************/
+static int bench_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+/*******************************************************************************
+* Function Name: bench_overhead
+********************************************************************************
+* Summary:
+* This function measures the cost of two back-to-back cycle counter reads,
+* which is subtracted from every sample.
+*
+*******************************************************************************/
+static uint32_t bench_overhead(void)
+{
+    uint32_t overhead = UINT32_MAX;
+
+    for(uint32_t i = 0; i < BENCH_CALIBRATION_REPS; i++)
+    {
+        uint32_t start = cycle_counter_get();
+        uint32_t delta = cycle_counter_get() - start;
+        if(delta < overhead)
+        {
+            overhead = delta;
+        }
+    }
+
+    return overhead;
+}
+
+
+/*******************************************************************************
+* Function Name: bench_run
+********************************************************************************
+* Summary:
+* This function runs one benchmark: 'warmup' untimed iterations followed by
+* 'reps' timed iterations. Interrupts stay enabled, so outliers are expected
+* and the median is the figure to compare.
+*
+* Parameters:
+*  const bench_case_t *bench : benchmark to run
+*  uint32_t warmup           : number of untimed iterations
+*  uint32_t reps             : number of timed iterations (max BENCH_MAX_REPS)
+*  bench_result_t *result    : statistics in cycles
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t bench_run(const bench_case_t *bench, uint32_t warmup, uint32_t reps, bench_result_t *result)
+{
+    uint32_t overhead;
+    uint64_t sum = 0;
+
+    if((reps == 0u) || (reps > BENCH_MAX_REPS))
+    {
+        return (cy_rslt_t)-1;
+    }
+
+    cycle_counter_init();
+    overhead = bench_overhead();
+
+    for(uint32_t i = 0; i < warmup + reps; i++)
+    {
+        uint32_t start;
+        uint32_t delta;
+
+        if(bench->setup != NULL)
+        {
+            bench->setup(bench->arg);
+        }
+
+        start = cycle_counter_get();
+        bench->run(bench->arg);
+        delta = cycle_counter_get() - start;
+
+        if(bench->teardown != NULL)
+        {
+            bench->teardown(bench->arg);
+        }
+
+        if(i >= warmup)
+        {
+            delta = (delta > overhead) ? (delta - overhead) : 0u;
+            bench_samples[i - warmup] = delta;
+            sum += delta;
+        }
+    }
+
+    qsort(bench_samples, reps, sizeof(bench_samples[0]), bench_compare);
+
+    result->reps   = reps;
+    result->min    = bench_samples[0];
+    result->median = bench_samples[reps / 2u];
+    result->p90    = bench_samples[(reps * 90u) / 100u];
+    result->p99    = bench_samples[(reps * 99u) / 100u];
+    result->max    = bench_samples[reps - 1u];
+    result->mean   = (uint32_t)(sum / reps);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: bench_report
+********************************************************************************
+* Summary:
+* This function runs a benchmark and prints one line of results.
+*
+*******************************************************************************/
+static void bench_report(const bench_case_t *bench, uint32_t reps)
+{
+    bench_result_t result;
+
+    if(bench_run(bench, BENCH_DEFAULT_WARMUP, reps, &result) != CY_RSLT_SUCCESS)
+    {
+        printf("%-24s failed\n", bench->name);
+        return;
+    }
+
+    printf("%-24s %5" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 "\n",
+           bench->name, result.reps, result.min, result.median, result.p90, result.p99,
+           result.max, (uint32_t)cycle_counter_to_ns(result.median));
+}
+
+
+/*******************************************************************************
+* Function Name: bench_command
+********************************************************************************
+* Summary:
+* This function lists the registered benchmarks, or runs all of them or the
+* one given by name.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int bench_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint32_t reps = BENCH_DEFAULT_REPS;
+    bool found = false;
+
+    if(argc < 2)
+    {
+        printf("Registered benchmarks:\n");
+        for(uint32_t t = 0; t < bench_table_count; t++)
+        {
+            for(const bench_case_t *bench = bench_tables[t]; bench->name != NULL; bench++)
+            {
+                printf("  %s\n", bench->name);
+            }
+        }
+        return 0;
+    }
+
+    if(argc > 2)
+    {
+        reps = (uint32_t)strtoul(argv[2], NULL, 0);
+        if((reps == 0u) || (reps > BENCH_MAX_REPS))
+        {
+            printf("Repetitions must be between 1 and %u\n", (unsigned)BENCH_MAX_REPS);
+            return -1;
+        }
+    }
+
+    printf("%-24s %5s %8s %8s %8s %8s %8s %8s\n",
+           "benchmark", "reps", "min", "median", "p90", "p99", "max", "med(ns)");
+
+    for(uint32_t t = 0; t < bench_table_count; t++)
+    {
+        for(const bench_case_t *bench = bench_tables[t]; bench->name != NULL; bench++)
+        {
+            if(!strcmp(argv[1], "all") || !strcmp(argv[1], bench->name))
+            {
+                bench_report(bench, reps);
+                found = true;
+            }
+        }
+    }
+
+    if(!found)
+    {
+        printf("Unknown benchmark '%s'\n", argv[1]);
+        return -1;
+    }
+
+    printf("Cycles at %" PRIu32 " Hz\n", (uint32_t)CYCLE_COUNTER_HZ);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: bench_add_commands
+********************************************************************************
+* Summary:
+* This function registers the built-in benchmarks and the bench commands table.
+*
+*******************************************************************************/
+cy_rslt_t bench_add_commands(void)
+{
+    cy_rslt_t result = bench_cases_init();
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    return cy_command_console_add_table(bench_commands_table);
+}
+
+
+/* [] END OF FILE */
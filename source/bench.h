@@ -0,0 +1,103 @@
+/******************************************************************************
+* File Name:   bench.h
+*
+* Description: This file contains the declarations for the cycle-accurate
+*              microbenchmark harness.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include "cy_result.h"
+
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define BENCH_DEFAULT_WARMUP            (8u)
+#define BENCH_DEFAULT_REPS              (100u)
+#define BENCH_MAX_REPS                  (256u)
+#define BENCH_MAX_TABLES                (8u)
+
+/* Registers a benchmark in a table; setup and teardown may be NULL and run
+ * outside of the measured region. */
+#define BENCH_CASE(name, setup, run, teardown, arg) \
+    { (const char *)(name), (setup), (run), (teardown), (void *)(arg) },
+
+#define BENCH_TABLE_END { NULL, NULL, NULL, NULL, NULL }
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef void (*bench_fn_t)(void *arg);
+
+typedef struct
+{
+    const char *name;
+    bench_fn_t  setup;
+    bench_fn_t  run;
+    bench_fn_t  teardown;
+    void       *arg;
+} bench_case_t;
+
+typedef struct
+{
+    uint32_t reps;
+    uint32_t min;
+    uint32_t median;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+    uint32_t mean;
+} bench_result_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t bench_add_table(const bench_case_t *table);
+cy_rslt_t bench_run(const bench_case_t *bench, uint32_t warmup, uint32_t reps, bench_result_t *result);
+cy_rslt_t bench_add_commands(void);
+cy_rslt_t bench_cases_init(void);
+
+#endif /* BENCH_H_ */
+
+/* [] END OF FILE */
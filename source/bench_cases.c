@@ -0,0 +1,214 @@
+/******************************************************************************
+* File Name:   bench_cases.c
+*
+* Description: This file contains the built-in microbenchmarks for hot
+*              functions of the application.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "command_console.h"
+#include "bench.h"
+
+/* Network buffer header file. */
+#include "cy_network_buffer.h"
+
+/* Standard C header files. */
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define BENCH_IP_STR_LEN                (16)
+#define BENCH_LINE_LEN                  (85)
+#define BENCH_MAX_ARGS                  (32)
+#define BENCH_PACKET_SIZE               (1500u)
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Defined in main.c */
+void get_ip_string(char* buffer, uint32_t ip);
+
+static void bench_get_ip_string(void *arg);
+static void bench_cmd_tokenize_lookup(void *arg);
+static void bench_packet_alloc_free(void *arg);
+static void bench_log_snprintf(void *arg);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Command tables searched by the command lookup benchmark */
+extern const cy_command_console_cmd_t itwt_commands_table[];
+extern const cy_command_console_cmd_t warm_boot_commands_table[];
+extern const cy_command_console_cmd_t bench_commands_table[];
+
+static const cy_command_console_cmd_t *bench_console_tables[] =
+{
+    itwt_commands_table,
+    warm_boot_commands_table,
+    bench_commands_table,
+};
+
+static volatile uint32_t bench_sink;
+
+static const bench_case_t bench_cases_table[] =
+{
+    BENCH_CASE("get_ip_string", NULL, bench_get_ip_string, NULL, NULL)
+    BENCH_CASE("cmd_tokenize_lookup", NULL, bench_cmd_tokenize_lookup, NULL, "bench all 100")
+    BENCH_CASE("pkt_pool_alloc_free", NULL, bench_packet_alloc_free, NULL, NULL)
+    BENCH_CASE("log_snprintf", NULL, bench_log_snprintf, NULL, NULL)
+    BENCH_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: bench_get_ip_string
+********************************************************************************
+* Summary:
+* Formats an IPv4 address as printed after every connection.
+*
+*******************************************************************************/
+static void bench_get_ip_string(void *arg)
+{
+    char ipstr[BENCH_IP_STR_LEN];
+
+    get_ip_string(ipstr, 0x6401A8C0UL); /* 192.168.1.100 */
+    bench_sink = (uint32_t)ipstr[0];
+}
+
+
+/*******************************************************************************
+* Function Name: bench_cmd_tokenize_lookup
+********************************************************************************
+* Summary:
+* Tokenizes a command line with strtok_r() and looks the command up in the
+* application command tables. This is a model of the work the command console
+* library does before calling a handler, not its own code, which is not
+* callable from the application; its input handling and the handler are not
+* measured.
+*
+*******************************************************************************/
+static void bench_cmd_tokenize_lookup(void *arg)
+{
+    char line[BENCH_LINE_LEN];
+    char *argv[BENCH_MAX_ARGS];
+    char *save = NULL;
+    int argc = 0;
+
+    strncpy(line, (const char *)arg, sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+
+    for(char *tok = strtok_r(line, " ", &save); (tok != NULL) && (argc < BENCH_MAX_ARGS);
+        tok = strtok_r(NULL, " ", &save))
+    {
+        argv[argc++] = tok;
+    }
+
+    if(argc == 0)
+    {
+        return;
+    }
+
+    for(size_t t = 0; t < sizeof(bench_console_tables) / sizeof(bench_console_tables[0]); t++)
+    {
+        for(const cy_command_console_cmd_t *cmd = bench_console_tables[t]; cmd->name != NULL; cmd++)
+        {
+            if(!strcmp(cmd->name, argv[0]))
+            {
+                bench_sink = (uint32_t)cmd->arg_count;
+                return;
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: bench_packet_alloc_free
+********************************************************************************
+* Summary:
+* Allocates a full-size packet from the TX packet pool and releases it.
+*
+*******************************************************************************/
+static void bench_packet_alloc_free(void *arg)
+{
+    whd_buffer_t buffer;
+
+    if(cy_host_buffer_get(&buffer, WHD_NETWORK_TX, BENCH_PACKET_SIZE, 0) == WHD_SUCCESS)
+    {
+        cy_buffer_release(buffer, WHD_NETWORK_TX);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: bench_log_snprintf
+********************************************************************************
+* Summary:
+* Formats a typical log line with snprintf(). Only the formatting is
+* measured; printf() additionally goes through the stdio buffer and _write()
+* to the UART, which is bound by the baud rate rather than by the CPU.
+*
+*******************************************************************************/
+static void bench_log_snprintf(void *arg)
+{
+    char line[BENCH_LINE_LEN];
+
+    bench_sink = (uint32_t)snprintf(line, sizeof(line), "[%lu] %s: rssi %d dBm, ip %s\n",
+                                    123456UL, "wcm", -52, "192.168.1.100");
+}
+
+
+/*******************************************************************************
+* Function Name: bench_cases_init
+********************************************************************************
+* Summary:
+* This function registers the built-in benchmarks.
+*
+*******************************************************************************/
+cy_rslt_t bench_cases_init(void)
+{
+    return bench_add_table(bench_cases_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1017 @@
+/******************************************************************************
+* File Name:   coap_client.c
+*
+* Description: This file implements a CoAP (RFC 7252) client over UDP with
+*              block-wise transfers (RFC 7959). The standard retransmission
+*              timer (2 to 3 s, doubled on each retransmission) ignores the
+*              iTWT schedule. While an agreement is active:
+*              - the ACK timeout covers at least two wake intervals plus the
+*                wake duration, as the response may only arrive in the next
+*                SP,
+*              - an expired retransmission waits for the start of the next SP,
+*                still listening for a late response,
+*              - blocks are sized so that one block fits in the wake duration
+*                at the current PHY rate.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "cy_secure_sockets.h"
+#include "coap_client.h"
+#include "cycle_counter.h"
+#include "lock_prof.h"
+#include "socket_init.h"
+#include "twt_session.h"
+#include "whd_prof.h"
+#include "whd_wlioctl.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define COAP_CLIENT_MESSAGE_LEN         (1024u + 128u)
+#define COAP_CLIENT_TOKEN_LEN           (4u)
+#define COAP_MAX_TOKEN_LEN              (8u)
+#define COAP_CLIENT_VERSION             (1u)
+
+/* Wait for a separate response after an empty ACK (EXCHANGE_LIFETIME is far
+ * longer; a few ACK timeouts are enough in practice) */
+#define COAP_CLIENT_SEPARATE_WAIT_MS    (4u * COAP_CLIENT_ACK_TIMEOUT_MS)
+
+/* Message types */
+#define COAP_TYPE_CON                   (0u)
+#define COAP_TYPE_NON                   (1u)
+#define COAP_TYPE_ACK                   (2u)
+#define COAP_TYPE_RST                   (3u)
+
+/* Codes (class << 5 | detail) */
+#define COAP_CODE_EMPTY                 (0x00u)
+#define COAP_CODE_GET                   (0x01u)
+#define COAP_CODE_PUT                   (0x03u)
+#define COAP_CODE_CONTINUE              (0x5Fu)  /* 2.31 */
+#define COAP_CODE_CLASS(code)           ((code) >> 5)
+#define COAP_CLASS_SUCCESS              (2u)
+
+/* Option numbers */
+#define COAP_OPTION_URI_PATH            (11u)
+#define COAP_OPTION_BLOCK2              (23u)
+#define COAP_OPTION_BLOCK1              (27u)
+
+#define COAP_BLOCK_MORE                 (0x08u)
+#define COAP_BLOCK_SIZE(szx)            (16u << (szx))
+
+#define COAP_CLIENT_ERROR               ((cy_rslt_t)-1)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint8_t        type;
+    uint8_t        code;
+    uint16_t       message_id;
+    uint8_t        token_length;
+    const uint8_t *token;
+    bool           has_block1;
+    uint32_t       block1;
+    bool           has_block2;
+    uint32_t       block2;
+    const uint8_t *payload;
+    uint32_t       payload_length;
+} coap_message_t;
+
+typedef enum
+{
+    COAP_WAIT_TIMEOUT = 0,
+    COAP_WAIT_RESPONSE,
+    COAP_WAIT_RESET
+} coap_wait_result_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int coap_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern whd_interface_t whd_ifs[2];
+
+static uint8_t coap_tx_buffer[COAP_CLIENT_MESSAGE_LEN];
+static uint8_t coap_rx_buffer[COAP_CLIENT_MESSAGE_LEN];
+static uint16_t coap_message_id;
+static uint32_t coap_token;
+static coap_client_stats_t coap_stats;
+static cy_mutex_t coap_mutex;
+static bool coap_initialized;
+
+#define COAP_COMMANDS \
+    { (char *) "coap", coap_command, 1, NULL, NULL, (char *) "<get <host> <path> [port]|put <host> <path> <bytes> [port]|stats [reset]>", (char *) "CoAP client with iTWT-aware retransmissions and block sizes" }, \
+
+const cy_command_console_cmd_t coap_commands_table[] =
+{
+    COAP_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: coap_client_block_szx
+********************************************************************************
+* Summary:
+* This function returns the largest block size exponent (block size
+* 16 << szx) whose block fits in COAP_CLIENT_SP_EFFICIENCY_PCT of what the PHY
+* rate can carry in the wake duration.
+*
+* Parameters:
+*  uint32_t rate_kbps        : PHY rate, 0 if unknown
+*  uint32_t wake_duration_us : wake duration, 0 without iTWT
+*
+* Return:
+*  uint8_t : block size exponent, 0 to COAP_CLIENT_MAX_SZX
+*
+*******************************************************************************/
+uint8_t coap_client_block_szx(uint32_t rate_kbps, uint32_t wake_duration_us)
+{
+    uint64_t budget;
+    uint8_t szx = COAP_CLIENT_MAX_SZX;
+
+    if((rate_kbps == 0u) || (wake_duration_us == 0u))
+    {
+        return COAP_CLIENT_MAX_SZX;
+    }
+
+    /* kbit/s * us / 8000 = bytes */
+    budget = ((uint64_t)rate_kbps * wake_duration_us * COAP_CLIENT_SP_EFFICIENCY_PCT) / (8000u * 100u);
+
+    while((szx > 0u) && (COAP_BLOCK_SIZE(szx) > budget))
+    {
+        szx--;
+    }
+
+    return szx;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_client_ack_timeout_ms
+********************************************************************************
+* Summary:
+* This function returns the initial ACK timeout: ACK_TIMEOUT, or two wake
+* intervals plus the wake duration if that is longer.
+*
+*******************************************************************************/
+uint32_t coap_client_ack_timeout_ms(uint32_t wake_interval_us, uint32_t wake_duration_us)
+{
+    uint32_t twt_ms = ((2u * wake_interval_us) + wake_duration_us) / 1000u;
+
+    return (twt_ms > COAP_CLIENT_ACK_TIMEOUT_MS) ? twt_ms : COAP_CLIENT_ACK_TIMEOUT_MS;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_put_option
+********************************************************************************
+* Summary:
+* This function appends an option. Options must be added in increasing
+* number order.
+*
+*******************************************************************************/
+static uint32_t coap_put_option(uint8_t *buffer, uint32_t offset, uint16_t *last_number, uint16_t number,
+                                const uint8_t *value, uint32_t length)
+{
+    uint32_t delta = number - *last_number;
+    uint32_t header = offset++;
+    uint8_t nibbles[2];
+    uint32_t fields[2] = { delta, length };
+
+    for(uint32_t i = 0; i < 2u; i++)
+    {
+        if(fields[i] < 13u)
+        {
+            nibbles[i] = (uint8_t)fields[i];
+        }
+        else if(fields[i] < 269u)
+        {
+            nibbles[i] = 13u;
+            buffer[offset++] = (uint8_t)(fields[i] - 13u);
+        }
+        else
+        {
+            nibbles[i] = 14u;
+            buffer[offset++] = (uint8_t)((fields[i] - 269u) >> 8);
+            buffer[offset++] = (uint8_t)(fields[i] - 269u);
+        }
+    }
+    buffer[header] = (uint8_t)((nibbles[0] << 4) | nibbles[1]);
+
+    memcpy(&buffer[offset], value, length);
+    *last_number = number;
+
+    return offset + length;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_put_uint_option
+********************************************************************************
+* Summary:
+* This function appends an option holding an unsigned integer in the fewest
+* bytes.
+*
+*******************************************************************************/
+static uint32_t coap_put_uint_option(uint8_t *buffer, uint32_t offset, uint16_t *last_number, uint16_t number,
+                                     uint32_t value)
+{
+    uint8_t bytes[4];
+    uint32_t length = 0;
+
+    for(int32_t shift = 24; shift >= 0; shift -= 8)
+    {
+        if((length != 0u) || ((value >> shift) != 0u))
+        {
+            bytes[length++] = (uint8_t)(value >> shift);
+        }
+    }
+
+    return coap_put_option(buffer, offset, last_number, number, bytes, length);
+}
+
+
+/*******************************************************************************
+* Function Name: coap_build_request
+********************************************************************************
+* Summary:
+* This function builds a confirmable request with the Uri-Path options of
+* 'path', a block option and a payload, and returns its length.
+*
+*******************************************************************************/
+static uint32_t coap_build_request(uint8_t code, const char *path, uint16_t block_option, uint32_t block_value,
+                                   const uint8_t *payload, uint32_t payload_length)
+{
+    uint16_t last_number = 0;
+    uint32_t offset = 0;
+    const char *segment = path;
+
+    coap_message_id++;
+    coap_token++;
+
+    coap_tx_buffer[offset++] = (uint8_t)((COAP_CLIENT_VERSION << 6) | (COAP_TYPE_CON << 4) | COAP_CLIENT_TOKEN_LEN);
+    coap_tx_buffer[offset++] = code;
+    coap_tx_buffer[offset++] = (uint8_t)(coap_message_id >> 8);
+    coap_tx_buffer[offset++] = (uint8_t)coap_message_id;
+    memcpy(&coap_tx_buffer[offset], &coap_token, COAP_CLIENT_TOKEN_LEN);
+    offset += COAP_CLIENT_TOKEN_LEN;
+
+    while(*segment != '\0')
+    {
+        const char *end;
+
+        while(*segment == '/')
+        {
+            segment++;
+        }
+        end = segment;
+        while((*end != '\0') && (*end != '/'))
+        {
+            end++;
+        }
+        if(end != segment)
+        {
+            offset = coap_put_option(coap_tx_buffer, offset, &last_number, COAP_OPTION_URI_PATH,
+                                     (const uint8_t *)segment, (uint32_t)(end - segment));
+        }
+        segment = end;
+    }
+
+    offset = coap_put_uint_option(coap_tx_buffer, offset, &last_number, block_option, block_value);
+
+    if(payload_length != 0u)
+    {
+        coap_tx_buffer[offset++] = 0xFFu;
+        memcpy(&coap_tx_buffer[offset], payload, payload_length);
+        offset += payload_length;
+    }
+
+    return offset;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_parse
+********************************************************************************
+* Summary:
+* This function parses a received message. Messages with a reserved token
+* length (9 to 15), an option or payload marker running past the end of the
+* datagram, or an empty payload after the marker are rejected (RFC 7252,
+* section 3).
+*
+*******************************************************************************/
+static bool coap_parse(const uint8_t *buffer, uint32_t length, coap_message_t *message)
+{
+    uint32_t offset = 4;
+    uint32_t number = 0;
+
+    memset(message, 0, sizeof(*message));
+
+    if((length < 4u) || ((buffer[0] >> 6) != COAP_CLIENT_VERSION))
+    {
+        return false;
+    }
+
+    message->type = (buffer[0] >> 4) & 0x03u;
+    message->token_length = buffer[0] & 0x0Fu;
+    message->code = buffer[1];
+    message->message_id = (uint16_t)((buffer[2] << 8) | buffer[3]);
+    message->token = &buffer[offset];
+    offset += message->token_length;
+
+    if((message->token_length > COAP_MAX_TOKEN_LEN) || (offset > length))
+    {
+        return false;
+    }
+
+    while(offset < length)
+    {
+        uint32_t fields[2];
+        uint32_t value = 0;
+
+        if(buffer[offset] == 0xFFu)
+        {
+            if(offset + 1u == length)
+            {
+                return false;
+            }
+            message->payload = &buffer[offset + 1u];
+            message->payload_length = length - offset - 1u;
+            return true;
+        }
+
+        fields[0] = buffer[offset] >> 4;
+        fields[1] = buffer[offset] & 0x0Fu;
+        offset++;
+
+        for(uint32_t i = 0; i < 2u; i++)
+        {
+            if(((fields[i] == 13u) && (offset + 1u > length)) || ((fields[i] == 14u) && (offset + 2u > length)))
+            {
+                return false;
+            }
+
+            if(fields[i] == 13u)
+            {
+                fields[i] = 13u + buffer[offset++];
+            }
+            else if(fields[i] == 14u)
+            {
+                fields[i] = 269u + (((uint32_t)buffer[offset] << 8) | buffer[offset + 1u]);
+                offset += 2u;
+            }
+            else if(fields[i] == 15u)
+            {
+                return false;
+            }
+        }
+
+        if(offset + fields[1] > length)
+        {
+            return false;
+        }
+
+        number += fields[0];
+        for(uint32_t i = 0; (i < fields[1]) && (i < 4u); i++)
+        {
+            value = (value << 8) | buffer[offset + i];
+        }
+
+        if(number == COAP_OPTION_BLOCK1)
+        {
+            message->has_block1 = true;
+            message->block1 = value;
+        }
+        else if(number == COAP_OPTION_BLOCK2)
+        {
+            message->has_block2 = true;
+            message->block2 = value;
+        }
+
+        offset += fields[1];
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_wait
+********************************************************************************
+* Summary:
+* This function waits up to 'wait_ms' for the response to the request in the
+* transmit buffer. An empty ACK is noted, and a confirmable separate response
+* is acknowledged.
+*
+*******************************************************************************/
+static coap_wait_result_t coap_wait(cy_socket_t socket, uint32_t wait_ms, coap_message_t *response, bool *acked)
+{
+    uint16_t message_id = (uint16_t)((coap_tx_buffer[2] << 8) | coap_tx_buffer[3]);
+    cy_time_t start;
+    cy_time_t now;
+
+    cy_rtos_get_time(&start);
+    now = start;
+
+    while((uint32_t)(now - start) < wait_ms)
+    {
+        uint32_t timeout = wait_ms - (uint32_t)(now - start);
+        uint32_t received = 0;
+        cy_socket_sockaddr_t peer;
+        uint32_t peer_length = sizeof(peer);
+
+        cy_socket_setsockopt(socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        if((cy_socket_recvfrom(socket, coap_rx_buffer, sizeof(coap_rx_buffer), CY_SOCKET_FLAGS_NONE,
+                               &peer, &peer_length, &received) == CY_RSLT_SUCCESS) &&
+           coap_parse(coap_rx_buffer, received, response))
+        {
+            bool own_id = (response->message_id == message_id);
+            bool own_token = (response->token_length == COAP_CLIENT_TOKEN_LEN) &&
+                             !memcmp(response->token, &coap_tx_buffer[4], COAP_CLIENT_TOKEN_LEN);
+
+            if(own_id && (response->type == COAP_TYPE_RST))
+            {
+                return COAP_WAIT_RESET;
+            }
+            if(own_id && (response->type == COAP_TYPE_ACK) && (response->code == COAP_CODE_EMPTY))
+            {
+                *acked = true;
+            }
+            else if(own_token && (response->code != COAP_CODE_EMPTY))
+            {
+                if(response->type == COAP_TYPE_CON)
+                {
+                    uint8_t ack[4] = { (uint8_t)((COAP_CLIENT_VERSION << 6) | (COAP_TYPE_ACK << 4)), COAP_CODE_EMPTY,
+                                       (uint8_t)(response->message_id >> 8), (uint8_t)response->message_id };
+                    uint32_t sent = 0;
+
+                    cy_socket_sendto(socket, ack, sizeof(ack), CY_SOCKET_FLAGS_NONE, &peer, peer_length, &sent);
+                }
+                return COAP_WAIT_RESPONSE;
+            }
+        }
+
+        cy_rtos_get_time(&now);
+    }
+
+    return COAP_WAIT_TIMEOUT;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_exchange
+********************************************************************************
+* Summary:
+* This function sends the confirmable request in the transmit buffer and
+* retransmits it with exponential back-off until a response arrives. While an
+* iTWT agreement is active, a retransmission that falls between SPs is held
+* until the next SP starts.
+*
+*******************************************************************************/
+static cy_rslt_t coap_exchange(cy_socket_t socket, const cy_socket_sockaddr_t *server, uint32_t length,
+                               coap_message_t *response)
+{
+    twt_session_agreement_t agreement;
+    uint32_t timeout;
+    bool acked = false;
+    cy_time_t start;
+    cy_time_t end;
+    coap_wait_result_t wait = COAP_WAIT_TIMEOUT;
+
+    twt_session_get(&agreement);
+    timeout = agreement.active ? coap_client_ack_timeout_ms(twt_session_wake_interval_us(&agreement),
+                                                            twt_session_wake_duration_us(&agreement))
+                               : COAP_CLIENT_ACK_TIMEOUT_MS;
+
+    /* ACK_RANDOM_FACTOR of 1.5 */
+    timeout += (cycle_counter_get() % (timeout / 2u + 1u));
+
+    coap_stats.requests++;
+    cy_rtos_get_time(&start);
+
+    for(uint32_t attempt = 0; attempt <= COAP_CLIENT_MAX_RETRANSMIT; attempt++)
+    {
+        uint32_t sent = 0;
+
+        if(attempt != 0u)
+        {
+            coap_stats.retransmits++;
+        }
+
+        if(cy_socket_sendto(socket, coap_tx_buffer, length, CY_SOCKET_FLAGS_NONE, server,
+                            sizeof(*server), &sent) != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+
+        wait = coap_wait(socket, timeout, response, &acked);
+        if((wait == COAP_WAIT_TIMEOUT) && acked)
+        {
+            /* The server acknowledged the request; the response comes separately */
+            wait = coap_wait(socket, COAP_CLIENT_SEPARATE_WAIT_MS, response, &acked);
+            break;
+        }
+        if((wait != COAP_WAIT_TIMEOUT) || (attempt == COAP_CLIENT_MAX_RETRANSMIT))
+        {
+            break;
+        }
+
+        timeout *= 2u;
+
+        if(twt_session_is_active() && !twt_session_in_sp())
+        {
+            uint32_t to_sp = twt_session_ms_to_next_sp();
+
+            coap_stats.sp_retransmits++;
+            wait = coap_wait(socket, to_sp, response, &acked);
+            if(wait != COAP_WAIT_TIMEOUT)
+            {
+                break;
+            }
+        }
+    }
+
+    cy_rtos_get_time(&end);
+
+    if(wait != COAP_WAIT_RESPONSE)
+    {
+        coap_stats.failures++;
+        return COAP_CLIENT_ERROR;
+    }
+
+    coap_stats.rtt_ms_total += (uint32_t)(end - start);
+    if((uint32_t)(end - start) > coap_stats.rtt_ms_max)
+    {
+        coap_stats.rtt_ms_max = (uint32_t)(end - start);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_open
+********************************************************************************
+* Summary:
+* This function creates the UDP socket and resolves the server address. It
+* also takes the client mutex, released by coap_close().
+*
+*******************************************************************************/
+static cy_rslt_t coap_open(const char *host, uint16_t port, cy_socket_t *socket, cy_socket_sockaddr_t *server)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if(!coap_initialized)
+    {
+        result = socket_init();
+        if(result == CY_RSLT_SUCCESS)
+        {
+            result = cy_rtos_init_mutex(&coap_mutex);
+        }
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        lock_prof_name(&coap_mutex, "coap");
+        cycle_counter_init();
+        coap_initialized = true;
+    }
+
+    memset(server, 0, sizeof(*server));
+    result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &server->ip_address);
+    server->port = port;
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    lock_prof_get(&coap_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP, socket);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        lock_prof_set(&coap_mutex);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_close
+********************************************************************************
+* Summary:
+* This function deletes the UDP socket and releases the client mutex.
+*
+*******************************************************************************/
+static void coap_close(cy_socket_t socket)
+{
+    cy_socket_delete(socket);
+    lock_prof_set(&coap_mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: coap_initial_szx
+********************************************************************************
+* Summary:
+* This function returns the block size exponent for the agreement in effect.
+*
+*******************************************************************************/
+static uint8_t coap_initial_szx(void)
+{
+    twt_session_agreement_t agreement;
+    uint32_t rate = 0;
+
+    twt_session_get(&agreement);
+    if(!agreement.active)
+    {
+        return COAP_CLIENT_MAX_SZX;
+    }
+
+    /* WLC_GET_RATE reports the current TX rate in units of 500 kbit/s */
+    if(whd_prof_get_ioctl_value(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], WLC_GET_RATE, &rate) != WHD_SUCCESS)
+    {
+        rate = 0;
+    }
+
+    return coap_client_block_szx(rate * 500u, twt_session_wake_duration_us(&agreement));
+}
+
+
+/*******************************************************************************
+* Function Name: coap_client_get
+********************************************************************************
+* Summary:
+* This function reads a resource, in blocks (Block2) if the server sends it in
+* blocks or if it does not fit in one SP.
+*
+* Parameters:
+*  const char *host   : server name or address
+*  uint16_t port      : server port
+*  const char *path   : resource path, e.g. "sensors/temp"
+*  uint8_t *buffer    : buffer for the representation
+*  size_t size        : buffer size; the rest of the representation is dropped
+*  size_t *length     : length of the representation stored
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t coap_client_get(const char *host, uint16_t port, const char *path,
+                          uint8_t *buffer, size_t size, size_t *length)
+{
+    cy_socket_sockaddr_t server;
+    coap_message_t response;
+    cy_socket_t socket;
+    uint8_t szx = coap_initial_szx();
+    uint32_t offset = 0;
+    bool more = true;
+    cy_rslt_t result;
+
+    result = coap_open(host, port, &socket, &server);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    while(more && (result == CY_RSLT_SUCCESS))
+    {
+        uint32_t num = offset / COAP_BLOCK_SIZE(szx);
+        uint32_t request_length = coap_build_request(COAP_CODE_GET, path, COAP_OPTION_BLOCK2, (num << 4) | szx, NULL, 0);
+
+        result = coap_exchange(socket, &server, request_length, &response);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+        if(COAP_CODE_CLASS(response.code) != COAP_CLASS_SUCCESS)
+        {
+            printf("CoAP server responded %u.%02u\n", (unsigned)COAP_CODE_CLASS(response.code), (unsigned)(response.code & 0x1Fu));
+            result = COAP_CLIENT_ERROR;
+            break;
+        }
+
+        if(offset < size)
+        {
+            uint32_t copy = ((offset + response.payload_length) <= size) ? response.payload_length : (uint32_t)(size - offset);
+
+            memcpy(&buffer[offset], response.payload, copy);
+        }
+        offset += response.payload_length;
+        coap_stats.bytes += response.payload_length;
+
+        more = response.has_block2 && ((response.block2 & COAP_BLOCK_MORE) != 0u);
+        if(response.has_block2 && ((response.block2 & 0x07u) < szx))
+        {
+            szx = response.block2 & 0x07u;
+        }
+    }
+
+    coap_stats.last_szx = szx;
+    coap_close(socket);
+
+    *length = (offset < size) ? offset : size;
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_client_put
+********************************************************************************
+* Summary:
+* This function writes a resource in blocks (Block1), each sized to fit in one
+* SP. The server may ask for smaller blocks in its responses.
+*
+* Parameters:
+*  const char *host      : server name or address
+*  uint16_t port         : server port
+*  const char *path      : resource path
+*  const uint8_t *payload: representation
+*  size_t length         : representation length
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t coap_client_put(const char *host, uint16_t port, const char *path,
+                          const uint8_t *payload, size_t length)
+{
+    cy_socket_sockaddr_t server;
+    coap_message_t response;
+    cy_socket_t socket;
+    uint8_t szx = coap_initial_szx();
+    uint32_t offset = 0;
+    cy_rslt_t result;
+
+    result = coap_open(host, port, &socket, &server);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    do
+    {
+        uint32_t block = COAP_BLOCK_SIZE(szx);
+        uint32_t chunk = ((length - offset) < block) ? (uint32_t)(length - offset) : block;
+        bool more = (offset + chunk) < length;
+        uint32_t request_length = coap_build_request(COAP_CODE_PUT, path, COAP_OPTION_BLOCK1,
+                                                     ((offset / block) << 4) | (more ? COAP_BLOCK_MORE : 0u) | szx,
+                                                     &payload[offset], chunk);
+
+        result = coap_exchange(socket, &server, request_length, &response);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+        if(COAP_CODE_CLASS(response.code) != COAP_CLASS_SUCCESS)
+        {
+            printf("CoAP server responded %u.%02u\n", (unsigned)COAP_CODE_CLASS(response.code), (unsigned)(response.code & 0x1Fu));
+            result = COAP_CLIENT_ERROR;
+            break;
+        }
+
+        offset += chunk;
+        coap_stats.bytes += chunk;
+
+        if(response.has_block1 && ((response.block1 & 0x07u) < szx))
+        {
+            szx = response.block1 & 0x07u;
+        }
+    } while(offset < length);
+
+    coap_stats.last_szx = szx;
+    coap_close(socket);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_client_get_stats
+********************************************************************************
+* Summary:
+* This function returns a copy of the client statistics. They are updated
+* with the client mutex held, so the copy waits for a transfer in progress.
+*
+*******************************************************************************/
+void coap_client_get_stats(coap_client_stats_t *stats)
+{
+    if(!coap_initialized)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    lock_prof_get(&coap_mutex, CY_RTOS_NEVER_TIMEOUT);
+    *stats = coap_stats;
+    lock_prof_set(&coap_mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: coap_print_transfer
+********************************************************************************
+* Summary:
+* This function prints the duration and throughput of a transfer, and the
+* block size it ended with, after the server's requests for smaller blocks.
+*
+*******************************************************************************/
+static void coap_print_transfer(const char *what, uint32_t bytes, cy_time_t start, cy_time_t end,
+                                const coap_client_stats_t *before)
+{
+    uint32_t elapsed = (uint32_t)(end - start);
+    coap_client_stats_t after;
+
+    coap_client_get_stats(&after);
+
+    printf("%s %" PRIu32 " bytes in %" PRIu32 " ms (%" PRIu32 " kbit/s), %" PRIu32 " blocks, %" PRIu32 " retransmissions, block size %u\n",
+           what, bytes, elapsed, (elapsed != 0u) ? ((bytes * 8u) / elapsed) : 0u, after.requests - before->requests,
+           after.retransmits - before->retransmits, (unsigned)COAP_BLOCK_SIZE(after.last_szx));
+}
+
+
+/*******************************************************************************
+* Function Name: coap_command
+********************************************************************************
+* Summary:
+* This function handles the "coap" command.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int coap_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    coap_client_stats_t before;
+    cy_time_t start;
+    cy_time_t end;
+    cy_rslt_t result;
+
+    coap_client_get_stats(&before);
+
+    if(!strcmp(argv[1], "get") && (argc > 3))
+    {
+        static uint8_t representation[COAP_CLIENT_MESSAGE_LEN];
+        uint16_t port = (argc > 4) ? (uint16_t)strtoul(argv[4], NULL, 0) : (uint16_t)COAP_CLIENT_DEFAULT_PORT;
+        size_t length = 0;
+
+        cy_rtos_get_time(&start);
+        result = coap_client_get(argv[2], port, argv[3], representation, sizeof(representation) - 1u, &length);
+        cy_rtos_get_time(&end);
+
+        if(result == CY_RSLT_SUCCESS)
+        {
+            representation[length] = '\0';
+            printf("%s\n", (const char *)representation);
+            coap_print_transfer("Received", (uint32_t)length, start, end, &before);
+        }
+    }
+    else if(!strcmp(argv[1], "put") && (argc > 4))
+    {
+        uint16_t port = (argc > 5) ? (uint16_t)strtoul(argv[5], NULL, 0) : (uint16_t)COAP_CLIENT_DEFAULT_PORT;
+        uint32_t bytes = (uint32_t)strtoul(argv[4], NULL, 0);
+        uint8_t *payload;
+
+        if((bytes == 0u) || (bytes > COAP_CLIENT_MAX_UPLOAD))
+        {
+            printf("Size must be between 1 and %u bytes\n", (unsigned)COAP_CLIENT_MAX_UPLOAD);
+            return -1;
+        }
+
+        payload = malloc(bytes);
+        if(payload == NULL)
+        {
+            printf("Out of memory\n");
+            return -1;
+        }
+        for(uint32_t i = 0; i < bytes; i++)
+        {
+            payload[i] = (uint8_t)('a' + (i % 26u));
+        }
+
+        cy_rtos_get_time(&start);
+        result = coap_client_put(argv[2], port, argv[3], payload, bytes);
+        cy_rtos_get_time(&end);
+        free(payload);
+
+        if(result == CY_RSLT_SUCCESS)
+        {
+            coap_print_transfer("Sent", bytes, start, end, &before);
+        }
+    }
+    else if(!strcmp(argv[1], "stats"))
+    {
+        coap_client_stats_t stats;
+
+        if((argc > 2) && !strcmp(argv[2], "reset"))
+        {
+            if(coap_initialized)
+            {
+                lock_prof_get(&coap_mutex, CY_RTOS_NEVER_TIMEOUT);
+                memset(&coap_stats, 0, sizeof(coap_stats));
+                lock_prof_set(&coap_mutex);
+            }
+            return 0;
+        }
+
+        coap_client_get_stats(&stats);
+        printf("Requests           : %" PRIu32 ", %" PRIu32 " failed, %" PRIu32 " payload bytes\n",
+               stats.requests, stats.failures, stats.bytes);
+        printf("Retransmissions    : %" PRIu32 " (%" PRIu32 " held until an SP start)\n",
+               stats.retransmits, stats.sp_retransmits);
+        printf("Response time      : avg %" PRIu32 " ms, max %" PRIu32 " ms\n",
+               (stats.requests > stats.failures) ? (stats.rtt_ms_total / (stats.requests - stats.failures)) : 0u,
+               stats.rtt_ms_max);
+        return 0;
+    }
+    else
+    {
+        printf("Usage: coap <get <host> <path> [port]|put <host> <path> <bytes> [port]|stats [reset]>\n");
+        return -1;
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("coap %s failed: 0x%08" PRIx32 "\n", argv[1], result);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: coap_client_add_commands
+********************************************************************************
+* Summary:
+* This function registers the CoAP commands table.
+*
+*******************************************************************************/
+cy_rslt_t coap_client_add_commands(void)
+{
+    return cy_command_console_add_table(coap_commands_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,104 @@
+/******************************************************************************
+* File Name:   coap_client.h
+*
+* Description: This file contains the declarations for the CoAP client with
+*              retransmissions scheduled on iTWT service periods and block-wise
+*              transfers sized to fit one service period.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef COAP_CLIENT_H_
+#define COAP_CLIENT_H_
+
+#include "cy_result.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define COAP_CLIENT_DEFAULT_PORT        (5683u)
+
+/* Transmission parameters of RFC 7252, section 4.8 */
+#define COAP_CLIENT_ACK_TIMEOUT_MS      (2000u)
+#define COAP_CLIENT_MAX_RETRANSMIT      (4u)
+
+/* Largest block size exponent: 2^(6+4) = 1024 bytes */
+#define COAP_CLIENT_MAX_SZX             (6u)
+
+/* Share of the PHY rate times the wake duration used for one block, leaving
+ * room for MAC overhead and the response */
+#define COAP_CLIENT_SP_EFFICIENCY_PCT   (25u)
+
+/* Largest upload of the "coap put" command */
+#define COAP_CLIENT_MAX_UPLOAD          (16384u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t requests;          /* Confirmable messages, one per block */
+    uint32_t retransmits;
+    uint32_t sp_retransmits;    /* Retransmissions delayed to an SP start */
+    uint32_t failures;
+    uint32_t bytes;             /* Payload bytes transferred */
+    uint32_t rtt_ms_total;      /* Request to response, retransmissions included */
+    uint32_t rtt_ms_max;
+    uint8_t  last_szx;          /* Block size exponent the last transfer ended with */
+} coap_client_stats_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint8_t coap_client_block_szx(uint32_t rate_kbps, uint32_t wake_duration_us);
+uint32_t coap_client_ack_timeout_ms(uint32_t wake_interval_us, uint32_t wake_duration_us);
+
+cy_rslt_t coap_client_get(const char *host, uint16_t port, const char *path,
+                          uint8_t *buffer, size_t size, size_t *length);
+cy_rslt_t coap_client_put(const char *host, uint16_t port, const char *path,
+                          const uint8_t *payload, size_t length);
+void coap_client_get_stats(coap_client_stats_t *stats);
+cy_rslt_t coap_client_add_commands(void);
+
+#endif /* COAP_CLIENT_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,112 @@
+/******************************************************************************
+* File Name:   code_placement.c
+*
+* Description: This file copies the hot code section selected by
+*              tools/section_map.py from its load address in flash to RAM when
+*              the application is built with CODE_PLACEMENT=profile.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "code_placement.h"
+
+#include <string.h>
+
+
+#if defined(APP_CODE_PLACEMENT_PROFILE)
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Defined by the hot_sections.ld linker script fragment */
+extern uint32_t __app_hot_text_start[];
+extern uint32_t __app_hot_text_end[];
+extern uint32_t __app_hot_text_load[];
+
+
+/*******************************************************************************
+* Function Name: code_placement_init
+********************************************************************************
+* Summary:
+* This function copies the hot code to RAM. It runs as a constructor, i.e.
+* after the startup code has initialized .data/.bss and before main(), so that
+* none of the relocated functions is called before it is in place.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+__attribute__((constructor(101))) static void code_placement_init(void)
+{
+    size_t size = (size_t)((uint8_t *)__app_hot_text_end - (uint8_t *)__app_hot_text_start);
+
+    if((size != 0u) && ((void *)__app_hot_text_load != (void *)__app_hot_text_start))
+    {
+        memcpy(__app_hot_text_start, __app_hot_text_load, size);
+        __asm volatile ("dsb\n isb" ::: "memory");
+    }
+}
+#endif /* APP_CODE_PLACEMENT_PROFILE */
+
+
+/*******************************************************************************
+* Function Name: code_placement_hot_size
+********************************************************************************
+* Summary:
+* This function returns the number of code bytes kept in RAM.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t : size of the hot code section, 0 if all code executes from the
+*             region selected by APPEXEC
+*
+*******************************************************************************/
+uint32_t code_placement_hot_size(void)
+{
+#if defined(APP_CODE_PLACEMENT_PROFILE)
+    return (uint32_t)((uint8_t *)__app_hot_text_end - (uint8_t *)__app_hot_text_start);
+#else
+    return 0;
+#endif
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,296 @@
+/******************************************************************************
+* File Name:   cpu_monitor.c
+*
+* Description: This file implements the per-thread CPU utilization monitor.
+*              ThreadX calls the execution change hooks on every context
+*              switch when built with TX_ENABLE_EXECUTION_CHANGE_NOTIFY; the
+*              hooks feed the accounting core in cpu_stats.c and the event
+*              tracer.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "cpu_monitor.h"
+#include "cpu_stats.h"
+#include "cycle_counter.h"
+#include "lock_prof.h"
+#include "trace.h"
+
+/* ThreadX header file. */
+#include "tx_api.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int cpu_monitor_top(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static cpu_stats_t cpu_monitor_stats;
+static cpu_stats_t cpu_monitor_snapshot;
+static volatile bool cpu_monitor_running;
+static cy_timer_t cpu_monitor_timer;
+
+#define CPU_MONITOR_COMMANDS \
+    { (char *) "top", cpu_monitor_top, 0, NULL, NULL, (char *) "[windows]", (char *) "Show per-thread and idle CPU usage over the last windows of 1 s" }, \
+
+const cy_command_console_cmd_t cpu_monitor_commands_table[] =
+{
+    CPU_MONITOR_COMMANDS
+    CMD_TABLE_END
+};
+
+
+#if defined(TX_ENABLE_EXECUTION_CHANGE_NOTIFY)
+/*******************************************************************************
+* Function Name: _tx_execution_thread_enter
+********************************************************************************
+* Summary:
+* Called by the ThreadX scheduler right after a thread is switched in.
+*
+*******************************************************************************/
+void _tx_execution_thread_enter(void)
+{
+    TX_THREAD *thread = tx_thread_identify();
+
+    trace_record(TRACE_EVT_THREAD_ENTER, 0, (uint32_t)(uintptr_t)thread);
+    lock_prof_thread_switch(thread);
+
+    if(cpu_monitor_running)
+    {
+        cpu_stats_switch(&cpu_monitor_stats, cycle_counter_get(), (uintptr_t)thread,
+                         (thread != NULL) ? thread->tx_thread_name : NULL);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: _tx_execution_thread_exit
+********************************************************************************
+* Summary:
+* Called by the ThreadX scheduler when a thread is switched out. Until the next
+* thread is switched in, the CPU is idle.
+*
+*******************************************************************************/
+void _tx_execution_thread_exit(void)
+{
+    trace_record(TRACE_EVT_THREAD_EXIT, 0, (uint32_t)(uintptr_t)tx_thread_identify());
+
+    if(cpu_monitor_running)
+    {
+        cpu_stats_switch(&cpu_monitor_stats, cycle_counter_get(), CPU_STATS_IDLE_ID, NULL);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: _tx_execution_isr_enter / _tx_execution_isr_exit
+********************************************************************************
+* Summary:
+* Called on ISR entry and exit by ports and ISRs that support it.
+*
+*******************************************************************************/
+void _tx_execution_isr_enter(void)
+{
+    trace_record(TRACE_EVT_ISR_ENTER, (uint16_t)(__get_IPSR() & 0x1FFu), 0);
+
+    if(cpu_monitor_running)
+    {
+        cpu_stats_isr_enter(&cpu_monitor_stats, cycle_counter_get());
+    }
+}
+
+void _tx_execution_isr_exit(void)
+{
+    trace_record(TRACE_EVT_ISR_EXIT, (uint16_t)(__get_IPSR() & 0x1FFu), 0);
+
+    if(cpu_monitor_running)
+    {
+        cpu_stats_isr_exit(&cpu_monitor_stats, cycle_counter_get());
+    }
+}
+#endif /* TX_ENABLE_EXECUTION_CHANGE_NOTIFY */
+
+
+/*******************************************************************************
+* Function Name: cpu_monitor_timer_handler
+********************************************************************************
+* Summary:
+* This function closes accounting windows while no context switch happens.
+*
+*******************************************************************************/
+static void cpu_monitor_timer_handler(cy_timer_callback_arg_t arg)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    cpu_stats_update(&cpu_monitor_stats, cycle_counter_get());
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_monitor_init
+********************************************************************************
+* Summary:
+* This function starts CPU accounting. Switches that happened before this call
+* are not accounted.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t cpu_monitor_init(void)
+{
+    cy_rslt_t result;
+    uint32_t window_cycles = (uint32_t)(((uint64_t)CYCLE_COUNTER_HZ * CPU_MONITOR_WINDOW_MS) / 1000u);
+
+    cycle_counter_init();
+    cpu_stats_init(&cpu_monitor_stats, window_cycles, cycle_counter_get());
+    cpu_monitor_running = true;
+
+    result = cy_rtos_init_timer(&cpu_monitor_timer, CY_TIMER_TYPE_PERIODIC, cpu_monitor_timer_handler, 0);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_start_timer(&cpu_monitor_timer, CPU_MONITOR_WINDOW_MS / 2u);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_monitor_top
+********************************************************************************
+* Summary:
+* This function prints the CPU usage of every thread seen so far, over the
+* last window and averaged over the requested number of windows.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int cpu_monitor_top(int argc, char* argv[], tlv_buffer_t** data)
+{
+#if !defined(TX_ENABLE_EXECUTION_CHANGE_NOTIFY)
+    printf("Build with CPU_MONITOR=1 to enable the ThreadX execution change hooks\n");
+    return -1;
+#else
+    uint32_t windows = CPU_STATS_HISTORY;
+    uint32_t state;
+    const cpu_stats_t *stats = &cpu_monitor_snapshot;
+
+    if(argc > 1)
+    {
+        windows = (uint32_t)strtoul(argv[1], NULL, 0);
+        if((windows == 0u) || (windows > CPU_STATS_HISTORY))
+        {
+            printf("Windows must be between 1 and %u\n", (unsigned)CPU_STATS_HISTORY);
+            return -1;
+        }
+    }
+
+    /* Copy the state so that printing does not hold off the scheduler */
+    state = cyhal_system_critical_section_enter();
+    cpu_stats_update(&cpu_monitor_stats, cycle_counter_get());
+    cpu_monitor_snapshot = cpu_monitor_stats;
+    cyhal_system_critical_section_exit(state);
+
+    /* The hooks are defined here but only called by a ThreadX library built
+     * with the same define; without them everything is charged to idle */
+    if(stats->switches == 0u)
+    {
+        printf("No context switch recorded: the ThreadX library was built without "
+               "TX_ENABLE_EXECUTION_CHANGE_NOTIFY, rebuild it with CPU_MONITOR=1\n");
+        return -1;
+    }
+
+    printf("%-24s %8s %8s\n", "thread", "last 1s", "avg");
+    for(uint32_t i = 0; i < stats->count; i++)
+    {
+        uint32_t last = cpu_stats_usage(stats, i, 1);
+        uint32_t avg  = cpu_stats_usage(stats, i, windows);
+
+        if((i == CPU_STATS_ENTRY_OTHER) && (stats->entries[i].total == 0u))
+        {
+            continue;
+        }
+
+        printf("%-24s %5" PRIu32 ".%" PRIu32 "%% %5" PRIu32 ".%" PRIu32 "%%\n",
+               (stats->entries[i].name != NULL) ? stats->entries[i].name : "?",
+               last / 10u, last % 10u, avg / 10u, avg % 10u);
+    }
+    printf("Averaged over %" PRIu32 " window(s), %" PRIu32 " context switches\n",
+           (windows < stats->history_count) ? windows : stats->history_count, stats->switches);
+
+    return 0;
+#endif /* TX_ENABLE_EXECUTION_CHANGE_NOTIFY */
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_monitor_add_commands
+********************************************************************************
+* Summary:
+* This function registers the CPU monitor commands table.
+*
+*******************************************************************************/
+cy_rslt_t cpu_monitor_add_commands(void)
+{
+    return cy_command_console_add_table(cpu_monitor_commands_table);
+}
+
+
+/* [] END OF FILE */
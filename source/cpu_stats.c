@@ -0,0 +1,277 @@
+/******************************************************************************
+* File Name:   cpu_stats.c
+*
+* Description: This file implements the CPU accounting core. Time between two
+*              context switches is charged to the entry that was running, and
+*              charged time is collected in fixed-length windows so that usage
+*              can be reported over a sliding window of recent history.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cpu_stats.h"
+
+#include <string.h>
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_charge
+********************************************************************************
+* Summary:
+* This function charges the cycles elapsed since the last event to the running
+* entry and closes the window if it is complete. A charge that spans a window
+* boundary is accounted in the window being closed.
+*
+*******************************************************************************/
+static void cpu_stats_charge(cpu_stats_t *stats, uint32_t now)
+{
+    uint32_t delta = now - stats->last_switch;
+    cpu_stats_entry_t *running = &stats->entries[stats->running];
+
+    running->current += delta;
+    running->total   += delta;
+    stats->last_switch = now;
+
+    if((now - stats->window_start) >= stats->window_cycles)
+    {
+        uint32_t slot = stats->history_head;
+
+        for(uint32_t i = 0; i < stats->count; i++)
+        {
+            stats->entries[i].history[slot] = stats->entries[i].current;
+            stats->entries[i].current = 0;
+        }
+
+        stats->window_len[slot] = now - stats->window_start;
+        stats->window_start     = now;
+        stats->history_head     = (slot + 1u) % CPU_STATS_HISTORY;
+        if(stats->history_count < CPU_STATS_HISTORY)
+        {
+            stats->history_count++;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_lookup
+********************************************************************************
+* Summary:
+* This function returns the entry of a thread, allocating one on first use.
+* Threads that do not fit in the table are charged to the "other" entry.
+*
+*******************************************************************************/
+static uint32_t cpu_stats_lookup(cpu_stats_t *stats, uintptr_t id, const char *name)
+{
+    if(id == CPU_STATS_IDLE_ID)
+    {
+        return CPU_STATS_ENTRY_IDLE;
+    }
+
+    for(uint32_t i = CPU_STATS_FIRST_THREAD; i < stats->count; i++)
+    {
+        if(stats->entries[i].id == id)
+        {
+            return i;
+        }
+    }
+
+    if(stats->count >= CPU_STATS_MAX_ENTRIES)
+    {
+        return CPU_STATS_ENTRY_OTHER;
+    }
+
+    stats->entries[stats->count].id   = id;
+    stats->entries[stats->count].name = name;
+
+    return stats->count++;
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_init
+********************************************************************************
+* Summary:
+* This function resets the accounting state.
+*
+* Parameters:
+*  cpu_stats_t *stats     : accounting state
+*  uint32_t window_cycles : length of one accounting window in cycles
+*  uint32_t now           : current cycle count
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void cpu_stats_init(cpu_stats_t *stats, uint32_t window_cycles, uint32_t now)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    stats->entries[CPU_STATS_ENTRY_IDLE].name  = "(idle)";
+    stats->entries[CPU_STATS_ENTRY_ISR].name   = "(isr)";
+    stats->entries[CPU_STATS_ENTRY_OTHER].name = "(other)";
+    stats->count         = CPU_STATS_FIRST_THREAD;
+    stats->running       = CPU_STATS_ENTRY_IDLE;
+    stats->window_cycles = window_cycles;
+    stats->window_start  = now;
+    stats->last_switch   = now;
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_switch
+********************************************************************************
+* Summary:
+* This function records a context switch to the given thread, or to idle when
+* id is CPU_STATS_IDLE_ID. During an ISR the switch takes effect when the
+* outermost ISR exits.
+*
+* Parameters:
+*  cpu_stats_t *stats : accounting state
+*  uint32_t now       : current cycle count
+*  uintptr_t id       : unique id of the thread, e.g. its control block address
+*  const char *name   : name of the thread, must stay valid
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void cpu_stats_switch(cpu_stats_t *stats, uint32_t now, uintptr_t id, const char *name)
+{
+    uint32_t entry = cpu_stats_lookup(stats, id, name);
+
+    stats->switches++;
+
+    if(stats->isr_depth != 0u)
+    {
+        stats->isr_preempted = entry;
+        return;
+    }
+
+    cpu_stats_charge(stats, now);
+    stats->running = entry;
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_isr_enter
+********************************************************************************
+* Summary:
+* This function starts charging time to the ISR entry. Nested ISRs are
+* accounted as one.
+*
+*******************************************************************************/
+void cpu_stats_isr_enter(cpu_stats_t *stats, uint32_t now)
+{
+    if(stats->isr_depth++ == 0u)
+    {
+        cpu_stats_charge(stats, now);
+        stats->isr_preempted = stats->running;
+        stats->running = CPU_STATS_ENTRY_ISR;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_isr_exit
+********************************************************************************
+* Summary:
+* This function resumes charging the entry interrupted by the outermost ISR.
+*
+*******************************************************************************/
+void cpu_stats_isr_exit(cpu_stats_t *stats, uint32_t now)
+{
+    if((stats->isr_depth != 0u) && (--stats->isr_depth == 0u))
+    {
+        cpu_stats_charge(stats, now);
+        stats->running = stats->isr_preempted;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_update
+********************************************************************************
+* Summary:
+* This function charges the running entry up to now. It must be called at
+* least once per window so that windows are closed while the system is idle.
+*
+*******************************************************************************/
+void cpu_stats_update(cpu_stats_t *stats, uint32_t now)
+{
+    cpu_stats_charge(stats, now);
+}
+
+
+/*******************************************************************************
+* Function Name: cpu_stats_usage
+********************************************************************************
+* Summary:
+* This function returns the share of CPU time of an entry over the most recent
+* closed windows.
+*
+* Parameters:
+*  const cpu_stats_t *stats : accounting state
+*  uint32_t entry           : entry index
+*  uint32_t windows         : number of windows to average over
+*
+* Return:
+*  uint32_t : usage in tenths of a percent (0..1000)
+*
+*******************************************************************************/
+uint32_t cpu_stats_usage(const cpu_stats_t *stats, uint32_t entry, uint32_t windows)
+{
+    uint64_t busy = 0;
+    uint64_t total = 0;
+
+    if(windows > stats->history_count)
+    {
+        windows = stats->history_count;
+    }
+
+    for(uint32_t i = 0; i < windows; i++)
+    {
+        uint32_t slot = (stats->history_head + CPU_STATS_HISTORY - 1u - i) % CPU_STATS_HISTORY;
+        busy  += stats->entries[entry].history[slot];
+        total += stats->window_len[slot];
+    }
+
+    return (total == 0u) ? 0u : (uint32_t)((busy * 1000u) / total);
+}
+
+
+/* [] END OF FILE */
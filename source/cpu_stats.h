@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name:   cpu_stats.h
+*
+* Description: This file contains the declarations for the CPU accounting core
+*              used by the per-thread CPU utilization monitor. The core has no
+*              RTOS dependencies; it only consumes a trace of context switches.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CPU_STATS_H_
+#define CPU_STATS_H_
+
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define CPU_STATS_MAX_ENTRIES           (16u)
+#define CPU_STATS_HISTORY               (10u)
+
+/* Reserved entries */
+#define CPU_STATS_ENTRY_IDLE            (0u)
+#define CPU_STATS_ENTRY_ISR             (1u)
+#define CPU_STATS_ENTRY_OTHER           (2u)
+#define CPU_STATS_FIRST_THREAD          (3u)
+
+/* Thread id used for "no thread running" */
+#define CPU_STATS_IDLE_ID               ((uintptr_t)0)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uintptr_t   id;
+    const char *name;
+    uint32_t    current;                        /* Cycles in the open window */
+    uint32_t    history[CPU_STATS_HISTORY];     /* Cycles in closed windows */
+    uint64_t    total;
+} cpu_stats_entry_t;
+
+typedef struct
+{
+    cpu_stats_entry_t entries[CPU_STATS_MAX_ENTRIES];
+    uint32_t          count;
+    uint32_t          running;                  /* Entry being charged */
+    uint32_t          last_switch;
+    uint32_t          window_cycles;
+    uint32_t          window_start;
+    uint32_t          window_len[CPU_STATS_HISTORY];
+    uint32_t          history_head;             /* Next history slot to fill */
+    uint32_t          history_count;
+    uint32_t          isr_depth;
+    uint32_t          isr_preempted;            /* Entry interrupted by the outermost ISR */
+    uint32_t          switches;
+} cpu_stats_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void cpu_stats_init(cpu_stats_t *stats, uint32_t window_cycles, uint32_t now);
+void cpu_stats_switch(cpu_stats_t *stats, uint32_t now, uintptr_t id, const char *name);
+void cpu_stats_isr_enter(cpu_stats_t *stats, uint32_t now);
+void cpu_stats_isr_exit(cpu_stats_t *stats, uint32_t now);
+void cpu_stats_update(cpu_stats_t *stats, uint32_t now);
+uint32_t cpu_stats_usage(const cpu_stats_t *stats, uint32_t entry, uint32_t windows);
+
+#endif /* CPU_STATS_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,120 @@
+/******************************************************************************
+* File Name:   cycle_counter.h
+*
+* Description: This file provides a free-running cycle counter. On target it
+*              uses the Cortex-M33 DWT cycle counter; in a Linux host build it
+*              falls back to clock_gettime() with a 1 GHz virtual clock.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <time.h>
+#else
+#include "cyhal.h"
+#endif
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#if defined(__linux__)
+#define CYCLE_COUNTER_HZ                (1000000000UL)
+#elif defined(H1CP_CLOCK_FREQ)
+#define CYCLE_COUNTER_HZ                ((uint32_t)H1CP_CLOCK_FREQ)
+#else
+#define CYCLE_COUNTER_HZ                (SystemCoreClock)
+#endif
+
+
+/*******************************************************************************
+* Function Name: cycle_counter_init
+********************************************************************************
+* Summary:
+* This function enables the DWT cycle counter. It is safe to call it more than
+* once.
+*
+*******************************************************************************/
+static inline void cycle_counter_init(void)
+{
+#if !defined(__linux__)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: cycle_counter_get
+********************************************************************************
+* Summary:
+* This function returns the current value of the 32-bit cycle counter. The
+* counter wraps after ~44 s at 96 MHz; differences of two readings are valid
+* as long as the interval is shorter than that.
+*
+*******************************************************************************/
+static inline uint32_t cycle_counter_get(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: cycle_counter_to_ns
+********************************************************************************
+* Summary:
+* This function converts a number of cycles to nanoseconds.
+*
+*******************************************************************************/
+static inline uint64_t cycle_counter_to_ns(uint64_t cycles)
+{
+    return (cycles * 1000000000ULL) / CYCLE_COUNTER_HZ;
+}
+
+#endif /* CYCLE_COUNTER_H_ */
+
+/* [] END OF FILE */
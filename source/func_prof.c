@@ -0,0 +1,391 @@
+/******************************************************************************
+* File Name:   func_prof.c
+*
+* Description: This file implements the function profiler. Built with
+*              FUNC_PROFILE=1, the compiler calls __cyg_profile_func_enter()
+*              and __cyg_profile_func_exit() around every function built
+*              from source, the libraries included unless
+*              FUNC_PROFILE_LIBS=0 (-finstrument-functions); these hooks
+*              must therefore call no instrumented code. They count the calls
+*              and the self cycles (DWT cycle counter, callees excluded) per
+*              function address. "func_prof" prints them as the
+*              "address,calls,cycles" CSV read by tools/section_map.py.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "func_prof.h"
+#include "cycle_counter.h"
+
+#include "cyhal.h"
+#include "command_console.h"
+
+/* ThreadX header files. */
+#include "tx_api.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define FUNC_PROF_NO_INSTRUMENT         __attribute__((no_instrument_function))
+
+/* Context of the interrupt handlers, after the thread contexts */
+#define FUNC_PROF_ISR_CONTEXT           (FUNC_PROF_MAX_CONTEXTS)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uintptr_t address;              /* 0: free slot */
+    uint32_t  calls;
+    uint64_t  cycles;               /* Self cycles */
+} func_prof_entry_t;
+
+typedef struct
+{
+    uintptr_t address;
+    uint32_t  start;
+    uint32_t  children;             /* Cycles spent in callees */
+} func_prof_frame_t;
+
+/* Call stack of a thread. Cycles of a frame include the time the thread was
+ * preempted; run the profile under the workload of interest only */
+typedef struct
+{
+    TX_THREAD        *thread;       /* NULL: free (thread contexts only) */
+    uint32_t          depth;        /* May exceed FUNC_PROF_MAX_DEPTH */
+    func_prof_frame_t frames[FUNC_PROF_MAX_DEPTH];
+} func_prof_context_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void __cyg_profile_func_enter(void *function, void *call_site) FUNC_PROF_NO_INSTRUMENT;
+void __cyg_profile_func_exit(void *function, void *call_site) FUNC_PROF_NO_INSTRUMENT;
+int func_prof_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static func_prof_entry_t func_prof_entries[FUNC_PROF_MAX_FUNCTIONS];
+static func_prof_context_t func_prof_contexts[FUNC_PROF_MAX_CONTEXTS + 1u];
+static uint32_t func_prof_dropped;          /* Calls not recorded */
+static bool func_prof_running = true;
+
+#define FUNC_PROF_COMMANDS \
+    { (char *) "func_prof", func_prof_command, 0, NULL, NULL, (char *) "[reset|stop|start]", (char *) "Print the calls and self cycles of the instrumented functions as address,calls,cycles" }, \
+
+const cy_command_console_cmd_t func_prof_commands_table[] =
+{
+    FUNC_PROF_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: func_prof_irq_save / func_prof_irq_restore
+********************************************************************************
+* Summary:
+* Masks the interrupts around an update. The hooks cannot call the HAL
+* critical section functions, which may be instrumented themselves.
+*
+*******************************************************************************/
+static inline uint32_t FUNC_PROF_NO_INSTRUMENT func_prof_irq_save(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    return primask;
+}
+
+static inline void FUNC_PROF_NO_INSTRUMENT func_prof_irq_restore(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+
+/*******************************************************************************
+* Function Name: func_prof_context
+********************************************************************************
+* Summary:
+* Returns the call stack of the running thread or interrupt handler, taking a
+* free one for a thread seen for the first time. Called with the interrupts
+* masked.
+*
+*******************************************************************************/
+static func_prof_context_t * FUNC_PROF_NO_INSTRUMENT func_prof_context(void)
+{
+    TX_THREAD *thread;
+
+    if(__get_IPSR() != 0u)
+    {
+        return &func_prof_contexts[FUNC_PROF_ISR_CONTEXT];
+    }
+
+    thread = tx_thread_identify();
+    for(uint32_t i = 0; i < FUNC_PROF_MAX_CONTEXTS; i++)
+    {
+        if(func_prof_contexts[i].thread == thread)
+        {
+            return &func_prof_contexts[i];
+        }
+    }
+
+    for(uint32_t i = 0; i < FUNC_PROF_MAX_CONTEXTS; i++)
+    {
+        if(func_prof_contexts[i].thread == NULL)
+        {
+            func_prof_contexts[i].thread = thread;
+            func_prof_contexts[i].depth = 0;
+            return &func_prof_contexts[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: func_prof_account
+********************************************************************************
+* Summary:
+* Adds a call and its self cycles to the entry of a function. Called with the
+* interrupts masked.
+*
+*******************************************************************************/
+static void FUNC_PROF_NO_INSTRUMENT func_prof_account(uintptr_t address, uint32_t cycles)
+{
+    uint32_t slot = (uint32_t)(address >> 1) & (FUNC_PROF_MAX_FUNCTIONS - 1u);
+
+    for(uint32_t probe = 0; probe < FUNC_PROF_MAX_FUNCTIONS; probe++)
+    {
+        func_prof_entry_t *entry = &func_prof_entries[slot];
+
+        if((entry->address == address) || (entry->address == 0u))
+        {
+            entry->address = address;
+            entry->calls++;
+            entry->cycles += cycles;
+            return;
+        }
+        slot = (slot + 1u) & (FUNC_PROF_MAX_FUNCTIONS - 1u);
+    }
+
+    func_prof_dropped++;
+}
+
+
+/*******************************************************************************
+* Function Name: __cyg_profile_func_enter
+********************************************************************************
+* Summary:
+* This function is called by the compiler on entry of every instrumented
+* function. It pushes a frame on the call stack of the running context.
+*
+* Parameters:
+*  void *function  : address of the function
+*  void *call_site : address of the caller (unused)
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void __cyg_profile_func_enter(void *function, void *call_site)
+{
+    uint32_t primask = func_prof_irq_save();
+    func_prof_context_t *context = func_prof_context();
+
+    if(context != NULL)
+    {
+        if(context->depth < FUNC_PROF_MAX_DEPTH)
+        {
+            func_prof_frame_t *frame = &context->frames[context->depth];
+
+            frame->address  = (uintptr_t)function;
+            frame->children = 0;
+            frame->start    = cycle_counter_get();
+        }
+        context->depth++;
+    }
+
+    func_prof_irq_restore(primask);
+}
+
+
+/*******************************************************************************
+* Function Name: __cyg_profile_func_exit
+********************************************************************************
+* Summary:
+* This function is called by the compiler on return of every instrumented
+* function. It pops the frame of the function, records its self cycles and
+* charges its total cycles to the caller's frame.
+*
+* Parameters:
+*  void *function  : address of the function
+*  void *call_site : address of the caller (unused)
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void __cyg_profile_func_exit(void *function, void *call_site)
+{
+    uint32_t primask = func_prof_irq_save();
+    uint32_t now = cycle_counter_get();
+    func_prof_context_t *context = func_prof_context();
+
+    if((context != NULL) && (context->depth > 0u))
+    {
+        context->depth--;
+
+        if(context->depth < FUNC_PROF_MAX_DEPTH)
+        {
+            func_prof_frame_t *frame = &context->frames[context->depth];
+            uint32_t total = now - frame->start;
+
+            /* A frame pushed before a reset has no matching function */
+            if((frame->address == (uintptr_t)function) && func_prof_running)
+            {
+                func_prof_account(frame->address, total - frame->children);
+            }
+
+            if(context->depth > 0u)
+            {
+                context->frames[context->depth - 1u].children += total;
+            }
+        }
+    }
+
+    func_prof_irq_restore(primask);
+}
+
+
+/*******************************************************************************
+* Function Name: func_prof_command
+********************************************************************************
+* Summary:
+* This function prints one "address,calls,cycles" line per profiled function;
+* save the output to a file and pass it to "make section_map PROFILE=<file>".
+* "reset" clears the profile, "stop" and "start" suspend and resume the
+* recording, e.g. around the console output itself.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int func_prof_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint32_t primask;
+
+    if(argc > 1)
+    {
+        primask = func_prof_irq_save();
+        if(!strcmp(argv[1], "reset"))
+        {
+            memset(func_prof_entries, 0, sizeof(func_prof_entries));
+            func_prof_dropped = 0;
+        }
+        else if(!strcmp(argv[1], "stop") || !strcmp(argv[1], "start"))
+        {
+            func_prof_running = !strcmp(argv[1], "start");
+        }
+        func_prof_irq_restore(primask);
+        return 0;
+    }
+
+#if !defined(APP_FUNC_PROFILE)
+    printf("# No function is instrumented. Build with FUNC_PROFILE=1.\n");
+#endif
+
+    /* Printing calls instrumented functions; do not profile the dump */
+    primask = func_prof_irq_save();
+    bool running = func_prof_running;
+    func_prof_running = false;
+    func_prof_irq_restore(primask);
+
+    printf("# address,calls,cycles (%" PRIu32 " Hz)\n", (uint32_t)CYCLE_COUNTER_HZ);
+    for(uint32_t i = 0; i < FUNC_PROF_MAX_FUNCTIONS; i++)
+    {
+        func_prof_entry_t entry = func_prof_entries[i];
+
+        if(entry.address != 0u)
+        {
+            printf("0x%08" PRIxPTR ",%" PRIu32 ",%" PRIu64 "\n", entry.address, entry.calls, entry.cycles);
+        }
+    }
+
+    if(func_prof_dropped != 0u)
+    {
+        printf("# %" PRIu32 " calls not recorded: more than %u functions\n", func_prof_dropped,
+               (unsigned)FUNC_PROF_MAX_FUNCTIONS);
+    }
+
+    func_prof_running = running;
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: func_prof_add_commands
+********************************************************************************
+* Summary:
+* This function registers the function profiler command.
+*
+*******************************************************************************/
+cy_rslt_t func_prof_add_commands(void)
+{
+    cycle_counter_init();
+    return cy_command_console_add_table(func_prof_commands_table);
+}
+
+
+/* [] END OF FILE */
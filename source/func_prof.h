@@ -0,0 +1,73 @@
+/******************************************************************************
+* File Name:   func_prof.h
+*
+* Description: This file contains the declarations for the function profiler
+*              that counts the calls and CPU cycles of every application
+*              function (FUNC_PROFILE=1). Its output is the profile read by
+*              tools/section_map.py.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef FUNC_PROF_H_
+#define FUNC_PROF_H_
+
+#include "cy_result.h"
+
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Distinct functions recorded; power of two (open addressing hash table).
+ * Sized for the libraries instrumented with FUNC_PROFILE_LIBS=1 */
+#define FUNC_PROF_MAX_FUNCTIONS         (2048u)
+
+/* Threads profiled at once and call depth tracked per thread. Interrupts
+ * share one call stack as they nest strictly */
+#define FUNC_PROF_MAX_CONTEXTS          (16u)
+#define FUNC_PROF_MAX_DEPTH             (32u)
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t func_prof_add_commands(void);
+
+#endif /* FUNC_PROF_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,567 @@
+/******************************************************************************
+* File Name:   link_monitor.c
+*
+* Description: This file implements the link monitor. Each sample reads the
+*              RSSI, the current TX rate and the firmware packet counters of
+*              the STA and computes the frame error rates since the previous
+*              sample. From the rate and error rates, the monitor derives how
+*              many bytes of data an SP of the current wake duration carries,
+*              which the power-save policy compares with the expected load
+*              per wake interval. At the cell edge the rate drops and the same
+*              SP carries far fewer bytes.
+*
+*              The model of the HE MCS reached at a given RSSI also builds on
+*              Linux (see tools/link_model_host.c).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "link_monitor.h"
+
+#if !defined(__linux__)
+#include "cyabs_rtos.h"
+#include "cyhal.h"
+#include "command_console.h"
+#include "twt_session.h"
+#include "whd_prof.h"
+#include "wl_counters.h"
+
+/* Wi-Fi connection manager and WHD header files. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define LINK_MONITOR_THREAD_STACK       (2048u)
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int link_stats_command(int argc, char* argv[], tlv_buffer_t** data);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* HE MCS 0..11 PHY rates and typical receive sensitivity (20 MHz, 1 SS) */
+static const uint32_t link_monitor_mcs_kbps[LINK_MONITOR_MCS_COUNT] =
+{
+    8600, 17200, 25800, 34400, 51600, 68800, 77400, 86000, 103200, 114700, 129000, 143400
+};
+
+static const int32_t link_monitor_mcs_rssi_dbm[LINK_MONITOR_MCS_COUNT] =
+{
+    -82, -79, -77, -74, -70, -66, -65, -64, -59, -57, -54, -52
+};
+
+#if !defined(__linux__)
+extern whd_interface_t whd_ifs[2];
+
+static volatile bool link_monitor_enabled;
+static bool link_monitor_initialized;
+static uint32_t link_monitor_period_ms = LINK_MONITOR_PERIOD_MS;
+
+/* Firmware counters at the previous sample */
+static get_pktcnt_t link_monitor_prev_cnt;
+static bool link_monitor_prev_valid;
+static uint32_t link_monitor_prev_retrans;
+static bool link_monitor_prev_retrans_valid;
+
+static link_monitor_sample_t link_monitor_history[LINK_MONITOR_HISTORY];
+static uint32_t link_monitor_count;
+
+static cy_thread_t link_monitor_thread;
+static cy_semaphore_t link_monitor_wake;
+
+#define LINK_MONITOR_COMMANDS \
+    { (char *) "link_stats", link_stats_command, 0, NULL, NULL, (char *) "[start [period_ms]|stop|history]", (char *) "Show RSSI, rate, error rates and SP capacity of the link" }, \
+
+const cy_command_console_cmd_t link_monitor_commands_table[] =
+{
+    LINK_MONITOR_COMMANDS
+    CMD_TABLE_END
+};
+#endif
+
+
+/*******************************************************************************
+* Function Name: link_monitor_model_mcs
+********************************************************************************
+* Summary:
+* This function returns the highest HE MCS whose typical sensitivity is met
+* at the given RSSI; MCS 0 below the lowest sensitivity.
+*
+* Parameters:
+*  int32_t rssi_dbm
+*
+* Return:
+*  uint32_t : MCS
+*
+*******************************************************************************/
+uint32_t link_monitor_model_mcs(int32_t rssi_dbm)
+{
+    uint32_t mcs = 0;
+
+    for(uint32_t i = 0; i < LINK_MONITOR_MCS_COUNT; i++)
+    {
+        if(rssi_dbm >= link_monitor_mcs_rssi_dbm[i])
+        {
+            mcs = i;
+        }
+    }
+
+    return mcs;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_mcs_rate_kbps
+********************************************************************************
+* Summary:
+* This function returns the PHY rate of an HE MCS of the model.
+*
+* Parameters:
+*  uint32_t mcs
+*
+* Return:
+*  uint32_t : rate in kbit/s
+*
+*******************************************************************************/
+uint32_t link_monitor_mcs_rate_kbps(uint32_t mcs)
+{
+    return link_monitor_mcs_kbps[(mcs < LINK_MONITOR_MCS_COUNT) ? mcs : (LINK_MONITOR_MCS_COUNT - 1u)];
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_rate_to_mcs
+********************************************************************************
+* Summary:
+* This function returns the highest MCS of the model whose rate does not
+* exceed the given rate. Legacy rates map to the MCS of similar rate.
+*
+* Parameters:
+*  uint32_t rate_kbps
+*
+* Return:
+*  uint32_t : MCS
+*
+*******************************************************************************/
+uint32_t link_monitor_rate_to_mcs(uint32_t rate_kbps)
+{
+    uint32_t mcs = 0;
+
+    for(uint32_t i = 0; i < LINK_MONITOR_MCS_COUNT; i++)
+    {
+        if(rate_kbps >= link_monitor_mcs_kbps[i])
+        {
+            mcs = i;
+        }
+    }
+
+    return mcs;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_sp_bytes
+********************************************************************************
+* Summary:
+* This function returns the data an SP carries: the wake duration at the
+* PHY rate, less the MAC overhead, the frames lost after all retries and the
+* airtime of the retries.
+*
+* Parameters:
+*  uint32_t rate_kbps      : PHY rate
+*  uint32_t per_permille   : TX frames lost
+*  uint32_t retry_permille : TX retries per frame
+*  uint32_t wd_us          : wake duration
+*
+* Return:
+*  uint32_t : bytes
+*
+*******************************************************************************/
+uint32_t link_monitor_sp_bytes(uint32_t rate_kbps, uint32_t per_permille, uint32_t retry_permille, uint32_t wd_us)
+{
+    uint64_t bytes = ((uint64_t)rate_kbps * wd_us * LINK_MONITOR_MAC_EFFICIENCY_PCT) / (8000u * 100u);
+
+    if(per_permille > 1000u)
+    {
+        per_permille = 1000u;
+    }
+
+    bytes = (bytes * (1000u - per_permille)) / 1000u;
+    bytes = (bytes * 1000u) / (1000u + retry_permille);
+
+    return (uint32_t)bytes;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_sustained_kbps
+********************************************************************************
+* Summary:
+* This function returns the load carried when every SP is filled.
+*
+* Parameters:
+*  uint32_t sp_bytes : data per SP
+*  uint32_t wi_us    : wake interval
+*
+* Return:
+*  uint32_t : kbit/s
+*
+*******************************************************************************/
+uint32_t link_monitor_sustained_kbps(uint32_t sp_bytes, uint32_t wi_us)
+{
+    return (wi_us != 0u) ? (uint32_t)(((uint64_t)sp_bytes * 8000u) / wi_us) : 0u;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: link_monitor_permille
+********************************************************************************
+* Summary:
+* Returns part / total in permille, or 0 for an empty total.
+*
+*******************************************************************************/
+static uint32_t link_monitor_permille(uint32_t part, uint32_t total)
+{
+    return (total != 0u) ? (uint32_t)(((uint64_t)part * 1000u) / total) : 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_sample
+********************************************************************************
+* Summary:
+* This function samples the link and adds the sample to the history. The
+* error rates cover the frames since the previous sample. WLC_GET_PKTCNTS
+* has no retry count; the retransmissions come from the WLAN counters.
+*
+* Parameters:
+*  link_monitor_sample_t *sample : sample taken
+*
+* Return:
+*  cy_rslt_t : result of reading the RSSI
+*
+*******************************************************************************/
+cy_rslt_t link_monitor_sample(link_monitor_sample_t *sample)
+{
+    whd_interface_t ifp = whd_ifs[CY_WCM_INTERFACE_TYPE_STA];
+    twt_session_agreement_t agreement;
+    get_pktcnt_t cnt;
+    whd_prof_request_t requests[3];
+    wl_counters_t counters;
+    cy_time_t now;
+    uint32_t value = 0;
+    uint32_t wd_us;
+    uint32_t state;
+    cy_rslt_t result;
+
+    memset(sample, 0, sizeof(*sample));
+    cy_rtos_get_time(&now);
+    sample->time_ms = (uint32_t)now;
+
+    /* RSSI, rate and packet counts are read back to back */
+    memset(&cnt, 0, sizeof(cnt));
+    memset(requests, 0, sizeof(requests));
+    requests[0].op     = WHD_PROF_GET_IOCTL;
+    requests[0].ioctl  = WLC_GET_RSSI;
+    requests[0].buffer = (uint8_t *)&sample->rssi_dbm;
+    requests[0].len    = sizeof(sample->rssi_dbm);
+    requests[1].op     = WHD_PROF_GET_IOCTL;
+    requests[1].ioctl  = WLC_GET_RATE;
+    requests[1].buffer = (uint8_t *)&value;
+    requests[1].len    = sizeof(value);
+    requests[2].op     = WHD_PROF_GET_IOCTL;
+    requests[2].ioctl  = WLC_GET_PKTCNTS;
+    requests[2].buffer = (uint8_t *)&cnt;
+    requests[2].len    = sizeof(cnt);
+    whd_prof_batch(ifp, requests, 3u);
+
+    result = requests[0].result;
+    sample->model_mcs = link_monitor_model_mcs(sample->rssi_dbm);
+
+    /* WLC_GET_RATE reports the current TX rate in units of 500 kbit/s; fall back to the model */
+    if((requests[1].result == WHD_SUCCESS) && (value != 0u))
+    {
+        sample->rate_kbps = value * 500u;
+    }
+    else
+    {
+        sample->rate_kbps = link_monitor_mcs_rate_kbps(sample->model_mcs);
+    }
+    sample->mcs = link_monitor_rate_to_mcs(sample->rate_kbps);
+
+    if(requests[2].result == WHD_SUCCESS)
+    {
+        if(link_monitor_prev_valid)
+        {
+            sample->tx_frames = (cnt.tx_good_pkt + cnt.tx_bad_pkt) -
+                                (link_monitor_prev_cnt.tx_good_pkt + link_monitor_prev_cnt.tx_bad_pkt);
+            sample->tx_failed = cnt.tx_bad_pkt - link_monitor_prev_cnt.tx_bad_pkt;
+            sample->rx_frames = (cnt.rx_good_pkt + cnt.rx_bad_pkt) -
+                                (link_monitor_prev_cnt.rx_good_pkt + link_monitor_prev_cnt.rx_bad_pkt);
+            sample->rx_errors = cnt.rx_bad_pkt - link_monitor_prev_cnt.rx_bad_pkt;
+        }
+        link_monitor_prev_cnt = cnt;
+        link_monitor_prev_valid = true;
+    }
+
+    if(wl_counters_read(&counters) == CY_RSLT_SUCCESS)
+    {
+        if(link_monitor_prev_retrans_valid)
+        {
+            sample->tx_retries = counters.tx_retrans - link_monitor_prev_retrans;
+        }
+        link_monitor_prev_retrans = counters.tx_retrans;
+        link_monitor_prev_retrans_valid = true;
+    }
+
+    sample->per_permille = link_monitor_permille(sample->tx_failed, sample->tx_frames);
+    sample->retry_permille = link_monitor_permille(sample->tx_retries, sample->tx_frames);
+    sample->rx_err_permille = link_monitor_permille(sample->rx_errors, sample->rx_frames);
+
+    /* Both WCM profiles use the same wake duration */
+    twt_session_get(&agreement);
+    wd_us = agreement.active ? twt_session_wake_duration_us(&agreement) : (TWT_ACTIVE_WD * TWT_WD_UNIT_US);
+    sample->sp_bytes = link_monitor_sp_bytes(sample->rate_kbps, sample->per_permille, sample->retry_permille, wd_us);
+
+    state = cyhal_system_critical_section_enter();
+    link_monitor_history[link_monitor_count % LINK_MONITOR_HISTORY] = *sample;
+    link_monitor_count++;
+    cyhal_system_critical_section_exit(state);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_last
+********************************************************************************
+* Summary:
+* This function returns the last sample taken.
+*
+* Parameters:
+*  link_monitor_sample_t *sample : last sample
+*
+* Return:
+*  bool : false if no sample was taken yet
+*
+*******************************************************************************/
+bool link_monitor_last(link_monitor_sample_t *sample)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+    bool valid = (link_monitor_count != 0u);
+
+    if(valid)
+    {
+        *sample = link_monitor_history[(link_monitor_count - 1u) % LINK_MONITOR_HISTORY];
+    }
+    cyhal_system_critical_section_exit(state);
+
+    return valid;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_thread_function
+********************************************************************************
+* Summary:
+* Samples the link every period while the monitor is started. The thread
+* blocks without timeout while it is stopped.
+*
+*******************************************************************************/
+static void link_monitor_thread_function(cy_thread_arg_t arg)
+{
+    link_monitor_sample_t sample;
+
+    for(;;)
+    {
+        cy_rslt_t result = cy_rtos_get_semaphore(&link_monitor_wake,
+                                                 link_monitor_enabled ? link_monitor_period_ms : CY_RTOS_NEVER_TIMEOUT,
+                                                 false);
+
+        if((result != CY_RSLT_SUCCESS) && link_monitor_enabled && cy_wcm_is_connected_to_ap())
+        {
+            link_monitor_sample(&sample);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_print_sample
+********************************************************************************
+* Summary:
+* Prints one line of the sample table.
+*
+*******************************************************************************/
+static void link_monitor_print_sample(const link_monitor_sample_t *sample)
+{
+    printf("%10" PRIu32 " %5" PRId32 " %7" PRIu32 " %4" PRIu32 " %4" PRIu32 " %6" PRIu32 " %3" PRIu32 ".%" PRIu32
+           " %3" PRIu32 ".%" PRIu32 " %3" PRIu32 ".%" PRIu32 " %8" PRIu32 "\n",
+           sample->time_ms, sample->rssi_dbm, sample->rate_kbps, sample->mcs, sample->model_mcs, sample->tx_frames,
+           sample->per_permille / 10u, sample->per_permille % 10u, sample->retry_permille / 10u,
+           sample->retry_permille % 10u, sample->rx_err_permille / 10u, sample->rx_err_permille % 10u,
+           sample->sp_bytes);
+}
+
+
+/*******************************************************************************
+* Function Name: link_stats_command
+********************************************************************************
+* Summary:
+* This function starts or stops the background sampling, prints the sample
+* history, or takes a sample and prints it with the load each iTWT profile
+* carries at that SP capacity.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int link_stats_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    static const char header[] = "  time(ms)  rssi  kbit/s  mcs  exp   txfr   per%  rtry% rxerr% SP bytes\n";
+    link_monitor_sample_t sample;
+
+    if((argc >= 2) && !strcmp(argv[1], "start"))
+    {
+        uint32_t period_ms = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : LINK_MONITOR_PERIOD_MS;
+
+        if(period_ms < 100u)
+        {
+            printf("The period must be at least 100 ms\n");
+            return -1;
+        }
+
+        if(!link_monitor_initialized)
+        {
+            if((cy_rtos_init_semaphore(&link_monitor_wake, 1, 0) != CY_RSLT_SUCCESS) ||
+               (cy_rtos_thread_create(&link_monitor_thread, link_monitor_thread_function, "LinkMonitor", NULL,
+                                      LINK_MONITOR_THREAD_STACK, CY_RTOS_PRIORITY_LOW, NULL) != CY_RSLT_SUCCESS))
+            {
+                printf("Failed to start the link monitor thread\n");
+                return -1;
+            }
+            link_monitor_initialized = true;
+        }
+
+        link_monitor_period_ms = period_ms;
+        link_monitor_enabled = true;
+        cy_rtos_set_semaphore(&link_monitor_wake, false);
+        printf("Sampling the link every %" PRIu32 " ms\n", period_ms);
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "stop"))
+    {
+        link_monitor_enabled = false;
+        if(link_monitor_initialized)
+        {
+            cy_rtos_set_semaphore(&link_monitor_wake, false);
+        }
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "history"))
+    {
+        uint32_t count = (link_monitor_count < LINK_MONITOR_HISTORY) ? link_monitor_count : LINK_MONITOR_HISTORY;
+
+        printf("%s", header);
+        for(uint32_t i = link_monitor_count - count; i < link_monitor_count; i++)
+        {
+            uint32_t state = cyhal_system_critical_section_enter();
+            sample = link_monitor_history[i % LINK_MONITOR_HISTORY];
+            cyhal_system_critical_section_exit(state);
+            link_monitor_print_sample(&sample);
+        }
+        return 0;
+    }
+
+    if(!cy_wcm_is_connected_to_ap())
+    {
+        printf("Not connected to an AP\n");
+        return -1;
+    }
+
+    link_monitor_sample(&sample);
+
+    printf("%s", header);
+    link_monitor_print_sample(&sample);
+    printf("Sampling: %s\n", link_monitor_enabled ? "running" : "stopped");
+    printf("Sustained load with full SPs: active profile %" PRIu32 " kbit/s, idle profile %" PRIu32 " kbit/s\n",
+           link_monitor_sustained_kbps(sample.sp_bytes, (TWT_ACTIVE_WI_MANTISSA << TWT_ACTIVE_WI_EXPONENT)),
+           link_monitor_sustained_kbps(sample.sp_bytes, (TWT_IDLE_WI_MANTISSA << TWT_IDLE_WI_EXPONENT)));
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: link_monitor_add_commands
+********************************************************************************
+* Summary:
+* This function registers the link monitor command.
+*
+*******************************************************************************/
+cy_rslt_t link_monitor_add_commands(void)
+{
+    return cy_command_console_add_table(link_monitor_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
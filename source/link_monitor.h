@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name:   link_monitor.h
+*
+* Description: This file contains the declarations for the link monitor,
+*              which samples the RSSI, PHY rate and frame error rates of the
+*              STA link and derives the airtime an SP offers.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef LINK_MONITOR_H_
+#define LINK_MONITOR_H_
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Sampling period of the background monitor and samples kept */
+#define LINK_MONITOR_PERIOD_MS          (1000u)
+#define LINK_MONITOR_HISTORY            (32u)
+
+/* Share of an SP left for data once contention, preambles and ACKs are paid */
+#define LINK_MONITOR_MAC_EFFICIENCY_PCT (60u)
+
+/* HE MCS of the rate model (20 MHz, 1 spatial stream, 0.8-us GI) */
+#define LINK_MONITOR_MCS_COUNT          (12u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t time_ms;
+    int32_t  rssi_dbm;
+    uint32_t rate_kbps;         /* Current TX rate reported by the firmware */
+    uint32_t mcs;               /* HE MCS of the model closest below rate_kbps */
+    uint32_t model_mcs;         /* HE MCS the model expects at rssi_dbm */
+    uint32_t tx_frames;         /* Since the previous sample */
+    uint32_t tx_failed;
+    uint32_t rx_frames;
+    uint32_t rx_errors;
+    uint32_t tx_retries;
+    uint32_t per_permille;      /* TX frames failed after all retries */
+    uint32_t retry_permille;    /* TX retries per frame sent */
+    uint32_t rx_err_permille;   /* RX frames received with errors */
+    uint32_t sp_bytes;          /* Data an SP of the current wake duration carries */
+} link_monitor_sample_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t link_monitor_model_mcs(int32_t rssi_dbm);
+uint32_t link_monitor_mcs_rate_kbps(uint32_t mcs);
+uint32_t link_monitor_rate_to_mcs(uint32_t rate_kbps);
+uint32_t link_monitor_sp_bytes(uint32_t rate_kbps, uint32_t per_permille, uint32_t retry_permille, uint32_t wd_us);
+uint32_t link_monitor_sustained_kbps(uint32_t sp_bytes, uint32_t wi_us);
+
+#if !defined(__linux__)
+cy_rslt_t link_monitor_sample(link_monitor_sample_t *sample);
+bool link_monitor_last(link_monitor_sample_t *sample);
+cy_rslt_t link_monitor_add_commands(void);
+#endif
+
+#endif /* LINK_MONITOR_H_ */
+
+/* [] END OF FILE */
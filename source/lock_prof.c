@@ -0,0 +1,777 @@
+/******************************************************************************
+* File Name:   lock_prof.c
+*
+* Description: This file implements the mutex contention and priority-inversion
+*              profiler. It records the wait and hold times of every profiled
+*              mutex. A wait on an owner of lower priority is flagged as a
+*              priority inversion from the priorities recorded with the
+*              owner and the waiters; where context switches are reported,
+*              the inversions during which the scheduler switches in a
+*              thread of higher priority than the owner but lower than the
+*              blocked thread, which thus preempts the owner, are counted
+*              as well.
+*
+*              Mutexes of the application are profiled through lock_prof_get()
+*              and lock_prof_set(). Building with LOCK_PROFILE=1 also wraps the
+*              abstraction-rtos mutex functions at link time, so that the
+*              mutexes of WCM, secure sockets, iperf and the console are
+*              profiled as well. Context switches are reported by the ThreadX
+*              execution change hooks of cpu_monitor (CPU_MONITOR=1).
+*
+*              The profiler also builds on Linux with POSIX mutexes, for the
+*              host test in tools/lock_prof_host.c.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cycle_counter.h"
+#include "lock_prof.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <time.h>
+#else
+#include "cyhal.h"
+#include "command_console.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Names of the wrapped abstraction-rtos functions, set by the Makefile */
+#ifndef LOCK_PROF_GET_SYMBOL
+#define LOCK_PROF_GET_SYMBOL            cy_rtos_get_mutex
+#endif
+#ifndef LOCK_PROF_SET_SYMBOL
+#define LOCK_PROF_SET_SYMBOL            cy_rtos_set_mutex
+#endif
+
+#define LOCK_PROF_CONCAT_(a, b)         a##b
+#define LOCK_PROF_CONCAT(a, b)          LOCK_PROF_CONCAT_(a, b)
+#define LOCK_PROF_REAL(sym)             LOCK_PROF_CONCAT(__real_, sym)
+#define LOCK_PROF_WRAP(sym)             LOCK_PROF_CONCAT(__wrap_, sym)
+
+/* Scheduling state of a thread */
+#if defined(__linux__)
+#define LOCK_PROF_SELF()                (lock_prof_self)
+#define LOCK_PROF_PRIORITY(thread)      ((thread)->priority)
+#define LOCK_PROF_THREAD_NAME(thread)   ((thread)->name)
+#define LOCK_PROF_READY(thread)         ((thread)->ready)
+#define LOCK_PROF_SUCCESS               (0u)
+#else
+#define LOCK_PROF_SELF()                tx_thread_identify()
+#define LOCK_PROF_PRIORITY(thread)      ((thread)->tx_thread_user_priority)
+#define LOCK_PROF_THREAD_NAME(thread)   ((thread)->tx_thread_name)
+#define LOCK_PROF_READY(thread)         ((thread)->tx_thread_state == TX_READY)
+#define LOCK_PROF_SUCCESS               (CY_RSLT_SUCCESS)
+#endif
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef lock_prof_result_t (*lock_prof_get_fn_t)(lock_prof_mutex_t *mutex, uint32_t timeout_ms);
+typedef lock_prof_result_t (*lock_prof_set_fn_t)(lock_prof_mutex_t *mutex);
+
+/* A thread blocked on a profiled mutex */
+typedef struct
+{
+    lock_prof_thread_t *thread;         /* NULL: free */
+    lock_prof_entry_t  *entry;
+    lock_prof_thread_t *owner;          /* Owner when the wait started */
+    uint32_t            owner_priority;
+    bool                lower_owner;    /* Owner of lower priority than the waiter */
+    bool                inverted;       /* Preemption of the owner counted for this wait */
+} lock_prof_waiter_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int lock_prof_command(int argc, char* argv[], tlv_buffer_t** data);
+#endif
+
+#if defined(LOCK_PROFILE_WRAP)
+cy_rslt_t LOCK_PROF_REAL(LOCK_PROF_GET_SYMBOL)(cy_mutex_t *mutex, cy_time_t timeout_ms);
+cy_rslt_t LOCK_PROF_REAL(LOCK_PROF_SET_SYMBOL)(cy_mutex_t *mutex);
+cy_rslt_t LOCK_PROF_WRAP(LOCK_PROF_GET_SYMBOL)(cy_mutex_t *mutex, cy_time_t timeout_ms);
+cy_rslt_t LOCK_PROF_WRAP(LOCK_PROF_SET_SYMBOL)(cy_mutex_t *mutex);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static lock_prof_entry_t lock_prof_entries[LOCK_PROF_MAX_LOCKS];
+static uint32_t lock_prof_count;
+static uint32_t lock_prof_dropped;
+
+static lock_prof_waiter_t lock_prof_waiters[LOCK_PROF_MAX_WAITERS];
+static volatile uint32_t lock_prof_blocked;     /* Waiters in use */
+
+#if defined(__linux__)
+static pthread_mutex_t lock_prof_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread lock_prof_thread_t *lock_prof_self;
+#else
+#define LOCK_PROF_COMMANDS \
+    { (char *) "locks", lock_prof_command, 0, NULL, NULL, (char *) "[reset]", (char *) "Show mutex wait/hold times and priority inversions" }, \
+
+const cy_command_console_cmd_t lock_prof_commands_table[] =
+{
+    LOCK_PROF_COMMANDS
+    CMD_TABLE_END
+};
+#endif
+
+
+/*******************************************************************************
+* Function Name: lock_prof_lock / lock_prof_unlock
+********************************************************************************
+* Summary:
+* Protect the statistics: interrupts are disabled on the kit, where the
+* context switch hook updates them, a mutex in the host build.
+*
+*******************************************************************************/
+static inline uint32_t lock_prof_lock(void)
+{
+#if defined(__linux__)
+    pthread_mutex_lock(&lock_prof_mutex);
+    return 0;
+#else
+    return cyhal_system_critical_section_enter();
+#endif
+}
+
+static inline void lock_prof_unlock(uint32_t state)
+{
+#if defined(__linux__)
+    (void)state;
+    pthread_mutex_unlock(&lock_prof_mutex);
+#else
+    cyhal_system_critical_section_exit(state);
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_lookup
+********************************************************************************
+* Summary:
+* This function returns the entry of a mutex, allocating one on first use.
+* Must be called with the statistics locked.
+*
+*******************************************************************************/
+static lock_prof_entry_t* lock_prof_lookup(const lock_prof_mutex_t *mutex)
+{
+    for(uint32_t i = 0; i < lock_prof_count; i++)
+    {
+        if(lock_prof_entries[i].mutex == mutex)
+        {
+            return &lock_prof_entries[i];
+        }
+    }
+
+    if(lock_prof_count >= LOCK_PROF_MAX_LOCKS)
+    {
+        lock_prof_dropped++;
+        return NULL;
+    }
+
+    memset(&lock_prof_entries[lock_prof_count], 0, sizeof(lock_prof_entry_t));
+    lock_prof_entries[lock_prof_count].mutex = (lock_prof_mutex_t *)mutex;
+
+    return &lock_prof_entries[lock_prof_count++];
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_thread_name
+********************************************************************************
+* Summary:
+* This function returns a printable thread name.
+*
+*******************************************************************************/
+static const char* lock_prof_thread_name(const lock_prof_thread_t *thread)
+{
+    return ((thread != NULL) && (LOCK_PROF_THREAD_NAME(thread) != NULL)) ? LOCK_PROF_THREAD_NAME(thread) : "?";
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_update_waiter_priority
+********************************************************************************
+* Summary:
+* Recomputes the highest priority of the threads blocked on a mutex. Called
+* with the profiler locked.
+*
+*******************************************************************************/
+static void lock_prof_update_waiter_priority(lock_prof_entry_t *entry)
+{
+    entry->waiter_priority = UINT32_MAX;
+    for(uint32_t i = 0; i < LOCK_PROF_MAX_WAITERS; i++)
+    {
+        if((lock_prof_waiters[i].thread != NULL) && (lock_prof_waiters[i].entry == entry) &&
+           (LOCK_PROF_PRIORITY(lock_prof_waiters[i].thread) < entry->waiter_priority))
+        {
+            entry->waiter_priority = LOCK_PROF_PRIORITY(lock_prof_waiters[i].thread);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_acquire
+********************************************************************************
+* Summary:
+* This function acquires a mutex through 'get' and records the acquisition.
+* While the mutex is owned by another thread, the calling thread is listed as
+* a waiter, with the owner and its priority: a wait on an owner of lower
+* priority is counted as an inverted wait once it ends, and
+* lock_prof_thread_switch() can detect the preemption of the owner. The
+* owner is read again once 'get' returns, since it may have changed while
+* the thread was blocked.
+*
+*******************************************************************************/
+static lock_prof_result_t lock_prof_acquire(lock_prof_get_fn_t get, lock_prof_mutex_t *mutex, uint32_t timeout_ms)
+{
+    lock_prof_thread_t *self = LOCK_PROF_SELF();
+    lock_prof_waiter_t *waiter = NULL;
+    uint32_t start;
+    uint32_t now;
+    uint32_t wait;
+    uint32_t state;
+    lock_prof_result_t result;
+    lock_prof_entry_t *entry;
+
+    state = lock_prof_lock();
+    entry = lock_prof_lookup(mutex);
+    if((entry != NULL) && (entry->owner != NULL) && (entry->owner != self) && (self != NULL))
+    {
+        for(uint32_t i = 0; i < LOCK_PROF_MAX_WAITERS; i++)
+        {
+            if(lock_prof_waiters[i].thread == NULL)
+            {
+                waiter = &lock_prof_waiters[i];
+                waiter->thread         = self;
+                waiter->entry          = entry;
+                waiter->owner          = entry->owner;
+                waiter->owner_priority = entry->owner_priority;
+                waiter->lower_owner    = (LOCK_PROF_PRIORITY(self) < entry->owner_priority);
+                waiter->inverted       = false;
+                lock_prof_blocked++;
+                entry->waiters++;
+                lock_prof_update_waiter_priority(entry);
+                break;
+            }
+        }
+    }
+    lock_prof_unlock(state);
+
+    start = cycle_counter_get();
+    result = get(mutex, timeout_ms);
+    now = cycle_counter_get();
+    wait = now - start;
+
+    if(entry == NULL)
+    {
+        return result;
+    }
+
+    state = lock_prof_lock();
+
+    if(waiter != NULL)
+    {
+        entry->contended++;
+        if(waiter->lower_owner)
+        {
+            entry->inverted_waits++;
+            if(wait >= entry->inverted_wait_max)
+            {
+                entry->inverted_wait_max        = wait;
+                entry->inverted_waiter          = lock_prof_thread_name(self);
+                entry->inverted_owner           = lock_prof_thread_name(waiter->owner);
+                entry->inverted_waiter_priority = LOCK_PROF_PRIORITY(self);
+                entry->inverted_owner_priority  = waiter->owner_priority;
+            }
+        }
+        if(waiter->inverted && (wait > entry->inversion_wait_max))
+        {
+            entry->inversion_wait_max = wait;
+        }
+        waiter->thread = NULL;
+        lock_prof_blocked--;
+        entry->waiters--;
+        lock_prof_update_waiter_priority(entry);
+    }
+
+    if(result != LOCK_PROF_SUCCESS)
+    {
+        entry->timeouts++;
+    }
+    else if((entry->owner == self) && (entry->depth != 0u))
+    {
+        /* Recursive acquisition, hold time is measured on the outermost one */
+        entry->depth++;
+    }
+    else
+    {
+        entry->owner          = self;
+        entry->owner_priority = LOCK_PROF_PRIORITY(self);
+        entry->depth          = 1;
+        entry->acquired_at    = now;
+        entry->acquisitions++;
+        entry->wait_total    += wait;
+        if(wait > entry->wait_max)
+        {
+            entry->wait_max = wait;
+        }
+        if(entry->first_user == NULL)
+        {
+            entry->first_user = lock_prof_thread_name(self);
+        }
+    }
+
+    lock_prof_unlock(state);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_release
+********************************************************************************
+* Summary:
+* This function records the hold time and releases a mutex through 'set'.
+*
+*******************************************************************************/
+static lock_prof_result_t lock_prof_release(lock_prof_set_fn_t set, lock_prof_mutex_t *mutex)
+{
+    lock_prof_thread_t *self = LOCK_PROF_SELF();
+    uint32_t state;
+    uint32_t hold;
+    lock_prof_entry_t *entry;
+
+    state = lock_prof_lock();
+    entry = lock_prof_lookup(mutex);
+    if((entry != NULL) && (entry->owner == self) && (entry->depth != 0u) && (--entry->depth == 0u))
+    {
+        hold = cycle_counter_get() - entry->acquired_at;
+        entry->hold_total += hold;
+        if(hold > entry->hold_max)
+        {
+            entry->hold_max = hold;
+        }
+        entry->owner = NULL;
+    }
+    lock_prof_unlock(state);
+
+    return set(mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_thread_switch
+********************************************************************************
+* Summary:
+* This function is called when a thread is switched in. For every thread
+* blocked on a profiled mutex, a priority inversion is counted, once per
+* wait, when the switched-in thread has a lower priority than the blocked
+* thread but a higher one than the owner, and the owner is ready to run:
+* the switched-in thread then preempts the owner and delays the blocked
+* thread. Base priorities are compared, so that an owner boosted by priority
+* inheritance still shows the inversion the inheritance resolved.
+*
+* Parameters:
+*  lock_prof_thread_t *thread : thread switched in
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void lock_prof_thread_switch(lock_prof_thread_t *thread)
+{
+    uint32_t state;
+
+    if((lock_prof_blocked == 0u) || (thread == NULL))
+    {
+        return;
+    }
+
+    state = lock_prof_lock();
+    for(uint32_t i = 0; i < LOCK_PROF_MAX_WAITERS; i++)
+    {
+        lock_prof_waiter_t *waiter = &lock_prof_waiters[i];
+        lock_prof_thread_t *owner;
+
+        if((waiter->thread == NULL) || waiter->inverted)
+        {
+            continue;
+        }
+
+        owner = waiter->entry->owner;
+        if((owner != NULL) && (owner != thread) && (waiter->thread != thread) && LOCK_PROF_READY(owner) &&
+           (LOCK_PROF_PRIORITY(waiter->thread) < LOCK_PROF_PRIORITY(thread)) &&
+           (LOCK_PROF_PRIORITY(thread) < LOCK_PROF_PRIORITY(owner)))
+        {
+            waiter->inverted = true;
+            waiter->entry->inversions++;
+            waiter->entry->inversion_waiter    = lock_prof_thread_name(waiter->thread);
+            waiter->entry->inversion_owner     = lock_prof_thread_name(owner);
+            waiter->entry->inversion_preempter = lock_prof_thread_name(thread);
+        }
+    }
+    lock_prof_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_name
+********************************************************************************
+* Summary:
+* This function gives a mutex a name for the report.
+*
+* Parameters:
+*  lock_prof_mutex_t *mutex : mutex to name
+*  const char *name         : name, must stay valid
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void lock_prof_name(lock_prof_mutex_t *mutex, const char *name)
+{
+    uint32_t state = lock_prof_lock();
+    lock_prof_entry_t *entry = lock_prof_lookup(mutex);
+
+    if(entry != NULL)
+    {
+        entry->name = name;
+    }
+    lock_prof_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_find
+********************************************************************************
+* Summary:
+* This function copies the statistics of a mutex.
+*
+* Parameters:
+*  const lock_prof_mutex_t *mutex : mutex
+*  lock_prof_entry_t *entry       : statistics
+*
+* Return:
+*  bool : false if the mutex was never used through the profiler
+*
+*******************************************************************************/
+bool lock_prof_find(const lock_prof_mutex_t *mutex, lock_prof_entry_t *entry)
+{
+    bool found = false;
+    uint32_t state = lock_prof_lock();
+
+    for(uint32_t i = 0; !found && (i < lock_prof_count); i++)
+    {
+        if(lock_prof_entries[i].mutex == mutex)
+        {
+            *entry = lock_prof_entries[i];
+            found = true;
+        }
+    }
+    lock_prof_unlock(state);
+
+    return found;
+}
+
+
+#if defined(__linux__)
+/*******************************************************************************
+* Function Name: lock_prof_host_get / lock_prof_host_set
+********************************************************************************
+* Summary:
+* POSIX counterparts of cy_rtos_get_mutex() and cy_rtos_set_mutex().
+*
+*******************************************************************************/
+static lock_prof_result_t lock_prof_host_get(lock_prof_mutex_t *mutex, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+
+    if(timeout_ms == LOCK_PROF_NEVER_TIMEOUT)
+    {
+        return (lock_prof_result_t)pthread_mutex_lock(mutex);
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec  += (time_t)(timeout_ms / 1000u);
+    deadline.tv_nsec += (long)(timeout_ms % 1000u) * 1000000L;
+    if(deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return (lock_prof_result_t)pthread_mutex_timedlock(mutex, &deadline);
+}
+
+static lock_prof_result_t lock_prof_host_set(lock_prof_mutex_t *mutex)
+{
+    return (lock_prof_result_t)pthread_mutex_unlock(mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_thread_attach
+********************************************************************************
+* Summary:
+* This function sets the scheduling state of the calling thread. The host
+* test updates it, and calls lock_prof_thread_switch(), as the scheduler of
+* the scenario it plays would.
+*
+* Parameters:
+*  lock_prof_thread_t *thread : calling thread, must stay valid
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void lock_prof_thread_attach(lock_prof_thread_t *thread)
+{
+    lock_prof_self = thread;
+}
+
+
+lock_prof_result_t lock_prof_get(lock_prof_mutex_t *mutex, uint32_t timeout_ms)
+{
+    return lock_prof_acquire(lock_prof_host_get, mutex, timeout_ms);
+}
+
+lock_prof_result_t lock_prof_set(lock_prof_mutex_t *mutex)
+{
+    return lock_prof_release(lock_prof_host_set, mutex);
+}
+#elif defined(LOCK_PROFILE_WRAP)
+/*******************************************************************************
+* Function Name: __wrap_cy_rtos_get_mutex / __wrap_cy_rtos_set_mutex
+********************************************************************************
+* Summary:
+* Link-time wrappers of the abstraction-rtos mutex functions (LOCK_PROFILE=1).
+*
+*******************************************************************************/
+cy_rslt_t LOCK_PROF_WRAP(LOCK_PROF_GET_SYMBOL)(cy_mutex_t *mutex, cy_time_t timeout_ms)
+{
+    return lock_prof_acquire(LOCK_PROF_REAL(LOCK_PROF_GET_SYMBOL), mutex, timeout_ms);
+}
+
+cy_rslt_t LOCK_PROF_WRAP(LOCK_PROF_SET_SYMBOL)(cy_mutex_t *mutex)
+{
+    return lock_prof_release(LOCK_PROF_REAL(LOCK_PROF_SET_SYMBOL), mutex);
+}
+
+
+cy_rslt_t lock_prof_get(cy_mutex_t *mutex, cy_time_t timeout_ms)
+{
+    /* Goes through the link-time wrapper */
+    return LOCK_PROF_GET_SYMBOL(mutex, timeout_ms);
+}
+
+cy_rslt_t lock_prof_set(cy_mutex_t *mutex)
+{
+    return LOCK_PROF_SET_SYMBOL(mutex);
+}
+#else
+/*******************************************************************************
+* Function Name: lock_prof_get / lock_prof_set
+********************************************************************************
+* Summary:
+* Profiled replacements of cy_rtos_get_mutex() and cy_rtos_set_mutex().
+*
+*******************************************************************************/
+cy_rslt_t lock_prof_get(cy_mutex_t *mutex, cy_time_t timeout_ms)
+{
+    return lock_prof_acquire(LOCK_PROF_GET_SYMBOL, mutex, timeout_ms);
+}
+
+cy_rslt_t lock_prof_set(cy_mutex_t *mutex)
+{
+    return lock_prof_release(LOCK_PROF_SET_SYMBOL, mutex);
+}
+#endif /* LOCK_PROFILE_WRAP */
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: lock_prof_us
+********************************************************************************
+* Summary:
+* Converts cycles to microseconds for printing.
+*
+*******************************************************************************/
+static uint32_t lock_prof_us(uint64_t cycles)
+{
+    return (uint32_t)(cycle_counter_to_ns(cycles) / 1000u);
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_command
+********************************************************************************
+* Summary:
+* This function prints the lock report, or resets the statistics with "reset".
+* Times are in microseconds.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int lock_prof_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint32_t state;
+
+    if((argc > 1) && !strcmp(argv[1], "reset"))
+    {
+        state = lock_prof_lock();
+        for(uint32_t i = 0; i < lock_prof_count; i++)
+        {
+            lock_prof_entry_t *entry = &lock_prof_entries[i];
+            entry->acquisitions = entry->contended = entry->timeouts = 0;
+            entry->wait_total = entry->hold_total = 0;
+            entry->wait_max = entry->hold_max = 0;
+            entry->inverted_waits = entry->inverted_wait_max = 0;
+            entry->inverted_waiter_priority = entry->inverted_owner_priority = 0;
+            entry->inverted_waiter = entry->inverted_owner = NULL;
+            entry->inversions = entry->inversion_wait_max = 0;
+            entry->inversion_waiter = entry->inversion_owner = entry->inversion_preempter = NULL;
+        }
+        lock_prof_dropped = 0;
+        lock_prof_unlock(state);
+        return 0;
+    }
+
+#if !defined(LOCK_PROFILE_WRAP)
+    printf("Only application mutexes are profiled. Build with LOCK_PROFILE=1 to profile all mutexes.\n");
+#endif
+#if !defined(TX_ENABLE_EXECUTION_CHANGE_NOTIFY)
+    printf("Context switches are not reported, so preemptions of the owner during an inversion are not detected.\n"
+           "Build with CPU_MONITOR=1.\n");
+#endif
+
+    printf("%-16s %-14s %7s %6s %8s %8s %8s %8s %5s %5s\n", "lock", "first user", "acq", "cont",
+           "avg wait", "max wait", "avg hold", "max hold", "inv", "prmt");
+
+    for(uint32_t i = 0; i < lock_prof_count; i++)
+    {
+        lock_prof_entry_t entry;
+        char name[17];
+
+        state = lock_prof_lock();
+        entry = lock_prof_entries[i];
+        lock_prof_unlock(state);
+
+        if(entry.name != NULL)
+        {
+            snprintf(name, sizeof(name), "%s", entry.name);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "0x%08" PRIx32, (uint32_t)(uintptr_t)entry.mutex);
+        }
+
+        printf("%-16s %-14.14s %7" PRIu32 " %6" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %5" PRIu32
+               " %5" PRIu32 "\n",
+               name, (entry.first_user != NULL) ? entry.first_user : "-",
+               entry.acquisitions, entry.contended,
+               (entry.acquisitions != 0u) ? lock_prof_us(entry.wait_total / entry.acquisitions) : 0u,
+               lock_prof_us(entry.wait_max),
+               (entry.acquisitions != 0u) ? lock_prof_us(entry.hold_total / entry.acquisitions) : 0u,
+               lock_prof_us(entry.hold_max), entry.inverted_waits, entry.inversions);
+
+        if(entry.inverted_waits != 0u)
+        {
+            printf("    priority inversion: '%s' (priority %" PRIu32 ") waited up to %" PRIu32 " us for '%s' (priority %"
+                   PRIu32 ")\n", entry.inverted_waiter, entry.inverted_waiter_priority,
+                   lock_prof_us(entry.inverted_wait_max), entry.inverted_owner, entry.inverted_owner_priority);
+        }
+        if(entry.inversions != 0u)
+        {
+            printf("    owner preempted: '%s' waited up to %" PRIu32 " us for '%s', preempted by '%s'\n",
+                   entry.inversion_waiter, lock_prof_us(entry.inversion_wait_max), entry.inversion_owner,
+                   entry.inversion_preempter);
+        }
+        if(entry.timeouts != 0u)
+        {
+            printf("    %" PRIu32 " acquisition(s) timed out\n", entry.timeouts);
+        }
+    }
+
+    if(lock_prof_dropped != 0u)
+    {
+        printf("%" PRIu32 " acquisition(s) of untracked mutexes (table full)\n", lock_prof_dropped);
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: lock_prof_add_commands
+********************************************************************************
+* Summary:
+* This function registers the lock profiler commands table.
+*
+*******************************************************************************/
+cy_rslt_t lock_prof_add_commands(void)
+{
+    cycle_counter_init();
+
+    return cy_command_console_add_table(lock_prof_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
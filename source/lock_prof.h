@@ -0,0 +1,143 @@
+/******************************************************************************
+* File Name:   lock_prof.h
+*
+* Description: This file contains the declarations for the mutex contention
+*              and priority-inversion profiler.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef LOCK_PROF_H_
+#define LOCK_PROF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#else
+#include "cyabs_rtos.h"
+#include "tx_api.h"
+#endif
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define LOCK_PROF_MAX_LOCKS             (24u)
+
+/* Threads blocked on profiled mutexes at the same time */
+#define LOCK_PROF_MAX_WAITERS           (8u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+#if defined(__linux__)
+/* Host build: POSIX mutexes, and threads that describe their scheduling
+ * state as ThreadX would (See tools/lock_prof_host.c) */
+typedef pthread_mutex_t lock_prof_mutex_t;
+typedef uint32_t lock_prof_result_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t    priority;           /* Lower value, higher priority */
+    bool        ready;              /* Runnable, i.e. not blocked */
+} lock_prof_thread_t;
+
+#define LOCK_PROF_NEVER_TIMEOUT         (0xFFFFFFFFu)
+#else
+typedef cy_mutex_t lock_prof_mutex_t;
+typedef cy_rslt_t lock_prof_result_t;
+typedef TX_THREAD lock_prof_thread_t;
+
+#define LOCK_PROF_NEVER_TIMEOUT         (CY_RTOS_NEVER_TIMEOUT)
+#endif
+
+typedef struct
+{
+    lock_prof_mutex_t  *mutex;
+    const char         *name;
+    const char         *first_user;         /* Thread that used the mutex first */
+    lock_prof_thread_t *owner;
+    uint32_t            owner_priority;     /* Base priority of the owner when it acquired the mutex */
+    uint32_t            depth;              /* Recursion depth of the owner */
+    uint32_t            acquired_at;
+    uint32_t            waiters;            /* Threads blocked on the mutex now */
+    uint32_t            waiter_priority;    /* Highest base priority of these, valid while waiters != 0 */
+    uint32_t            acquisitions;
+    uint32_t            contended;
+    uint32_t            timeouts;
+    uint64_t            wait_total;
+    uint32_t            wait_max;
+    uint64_t            hold_total;
+    uint32_t            hold_max;
+    /* Waits of a thread on an owner of lower base priority */
+    uint32_t            inverted_waits;
+    uint32_t            inverted_wait_max;
+    const char         *inverted_waiter;    /* Threads and priorities of the longest one */
+    const char         *inverted_owner;
+    uint32_t            inverted_waiter_priority;
+    uint32_t            inverted_owner_priority;
+    /* Of these, waits during which a thread of intermediate priority preempted
+     * the owner (context switches reported by lock_prof_thread_switch()) */
+    uint32_t            inversions;
+    uint32_t            inversion_wait_max;
+    const char         *inversion_waiter;
+    const char         *inversion_owner;
+    const char         *inversion_preempter;
+} lock_prof_entry_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void lock_prof_name(lock_prof_mutex_t *mutex, const char *name);
+lock_prof_result_t lock_prof_get(lock_prof_mutex_t *mutex, uint32_t timeout_ms);
+lock_prof_result_t lock_prof_set(lock_prof_mutex_t *mutex);
+void lock_prof_thread_switch(lock_prof_thread_t *thread);
+bool lock_prof_find(const lock_prof_mutex_t *mutex, lock_prof_entry_t *entry);
+
+#if defined(__linux__)
+void lock_prof_thread_attach(lock_prof_thread_t *thread);
+#else
+cy_rslt_t lock_prof_add_commands(void);
+#endif
+
+#endif /* LOCK_PROF_H_ */
+
+/* [] END OF FILE */
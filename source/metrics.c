@@ -0,0 +1,1283 @@
+/******************************************************************************
+* File Name:   metrics.c
+*
+* Description: This file implements a registry of counters, gauges and
+*              histograms, and two exporters: an HTTP endpoint serving the
+*              Prometheus text format, and a periodic UDP push of the same
+*              text sent at the start of an iTWT SP.
+*
+*              Gauges that need a WHD or WCM call (PHY rate, RSSI) are only
+*              sampled when the metrics are rendered, so that the cost of
+*              the registry is paid per scrape or push and not per update.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "command_console.h"
+#include "cycle_counter.h"
+#include "lock_prof.h"
+#include "metrics.h"
+#include "socket_init.h"
+#include "twt_session.h"
+#include "whd_prof.h"
+
+/* Wi-Fi connection manager and WHD header files. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+
+/* Secure sockets header file. */
+#include "cy_secure_sockets.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define METRICS_THREAD_STACK            (2048u)
+#define METRICS_SOCKET_TIMEOUT_MS       (2000u)
+#define METRICS_HTTP_REQUEST_LEN        (256u)
+#define METRICS_HTTP_HEADER_LEN         (128u)
+#define METRICS_LABELS_LEN              (32u)
+
+/* Longest sample line beyond the metric name and labels:
+ * "_bucket{le=\"4294967295\",} -2147483648\n" */
+#define METRICS_SAMPLE_OVERHEAD         (40u)
+
+/* "# TYPE " + " histogram\n", and "# HELP " + " " + "\n" */
+#define METRICS_TYPE_OVERHEAD           (18u)
+#define METRICS_HELP_OVERHEAD           (9u)
+
+/* Extra wait for the SP start event beyond its predicted time */
+#define METRICS_PUSH_SP_MARGIN_MS       (50u)
+
+/* MAC, LLC, IP and UDP/TCP headers added to every frame, for airtime */
+#define METRICS_FRAME_OVERHEAD          (70u)
+
+/* SYN, SYN-ACK, ACKs and FINs of a scrape */
+#define METRICS_TCP_CONTROL_FRAMES      (6u)
+#define METRICS_TCP_MSS                 (1460u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+struct metrics_entry
+{
+    const char     *name;
+    const char     *help;
+    metrics_type_t  type;
+    uint32_t        value;          /* Counter, or gauge as int32_t */
+    const uint32_t *bounds;         /* Histogram upper bounds, ascending */
+    uint32_t        bucket_count;
+    uint32_t        buckets[METRICS_HISTOGRAM_BUCKETS + 1u];  /* Last is +Inf */
+    uint32_t        sum;
+    uint32_t        count;
+};
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int metrics_command(int argc, char* argv[], tlv_buffer_t** data);
+
+/* Defined in main.c */
+extern whd_interface_t whd_ifs[2];
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static metrics_entry_t metrics_registry[METRICS_MAX];
+static uint32_t metrics_count;
+static bool metrics_initialized;
+
+static cy_mutex_t metrics_mutex;
+static char *metrics_text;
+static size_t metrics_text_size;
+static size_t metrics_text_length;
+static bool metrics_text_cached;
+static cy_time_t metrics_text_time;
+static uint32_t metrics_phy_rate_kbps;
+
+static const uint32_t metrics_render_bounds[] = { 250u, 500u, 1000u, 2000u, 4000u, 8000u };
+
+/* Built-in metrics */
+static metrics_entry_t *metrics_heap_used;
+static metrics_entry_t *metrics_twt_active;
+static metrics_entry_t *metrics_twt_duty;
+static metrics_entry_t *metrics_twt_sps;
+static metrics_entry_t *metrics_rssi;
+static metrics_entry_t *metrics_phy_rate;
+static metrics_entry_t *metrics_tx_bytes;
+static metrics_entry_t *metrics_rx_bytes;
+static metrics_entry_t *metrics_tx_frames;
+static metrics_entry_t *metrics_rx_frames;
+static metrics_entry_t *metrics_render_us;
+static metrics_entry_t *metrics_truncated;
+static metrics_entry_t *metrics_scrapes;
+static metrics_entry_t *metrics_pushes;
+static metrics_entry_t *metrics_export_bytes;
+static metrics_entry_t *metrics_export_frames;
+static metrics_entry_t *metrics_export_airtime;
+
+/* HTTP exporter */
+static cy_thread_t metrics_http_thread;
+static cy_socket_t metrics_http_socket;
+static uint16_t metrics_http_port;
+static uint32_t metrics_http_cached;
+
+/* UDP push exporter */
+static cy_thread_t metrics_push_thread;
+static cy_socket_t metrics_push_socket;
+static bool metrics_push_created;
+static cy_socket_sockaddr_t metrics_push_address;
+static volatile bool metrics_push_enabled;
+static uint32_t metrics_push_interval_ms;
+static cy_semaphore_t metrics_push_wakeup;
+static cy_semaphore_t metrics_sp_start;
+static volatile bool metrics_sp_waiting;
+static char metrics_push_labels[METRICS_LABELS_LEN];
+
+#define METRICS_COMMANDS \
+    { (char *) "metrics", metrics_command, 0, NULL, NULL, (char *) "[http [port]|push <host> [port] [interval_s]|stop|stats]", (char *) "Show the metrics, or start/stop their HTTP and UDP exporters" }, \
+
+const cy_command_console_cmd_t metrics_commands_table[] =
+{
+    METRICS_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: metrics_register
+********************************************************************************
+* Summary:
+* This function adds an entry to the registry.
+*
+*******************************************************************************/
+static metrics_entry_t* metrics_register(const char *name, const char *help, metrics_type_t type)
+{
+    metrics_entry_t *metric = NULL;
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    if(metrics_count < METRICS_MAX)
+    {
+        metric = &metrics_registry[metrics_count++];
+        memset(metric, 0, sizeof(*metric));
+        metric->name = name;
+        metric->help = help;
+        metric->type = type;
+    }
+
+    cyhal_system_critical_section_exit(state);
+
+    return metric;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_counter
+********************************************************************************
+* Summary:
+* This function registers a counter. The name should end in "_total".
+*
+* Parameters:
+*  const char *name : metric name; the string must remain valid
+*  const char *help : one-line description
+*
+* Return:
+*  metrics_entry_t* : handle, or NULL if the registry is full
+*
+*******************************************************************************/
+metrics_entry_t* metrics_counter(const char *name, const char *help)
+{
+    return metrics_register(name, help, METRICS_COUNTER);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_gauge
+********************************************************************************
+* Summary:
+* This function registers a gauge.
+*
+* Parameters:
+*  const char *name : metric name; the string must remain valid
+*  const char *help : one-line description
+*
+* Return:
+*  metrics_entry_t* : handle, or NULL if the registry is full
+*
+*******************************************************************************/
+metrics_entry_t* metrics_gauge(const char *name, const char *help)
+{
+    return metrics_register(name, help, METRICS_GAUGE);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_histogram
+********************************************************************************
+* Summary:
+* This function registers a histogram with fixed bucket upper bounds.
+*
+* Parameters:
+*  const char *name       : metric name; the string must remain valid
+*  const char *help       : one-line description
+*  const uint32_t *bounds : ascending upper bounds; the array must remain valid
+*  uint32_t count         : number of bounds (max METRICS_HISTOGRAM_BUCKETS)
+*
+* Return:
+*  metrics_entry_t* : handle, or NULL if the registry is full
+*
+*******************************************************************************/
+metrics_entry_t* metrics_histogram(const char *name, const char *help, const uint32_t *bounds, uint32_t count)
+{
+    metrics_entry_t *metric;
+
+    if(count > METRICS_HISTOGRAM_BUCKETS)
+    {
+        return NULL;
+    }
+
+    metric = metrics_register(name, help, METRICS_HISTOGRAM);
+    if(metric != NULL)
+    {
+        metric->bounds = bounds;
+        metric->bucket_count = count;
+    }
+
+    return metric;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_add
+********************************************************************************
+* Summary:
+* This function increments a counter. Counters wrap at 2^32, which Prometheus
+* handles as a counter reset.
+*
+* Parameters:
+*  metrics_entry_t *metric : counter, or NULL
+*  uint32_t delta          : increment
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void metrics_add(metrics_entry_t *metric, uint32_t delta)
+{
+    uint32_t state;
+
+    if(metric == NULL)
+    {
+        return;
+    }
+
+    state = cyhal_system_critical_section_enter();
+    metric->value += delta;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_set
+********************************************************************************
+* Summary:
+* This function sets a gauge.
+*
+* Parameters:
+*  metrics_entry_t *metric : gauge, or NULL
+*  int32_t value           : value
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void metrics_set(metrics_entry_t *metric, int32_t value)
+{
+    if(metric != NULL)
+    {
+        metric->value = (uint32_t)value;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_observe
+********************************************************************************
+* Summary:
+* This function records a sample in a histogram.
+*
+* Parameters:
+*  metrics_entry_t *metric : histogram, or NULL
+*  uint32_t value          : sample
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void metrics_observe(metrics_entry_t *metric, uint32_t value)
+{
+    uint32_t bucket = 0;
+    uint32_t state;
+
+    if(metric == NULL)
+    {
+        return;
+    }
+
+    while((bucket < metric->bucket_count) && (value > metric->bounds[bucket]))
+    {
+        bucket++;
+    }
+
+    state = cyhal_system_critical_section_enter();
+    metric->buckets[bucket]++;
+    metric->sum += value;
+    metric->count++;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_frame
+********************************************************************************
+* Summary:
+* This function counts an Ethernet frame passed between the network stack and
+* WHD. Called from the packet hooks.
+*
+* Parameters:
+*  bool tx         : true for a frame sent, false for a frame received
+*  uint32_t length : frame length
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void metrics_frame(bool tx, uint32_t length)
+{
+    metrics_entry_t *bytes = tx ? metrics_tx_bytes : metrics_rx_bytes;
+    metrics_entry_t *frames = tx ? metrics_tx_frames : metrics_rx_frames;
+    uint32_t state;
+
+    if((bytes == NULL) || (frames == NULL))
+    {
+        return;
+    }
+
+    state = cyhal_system_critical_section_enter();
+    bytes->value += length;
+    frames->value++;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_append
+********************************************************************************
+* Summary:
+* This function appends formatted text. Returns false if it does not fit.
+*
+*******************************************************************************/
+static bool metrics_append(char *buffer, size_t size, size_t *length, const char *format, ...)
+{
+    va_list args;
+    int written;
+
+    if(*length >= size)
+    {
+        return false;
+    }
+
+    va_start(args, format);
+    written = vsnprintf(&buffer[*length], size - *length, format, args);
+    va_end(args);
+
+    if((written < 0) || ((size_t)written >= size - *length))
+    {
+        return false;
+    }
+
+    *length += (size_t)written;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_render_entry
+********************************************************************************
+* Summary:
+* This function appends the samples of one metric. Returns false if they do
+* not fit.
+*
+*******************************************************************************/
+static bool metrics_render_entry(const metrics_entry_t *metric, char *buffer, size_t size, size_t *length,
+                                 const char *labels, bool help)
+{
+    static const char *type_names[] = { "counter", "gauge", "histogram" };
+    const char *open = (labels != NULL) ? "{" : "";
+    const char *close = (labels != NULL) ? "}" : "";
+    const char *text = (labels != NULL) ? labels : "";
+    bool ok = true;
+
+    if(help)
+    {
+        ok = metrics_append(buffer, size, length, "# HELP %s %s\n", metric->name, metric->help);
+    }
+    ok = ok && metrics_append(buffer, size, length, "# TYPE %s %s\n", metric->name, type_names[metric->type]);
+
+    if(metric->type == METRICS_COUNTER)
+    {
+        ok = ok && metrics_append(buffer, size, length, "%s%s%s%s %" PRIu32 "\n",
+                                  metric->name, open, text, close, metric->value);
+    }
+    else if(metric->type == METRICS_GAUGE)
+    {
+        ok = ok && metrics_append(buffer, size, length, "%s%s%s%s %" PRId32 "\n",
+                                  metric->name, open, text, close, (int32_t)metric->value);
+    }
+    else
+    {
+        uint32_t cumulative = 0;
+        const char *separator = (labels != NULL) ? "," : "";
+
+        for(uint32_t i = 0; ok && (i < metric->bucket_count); i++)
+        {
+            cumulative += metric->buckets[i];
+            ok = metrics_append(buffer, size, length, "%s_bucket{le=\"%" PRIu32 "\"%s%s} %" PRIu32 "\n",
+                                metric->name, metric->bounds[i], separator, text, cumulative);
+        }
+        ok = ok && metrics_append(buffer, size, length, "%s_bucket{le=\"+Inf\"%s%s} %" PRIu32 "\n",
+                                  metric->name, separator, text, metric->count);
+        ok = ok && metrics_append(buffer, size, length, "%s_sum%s%s%s %" PRIu32 "\n",
+                                  metric->name, open, text, close, metric->sum);
+        ok = ok && metrics_append(buffer, size, length, "%s_count%s%s%s %" PRIu32 "\n",
+                                  metric->name, open, text, close, metric->count);
+    }
+
+    return ok;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_render
+********************************************************************************
+* Summary:
+* This function formats all metrics in the Prometheus text format. Each
+* metric is copied in a critical section, so that the samples of a histogram
+* are consistent. Rendering stops at the first metric that does not fit, so
+* the cost is bounded by the buffer size.
+*
+* Parameters:
+*  char *buffer       : output buffer
+*  size_t size        : output buffer size
+*  const char *labels : labels added to every sample, e.g. "device=\"..\"", or NULL
+*  bool help          : include the HELP lines
+*
+* Return:
+*  size_t : length of the text, without the terminating null character
+*
+*******************************************************************************/
+size_t metrics_render(char *buffer, size_t size, const char *labels, bool help)
+{
+    size_t length = 0;
+    uint32_t count = metrics_count;
+
+    if(size == 0u)
+    {
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        metrics_entry_t metric;
+        size_t start = length;
+        uint32_t state = cyhal_system_critical_section_enter();
+
+        metric = metrics_registry[i];
+        cyhal_system_critical_section_exit(state);
+
+        if(!metrics_render_entry(&metric, buffer, size, &length, labels, help))
+        {
+            length = start;
+            metrics_add(metrics_truncated, 1);
+            break;
+        }
+    }
+
+    buffer[length] = '\0';
+
+    return length;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_entry_size
+********************************************************************************
+* Summary:
+* This function returns the longest text metrics_render_entry() can produce
+* for a metric, whatever its values.
+*
+*******************************************************************************/
+static size_t metrics_entry_size(const metrics_entry_t *metric, size_t labels_length, bool help)
+{
+    size_t name = strlen(metric->name);
+    size_t lines = (metric->type == METRICS_HISTOGRAM) ? (metric->bucket_count + 3u) : 1u;
+    size_t size = name + METRICS_TYPE_OVERHEAD + lines * (name + labels_length + METRICS_SAMPLE_OVERHEAD);
+
+    if(help)
+    {
+        size += name + strlen(metric->help) + METRICS_HELP_OVERHEAD;
+    }
+
+    return size;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_text_reserve
+********************************************************************************
+* Summary:
+* This function grows the exposition buffer to the size the registered
+* metrics can take. The buffer is sized from the registry rather than fixed,
+* as the modules register their metrics at run time. If the heap cannot
+* provide it, the previous buffer is kept and the metrics that do not fit are
+* left out (See metrics_render()). Called with metrics_mutex held.
+*
+*******************************************************************************/
+static void metrics_text_reserve(const char *labels, bool help)
+{
+    size_t labels_length = (labels != NULL) ? strlen(labels) : 0u;
+    uint32_t count = metrics_count;
+    size_t size = 1u;
+    char *text;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        size += metrics_entry_size(&metrics_registry[i], labels_length, help);
+    }
+
+    if(size > metrics_text_size)
+    {
+        text = realloc(metrics_text, size);
+        if(text != NULL)
+        {
+            metrics_text = text;
+            metrics_text_size = size;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_collect
+********************************************************************************
+* Summary:
+* This function samples the gauges that are not updated by the code paths
+* they describe.
+*
+*******************************************************************************/
+static void metrics_collect(void)
+{
+    struct mallinfo info = mallinfo();
+    twt_session_agreement_t agreement;
+    cy_wcm_associated_ap_info_t ap_info;
+    uint32_t wake_interval_us;
+    uint32_t rate = 0;
+
+    metrics_set(metrics_heap_used, (int32_t)info.uordblks);
+
+    twt_session_get(&agreement);
+    wake_interval_us = agreement.active ? twt_session_wake_interval_us(&agreement) : 0u;
+    metrics_set(metrics_twt_active, agreement.active ? 1 : 0);
+    metrics_set(metrics_twt_duty, (wake_interval_us != 0u) ?
+                (int32_t)(((uint64_t)twt_session_wake_duration_us(&agreement) * 1000u) / wake_interval_us) : 1000);
+
+    if(cy_wcm_is_connected_to_ap())
+    {
+        /* WLC_GET_RATE reports the current TX rate in units of 500 kbit/s */
+        if(whd_prof_get_ioctl_value(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], WLC_GET_RATE, &rate) != WHD_SUCCESS)
+        {
+            rate = 0;
+        }
+        if(cy_wcm_get_associated_ap_info(&ap_info) == CY_RSLT_SUCCESS)
+        {
+            metrics_set(metrics_rssi, ap_info.signal_strength);
+        }
+    }
+
+    metrics_phy_rate_kbps = rate * 500u;
+    metrics_set(metrics_phy_rate, (int32_t)metrics_phy_rate_kbps);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_export_text
+********************************************************************************
+* Summary:
+* This function samples and renders the metrics into the exposition buffer,
+* and records the time it took. Called with metrics_mutex held.
+*
+*******************************************************************************/
+static void metrics_export_text(const char *labels, bool help)
+{
+    uint32_t start = cycle_counter_get();
+
+    metrics_collect();
+    metrics_text_reserve(labels, help);
+    metrics_text_length = metrics_render(metrics_text, metrics_text_size, labels, help);
+    metrics_text_cached = false;
+
+    metrics_observe(metrics_render_us, (uint32_t)(cycle_counter_to_ns(cycle_counter_get() - start) / 1000u));
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_account
+********************************************************************************
+* Summary:
+* This function counts the traffic of an exporter and its airtime, estimated
+* from the last sampled PHY rate.
+*
+*******************************************************************************/
+static void metrics_account(uint32_t bytes, uint32_t frames)
+{
+    metrics_add(metrics_export_bytes, bytes);
+    metrics_add(metrics_export_frames, frames);
+
+    if(metrics_phy_rate_kbps != 0u)
+    {
+        metrics_add(metrics_export_airtime,
+                    (uint32_t)(((uint64_t)(bytes + frames * METRICS_FRAME_OVERHEAD) * 8000u) / metrics_phy_rate_kbps));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_send_all
+********************************************************************************
+* Summary:
+* This function sends a buffer on a TCP socket.
+*
+*******************************************************************************/
+static cy_rslt_t metrics_send_all(cy_socket_t socket, const char *data, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t offset = 0;
+
+    while((result == CY_RSLT_SUCCESS) && (offset < length))
+    {
+        uint32_t sent = 0;
+
+        result = cy_socket_send(socket, &data[offset], length - offset, CY_SOCKET_FLAGS_NONE, &sent);
+        offset += sent;
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_http_serve
+********************************************************************************
+* Summary:
+* This function answers one HTTP request. Only "GET /metrics" is served;
+* scrapes within METRICS_HTTP_CACHE_MS of the previous one reuse its text.
+*
+*******************************************************************************/
+static void metrics_http_serve(cy_socket_t client)
+{
+    static const char not_found[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    char request[METRICS_HTTP_REQUEST_LEN];
+    char header[METRICS_HTTP_HEADER_LEN];
+    uint32_t timeout = METRICS_SOCKET_TIMEOUT_MS;
+    uint32_t length = 0;
+    uint32_t response = 0;
+    cy_time_t now;
+    int header_length;
+
+    cy_socket_setsockopt(client, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout, sizeof(timeout));
+    cy_socket_setsockopt(client, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    /* Read the request line and headers; the body, if any, is ignored */
+    while(length < sizeof(request) - 1u)
+    {
+        uint32_t received = 0;
+
+        if((cy_socket_recv(client, &request[length], sizeof(request) - 1u - length, CY_SOCKET_FLAGS_NONE,
+                           &received) != CY_RSLT_SUCCESS) || (received == 0u))
+        {
+            break;
+        }
+        length += received;
+        request[length] = '\0';
+        if(strstr(request, "\r\n\r\n") != NULL)
+        {
+            break;
+        }
+    }
+    request[length] = '\0';
+
+    if(strncmp(request, "GET /metrics", 12) || ((request[12] != ' ') && (request[12] != '?')))
+    {
+        metrics_send_all(client, not_found, sizeof(not_found) - 1u);
+        metrics_account(length + sizeof(not_found) - 1u, METRICS_TCP_CONTROL_FRAMES + 2u);
+        return;
+    }
+
+    lock_prof_get(&metrics_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    cy_rtos_get_time(&now);
+    if(metrics_text_cached && ((uint32_t)(now - metrics_text_time) < METRICS_HTTP_CACHE_MS))
+    {
+        metrics_http_cached++;
+    }
+    else
+    {
+        metrics_export_text(NULL, true);
+        metrics_text_cached = true;
+        metrics_text_time = now;
+    }
+
+    header_length = snprintf(header, sizeof(header),
+                             "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                             "Content-Length: %u\r\nConnection: close\r\n\r\n", (unsigned)metrics_text_length);
+
+    if(metrics_send_all(client, header, (uint32_t)header_length) == CY_RSLT_SUCCESS)
+    {
+        metrics_send_all(client, metrics_text, (uint32_t)metrics_text_length);
+    }
+    response = (uint32_t)header_length + (uint32_t)metrics_text_length;
+
+    lock_prof_set(&metrics_mutex);
+
+    metrics_add(metrics_scrapes, 1);
+    metrics_account(length + response, METRICS_TCP_CONTROL_FRAMES + 1u + (response + METRICS_TCP_MSS - 1u) / METRICS_TCP_MSS);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_http_thread_function
+********************************************************************************
+* Summary:
+* Thread serving scrapes one connection at a time.
+*
+*******************************************************************************/
+static void metrics_http_thread_function(cy_thread_arg_t arg)
+{
+    while(1)
+    {
+        cy_socket_sockaddr_t peer;
+        uint32_t peer_length = sizeof(peer);
+        cy_socket_t client;
+
+        if(cy_socket_accept(metrics_http_socket, &peer, &peer_length, &client) != CY_RSLT_SUCCESS)
+        {
+            cy_rtos_delay_milliseconds(100);
+            continue;
+        }
+
+        metrics_http_serve(client);
+
+        cy_socket_disconnect(client, 0);
+        cy_socket_delete(client);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_http_start
+********************************************************************************
+* Summary:
+* This function starts the HTTP endpoint, served at "/metrics".
+*
+* Parameters:
+*  uint16_t port : TCP port
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t metrics_http_start(uint16_t port)
+{
+    cy_socket_sockaddr_t address;
+    cy_rslt_t result;
+
+    if(!metrics_initialized)
+    {
+        return (cy_rslt_t)-1;
+    }
+    if(metrics_http_port != 0u)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = socket_init();
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP,
+                                  &metrics_http_socket);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        memset(&address, 0, sizeof(address));
+        address.ip_address.version = CY_SOCKET_IP_VER_V4;
+        address.port = port;
+        result = cy_socket_bind(metrics_http_socket, &address, sizeof(address));
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_listen(metrics_http_socket, 1);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_thread_create(&metrics_http_thread, metrics_http_thread_function, "MetricsHTTP", NULL,
+                                       METRICS_THREAD_STACK, CY_RTOS_PRIORITY_LOW, NULL);
+    }
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        metrics_http_port = port;
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_push
+********************************************************************************
+* Summary:
+* This function renders the metrics and sends them in back-to-back datagrams
+* split at line boundaries. Called with metrics_mutex held.
+*
+*******************************************************************************/
+static void metrics_push(void)
+{
+    uint32_t offset = 0;
+    uint32_t bytes = 0;
+    uint32_t frames = 0;
+
+    metrics_export_text(metrics_push_labels, false);
+
+    while(offset < metrics_text_length)
+    {
+        uint32_t chunk = (uint32_t)metrics_text_length - offset;
+        uint32_t sent = 0;
+
+        if(chunk > METRICS_PUSH_DATAGRAM_MAX)
+        {
+            chunk = METRICS_PUSH_DATAGRAM_MAX;
+            while((chunk > 1u) && (metrics_text[offset + chunk - 1u] != '\n'))
+            {
+                chunk--;
+            }
+            if(chunk == 1u)
+            {
+                chunk = METRICS_PUSH_DATAGRAM_MAX;
+            }
+        }
+
+        if(cy_socket_sendto(metrics_push_socket, &metrics_text[offset], chunk, CY_SOCKET_FLAGS_NONE,
+                            &metrics_push_address, sizeof(metrics_push_address), &sent) != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+
+        bytes += chunk;
+        frames++;
+        offset += chunk;
+    }
+
+    metrics_add(metrics_pushes, 1);
+    metrics_account(bytes, frames);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_sp_callback
+********************************************************************************
+* Summary:
+* SP listener counting SPs, and waking the push thread when it waits for one.
+*
+*******************************************************************************/
+static void metrics_sp_callback(twt_sp_event_t event, void *arg)
+{
+    if(event == TWT_SP_START)
+    {
+        metrics_add(metrics_twt_sps, 1);
+        if(metrics_sp_waiting)
+        {
+            cy_rtos_set_semaphore(&metrics_sp_start, false);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_push_thread_function
+********************************************************************************
+* Summary:
+* Push thread. With iTWT, a push due between two SPs waits for the start of
+* the next SP, so that it does not keep the radio awake on its own.
+*
+*******************************************************************************/
+static void metrics_push_thread_function(cy_thread_arg_t arg)
+{
+    while(1)
+    {
+        cy_rtos_get_semaphore(&metrics_push_wakeup,
+                              metrics_push_enabled ? metrics_push_interval_ms : CY_RTOS_NEVER_TIMEOUT, false);
+
+        if(!metrics_push_enabled)
+        {
+            continue;
+        }
+
+        if(twt_session_is_active() && !twt_session_in_sp())
+        {
+            uint32_t wait_ms = twt_session_ms_to_next_sp() + METRICS_PUSH_SP_MARGIN_MS;
+
+            cy_rtos_get_semaphore(&metrics_sp_start, 0, false);
+            metrics_sp_waiting = true;
+            cy_rtos_get_semaphore(&metrics_sp_start, wait_ms, false);
+            metrics_sp_waiting = false;
+        }
+
+        lock_prof_get(&metrics_mutex, CY_RTOS_NEVER_TIMEOUT);
+        metrics_push();
+        lock_prof_set(&metrics_mutex);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_push_start
+********************************************************************************
+* Summary:
+* This function starts pushing the metrics to a UDP collector every
+* 'interval_s' seconds, or changes the collector and interval. Samples are
+* labelled with the MAC address of the device.
+*
+* Parameters:
+*  const char *host    : collector name or address
+*  uint16_t port       : collector UDP port
+*  uint32_t interval_s : push interval in seconds
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t metrics_push_start(const char *host, uint16_t port, uint32_t interval_s)
+{
+    cy_socket_sockaddr_t address;
+    cy_wcm_mac_t mac;
+    cy_rslt_t result;
+
+    if(!metrics_initialized || (interval_s == 0u))
+    {
+        return (cy_rslt_t)-1;
+    }
+
+    result = socket_init();
+    if(result == CY_RSLT_SUCCESS)
+    {
+        memset(&address, 0, sizeof(address));
+        result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address.ip_address);
+        address.port = port;
+    }
+    if((result == CY_RSLT_SUCCESS) && !metrics_push_created)
+    {
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP,
+                                  &metrics_push_socket);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            result = cy_rtos_thread_create(&metrics_push_thread, metrics_push_thread_function, "MetricsPush", NULL,
+                                           METRICS_THREAD_STACK, CY_RTOS_PRIORITY_LOW, NULL);
+        }
+        metrics_push_created = (result == CY_RSLT_SUCCESS);
+    }
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    if(cy_wcm_get_mac_addr(CY_WCM_INTERFACE_TYPE_STA, &mac) == CY_RSLT_SUCCESS)
+    {
+        snprintf(metrics_push_labels, sizeof(metrics_push_labels), "device=\"%02x%02x%02x%02x%02x%02x\"",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+
+    lock_prof_get(&metrics_mutex, CY_RTOS_NEVER_TIMEOUT);
+    metrics_push_address = address;
+    metrics_push_interval_ms = interval_s * 1000u;
+    metrics_push_enabled = true;
+    lock_prof_set(&metrics_mutex);
+
+    cy_rtos_set_semaphore(&metrics_push_wakeup, false);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_push_stop
+********************************************************************************
+* Summary:
+* This function stops the UDP push.
+*
+*******************************************************************************/
+void metrics_push_stop(void)
+{
+    if(metrics_push_enabled)
+    {
+        metrics_push_enabled = false;
+        cy_rtos_set_semaphore(&metrics_push_wakeup, false);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_init
+********************************************************************************
+* Summary:
+* This function creates the registry resources and registers the built-in
+* metrics. The exporters are started by the "metrics" command.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t metrics_init(void)
+{
+    cy_rslt_t result;
+
+    if(metrics_initialized)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    cycle_counter_init();
+
+    result = cy_rtos_init_mutex(&metrics_mutex);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        lock_prof_name(&metrics_mutex, "metrics");
+        result = cy_rtos_init_semaphore(&metrics_push_wakeup, 1, 0);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_init_semaphore(&metrics_sp_start, 1, 0);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = twt_session_register_sp_callback(metrics_sp_callback, NULL);
+    }
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    metrics_heap_used      = metrics_gauge("heap_used_bytes", "Heap in use");
+    metrics_twt_active     = metrics_gauge("twt_agreement_active", "1 while an iTWT agreement is in effect");
+    metrics_twt_duty       = metrics_gauge("twt_duty_cycle_permille", "Wake duration over wake interval, 1000 without iTWT");
+    metrics_twt_sps        = metrics_counter("twt_service_periods_total", "Predicted iTWT service periods");
+    metrics_rssi           = metrics_gauge("wlan_rssi_dbm", "RSSI of the AP");
+    metrics_phy_rate       = metrics_gauge("wlan_phy_rate_kbps", "Current TX PHY rate");
+    metrics_tx_bytes       = metrics_counter("wlan_tx_bytes_total", "Ethernet bytes sent to WHD");
+    metrics_rx_bytes       = metrics_counter("wlan_rx_bytes_total", "Ethernet bytes received from WHD");
+    metrics_tx_frames      = metrics_counter("wlan_tx_frames_total", "Ethernet frames sent to WHD");
+    metrics_rx_frames      = metrics_counter("wlan_rx_frames_total", "Ethernet frames received from WHD");
+    metrics_render_us      = metrics_histogram("metrics_render_us", "Time to sample and render the metrics",
+                                               metrics_render_bounds,
+                                               sizeof(metrics_render_bounds) / sizeof(metrics_render_bounds[0]));
+    metrics_truncated      = metrics_counter("metrics_truncated_total", "Renders that left metrics out for lack of space");
+    metrics_scrapes        = metrics_counter("metrics_scrapes_total", "HTTP scrapes served");
+    metrics_pushes         = metrics_counter("metrics_pushes_total", "UDP pushes sent");
+    metrics_export_bytes   = metrics_counter("metrics_export_bytes_total", "Payload bytes sent and received by the exporters");
+    metrics_export_frames  = metrics_counter("metrics_export_frames_total", "Frames sent and received by the exporters (estimated for HTTP)");
+    metrics_export_airtime = metrics_counter("metrics_export_airtime_us_total", "Airtime of the exporter frames, estimated from the PHY rate");
+
+    metrics_initialized = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_print_stats
+********************************************************************************
+* Summary:
+* This function prints the cost of the exporters.
+*
+*******************************************************************************/
+static void metrics_print_stats(void)
+{
+    uint32_t renders = metrics_render_us->count;
+    uint32_t exports = metrics_scrapes->value + metrics_pushes->value;
+
+    printf("Metrics registered      : %" PRIu32 " of %u\n", metrics_count, (unsigned)METRICS_MAX);
+    if(metrics_http_port != 0u)
+    {
+        printf("HTTP endpoint           : port %u\n", (unsigned)metrics_http_port);
+    }
+    else
+    {
+        printf("HTTP endpoint           : off\n");
+    }
+    printf("UDP push                : %s, every %" PRIu32 " s\n", metrics_push_enabled ? "on" : "off", metrics_push_interval_ms / 1000u);
+    printf("Scrapes/cached/pushes   : %" PRIu32 " / %" PRIu32 " / %" PRIu32 "\n",
+           metrics_scrapes->value, metrics_http_cached, metrics_pushes->value);
+    printf("Renders                 : %" PRIu32 ", average %" PRIu32 " us, %" PRIu32 " truncated\n",
+           renders, (renders != 0u) ? (metrics_render_us->sum / renders) : 0u, metrics_truncated->value);
+    printf("Text buffer             : %u bytes\n", (unsigned)metrics_text_size);
+    printf("Exporter traffic        : %" PRIu32 " bytes in %" PRIu32 " frames\n",
+           metrics_export_bytes->value, metrics_export_frames->value);
+    printf("Exporter airtime        : %" PRIu32 " us total, %" PRIu32 " us per export\n",
+           metrics_export_airtime->value, (exports != 0u) ? (metrics_export_airtime->value / exports) : 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_command
+********************************************************************************
+* Summary:
+* This function prints the metrics, starts or stops the exporters, or prints
+* their cost.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int metrics_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if(!metrics_initialized)
+    {
+        printf("Metrics registry not initialized\n");
+        return -1;
+    }
+
+    if(argc < 2)
+    {
+        lock_prof_get(&metrics_mutex, CY_RTOS_NEVER_TIMEOUT);
+        metrics_export_text(NULL, false);
+        if(metrics_text_length != 0u)
+        {
+            printf("%s", metrics_text);
+        }
+        lock_prof_set(&metrics_mutex);
+    }
+    else if(!strcmp(argv[1], "http"))
+    {
+        uint16_t port = (argc > 2) ? (uint16_t)strtoul(argv[2], NULL, 0) : (uint16_t)METRICS_HTTP_DEFAULT_PORT;
+
+        result = metrics_http_start(port);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            printf("Metrics served at http://<IP address>:%u/metrics\n", (unsigned)metrics_http_port);
+        }
+    }
+    else if(!strcmp(argv[1], "push") && (argc > 2))
+    {
+        uint16_t port = (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) : (uint16_t)METRICS_PUSH_DEFAULT_PORT;
+        uint32_t interval_s = (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 0) : METRICS_PUSH_DEFAULT_INTERVAL_S;
+
+        result = metrics_push_start(argv[2], port, interval_s);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            printf("Pushing metrics to %s:%u every %" PRIu32 " s\n", argv[2], (unsigned)port, interval_s);
+        }
+    }
+    else if(!strcmp(argv[1], "stop"))
+    {
+        metrics_push_stop();
+    }
+    else if(!strcmp(argv[1], "stats"))
+    {
+        metrics_print_stats();
+    }
+    else
+    {
+        printf("Usage: metrics [http [port]|push <host> [port] [interval_s]|stop|stats]\n");
+        return -1;
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed: 0x%08" PRIx32 "\n", result);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: metrics_add_commands
+********************************************************************************
+* Summary:
+* This function registers the metrics commands table.
+*
+*******************************************************************************/
+cy_rslt_t metrics_add_commands(void)
+{
+    return cy_command_console_add_table(metrics_commands_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,106 @@
+/******************************************************************************
+* File Name:   metrics.h
+*
+* Description: This file contains the declarations for the metrics registry
+*              and its Prometheus HTTP and UDP push exporters.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include "cy_result.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define METRICS_MAX                     (32u)
+#define METRICS_HISTOGRAM_BUCKETS       (8u)
+
+/* HTTP scrapes closer than this reuse the previous exposition text */
+#define METRICS_HTTP_CACHE_MS           (1000u)
+#define METRICS_HTTP_DEFAULT_PORT       (9100u)
+
+/* UDP push: datagrams are split at line boundaries */
+#define METRICS_PUSH_DEFAULT_PORT       (9125u)
+#define METRICS_PUSH_DEFAULT_INTERVAL_S (60u)
+#define METRICS_PUSH_DATAGRAM_MAX       (1200u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    METRICS_COUNTER = 0,
+    METRICS_GAUGE,
+    METRICS_HISTOGRAM
+} metrics_type_t;
+
+typedef struct metrics_entry metrics_entry_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t metrics_init(void);
+
+/* Registration returns NULL when the registry is full; updates ignore NULL */
+metrics_entry_t* metrics_counter(const char *name, const char *help);
+metrics_entry_t* metrics_gauge(const char *name, const char *help);
+metrics_entry_t* metrics_histogram(const char *name, const char *help, const uint32_t *bounds, uint32_t count);
+
+void metrics_add(metrics_entry_t *metric, uint32_t delta);
+void metrics_set(metrics_entry_t *metric, int32_t value);
+void metrics_observe(metrics_entry_t *metric, uint32_t value);
+void metrics_frame(bool tx, uint32_t length);
+
+size_t metrics_render(char *buffer, size_t size, const char *labels, bool help);
+
+cy_rslt_t metrics_http_start(uint16_t port);
+cy_rslt_t metrics_push_start(const char *host, uint16_t port, uint32_t interval_s);
+void metrics_push_stop(void);
+cy_rslt_t metrics_add_commands(void);
+
+#endif /* METRICS_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,1188 @@
+/******************************************************************************
+* File Name:   mqtt_client.c
+*
+* Description: This file implements a small MQTT 3.1.1 client (QoS 0 and 1
+*              publish, keepalive) over secure sockets. While an iTWT
+*              agreement is active, publishes are queued and sent together at
+*              the start of the next predicted SP, the keepalive is a whole
+*              number of wake intervals and PINGREQs go out in the last SP
+*              before it expires, and QoS 1 retransmissions wait for the SP
+*              after the one the PUBACK could have arrived in.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "cy_secure_sockets.h"
+#include "lock_prof.h"
+#include "mqtt_client.h"
+#include "socket_init.h"
+#include "tls_session.h"
+#include "twt_session.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* The thread reconnects, which runs the TLS handshake on MQTT_CLIENT_TLS_PORT */
+#define MQTT_CLIENT_THREAD_STACK        (4096u)
+#define MQTT_CLIENT_POLL_MS             (1000u)
+#define MQTT_CLIENT_IO_TIMEOUT_MS       (5000u)
+#define MQTT_CLIENT_RECONNECT_MS        (5000u)
+#define MQTT_CLIENT_HOST_LEN            (64u)
+#define MQTT_CLIENT_TX_BUFFER_LEN       (8u + MQTT_CLIENT_TOPIC_LEN + MQTT_CLIENT_PAYLOAD_LEN)
+#define MQTT_CLIENT_RX_BUFFER_LEN       (8u + MQTT_CLIENT_TOPIC_LEN + MQTT_CLIENT_PAYLOAD_LEN)
+
+/* MQTT 3.1.1 control packet types (upper nibble of the first byte) */
+#define MQTT_PACKET_CONNECT             (0x10u)
+#define MQTT_PACKET_CONNACK             (0x20u)
+#define MQTT_PACKET_PUBLISH             (0x30u)
+#define MQTT_PACKET_PUBACK              (0x40u)
+#define MQTT_PACKET_PINGREQ             (0xC0u)
+#define MQTT_PACKET_PINGRESP            (0xD0u)
+#define MQTT_PACKET_DISCONNECT          (0xE0u)
+
+#define MQTT_PUBLISH_DUP                (0x08u)
+#define MQTT_CONNECT_CLEAN_SESSION      (0x02u)
+#define MQTT_PROTOCOL_LEVEL_3_1_1       (0x04u)
+
+#define MQTT_CLIENT_ERROR               ((cy_rslt_t)-1)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    char     topic[MQTT_CLIENT_TOPIC_LEN];
+    uint8_t  payload[MQTT_CLIENT_PAYLOAD_LEN];
+    uint16_t length;
+    uint8_t  qos;
+} mqtt_client_message_t;
+
+typedef struct
+{
+    bool                  used;
+    uint16_t              packet_id;
+    cy_time_t             sent_ms;
+    mqtt_client_message_t message;
+} mqtt_client_inflight_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int mqtt_command(int argc, char* argv[], tlv_buffer_t** data);
+static cy_rslt_t mqtt_connect(void);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static cy_thread_t mqtt_thread;
+static uint64_t mqtt_thread_stack[MQTT_CLIENT_THREAD_STACK / sizeof(uint64_t)];
+static cy_queue_t mqtt_queue;
+static cy_semaphore_t mqtt_wakeup;
+static cy_mutex_t mqtt_mutex;
+static bool mqtt_initialized;
+
+static cy_socket_t mqtt_socket;
+static volatile bool mqtt_connected;
+static volatile bool mqtt_sp_pending;
+static uint16_t mqtt_keepalive_s;
+static uint16_t mqtt_next_packet_id;
+static cy_time_t mqtt_last_tx_ms;
+static cy_time_t mqtt_ping_sent_ms;
+static bool mqtt_ping_outstanding;
+
+/* Broker of the last "mqtt connect", reconnected to until "mqtt disconnect" */
+static char mqtt_host[MQTT_CLIENT_HOST_LEN];
+static char mqtt_client_id[MQTT_CLIENT_CLIENT_ID_LEN];
+static uint16_t mqtt_port;
+static bool mqtt_reconnect;
+static cy_time_t mqtt_reconnect_ms;
+
+static mqtt_client_inflight_t mqtt_inflight[MQTT_CLIENT_MAX_INFLIGHT];
+static mqtt_client_stats_t mqtt_stats;
+static uint8_t mqtt_tx_buffer[MQTT_CLIENT_TX_BUFFER_LEN];
+static uint8_t mqtt_rx_buffer[MQTT_CLIENT_RX_BUFFER_LEN];
+
+#define MQTT_COMMANDS \
+    { (char *) "mqtt", mqtt_command, 1, NULL, NULL, (char *) "<connect <host> [port] [client_id]|pub <topic> <message> [qos]|burst <topic> <count> <interval_ms> [qos]|disconnect|stats [reset]>", (char *) "MQTT client with publishes and keepalives aligned to iTWT SPs" }, \
+
+const cy_command_console_cmd_t mqtt_commands_table[] =
+{
+    MQTT_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_keepalive_s
+********************************************************************************
+* Summary:
+* This function returns the keepalive to negotiate: 'target_s' rounded up to
+* a whole number of wake intervals, and at least two wake intervals so that a
+* PINGREQ sent in an SP always reaches the broker before the keepalive
+* expires.
+*
+* Parameters:
+*  uint32_t wake_interval_us : wake interval, 0 without iTWT
+*  uint16_t target_s         : keepalive aimed for
+*
+* Return:
+*  uint16_t : keepalive in seconds
+*
+*******************************************************************************/
+uint16_t mqtt_client_keepalive_s(uint32_t wake_interval_us, uint16_t target_s)
+{
+    uint64_t wi_ms = wake_interval_us / 1000u;
+    uint64_t intervals;
+    uint64_t keepalive_s;
+
+    if(wi_ms == 0u)
+    {
+        return target_s;
+    }
+
+    intervals = (((uint64_t)target_s * 1000u) + wi_ms - 1u) / wi_ms;
+    if(intervals < 2u)
+    {
+        intervals = 2u;
+    }
+
+    keepalive_s = ((intervals * wi_ms) + 999u) / 1000u;
+
+    return (keepalive_s > UINT16_MAX) ? UINT16_MAX : (uint16_t)keepalive_s;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_retry_ms
+********************************************************************************
+* Summary:
+* This function returns the QoS 1 retransmission timeout.
+*
+* Parameters:
+*  uint32_t wake_interval_us : wake interval, 0 without iTWT
+*  uint32_t wake_duration_us : wake duration
+*
+* Return:
+*  uint32_t : timeout in milliseconds
+*
+*******************************************************************************/
+uint32_t mqtt_client_retry_ms(uint32_t wake_interval_us, uint32_t wake_duration_us)
+{
+    uint32_t twt_ms = ((2u * wake_interval_us) + wake_duration_us) / 1000u;
+
+    return (twt_ms > MQTT_CLIENT_QOS1_RETRY_MS) ? twt_ms : MQTT_CLIENT_QOS1_RETRY_MS;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_encode_length
+********************************************************************************
+* Summary:
+* This function encodes the remaining length of a packet and returns the
+* number of bytes written.
+*
+*******************************************************************************/
+static uint32_t mqtt_encode_length(uint8_t *buffer, uint32_t length)
+{
+    uint32_t count = 0;
+
+    do
+    {
+        uint8_t byte = (uint8_t)(length % 128u);
+
+        length /= 128u;
+        if(length != 0u)
+        {
+            byte |= 0x80u;
+        }
+        buffer[count++] = byte;
+    } while(length != 0u);
+
+    return count;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_encode_string
+********************************************************************************
+* Summary:
+* This function writes a length-prefixed UTF-8 string.
+*
+*******************************************************************************/
+static uint32_t mqtt_encode_string(uint8_t *buffer, const char *string)
+{
+    uint32_t length = (uint32_t)strlen(string);
+
+    buffer[0] = (uint8_t)(length >> 8);
+    buffer[1] = (uint8_t)length;
+    memcpy(&buffer[2], string, length);
+
+    return length + 2u;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_send
+********************************************************************************
+* Summary:
+* This function sends a whole packet. Must be called with the client mutex
+* held.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_send(const uint8_t *packet, uint32_t length)
+{
+    uint32_t sent = 0;
+    cy_rslt_t result;
+
+    while(sent < length)
+    {
+        uint32_t bytes = 0;
+
+        result = cy_socket_send(mqtt_socket, &packet[sent], length - sent, CY_SOCKET_FLAGS_NONE, &bytes);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        sent += bytes;
+    }
+
+    cy_rtos_get_time(&mqtt_last_tx_ms);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_send_publish
+********************************************************************************
+* Summary:
+* This function sends a PUBLISH packet.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_send_publish(const mqtt_client_message_t *message, uint16_t packet_id, bool dup)
+{
+    uint32_t remaining = 2u + (uint32_t)strlen(message->topic) + message->length + ((message->qos != 0u) ? 2u : 0u);
+    uint32_t offset = 0;
+
+    mqtt_tx_buffer[offset++] = (uint8_t)(MQTT_PACKET_PUBLISH | (dup ? MQTT_PUBLISH_DUP : 0u) | (message->qos << 1));
+    offset += mqtt_encode_length(&mqtt_tx_buffer[offset], remaining);
+    offset += mqtt_encode_string(&mqtt_tx_buffer[offset], message->topic);
+    if(message->qos != 0u)
+    {
+        mqtt_tx_buffer[offset++] = (uint8_t)(packet_id >> 8);
+        mqtt_tx_buffer[offset++] = (uint8_t)packet_id;
+    }
+    memcpy(&mqtt_tx_buffer[offset], message->payload, message->length);
+    offset += message->length;
+
+    return mqtt_send(mqtt_tx_buffer, offset);
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_send_simple
+********************************************************************************
+* Summary:
+* This function sends a packet made of a type byte and an optional packet
+* identifier (PINGREQ, DISCONNECT, PUBACK).
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_send_simple(uint8_t type, bool with_id, uint16_t packet_id)
+{
+    uint8_t packet[4] = { type, 0u, (uint8_t)(packet_id >> 8), (uint8_t)packet_id };
+
+    if(with_id)
+    {
+        packet[1] = 2u;
+        return mqtt_send(packet, 4u);
+    }
+
+    return mqtt_send(packet, 2u);
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_recv_exact
+********************************************************************************
+* Summary:
+* This function receives exactly 'length' bytes.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_recv_exact(uint8_t *buffer, uint32_t length)
+{
+    uint32_t received = 0;
+    cy_rslt_t result;
+
+    while(received < length)
+    {
+        uint32_t bytes = 0;
+
+        result = cy_socket_recv(mqtt_socket, &buffer[received], length - received, CY_SOCKET_FLAGS_NONE, &bytes);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        received += bytes;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_recv_packet
+********************************************************************************
+* Summary:
+* This function receives one packet. The variable part is stored in the
+* receive buffer, truncated to its size.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_recv_packet(uint8_t *type, uint32_t *length)
+{
+    uint32_t remaining = 0;
+    uint32_t shift = 0;
+    uint8_t byte;
+    cy_rslt_t result;
+
+    result = mqtt_recv_exact(type, 1u);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    do
+    {
+        result = mqtt_recv_exact(&byte, 1u);
+        if((result != CY_RSLT_SUCCESS) || (shift > 21u))
+        {
+            return MQTT_CLIENT_ERROR;
+        }
+        remaining |= (uint32_t)(byte & 0x7Fu) << shift;
+        shift += 7u;
+    } while((byte & 0x80u) != 0u);
+
+    *length = (remaining < sizeof(mqtt_rx_buffer)) ? remaining : sizeof(mqtt_rx_buffer);
+    result = mqtt_recv_exact(mqtt_rx_buffer, *length);
+
+    /* Discard what does not fit */
+    for(uint32_t left = remaining - *length; (result == CY_RSLT_SUCCESS) && (left != 0u); left--)
+    {
+        result = mqtt_recv_exact(&byte, 1u);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_close
+********************************************************************************
+* Summary:
+* This function closes the connection. Must be called with the client mutex
+* held.
+*
+*******************************************************************************/
+static void mqtt_close(void)
+{
+    if(mqtt_connected)
+    {
+        mqtt_connected = false;
+        cy_socket_disconnect(mqtt_socket, 0);
+        cy_socket_delete(mqtt_socket);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_handle_packets
+********************************************************************************
+* Summary:
+* This function processes the packets received from the broker. Must be
+* called with the client mutex held.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_handle_packets(void)
+{
+    uint32_t available = 0;
+    uint32_t option_length = sizeof(available);
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    while((result == CY_RSLT_SUCCESS) &&
+          (cy_socket_getsockopt(mqtt_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_BYTES_AVAILABLE,
+                                &available, &option_length) == CY_RSLT_SUCCESS) && (available != 0u))
+    {
+        uint8_t type;
+        uint32_t length;
+
+        result = mqtt_recv_packet(&type, &length);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+
+        switch(type & 0xF0u)
+        {
+            case MQTT_PACKET_PUBACK:
+                if(length >= 2u)
+                {
+                    uint16_t packet_id = (uint16_t)((mqtt_rx_buffer[0] << 8) | mqtt_rx_buffer[1]);
+
+                    for(uint32_t i = 0; i < MQTT_CLIENT_MAX_INFLIGHT; i++)
+                    {
+                        if(mqtt_inflight[i].used && (mqtt_inflight[i].packet_id == packet_id))
+                        {
+                            mqtt_inflight[i].used = false;
+                            mqtt_stats.pubacks++;
+                        }
+                    }
+                }
+                break;
+
+            case MQTT_PACKET_PINGRESP:
+                mqtt_ping_outstanding = false;
+                mqtt_stats.pingresps++;
+                break;
+
+            case MQTT_PACKET_PUBLISH:
+                /* No subscriptions are made; acknowledge QoS 1 deliveries anyway */
+                if(((type >> 1) & 0x03u) == 1u)
+                {
+                    uint32_t topic_length = (length >= 2u) ? (((uint32_t)mqtt_rx_buffer[0] << 8) | mqtt_rx_buffer[1]) : 0u;
+
+                    if(length >= topic_length + 4u)
+                    {
+                        result = mqtt_send_simple(MQTT_PACKET_PUBACK, true,
+                                                  (uint16_t)((mqtt_rx_buffer[topic_length + 2u] << 8) |
+                                                             mqtt_rx_buffer[topic_length + 3u]));
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_service
+********************************************************************************
+* Summary:
+* This function sends the queued publishes, the due QoS 1 retransmissions and
+* the PINGREQ if the keepalive would expire before the next opportunity to
+* send. With iTWT, this runs at the start of each SP and the next opportunity
+* is the next SP. Must be called with the client mutex held.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_service(bool in_sp)
+{
+    twt_session_agreement_t agreement;
+    mqtt_client_message_t message;
+    uint32_t wi_ms = 0;
+    uint32_t retry_ms;
+    uint32_t batch = 0;
+    uint32_t retransmits = 0;
+    cy_time_t now;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    /* The broker did not answer the last PINGREQ within a keepalive: the
+     * connection is dead even if the socket still looks fine */
+    cy_rtos_get_time(&now);
+    if(mqtt_ping_outstanding && ((uint32_t)(now - mqtt_ping_sent_ms) >= ((uint32_t)mqtt_keepalive_s * 1000u)))
+    {
+        printf("MQTT PINGRESP timeout\n");
+        mqtt_stats.ping_timeouts++;
+        return MQTT_CLIENT_ERROR;
+    }
+
+    twt_session_get(&agreement);
+    if(in_sp)
+    {
+        wi_ms = twt_session_wake_interval_us(&agreement) / 1000u;
+    }
+    retry_ms = mqtt_client_retry_ms(in_sp ? twt_session_wake_interval_us(&agreement) : 0u,
+                                    in_sp ? twt_session_wake_duration_us(&agreement) : 0u);
+
+    /* Publishes, as long as a QoS 1 publish would find an inflight slot */
+    while(result == CY_RSLT_SUCCESS)
+    {
+        mqtt_client_inflight_t *slot = NULL;
+
+        for(uint32_t i = 0; (slot == NULL) && (i < MQTT_CLIENT_MAX_INFLIGHT); i++)
+        {
+            if(!mqtt_inflight[i].used)
+            {
+                slot = &mqtt_inflight[i];
+            }
+        }
+
+        if((slot == NULL) || (cy_rtos_get_queue(&mqtt_queue, &message, 0, false) != CY_RSLT_SUCCESS))
+        {
+            break;
+        }
+
+        if(message.qos == 0u)
+        {
+            result = mqtt_send_publish(&message, 0u, false);
+        }
+        else
+        {
+            if(++mqtt_next_packet_id == 0u)
+            {
+                mqtt_next_packet_id = 1u;
+            }
+            slot->used = true;
+            slot->packet_id = mqtt_next_packet_id;
+            slot->message = message;
+            result = mqtt_send_publish(&message, slot->packet_id, false);
+            cy_rtos_get_time(&slot->sent_ms);
+        }
+
+        if(result == CY_RSLT_SUCCESS)
+        {
+            mqtt_stats.sent++;
+            batch++;
+        }
+    }
+
+    cy_rtos_get_time(&now);
+
+    /* Retransmissions due before the next opportunity to send */
+    for(uint32_t i = 0; (result == CY_RSLT_SUCCESS) && (i < MQTT_CLIENT_MAX_INFLIGHT); i++)
+    {
+        if(mqtt_inflight[i].used && ((uint32_t)(now + wi_ms - mqtt_inflight[i].sent_ms) >= retry_ms))
+        {
+            result = mqtt_send_publish(&mqtt_inflight[i].message, mqtt_inflight[i].packet_id, true);
+            mqtt_inflight[i].sent_ms = now;
+            mqtt_stats.retransmits++;
+            retransmits++;
+        }
+    }
+
+    /* Keepalive, unless the previous PINGREQ is still unanswered */
+    if((result == CY_RSLT_SUCCESS) && !mqtt_ping_outstanding &&
+       ((uint32_t)(now + wi_ms - mqtt_last_tx_ms) >= ((uint32_t)mqtt_keepalive_s * 1000u)))
+    {
+        result = mqtt_send_simple(MQTT_PACKET_PINGREQ, false, 0u);
+        mqtt_ping_outstanding = true;
+        mqtt_ping_sent_ms = now;
+        mqtt_stats.pingreqs++;
+        if((batch == 0u) && (retransmits == 0u))
+        {
+            mqtt_stats.keepalive_wakeups++;
+        }
+    }
+
+    if(in_sp && (batch != 0u))
+    {
+        mqtt_stats.sp_batches++;
+        mqtt_stats.sp_messages += batch;
+        if(batch > mqtt_stats.sp_batch_max)
+        {
+            mqtt_stats.sp_batch_max = batch;
+        }
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_sp_callback
+********************************************************************************
+* Summary:
+* SP listener waking the client thread at the start of each SP.
+*
+*******************************************************************************/
+static void mqtt_sp_callback(twt_sp_event_t event, void *arg)
+{
+    if((event == TWT_SP_START) && mqtt_connected)
+    {
+        mqtt_sp_pending = true;
+        cy_rtos_set_semaphore(&mqtt_wakeup, false);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_receive_callback
+********************************************************************************
+* Summary:
+* Secure sockets callback waking the client thread when data is received.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_receive_callback(cy_socket_t socket, void *arg)
+{
+    cy_rtos_set_semaphore(&mqtt_wakeup, false);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_thread_function
+********************************************************************************
+* Summary:
+* Client thread. Without iTWT, publishes are sent as soon as they are queued.
+* With iTWT, they wait for the next SP. A lost connection is reopened every
+* MQTT_CLIENT_RECONNECT_MS until "mqtt disconnect".
+*
+*******************************************************************************/
+static void mqtt_thread_function(cy_thread_arg_t arg)
+{
+    cy_rslt_t result;
+    cy_time_t now;
+
+    while(1)
+    {
+        cy_rtos_get_semaphore(&mqtt_wakeup, MQTT_CLIENT_POLL_MS, false);
+
+        lock_prof_get(&mqtt_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+        cy_rtos_get_time(&now);
+        if(!mqtt_connected && mqtt_reconnect &&
+           ((uint32_t)(now - mqtt_reconnect_ms) >= MQTT_CLIENT_RECONNECT_MS))
+        {
+            mqtt_reconnect_ms = now;
+            if(mqtt_connect() == CY_RSLT_SUCCESS)
+            {
+                printf("MQTT reconnected to %s:%u\n", mqtt_host, (unsigned)mqtt_port);
+                mqtt_stats.reconnects++;
+            }
+        }
+
+        if(mqtt_connected)
+        {
+            bool twt = twt_session_is_active();
+
+            result = mqtt_handle_packets();
+
+            if((result == CY_RSLT_SUCCESS) && (!twt || mqtt_sp_pending))
+            {
+                mqtt_sp_pending = false;
+                result = mqtt_service(twt);
+            }
+
+            if(result != CY_RSLT_SUCCESS)
+            {
+                printf("MQTT connection lost: 0x%08" PRIx32 "\n", result);
+                mqtt_close();
+                mqtt_reconnect_ms = now - MQTT_CLIENT_RECONNECT_MS;
+            }
+        }
+
+        lock_prof_set(&mqtt_mutex);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_init
+********************************************************************************
+* Summary:
+* This function creates the client thread and its resources on first use.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_client_init(void)
+{
+    cy_rslt_t result;
+
+    if(mqtt_initialized)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = socket_init();
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_init_queue(&mqtt_queue, MQTT_CLIENT_QUEUE_LENGTH, sizeof(mqtt_client_message_t));
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_init_semaphore(&mqtt_wakeup, 1, 0);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_init_mutex(&mqtt_mutex);
+        lock_prof_name(&mqtt_mutex, "mqtt");
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = twt_session_register_sp_callback(mqtt_sp_callback, NULL);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_thread_create(&mqtt_thread, mqtt_thread_function, "MQTT", mqtt_thread_stack,
+                                       MQTT_CLIENT_THREAD_STACK, CY_RTOS_PRIORITY_LOW, 0);
+    }
+
+    mqtt_initialized = (result == CY_RSLT_SUCCESS);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_open_socket
+********************************************************************************
+* Summary:
+* This function opens a TCP connection, or a TLS one on MQTT_CLIENT_TLS_PORT.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_open_socket(const char *host, uint16_t port)
+{
+    cy_socket_opt_callback_t callback = { .callback = mqtt_receive_callback, .arg = NULL };
+    uint32_t timeout = MQTT_CLIENT_IO_TIMEOUT_MS;
+    cy_socket_sockaddr_t address;
+    cy_rslt_t result;
+
+    if(port == MQTT_CLIENT_TLS_PORT)
+    {
+        result = tls_session_connect(host, port, CY_SOCKET_TLS_VERIFY_REQUIRED, &mqtt_socket);
+    }
+    else
+    {
+        memset(&address, 0, sizeof(address));
+        result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address.ip_address);
+        address.port = port;
+
+        if(result == CY_RSLT_SUCCESS)
+        {
+            result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP, &mqtt_socket);
+        }
+        if(result == CY_RSLT_SUCCESS)
+        {
+            result = cy_socket_connect(mqtt_socket, &address, sizeof(address));
+            if(result != CY_RSLT_SUCCESS)
+            {
+                cy_socket_delete(mqtt_socket);
+            }
+        }
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    result = cy_socket_setsockopt(mqtt_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_setsockopt(mqtt_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_setsockopt(mqtt_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RECEIVE_CALLBACK, &callback, sizeof(callback));
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        cy_socket_disconnect(mqtt_socket, 0);
+        cy_socket_delete(mqtt_socket);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_connect
+********************************************************************************
+* Summary:
+* This function connects to the broker last given to mqtt_client_connect()
+* with a clean session. The keepalive is derived from the wake interval of
+* the iTWT agreement in effect. Unacknowledged QoS 1 publishes are kept and
+* retransmitted on the new connection. Must be called with the client mutex
+* held.
+*
+*******************************************************************************/
+static cy_rslt_t mqtt_connect(void)
+{
+    twt_session_agreement_t agreement;
+    uint32_t offset = 0;
+    uint8_t type = 0;
+    uint32_t length = 0;
+    cy_rslt_t result;
+
+    mqtt_close();
+
+    result = mqtt_open_socket(mqtt_host, mqtt_port);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    twt_session_get(&agreement);
+    mqtt_keepalive_s = mqtt_client_keepalive_s(agreement.active ? twt_session_wake_interval_us(&agreement) : 0u,
+                                               MQTT_CLIENT_KEEPALIVE_S);
+
+    mqtt_tx_buffer[offset++] = MQTT_PACKET_CONNECT;
+    offset += mqtt_encode_length(&mqtt_tx_buffer[offset], 10u + 2u + (uint32_t)strlen(mqtt_client_id));
+    offset += mqtt_encode_string(&mqtt_tx_buffer[offset], "MQTT");
+    mqtt_tx_buffer[offset++] = MQTT_PROTOCOL_LEVEL_3_1_1;
+    mqtt_tx_buffer[offset++] = MQTT_CONNECT_CLEAN_SESSION;
+    mqtt_tx_buffer[offset++] = (uint8_t)(mqtt_keepalive_s >> 8);
+    mqtt_tx_buffer[offset++] = (uint8_t)mqtt_keepalive_s;
+    offset += mqtt_encode_string(&mqtt_tx_buffer[offset], mqtt_client_id);
+
+    result = mqtt_send(mqtt_tx_buffer, offset);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = mqtt_recv_packet(&type, &length);
+    }
+    if((result == CY_RSLT_SUCCESS) &&
+       (((type & 0xF0u) != MQTT_PACKET_CONNACK) || (length < 2u) || (mqtt_rx_buffer[1] != 0u)))
+    {
+        printf("MQTT broker refused the connection (return code %u)\n", (unsigned)mqtt_rx_buffer[1]);
+        result = MQTT_CLIENT_ERROR;
+    }
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        mqtt_ping_outstanding = false;
+        mqtt_connected = true;
+        mqtt_stats.connects++;
+        mqtt_stats.keepalive_s = mqtt_keepalive_s;
+    }
+    else
+    {
+        cy_socket_disconnect(mqtt_socket, 0);
+        cy_socket_delete(mqtt_socket);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_connect
+********************************************************************************
+* Summary:
+* This function connects to a broker with a clean session. Once connected, the
+* client thread reconnects to it when the connection is lost, including when
+* a PINGREQ is still unanswered after a keepalive.
+*
+* Parameters:
+*  const char *host      : broker name or address
+*  uint16_t port         : broker port; MQTT_CLIENT_TLS_PORT uses TLS
+*  const char *client_id : client identifier
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_connect(const char *host, uint16_t port, const char *client_id)
+{
+    cy_rslt_t result;
+
+    if((strlen(host) >= MQTT_CLIENT_HOST_LEN) || (strlen(client_id) >= MQTT_CLIENT_CLIENT_ID_LEN))
+    {
+        return MQTT_CLIENT_ERROR;
+    }
+
+    result = mqtt_client_init();
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    lock_prof_get(&mqtt_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    strncpy(mqtt_host, host, sizeof(mqtt_host) - 1);
+    strncpy(mqtt_client_id, client_id, sizeof(mqtt_client_id) - 1);
+    mqtt_port = port;
+    memset(mqtt_inflight, 0, sizeof(mqtt_inflight));
+
+    result = mqtt_connect();
+    mqtt_reconnect = (result == CY_RSLT_SUCCESS);
+
+    lock_prof_set(&mqtt_mutex);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_disconnect
+********************************************************************************
+* Summary:
+* This function sends DISCONNECT and closes the connection. Queued and
+* unacknowledged publishes are dropped.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_disconnect(void)
+{
+    mqtt_client_message_t message;
+
+    if(!mqtt_initialized)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    lock_prof_get(&mqtt_mutex, CY_RTOS_NEVER_TIMEOUT);
+    mqtt_reconnect = false;
+    if(mqtt_connected)
+    {
+        mqtt_send_simple(MQTT_PACKET_DISCONNECT, false, 0u);
+        mqtt_close();
+    }
+    while(cy_rtos_get_queue(&mqtt_queue, &message, 0, false) == CY_RSLT_SUCCESS)
+    {
+    }
+    lock_prof_set(&mqtt_mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_is_connected
+********************************************************************************
+* Summary:
+* This function tells whether the client is connected to a broker.
+*
+*******************************************************************************/
+bool mqtt_client_is_connected(void)
+{
+    return mqtt_connected;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_publish
+********************************************************************************
+* Summary:
+* This function queues a publish. It is sent right away without iTWT, or at
+* the start of the next SP with iTWT.
+*
+* Parameters:
+*  const char *topic     : topic name
+*  const void *payload   : message
+*  uint16_t length       : message length (max MQTT_CLIENT_PAYLOAD_LEN)
+*  uint8_t qos           : 0 or 1
+*
+* Return:
+*  cy_rslt_t : CY_RSLT_SUCCESS, or an error if not connected, the arguments
+*              are too long or the queue is full
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_publish(const char *topic, const void *payload, uint16_t length, uint8_t qos)
+{
+    mqtt_client_message_t message;
+
+    if(!mqtt_connected || (qos > 1u) || (length > MQTT_CLIENT_PAYLOAD_LEN) || (strlen(topic) >= MQTT_CLIENT_TOPIC_LEN))
+    {
+        return MQTT_CLIENT_ERROR;
+    }
+
+    memset(&message, 0, sizeof(message));
+    strncpy(message.topic, topic, sizeof(message.topic) - 1);
+    memcpy(message.payload, payload, length);
+    message.length = length;
+    message.qos = qos;
+
+    if(cy_rtos_put_queue(&mqtt_queue, &message, 0, false) != CY_RSLT_SUCCESS)
+    {
+        mqtt_stats.dropped++;
+        return MQTT_CLIENT_ERROR;
+    }
+
+    mqtt_stats.queued++;
+    if(!twt_session_is_active())
+    {
+        cy_rtos_set_semaphore(&mqtt_wakeup, false);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_get_stats
+********************************************************************************
+* Summary:
+* This function returns a copy of the client statistics.
+*
+*******************************************************************************/
+void mqtt_client_get_stats(mqtt_client_stats_t *stats)
+{
+    *stats = mqtt_stats;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_print_stats
+********************************************************************************
+* Summary:
+* This function prints the client statistics.
+*
+*******************************************************************************/
+static void mqtt_print_stats(void)
+{
+    mqtt_client_stats_t stats;
+
+    mqtt_client_get_stats(&stats);
+
+    printf("Connected          : %s (keepalive %u s)\n", mqtt_connected ? "yes" : "no", (unsigned)stats.keepalive_s);
+    printf("Publishes          : %" PRIu32 " queued, %" PRIu32 " sent, %" PRIu32 " dropped\n",
+           stats.queued, stats.sent, stats.dropped);
+    printf("QoS 1              : %" PRIu32 " PUBACKs, %" PRIu32 " retransmissions\n", stats.pubacks, stats.retransmits);
+    printf("Messages per SP    : avg %" PRIu32 ".%02" PRIu32 ", max %" PRIu32 " (%" PRIu32 " SPs with publishes)\n",
+           (stats.sp_batches != 0u) ? (stats.sp_messages / stats.sp_batches) : 0u,
+           (stats.sp_batches != 0u) ? (((stats.sp_messages * 100u) / stats.sp_batches) % 100u) : 0u,
+           stats.sp_batch_max, stats.sp_batches);
+    printf("Keepalive          : %" PRIu32 " PINGREQs, %" PRIu32 " PINGRESPs, %" PRIu32 " wakeups for keepalive only\n",
+           stats.pingreqs, stats.pingresps, stats.keepalive_wakeups);
+    printf("Reconnections      : %" PRIu32 " (%" PRIu32 " PINGRESP timeouts)\n", stats.reconnects, stats.ping_timeouts);
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_command
+********************************************************************************
+* Summary:
+* This function handles the "mqtt" command.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int mqtt_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if(!strcmp(argv[1], "connect") && (argc > 2))
+    {
+        uint16_t port = (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) : (uint16_t)MQTT_CLIENT_DEFAULT_PORT;
+        const char *client_id = (argc > 4) ? argv[4] : "twt-demo";
+
+        result = mqtt_client_connect(argv[2], port, client_id);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            printf("Connected to %s:%u, keepalive %u s\n", argv[2], (unsigned)port, (unsigned)mqtt_keepalive_s);
+        }
+    }
+    else if(!strcmp(argv[1], "pub") && (argc > 3))
+    {
+        uint8_t qos = (argc > 4) ? (uint8_t)strtoul(argv[4], NULL, 0) : 0u;
+
+        result = mqtt_client_publish(argv[2], argv[3], (uint16_t)strlen(argv[3]), qos);
+    }
+    else if(!strcmp(argv[1], "burst") && (argc > 4))
+    {
+        uint32_t count = (uint32_t)strtoul(argv[3], NULL, 0);
+        uint32_t interval_ms = (uint32_t)strtoul(argv[4], NULL, 0);
+        uint8_t qos = (argc > 5) ? (uint8_t)strtoul(argv[5], NULL, 0) : 0u;
+        char payload[16];
+
+        for(uint32_t i = 0; (i < count) && (result == CY_RSLT_SUCCESS); i++)
+        {
+            int length = snprintf(payload, sizeof(payload), "%" PRIu32, i);
+
+            result = mqtt_client_publish(argv[2], payload, (uint16_t)length, qos);
+            cy_rtos_delay_milliseconds(interval_ms);
+        }
+    }
+    else if(!strcmp(argv[1], "disconnect"))
+    {
+        result = mqtt_client_disconnect();
+    }
+    else if(!strcmp(argv[1], "stats"))
+    {
+        if((argc > 2) && !strcmp(argv[2], "reset"))
+        {
+            uint16_t keepalive_s = mqtt_stats.keepalive_s;
+
+            memset(&mqtt_stats, 0, sizeof(mqtt_stats));
+            mqtt_stats.keepalive_s = keepalive_s;
+        }
+        else
+        {
+            mqtt_print_stats();
+        }
+    }
+    else
+    {
+        printf("Usage: mqtt <connect <host> [port] [client_id]|pub <topic> <message> [qos]|"
+               "burst <topic> <count> <interval_ms> [qos]|disconnect|stats [reset]>\n");
+        return -1;
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("mqtt %s failed: 0x%08" PRIx32 "\n", argv[1], result);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: mqtt_client_add_commands
+********************************************************************************
+* Summary:
+* This function registers the MQTT commands table.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_add_commands(void)
+{
+    return cy_command_console_add_table(mqtt_commands_table);
+}
+
+
+/* [] END OF FILE */
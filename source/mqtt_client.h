@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name:   mqtt_client.h
+*
+* Description: This file contains the declarations for the MQTT 3.1.1 client
+*              that aligns publishes, QoS 1 retransmissions and keepalives
+*              with the iTWT service periods.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef MQTT_CLIENT_H_
+#define MQTT_CLIENT_H_
+
+#include "cy_result.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define MQTT_CLIENT_DEFAULT_PORT        (1883u)
+#define MQTT_CLIENT_TLS_PORT            (8883u)
+
+/* Publishes waiting for the next SP */
+#define MQTT_CLIENT_QUEUE_LENGTH        (8u)
+#define MQTT_CLIENT_TOPIC_LEN           (64u)
+#define MQTT_CLIENT_PAYLOAD_LEN         (128u)
+#define MQTT_CLIENT_CLIENT_ID_LEN       (24u)
+
+/* QoS 1 publishes awaiting PUBACK */
+#define MQTT_CLIENT_MAX_INFLIGHT        (4u)
+
+/* Keepalive aimed for; rounded to a whole number of wake intervals */
+#define MQTT_CLIENT_KEEPALIVE_S         (60u)
+
+/* PUBACK timeout without iTWT. With iTWT it is at least two wake intervals
+ * plus the wake duration, as the PUBACK may only arrive in the next SP. */
+#define MQTT_CLIENT_QOS1_RETRY_MS       (5000u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t connects;
+    uint16_t keepalive_s;
+    uint32_t queued;
+    uint32_t dropped;           /* Publishes rejected because the queue was full */
+    uint32_t sent;
+    uint32_t pubacks;
+    uint32_t retransmits;
+    uint32_t sp_batches;        /* SPs in which publishes were sent */
+    uint32_t sp_messages;       /* Publishes sent in those SPs */
+    uint32_t sp_batch_max;
+    uint32_t pingreqs;
+    uint32_t pingresps;
+    uint32_t keepalive_wakeups; /* PINGREQs sent with no other traffic */
+    uint32_t ping_timeouts;     /* PINGREQs unanswered after a keepalive */
+    uint32_t reconnects;
+} mqtt_client_stats_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint16_t mqtt_client_keepalive_s(uint32_t wake_interval_us, uint16_t target_s);
+uint32_t mqtt_client_retry_ms(uint32_t wake_interval_us, uint32_t wake_duration_us);
+
+cy_rslt_t mqtt_client_connect(const char *host, uint16_t port, const char *client_id);
+cy_rslt_t mqtt_client_disconnect(void);
+bool mqtt_client_is_connected(void);
+cy_rslt_t mqtt_client_publish(const char *topic, const void *payload, uint16_t length, uint8_t qos);
+void mqtt_client_get_stats(mqtt_client_stats_t *stats);
+cy_rslt_t mqtt_client_add_commands(void);
+
+#endif /* MQTT_CLIENT_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,106 @@
+/******************************************************************************
+* File Name:   packet_hooks.c
+*
+* Description: This file hooks the packet path between the network stack and
+*              WHD. The Makefile wraps the two functions below with the
+*              linker's --wrap option, so every Ethernet frame handed to or
+*              received from the WLAN passes through here.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "awake_est.h"
+#include "metrics.h"
+#include "pcap_capture.h"
+#include "ps_policy.h"
+#include "tcp_tune.h"
+#include "trace.h"
+
+/* Network buffer header file. */
+#include "cy_network_buffer.h"
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+whd_result_t __real_whd_network_send_ethernet_data(whd_interface_t ifp, whd_buffer_t buffer);
+whd_result_t __wrap_whd_network_send_ethernet_data(whd_interface_t ifp, whd_buffer_t buffer);
+void __real_cy_network_process_ethernet_data(whd_interface_t iface, whd_buffer_t buf);
+void __wrap_cy_network_process_ethernet_data(whd_interface_t iface, whd_buffer_t buf);
+
+
+/*******************************************************************************
+* Function Name: __wrap_whd_network_send_ethernet_data
+********************************************************************************
+* Summary:
+* TX hook: a frame is handed from the network stack to the WLAN.
+*
+*******************************************************************************/
+whd_result_t __wrap_whd_network_send_ethernet_data(whd_interface_t ifp, whd_buffer_t buffer)
+{
+    trace_record(TRACE_EVT_PKT_ENQUEUE, TRACE_QUEUE_WLAN_TX, cy_buffer_get_current_piece_size(buffer));
+    tcp_tune_frame(true, cy_buffer_get_current_piece_data_pointer(buffer), cy_buffer_get_current_piece_size(buffer));
+    metrics_frame(true, cy_buffer_get_current_piece_size(buffer));
+    awake_est_frame(cy_buffer_get_current_piece_size(buffer));
+    ps_policy_frame(cy_buffer_get_current_piece_size(buffer));
+    pcap_capture_frame(PCAP_CAPTURE_TX, cy_buffer_get_current_piece_data_pointer(buffer), cy_buffer_get_current_piece_size(buffer));
+
+    return __real_whd_network_send_ethernet_data(ifp, buffer);
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap_cy_network_process_ethernet_data
+********************************************************************************
+* Summary:
+* RX hook: a frame received by the WLAN is handed to the network stack.
+*
+*******************************************************************************/
+void __wrap_cy_network_process_ethernet_data(whd_interface_t iface, whd_buffer_t buf)
+{
+    trace_record(TRACE_EVT_PKT_DEQUEUE, TRACE_QUEUE_WLAN_RX, cy_buffer_get_current_piece_size(buf));
+    tcp_tune_frame(false, cy_buffer_get_current_piece_data_pointer(buf), cy_buffer_get_current_piece_size(buf));
+    metrics_frame(false, cy_buffer_get_current_piece_size(buf));
+    awake_est_frame(cy_buffer_get_current_piece_size(buf));
+    ps_policy_frame(cy_buffer_get_current_piece_size(buf));
+    pcap_capture_frame(PCAP_CAPTURE_RX, cy_buffer_get_current_piece_data_pointer(buf), cy_buffer_get_current_piece_size(buf));
+
+    __real_cy_network_process_ethernet_data(iface, buf);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,831 @@
+/******************************************************************************
+* File Name:   pcap_capture.c
+*
+* Description: This file implements an on-device packet capture. The headers
+*              of the Ethernet frames passed between the network stack and
+*              WHD, and the WHD connection, action frame and TWT events, are
+*              recorded in a RAM ring, time-stamped with the RTOS time and the
+*              cycle counter. "pcap dump" prints the ring as text lines on the
+*              console, "pcap send" sends the same lines to a host over TCP;
+*              tools/pcap_export.py writes them to a .pcap file.
+*
+*              Management frames are exchanged by the WLAN firmware and never
+*              reach the host. The firmware reports them as WHD events, which
+*              are recorded instead and exported as Broadcom event frames
+*              (Ethertype 0x886C).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "bench.h"
+#include "cycle_counter.h"
+#include "pcap_capture.h"
+#include "socket_init.h"
+
+/* Wi-Fi connection manager and WHD header files. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+
+/* Secure sockets header file. */
+#include "cy_secure_sockets.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Scratch ring written by the pcap_capture_frame benchmark */
+#define PCAP_CAPTURE_BENCH_RECORDS      (4u)
+
+#if ((PCAP_CAPTURE_RECORDS & (PCAP_CAPTURE_RECORDS - 1u)) != 0u)
+#error "PCAP_CAPTURE_RECORDS must be a power of two"
+#endif
+
+#define PCAP_CAPTURE_ETH_HEADER_LEN     (14u)
+#define PCAP_CAPTURE_ETHERTYPE_IPV4     (0x0800u)
+#define PCAP_CAPTURE_IP_PROTO_TCP       (6u)
+#define PCAP_CAPTURE_IP_PROTO_UDP       (17u)
+#define PCAP_CAPTURE_ALL_TYPES          ((1u << PCAP_CAPTURE_TX) | (1u << PCAP_CAPTURE_RX) | (1u << PCAP_CAPTURE_EVENT))
+
+/* Event record header: type, status, reason, data length (big endian), address */
+#define PCAP_CAPTURE_EVENT_HEADER_LEN   (22u)
+
+/* WHD events not defined by every WHD release; TWT ones are 11ax firmware events */
+#define PCAP_CAPTURE_WLC_E_ACTION_FRAME          (59u)
+#define PCAP_CAPTURE_WLC_E_ACTION_FRAME_COMPLETE (60u)
+#define PCAP_CAPTURE_WLC_E_TWT_SETUP             (157u)
+#define PCAP_CAPTURE_WLC_E_TWT_TEARDOWN          (158u)
+#define PCAP_CAPTURE_WLC_E_TWT_INFO_FRM          (159u)
+
+/* One dump line: header and two hexadecimal digits per byte */
+#define PCAP_CAPTURE_LINE_LEN           (48u + 2u * PCAP_CAPTURE_MAX_SNAPLEN)
+#define PCAP_CAPTURE_SEND_BUFFER        (1024u)
+#define PCAP_CAPTURE_SOCKET_TIMEOUT_MS  (5000u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t timestamp;             /* Cycle counter */
+    uint32_t time_ms;               /* RTOS time */
+    uint16_t orig_len;
+    uint8_t  cap_len;
+    uint8_t  type;                  /* pcap_capture_type_t */
+    uint8_t  data[PCAP_CAPTURE_MAX_SNAPLEN];
+} pcap_capture_record_t;
+
+/* Destination of the dump lines */
+typedef struct
+{
+    cy_socket_t socket;             /* NULL for the console */
+    cy_rslt_t   result;
+    uint32_t    length;
+    char        buffer[PCAP_CAPTURE_SEND_BUFFER];
+} pcap_capture_sink_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int pcap_command(int argc, char* argv[], tlv_buffer_t** data);
+static void* pcap_capture_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                                        const uint8_t *event_data, void *handler_user_data);
+static void pcap_capture_bench_frame(void *arg);
+
+/* Defined in main.c */
+extern whd_interface_t whd_ifs[2];
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static pcap_capture_record_t pcap_capture_ring[PCAP_CAPTURE_RECORDS];
+static uint32_t pcap_capture_head;      /* Number of records ever written */
+static pcap_capture_record_t pcap_capture_bench_ring[PCAP_CAPTURE_BENCH_RECORDS];
+static uint32_t pcap_capture_bench_head;
+static volatile bool pcap_capture_enabled;
+static uint32_t pcap_capture_snaplen = PCAP_CAPTURE_DEFAULT_SNAPLEN;
+static pcap_capture_filter_t pcap_capture_filter = { PCAP_CAPTURE_ALL_TYPES, 0, 0, 0 };
+static bool pcap_capture_events_registered;
+static uint16_t pcap_capture_event_index;
+
+/* Overhead of the capture, in cycles, and frames dropped by the filter */
+static uint32_t pcap_capture_calls;
+static uint64_t pcap_capture_cycles;
+static uint32_t pcap_capture_cycles_max;
+static uint32_t pcap_capture_filtered;
+
+static const uint32_t pcap_capture_events[] =
+{
+    WLC_E_SET_SSID, WLC_E_AUTH, WLC_E_DEAUTH, WLC_E_DEAUTH_IND, WLC_E_ASSOC, WLC_E_REASSOC,
+    WLC_E_DISASSOC_IND, WLC_E_LINK, WLC_E_ROAM, WLC_E_PSK_SUP,
+    PCAP_CAPTURE_WLC_E_ACTION_FRAME, PCAP_CAPTURE_WLC_E_ACTION_FRAME_COMPLETE,
+    PCAP_CAPTURE_WLC_E_TWT_SETUP, PCAP_CAPTURE_WLC_E_TWT_TEARDOWN, PCAP_CAPTURE_WLC_E_TWT_INFO_FRM,
+    WLC_E_NONE
+};
+
+/* 1500-byte UDP frame to port 5001 used by the capture benchmark */
+static const uint8_t pcap_capture_bench_packet[PCAP_CAPTURE_MAX_SNAPLEN] =
+{
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0xA0, 0x50, 0x01, 0x02, 0x03, 0x08, 0x00,
+    0x45, 0x00, 0x05, 0xDC, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11, 0x00, 0x00,
+    0xC0, 0xA8, 0x01, 0x64, 0xC0, 0xA8, 0x01, 0x01,
+    0xC3, 0x50, 0x13, 0x89, 0x05, 0xC8, 0x00, 0x00
+};
+
+#define PCAP_COMMANDS \
+    { (char *) "pcap", pcap_command, 1, NULL, NULL, (char *) "<start [snaplen]|stop|clear|filter ...|dump|send <host> [port]|status>", (char *) "Capture frame headers and WHD events, and export them for tools/pcap_export.py" }, \
+
+const cy_command_console_cmd_t pcap_capture_commands_table[] =
+{
+    PCAP_COMMANDS
+    CMD_TABLE_END
+};
+
+static const bench_case_t pcap_capture_bench_table[] =
+{
+    BENCH_CASE("pcap_capture_frame", NULL, pcap_capture_bench_frame, NULL, NULL)
+    BENCH_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_match
+********************************************************************************
+* Summary:
+* This function applies the filter to an Ethernet frame or an event.
+*
+*******************************************************************************/
+static bool pcap_capture_match(pcap_capture_type_t type, const uint8_t *data, uint32_t length)
+{
+    const pcap_capture_filter_t *filter = &pcap_capture_filter;
+    uint32_t ihl;
+    uint16_t ethertype;
+
+    if((filter->types & (1u << type)) == 0u)
+    {
+        return false;
+    }
+    if((type == PCAP_CAPTURE_EVENT) || ((filter->ethertype == 0u) && (filter->ip_protocol == 0u) && (filter->port == 0u)))
+    {
+        return true;
+    }
+    if(length < PCAP_CAPTURE_ETH_HEADER_LEN)
+    {
+        return false;
+    }
+
+    ethertype = (uint16_t)((data[12] << 8) | data[13]);
+    if((filter->ethertype != 0u) && (ethertype != filter->ethertype))
+    {
+        return false;
+    }
+    if((filter->ip_protocol == 0u) && (filter->port == 0u))
+    {
+        return true;
+    }
+
+    /* Protocol and port filters only match IPv4 */
+    if((ethertype != PCAP_CAPTURE_ETHERTYPE_IPV4) || (length < PCAP_CAPTURE_ETH_HEADER_LEN + 20u))
+    {
+        return false;
+    }
+    if((filter->ip_protocol != 0u) && (data[PCAP_CAPTURE_ETH_HEADER_LEN + 9u] != filter->ip_protocol))
+    {
+        return false;
+    }
+    if(filter->port == 0u)
+    {
+        return true;
+    }
+    if((data[PCAP_CAPTURE_ETH_HEADER_LEN + 9u] != PCAP_CAPTURE_IP_PROTO_TCP) &&
+       (data[PCAP_CAPTURE_ETH_HEADER_LEN + 9u] != PCAP_CAPTURE_IP_PROTO_UDP))
+    {
+        return false;
+    }
+
+    ihl = (data[PCAP_CAPTURE_ETH_HEADER_LEN] & 0x0Fu) * 4u;
+    if(length < PCAP_CAPTURE_ETH_HEADER_LEN + ihl + 4u)
+    {
+        return false;
+    }
+
+    data += PCAP_CAPTURE_ETH_HEADER_LEN + ihl;
+
+    return ((uint16_t)((data[0] << 8) | data[1]) == filter->port) ||
+           ((uint16_t)((data[2] << 8) | data[3]) == filter->port);
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_write
+********************************************************************************
+* Summary:
+* This function writes a record made of an optional header and the start of
+* the data, up to the snap length, at the head of a ring. When the ring is
+* full the oldest records are overwritten.
+*
+*******************************************************************************/
+static void pcap_capture_write(pcap_capture_record_t *ring, uint32_t mask, uint32_t *head,
+                               pcap_capture_type_t type, const uint8_t *header, uint32_t header_length,
+                               const uint8_t *data, uint32_t length)
+{
+    uint32_t snaplen = pcap_capture_snaplen;
+    uint32_t data_length = (header_length + length > snaplen) ? (snaplen - header_length) : length;
+    pcap_capture_record_t *record;
+    uint32_t state;
+    cy_time_t now;
+
+    cy_rtos_get_time(&now);
+
+    state = cyhal_system_critical_section_enter();
+    record = &ring[*head & mask];
+    record->timestamp = cycle_counter_get();
+    record->time_ms   = (uint32_t)now;
+    record->orig_len  = (uint16_t)(header_length + length);
+    record->cap_len   = (uint8_t)(header_length + data_length);
+    record->type      = (uint8_t)type;
+    if(header_length != 0u)
+    {
+        memcpy(record->data, header, header_length);
+    }
+    memcpy(&record->data[header_length], data, data_length);
+    (*head)++;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_frame
+********************************************************************************
+* Summary:
+* This function records the start of an Ethernet frame if capture is enabled
+* and the frame matches the filter. Called from the packet hooks.
+*
+* Parameters:
+*  pcap_capture_type_t type : PCAP_CAPTURE_TX or PCAP_CAPTURE_RX
+*  const uint8_t *data      : frame, starting with the Ethernet header
+*  uint32_t length          : frame length
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void pcap_capture_frame(pcap_capture_type_t type, const uint8_t *data, uint32_t length)
+{
+    uint32_t start;
+    uint32_t cycles;
+
+    if(!pcap_capture_enabled || (data == NULL))
+    {
+        return;
+    }
+
+    start = cycle_counter_get();
+
+    if(pcap_capture_match(type, data, length))
+    {
+        pcap_capture_write(pcap_capture_ring, PCAP_CAPTURE_RECORDS - 1u, &pcap_capture_head, type, NULL, 0,
+                           data, length);
+    }
+    else
+    {
+        pcap_capture_filtered++;
+    }
+
+    cycles = cycle_counter_get() - start;
+    pcap_capture_calls++;
+    pcap_capture_cycles += cycles;
+    if(cycles > pcap_capture_cycles_max)
+    {
+        pcap_capture_cycles_max = cycles;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_put_u32
+********************************************************************************
+* Summary:
+* This function stores a 32-bit value in network byte order.
+*
+*******************************************************************************/
+static uint8_t* pcap_capture_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+
+    return p + 4;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_event_handler
+********************************************************************************
+* Summary:
+* WHD event handler recording the event header and the start of its data,
+* e.g. the body of an action frame or the TWT parameters.
+*
+*******************************************************************************/
+static void* pcap_capture_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                                        const uint8_t *event_data, void *handler_user_data)
+{
+    uint8_t header[PCAP_CAPTURE_EVENT_HEADER_LEN];
+    uint8_t *p = header;
+
+    if(!pcap_capture_enabled || !pcap_capture_match(PCAP_CAPTURE_EVENT, NULL, 0))
+    {
+        return handler_user_data;
+    }
+
+    p = pcap_capture_put_u32(p, event_header->event_type);
+    p = pcap_capture_put_u32(p, event_header->status);
+    p = pcap_capture_put_u32(p, event_header->reason);
+    p = pcap_capture_put_u32(p, event_header->datalen);
+    memcpy(p, &event_header->addr, 6);
+
+    pcap_capture_write(pcap_capture_ring, PCAP_CAPTURE_RECORDS - 1u, &pcap_capture_head,
+                       PCAP_CAPTURE_EVENT, header, sizeof(header), event_data,
+                       (event_data != NULL) ? event_header->datalen : 0u);
+
+    return handler_user_data;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_start
+********************************************************************************
+* Summary:
+* This function starts recording, keeping 'snaplen' bytes of every frame.
+* The WHD event handler is registered on first use.
+*
+* Parameters:
+*  uint32_t snaplen : bytes kept per frame, PCAP_CAPTURE_EVENT_HEADER_LEN to
+*                     PCAP_CAPTURE_MAX_SNAPLEN
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t pcap_capture_start(uint32_t snaplen)
+{
+    whd_result_t result;
+
+    if((snaplen < PCAP_CAPTURE_EVENT_HEADER_LEN) || (snaplen > PCAP_CAPTURE_MAX_SNAPLEN))
+    {
+        return (cy_rslt_t)-1;
+    }
+
+    if(!pcap_capture_events_registered)
+    {
+        result = whd_wifi_set_event_handler(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], pcap_capture_events,
+                                            pcap_capture_event_handler, NULL, &pcap_capture_event_index);
+        if(result != WHD_SUCCESS)
+        {
+            return (cy_rslt_t)result;
+        }
+        pcap_capture_events_registered = true;
+    }
+
+    cycle_counter_init();
+
+    /* Records of different snap lengths may share the ring; each keeps its own */
+    pcap_capture_snaplen = snaplen;
+    pcap_capture_enabled = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_stop
+********************************************************************************
+* Summary:
+* This function stops recording. The records are kept.
+*
+*******************************************************************************/
+void pcap_capture_stop(void)
+{
+    pcap_capture_enabled = false;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_clear
+********************************************************************************
+* Summary:
+* This function drops all records and resets the overhead counters.
+*
+*******************************************************************************/
+void pcap_capture_clear(void)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    pcap_capture_head = 0;
+    pcap_capture_calls = 0;
+    pcap_capture_cycles = 0;
+    pcap_capture_cycles_max = 0;
+    pcap_capture_filtered = 0;
+
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_set_filter
+********************************************************************************
+* Summary:
+* This function replaces the capture filter.
+*
+*******************************************************************************/
+void pcap_capture_set_filter(const pcap_capture_filter_t *filter)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    pcap_capture_filter = *filter;
+
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_output
+********************************************************************************
+* Summary:
+* This function writes dump text to the console, or buffers it for a socket.
+*
+*******************************************************************************/
+static void pcap_capture_output(pcap_capture_sink_t *sink, const char *text, uint32_t length)
+{
+    if(sink->socket == NULL)
+    {
+        printf("%s", text);
+        return;
+    }
+
+    while((sink->result == CY_RSLT_SUCCESS) && (length != 0u))
+    {
+        uint32_t chunk = sizeof(sink->buffer) - sink->length;
+
+        if(chunk > length)
+        {
+            chunk = length;
+        }
+        memcpy(&sink->buffer[sink->length], text, chunk);
+        sink->length += chunk;
+        text += chunk;
+        length -= chunk;
+
+        if((sink->length == sizeof(sink->buffer)) || (length == 0u))
+        {
+            uint32_t offset = 0;
+
+            while((sink->result == CY_RSLT_SUCCESS) && (offset < sink->length))
+            {
+                uint32_t sent = 0;
+
+                sink->result = cy_socket_send(sink->socket, &sink->buffer[offset], sink->length - offset,
+                                              CY_SOCKET_FLAGS_NONE, &sent);
+                offset += sent;
+            }
+            sink->length = 0;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_dump
+********************************************************************************
+* Summary:
+* This function outputs the records, oldest first. Recording is paused while
+* dumping. Format (one record per line):
+*    PCAP <version> <cycle counter Hz> <number of records> <records lost>
+*    F <type> <RTOS time in ms> <cycle counter> <original length> <data>
+*    END
+* Numbers are decimal except the cycle counter and data (hexadecimal).
+*
+*******************************************************************************/
+static void pcap_capture_dump(pcap_capture_sink_t *sink)
+{
+    static const char hex[] = "0123456789abcdef";
+    static char line[PCAP_CAPTURE_LINE_LEN];
+    bool was_enabled = pcap_capture_enabled;
+    uint32_t count;
+    uint32_t first;
+    int length;
+
+    pcap_capture_enabled = false;
+
+    count = (pcap_capture_head > PCAP_CAPTURE_RECORDS) ? PCAP_CAPTURE_RECORDS : pcap_capture_head;
+    first = pcap_capture_head - count;
+
+    length = snprintf(line, sizeof(line), "PCAP %u %" PRIu32 " %" PRIu32 " %" PRIu32 "\n",
+                      (unsigned)PCAP_CAPTURE_FORMAT_VERSION, (uint32_t)CYCLE_COUNTER_HZ, count, pcap_capture_head - count);
+    pcap_capture_output(sink, line, (uint32_t)length);
+
+    for(uint32_t i = first; i != pcap_capture_head; i++)
+    {
+        const pcap_capture_record_t *record = &pcap_capture_ring[i & (PCAP_CAPTURE_RECORDS - 1u)];
+
+        length = snprintf(line, sizeof(line), "F %u %" PRIu32 " %08" PRIx32 " %u ", record->type,
+                          record->time_ms, record->timestamp, record->orig_len);
+        for(uint32_t j = 0; j < record->cap_len; j++)
+        {
+            line[length++] = hex[record->data[j] >> 4];
+            line[length++] = hex[record->data[j] & 0x0Fu];
+        }
+        line[length++] = '\n';
+        line[length] = '\0';
+        pcap_capture_output(sink, line, (uint32_t)length);
+    }
+
+    pcap_capture_output(sink, "END\n", 4);
+
+    pcap_capture_enabled = was_enabled;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_send
+********************************************************************************
+* Summary:
+* This function connects to tools/pcap_export.py listening on a host and
+* sends it the dump.
+*
+*******************************************************************************/
+static cy_rslt_t pcap_capture_send(const char *host, uint16_t port)
+{
+    static pcap_capture_sink_t sink;
+    cy_socket_sockaddr_t address;
+    uint32_t timeout = PCAP_CAPTURE_SOCKET_TIMEOUT_MS;
+    cy_rslt_t result;
+
+    memset(&address, 0, sizeof(address));
+
+    result = socket_init();
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address.ip_address);
+        address.port = port;
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP, &sink.socket);
+    }
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    cy_socket_setsockopt(sink.socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    result = cy_socket_connect(sink.socket, &address, sizeof(address));
+    if(result == CY_RSLT_SUCCESS)
+    {
+        sink.result = CY_RSLT_SUCCESS;
+        sink.length = 0;
+        pcap_capture_dump(&sink);
+        result = sink.result;
+        cy_socket_disconnect(sink.socket, 0);
+    }
+
+    cy_socket_delete(sink.socket);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_parse_filter
+********************************************************************************
+* Summary:
+* This function parses "<key> <value>" pairs of the filter command into
+* 'filter'. Returns false on an invalid pair.
+*
+*******************************************************************************/
+static bool pcap_capture_parse_filter(int argc, char* argv[], pcap_capture_filter_t *filter)
+{
+    for(int i = 0; i + 1 < argc; i += 2)
+    {
+        const char *key = argv[i];
+        const char *value = argv[i + 1];
+
+        if(!strcmp(key, "type"))
+        {
+            filter->types = !strcmp(value, "tx")    ? (uint8_t)(1u << PCAP_CAPTURE_TX) :
+                            !strcmp(value, "rx")    ? (uint8_t)(1u << PCAP_CAPTURE_RX) :
+                            !strcmp(value, "frame") ? (uint8_t)((1u << PCAP_CAPTURE_TX) | (1u << PCAP_CAPTURE_RX)) :
+                            !strcmp(value, "event") ? (uint8_t)(1u << PCAP_CAPTURE_EVENT) :
+                            !strcmp(value, "all")   ? (uint8_t)PCAP_CAPTURE_ALL_TYPES : 0u;
+            if(filter->types == 0u)
+            {
+                return false;
+            }
+        }
+        else if(!strcmp(key, "ethertype"))
+        {
+            filter->ethertype = (uint16_t)strtoul(value, NULL, 16);
+        }
+        else if(!strcmp(key, "proto"))
+        {
+            filter->ip_protocol = !strcmp(value, "tcp")  ? PCAP_CAPTURE_IP_PROTO_TCP :
+                                  !strcmp(value, "udp")  ? PCAP_CAPTURE_IP_PROTO_UDP :
+                                  !strcmp(value, "any")  ? 0u : (uint8_t)strtoul(value, NULL, 0);
+        }
+        else if(!strcmp(key, "port"))
+        {
+            filter->port = (uint16_t)strtoul(value, NULL, 0);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return (argc % 2) == 0;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_status
+********************************************************************************
+* Summary:
+* This function prints the capture state, filter and overhead.
+*
+*******************************************************************************/
+static void pcap_capture_status(void)
+{
+    uint32_t stored = (pcap_capture_head > PCAP_CAPTURE_RECORDS) ? PCAP_CAPTURE_RECORDS : pcap_capture_head;
+
+    printf("Capture %s, snap length %" PRIu32 " bytes, %" PRIu32 " records in a ring of %u, %" PRIu32 " overwritten\n",
+           pcap_capture_enabled ? "enabled" : "disabled", pcap_capture_snaplen, stored,
+           (unsigned)PCAP_CAPTURE_RECORDS, pcap_capture_head - stored);
+    printf("Filter: types 0x%02x, ethertype 0x%04x, IP protocol %u, port %u\n", pcap_capture_filter.types,
+           pcap_capture_filter.ethertype, pcap_capture_filter.ip_protocol, pcap_capture_filter.port);
+    printf("Frames examined %" PRIu32 ", filtered out %" PRIu32 ", average %" PRIu32 " ns, maximum %" PRIu32 " ns per frame\n",
+           pcap_capture_calls, pcap_capture_filtered,
+           (pcap_capture_calls != 0u) ? (uint32_t)cycle_counter_to_ns(pcap_capture_cycles / pcap_capture_calls) : 0u,
+           (uint32_t)cycle_counter_to_ns(pcap_capture_cycles_max));
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_command
+********************************************************************************
+* Summary:
+* This function handles the pcap command.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int pcap_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if(!strcmp(argv[1], "start"))
+    {
+        result = pcap_capture_start((argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : PCAP_CAPTURE_DEFAULT_SNAPLEN);
+    }
+    else if(!strcmp(argv[1], "stop"))
+    {
+        pcap_capture_stop();
+    }
+    else if(!strcmp(argv[1], "clear"))
+    {
+        pcap_capture_clear();
+    }
+    else if(!strcmp(argv[1], "filter"))
+    {
+        pcap_capture_filter_t filter = { PCAP_CAPTURE_ALL_TYPES, 0, 0, 0 };
+
+        if(!pcap_capture_parse_filter(argc - 2, &argv[2], &filter))
+        {
+            printf("Usage: pcap filter [type <tx|rx|frame|event|all>] [ethertype <hex>] [proto <tcp|udp|number>] [port <port>]\n");
+            return -1;
+        }
+        pcap_capture_set_filter(&filter);
+    }
+    else if(!strcmp(argv[1], "dump"))
+    {
+        pcap_capture_sink_t sink = { .socket = NULL };
+
+        pcap_capture_dump(&sink);
+    }
+    else if(!strcmp(argv[1], "send") && (argc > 2))
+    {
+        result = pcap_capture_send(argv[2], (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) : (uint16_t)PCAP_CAPTURE_DEFAULT_PORT);
+    }
+    else if(!strcmp(argv[1], "status"))
+    {
+        pcap_capture_status();
+    }
+    else
+    {
+        printf("Invalid argument '%s'\n", argv[1]);
+        return -1;
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed: 0x%08" PRIx32 "\n", result);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_bench_frame
+********************************************************************************
+* Summary:
+* Benchmark of the cost of filtering and recording one UDP frame while
+* capture is enabled. The frame goes to a scratch ring, so that benchmarking
+* neither adds records to the capture nor overwrites recorded ones, and it is
+* not counted in the overhead shown by "pcap status".
+*
+*******************************************************************************/
+static void pcap_capture_bench_frame(void *arg)
+{
+    if(pcap_capture_match(PCAP_CAPTURE_TX, pcap_capture_bench_packet, 1514u))
+    {
+        pcap_capture_write(pcap_capture_bench_ring, PCAP_CAPTURE_BENCH_RECORDS - 1u, &pcap_capture_bench_head,
+                           PCAP_CAPTURE_TX, NULL, 0, pcap_capture_bench_packet, 1514u);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: pcap_capture_add_commands
+********************************************************************************
+* Summary:
+* This function registers the pcap commands table and benchmark.
+*
+*******************************************************************************/
+cy_rslt_t pcap_capture_add_commands(void)
+{
+    cy_rslt_t result = bench_add_table(pcap_capture_bench_table);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    return cy_command_console_add_table(pcap_capture_commands_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/******************************************************************************
+* File Name:   pcap_capture.h
+*
+* Description: This file contains the declarations for the on-device packet
+*              capture ring and its export for tools/pcap_export.py.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef PCAP_CAPTURE_H_
+#define PCAP_CAPTURE_H_
+
+#include "cy_result.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of records kept in RAM; must be a power of two */
+#ifndef PCAP_CAPTURE_RECORDS
+#define PCAP_CAPTURE_RECORDS            (64u)
+#endif
+
+/* Bytes kept per frame; the default covers the Ethernet, IP and TCP headers */
+#define PCAP_CAPTURE_MAX_SNAPLEN        (128u)
+#define PCAP_CAPTURE_DEFAULT_SNAPLEN    (64u)
+
+#define PCAP_CAPTURE_DEFAULT_PORT       (19000u)
+#define PCAP_CAPTURE_FORMAT_VERSION     (1u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    PCAP_CAPTURE_TX = 0,            /* Ethernet frame, stack to WLAN */
+    PCAP_CAPTURE_RX,                /* Ethernet frame, WLAN to stack */
+    PCAP_CAPTURE_EVENT              /* WHD event: connection, action frame or TWT */
+} pcap_capture_type_t;
+
+/* Frames are kept when all non-zero fields match */
+typedef struct
+{
+    uint8_t  types;                 /* Mask of (1 << pcap_capture_type_t) */
+    uint8_t  ip_protocol;           /* IPv4 protocol, e.g. 6 for TCP */
+    uint16_t ethertype;
+    uint16_t port;                  /* TCP/UDP source or destination port */
+} pcap_capture_filter_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t pcap_capture_start(uint32_t snaplen);
+void pcap_capture_stop(void);
+void pcap_capture_clear(void);
+void pcap_capture_set_filter(const pcap_capture_filter_t *filter);
+void pcap_capture_frame(pcap_capture_type_t type, const uint8_t *data, uint32_t length);
+cy_rslt_t pcap_capture_add_commands(void);
+
+#endif /* PCAP_CAPTURE_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,331 @@
+/******************************************************************************
+* File Name:   ps_bench.c
+*
+* Description: This file implements the power-save benchmark. The same tgen
+*              workload is run without power save, with PM1 (PS-Poll), with
+*              PM2 and the given return-to-sleep timer, and with each iTWT
+*              profile, and a table of throughput, round-trip latency and
+*              estimated awake time is printed. The power-save state and the
+*              iTWT agreement in effect before the run are restored after it.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "awake_est.h"
+#include "ps_bench.h"
+#include "ps_policy.h"
+#include "tgen.h"
+#include "twt_session.h"
+#include "whd_prof.h"
+
+/* Wi-Fi connection manager and WHD header files. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define PS_BENCH_MAX_ARGS               (7)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    bool               valid;
+    tgen_result_t      tgen;
+    awake_est_result_t awake;
+} ps_bench_row_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int ps_bench_command(int argc, char* argv[], tlv_buffer_t** data);
+
+/* Defined in main.c */
+cy_rslt_t itwt_select(cy_wcm_itwt_profile_t profile);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern whd_interface_t whd_ifs[2];
+
+static const char *ps_bench_mode_names[PS_POLICY_MODES] = { "no-ps", "pm1", "pm2", "itwt idle", "itwt active" };
+
+static ps_bench_row_t ps_bench_rows[PS_POLICY_MODES];
+static tgen_config_t ps_bench_config;
+
+#define PS_BENCH_COMMANDS \
+    { (char *) "ps_bench", ps_bench_command, 0, NULL, NULL, (char *) "<host> [pm2_ret_ms] [<periodic|bursty|poisson> <interval_ms> <size|min-max> <count> [burst] [port]]", (char *) "Run the same traffic without power save, with PM1, PM2 and each iTWT profile and compare" }, \
+
+const cy_command_console_cmd_t ps_bench_commands_table[] =
+{
+    PS_BENCH_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: ps_bench_run
+********************************************************************************
+* Summary:
+* This function runs the workload in one mode.
+*
+*******************************************************************************/
+static void ps_bench_run(ps_policy_mode_t mode, uint16_t pm2_ret_ms)
+{
+    ps_bench_row_t *row = &ps_bench_rows[mode];
+    awake_est_config_t model;
+    cy_rslt_t result;
+
+    printf("%s...\n", ps_bench_mode_names[mode]);
+
+    result = ps_policy_apply(mode, pm2_ret_ms);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("  failed to set the mode: 0x%08" PRIx32 "\n", (uint32_t)result);
+        return;
+    }
+
+    cy_rtos_delay_milliseconds(PS_BENCH_SETTLE_MS);
+
+    awake_est_detect(&model);
+    if(mode == PS_POLICY_PM2)
+    {
+        model.mode = AWAKE_EST_PM2;
+        model.pm2_ret_ms = pm2_ret_ms;
+    }
+
+    awake_est_start(&model);
+    row->valid = (tgen_run(&ps_bench_config, &row->tgen) == 0);
+    awake_est_stop(&row->awake);
+
+    if(!row->valid)
+    {
+        printf("  run failed\n");
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_bench_restore
+********************************************************************************
+* Summary:
+* This function restores the iTWT profile and power-save mode saved before
+* the benchmark.
+*
+*******************************************************************************/
+static void ps_bench_restore(cy_wcm_itwt_profile_t profile, uint32_t pm, uint32_t pm2_ret_ms)
+{
+    whd_interface_t ifp = whd_ifs[CY_WCM_INTERFACE_TYPE_STA];
+
+    if(profile != CY_WCM_ITWT_PROFILE_NONE)
+    {
+        itwt_select(profile);
+        return;
+    }
+
+    itwt_select(CY_WCM_ITWT_PROFILE_NONE);
+    if(pm == 0u)
+    {
+        whd_wifi_disable_powersave(ifp);
+    }
+    else if(pm == 1u)
+    {
+        whd_wifi_enable_powersave(ifp);
+    }
+    else
+    {
+        whd_wifi_enable_powersave_with_throughput(ifp, (uint16_t)pm2_ret_ms);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_bench_print
+********************************************************************************
+* Summary:
+* This function prints the result table. Throughput counts the payload sent
+* and echoed over the time the traffic was sent.
+*
+*******************************************************************************/
+static void ps_bench_print(uint16_t pm2_ret_ms)
+{
+    printf("\n%s, %" PRIu32 " ms, %" PRIu32 "-%" PRIu32 " bytes, %" PRIu32 " packets; PM2 return-to-sleep %u ms\n",
+           tgen_profile_name(ps_bench_config.profile), ps_bench_config.interval_ms, ps_bench_config.size_min,
+           ps_bench_config.size_max, ps_bench_config.count, (unsigned)pm2_ret_ms);
+    printf("%-12s %6s %5s %7s %8s %8s %8s %9s %6s\n", "mode", "sent", "lost", "kbit/s", "p50(us)", "p95(us)",
+           "max(us)", "awake ms", "awake%");
+
+    for(uint32_t i = 0; i < PS_POLICY_MODES; i++)
+    {
+        const ps_bench_row_t *row = &ps_bench_rows[i];
+        uint32_t kbps;
+        uint32_t permille;
+
+        if(!row->valid)
+        {
+            printf("%-12s %6s\n", ps_bench_mode_names[i], "-");
+            continue;
+        }
+
+        kbps = (row->tgen.duration_ms != 0u) ?
+               (uint32_t)(((row->tgen.bytes + row->tgen.echo_bytes) * 8u) / row->tgen.duration_ms) : 0u;
+        permille = (row->awake.elapsed_ms != 0u) ?
+                   (uint32_t)(((uint64_t)row->awake.awake_ms * 1000u) / row->awake.elapsed_ms) : 0u;
+
+        printf("%-12s %6" PRIu32 " %5" PRIu32 " %7" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %9" PRIu32
+               " %4" PRIu32 ".%" PRIu32 "\n",
+               ps_bench_mode_names[i], row->tgen.sent, row->tgen.sent - row->tgen.received, kbps,
+               row->tgen.rtt_p50_us, row->tgen.rtt_p95_us, row->tgen.rtt_max_us, row->awake.awake_ms,
+               permille / 10u, permille % 10u);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_bench_command
+********************************************************************************
+* Summary:
+* This function runs the benchmark. The default workload is one 256-byte
+* packet every 100 ms, 100 times, against a tgen sink on 'host'.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int ps_bench_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    char *workload[PS_BENCH_MAX_ARGS] = { (char *) "periodic", NULL, (char *) "100", (char *) "256", (char *) "100" };
+    int workload_argc = 5;
+    uint32_t pm2_ret_ms = PS_BENCH_PM2_RET_DEFAULT_MS;
+    twt_session_agreement_t agreement;
+    uint32_t saved_pm = 0;
+    uint32_t saved_pm2_ret_ms = PS_BENCH_PM2_RET_DEFAULT_MS;
+
+    if(argc < 2)
+    {
+        printf("Usage: ps_bench <host> [pm2_ret_ms] [<periodic|bursty|poisson> <interval_ms> <size|min-max> <count> [burst] [port]]\n");
+        return -1;
+    }
+
+    workload[1] = argv[1];
+
+    if(argc > 2)
+    {
+        pm2_ret_ms = (uint32_t)strtoul(argv[2], NULL, 0);
+        if((pm2_ret_ms < PS_BENCH_PM2_RET_MIN_MS) || (pm2_ret_ms > PS_BENCH_PM2_RET_MAX_MS))
+        {
+            printf("The return-to-sleep timer must be between %u and %u ms\n", (unsigned)PS_BENCH_PM2_RET_MIN_MS,
+                   (unsigned)PS_BENCH_PM2_RET_MAX_MS);
+            return -1;
+        }
+        pm2_ret_ms = (pm2_ret_ms / 10u) * 10u;
+    }
+
+    if(argc > 3)
+    {
+        workload[0] = argv[3];
+        workload_argc = 2;
+        for(int i = 4; (i < argc) && (workload_argc < PS_BENCH_MAX_ARGS); i++)
+        {
+            workload[workload_argc++] = argv[i];
+        }
+    }
+
+    if(!tgen_parse(workload_argc, workload, &ps_bench_config))
+    {
+        printf("Invalid workload\n");
+        return -1;
+    }
+
+    if(!cy_wcm_is_connected_to_ap())
+    {
+        printf("Not connected to an AP\n");
+        return -1;
+    }
+
+    twt_session_get(&agreement);
+    whd_wifi_get_powersave_mode(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &saved_pm);
+    whd_prof_get_iovar_value(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], "pm2_sleep_ret", &saved_pm2_ret_ms);
+
+    memset(ps_bench_rows, 0, sizeof(ps_bench_rows));
+    for(uint32_t i = 0; i < PS_POLICY_MODES; i++)
+    {
+        ps_bench_run((ps_policy_mode_t)i, (uint16_t)pm2_ret_ms);
+    }
+
+    ps_bench_restore(agreement.active ? agreement.profile : CY_WCM_ITWT_PROFILE_NONE, saved_pm,
+                     (saved_pm2_ret_ms != 0u) ? saved_pm2_ret_ms : PS_BENCH_PM2_RET_DEFAULT_MS);
+
+    ps_bench_print((uint16_t)pm2_ret_ms);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: ps_bench_add_commands
+********************************************************************************
+* Summary:
+* This function registers the power-save benchmark command.
+*
+*******************************************************************************/
+cy_rslt_t ps_bench_add_commands(void)
+{
+    return cy_command_console_add_table(ps_bench_commands_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,769 @@
+/******************************************************************************
+* File Name:   ps_policy.c
+*
+* Description: This file implements the power-save mode policy. The frames
+*              sent and received are grouped into bursts; at the end of each
+*              observation window, the load, the mean gap between bursts and
+*              the largest burst select the mode:
+*              - PM0 for heavy or nearly continuous traffic, where power save
+*                only adds latency.
+*              - PM2 for moderate load, bursts too large for one SP, or gaps
+*                shorter than the active wake interval.
+*              - The active or idle iTWT profile when the gaps between bursts
+*                match its wake interval and the AP accepts iTWT. The data
+*                arriving in one wake interval must also fit in the SP at the
+*                current rate and error rates (See link_monitor.c): the idle
+*                profile gives way to the active one, and the active one to
+*                PM2, as the link degrades.
+*              - PM1 for sparse traffic when iTWT is not available.
+*              A new mode is applied after it has been selected for
+*              PS_POLICY_HOLD_WINDOWS windows in a row. The classifier also
+*              builds on Linux, to be run on recorded traffic traces.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "ps_policy.h"
+
+#if !defined(__linux__)
+#include "cyabs_rtos.h"
+#include "cyhal.h"
+#include "command_console.h"
+#include "link_monitor.h"
+#include "twt_session.h"
+
+/* Wi-Fi connection manager and WHD header files. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define PS_POLICY_THREAD_STACK          (2048u)
+
+/* PM2 return-to-sleep timer used by the policy */
+#define PS_POLICY_PM2_RET_MS            (200u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+#if !defined(__linux__)
+typedef struct
+{
+    cy_time_t            time_ms;
+    ps_policy_decision_t decision;
+    ps_policy_mode_t     from;
+    bool                 applied;
+    cy_rslt_t            result;
+} ps_policy_log_entry_t;
+#endif
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int ps_policy_command(int argc, char* argv[], tlv_buffer_t** data);
+
+/* Defined in main.c */
+cy_rslt_t itwt_select(cy_wcm_itwt_profile_t profile);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char *ps_policy_mode_names[PS_POLICY_MODES] = { "pm0", "pm1", "pm2", "itwt idle", "itwt active" };
+
+static const char *ps_policy_reason_names[PS_POLICY_REASONS] =
+{
+    "high load",
+    "short gaps",
+    "medium load",
+    "large bursts",
+    "gaps < active WI",
+    "gaps ~ active WI",
+    "gaps ~ idle WI",
+    "load > idle SP",
+    "load > active SP",
+    "no iTWT, short gaps",
+    "no iTWT, long gaps",
+};
+
+#if !defined(__linux__)
+extern whd_interface_t whd_ifs[2];
+
+static volatile bool ps_policy_enabled;
+static bool ps_policy_initialized;
+static uint32_t ps_policy_window_ms = PS_POLICY_WINDOW_MS;
+static ps_policy_window_t ps_policy_window;
+static ps_policy_state_t ps_policy_state;
+
+static ps_policy_log_entry_t ps_policy_log[PS_POLICY_LOG_ENTRIES];
+static uint32_t ps_policy_log_count;
+
+static cy_thread_t ps_policy_thread;
+static cy_semaphore_t ps_policy_wake;
+
+#define PS_POLICY_COMMANDS \
+    { (char *) "ps_policy", ps_policy_command, 0, NULL, NULL, (char *) "[start [window_s]|stop|log|clear]", (char *) "Select the power-save mode from the traffic pattern, or show the decisions" }, \
+
+const cy_command_console_cmd_t ps_policy_commands_table[] =
+{
+    PS_POLICY_COMMANDS
+    CMD_TABLE_END
+};
+#endif
+
+
+/*******************************************************************************
+* Function Name: ps_policy_mode_name
+********************************************************************************
+* Summary:
+* This function returns the name of a power-save mode.
+*
+* Parameters:
+*  ps_policy_mode_t mode
+*
+* Return:
+*  const char *
+*
+*******************************************************************************/
+const char *ps_policy_mode_name(ps_policy_mode_t mode)
+{
+    return (mode < PS_POLICY_MODES) ? ps_policy_mode_names[mode] : "?";
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_reason_name
+********************************************************************************
+* Summary:
+* This function returns a short description of the rule behind a decision.
+*
+* Parameters:
+*  ps_policy_reason_t reason
+*
+* Return:
+*  const char *
+*
+*******************************************************************************/
+const char *ps_policy_reason_name(ps_policy_reason_t reason)
+{
+    return (reason < PS_POLICY_REASONS) ? ps_policy_reason_names[reason] : "?";
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_window_reset
+********************************************************************************
+* Summary:
+* This function starts a new observation window.
+*
+* Parameters:
+*  ps_policy_window_t *window
+*  uint32_t now_ms : start of the window
+*
+*******************************************************************************/
+void ps_policy_window_reset(ps_policy_window_t *window, uint32_t now_ms)
+{
+    memset(window, 0, sizeof(*window));
+    window->start_ms = now_ms;
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_observe
+********************************************************************************
+* Summary:
+* This function adds a frame sent or received to the window. A frame more
+* than PS_POLICY_BURST_GAP_MS after the previous one starts a new burst.
+*
+* Parameters:
+*  ps_policy_window_t *window
+*  uint32_t now_ms : time of the frame
+*  uint32_t size   : bytes
+*
+*******************************************************************************/
+void ps_policy_observe(ps_policy_window_t *window, uint32_t now_ms, uint32_t size)
+{
+    if((window->frames == 0u) || ((now_ms - window->last_ms) > PS_POLICY_BURST_GAP_MS))
+    {
+        if(window->frames != 0u)
+        {
+            window->gap_sum_ms += now_ms - window->last_ms;
+        }
+        window->bursts++;
+        window->burst_frames = 0;
+        window->burst_bytes = 0;
+    }
+
+    window->frames++;
+    window->bytes += size;
+    window->burst_frames++;
+    window->burst_bytes += size;
+    window->last_ms = now_ms;
+
+    if(window->burst_frames > window->max_burst_frames)
+    {
+        window->max_burst_frames = window->burst_frames;
+    }
+    if(window->burst_bytes > window->max_burst_bytes)
+    {
+        window->max_burst_bytes = window->burst_bytes;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_classify
+********************************************************************************
+* Summary:
+* This function selects the power-save mode for the traffic of a window.
+*
+* Parameters:
+*  const ps_policy_window_t *window
+*  uint32_t now_ms                : end of the window
+*  bool twt_capable               : the AP accepts iTWT
+*  uint32_t sp_bytes              : data one SP carries on the link, 0 if unknown
+*  ps_policy_decision_t *decision : selected mode, rule and features
+*
+*******************************************************************************/
+void ps_policy_classify(const ps_policy_window_t *window, uint32_t now_ms, bool twt_capable, uint32_t sp_bytes,
+                        ps_policy_decision_t *decision)
+{
+    uint32_t elapsed_ms = now_ms - window->start_ms;
+
+    if(elapsed_ms == 0u)
+    {
+        elapsed_ms = 1u;
+    }
+    if(sp_bytes == 0u)
+    {
+        sp_bytes = PS_POLICY_SP_BYTES;
+    }
+
+    decision->frames = window->frames;
+    decision->load_kbps = (uint32_t)(((uint64_t)window->bytes * 8u) / elapsed_ms);
+    decision->mean_gap_ms = (window->bursts > 1u) ? (window->gap_sum_ms / (window->bursts - 1u)) : elapsed_ms;
+    decision->max_burst_bytes = window->max_burst_bytes;
+    decision->sp_bytes = sp_bytes;
+
+    if(decision->load_kbps > PS_POLICY_PM0_LOAD_KBPS)
+    {
+        decision->mode = PS_POLICY_PM0;
+        decision->reason = PS_POLICY_REASON_HIGH_LOAD;
+    }
+    else if((window->bursts > 1u) && (decision->mean_gap_ms < PS_POLICY_PM0_GAP_MS))
+    {
+        decision->mode = PS_POLICY_PM0;
+        decision->reason = PS_POLICY_REASON_SHORT_GAPS;
+    }
+    else if(decision->load_kbps > PS_POLICY_PM2_LOAD_KBPS)
+    {
+        decision->mode = PS_POLICY_PM2;
+        decision->reason = PS_POLICY_REASON_MEDIUM_LOAD;
+    }
+    else if(!twt_capable)
+    {
+        decision->mode = (decision->mean_gap_ms < PS_POLICY_PM1_GAP_MS) ? PS_POLICY_PM2 : PS_POLICY_PM1;
+        decision->reason = (decision->mean_gap_ms < PS_POLICY_PM1_GAP_MS) ? PS_POLICY_REASON_NO_TWT_SHORT :
+                                                                            PS_POLICY_REASON_NO_TWT_LONG;
+    }
+    else if(decision->max_burst_bytes > sp_bytes)
+    {
+        decision->mode = PS_POLICY_PM2;
+        decision->reason = PS_POLICY_REASON_LARGE_BURSTS;
+    }
+    else if(decision->mean_gap_ms < PS_POLICY_ITWT_ACTIVE_GAP_MS)
+    {
+        decision->mode = PS_POLICY_PM2;
+        decision->reason = PS_POLICY_REASON_GAPS_BELOW_WI;
+    }
+    else if(decision->mean_gap_ms < PS_POLICY_ITWT_IDLE_GAP_MS)
+    {
+        decision->mode = PS_POLICY_ITWT_ACTIVE;
+        decision->reason = PS_POLICY_REASON_GAPS_ACTIVE_WI;
+    }
+    else
+    {
+        decision->mode = PS_POLICY_ITWT_IDLE;
+        decision->reason = PS_POLICY_REASON_GAPS_IDLE_WI;
+    }
+
+    /* The data arriving in one wake interval must fit in an SP, or it backs up */
+    if((decision->mode == PS_POLICY_ITWT_IDLE) &&
+       ((((uint64_t)window->bytes * PS_POLICY_ITWT_IDLE_GAP_MS) / elapsed_ms) > sp_bytes))
+    {
+        decision->mode = PS_POLICY_ITWT_ACTIVE;
+        decision->reason = PS_POLICY_REASON_SP_SHORT_IDLE;
+    }
+    if((decision->mode == PS_POLICY_ITWT_ACTIVE) &&
+       ((((uint64_t)window->bytes * PS_POLICY_ITWT_ACTIVE_GAP_MS) / elapsed_ms) > sp_bytes))
+    {
+        decision->mode = PS_POLICY_PM2;
+        decision->reason = PS_POLICY_REASON_SP_SHORT_ACTIVE;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_state_init
+********************************************************************************
+* Summary:
+* This function sets the mode in effect and clears the hysteresis.
+*
+* Parameters:
+*  ps_policy_state_t *state
+*  ps_policy_mode_t mode : mode in effect
+*
+*******************************************************************************/
+void ps_policy_state_init(ps_policy_state_t *state, ps_policy_mode_t mode)
+{
+    state->current = mode;
+    state->candidate = mode;
+    state->count = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_hold
+********************************************************************************
+* Summary:
+* This function feeds a decision to the hysteresis. A mode other than the
+* current one is taken once it has been selected PS_POLICY_HOLD_WINDOWS
+* times in a row.
+*
+* Parameters:
+*  ps_policy_state_t *state
+*  ps_policy_mode_t mode : mode selected for the last window
+*
+* Return:
+*  bool : true if the current mode changed to 'mode'
+*
+*******************************************************************************/
+bool ps_policy_hold(ps_policy_state_t *state, ps_policy_mode_t mode)
+{
+    if(mode == state->current)
+    {
+        state->candidate = mode;
+        state->count = 0;
+        return false;
+    }
+
+    if(mode != state->candidate)
+    {
+        state->candidate = mode;
+        state->count = 0;
+    }
+
+    if(++state->count < PS_POLICY_HOLD_WINDOWS)
+    {
+        return false;
+    }
+
+    state->current = mode;
+    state->count = 0;
+    return true;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: ps_policy_apply
+********************************************************************************
+* Summary:
+* This function puts the STA in the given mode. The legacy modes are set on
+* a connection without iTWT; for the iTWT profiles, the AP is rejoined with
+* the profile and the power-save mode is left as the connection manager sets
+* it.
+*
+* Parameters:
+*  ps_policy_mode_t mode
+*  uint16_t pm2_ret_ms : PM2 return-to-sleep timer
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t ps_policy_apply(ps_policy_mode_t mode, uint16_t pm2_ret_ms)
+{
+    whd_interface_t ifp = whd_ifs[CY_WCM_INTERFACE_TYPE_STA];
+    cy_wcm_itwt_profile_t profile = (mode == PS_POLICY_ITWT_IDLE)   ? CY_WCM_ITWT_PROFILE_IDLE :
+                                    (mode == PS_POLICY_ITWT_ACTIVE) ? CY_WCM_ITWT_PROFILE_ACTIVE :
+                                                                      CY_WCM_ITWT_PROFILE_NONE;
+    cy_rslt_t result = itwt_select(profile);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    switch(mode)
+    {
+        case PS_POLICY_PM0:
+            return whd_wifi_disable_powersave(ifp);
+
+        case PS_POLICY_PM1:
+            return whd_wifi_enable_powersave(ifp);
+
+        case PS_POLICY_PM2:
+            return whd_wifi_enable_powersave_with_throughput(ifp, pm2_ret_ms);
+
+        default:
+            return CY_RSLT_SUCCESS;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_frame
+********************************************************************************
+* Summary:
+* This function is called for every frame sent or received.
+*
+* Parameters:
+*  uint32_t size : frame length in bytes
+*
+*******************************************************************************/
+void ps_policy_frame(uint32_t size)
+{
+    cy_time_t now;
+    uint32_t state;
+
+    if(!ps_policy_enabled)
+    {
+        return;
+    }
+
+    cy_rtos_get_time(&now);
+
+    state = cyhal_system_critical_section_enter();
+    ps_policy_observe(&ps_policy_window, (uint32_t)now, size);
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_twt_capable
+********************************************************************************
+* Summary:
+* Tells whether the iTWT profiles may be selected: unless the AP rejected the
+* last TWT setup or tore the agreement down. Until the AP answers a setup,
+* it is assumed to support iTWT.
+*
+*******************************************************************************/
+static bool ps_policy_twt_capable(void)
+{
+    return twt_session_support() != TWT_SESSION_SUPPORT_REFUSED;
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_current_mode
+********************************************************************************
+* Summary:
+* Returns the mode in effect: the iTWT profile, or the WHD power-save mode.
+*
+*******************************************************************************/
+static ps_policy_mode_t ps_policy_current_mode(void)
+{
+    twt_session_agreement_t agreement;
+    uint32_t pm = 0;
+
+    twt_session_get(&agreement);
+    if(agreement.active)
+    {
+        return (agreement.profile == CY_WCM_ITWT_PROFILE_IDLE) ? PS_POLICY_ITWT_IDLE : PS_POLICY_ITWT_ACTIVE;
+    }
+
+    whd_wifi_get_powersave_mode(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &pm);
+
+    return (pm == 0u) ? PS_POLICY_PM0 : (pm == 1u) ? PS_POLICY_PM1 : PS_POLICY_PM2;
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_evaluate
+********************************************************************************
+* Summary:
+* Closes the observation window, logs the decision and applies the mode once
+* the hysteresis lets it through. An AP that does not set up the agreement
+* is marked as not accepting iTWT.
+*
+*******************************************************************************/
+static void ps_policy_evaluate(void)
+{
+    ps_policy_log_entry_t *entry = &ps_policy_log[ps_policy_log_count % PS_POLICY_LOG_ENTRIES];
+    ps_policy_window_t window;
+    link_monitor_sample_t link;
+    cy_time_t now;
+    uint32_t state;
+
+    link_monitor_sample(&link);
+    cy_rtos_get_time(&now);
+
+    state = cyhal_system_critical_section_enter();
+    window = ps_policy_window;
+    ps_policy_window_reset(&ps_policy_window, (uint32_t)now);
+    cyhal_system_critical_section_exit(state);
+
+    memset(entry, 0, sizeof(*entry));
+    entry->time_ms = now;
+    entry->from = ps_policy_state.current;
+    ps_policy_classify(&window, (uint32_t)now, ps_policy_twt_capable(), link.sp_bytes, &entry->decision);
+    ps_policy_log_count++;
+
+    if(!ps_policy_hold(&ps_policy_state, entry->decision.mode))
+    {
+        return;
+    }
+
+    entry->applied = true;
+    entry->result = ps_policy_apply(entry->decision.mode, PS_POLICY_PM2_RET_MS);
+
+    /* The mode in effect may differ from the one requested if the switch failed */
+    ps_policy_state_init(&ps_policy_state, ps_policy_current_mode());
+
+    /* Drop the traffic of the switch itself */
+    cy_rtos_get_time(&now);
+    state = cyhal_system_critical_section_enter();
+    ps_policy_window_reset(&ps_policy_window, (uint32_t)now);
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_thread_function
+********************************************************************************
+* Summary:
+* Evaluates the policy at the end of every window while it is enabled. The
+* thread blocks without timeout while the policy is stopped.
+*
+*******************************************************************************/
+static void ps_policy_thread_function(cy_thread_arg_t arg)
+{
+    for(;;)
+    {
+        cy_rslt_t result = cy_rtos_get_semaphore(&ps_policy_wake,
+                                                 ps_policy_enabled ? ps_policy_window_ms : CY_RTOS_NEVER_TIMEOUT,
+                                                 false);
+
+        if((result != CY_RSLT_SUCCESS) && ps_policy_enabled && cy_wcm_is_connected_to_ap())
+        {
+            ps_policy_evaluate();
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_print_log
+********************************************************************************
+* Summary:
+* Prints the decision log, oldest first.
+*
+*******************************************************************************/
+static void ps_policy_print_log(void)
+{
+    uint32_t count = (ps_policy_log_count < PS_POLICY_LOG_ENTRIES) ? ps_policy_log_count : PS_POLICY_LOG_ENTRIES;
+
+    printf("%10s %7s %7s %8s %9s %6s  %-12s %-20s %s\n", "time(ms)", "frames", "kbit/s", "gap(ms)", "burst(B)",
+           "SP(B)", "decision", "reason", "action");
+
+    for(uint32_t i = ps_policy_log_count - count; i < ps_policy_log_count; i++)
+    {
+        const ps_policy_log_entry_t *entry = &ps_policy_log[i % PS_POLICY_LOG_ENTRIES];
+
+        printf("%10" PRIu32 " %7" PRIu32 " %7" PRIu32 " %8" PRIu32 " %9" PRIu32 " %6" PRIu32 "  %-12s %-20s ",
+               (uint32_t)entry->time_ms, entry->decision.frames, entry->decision.load_kbps,
+               entry->decision.mean_gap_ms, entry->decision.max_burst_bytes, entry->decision.sp_bytes,
+               ps_policy_mode_name(entry->decision.mode), ps_policy_reason_name(entry->decision.reason));
+
+        if(!entry->applied)
+        {
+            printf("%s\n", (entry->decision.mode == entry->from) ? "keep" : "hold");
+        }
+        else if(entry->result != CY_RSLT_SUCCESS)
+        {
+            printf("%s -> failed 0x%08" PRIx32 "\n", ps_policy_mode_name(entry->from), (uint32_t)entry->result);
+        }
+        else
+        {
+            printf("%s -> %s\n", ps_policy_mode_name(entry->from), ps_policy_mode_name(entry->decision.mode));
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_command
+********************************************************************************
+* Summary:
+* This function starts or stops the policy, prints the decision log, or
+* shows the mode in effect and the traffic of the current window.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int ps_policy_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    ps_policy_window_t window;
+    ps_policy_decision_t decision;
+    link_monitor_sample_t link;
+    cy_time_t now;
+    uint32_t state;
+
+    if((argc >= 2) && !strcmp(argv[1], "start"))
+    {
+        uint32_t window_s = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : (PS_POLICY_WINDOW_MS / 1000u);
+
+        if(window_s == 0u)
+        {
+            printf("Invalid window\n");
+            return -1;
+        }
+
+        if(!ps_policy_initialized)
+        {
+            if((cy_rtos_init_semaphore(&ps_policy_wake, 1, 0) != CY_RSLT_SUCCESS) ||
+               (cy_rtos_thread_create(&ps_policy_thread, ps_policy_thread_function, "PsPolicy", NULL,
+                                      PS_POLICY_THREAD_STACK, CY_RTOS_PRIORITY_LOW, NULL) != CY_RSLT_SUCCESS))
+            {
+                printf("Failed to start the policy thread\n");
+                return -1;
+            }
+            ps_policy_initialized = true;
+        }
+
+        ps_policy_window_ms = window_s * 1000u;
+        ps_policy_state_init(&ps_policy_state, ps_policy_current_mode());
+        cy_rtos_get_time(&now);
+        state = cyhal_system_critical_section_enter();
+        ps_policy_window_reset(&ps_policy_window, (uint32_t)now);
+        cyhal_system_critical_section_exit(state);
+
+        ps_policy_enabled = true;
+        cy_rtos_set_semaphore(&ps_policy_wake, false);
+        printf("Policy started in %s, evaluated every %" PRIu32 " s\n", ps_policy_mode_name(ps_policy_state.current),
+               window_s);
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "stop"))
+    {
+        ps_policy_enabled = false;
+        if(ps_policy_initialized)
+        {
+            cy_rtos_set_semaphore(&ps_policy_wake, false);
+        }
+        printf("Policy stopped; the mode in effect is kept\n");
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "log"))
+    {
+        ps_policy_print_log();
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "clear"))
+    {
+        ps_policy_log_count = 0;
+        twt_session_reset_support();
+        return 0;
+    }
+
+    printf("Policy   : %s\n", ps_policy_enabled ? "running" : "stopped");
+    printf("Mode     : %s\n", ps_policy_mode_name(ps_policy_current_mode()));
+    printf("iTWT     : %s\n", (twt_session_support() == TWT_SESSION_SUPPORT_ACCEPTED) ? "accepted by the AP" :
+                             (twt_session_support() == TWT_SESSION_SUPPORT_REFUSED)  ? "refused by the AP" :
+                                                                                       "not answered by the AP yet");
+
+    if(ps_policy_enabled)
+    {
+        cy_rtos_get_time(&now);
+        state = cyhal_system_critical_section_enter();
+        window = ps_policy_window;
+        cyhal_system_critical_section_exit(state);
+
+        if(!link_monitor_last(&link))
+        {
+            link.sp_bytes = 0;
+        }
+
+        ps_policy_classify(&window, (uint32_t)now, ps_policy_twt_capable(), link.sp_bytes, &decision);
+        printf("Window   : %" PRIu32 " ms, %" PRIu32 " frames in %" PRIu32 " bursts, %" PRIu32 " kbit/s, mean gap %"
+               PRIu32 " ms, largest burst %" PRIu32 " bytes\n", (uint32_t)now - window.start_ms, window.frames,
+               window.bursts, decision.load_kbps, decision.mean_gap_ms, decision.max_burst_bytes);
+        printf("Leaning  : %s (%s)\n", ps_policy_mode_name(decision.mode), ps_policy_reason_name(decision.reason));
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: ps_policy_add_commands
+********************************************************************************
+* Summary:
+* This function registers the power-save policy command.
+*
+*******************************************************************************/
+cy_rslt_t ps_policy_add_commands(void)
+{
+    return cy_command_console_add_table(ps_policy_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,174 @@
+/******************************************************************************
+* File Name:   ps_policy.h
+*
+* Description: This file contains the declarations for the policy that
+*              selects the power-save mode (PM0, PM1, PM2 or an iTWT profile)
+*              from the observed traffic pattern.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef PS_POLICY_H_
+#define PS_POLICY_H_
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Observation window after which the mode is re-evaluated */
+#define PS_POLICY_WINDOW_MS             (10000u)
+
+/* Consecutive windows that must agree before the mode is changed */
+#define PS_POLICY_HOLD_WINDOWS          (2u)
+
+/* Frames closer than this belong to the same burst */
+#define PS_POLICY_BURST_GAP_MS          (10u)
+
+/* Above this load or below this mean gap between bursts, power save only adds latency */
+#define PS_POLICY_PM0_LOAD_KBPS         (2000u)
+#define PS_POLICY_PM0_GAP_MS            (20u)
+
+/* Above this load, stay awake between frames with PM2 */
+#define PS_POLICY_PM2_LOAD_KBPS         (200u)
+
+/* Wake intervals of the WCM active and idle iTWT profiles (See twt_session.h) */
+#define PS_POLICY_ITWT_ACTIVE_GAP_MS    (57u)
+#define PS_POLICY_ITWT_IDLE_GAP_MS      (614u)
+
+/* Wake duration of the WCM profiles, and data one SP carries without a link sample: 6 Mbit/s (See link_monitor.h) */
+#define PS_POLICY_SP_WD_US              (8192u)
+#define PS_POLICY_SP_BYTES              (3686u)
+
+/* Without iTWT, gaps shorter than this are left to the PM2 return-to-sleep timer */
+#define PS_POLICY_PM1_GAP_MS            (300u)
+
+/* Entries of the decision log */
+#define PS_POLICY_LOG_ENTRIES           (16u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    PS_POLICY_PM0 = 0,
+    PS_POLICY_PM1,
+    PS_POLICY_PM2,
+    PS_POLICY_ITWT_IDLE,
+    PS_POLICY_ITWT_ACTIVE,
+    PS_POLICY_MODES
+} ps_policy_mode_t;
+
+typedef enum
+{
+    PS_POLICY_REASON_HIGH_LOAD = 0,     /* Load above PS_POLICY_PM0_LOAD_KBPS */
+    PS_POLICY_REASON_SHORT_GAPS,        /* Bursts closer than PS_POLICY_PM0_GAP_MS */
+    PS_POLICY_REASON_MEDIUM_LOAD,       /* Load above PS_POLICY_PM2_LOAD_KBPS */
+    PS_POLICY_REASON_LARGE_BURSTS,      /* A burst does not fit in one SP */
+    PS_POLICY_REASON_GAPS_BELOW_WI,     /* Bursts closer than the active wake interval */
+    PS_POLICY_REASON_GAPS_ACTIVE_WI,    /* Bursts fit the active profile */
+    PS_POLICY_REASON_GAPS_IDLE_WI,      /* Bursts fit the idle profile */
+    PS_POLICY_REASON_SP_SHORT_IDLE,     /* Load per idle wake interval exceeds an SP */
+    PS_POLICY_REASON_SP_SHORT_ACTIVE,   /* Load per active wake interval exceeds an SP */
+    PS_POLICY_REASON_NO_TWT_SHORT,      /* No iTWT, bursts closer than PS_POLICY_PM1_GAP_MS */
+    PS_POLICY_REASON_NO_TWT_LONG,       /* No iTWT, sparse bursts */
+    PS_POLICY_REASONS
+} ps_policy_reason_t;
+
+/* Traffic seen in one observation window */
+typedef struct
+{
+    uint32_t start_ms;
+    uint32_t last_ms;           /* Time of the last frame */
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t bursts;
+    uint32_t gap_sum_ms;        /* Sum of the gaps between bursts */
+    uint32_t burst_bytes;       /* Bytes of the current burst */
+    uint32_t max_burst_frames;
+    uint32_t burst_frames;
+    uint32_t max_burst_bytes;
+} ps_policy_window_t;
+
+typedef struct
+{
+    ps_policy_mode_t   mode;
+    ps_policy_reason_t reason;
+    uint32_t           frames;
+    uint32_t           load_kbps;
+    uint32_t           mean_gap_ms;
+    uint32_t           max_burst_bytes;
+    uint32_t           sp_bytes;
+} ps_policy_decision_t;
+
+/* Hysteresis between the decisions and the mode applied */
+typedef struct
+{
+    ps_policy_mode_t current;
+    ps_policy_mode_t candidate;
+    uint32_t         count;
+} ps_policy_state_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+const char *ps_policy_mode_name(ps_policy_mode_t mode);
+const char *ps_policy_reason_name(ps_policy_reason_t reason);
+
+void ps_policy_window_reset(ps_policy_window_t *window, uint32_t now_ms);
+void ps_policy_observe(ps_policy_window_t *window, uint32_t now_ms, uint32_t size);
+void ps_policy_classify(const ps_policy_window_t *window, uint32_t now_ms, bool twt_capable, uint32_t sp_bytes,
+                        ps_policy_decision_t *decision);
+void ps_policy_state_init(ps_policy_state_t *state, ps_policy_mode_t mode);
+bool ps_policy_hold(ps_policy_state_t *state, ps_policy_mode_t mode);
+
+#if !defined(__linux__)
+cy_rslt_t ps_policy_apply(ps_policy_mode_t mode, uint16_t pm2_ret_ms);
+void ps_policy_frame(uint32_t size);
+cy_rslt_t ps_policy_add_commands(void);
+#endif
+
+#endif /* PS_POLICY_H_ */
+
+/* [] END OF FILE */
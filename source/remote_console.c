@@ -0,0 +1,901 @@
+/******************************************************************************
+* File Name:   remote_console.c
+*
+* Description: This file implements a command console over TCP (telnet). It
+*              runs the commands of the tables registered with the command
+*              console library, and sends their output over the connection
+*              instead of the 115200-baud UART.
+*
+*              With REMOTE_CONSOLE=1 in the Makefile, the table registration
+*              functions of the command console library and the C library
+*              _write() function are wrapped at link time: the first to learn
+*              the command tables, the second to capture the output of the
+*              threads serving a remote session.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "cy_secure_sockets.h"
+#include "lock_prof.h"
+#include "remote_console.h"
+#include "socket_init.h"
+
+/* ThreadX header file. */
+#include "tx_api.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define REMOTE_CONSOLE_THREAD_STACK     (4096u)
+#define REMOTE_CONSOLE_LINE_LEN         (85u)
+#define REMOTE_CONSOLE_MAX_ARGS         (32u)
+#define REMOTE_CONSOLE_RECV_LEN         (64u)
+#define REMOTE_CONSOLE_BENCH_LINE       (64u)
+#define REMOTE_CONSOLE_PROMPT           "> "
+#define REMOTE_CONSOLE_ERROR            ((cy_rslt_t)-1)
+
+/* Telnet commands */
+#define TELNET_IAC                      (255u)
+#define TELNET_SB                       (250u)
+#define TELNET_SE                       (240u)
+#define TELNET_WILL                     (251u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    TELNET_STATE_DATA = 0,
+    TELNET_STATE_IAC,
+    TELNET_STATE_OPTION,
+    TELNET_STATE_SB,
+    TELNET_STATE_SB_IAC
+} telnet_state_t;
+
+typedef struct
+{
+    volatile bool  active;
+    cy_socket_t    socket;
+    cy_thread_t    thread;
+    TX_THREAD     *tx_thread;
+    cy_semaphore_t start;
+    telnet_state_t telnet;
+    char           line[REMOTE_CONSOLE_LINE_LEN];
+    uint32_t       line_length;
+    char           output[REMOTE_CONSOLE_OUTPUT_BUFFER];
+    uint32_t       output_length;
+    bool           send_failed;
+
+    /* Statistics */
+    uint32_t       commands;
+    uint32_t       command_ms_total;
+    uint32_t       command_ms_max;
+    uint32_t       bytes_sent;
+    uint32_t       send_ms_total;
+} remote_console_session_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int console_bench_command(int argc, char* argv[], tlv_buffer_t** data);
+
+#if defined(APP_REMOTE_CONSOLE)
+int rconsole_command(int argc, char* argv[], tlv_buffer_t** data);
+static int remote_console_dispatch(int argc, char* argv[], tlv_buffer_t** data);
+
+cy_rslt_t __real_cy_command_console_add_table(const cy_command_console_cmd_t *commands);
+cy_rslt_t __wrap_cy_command_console_add_table(const cy_command_console_cmd_t *commands);
+cy_rslt_t __real_cy_command_console_delete_table(const cy_command_console_cmd_t *commands);
+cy_rslt_t __wrap_cy_command_console_delete_table(const cy_command_console_cmd_t *commands);
+int __real__write(int fd, const char *ptr, int len);
+int __wrap__write(int fd, const char *ptr, int len);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+#if defined(APP_REMOTE_CONSOLE)
+/* Tables registered by the application, and the copies registered with the
+ * command console library in their place (See remote_console_dispatch()) */
+static const cy_command_console_cmd_t *remote_console_tables[REMOTE_CONSOLE_MAX_TABLES];
+static cy_command_console_cmd_t *remote_console_uart_tables[REMOTE_CONSOLE_MAX_TABLES];
+static uint32_t remote_console_table_count;
+static remote_console_session_t remote_console_sessions[REMOTE_CONSOLE_MAX_SESSIONS];
+static cy_thread_t remote_console_listener;
+static cy_socket_t remote_console_server;
+static cy_mutex_t remote_console_exec_mutex;
+static bool remote_console_exec_mutex_ready;
+static uint16_t remote_console_port;
+static uint32_t remote_console_rejected;
+#endif
+
+#if defined(APP_REMOTE_CONSOLE)
+#define REMOTE_CONSOLE_COMMANDS \
+    { (char *) "rconsole", rconsole_command, 0, NULL, NULL, (char *) "[start [port]]", (char *) "Start the TCP console, or show its sessions" }, \
+    { (char *) "console_bench", console_bench_command, 0, NULL, NULL, (char *) "[bytes]", (char *) "Print 'bytes' of output and measure the output throughput of this console" }, \
+
+#else
+#define REMOTE_CONSOLE_COMMANDS \
+    { (char *) "console_bench", console_bench_command, 0, NULL, NULL, (char *) "[bytes]", (char *) "Print 'bytes' of output and measure the output throughput of this console" }, \
+
+#endif
+
+const cy_command_console_cmd_t remote_console_commands_table[] =
+{
+    REMOTE_CONSOLE_COMMANDS
+    CMD_TABLE_END
+};
+
+
+#if defined(APP_REMOTE_CONSOLE)
+/*******************************************************************************
+* Function Name: __wrap_cy_command_console_add_table
+********************************************************************************
+* Summary:
+* Records every command table registered with the command console library,
+* including those of the Wi-Fi and iPerf utilities, and registers a copy of
+* it whose handlers go through remote_console_dispatch(), so that the UART
+* console runs its commands under the same mutex as the remote sessions. The
+* mutex is created with the first table, before any command can run.
+*
+*******************************************************************************/
+cy_rslt_t __wrap_cy_command_console_add_table(const cy_command_console_cmd_t *commands)
+{
+    cy_command_console_cmd_t *uart_table = NULL;
+    uint32_t count = 0;
+    cy_rslt_t result;
+
+    if(!remote_console_exec_mutex_ready)
+    {
+        result = cy_rtos_init_mutex(&remote_console_exec_mutex);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        lock_prof_name(&remote_console_exec_mutex, "rconsole");
+        remote_console_exec_mutex_ready = true;
+    }
+
+    if(remote_console_table_count >= REMOTE_CONSOLE_MAX_TABLES)
+    {
+        printf("Remote console: more than %u command tables, increase REMOTE_CONSOLE_MAX_TABLES\n",
+               (unsigned)REMOTE_CONSOLE_MAX_TABLES);
+        return __real_cy_command_console_add_table(commands);
+    }
+
+    while(commands[count].name != NULL)
+    {
+        count++;
+    }
+    uart_table = malloc((count + 1u) * sizeof(*uart_table));
+    if(uart_table == NULL)
+    {
+        return REMOTE_CONSOLE_ERROR;
+    }
+    for(uint32_t i = 0; i <= count; i++)
+    {
+        uart_table[i] = commands[i];
+        if((i < count) && (commands[i].command != NULL))
+        {
+            uart_table[i].command = remote_console_dispatch;
+        }
+    }
+
+    result = __real_cy_command_console_add_table(uart_table);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        remote_console_tables[remote_console_table_count] = commands;
+        remote_console_uart_tables[remote_console_table_count] = uart_table;
+        remote_console_table_count++;
+    }
+    else
+    {
+        free(uart_table);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap_cy_command_console_delete_table
+********************************************************************************
+* Summary:
+* Removes the copy registered in place of a command table.
+*
+*******************************************************************************/
+cy_rslt_t __wrap_cy_command_console_delete_table(const cy_command_console_cmd_t *commands)
+{
+    for(uint32_t i = 0; i < remote_console_table_count; i++)
+    {
+        if(remote_console_tables[i] == commands)
+        {
+            cy_command_console_cmd_t *uart_table = remote_console_uart_tables[i];
+            cy_rslt_t result = __real_cy_command_console_delete_table(uart_table);
+
+            if(result == CY_RSLT_SUCCESS)
+            {
+                remote_console_table_count--;
+                remote_console_tables[i] = remote_console_tables[remote_console_table_count];
+                remote_console_uart_tables[i] = remote_console_uart_tables[remote_console_table_count];
+                free(uart_table);
+            }
+            return result;
+        }
+    }
+
+    return __real_cy_command_console_delete_table(commands);
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_current
+********************************************************************************
+* Summary:
+* This function returns the session served by the calling thread, or NULL.
+*
+*******************************************************************************/
+static remote_console_session_t* remote_console_current(void)
+{
+    TX_THREAD *self = tx_thread_identify();
+
+    for(uint32_t i = 0; i < REMOTE_CONSOLE_MAX_SESSIONS; i++)
+    {
+        if(remote_console_sessions[i].active && (remote_console_sessions[i].tx_thread == self))
+        {
+            return &remote_console_sessions[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_send
+********************************************************************************
+* Summary:
+* This function sends the buffered output of a session.
+*
+*******************************************************************************/
+static void remote_console_send(remote_console_session_t *session)
+{
+    uint32_t offset = 0;
+    cy_time_t start;
+    cy_time_t end;
+
+    cy_rtos_get_time(&start);
+
+    while(!session->send_failed && (offset < session->output_length))
+    {
+        uint32_t sent = 0;
+
+        if(cy_socket_send(session->socket, &session->output[offset], session->output_length - offset,
+                          CY_SOCKET_FLAGS_NONE, &sent) != CY_RSLT_SUCCESS)
+        {
+            session->send_failed = true;
+        }
+        offset += sent;
+    }
+
+    cy_rtos_get_time(&end);
+
+    session->bytes_sent += offset;
+    session->send_ms_total += (uint32_t)(end - start);
+    session->output_length = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_write
+********************************************************************************
+* Summary:
+* This function appends output to a session, converting LF to CRLF.
+*
+*******************************************************************************/
+static void remote_console_write(remote_console_session_t *session, const char *data, uint32_t length)
+{
+    for(uint32_t i = 0; i < length; i++)
+    {
+        if(session->output_length + 2u > sizeof(session->output))
+        {
+            remote_console_send(session);
+        }
+        if(data[i] == '\n')
+        {
+            session->output[session->output_length++] = '\r';
+        }
+        session->output[session->output_length++] = data[i];
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap__write
+********************************************************************************
+* Summary:
+* C library output hook: stdout and stderr of a thread serving a remote
+* session go to the session, everything else to the UART. The routing is by
+* the thread calling _write(), so remote_console_start() makes stdout
+* unbuffered: its newlib buffer is shared by all threads, and a flush from
+* one thread would send the output of others.
+*
+*******************************************************************************/
+int __wrap__write(int fd, const char *ptr, int len)
+{
+    remote_console_session_t *session;
+
+    if(((fd == 1) || (fd == 2)) && (len > 0) && ((session = remote_console_current()) != NULL))
+    {
+        remote_console_write(session, ptr, (uint32_t)len);
+        return len;
+    }
+
+    return __real__write(fd, ptr, len);
+}
+#endif /* APP_REMOTE_CONSOLE */
+
+
+/*******************************************************************************
+* Function Name: remote_console_flush
+********************************************************************************
+* Summary:
+* This function sends the output buffered for the session of the calling
+* thread. Nothing is done when called from another thread.
+*
+*******************************************************************************/
+void remote_console_flush(void)
+{
+    fflush(stdout);
+
+#if defined(APP_REMOTE_CONSOLE)
+    remote_console_session_t *session = remote_console_current();
+
+    if(session != NULL)
+    {
+        remote_console_send(session);
+    }
+#endif
+}
+
+
+#if defined(APP_REMOTE_CONSOLE)
+/*******************************************************************************
+* Function Name: remote_console_find
+********************************************************************************
+* Summary:
+* This function looks a command up in the registered tables.
+*
+*******************************************************************************/
+static const cy_command_console_cmd_t* remote_console_find(const char *name)
+{
+    for(uint32_t t = 0; t < remote_console_table_count; t++)
+    {
+        for(const cy_command_console_cmd_t *cmd = remote_console_tables[t]; cmd->name != NULL; cmd++)
+        {
+            if(!strcmp(cmd->name, name))
+            {
+                return cmd;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_dispatch
+********************************************************************************
+* Summary:
+* Handler of every command of the UART console: runs the handler of the
+* application, looked up by the command name, under the mutex that remote
+* sessions hold while they run a command.
+*
+*******************************************************************************/
+static int remote_console_dispatch(int argc, char* argv[], tlv_buffer_t** data)
+{
+    const cy_command_console_cmd_t *cmd = remote_console_find(argv[0]);
+    int status;
+
+    if(cmd == NULL)
+    {
+        return -1;
+    }
+
+    lock_prof_get(&remote_console_exec_mutex, CY_RTOS_NEVER_TIMEOUT);
+    status = cmd->command(argc, argv, data);
+    lock_prof_set(&remote_console_exec_mutex);
+
+    return status;
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_execute
+********************************************************************************
+* Summary:
+* This function runs a command line. Commands of all remote sessions and of
+* the UART console run one at a time, as the command handlers are written for
+* a single console.
+*
+*******************************************************************************/
+static void remote_console_execute(remote_console_session_t *session, char *line)
+{
+    char *argv[REMOTE_CONSOLE_MAX_ARGS];
+    char *save = NULL;
+    int argc = 0;
+    tlv_buffer_t *data = NULL;
+    const cy_command_console_cmd_t *cmd;
+    cy_time_t start;
+    cy_time_t end;
+
+    for(char *tok = strtok_r(line, " ", &save); (tok != NULL) && (argc < (int)REMOTE_CONSOLE_MAX_ARGS);
+        tok = strtok_r(NULL, " ", &save))
+    {
+        argv[argc++] = tok;
+    }
+
+    if(argc == 0)
+    {
+        return;
+    }
+
+    cy_rtos_get_time(&start);
+
+    if(!strcmp(argv[0], "help"))
+    {
+        for(uint32_t t = 0; t < remote_console_table_count; t++)
+        {
+            for(cmd = remote_console_tables[t]; cmd->name != NULL; cmd++)
+            {
+                printf("%-16s %s\n", cmd->name, (cmd->format != NULL) ? cmd->format : "");
+            }
+        }
+    }
+    else if((cmd = remote_console_find(argv[0])) == NULL)
+    {
+        printf("Unknown command '%s', enter 'help' for a list\n", argv[0]);
+    }
+    else if((argc - 1) < cmd->arg_count)
+    {
+        printf("Usage: %s %s\n", cmd->name, (cmd->format != NULL) ? cmd->format : "");
+    }
+    else
+    {
+        lock_prof_get(&remote_console_exec_mutex, CY_RTOS_NEVER_TIMEOUT);
+        cmd->command(argc, argv, &data);
+        lock_prof_set(&remote_console_exec_mutex);
+    }
+
+    remote_console_send(session);
+    cy_rtos_get_time(&end);
+
+    session->commands++;
+    session->command_ms_total += (uint32_t)(end - start);
+    if((uint32_t)(end - start) > session->command_ms_max)
+    {
+        session->command_ms_max = (uint32_t)(end - start);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_input
+********************************************************************************
+* Summary:
+* This function processes one received byte: telnet negotiation is skipped,
+* backspace edits the line and CR or LF runs it. Returns false when the
+* session is to be closed.
+*
+*******************************************************************************/
+static bool remote_console_input(remote_console_session_t *session, uint8_t byte)
+{
+    switch(session->telnet)
+    {
+        case TELNET_STATE_IAC:
+            session->telnet = (byte == TELNET_SB) ? TELNET_STATE_SB :
+                              (byte >= TELNET_WILL) && (byte != TELNET_IAC) ? TELNET_STATE_OPTION : TELNET_STATE_DATA;
+            return true;
+
+        case TELNET_STATE_OPTION:
+            session->telnet = TELNET_STATE_DATA;
+            return true;
+
+        case TELNET_STATE_SB:
+            session->telnet = (byte == TELNET_IAC) ? TELNET_STATE_SB_IAC : TELNET_STATE_SB;
+            return true;
+
+        case TELNET_STATE_SB_IAC:
+            session->telnet = (byte == TELNET_SE) ? TELNET_STATE_DATA : TELNET_STATE_SB;
+            return true;
+
+        default:
+            break;
+    }
+
+    if(byte == TELNET_IAC)
+    {
+        session->telnet = TELNET_STATE_IAC;
+    }
+    else if((byte == '\r') || (byte == '\n'))
+    {
+        if(session->line_length != 0u)
+        {
+            session->line[session->line_length] = '\0';
+            session->line_length = 0;
+
+            if(!strcmp(session->line, "exit") || !strcmp(session->line, "quit"))
+            {
+                return false;
+            }
+
+            remote_console_execute(session, session->line);
+            remote_console_write(session, REMOTE_CONSOLE_PROMPT, sizeof(REMOTE_CONSOLE_PROMPT) - 1u);
+            remote_console_send(session);
+        }
+    }
+    else if((byte == 0x08u) || (byte == 0x7Fu))
+    {
+        if(session->line_length != 0u)
+        {
+            session->line_length--;
+        }
+    }
+    else if((byte >= 0x20u) && (session->line_length < sizeof(session->line) - 1u))
+    {
+        session->line[session->line_length++] = (char)byte;
+    }
+
+    return !session->send_failed;
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_session_thread
+********************************************************************************
+* Summary:
+* Thread serving the sessions assigned to one slot.
+*
+*******************************************************************************/
+static void remote_console_session_thread(cy_thread_arg_t arg)
+{
+    remote_console_session_t *session = (remote_console_session_t *)arg;
+    uint32_t timeout = REMOTE_CONSOLE_IDLE_TIMEOUT_MS;
+    uint8_t buffer[REMOTE_CONSOLE_RECV_LEN];
+
+    session->tx_thread = tx_thread_identify();
+
+    while(1)
+    {
+        bool open = true;
+
+        cy_rtos_get_semaphore(&session->start, CY_RTOS_NEVER_TIMEOUT, false);
+
+        cy_socket_setsockopt(session->socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout, sizeof(timeout));
+        session->telnet = TELNET_STATE_DATA;
+        session->line_length = 0;
+        session->output_length = 0;
+        session->send_failed = false;
+
+        printf("TWT demo remote console, enter 'help' for the commands and 'exit' to close\n" REMOTE_CONSOLE_PROMPT);
+        remote_console_send(session);
+
+        while(open)
+        {
+            uint32_t received = 0;
+
+            if((cy_socket_recv(session->socket, buffer, sizeof(buffer), CY_SOCKET_FLAGS_NONE, &received) != CY_RSLT_SUCCESS) ||
+               (received == 0u))
+            {
+                break;
+            }
+
+            for(uint32_t i = 0; open && (i < received); i++)
+            {
+                open = remote_console_input(session, buffer[i]);
+            }
+        }
+
+        cy_socket_disconnect(session->socket, 0);
+        cy_socket_delete(session->socket);
+        session->active = false;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_listener_thread
+********************************************************************************
+* Summary:
+* Thread accepting connections and handing them to a free session slot.
+*
+*******************************************************************************/
+static void remote_console_listener_thread(cy_thread_arg_t arg)
+{
+    static const char busy[] = "All remote console sessions are in use\r\n";
+
+    while(1)
+    {
+        cy_socket_sockaddr_t peer;
+        uint32_t peer_length = sizeof(peer);
+        cy_socket_t client;
+        uint32_t sent = 0;
+        bool assigned = false;
+
+        if(cy_socket_accept(remote_console_server, &peer, &peer_length, &client) != CY_RSLT_SUCCESS)
+        {
+            cy_rtos_delay_milliseconds(100);
+            continue;
+        }
+
+        for(uint32_t i = 0; !assigned && (i < REMOTE_CONSOLE_MAX_SESSIONS); i++)
+        {
+            remote_console_session_t *session = &remote_console_sessions[i];
+
+            if(!session->active)
+            {
+                session->socket = client;
+                session->active = true;
+                cy_rtos_set_semaphore(&session->start, false);
+                assigned = true;
+            }
+        }
+
+        if(!assigned)
+        {
+            remote_console_rejected++;
+            cy_socket_send(client, busy, sizeof(busy) - 1u, CY_SOCKET_FLAGS_NONE, &sent);
+            cy_socket_disconnect(client, 0);
+            cy_socket_delete(client);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_start
+********************************************************************************
+* Summary:
+* This function starts listening for remote console connections. Thread
+* stacks are allocated from the heap. From then on stdout is unbuffered, so
+* that each printf() reaches _write() in the thread that called it; the
+* sessions buffer their output themselves.
+*
+* Parameters:
+*  uint16_t port : TCP port
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t remote_console_start(uint16_t port)
+{
+    cy_socket_sockaddr_t address;
+    cy_rslt_t result;
+
+    if(remote_console_port != 0u)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = socket_init();
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        fflush(stdout);
+        setvbuf(stdout, NULL, _IONBF, 0);
+    }
+
+    for(uint32_t i = 0; (result == CY_RSLT_SUCCESS) && (i < REMOTE_CONSOLE_MAX_SESSIONS); i++)
+    {
+        result = cy_rtos_init_semaphore(&remote_console_sessions[i].start, 1, 0);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            result = cy_rtos_thread_create(&remote_console_sessions[i].thread, remote_console_session_thread,
+                                           "RemoteConsole", NULL, REMOTE_CONSOLE_THREAD_STACK,
+                                           CY_RTOS_PRIORITY_NORMAL, &remote_console_sessions[i]);
+        }
+    }
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP,
+                                  &remote_console_server);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        memset(&address, 0, sizeof(address));
+        address.ip_address.version = CY_SOCKET_IP_VER_V4;
+        address.port = port;
+        result = cy_socket_bind(remote_console_server, &address, sizeof(address));
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_listen(remote_console_server, REMOTE_CONSOLE_MAX_SESSIONS);
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_thread_create(&remote_console_listener, remote_console_listener_thread,
+                                       "RemoteConsoleListener", NULL, 1024, CY_RTOS_PRIORITY_LOW, NULL);
+    }
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        remote_console_port = port;
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: rconsole_command
+********************************************************************************
+* Summary:
+* This function starts the remote console, or prints its sessions: commands
+* run, average/maximum time from the end of a command line to the last byte
+* of its output, and output throughput.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int rconsole_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    cy_rslt_t result;
+
+    if((argc > 1) && !strcmp(argv[1], "start"))
+    {
+        uint16_t port = (argc > 2) ? (uint16_t)strtoul(argv[2], NULL, 0) : (uint16_t)REMOTE_CONSOLE_DEFAULT_PORT;
+
+        result = remote_console_start(port);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            printf("Starting the remote console failed: 0x%08" PRIx32 "\n", result);
+            return -1;
+        }
+        printf("Remote console listening on TCP port %u\n", (unsigned)remote_console_port);
+        return 0;
+    }
+
+    if(remote_console_port == 0u)
+    {
+        printf("Remote console not started, enter 'rconsole start [port]'\n");
+        return 0;
+    }
+
+    printf("Listening on TCP port %u, %" PRIu32 " command tables, %" PRIu32 " connections refused\n",
+           (unsigned)remote_console_port, remote_console_table_count, remote_console_rejected);
+    printf("%-8s %-7s %9s %10s %10s %12s %10s\n", "session", "state", "commands", "avg (ms)", "max (ms)",
+           "bytes out", "kB/s out");
+
+    for(uint32_t i = 0; i < REMOTE_CONSOLE_MAX_SESSIONS; i++)
+    {
+        const remote_console_session_t *session = &remote_console_sessions[i];
+
+        printf("%-8" PRIu32 " %-7s %9" PRIu32 " %10" PRIu32 " %10" PRIu32 " %12" PRIu32 " %10" PRIu32 "\n",
+               i, session->active ? "open" : "idle", session->commands,
+               (session->commands != 0u) ? (session->command_ms_total / session->commands) : 0u,
+               session->command_ms_max, session->bytes_sent,
+               (session->send_ms_total != 0u) ? (session->bytes_sent / session->send_ms_total) : 0u);
+    }
+
+    return 0;
+}
+#endif /* APP_REMOTE_CONSOLE */
+
+
+/*******************************************************************************
+* Function Name: console_bench_command
+********************************************************************************
+* Summary:
+* This function prints 'bytes' bytes of text (default 4096) and the time it
+* took, including sending buffered output. Run it on the UART and on a remote
+* session to compare their output throughput.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int console_bench_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint32_t bytes = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 4096u;
+    char line[REMOTE_CONSOLE_BENCH_LINE + 1];
+    uint32_t printed = 0;
+    cy_time_t start;
+    cy_time_t end;
+
+    memset(line, '#', REMOTE_CONSOLE_BENCH_LINE - 1u);
+    line[REMOTE_CONSOLE_BENCH_LINE - 1u] = '\n';
+    line[REMOTE_CONSOLE_BENCH_LINE] = '\0';
+
+    cy_rtos_get_time(&start);
+    while(printed < bytes)
+    {
+        uint32_t chunk = ((bytes - printed) < REMOTE_CONSOLE_BENCH_LINE) ? (bytes - printed) : REMOTE_CONSOLE_BENCH_LINE;
+
+        printf("%.*s", (int)chunk, &line[REMOTE_CONSOLE_BENCH_LINE - chunk]);
+        printed += chunk;
+    }
+    remote_console_flush();
+    cy_rtos_get_time(&end);
+
+    printf("\n%" PRIu32 " bytes in %" PRIu32 " ms (%" PRIu32 " bytes/s)\n", bytes, (uint32_t)(end - start),
+           ((uint32_t)(end - start) != 0u) ? (uint32_t)(((uint64_t)bytes * 1000u) / (uint32_t)(end - start)) : 0u);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: remote_console_add_commands
+********************************************************************************
+* Summary:
+* This function registers the remote console commands table.
+*
+*******************************************************************************/
+cy_rslt_t remote_console_add_commands(void)
+{
+    return cy_command_console_add_table(remote_console_commands_table);
+}
+
+
+/* [] END OF FILE */
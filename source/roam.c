@@ -0,0 +1,988 @@
+/******************************************************************************
+* File Name:   roam.c
+*
+* Description: This file implements roaming within the configured network
+*              while keeping the iTWT agreement. While roaming is enabled,
+*              the RSSI is checked periodically; below the trigger, the SSID
+*              is scanned and the candidate with the best score is joined:
+*              the RSSI, plus a bonus for a TWT responder when an agreement
+*              is in effect and for fast transition (802.11r) support. The
+*              iTWT profile in effect is set up as part of the association to
+*              the new BSSID, so the agreement is back as soon as the STA is.
+*
+*              Roams done by the firmware itself, such as after a BSS
+*              transition request (802.11v), are seen as WLC_E_ROAM events;
+*              the agreement does not survive them and is set up again on the
+*              new BSSID. Each roam is logged with its latency and the time
+*              without an agreement (the TWT gap).
+*
+*              IE parsing and candidate selection also build on Linux (see
+*              tools/roam_host.c).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "roam.h"
+
+#if !defined(__linux__)
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "lock_prof.h"
+#include "twt_session.h"
+#include "whd_prof.h"
+
+/* Wi-Fi connection manager header file. */
+#include "cy_wcm.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Information elements */
+#define ROAM_IE_RSN                     (48u)
+#define ROAM_IE_MOBILITY_DOMAIN         (54u)
+#define ROAM_IE_RM_ENABLED_CAPS         (70u)
+#define ROAM_IE_EXT_CAPS                (127u)
+#define ROAM_IE_EXTENSION               (255u)
+#define ROAM_IE_EXT_HE_CAPS             (35u)
+
+/* RSN AKM suite types (OUI 00-0F-AC) using fast transition */
+#define ROAM_AKM_FT_8021X               (3u)
+#define ROAM_AKM_FT_PSK                 (4u)
+#define ROAM_AKM_FT_SAE                 (9u)
+
+/* Capability bits: RM Enabled Capabilities bit 1, Extended Capabilities bit 19,
+ * HE MAC Capabilities Information bit 2 */
+#define ROAM_RRM_NEIGHBOR_REPORT_BIT    (1u)
+#define ROAM_EXT_CAP_BSS_TRANSITION_BIT (19u)
+#define ROAM_HE_MAC_TWT_RESPONDER_BIT   (2u)
+
+#define ROAM_THREAD_STACK               (4096u)
+#define ROAM_SCAN_TIMEOUT_MS            (10000u)
+
+/* Wait for the AP to accept the agreement requested after a firmware roam */
+#define ROAM_TWT_ACCEPT_TIMEOUT_MS      (2000u)
+#define ROAM_TWT_ACCEPT_POLL_MS         (10u)
+
+/* Firmware support for neighbor reports and BSS transition management */
+#define ROAM_RRM_IOVAR                  "rrm"
+#define ROAM_RRM_NEIGHBOR_REPORT        (1u << ROAM_RRM_NEIGHBOR_REPORT_BIT)
+#define ROAM_WNM_IOVAR                  "wnm"
+#define ROAM_WNM_BSS_TRANSITION         (0x01u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+#if !defined(__linux__)
+typedef struct
+{
+    cy_time_t             time_ms;
+    uint8_t               from[6];
+    uint8_t               to[6];
+    int32_t               rssi_before_dbm;
+    int32_t               rssi_after_dbm;
+    bool                  firmware;       /* Roam done by the firmware; its latency is unknown */
+    cy_wcm_itwt_profile_t profile;
+    uint32_t              roam_ms;        /* Until associated with an IP address */
+    uint32_t              twt_gap_ms;     /* Without an agreement */
+    cy_rslt_t             result;
+} roam_record_t;
+#endif
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int roam_command(int argc, char* argv[], tlv_buffer_t** data);
+static void* roam_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                                const uint8_t *event_data, void *handler_user_data);
+
+/* Defined in main.c */
+cy_rslt_t ConnectWifi(cy_wcm_itwt_profile_t profile);
+cy_rslt_t ReassociateWifi(const uint8_t *bssid, cy_wcm_wifi_band_t band, cy_wcm_itwt_profile_t profile);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+#if !defined(__linux__)
+extern whd_interface_t whd_ifs[2];
+
+static const uint32_t roam_events[] = { WLC_E_ROAM, WLC_E_NONE };
+
+static uint16_t roam_event_index;
+static volatile bool roam_enabled;
+static int32_t roam_trigger_dbm = ROAM_TRIGGER_DBM;
+
+/* Firmware roam waiting for the agreement to be set up again */
+static volatile bool roam_fw_pending;
+static cy_time_t roam_fw_ms;
+static uint8_t roam_fw_bssid[6];
+
+static roam_candidate_t roam_candidates[ROAM_MAX_CANDIDATES];
+static uint32_t roam_candidate_count;
+
+/* Filled by the scan callback */
+static roam_candidate_t roam_scan_results[ROAM_MAX_CANDIDATES];
+static uint32_t roam_scan_count;
+
+static roam_record_t roam_history[ROAM_HISTORY];
+static uint32_t roam_count;
+static uint32_t roam_scans;
+
+static cy_thread_t roam_thread;
+static cy_semaphore_t roam_wake;
+static cy_semaphore_t roam_scan_done;
+static cy_mutex_t roam_scan_mutex;
+
+#define ROAM_COMMANDS \
+    { (char *) "roam", roam_command, 0, NULL, NULL, (char *) "[start [trigger_dbm]|stop|scan|to <bssid>|clear]", (char *) "Roam within the network keeping the iTWT agreement, or show the roams" }, \
+
+const cy_command_console_cmd_t roam_commands_table[] =
+{
+    ROAM_COMMANDS
+    CMD_TABLE_END
+};
+#endif
+
+
+/*******************************************************************************
+* Function Name: roam_has_bit
+********************************************************************************
+* Summary:
+* Returns whether bit 'bit' of a little-endian bit field of 'len' bytes is set.
+*
+*******************************************************************************/
+static bool roam_has_bit(const uint8_t *field, uint32_t len, uint32_t bit)
+{
+    return ((bit / 8u) < len) && ((field[bit / 8u] & (1u << (bit % 8u))) != 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: roam_rsn_has_ft
+********************************************************************************
+* Summary:
+* Returns whether an RSN element lists an FT AKM suite.
+*
+*******************************************************************************/
+static bool roam_rsn_has_ft(const uint8_t *rsn, uint32_t len)
+{
+    uint32_t offset = 2u + 4u;      /* Version, group data cipher suite */
+    uint32_t count;
+
+    if(len < offset + 2u)
+    {
+        return false;
+    }
+    count = (uint32_t)rsn[offset] | ((uint32_t)rsn[offset + 1u] << 8);
+    offset += 2u + (count * 4u);    /* Pairwise cipher suites */
+
+    if(len < offset + 2u)
+    {
+        return false;
+    }
+    count = (uint32_t)rsn[offset] | ((uint32_t)rsn[offset + 1u] << 8);
+    offset += 2u;
+
+    for(uint32_t i = 0; (i < count) && (offset + 4u <= len); i++, offset += 4u)
+    {
+        if((rsn[offset] == 0x00u) && (rsn[offset + 1u] == 0x0Fu) && (rsn[offset + 2u] == 0xACu) &&
+           ((rsn[offset + 3u] == ROAM_AKM_FT_8021X) || (rsn[offset + 3u] == ROAM_AKM_FT_PSK) ||
+            (rsn[offset + 3u] == ROAM_AKM_FT_SAE)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_parse_ies
+********************************************************************************
+* Summary:
+* This function returns the roaming capabilities advertised in the IEs of a
+* beacon or probe response. Truncated elements are ignored.
+*
+* Parameters:
+*  const uint8_t *ies : information elements
+*  uint32_t len       : length of the IEs
+*
+* Return:
+*  uint32_t : ROAM_CAP_* flags
+*
+*******************************************************************************/
+uint32_t roam_parse_ies(const uint8_t *ies, uint32_t len)
+{
+    uint32_t caps = 0;
+    uint32_t offset = 0;
+
+    while((ies != NULL) && (offset + 2u <= len))
+    {
+        uint8_t id = ies[offset];
+        uint8_t ie_len = ies[offset + 1u];
+        const uint8_t *body = &ies[offset + 2u];
+
+        if(offset + 2u + ie_len > len)
+        {
+            break;
+        }
+
+        switch(id)
+        {
+            case ROAM_IE_RSN:
+                caps |= roam_rsn_has_ft(body, ie_len) ? ROAM_CAP_FT : 0u;
+                break;
+
+            case ROAM_IE_MOBILITY_DOMAIN:
+                caps |= ROAM_CAP_FT;
+                break;
+
+            case ROAM_IE_RM_ENABLED_CAPS:
+                caps |= roam_has_bit(body, ie_len, ROAM_RRM_NEIGHBOR_REPORT_BIT) ? ROAM_CAP_RRM : 0u;
+                break;
+
+            case ROAM_IE_EXT_CAPS:
+                caps |= roam_has_bit(body, ie_len, ROAM_EXT_CAP_BSS_TRANSITION_BIT) ? ROAM_CAP_BTM : 0u;
+                break;
+
+            case ROAM_IE_EXTENSION:
+                if((ie_len >= 2u) && (body[0] == ROAM_IE_EXT_HE_CAPS) &&
+                   roam_has_bit(&body[1], ie_len - 1u, ROAM_HE_MAC_TWT_RESPONDER_BIT))
+                {
+                    caps |= ROAM_CAP_TWT;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        offset += 2u + ie_len;
+    }
+
+    return caps;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_score
+********************************************************************************
+* Summary:
+* This function returns the score of a candidate: its RSSI plus the bonuses.
+*
+* Parameters:
+*  const roam_candidate_t *candidate
+*  bool need_twt : an iTWT agreement is to be carried over
+*
+* Return:
+*  int32_t
+*
+*******************************************************************************/
+int32_t roam_score(const roam_candidate_t *candidate, bool need_twt)
+{
+    int32_t score = candidate->rssi_dbm;
+
+    if(need_twt && ((candidate->caps & ROAM_CAP_TWT) != 0u))
+    {
+        score += ROAM_TWT_BONUS_DB;
+    }
+    if((candidate->caps & ROAM_CAP_FT) != 0u)
+    {
+        score += ROAM_FT_BONUS_DB;
+    }
+
+    return score;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_select
+********************************************************************************
+* Summary:
+* This function returns the candidate to roam to: the BSSID other than the
+* current one with the best score, provided it beats the score of the current
+* BSSID by ROAM_DELTA_DB. The current BSSID is scored with the RSSI measured
+* on the link and, when it was scanned too, its capabilities, so that leaving
+* a TWT responder for an AP that is not one takes the bonus on top of the
+* margin.
+*
+* Parameters:
+*  const roam_candidate_t *candidates
+*  uint32_t count
+*  const uint8_t *current_bssid
+*  int32_t current_rssi_dbm
+*  bool need_twt : an iTWT agreement is to be carried over
+*
+* Return:
+*  int : index of the candidate, or -1 to stay
+*
+*******************************************************************************/
+int roam_select(const roam_candidate_t *candidates, uint32_t count, const uint8_t *current_bssid,
+                int32_t current_rssi_dbm, bool need_twt)
+{
+    roam_candidate_t current;
+    int best = -1;
+    int32_t best_score = 0;
+
+    memset(&current, 0, sizeof(current));
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if((current_bssid != NULL) && !memcmp(candidates[i].bssid, current_bssid, sizeof(candidates[i].bssid)))
+        {
+            current = candidates[i];
+        }
+    }
+    current.rssi_dbm = current_rssi_dbm;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        int32_t score;
+
+        if((current_bssid != NULL) && !memcmp(candidates[i].bssid, current_bssid, sizeof(candidates[i].bssid)))
+        {
+            continue;
+        }
+
+        score = roam_score(&candidates[i], need_twt);
+        if((score >= roam_score(&current, need_twt) + ROAM_DELTA_DB) && ((best < 0) || (score > best_score)))
+        {
+            best = (int)i;
+            best_score = score;
+        }
+    }
+
+    return best;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: roam_format_mac
+********************************************************************************
+* Summary:
+* Formats a MAC address; returns 'buffer'.
+*
+*******************************************************************************/
+static char *roam_format_mac(char *buffer, const uint8_t *mac)
+{
+    sprintf(buffer, "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return buffer;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_format_caps
+********************************************************************************
+* Summary:
+* Formats the capability flags as "rkvT" with '-' for the missing ones.
+*
+*******************************************************************************/
+static char *roam_format_caps(char *buffer, uint32_t caps)
+{
+    buffer[0] = (caps & ROAM_CAP_FT)  ? 'r' : '-';
+    buffer[1] = (caps & ROAM_CAP_RRM) ? 'k' : '-';
+    buffer[2] = (caps & ROAM_CAP_BTM) ? 'v' : '-';
+    buffer[3] = (caps & ROAM_CAP_TWT) ? 'T' : '-';
+    buffer[4] = '\0';
+    return buffer;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_event_handler
+********************************************************************************
+* Summary:
+* WHD event handler noting a roam done by the firmware while an agreement is
+* in effect.
+*
+*******************************************************************************/
+static void* roam_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                                const uint8_t *event_data, void *handler_user_data)
+{
+    if((event_header->event_type == WLC_E_ROAM) && (event_header->status == WLC_E_STATUS_SUCCESS) &&
+       twt_session_is_active())
+    {
+        cy_rtos_get_time(&roam_fw_ms);
+        memcpy(roam_fw_bssid, &event_header->addr, sizeof(roam_fw_bssid));
+        roam_fw_pending = true;
+        cy_rtos_set_semaphore(&roam_wake, false);
+    }
+
+    return handler_user_data;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_scan_callback
+********************************************************************************
+* Summary:
+* Collects the BSSIDs of the scanned SSID, keeping the strongest report of
+* each.
+*
+*******************************************************************************/
+static void roam_scan_callback(cy_wcm_scan_result_t *result_ptr, void *user_data, cy_wcm_scan_status_t status)
+{
+    roam_candidate_t *candidate = NULL;
+
+    if(status == CY_WCM_SCAN_COMPLETE)
+    {
+        cy_rtos_set_semaphore(&roam_scan_done, false);
+        return;
+    }
+
+    if(result_ptr == NULL)
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < roam_scan_count; i++)
+    {
+        if(!memcmp(roam_scan_results[i].bssid, result_ptr->BSSID, sizeof(roam_scan_results[i].bssid)))
+        {
+            candidate = &roam_scan_results[i];
+            break;
+        }
+    }
+
+    if(candidate == NULL)
+    {
+        if(roam_scan_count >= ROAM_MAX_CANDIDATES)
+        {
+            return;
+        }
+        candidate = &roam_scan_results[roam_scan_count++];
+        memcpy(candidate->bssid, result_ptr->BSSID, sizeof(candidate->bssid));
+        candidate->rssi_dbm = result_ptr->signal_strength;
+    }
+    else if(result_ptr->signal_strength <= candidate->rssi_dbm)
+    {
+        return;
+    }
+
+    candidate->rssi_dbm = result_ptr->signal_strength;
+    candidate->channel = result_ptr->channel;
+    candidate->band = (uint8_t)result_ptr->band;
+    candidate->caps = roam_parse_ies(result_ptr->ie_ptr, result_ptr->ie_len);
+}
+
+
+/*******************************************************************************
+* Function Name: roam_scan_ssid
+********************************************************************************
+* Summary:
+* This function scans for the BSSIDs of an SSID, with the strongest report
+* of each and the capabilities read from its IEs. Scans are serialized.
+*
+* Parameters:
+*  const uint8_t *ssid          : SSID, NUL-terminated
+*  roam_candidate_t *candidates : receives up to ROAM_MAX_CANDIDATES BSSIDs
+*  uint32_t *count              : receives the number of BSSIDs
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t roam_scan_ssid(const uint8_t *ssid, roam_candidate_t *candidates, uint32_t *count)
+{
+    cy_wcm_scan_filter_t filter;
+    cy_rslt_t result;
+
+    memset(&filter, 0, sizeof(filter));
+    filter.mode = CY_WCM_SCAN_FILTER_TYPE_SSID;
+    strncpy((char *)filter.param.SSID, (const char *)ssid, sizeof(filter.param.SSID) - 1u);
+
+    *count = 0;
+    lock_prof_get(&roam_scan_mutex, CY_RTOS_NEVER_TIMEOUT);
+    roam_scan_count = 0;
+    roam_scans++;
+
+    /* Drop a completion left over from a timed out scan */
+    cy_rtos_get_semaphore(&roam_scan_done, 0, false);
+
+    result = cy_wcm_start_scan(roam_scan_callback, NULL, &filter);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_rtos_get_semaphore(&roam_scan_done, ROAM_SCAN_TIMEOUT_MS, false);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            cy_wcm_stop_scan();
+        }
+        else
+        {
+            memcpy(candidates, roam_scan_results, roam_scan_count * sizeof(roam_candidate_t));
+            *count = roam_scan_count;
+        }
+    }
+
+    lock_prof_set(&roam_scan_mutex);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_to
+********************************************************************************
+* Summary:
+* Joins 'candidate' with the iTWT profile in effect and logs the roam. If
+* the join fails, the network is joined again as after boot.
+*
+*******************************************************************************/
+static cy_rslt_t roam_to(const roam_candidate_t *candidate, int32_t rssi_before_dbm)
+{
+    roam_record_t *record = &roam_history[roam_count % ROAM_HISTORY];
+    twt_session_agreement_t agreement;
+    cy_wcm_associated_ap_info_t ap_info;
+    cy_time_t start;
+    cy_time_t end;
+
+    memset(record, 0, sizeof(*record));
+    twt_session_get(&agreement);
+    record->profile = agreement.active ? agreement.profile : CY_WCM_ITWT_PROFILE_NONE;
+    record->rssi_before_dbm = rssi_before_dbm;
+    memcpy(record->to, candidate->bssid, sizeof(record->to));
+    if(cy_wcm_get_associated_ap_info(&ap_info) == CY_RSLT_SUCCESS)
+    {
+        memcpy(record->from, ap_info.BSSID, sizeof(record->from));
+    }
+
+    cy_rtos_get_time(&start);
+    record->time_ms = start;
+    record->result = ReassociateWifi(candidate->bssid, (cy_wcm_wifi_band_t)candidate->band, record->profile);
+    cy_rtos_get_time(&end);
+    record->roam_ms = (uint32_t)(end - start);
+
+    if(record->result != CY_RSLT_SUCCESS)
+    {
+        ConnectWifi(record->profile);
+    }
+
+    twt_session_get(&agreement);
+    if(agreement.active)
+    {
+        record->twt_gap_ms = (uint32_t)(agreement.established_ms - start);
+    }
+    whd_prof_get_rssi(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &record->rssi_after_dbm);
+
+    roam_count++;
+
+    return record->result;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_restore_twt
+********************************************************************************
+* Summary:
+* Sets up the agreement again after a roam done by the firmware: requests the
+* WI and WD of the old agreement from the BSSID it roamed to, on the
+* association the firmware made, and waits for the Accept.
+*
+*******************************************************************************/
+static void roam_restore_twt(void)
+{
+    roam_record_t *record = &roam_history[roam_count % ROAM_HISTORY];
+    twt_session_agreement_t agreement;
+    whd_twt_setup_params_t twt_params;
+    cy_time_t end;
+
+    memset(record, 0, sizeof(*record));
+    twt_session_get(&agreement);
+    record->time_ms = roam_fw_ms;
+    record->firmware = true;
+    record->profile = agreement.profile;
+    memcpy(record->to, roam_fw_bssid, sizeof(record->to));
+    whd_prof_get_rssi(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &record->rssi_before_dbm);
+
+    memset(&twt_params, 0, sizeof(twt_params));
+    twt_params.negotiation_type = TWT_CTRL_NEGO_TYPE_0;
+    twt_params.setup_command = TWT_SETUP_CMD_SUGGEST_TWT;
+    twt_params.flow_id = agreement.flow_id;
+    twt_params.wake_dur = twt_session_wake_duration_us(&agreement);
+    twt_params.wake_int = twt_session_wake_interval_us(&agreement);
+
+    /* The old agreement is gone with the old AP; the new one is tracked from
+     * its Accept, and the new AP has not answered yet */
+    twt_session_join_start(record->profile);
+    twt_session_reset_support();
+    record->result = whd_prof_twt_setup(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &twt_params);
+    twt_session_join_done(record->result == CY_RSLT_SUCCESS);
+    if(record->result == CY_RSLT_SUCCESS)
+    {
+        uint32_t waited_ms;
+
+        for(waited_ms = 0; (waited_ms < ROAM_TWT_ACCEPT_TIMEOUT_MS) && !twt_session_is_active() &&
+            (twt_session_support() != TWT_SESSION_SUPPORT_REFUSED); waited_ms += ROAM_TWT_ACCEPT_POLL_MS)
+        {
+            cy_rtos_delay_milliseconds(ROAM_TWT_ACCEPT_POLL_MS);
+        }
+    }
+
+    cy_rtos_get_time(&end);
+    twt_session_get(&agreement);
+    record->twt_gap_ms = agreement.active ? (uint32_t)(agreement.established_ms - roam_fw_ms) : (uint32_t)(end - roam_fw_ms);
+    whd_prof_get_rssi(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &record->rssi_after_dbm);
+
+    roam_count++;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_check
+********************************************************************************
+* Summary:
+* Looks for a better BSSID when the RSSI is below the trigger.
+*
+*******************************************************************************/
+static void roam_check(void)
+{
+    cy_wcm_associated_ap_info_t ap_info;
+    int32_t rssi_dbm = 0;
+    int index;
+
+    if((whd_prof_get_rssi(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &rssi_dbm) != WHD_SUCCESS) ||
+       (rssi_dbm >= roam_trigger_dbm) || (cy_wcm_get_associated_ap_info(&ap_info) != CY_RSLT_SUCCESS) ||
+       (roam_scan_ssid(ap_info.SSID, roam_candidates, &roam_candidate_count) != CY_RSLT_SUCCESS))
+    {
+        return;
+    }
+
+    index = roam_select(roam_candidates, roam_candidate_count, ap_info.BSSID, rssi_dbm, twt_session_is_active());
+    if(index >= 0)
+    {
+        roam_to(&roam_candidates[index], rssi_dbm);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: roam_thread_function
+********************************************************************************
+* Summary:
+* Sets the agreement up again after firmware roams and, while roaming is
+* enabled, checks the RSSI every ROAM_CHECK_MS.
+*
+*******************************************************************************/
+static void roam_thread_function(cy_thread_arg_t arg)
+{
+    for(;;)
+    {
+        cy_rslt_t result = cy_rtos_get_semaphore(&roam_wake, roam_enabled ? ROAM_CHECK_MS : CY_RTOS_NEVER_TIMEOUT,
+                                                 false);
+
+        if(roam_fw_pending)
+        {
+            roam_fw_pending = false;
+            roam_restore_twt();
+        }
+        else if((result != CY_RSLT_SUCCESS) && roam_enabled && cy_wcm_is_connected_to_ap())
+        {
+            roam_check();
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: roam_init
+********************************************************************************
+* Summary:
+* This function starts the roam thread and registers the WHD event handler
+* for the roams done by the firmware.
+*
+* Parameters:
+*  whd_interface_t ifp : STA interface
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t roam_init(whd_interface_t ifp)
+{
+    cy_rslt_t result;
+
+    if(((result = cy_rtos_init_semaphore(&roam_wake, 1, 0)) != CY_RSLT_SUCCESS) ||
+       ((result = cy_rtos_init_semaphore(&roam_scan_done, 1, 0)) != CY_RSLT_SUCCESS) ||
+       ((result = cy_rtos_init_mutex(&roam_scan_mutex)) != CY_RSLT_SUCCESS) ||
+       ((result = cy_rtos_thread_create(&roam_thread, roam_thread_function, "Roam", NULL, ROAM_THREAD_STACK,
+                                        CY_RTOS_PRIORITY_LOW, NULL)) != CY_RSLT_SUCCESS))
+    {
+        return result;
+    }
+
+    lock_prof_name(&roam_scan_mutex, "roam_scan");
+    result = whd_wifi_set_event_handler(ifp, roam_events, roam_event_handler, NULL, &roam_event_index);
+
+    return (result == WHD_SUCCESS) ? CY_RSLT_SUCCESS : result;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_enable_firmware_support
+********************************************************************************
+* Summary:
+* Advertises neighbor report (802.11k) and BSS transition (802.11v) support
+* so that the AP can steer the STA. Firmware without them keeps working.
+*
+*******************************************************************************/
+static void roam_enable_firmware_support(void)
+{
+    whd_interface_t ifp = whd_ifs[CY_WCM_INTERFACE_TYPE_STA];
+    uint32_t value = 0;
+
+    if((whd_prof_get_iovar_value(ifp, ROAM_RRM_IOVAR, &value) != WHD_SUCCESS) ||
+       (whd_prof_set_iovar_value(ifp, ROAM_RRM_IOVAR, value | ROAM_RRM_NEIGHBOR_REPORT) != WHD_SUCCESS))
+    {
+        printf("Neighbor reports (802.11k) not supported by the firmware\n");
+    }
+
+    value = 0;
+    if((whd_prof_get_iovar_value(ifp, ROAM_WNM_IOVAR, &value) != WHD_SUCCESS) ||
+       (whd_prof_set_iovar_value(ifp, ROAM_WNM_IOVAR, value | ROAM_WNM_BSS_TRANSITION) != WHD_SUCCESS))
+    {
+        printf("BSS transition (802.11v) not supported by the firmware\n");
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: roam_print_candidates
+********************************************************************************
+* Summary:
+* Prints the scanned candidates with their score; '*' marks the current
+* BSSID and '>' the one that would be selected.
+*
+*******************************************************************************/
+static void roam_print_candidates(const uint8_t *current_bssid, int32_t rssi_dbm, bool need_twt)
+{
+    int selected = roam_select(roam_candidates, roam_candidate_count, current_bssid, rssi_dbm, need_twt);
+    char mac[18];
+    char caps[5];
+
+    printf("  %-17s %5s %4s %4s %5s\n", "bssid", "rssi", "chan", "caps", "score");
+    for(uint32_t i = 0; i < roam_candidate_count; i++)
+    {
+        const roam_candidate_t *candidate = &roam_candidates[i];
+        char mark = !memcmp(candidate->bssid, current_bssid, sizeof(candidate->bssid)) ? '*' :
+                    (((int)i == selected) ? '>' : ' ');
+
+        printf("%c %-17s %5" PRId32 " %4u %4s %5" PRId32 "\n", mark, roam_format_mac(mac, candidate->bssid),
+               candidate->rssi_dbm, candidate->channel, roam_format_caps(caps, candidate->caps),
+               roam_score(candidate, need_twt));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: roam_print_history
+********************************************************************************
+* Summary:
+* Prints the last roams, oldest first.
+*
+*******************************************************************************/
+static void roam_print_history(void)
+{
+    static const char *profiles[] = { "none", "idle", "active" };
+    uint32_t count = (roam_count < ROAM_HISTORY) ? roam_count : ROAM_HISTORY;
+    char from[18];
+    char to[18];
+
+    printf("%10s %-8s %-17s %-17s %5s %5s %-6s %8s %8s %s\n", "time(ms)", "kind", "from", "to", "rssi", "after",
+           "itwt", "roam ms", "gap ms", "result");
+
+    for(uint32_t i = roam_count - count; i < roam_count; i++)
+    {
+        const roam_record_t *record = &roam_history[i % ROAM_HISTORY];
+
+        printf("%10" PRIu32 " %-8s %-17s %-17s %5" PRId32 " %5" PRId32 " %-6s ", (uint32_t)record->time_ms,
+               record->firmware ? "firmware" : "host", record->firmware ? "-" : roam_format_mac(from, record->from),
+               roam_format_mac(to, record->to), record->rssi_before_dbm, record->rssi_after_dbm,
+               profiles[(record->profile <= CY_WCM_ITWT_PROFILE_ACTIVE) ? record->profile : 0]);
+
+        if(record->firmware)
+        {
+            printf("%8s ", "-");
+        }
+        else
+        {
+            printf("%8" PRIu32 " ", record->roam_ms);
+        }
+
+        if(record->profile == CY_WCM_ITWT_PROFILE_NONE)
+        {
+            printf("%8s ", "-");
+        }
+        else
+        {
+            printf("%8" PRIu32 " ", record->twt_gap_ms);
+        }
+
+        printf("%s\n", (record->result == CY_RSLT_SUCCESS) ? "ok" : "failed");
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: roam_command
+********************************************************************************
+* Summary:
+* This function enables or disables roaming, scans and lists the candidates,
+* forces a roam to a BSSID, or shows the roams with their latency and TWT gap.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int roam_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    cy_wcm_associated_ap_info_t ap_info;
+    int32_t rssi_dbm = 0;
+
+    if((argc >= 2) && !strcmp(argv[1], "start"))
+    {
+        roam_trigger_dbm = (argc > 2) ? (int32_t)strtol(argv[2], NULL, 0) : ROAM_TRIGGER_DBM;
+        roam_enable_firmware_support();
+        roam_enabled = true;
+        cy_rtos_set_semaphore(&roam_wake, false);
+        printf("Roaming below %" PRId32 " dBm to a BSSID at least %d dB stronger\n", roam_trigger_dbm, ROAM_DELTA_DB);
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "stop"))
+    {
+        roam_enabled = false;
+        cy_rtos_set_semaphore(&roam_wake, false);
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "clear"))
+    {
+        roam_count = 0;
+        roam_scans = 0;
+        return 0;
+    }
+
+    if((argc >= 2) && (!strcmp(argv[1], "scan") || !strcmp(argv[1], "to")))
+    {
+        if(roam_enabled || !cy_wcm_is_connected_to_ap() || (cy_wcm_get_associated_ap_info(&ap_info) != CY_RSLT_SUCCESS))
+        {
+            printf("Not connected, or roaming is enabled\n");
+            return -1;
+        }
+
+        whd_prof_get_rssi(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], &rssi_dbm);
+        if(roam_scan_ssid(ap_info.SSID, roam_candidates, &roam_candidate_count) != CY_RSLT_SUCCESS)
+        {
+            printf("Scan failed\n");
+            return -1;
+        }
+
+        if(!strcmp(argv[1], "scan"))
+        {
+            roam_print_candidates(ap_info.BSSID, rssi_dbm, twt_session_is_active());
+            return 0;
+        }
+
+        if(argc > 2)
+        {
+            unsigned int mac[6];
+
+            if(sscanf(argv[2], "%x:%x:%x:%x:%x:%x", &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) == 6)
+            {
+                for(uint32_t i = 0; i < roam_candidate_count; i++)
+                {
+                    bool match = true;
+
+                    for(uint32_t j = 0; j < 6u; j++)
+                    {
+                        match = match && (roam_candidates[i].bssid[j] == (uint8_t)mac[j]);
+                    }
+                    if(match)
+                    {
+                        roam_to(&roam_candidates[i], rssi_dbm);
+                        roam_print_history();
+                        return 0;
+                    }
+                }
+            }
+        }
+
+        printf("Usage: roam to <bssid>, with a BSSID listed by roam scan\n");
+        return -1;
+    }
+
+    printf("Roaming : %s, trigger %" PRId32 " dBm, %" PRIu32 " scans, %" PRIu32 " roams\n",
+           roam_enabled ? "enabled" : "disabled", roam_trigger_dbm, roam_scans, roam_count);
+    roam_print_history();
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: roam_add_commands
+********************************************************************************
+* Summary:
+* This function registers the roaming command.
+*
+*******************************************************************************/
+cy_rslt_t roam_add_commands(void)
+{
+    return cy_command_console_add_table(roam_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
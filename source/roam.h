@@ -0,0 +1,110 @@
+/******************************************************************************
+* File Name:   roam.h
+*
+* Description: This file contains the declarations for roaming within the
+*              configured network while keeping the iTWT agreement.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef ROAM_H_
+#define ROAM_H_
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#include "whd_wlioctl.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* RSSI below which candidates are scanned for, and margin by which a candidate
+ * must beat the score of the current BSSID */
+#define ROAM_TRIGGER_DBM                (-75)
+#define ROAM_DELTA_DB                   (8)
+
+/* Score bonus of a TWT responder when an agreement is to be carried over, and
+ * of a candidate supporting fast transition (802.11r) */
+#define ROAM_TWT_BONUS_DB               (6)
+#define ROAM_FT_BONUS_DB                (2)
+
+/* Period of the RSSI check while roaming is enabled */
+#define ROAM_CHECK_MS                   (2000u)
+
+#define ROAM_MAX_CANDIDATES             (8u)
+#define ROAM_HISTORY                    (8u)
+
+/* Capabilities advertised in the beacon/probe response IEs */
+#define ROAM_CAP_FT                     (0x01u)     /* 802.11r: Mobility Domain or FT AKM */
+#define ROAM_CAP_RRM                    (0x02u)     /* 802.11k: neighbor report */
+#define ROAM_CAP_BTM                    (0x04u)     /* 802.11v: BSS transition management */
+#define ROAM_CAP_TWT                    (0x08u)     /* HE TWT responder */
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint8_t  bssid[6];
+    int32_t  rssi_dbm;
+    uint8_t  channel;
+    uint8_t  band;          /* cy_wcm_wifi_band_t */
+    uint32_t caps;          /* ROAM_CAP_* */
+} roam_candidate_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t roam_parse_ies(const uint8_t *ies, uint32_t len);
+int32_t roam_score(const roam_candidate_t *candidate, bool need_twt);
+int roam_select(const roam_candidate_t *candidates, uint32_t count, const uint8_t *current_bssid,
+                int32_t current_rssi_dbm, bool need_twt);
+
+#if !defined(__linux__)
+cy_rslt_t roam_init(whd_interface_t ifp);
+cy_rslt_t roam_scan_ssid(const uint8_t *ssid, roam_candidate_t *candidates, uint32_t *count);
+cy_rslt_t roam_add_commands(void);
+#endif
+
+#endif /* ROAM_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,468 @@
+/******************************************************************************
+* File Name:   sae.c
+*
+* Description: This file configures WPA3-SAE joins and measures them. SAE runs
+*              in the WLAN firmware supplicant; its elliptic-curve work makes
+*              the authentication phase of a join take much longer than with
+*              WPA2-PSK. A join to an AP with a cached PMKSA skips SAE and
+*              authenticates in one round trip.
+*
+*              The authentication phase is timed from the start of the join
+*              to the WLC_E_AUTH event. Whether the firmware used a cached
+*              PMKSA is read from what it reports: the PMKID in the RSN
+*              element of the association request (WLC_E_ASSOC_REQ_IE), the
+*              authentication algorithm (WLC_E_AUTH) and the association
+*              status, which tells when the AP rejected the PMKID.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "sae.h"
+#include "whd_prof.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* RSN element (IEEE 802.11-2020 9.4.2.24) */
+#define SAE_IE_RSN                      (48u)
+#define SAE_RSN_SUITE_LEN               (4u)
+#define SAE_RSN_PMKID_LEN               (16u)
+
+/* AKM suites 00-0F-AC:8 (SAE) and 00-0F-AC:9 (FT over SAE) */
+#define SAE_AKM_SAE                     (8u)
+#define SAE_AKM_FT_SAE                  (9u)
+
+/* Association status code of an AP that has no PMKSA for the PMKID */
+#define SAE_STATUS_INVALID_PMKID        (53u)
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int sae_command(int argc, char* argv[], tlv_buffer_t** data);
+static void* sae_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                               const uint8_t *event_data, void *handler_user_data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const uint32_t sae_events[] = { WLC_E_ASSOC_REQ_IE, WLC_E_AUTH, WLC_E_ASSOC, WLC_E_REASSOC, WLC_E_NONE };
+
+static bool sae_enabled;
+static uint16_t sae_event_index;
+static sae_stats_t sae_stats;
+static volatile bool sae_join_active;
+static volatile bool sae_auth_seen;
+static volatile bool sae_auth_started;
+static volatile bool sae_pmkid_sent;        /* The last association request offered a PMKSA */
+static volatile bool sae_pmkid_offered;     /* Any association request of the join did */
+static volatile bool sae_pmkid_rejected;
+static cy_time_t sae_join_start_ms;
+static cy_time_t sae_auth_start_ms;
+static cy_time_t sae_auth_ms;
+static uint32_t sae_auth_type;
+static uint32_t sae_last_auth_ms;
+static bool sae_last_hit;
+
+#define SAE_COMMANDS \
+    { (char *) "sae", sae_command, 0, NULL, NULL, (char *) "[reset]", (char *) "Show SAE authentication time and PMKSA cache hit rate" }, \
+
+const cy_command_console_cmd_t sae_commands_table[] =
+{
+    SAE_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: sae_init
+********************************************************************************
+* Summary:
+* This function selects the SAE password element derivation and starts
+* listening for authentication events. Must be called after WCM is
+* initialized and before the first join. Nothing is done unless 'security'
+* uses SAE.
+*
+* With H2E, the password element is derived from the password and SSID only,
+* once, instead of being hunted for with the MAC addresses of both peers on
+* every join.
+*
+* Parameters:
+*  whd_interface_t ifp          : STA interface
+*  cy_wcm_security_t security   : security of the configured network
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t sae_init(whd_interface_t ifp, cy_wcm_security_t security)
+{
+    whd_result_t result;
+
+    if((security != CY_WCM_SECURITY_WPA3_SAE) && (security != CY_WCM_SECURITY_WPA3_WPA2_PSK))
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = whd_prof_set_iovar_value(ifp, SAE_PWE_IOVAR, SAE_PWE_MODE);
+    if(result != WHD_SUCCESS)
+    {
+        /* Older firmware only does hunting-and-pecking; SAE still works */
+        printf("SAE: setting %s to %u failed: 0x%08" PRIx32 "\n", SAE_PWE_IOVAR, (unsigned)SAE_PWE_MODE, (uint32_t)result);
+    }
+
+    result = whd_wifi_set_event_handler(ifp, sae_events, sae_event_handler, NULL, &sae_event_index);
+    if(result != WHD_SUCCESS)
+    {
+        return (cy_rslt_t)result;
+    }
+
+    sae_enabled = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_rsn_pmksa
+********************************************************************************
+* Summary:
+* This function tells whether the IEs of an association request offer a
+* PMKSA of an SAE AKM, i.e. their RSN element lists an SAE AKM suite and at
+* least one PMKID.
+*
+*******************************************************************************/
+static bool sae_rsn_pmksa(const uint8_t *ies, uint32_t length)
+{
+    uint32_t offset = 0;
+
+    while((ies != NULL) && (offset + 2u <= length) && (offset + 2u + ies[offset + 1u] <= length))
+    {
+        const uint8_t *rsn = &ies[offset + 2u];
+        uint32_t rsn_len = ies[offset + 1u];
+        uint32_t pos = 2u + SAE_RSN_SUITE_LEN;     /* Version, group cipher */
+        uint32_t count;
+        bool sae_akm = false;
+
+        if(ies[offset] != SAE_IE_RSN)
+        {
+            offset += 2u + rsn_len;
+            continue;
+        }
+
+        /* Pairwise cipher suites */
+        if(pos + 2u > rsn_len)
+        {
+            return false;
+        }
+        count = (uint32_t)rsn[pos] | ((uint32_t)rsn[pos + 1u] << 8);
+        pos += 2u + (count * SAE_RSN_SUITE_LEN);
+
+        /* AKM suites */
+        if(pos + 2u > rsn_len)
+        {
+            return false;
+        }
+        count = (uint32_t)rsn[pos] | ((uint32_t)rsn[pos + 1u] << 8);
+        pos += 2u;
+        for(uint32_t i = 0; (i < count) && (pos + SAE_RSN_SUITE_LEN <= rsn_len); i++)
+        {
+            if((rsn[pos] == 0x00u) && (rsn[pos + 1u] == 0x0Fu) && (rsn[pos + 2u] == 0xACu) &&
+               ((rsn[pos + 3u] == SAE_AKM_SAE) || (rsn[pos + 3u] == SAE_AKM_FT_SAE)))
+            {
+                sae_akm = true;
+            }
+            pos += SAE_RSN_SUITE_LEN;
+        }
+
+        /* RSN capabilities, then the PMKID count */
+        pos += 2u;
+        if(pos + 2u > rsn_len)
+        {
+            return false;
+        }
+        count = (uint32_t)rsn[pos] | ((uint32_t)rsn[pos + 1u] << 8);
+
+        return sae_akm && (count != 0u) && (pos + 2u + SAE_RSN_PMKID_LEN <= rsn_len);
+    }
+
+    return false;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_event_handler
+********************************************************************************
+* Summary:
+* WHD event handler recording the authentication phase of a join. The
+* firmware reports WLC_E_ASSOC_REQ_IE with the IEs of its association
+* request when it starts to join a BSS, after the scan, and WLC_E_AUTH with
+* the algorithm used once authenticated. An AP without a PMKSA for the
+* offered PMKID fails the association with status 53, and the firmware
+* authenticates again with SAE; the last authentication counts.
+*
+*******************************************************************************/
+static void* sae_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                               const uint8_t *event_data, void *handler_user_data)
+{
+    if(!sae_join_active)
+    {
+        return handler_user_data;
+    }
+
+    if(event_header->event_type == WLC_E_ASSOC_REQ_IE)
+    {
+        cy_rtos_get_time(&sae_auth_start_ms);
+        sae_auth_started = true;
+        sae_pmkid_sent = sae_rsn_pmksa(event_data, event_header->datalen);
+        sae_pmkid_offered = sae_pmkid_offered || sae_pmkid_sent;
+    }
+    else if(((event_header->event_type == WLC_E_ASSOC) || (event_header->event_type == WLC_E_REASSOC)) &&
+            (event_header->status != WLC_E_STATUS_SUCCESS) && (event_header->reason == SAE_STATUS_INVALID_PMKID))
+    {
+        sae_pmkid_rejected = true;
+        sae_pmkid_sent = false;
+    }
+    else if((event_header->event_type == WLC_E_AUTH) && (event_header->status == WLC_E_STATUS_SUCCESS))
+    {
+        cy_rtos_get_time(&sae_auth_ms);
+        sae_auth_type = event_header->auth_type;
+        sae_auth_seen = true;
+    }
+
+    return handler_user_data;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_join_start
+********************************************************************************
+* Summary:
+* This function is called right before cy_wcm_connect_ap().
+*
+*******************************************************************************/
+void sae_join_start(void)
+{
+    if(!sae_enabled)
+    {
+        return;
+    }
+
+    sae_auth_seen = false;
+    sae_auth_started = false;
+    sae_pmkid_sent = false;
+    sae_pmkid_offered = false;
+    sae_pmkid_rejected = false;
+    cy_rtos_get_time(&sae_join_start_ms);
+    sae_join_active = true;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_join_done
+********************************************************************************
+* Summary:
+* This function is called with the result of cy_wcm_connect_ap() and
+* classifies the authentication as a full SAE exchange, or as a PMKSA cache
+* hit when the firmware authenticated with Open System and offered a PMKID
+* of an SAE AKM in the association request. The authentication time runs from the start of the
+* join to the BSS, so that the scan is not included; it is not recorded if
+* the start was not reported.
+*
+*******************************************************************************/
+void sae_join_done(cy_rslt_t result)
+{
+    cy_time_t now;
+    uint32_t auth_ms;
+    bool timed;
+    bool hit;
+
+    if(!sae_enabled || !sae_join_active)
+    {
+        return;
+    }
+
+    sae_join_active = false;
+    cy_rtos_get_time(&now);
+    sae_stats.joins++;
+
+    if((result != CY_RSLT_SUCCESS) || !sae_auth_seen)
+    {
+        sae_stats.failed_joins++;
+        return;
+    }
+
+    sae_stats.join_ms_total += (uint32_t)(now - sae_join_start_ms);
+
+    sae_stats.pmksa_offered += sae_pmkid_offered ? 1u : 0u;
+    sae_stats.pmksa_rejected += sae_pmkid_rejected ? 1u : 0u;
+
+    /* Open System without an SAE PMKID is a WPA2-PSK join (transition mode),
+     * which is neither */
+    hit = sae_pmkid_sent && (sae_auth_type == SAE_AUTH_ALG_OPEN);
+    if(!hit && (sae_auth_type != SAE_AUTH_ALG_SAE))
+    {
+        return;
+    }
+
+    /* A start reported after the authentication belongs to a later attempt */
+    timed = sae_auth_started && ((int32_t)(sae_auth_ms - sae_auth_start_ms) >= 0);
+    auth_ms = timed ? (uint32_t)(sae_auth_ms - sae_auth_start_ms) : 0u;
+
+    if(hit)
+    {
+        sae_stats.pmksa_hits++;
+        if(timed)
+        {
+            sae_stats.cached_timed++;
+            sae_stats.cached_ms_total += auth_ms;
+        }
+    }
+    else
+    {
+        sae_stats.sae_auths++;
+        if(timed)
+        {
+            sae_stats.sae_timed++;
+            sae_stats.sae_ms_total += auth_ms;
+            if(auth_ms > sae_stats.sae_ms_max)
+            {
+                sae_stats.sae_ms_max = auth_ms;
+            }
+        }
+    }
+
+    sae_last_auth_ms = auth_ms;
+    sae_last_hit = hit;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_get_stats
+********************************************************************************
+* Summary:
+* This function returns a copy of the SAE statistics.
+*
+*******************************************************************************/
+void sae_get_stats(sae_stats_t *stats)
+{
+    *stats = sae_stats;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_command
+********************************************************************************
+* Summary:
+* This function prints the SAE statistics, or resets them with "reset".
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int sae_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    sae_stats_t stats;
+
+    if(!sae_enabled)
+    {
+        printf("The configured network does not use WPA3-SAE\n");
+        return 0;
+    }
+
+    if((argc > 1) && !strcmp(argv[1], "reset"))
+    {
+        memset(&sae_stats, 0, sizeof(sae_stats));
+        return 0;
+    }
+
+    sae_get_stats(&stats);
+
+    printf("PWE derivation     : %s\n", (SAE_PWE_MODE == 0u) ? "hunting-and-pecking" :
+                                        (SAE_PWE_MODE == 1u) ? "H2E" : "H2E or hunting-and-pecking");
+    printf("Joins              : %" PRIu32 " (%" PRIu32 " failed), avg %" PRIu32 " ms\n",
+           stats.joins, stats.failed_joins,
+           (stats.joins > stats.failed_joins) ? (stats.join_ms_total / (stats.joins - stats.failed_joins)) : 0u);
+    printf("SAE authentications: %" PRIu32 ", avg %" PRIu32 " ms, max %" PRIu32 " ms\n",
+           stats.sae_auths, (stats.sae_timed != 0u) ? (stats.sae_ms_total / stats.sae_timed) : 0u,
+           stats.sae_ms_max);
+    printf("PMKSA cache hits   : %" PRIu32 " of %" PRIu32 " offered (%" PRIu32 " rejected by the AP), avg %" PRIu32 " ms\n",
+           stats.pmksa_hits, stats.pmksa_offered, stats.pmksa_rejected,
+           (stats.cached_timed != 0u) ? (stats.cached_ms_total / stats.cached_timed) : 0u);
+    if((stats.sae_auths + stats.pmksa_hits) != (stats.sae_timed + stats.cached_timed))
+    {
+        printf("Not timed          : %" PRIu32 " (no join start reported)\n",
+               (stats.sae_auths + stats.pmksa_hits) - (stats.sae_timed + stats.cached_timed));
+    }
+    if((stats.sae_auths + stats.pmksa_hits) != 0u)
+    {
+        printf("Last authentication: %" PRIu32 " ms (%s)\n", sae_last_auth_ms, sae_last_hit ? "PMKSA" : "SAE");
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: sae_add_commands
+********************************************************************************
+* Summary:
+* This function registers the SAE commands table.
+*
+*******************************************************************************/
+cy_rslt_t sae_add_commands(void)
+{
+    return cy_command_console_add_table(sae_commands_table);
+}
+
+
+/* [] END OF FILE */
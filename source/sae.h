@@ -0,0 +1,106 @@
+/******************************************************************************
+* File Name:   sae.h
+*
+* Description: This file contains the declarations for the WPA3-SAE join
+*              configuration and the SAE and PMKSA caching statistics.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SAE_H_
+#define SAE_H_
+
+#include "cy_result.h"
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* SAE password element derivation: 0 = hunting-and-pecking only,
+ * 1 = hash-to-element (H2E) only, 2 = both */
+#ifndef SAE_PWE_MODE
+#define SAE_PWE_MODE                    (2u)
+#endif
+
+/* Firmware iovar selecting the SAE password element derivation */
+#ifndef SAE_PWE_IOVAR
+#define SAE_PWE_IOVAR                   "sae_pwe"
+#endif
+
+/* Authentication algorithm numbers of the WLC_E_AUTH event (IEEE 802.11
+ * Authentication Algorithm Number field). With a cached PMKSA the STA
+ * authenticates with Open System and sends the PMKID in the association. */
+#define SAE_AUTH_ALG_OPEN               (0u)
+#define SAE_AUTH_ALG_SAE                (3u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t joins;
+    uint32_t failed_joins;
+    uint32_t sae_auths;             /* Authentications with the full SAE exchange */
+    uint32_t pmksa_offered;         /* Joins whose association request carried an SAE PMKID */
+    uint32_t pmksa_rejected;        /* Of these, joins where the AP rejected it (status 53) */
+    uint32_t pmksa_hits;
+    uint32_t sae_timed;             /* Authentications whose start was reported */
+    uint32_t sae_ms_total;
+    uint32_t sae_ms_max;
+    uint32_t cached_timed;
+    uint32_t cached_ms_total;
+    uint32_t join_ms_total;
+} sae_stats_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t sae_init(whd_interface_t ifp, cy_wcm_security_t security);
+void sae_join_start(void);
+void sae_join_done(cy_rslt_t result);
+void sae_get_stats(sae_stats_t *stats);
+cy_rslt_t sae_add_commands(void);
+
+#endif /* SAE_H_ */
+
+/* [] END OF FILE */
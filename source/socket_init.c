@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   socket_init.c
+*
+* Description: This file implements the one-time initialization of the
+*              secure sockets library. The modules that open sockets are
+*              started from different threads (console commands, the
+*              metrics and remote console servers, the capture), so the
+*              first of them initializes the library while the others wait.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "cy_secure_sockets.h"
+#include "socket_init.h"
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Poll period of a thread waiting for another one to initialize the library */
+#define SOCKET_INIT_POLL_MS             (5u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    SOCKET_INIT_NONE,
+    SOCKET_INIT_RUNNING,
+    SOCKET_INIT_DONE
+} socket_init_state_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static volatile socket_init_state_t socket_init_state = SOCKET_INIT_NONE;
+
+
+/*******************************************************************************
+* Function Name: socket_init
+********************************************************************************
+* Summary:
+* This function initializes the secure sockets library once. The state is
+* checked and claimed in a critical section; cy_socket_init() creates RTOS
+* objects, so it runs outside of it and the threads calling meanwhile wait
+* for its result. After a failure, the next call tries again.
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t socket_init(void)
+{
+    socket_init_state_t state;
+    uint32_t critical;
+    cy_rslt_t result;
+
+    for(;;)
+    {
+        critical = cyhal_system_critical_section_enter();
+        state = socket_init_state;
+        if(state == SOCKET_INIT_NONE)
+        {
+            socket_init_state = SOCKET_INIT_RUNNING;
+        }
+        cyhal_system_critical_section_exit(critical);
+
+        if(state == SOCKET_INIT_DONE)
+        {
+            return CY_RSLT_SUCCESS;
+        }
+        if(state == SOCKET_INIT_NONE)
+        {
+            break;
+        }
+        cy_rtos_delay_milliseconds(SOCKET_INIT_POLL_MS);
+    }
+
+    result = cy_socket_init();
+    socket_init_state = (result == CY_RSLT_SUCCESS) ? SOCKET_INIT_DONE : SOCKET_INIT_NONE;
+
+    return result;
+}
+
+
+/* [] END OF FILE */
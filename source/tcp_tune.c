@@ -0,0 +1,688 @@
+/******************************************************************************
+* File Name:   tcp_tune.c
+*
+* Description: This file adjusts the NetX Duo TCP timers to the iTWT agreement
+*              in effect. With the idle profile, a segment and its ACK can
+*              each wait up to a wake interval for an SP, so the default
+*              1-s retransmission timeout expires while the ACK is still
+*              buffered at the AP, and the retransmission collapses the
+*              congestion window. While an agreement is active, the
+*              retransmission timeout is raised above two wake intervals plus
+*              the wake duration, and the delayed ACK timer is shortened so
+*              that ACKs leave within the current SP.
+*
+*              Retransmissions are counted from the frames passed to WHD. A
+*              retransmission is counted as spurious when the ACK covering it
+*              arrives in less than half the smallest RTT measured on the
+*              connection, i.e. the ACK was sent for the original segment.
+*              Frames are not inspected while the tuning is off.
+*
+*              The accounting also builds on Linux, where
+*              tools/tcp_tune_host.c runs it on a simulated iTWT link.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cycle_counter.h"
+#include "tcp_tune.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#else
+#include "cyabs_rtos.h"
+#include "cyhal.h"
+#include "command_console.h"
+#include "lock_prof.h"
+#include "twt_session.h"
+
+/* NetX Duo header files. */
+#include "nx_api.h"
+#include "cy_network_mw_core.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TCP_TUNE_ETH_HEADER_LEN         (14u)
+#define TCP_TUNE_ETHERTYPE_IPV4         (0x0800u)
+#define TCP_TUNE_IP_PROTO_TCP           (6u)
+#define TCP_TUNE_TCP_HEADER_LEN         (20u)
+
+#define TCP_TUNE_FLAG_FIN               (0x01u)
+#define TCP_TUNE_FLAG_SYN               (0x02u)
+#define TCP_TUNE_FLAG_ACK               (0x10u)
+
+#define TCP_TUNE_SEQ_GEQ(a, b)          ((int32_t)((a) - (b)) >= 0)
+
+/* Counter sets */
+#define TCP_TUNE_SET_DEFAULT            (0u)
+#define TCP_TUNE_SET_TWT                (1u)
+
+#define TCP_TUNE_GET_BE16(p)            ((uint16_t)(((uint16_t)(p)[0] << 8) | (p)[1]))
+#define TCP_TUNE_GET_BE32(p)            (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                                         ((uint32_t)(p)[2] << 8) | (p)[3])
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    bool     used;
+    uint32_t remote_ip;
+    uint16_t local_port;
+    uint16_t remote_port;
+    uint32_t last_seen;
+    uint32_t snd_max;           /* Highest sequence number sent + 1 */
+    bool     sample_pending;    /* RTT sample on new data (Karn's algorithm) */
+    uint32_t sample_end;
+    uint32_t sample_time;
+    uint32_t min_rtt;           /* Cycles, 0 until measured */
+    bool     rtx_pending;
+    uint32_t rtx_end;
+    uint32_t rtx_time;
+} tcp_tune_flow_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int tcp_tune_command(int argc, char* argv[], tlv_buffer_t** data);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static tcp_tune_flow_t tcp_tune_flows[TCP_TUNE_MAX_FLOWS];
+static tcp_tune_counters_t tcp_tune_counters[2];
+static volatile uint32_t tcp_tune_set;
+static volatile bool tcp_tune_enabled = true;
+
+#if defined(__linux__)
+static pthread_mutex_t tcp_tune_frame_mutex = PTHREAD_MUTEX_INITIALIZER;
+#else
+/* Serializes tcp_tune_update(), called from the console task and from the
+ * command */
+static cy_mutex_t tcp_tune_mutex;
+static bool tcp_tune_initialized;
+static bool tcp_tune_applied;
+static bool tcp_tune_defaults_saved;
+static ULONG tcp_tune_default_transmit_rate;
+static ULONG tcp_tune_default_ack_rate;
+static uint32_t tcp_tune_rto_ms;
+
+#define TCP_TUNE_COMMANDS \
+    { (char *) "tcp_tune", tcp_tune_command, 0, NULL, NULL, (char *) "[auto|off|reset]", (char *) "Show TCP timers and retransmission counters with and without iTWT tuning" }, \
+
+const cy_command_console_cmd_t tcp_tune_commands_table[] =
+{
+    TCP_TUNE_COMMANDS
+    CMD_TABLE_END
+};
+#endif /* defined(__linux__) */
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_lock / tcp_tune_unlock
+********************************************************************************
+* Summary:
+* Serialize the updates of the flows and counters: a critical section on the
+* kit, as frames are seen from the network stack and WHD threads, a mutex in
+* the host build.
+*
+*******************************************************************************/
+static inline uint32_t tcp_tune_lock(void)
+{
+#if defined(__linux__)
+    pthread_mutex_lock(&tcp_tune_frame_mutex);
+    return 0;
+#else
+    return cyhal_system_critical_section_enter();
+#endif
+}
+
+static inline void tcp_tune_unlock(uint32_t state)
+{
+#if defined(__linux__)
+    (void)state;
+    pthread_mutex_unlock(&tcp_tune_frame_mutex);
+#else
+    cyhal_system_critical_section_exit(state);
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_min_rto_ms
+********************************************************************************
+* Summary:
+* This function returns the minimum retransmission timeout for an agreement:
+* the default, or two wake intervals plus the wake duration and a margin if
+* that is longer.
+*
+* Parameters:
+*  uint32_t wake_interval_us : wake interval, 0 without iTWT
+*  uint32_t wake_duration_us : wake duration
+*  uint32_t default_ms       : retransmission timeout of the stack
+*
+* Return:
+*  uint32_t : timeout in milliseconds
+*
+*******************************************************************************/
+uint32_t tcp_tune_min_rto_ms(uint32_t wake_interval_us, uint32_t wake_duration_us, uint32_t default_ms)
+{
+    uint32_t twt_ms;
+
+    if(wake_interval_us == 0u)
+    {
+        return default_ms;
+    }
+
+    twt_ms = (((2u * wake_interval_us) + wake_duration_us) / 1000u) + TCP_TUNE_RTO_MARGIN_MS;
+
+    return (twt_ms > default_ms) ? twt_ms : default_ms;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: tcp_tune_apply
+********************************************************************************
+* Summary:
+* This function sets the retransmission timeout of new sockets and of the
+* sockets already created, and the delayed ACK timeout.
+*
+*******************************************************************************/
+static void tcp_tune_apply(ULONG transmit_rate, ULONG ack_rate)
+{
+    NX_IP *ip_ptr = (NX_IP *)cy_network_get_nw_interface(CY_NETWORK_WIFI_STA_INTERFACE, 0);
+    NX_TCP_SOCKET *socket_ptr;
+
+    _nx_tcp_transmit_timer_rate = transmit_rate;
+    _nx_tcp_ack_timer_rate = ack_rate;
+
+    if(ip_ptr == NULL)
+    {
+        return;
+    }
+
+    tx_mutex_get(&ip_ptr->nx_ip_protection, TX_WAIT_FOREVER);
+    socket_ptr = ip_ptr->nx_ip_tcp_created_sockets_ptr;
+    for(ULONG i = 0; (socket_ptr != NULL) && (i < ip_ptr->nx_ip_tcp_created_sockets_count); i++)
+    {
+        socket_ptr->nx_tcp_socket_timeout_rate = transmit_rate;
+        socket_ptr = socket_ptr->nx_tcp_socket_created_next;
+    }
+    tx_mutex_put(&ip_ptr->nx_ip_protection);
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_update
+********************************************************************************
+* Summary:
+* This function applies or reverts the TCP timer tuning when the iTWT
+* agreement changes. Called periodically from the console task, and by the
+* command.
+*
+*******************************************************************************/
+void tcp_tune_update(void)
+{
+    twt_session_agreement_t agreement;
+    bool twt;
+    uint32_t rto_ms;
+
+    if(!tcp_tune_initialized)
+    {
+        return;
+    }
+
+    lock_prof_get(&tcp_tune_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    if(!tcp_tune_defaults_saved)
+    {
+        tcp_tune_default_transmit_rate = _nx_tcp_transmit_timer_rate;
+        tcp_tune_default_ack_rate = _nx_tcp_ack_timer_rate;
+        tcp_tune_defaults_saved = true;
+        cycle_counter_init();
+    }
+
+    twt_session_get(&agreement);
+    twt = tcp_tune_enabled && agreement.active;
+
+    if(!twt)
+    {
+        if(tcp_tune_applied)
+        {
+            tcp_tune_apply(tcp_tune_default_transmit_rate, tcp_tune_default_ack_rate);
+            tcp_tune_applied = false;
+            tcp_tune_rto_ms = 0;
+        }
+        tcp_tune_set = TCP_TUNE_SET_DEFAULT;
+        lock_prof_set(&tcp_tune_mutex);
+        return;
+    }
+
+    rto_ms = tcp_tune_min_rto_ms(twt_session_wake_interval_us(&agreement), twt_session_wake_duration_us(&agreement),
+                                 (uint32_t)((tcp_tune_default_transmit_rate * 1000u) / NX_IP_PERIODIC_RATE));
+    if(!tcp_tune_applied || (rto_ms != tcp_tune_rto_ms))
+    {
+        /* The delayed ACK timer runs on the fast TCP timer; one period is the
+         * shortest delay */
+        tcp_tune_apply((ULONG)((rto_ms * NX_IP_PERIODIC_RATE + 999u) / 1000u),
+                       (_nx_tcp_fast_timer_rate < tcp_tune_default_ack_rate) ? _nx_tcp_fast_timer_rate : tcp_tune_default_ack_rate);
+        tcp_tune_applied = true;
+        tcp_tune_rto_ms = rto_ms;
+    }
+    tcp_tune_set = TCP_TUNE_SET_TWT;
+
+    lock_prof_set(&tcp_tune_mutex);
+}
+#endif /* !defined(__linux__) */
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_flow
+********************************************************************************
+* Summary:
+* This function returns the tracking entry of a connection, taking over the
+* least recently seen one for a new connection. Must be called with interrupts
+* disabled.
+*
+*******************************************************************************/
+static tcp_tune_flow_t* tcp_tune_flow(uint32_t remote_ip, uint16_t local_port, uint16_t remote_port, uint32_t now)
+{
+    tcp_tune_flow_t *oldest = &tcp_tune_flows[0];
+
+    for(uint32_t i = 0; i < TCP_TUNE_MAX_FLOWS; i++)
+    {
+        tcp_tune_flow_t *flow = &tcp_tune_flows[i];
+
+        if(flow->used && (flow->remote_ip == remote_ip) && (flow->local_port == local_port) &&
+           (flow->remote_port == remote_port))
+        {
+            flow->last_seen = now;
+            return flow;
+        }
+        if(!flow->used || (oldest->used && ((now - flow->last_seen) > (now - oldest->last_seen))))
+        {
+            oldest = flow;
+        }
+    }
+
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->used = true;
+    oldest->remote_ip = remote_ip;
+    oldest->local_port = local_port;
+    oldest->remote_port = remote_port;
+    oldest->last_seen = now;
+
+    return oldest;
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_frame
+********************************************************************************
+* Summary:
+* This function inspects an Ethernet frame passed between the network stack
+* and WHD and updates the retransmission counters.
+*
+* Parameters:
+*  bool tx              : true for frames sent, false for frames received
+*  const uint8_t *frame : Ethernet frame
+*  uint32_t length      : frame length
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void tcp_tune_frame(bool tx, const uint8_t *frame, uint32_t length)
+{
+    if(tcp_tune_enabled)
+    {
+        tcp_tune_frame_at(tx, frame, length, cycle_counter_get());
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_frame_at
+********************************************************************************
+* Summary:
+* This function does the work of tcp_tune_frame() for a frame seen at a given
+* time, so that a simulation can replay frames at simulated times.
+*
+* Parameters:
+*  bool tx              : true for frames sent, false for frames received
+*  const uint8_t *frame : Ethernet frame
+*  uint32_t length      : frame length
+*  uint32_t now         : cycle counter when the frame was seen
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void tcp_tune_frame_at(bool tx, const uint8_t *frame, uint32_t length, uint32_t now)
+{
+    const uint8_t *ip;
+    const uint8_t *tcp;
+    uint32_t ip_header_len;
+    uint32_t ip_total_len;
+    uint32_t tcp_header_len;
+    uint32_t payload;
+    uint32_t seq;
+    uint32_t ack;
+    uint8_t flags;
+    uint32_t state;
+    tcp_tune_flow_t *flow;
+    tcp_tune_counters_t *counters;
+
+    if(!tcp_tune_enabled || (frame == NULL) || (length < TCP_TUNE_ETH_HEADER_LEN + 20u + TCP_TUNE_TCP_HEADER_LEN) ||
+       (TCP_TUNE_GET_BE16(&frame[12]) != TCP_TUNE_ETHERTYPE_IPV4))
+    {
+        return;
+    }
+
+    ip = &frame[TCP_TUNE_ETH_HEADER_LEN];
+    ip_header_len = (uint32_t)(ip[0] & 0x0Fu) * 4u;
+    ip_total_len = TCP_TUNE_GET_BE16(&ip[2]);
+    if((ip[9] != TCP_TUNE_IP_PROTO_TCP) || (ip_header_len < 20u) ||
+       (TCP_TUNE_ETH_HEADER_LEN + ip_header_len + TCP_TUNE_TCP_HEADER_LEN > length) ||
+       (ip_total_len < ip_header_len + TCP_TUNE_TCP_HEADER_LEN))
+    {
+        return;
+    }
+
+    tcp = &ip[ip_header_len];
+    tcp_header_len = (uint32_t)(tcp[12] >> 4) * 4u;
+    if(ip_total_len < ip_header_len + tcp_header_len)
+    {
+        return;
+    }
+    payload = ip_total_len - ip_header_len - tcp_header_len;
+    seq = TCP_TUNE_GET_BE32(&tcp[4]);
+    ack = TCP_TUNE_GET_BE32(&tcp[8]);
+    flags = tcp[13];
+
+    state = tcp_tune_lock();
+
+    counters = &tcp_tune_counters[tcp_tune_set];
+
+    if(tx)
+    {
+        uint32_t seq_end = seq + payload + (((flags & (TCP_TUNE_FLAG_SYN | TCP_TUNE_FLAG_FIN)) != 0u) ? 1u : 0u);
+
+        if(seq_end != seq)
+        {
+            flow = tcp_tune_flow(TCP_TUNE_GET_BE32(&ip[16]), TCP_TUNE_GET_BE16(&tcp[0]), TCP_TUNE_GET_BE16(&tcp[2]), now);
+            counters->segments++;
+
+            if(((flags & TCP_TUNE_FLAG_SYN) != 0u) || TCP_TUNE_SEQ_GEQ(seq, flow->snd_max) || (flow->snd_max == 0u))
+            {
+                if(!flow->sample_pending)
+                {
+                    flow->sample_pending = true;
+                    flow->sample_end = seq_end;
+                    flow->sample_time = now;
+                }
+                flow->snd_max = seq_end;
+            }
+            else
+            {
+                counters->retransmits++;
+                flow->sample_pending = false;
+                flow->rtx_pending = true;
+                flow->rtx_end = seq_end;
+                flow->rtx_time = now;
+            }
+        }
+    }
+    else if((flags & TCP_TUNE_FLAG_ACK) != 0u)
+    {
+        flow = NULL;
+        for(uint32_t i = 0; i < TCP_TUNE_MAX_FLOWS; i++)
+        {
+            if(tcp_tune_flows[i].used && (tcp_tune_flows[i].remote_ip == TCP_TUNE_GET_BE32(&ip[12])) &&
+               (tcp_tune_flows[i].local_port == TCP_TUNE_GET_BE16(&tcp[2])) &&
+               (tcp_tune_flows[i].remote_port == TCP_TUNE_GET_BE16(&tcp[0])))
+            {
+                flow = &tcp_tune_flows[i];
+            }
+        }
+
+        if(flow != NULL)
+        {
+            if(flow->sample_pending && TCP_TUNE_SEQ_GEQ(ack, flow->sample_end))
+            {
+                uint32_t rtt = now - flow->sample_time;
+
+                if((flow->min_rtt == 0u) || (rtt < flow->min_rtt))
+                {
+                    flow->min_rtt = rtt;
+                }
+                flow->sample_pending = false;
+            }
+
+            if(flow->rtx_pending && TCP_TUNE_SEQ_GEQ(ack, flow->rtx_end))
+            {
+                if((flow->min_rtt != 0u) && ((now - flow->rtx_time) < (flow->min_rtt / 2u)))
+                {
+                    counters->spurious++;
+                }
+                flow->rtx_pending = false;
+            }
+        }
+    }
+
+    tcp_tune_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_get_counters
+********************************************************************************
+* Summary:
+* This function returns a copy of the counters of the frames seen with the
+* default timers and with the iTWT timers.
+*
+*******************************************************************************/
+void tcp_tune_get_counters(tcp_tune_counters_t *default_timers, tcp_tune_counters_t *twt_timers)
+{
+    uint32_t state = tcp_tune_lock();
+
+    *default_timers = tcp_tune_counters[TCP_TUNE_SET_DEFAULT];
+    *twt_timers = tcp_tune_counters[TCP_TUNE_SET_TWT];
+
+    tcp_tune_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_reset_counters
+********************************************************************************
+* Summary:
+* This function clears both sets of counters.
+*
+*******************************************************************************/
+void tcp_tune_reset_counters(void)
+{
+    uint32_t state = tcp_tune_lock();
+
+    memset(tcp_tune_counters, 0, sizeof(tcp_tune_counters));
+
+    tcp_tune_unlock(state);
+}
+
+
+#if defined(__linux__)
+/*******************************************************************************
+* Function Name: tcp_tune_select
+********************************************************************************
+* Summary:
+* Host build: what tcp_tune_update() decides on the kit, i.e. whether frames
+* are inspected and which set of counters they go to.
+*
+* Parameters:
+*  bool enabled : false for "tcp_tune off"
+*  bool twt     : true to count in the iTWT timers set
+*
+*******************************************************************************/
+void tcp_tune_select(bool enabled, bool twt)
+{
+    uint32_t state = tcp_tune_lock();
+
+    tcp_tune_enabled = enabled;
+    tcp_tune_set = (enabled && twt) ? TCP_TUNE_SET_TWT : TCP_TUNE_SET_DEFAULT;
+
+    tcp_tune_unlock(state);
+}
+#else
+/*******************************************************************************
+* Function Name: tcp_tune_print_counters
+********************************************************************************
+* Summary:
+* This function prints one set of counters.
+*
+*******************************************************************************/
+static void tcp_tune_print_counters(const char *name, const tcp_tune_counters_t *counters)
+{
+    uint32_t permille = (counters->segments != 0u) ? (uint32_t)(((uint64_t)counters->retransmits * 1000u) / counters->segments) : 0u;
+
+    printf("%-16s %10" PRIu32 " %12" PRIu32 " %5" PRIu32 ".%" PRIu32 "%% %9" PRIu32 "\n", name,
+           counters->segments, counters->retransmits, permille / 10u, permille % 10u, counters->spurious);
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_command
+********************************************************************************
+* Summary:
+* This function prints the TCP timers and the retransmission counters, and
+* enables ("auto") or disables ("off") the tuning.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int tcp_tune_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    tcp_tune_counters_t default_timers;
+    tcp_tune_counters_t twt_timers;
+
+    if(argc > 1)
+    {
+        if(!strcmp(argv[1], "auto") || !strcmp(argv[1], "off"))
+        {
+            tcp_tune_enabled = !strcmp(argv[1], "auto");
+            tcp_tune_update();
+        }
+        else if(!strcmp(argv[1], "reset"))
+        {
+            tcp_tune_reset_counters();
+        }
+        else
+        {
+            printf("Usage: tcp_tune [auto|off|reset]\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    tcp_tune_update();
+
+    lock_prof_get(&tcp_tune_mutex, CY_RTOS_NEVER_TIMEOUT);
+    printf("Tuning           : %s, %s\n", tcp_tune_enabled ? "auto" : "off (frames not inspected)",
+           tcp_tune_applied ? "applied (iTWT active)" : "not applied");
+    printf("Retransmit timer : %" PRIu32 " ms (default %" PRIu32 " ms)\n",
+           (uint32_t)((_nx_tcp_transmit_timer_rate * 1000u) / NX_IP_PERIODIC_RATE),
+           (uint32_t)((tcp_tune_default_transmit_rate * 1000u) / NX_IP_PERIODIC_RATE));
+    printf("Delayed ACK timer: %" PRIu32 " ms (default %" PRIu32 " ms)\n",
+           (uint32_t)((_nx_tcp_ack_timer_rate * 1000u) / NX_IP_PERIODIC_RATE),
+           (uint32_t)((tcp_tune_default_ack_rate * 1000u) / NX_IP_PERIODIC_RATE));
+    lock_prof_set(&tcp_tune_mutex);
+
+    tcp_tune_get_counters(&default_timers, &twt_timers);
+
+    printf("%-16s %10s %12s %7s %9s\n", "", "segments", "retransmits", "rate", "spurious");
+    tcp_tune_print_counters("default timers", &default_timers);
+    tcp_tune_print_counters("iTWT timers", &twt_timers);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tcp_tune_add_commands
+********************************************************************************
+* Summary:
+* This function registers the TCP tuning commands table.
+*
+*******************************************************************************/
+cy_rslt_t tcp_tune_add_commands(void)
+{
+    cy_rslt_t result;
+
+    result = cy_rtos_init_mutex(&tcp_tune_mutex);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+    lock_prof_name(&tcp_tune_mutex, "tcp_tune");
+    tcp_tune_initialized = true;
+
+    tcp_tune_update();
+
+    return cy_command_console_add_table(tcp_tune_commands_table);
+}
+#endif /* defined(__linux__) */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name:   tcp_tune.h
+*
+* Description: This file contains the declarations for the adjustment of the
+*              NetX Duo TCP timers to the iTWT agreement in effect and for the
+*              retransmission counters.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TCP_TUNE_H_
+#define TCP_TUNE_H_
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Added to twice the wake interval plus the wake duration for the minimum
+ * retransmission timeout with iTWT */
+#define TCP_TUNE_RTO_MARGIN_MS          (200u)
+
+/* TCP connections tracked for retransmission counting */
+#define TCP_TUNE_MAX_FLOWS              (4u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t segments;          /* Segments with data, SYN or FIN sent */
+    uint32_t retransmits;
+    uint32_t spurious;          /* Retransmissions whose original was ACKed */
+} tcp_tune_counters_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t tcp_tune_min_rto_ms(uint32_t wake_interval_us, uint32_t wake_duration_us, uint32_t default_ms);
+void tcp_tune_frame(bool tx, const uint8_t *frame, uint32_t length);
+void tcp_tune_frame_at(bool tx, const uint8_t *frame, uint32_t length, uint32_t now);
+void tcp_tune_get_counters(tcp_tune_counters_t *default_timers, tcp_tune_counters_t *twt_timers);
+void tcp_tune_reset_counters(void);
+
+#if defined(__linux__)
+void tcp_tune_select(bool enabled, bool twt);
+#else
+void tcp_tune_update(void);
+cy_rslt_t tcp_tune_add_commands(void);
+#endif
+
+#endif /* TCP_TUNE_H_ */
+
+/* [] END OF FILE */
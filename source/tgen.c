@@ -0,0 +1,1127 @@
+/******************************************************************************
+* File Name:   tgen.c
+*
+* Description: This file implements the UDP traffic generator. Packets are
+*              sent to one or more destinations with periodic, bursty or
+*              Poisson arrivals, or from another packet source such as a
+*              replayed trace; a sink answers every packet with a reply of
+*              the size asked for in its header, from which the generator
+*              measures round-trip latency and loss.
+*              The platform layer also has a Linux branch, so that the
+*              generator and the sink can run in a host build (see
+*              tools/tgen_host.c).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "tgen.h"
+#include "cycle_counter.h"
+#include "trace.h"
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#else
+#include "command_console.h"
+#include "cy_secure_sockets.h"
+#include "cyabs_rtos.h"
+#include "cyhal.h"
+#include "socket_init.h"
+#include "twt_session.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TGEN_MAGIC                      (0x5447454EUL) /* "TGEN" */
+
+/* Longest single wait, so that the time base is read well within a wrap */
+#define TGEN_MAX_WAIT_MS                (1000u)
+
+#define TGEN_THREAD_STACK               (3072u)
+#define TGEN_SINK_THREAD_STACK          (2048u)
+
+/* ln(2) and the log2(1 + x) approximation coefficients, Q16 */
+#define TGEN_LN2_Q16                    (45426u)
+#define TGEN_LOG2_A_Q16                 (88244u)
+#define TGEN_LOG2_B_Q16                 (22708u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+#if defined(__linux__)
+typedef int tgen_socket_t;
+typedef struct sockaddr_in tgen_addr_t;
+#else
+typedef cy_socket_t tgen_socket_t;
+typedef cy_socket_sockaddr_t tgen_addr_t;
+#endif
+
+typedef struct
+{
+    const tgen_config_t *config;
+    uint64_t             time_us;
+    uint32_t             packets;
+    uint32_t             burst_left;
+} tgen_profile_state_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int tgen_command(int argc, char* argv[], tlv_buffer_t** data);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char *tgen_profile_names[TGEN_PROFILES] = { "periodic", "bursty", "poisson" };
+
+/* State of the run in progress; only one run at a time */
+static uint8_t tgen_tx_buffer[TGEN_MAX_SIZE];
+static uint8_t tgen_rx_buffer[TGEN_HEADER_LEN];
+static uint8_t tgen_seen[TGEN_MAX_PACKETS / 8u];
+static uint32_t tgen_samples[TGEN_MAX_SAMPLES];
+static uint32_t tgen_samples_seen;
+static uint64_t tgen_rtt_sum_us;
+static uint32_t tgen_random_state;
+
+/* Sink */
+static uint8_t tgen_sink_buffer[TGEN_MAX_SIZE];
+static uint32_t tgen_sink_packets;
+static uint64_t tgen_sink_bytes;
+
+#if !defined(__linux__)
+static volatile bool tgen_running;
+static bool tgen_initialized;
+static cy_thread_t tgen_thread;
+static cy_semaphore_t tgen_start;
+static volatile bool tgen_busy;
+static tgen_config_t tgen_pending;
+static tgen_config_t tgen_configs[TGEN_PROFILES];
+static tgen_result_t tgen_results[TGEN_PROFILES];
+static bool tgen_result_valid[TGEN_PROFILES];
+
+static cy_thread_t tgen_sink_thread;
+static cy_socket_t tgen_sink_socket;
+static uint16_t tgen_sink_port;
+
+/* Time base extended from the 32-bit cycle counter */
+static uint32_t tgen_time_last;
+static uint64_t tgen_time_cycles;
+
+#define TGEN_COMMANDS \
+    { (char *) "tgen", tgen_command, 0, NULL, NULL, (char *) "<periodic|bursty|poisson> <host[,host]> <interval_ms> <size|min-max> <count> [burst] [port] | sink [port] | stats", (char *) "Generate UDP traffic and report latency and loss against an echo sink" }, \
+
+const cy_command_console_cmd_t tgen_commands_table[] =
+{
+    TGEN_COMMANDS
+    CMD_TABLE_END
+};
+#endif
+
+
+/*******************************************************************************
+* Function Name: tgen_now_us
+********************************************************************************
+* Summary:
+* This function returns a monotonic time in microseconds. On the target, the
+* 32-bit cycle counter is extended in software; it must be read at least once
+* per wrap, which the TGEN_MAX_WAIT_MS bound on every wait guarantees.
+*
+*******************************************************************************/
+static uint64_t tgen_now_us(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000u);
+#else
+    uint32_t now = cycle_counter_get();
+
+    tgen_time_cycles += (uint32_t)(now - tgen_time_last);
+    tgen_time_last = now;
+
+    return (tgen_time_cycles * 1000000ULL) / CYCLE_COUNTER_HZ;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_socket_open
+********************************************************************************
+* Summary:
+* This function creates a UDP socket, bound to the given port unless it is 0.
+*
+*******************************************************************************/
+static int tgen_socket_open(tgen_socket_t *socket_out, uint16_t port)
+{
+#if defined(__linux__)
+    struct sockaddr_in address;
+    int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+    if(s < 0)
+    {
+        return -1;
+    }
+
+    if(port != 0u)
+    {
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if(bind(s, (struct sockaddr *)&address, sizeof(address)) != 0)
+        {
+            close(s);
+            return -1;
+        }
+    }
+
+    *socket_out = s;
+    return 0;
+#else
+    cy_socket_sockaddr_t address;
+
+    if(socket_init() != CY_RSLT_SUCCESS)
+    {
+        return -1;
+    }
+
+    if(cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP,
+                        socket_out) != CY_RSLT_SUCCESS)
+    {
+        return -1;
+    }
+
+    if(port != 0u)
+    {
+        memset(&address, 0, sizeof(address));
+        address.ip_address.version = CY_SOCKET_IP_VER_V4;
+        address.port = port;
+        if(cy_socket_bind(*socket_out, &address, sizeof(address)) != CY_RSLT_SUCCESS)
+        {
+            cy_socket_delete(*socket_out);
+            return -1;
+        }
+    }
+
+    return 0;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_socket_close
+********************************************************************************
+* Summary:
+* This function deletes a socket created by tgen_socket_open().
+*
+*******************************************************************************/
+static void tgen_socket_close(tgen_socket_t s)
+{
+#if defined(__linux__)
+    close(s);
+#else
+    cy_socket_delete(s);
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_resolve
+********************************************************************************
+* Summary:
+* This function resolves a host name or dotted IPv4 address.
+*
+*******************************************************************************/
+static int tgen_resolve(const char *host, uint16_t port, tgen_addr_t *address)
+{
+    memset(address, 0, sizeof(*address));
+
+#if defined(__linux__)
+    struct addrinfo hints;
+    struct addrinfo *info = NULL;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if((getaddrinfo(host, NULL, &hints, &info) != 0) || (info == NULL))
+    {
+        return -1;
+    }
+    memcpy(address, info->ai_addr, sizeof(*address));
+    address->sin_port = htons(port);
+    freeaddrinfo(info);
+    return 0;
+#else
+    address->port = port;
+    return (cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address->ip_address) == CY_RSLT_SUCCESS) ? 0 : -1;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_send
+********************************************************************************
+* Summary:
+* This function sends one datagram.
+*
+*******************************************************************************/
+static int tgen_send(tgen_socket_t s, const tgen_addr_t *address, const uint8_t *data, uint32_t length)
+{
+#if defined(__linux__)
+    return (sendto(s, data, length, 0, (const struct sockaddr *)address, sizeof(*address)) == (ssize_t)length) ? 0 : -1;
+#else
+    uint32_t sent = 0;
+
+    return ((cy_socket_sendto(s, data, length, CY_SOCKET_FLAGS_NONE, address, sizeof(*address), &sent) ==
+             CY_RSLT_SUCCESS) && (sent == length)) ? 0 : -1;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_receive
+********************************************************************************
+* Summary:
+* This function waits up to timeout_ms for a datagram. Datagrams longer than
+* the buffer are truncated.
+*
+* Return:
+*  uint32_t : number of bytes received, 0 on timeout or error
+*
+*******************************************************************************/
+static uint32_t tgen_receive(tgen_socket_t s, uint8_t *buffer, uint32_t size, uint32_t timeout_ms,
+                             tgen_addr_t *from)
+{
+#if defined(__linux__)
+    struct timeval timeout = { (time_t)(timeout_ms / 1000u), (suseconds_t)((timeout_ms % 1000u) * 1000u) };
+    socklen_t from_length = sizeof(*from);
+    ssize_t received;
+
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    received = recvfrom(s, buffer, size, 0, (struct sockaddr *)from, &from_length);
+
+    return (received > 0) ? (uint32_t)received : 0u;
+#else
+    uint32_t from_length = sizeof(*from);
+    uint32_t received = 0;
+
+    cy_socket_setsockopt(s, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    if(cy_socket_recvfrom(s, buffer, size, CY_SOCKET_FLAGS_NONE, from, &from_length, &received) != CY_RSLT_SUCCESS)
+    {
+        return 0u;
+    }
+
+    return received;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_put_be
+********************************************************************************
+* Summary:
+* Stores a header field in big-endian order.
+*
+*******************************************************************************/
+static void tgen_put_be(uint8_t *p, uint64_t value, uint32_t bytes)
+{
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        p[i] = (uint8_t)(value >> (8u * (bytes - 1u - i)));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_get_be
+********************************************************************************
+* Summary:
+* Loads a big-endian header field.
+*
+*******************************************************************************/
+static uint64_t tgen_get_be(const uint8_t *p, uint32_t bytes)
+{
+    uint64_t value = 0;
+
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        value = (value << 8) | p[i];
+    }
+
+    return value;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_echo_size
+********************************************************************************
+* Summary:
+* Returns the size of the reply asked for in a packet header, clamped to the
+* header and datagram sizes.
+*
+*******************************************************************************/
+static uint32_t tgen_echo_size(const uint8_t *header)
+{
+    uint32_t size = (uint32_t)tgen_get_be(&header[10], 2u);
+
+    return (size < TGEN_HEADER_LEN) ? TGEN_HEADER_LEN : ((size > TGEN_MAX_SIZE) ? TGEN_MAX_SIZE : size);
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_random
+********************************************************************************
+* Summary:
+* xorshift32 pseudo-random generator, seeded at the start of every run.
+*
+*******************************************************************************/
+static uint32_t tgen_random(void)
+{
+    uint32_t x = tgen_random_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tgen_random_state = x;
+
+    return x;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_exponential_us
+********************************************************************************
+* Summary:
+* This function draws an exponentially distributed interval with the given
+* mean as -ln(U) * mean. The logarithm is computed in Q16 fixed point from the
+* position of the leading one and a quadratic fit of log2(1 + x), accurate to
+* about 0.5 %, which avoids pulling floating-point libm into the image.
+*
+*******************************************************************************/
+static uint64_t tgen_exponential_us(uint32_t mean_us)
+{
+    uint32_t u = tgen_random() | 1u;
+    uint32_t msb = 31u - (uint32_t)__builtin_clz(u);
+    uint32_t x = ((msb >= 16u) ? (u >> (msb - 16u)) : (u << (16u - msb))) & 0xFFFFu;
+    uint64_t log2_frac = ((uint64_t)x * (TGEN_LOG2_A_Q16 - (((uint64_t)TGEN_LOG2_B_Q16 * x) >> 16))) >> 16;
+    uint64_t neg_log2 = (32ULL << 16) - (((uint64_t)msb << 16) + log2_frac);
+    uint64_t neg_ln = (neg_log2 * TGEN_LN2_Q16) >> 16;
+
+    return ((uint64_t)mean_us * neg_ln) >> 16;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_compare
+********************************************************************************
+* Summary:
+* qsort() comparator for latency samples.
+*
+*******************************************************************************/
+static int tgen_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_collect
+********************************************************************************
+* Summary:
+* This function waits for one echo and accounts for it. Samples beyond
+* TGEN_MAX_SAMPLES replace stored ones at random (reservoir sampling), so the
+* percentiles stay representative of the whole run.
+*
+*******************************************************************************/
+static void tgen_collect(tgen_socket_t s, uint32_t timeout_ms, tgen_result_t *result)
+{
+    tgen_addr_t from;
+    uint32_t length = tgen_receive(s, tgen_rx_buffer, sizeof(tgen_rx_buffer), timeout_ms, &from);
+    uint64_t now = tgen_now_us();
+    uint32_t seq;
+    uint32_t flow;
+    uint32_t rtt;
+
+    if((length < TGEN_HEADER_LEN) || (tgen_get_be(&tgen_rx_buffer[0], 4u) != TGEN_MAGIC))
+    {
+        return;
+    }
+
+    seq = (uint32_t)tgen_get_be(&tgen_rx_buffer[4], 4u);
+    flow = (uint32_t)tgen_get_be(&tgen_rx_buffer[8], 2u);
+    if((seq >= result->sent) || (flow >= TGEN_MAX_DESTINATIONS))
+    {
+        return;
+    }
+    if((tgen_seen[seq / 8u] & (1u << (seq % 8u))) != 0u)
+    {
+        result->duplicates++;
+        return;
+    }
+    tgen_seen[seq / 8u] |= (uint8_t)(1u << (seq % 8u));
+    trace_record(TRACE_EVT_PKT_DEQUEUE, TRACE_QUEUE_APP, length);
+
+    rtt = (uint32_t)(now - tgen_get_be(&tgen_rx_buffer[12], 8u));
+    result->received++;
+    result->echo_bytes += tgen_echo_size(tgen_rx_buffer);
+    result->dest_received[flow]++;
+    tgen_rtt_sum_us += rtt;
+    if(rtt < result->rtt_min_us)
+    {
+        result->rtt_min_us = rtt;
+    }
+    if(rtt > result->rtt_max_us)
+    {
+        result->rtt_max_us = rtt;
+    }
+
+    if(tgen_samples_seen < TGEN_MAX_SAMPLES)
+    {
+        tgen_samples[tgen_samples_seen] = rtt;
+    }
+    else
+    {
+        uint32_t slot = tgen_random() % (tgen_samples_seen + 1u);
+        if(slot < TGEN_MAX_SAMPLES)
+        {
+            tgen_samples[slot] = rtt;
+        }
+    }
+    tgen_samples_seen++;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_profile_name
+********************************************************************************
+* Summary:
+* This function returns the name of an arrival profile.
+*
+*******************************************************************************/
+const char *tgen_profile_name(tgen_profile_t profile)
+{
+    return (profile < TGEN_PROFILES) ? tgen_profile_names[profile] : "?";
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_parse
+********************************************************************************
+* Summary:
+* This function parses the generator arguments shared by the console command
+* and the host build:
+*   <profile> <host[,host]> <interval_ms> <size|min-max> <count> [burst] [port]
+*
+* Parameters:
+*  int argc
+*  char* argv[]             : argv[0] is the profile name
+*  tgen_config_t *config    : parsed configuration
+*
+* Return:
+*  bool : true if the arguments are valid
+*
+*******************************************************************************/
+bool tgen_parse(int argc, char *argv[], tgen_config_t *config)
+{
+    char *end;
+    const char *host;
+
+    if(argc < 5)
+    {
+        return false;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->profile = TGEN_PROFILES;
+    for(uint32_t i = 0; i < TGEN_PROFILES; i++)
+    {
+        if(!strcmp(argv[0], tgen_profile_names[i]))
+        {
+            config->profile = (tgen_profile_t)i;
+        }
+    }
+
+    host = argv[1];
+    while((*host != '\0') && (config->destinations < TGEN_MAX_DESTINATIONS))
+    {
+        size_t length = strcspn(host, ",");
+
+        if((length == 0u) || (length >= TGEN_HOST_LEN))
+        {
+            return false;
+        }
+        memcpy(config->hosts[config->destinations], host, length);
+        config->hosts[config->destinations][length] = '\0';
+        config->destinations++;
+        host += length;
+        if(*host == ',')
+        {
+            host++;
+        }
+    }
+
+    config->interval_ms = (uint32_t)strtoul(argv[2], NULL, 0);
+    config->size_min = (uint32_t)strtoul(argv[3], &end, 0);
+    config->size_max = (*end == '-') ? (uint32_t)strtoul(end + 1, NULL, 0) : config->size_min;
+    config->count = (uint32_t)strtoul(argv[4], NULL, 0);
+    config->burst = (argc > 5) ? (uint32_t)strtoul(argv[5], NULL, 0) : TGEN_DEFAULT_BURST;
+    config->port = (argc > 6) ? (uint16_t)strtoul(argv[6], NULL, 0) : (uint16_t)TGEN_DEFAULT_PORT;
+
+    return (config->profile < TGEN_PROFILES) && (*host == '\0') && (config->interval_ms != 0u) &&
+           (config->size_min >= TGEN_HEADER_LEN) && (config->size_max >= config->size_min) &&
+           (config->size_max <= TGEN_MAX_SIZE) && (config->count != 0u) && (config->count <= TGEN_MAX_PACKETS) &&
+           (config->burst != 0u) && (config->port != 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_profile_next
+********************************************************************************
+* Summary:
+* Packet source of the built-in arrival profiles.
+*
+*******************************************************************************/
+static bool tgen_profile_next(void *arg, tgen_packet_t *packet)
+{
+    tgen_profile_state_t *state = (tgen_profile_state_t *)arg;
+    const tgen_config_t *config = state->config;
+
+    if(state->packets == config->count)
+    {
+        return false;
+    }
+
+    if(state->burst_left == 0u)
+    {
+        if(state->packets != 0u)
+        {
+            state->time_us += (config->profile == TGEN_POISSON) ? tgen_exponential_us(config->interval_ms * 1000u)
+                                                                : ((uint64_t)config->interval_ms * 1000u);
+        }
+        state->burst_left = (config->profile == TGEN_BURSTY) ? config->burst : 1u;
+    }
+    state->burst_left--;
+
+    packet->time_us = state->time_us;
+    packet->size = config->size_min;
+    if(config->size_max > config->size_min)
+    {
+        packet->size += tgen_random() % (config->size_max - config->size_min + 1u);
+    }
+    packet->echo_size = TGEN_HEADER_LEN;
+    packet->flow = state->packets % config->destinations;
+    state->packets++;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_run
+********************************************************************************
+* Summary:
+* This function runs one of the built-in traffic profiles to completion.
+*
+* Parameters:
+*  const tgen_config_t *config : configuration, as validated by tgen_parse()
+*  tgen_result_t *result       : delivery and latency statistics
+*
+* Return:
+*  int : 0 on success, -1 on error
+*
+*******************************************************************************/
+int tgen_run(const tgen_config_t *config, tgen_result_t *result)
+{
+    tgen_profile_state_t state;
+
+    memset(&state, 0, sizeof(state));
+    state.config = config;
+
+    return tgen_run_source(config, tgen_profile_next, &state, result);
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_run_source
+********************************************************************************
+* Summary:
+* This function sends the packets of a source at their scheduled times, to
+* the destinations and port of the configuration; at most TGEN_MAX_PACKETS
+* are sent. Echoes are collected while waiting for the next packet, then for
+* TGEN_DRAIN_MS (or two wake intervals of the iTWT agreement in effect, if
+* longer) after the last one. Round-trip times are measured against the local
+* time stamp carried in the header, so the sink needs no clock
+* synchronization. Only one run can be in progress at a time.
+*
+* Parameters:
+*  const tgen_config_t *config : destinations and port
+*  tgen_source_t source        : packet source
+*  void *arg                   : argument of the source
+*  tgen_result_t *result       : delivery and latency statistics
+*
+* Return:
+*  int : 0 on success, -1 if a run is in progress, a destination cannot be
+*        resolved or the socket cannot be created
+*
+*******************************************************************************/
+int tgen_run_source(const tgen_config_t *config, tgen_source_t source, void *arg, tgen_result_t *result)
+{
+    tgen_addr_t destinations[TGEN_MAX_DESTINATIONS];
+    tgen_packet_t packet;
+    tgen_socket_t s;
+    uint64_t start;
+    uint64_t now;
+    uint64_t deadline;
+    uint32_t drain_ms = TGEN_DRAIN_MS;
+    bool more;
+    int status = 0;
+
+#if !defined(__linux__)
+    uint32_t irq_state = cyhal_system_critical_section_enter();
+    bool busy = tgen_running;
+
+    tgen_running = true;
+    cyhal_system_critical_section_exit(irq_state);
+    if(busy)
+    {
+        return -1;
+    }
+#endif
+
+    memset(result, 0, sizeof(*result));
+    result->rtt_min_us = UINT32_MAX;
+    memset(tgen_seen, 0, sizeof(tgen_seen));
+    tgen_samples_seen = 0;
+    tgen_rtt_sum_us = 0;
+
+    for(uint32_t i = 0; (status == 0) && (i < config->destinations); i++)
+    {
+        status = tgen_resolve(config->hosts[i], config->port, &destinations[i]);
+        if(status != 0)
+        {
+            printf("tgen: cannot resolve %s\n", config->hosts[i]);
+        }
+    }
+
+    if((status != 0) || (tgen_socket_open(&s, 0u) != 0))
+    {
+#if !defined(__linux__)
+        tgen_running = false;
+#endif
+        return -1;
+    }
+
+#if !defined(__linux__)
+    {
+        twt_session_agreement_t agreement;
+
+        twt_session_get(&agreement);
+        if(agreement.active)
+        {
+            result->twt_wi_ms = twt_session_wake_interval_us(&agreement) / 1000u;
+            result->twt_wd_us = twt_session_wake_duration_us(&agreement);
+            if(2u * result->twt_wi_ms > drain_ms)
+            {
+                drain_ms = 2u * result->twt_wi_ms;
+            }
+        }
+    }
+#endif
+
+    cycle_counter_init();
+    start = tgen_now_us();
+    tgen_random_state = (uint32_t)start | 1u;
+    more = source(arg, &packet);
+
+    while(more && (result->sent < TGEN_MAX_PACKETS))
+    {
+        uint32_t size = (packet.size < TGEN_HEADER_LEN) ? TGEN_HEADER_LEN :
+                        ((packet.size > TGEN_MAX_SIZE) ? TGEN_MAX_SIZE : packet.size);
+        uint32_t flow = packet.flow % config->destinations;
+
+        now = tgen_now_us();
+        if(now < start + packet.time_us)
+        {
+            uint64_t wait_ms = (start + packet.time_us - now + 999u) / 1000u;
+            tgen_collect(s, (wait_ms > TGEN_MAX_WAIT_MS) ? TGEN_MAX_WAIT_MS : (uint32_t)wait_ms, result);
+            continue;
+        }
+
+        tgen_put_be(&tgen_tx_buffer[0], TGEN_MAGIC, 4u);
+        tgen_put_be(&tgen_tx_buffer[4], result->sent, 4u);
+        tgen_put_be(&tgen_tx_buffer[8], flow, 2u);
+        tgen_put_be(&tgen_tx_buffer[10], packet.echo_size, 2u);
+        tgen_put_be(&tgen_tx_buffer[12], tgen_now_us(), 8u);
+
+        if(tgen_send(s, &destinations[flow], tgen_tx_buffer, size) != 0)
+        {
+            result->send_errors++;
+        }
+        else
+        {
+            trace_record(TRACE_EVT_PKT_ENQUEUE, TRACE_QUEUE_APP, size);
+            result->bytes += size;
+        }
+        result->dest_sent[flow]++;
+        result->sent++;
+
+        more = source(arg, &packet);
+    }
+
+    now = tgen_now_us();
+    result->duration_ms = (uint32_t)((now - start) / 1000u);
+    deadline = now + ((uint64_t)drain_ms * 1000u);
+
+    while((result->received < result->sent) && (now < deadline))
+    {
+        uint64_t wait_ms = (deadline - now + 999u) / 1000u;
+        tgen_collect(s, (wait_ms > TGEN_MAX_WAIT_MS) ? TGEN_MAX_WAIT_MS : (uint32_t)wait_ms, result);
+        now = tgen_now_us();
+    }
+
+    tgen_socket_close(s);
+
+    if(result->received == 0u)
+    {
+        result->rtt_min_us = 0;
+    }
+    else
+    {
+        uint32_t samples = (tgen_samples_seen < TGEN_MAX_SAMPLES) ? tgen_samples_seen : TGEN_MAX_SAMPLES;
+
+        qsort(tgen_samples, samples, sizeof(tgen_samples[0]), tgen_compare);
+        result->rtt_p50_us = tgen_samples[samples / 2u];
+        result->rtt_p95_us = tgen_samples[(samples * 95u) / 100u];
+        result->rtt_avg_us = (uint32_t)(tgen_rtt_sum_us / result->received);
+    }
+
+#if !defined(__linux__)
+    tgen_running = false;
+#endif
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_print_result
+********************************************************************************
+* Summary:
+* This function prints the statistics of one run.
+*
+*******************************************************************************/
+void tgen_print_result(const tgen_config_t *config, const tgen_result_t *result)
+{
+    uint32_t lost = result->sent - result->received;
+    uint32_t loss_permille = (result->sent != 0u) ? (uint32_t)((lost * 1000ULL) / result->sent) : 0u;
+    uint32_t kbps = (result->duration_ms != 0u) ? (uint32_t)((result->bytes * 8u) / result->duration_ms) : 0u;
+
+    printf("%s: %" PRIu32 " ms, %" PRIu32 "-%" PRIu32 " bytes, port %u", tgen_profile_name(config->profile),
+           config->interval_ms, config->size_min, config->size_max, (unsigned)config->port);
+    if(config->profile == TGEN_BURSTY)
+    {
+        printf(", burst %" PRIu32, config->burst);
+    }
+    if(result->twt_wi_ms != 0u)
+    {
+        printf(", iTWT WI %" PRIu32 " ms WD %" PRIu32 " us", result->twt_wi_ms, result->twt_wd_us);
+    }
+    printf("\n");
+
+    printf("  sent %" PRIu32 " (%" PRIu32 " errors) in %" PRIu32 " ms, %" PRIu32 " kbit/s offered\n",
+           result->sent, result->send_errors, result->duration_ms, kbps);
+    printf("  echoed %" PRIu32 ", lost %" PRIu32 " (%" PRIu32 ".%" PRIu32 " %%), duplicates %" PRIu32 "\n",
+           result->received, lost, loss_permille / 10u, loss_permille % 10u, result->duplicates);
+    printf("  rtt us: min %" PRIu32 " p50 %" PRIu32 " p95 %" PRIu32 " max %" PRIu32 " avg %" PRIu32 "\n",
+           result->rtt_min_us, result->rtt_p50_us, result->rtt_p95_us, result->rtt_max_us, result->rtt_avg_us);
+
+    if(config->destinations > 1u)
+    {
+        for(uint32_t i = 0; i < config->destinations; i++)
+        {
+            printf("  %-20s sent %" PRIu32 " echoed %" PRIu32 "\n", config->hosts[i],
+                   result->dest_sent[i], result->dest_received[i]);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_sink_loop
+********************************************************************************
+* Summary:
+* This function echoes the header of every generator packet received on the
+* socket. It only returns on the host build, never on the target.
+*
+*******************************************************************************/
+static void tgen_sink_loop(tgen_socket_t s)
+{
+#if defined(__linux__)
+    uint32_t reported = 0;
+#endif
+
+    for(;;)
+    {
+        tgen_addr_t from;
+        uint32_t length = tgen_receive(s, tgen_sink_buffer, sizeof(tgen_sink_buffer), TGEN_MAX_WAIT_MS, &from);
+
+        if((length >= TGEN_HEADER_LEN) && (tgen_get_be(tgen_sink_buffer, 4u) == TGEN_MAGIC))
+        {
+            uint32_t reply = tgen_echo_size(tgen_sink_buffer);
+
+            tgen_sink_packets++;
+            tgen_sink_bytes += length;
+            if(reply > length)
+            {
+                memset(&tgen_sink_buffer[length], 0, reply - length);
+            }
+            tgen_send(s, &from, tgen_sink_buffer, reply);
+        }
+#if defined(__linux__)
+        else if((length == 0u) && (reported != tgen_sink_packets))
+        {
+            /* Idle again after a run */
+            reported = tgen_sink_packets;
+            printf("sink: %" PRIu32 " packets, %" PRIu64 " bytes\n", tgen_sink_packets, tgen_sink_bytes);
+            fflush(stdout);
+        }
+#endif
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_sink
+********************************************************************************
+* Summary:
+* This function runs the echo sink on the given port in the calling thread.
+*
+* Parameters:
+*  uint16_t port : UDP port to listen on
+*
+* Return:
+*  int : -1 if the socket cannot be created; does not return otherwise
+*
+*******************************************************************************/
+int tgen_sink(uint16_t port)
+{
+    tgen_socket_t s;
+
+    if(tgen_socket_open(&s, port) != 0)
+    {
+        return -1;
+    }
+
+    tgen_sink_loop(s);
+
+    return 0;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: tgen_thread_function
+********************************************************************************
+* Summary:
+* Runs the profiles posted by the tgen command, one at a time.
+*
+*******************************************************************************/
+static void tgen_thread_function(cy_thread_arg_t arg)
+{
+    for(;;)
+    {
+        tgen_result_t result;
+
+        cy_rtos_get_semaphore(&tgen_start, CY_RTOS_NEVER_TIMEOUT, false);
+
+        if(tgen_run(&tgen_pending, &result) == 0)
+        {
+            tgen_configs[tgen_pending.profile] = tgen_pending;
+            tgen_results[tgen_pending.profile] = result;
+            tgen_result_valid[tgen_pending.profile] = true;
+            tgen_print_result(&tgen_pending, &result);
+        }
+        else
+        {
+            printf("tgen: %s run failed\n", tgen_profile_name(tgen_pending.profile));
+        }
+
+        tgen_busy = false;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_sink_thread_function
+********************************************************************************
+* Summary:
+* Runs the echo loop on the socket opened by the tgen sink command.
+*
+*******************************************************************************/
+static void tgen_sink_thread_function(cy_thread_arg_t arg)
+{
+    tgen_sink_loop(tgen_sink_socket);
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_command
+********************************************************************************
+* Summary:
+* This function starts a traffic profile in the background, starts the echo
+* sink, or prints the last result of each profile and the sink counters.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int tgen_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    if((argc >= 2) && !strcmp(argv[1], "stats"))
+    {
+        for(uint32_t i = 0; i < TGEN_PROFILES; i++)
+        {
+            if(tgen_result_valid[i])
+            {
+                tgen_print_result(&tgen_configs[i], &tgen_results[i]);
+            }
+        }
+        if(tgen_sink_port != 0u)
+        {
+            printf("sink on port %u: %" PRIu32 " packets, %" PRIu64 " bytes\n", (unsigned)tgen_sink_port,
+                   tgen_sink_packets, tgen_sink_bytes);
+        }
+        printf("%s\n", tgen_busy ? "run in progress" : "idle");
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "sink"))
+    {
+        uint16_t port = (argc > 2) ? (uint16_t)strtoul(argv[2], NULL, 0) : (uint16_t)TGEN_DEFAULT_PORT;
+
+        if(tgen_sink_port != 0u)
+        {
+            printf("Sink already running on port %u\n", (unsigned)tgen_sink_port);
+            return -1;
+        }
+        if((tgen_socket_open(&tgen_sink_socket, port) != 0) ||
+           (cy_rtos_thread_create(&tgen_sink_thread, tgen_sink_thread_function, "TrafficSink", NULL,
+                                  TGEN_SINK_THREAD_STACK, CY_RTOS_PRIORITY_LOW, NULL) != CY_RSLT_SUCCESS))
+        {
+            printf("Failed to start the sink on port %u\n", (unsigned)port);
+            return -1;
+        }
+        tgen_sink_port = port;
+        printf("Sink listening on UDP port %u\n", (unsigned)port);
+        return 0;
+    }
+
+    if(tgen_busy)
+    {
+        printf("A run is in progress\n");
+        return -1;
+    }
+
+    if(!tgen_parse(argc - 1, &argv[1], &tgen_pending))
+    {
+        printf("Usage: tgen <periodic|bursty|poisson> <host[,host]> <interval_ms> <size|min-max> <count> [burst] [port]\n");
+        printf("       sizes %u..%u bytes, count up to %u\n", (unsigned)TGEN_HEADER_LEN, (unsigned)TGEN_MAX_SIZE,
+               (unsigned)TGEN_MAX_PACKETS);
+        return -1;
+    }
+
+    if(!tgen_initialized)
+    {
+        if((cy_rtos_init_semaphore(&tgen_start, 1, 0) != CY_RSLT_SUCCESS) ||
+           (cy_rtos_thread_create(&tgen_thread, tgen_thread_function, "TrafficGen", NULL, TGEN_THREAD_STACK,
+                                  CY_RTOS_PRIORITY_LOW, NULL) != CY_RSLT_SUCCESS))
+        {
+            printf("Failed to start the generator thread\n");
+            return -1;
+        }
+        tgen_initialized = true;
+    }
+
+    tgen_busy = true;
+    cy_rtos_set_semaphore(&tgen_start, false);
+    printf("Started %s run of %" PRIu32 " packets\n", tgen_profile_name(tgen_pending.profile), tgen_pending.count);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tgen_add_commands
+********************************************************************************
+* Summary:
+* This function registers the traffic generator commands.
+*
+*******************************************************************************/
+cy_rslt_t tgen_add_commands(void)
+{
+    return cy_command_console_add_table(tgen_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,149 @@
+/******************************************************************************
+* File Name:   tgen.h
+*
+* Description: This file contains the declarations for the UDP traffic
+*              generator and its echo sink.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TGEN_H_
+#define TGEN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#endif
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TGEN_DEFAULT_PORT               (5002u)
+
+/* Sequence numbers tracked per run, and latency samples kept for percentiles */
+#define TGEN_MAX_PACKETS                (4096u)
+#define TGEN_MAX_SAMPLES                (512u)
+
+#define TGEN_MAX_DESTINATIONS           (4u)
+#define TGEN_HOST_LEN                   (64u)
+
+/* Header carried by every packet; the sink replies with the header followed
+ * by as many bytes as the header asks for */
+#define TGEN_HEADER_LEN                 (20u)
+#define TGEN_MAX_SIZE                   (1472u)
+
+#define TGEN_DEFAULT_BURST              (8u)
+
+/* Minimum time to wait for late echoes after the last packet is sent */
+#define TGEN_DRAIN_MS                   (3000u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    TGEN_PERIODIC = 0,  /* One packet every interval */
+    TGEN_BURSTY,        /* 'burst' packets back to back every interval */
+    TGEN_POISSON,       /* Exponential inter-arrival times with the given mean */
+    TGEN_PROFILES
+} tgen_profile_t;
+
+typedef struct
+{
+    tgen_profile_t profile;
+    char           hosts[TGEN_MAX_DESTINATIONS][TGEN_HOST_LEN]; /* Used in turn */
+    uint32_t       destinations;
+    uint16_t       port;
+    uint32_t       interval_ms;  /* Period, or mean for TGEN_POISSON */
+    uint32_t       size_min;     /* Bytes of UDP payload, drawn uniformly... */
+    uint32_t       size_max;     /* ...between size_min and size_max */
+    uint32_t       count;        /* Packets to send */
+    uint32_t       burst;        /* Packets per arrival for TGEN_BURSTY */
+} tgen_config_t;
+
+typedef struct
+{
+    uint32_t sent;
+    uint32_t received;
+    uint32_t duplicates;
+    uint32_t send_errors;
+    uint32_t dest_sent[TGEN_MAX_DESTINATIONS];
+    uint32_t dest_received[TGEN_MAX_DESTINATIONS];
+    uint64_t bytes;
+    uint64_t echo_bytes;
+    uint32_t duration_ms;        /* First to last packet sent */
+    uint32_t rtt_min_us;
+    uint32_t rtt_p50_us;
+    uint32_t rtt_p95_us;
+    uint32_t rtt_max_us;
+    uint32_t rtt_avg_us;
+    uint32_t twt_wi_ms;          /* iTWT agreement during the run, 0 if none */
+    uint32_t twt_wd_us;
+} tgen_result_t;
+
+typedef struct
+{
+    uint64_t time_us;    /* Send time from the start of the run */
+    uint32_t size;       /* UDP payload sent */
+    uint32_t echo_size;  /* UDP payload the sink sends back */
+    uint32_t flow;       /* Index of the destination */
+} tgen_packet_t;
+
+/* Supplies the packets of a run in time order; returns false after the last */
+typedef bool (*tgen_source_t)(void *arg, tgen_packet_t *packet);
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+const char *tgen_profile_name(tgen_profile_t profile);
+bool tgen_parse(int argc, char *argv[], tgen_config_t *config);
+int tgen_run(const tgen_config_t *config, tgen_result_t *result);
+int tgen_run_source(const tgen_config_t *config, tgen_source_t source, void *arg, tgen_result_t *result);
+void tgen_print_result(const tgen_config_t *config, const tgen_result_t *result);
+int tgen_sink(uint16_t port);
+
+#if !defined(__linux__)
+cy_rslt_t tgen_add_commands(void);
+#endif
+
+#endif /* TGEN_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,744 @@
+/******************************************************************************
+* File Name:   tls_session.c
+*
+* Description: This file implements the TLS session resumption cache. A full
+*              TLS handshake takes two round trips plus the certificate
+*              exchange; with the idle iTWT profile each round trip can wait
+*              for the next service period. Sessions are cached per server
+*              ("host:port") across reconnects so that the next handshake can
+*              be abbreviated, and every handshake is timed.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "command_console.h"
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "lock_prof.h"
+#include "socket_init.h"
+#include "tls_session.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TLS_SESSION_MAX_ATTEMPTS        (2u)
+#define TLS_SESSION_DEFAULT_COUNT       (2u)
+
+/* Poll period of a thread waiting for another one to initialize the cache */
+#define TLS_SESSION_INIT_POLL_MS        (5u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    bool      used;
+    char      server[TLS_SESSION_SERVER_LEN];
+    uint8_t   blob[TLS_SESSION_BLOB_SIZE];
+    size_t    length;
+    cy_time_t stored_ms;
+    cy_time_t last_used_ms;
+    uint32_t  lifetime_s;
+    uint32_t  hits;
+} tls_session_entry_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int tls_connect_command(int argc, char* argv[], tlv_buffer_t** data);
+int tls_cache_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static tls_session_entry_t tls_session_cache[TLS_SESSION_CACHE_ENTRIES];
+static tls_session_stats_t tls_session_stats;
+static const tls_session_backend_t *tls_session_backend;
+static cy_mutex_t tls_session_mutex;
+static volatile bool tls_session_initialized;
+static bool tls_session_initializing;
+
+#define TLS_SESSION_COMMANDS \
+    { (char *) "tls_connect", tls_connect_command, 1, NULL, NULL, (char *) "<host> [port] [count]", (char *) "Connect to a TLS server 'count' times and time each handshake" }, \
+    { (char *) "tls_cache", tls_cache_command, 0, NULL, NULL, (char *) "[clear]", (char *) "Show the TLS session cache, resumption hit rate and handshake times" }, \
+
+const cy_command_console_cmd_t tls_session_commands_table[] =
+{
+    TLS_SESSION_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: tls_session_init
+********************************************************************************
+* Summary:
+* This function initializes the secure sockets library and the cache, and
+* registers the session functions of the TLS port if it has them. Like
+* socket_init(), the first caller initializes while the others wait.
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t tls_session_init(void)
+{
+    bool claimed = false;
+    uint32_t critical;
+    cy_rslt_t result;
+
+    result = socket_init();
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    while(!claimed)
+    {
+        critical = cyhal_system_critical_section_enter();
+        if(tls_session_initialized)
+        {
+            cyhal_system_critical_section_exit(critical);
+            return CY_RSLT_SUCCESS;
+        }
+        claimed = !tls_session_initializing;
+        tls_session_initializing = true;
+        cyhal_system_critical_section_exit(critical);
+
+        if(!claimed)
+        {
+            cy_rtos_delay_milliseconds(TLS_SESSION_INIT_POLL_MS);
+        }
+    }
+
+    result = cy_rtos_init_mutex(&tls_session_mutex);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        lock_prof_name(&tls_session_mutex, "tls_session");
+
+#if defined(COMPONENT_MBEDTLS)
+        if(tls_session_backend == NULL)
+        {
+            tls_session_set_backend(&tls_session_mbedtls_backend);
+        }
+#endif
+        tls_session_initialized = true;
+    }
+    tls_session_initializing = false;
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_set_backend
+********************************************************************************
+* Summary:
+* This function sets the session export/import functions of the TLS stack,
+* replacing those registered by tls_session_init().
+*
+*******************************************************************************/
+void tls_session_set_backend(const tls_session_backend_t *backend)
+{
+    tls_session_backend = backend;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_find
+********************************************************************************
+* Summary:
+* This function returns the cache entry of a server, dropping it if the
+* session has expired. Must be called with the cache mutex held.
+*
+*******************************************************************************/
+static tls_session_entry_t* tls_session_find(const char *server, cy_time_t now)
+{
+    for(uint32_t i = 0; i < TLS_SESSION_CACHE_ENTRIES; i++)
+    {
+        tls_session_entry_t *entry = &tls_session_cache[i];
+
+        if(entry->used && !strcmp(entry->server, server))
+        {
+            if((now - entry->stored_ms) / 1000u >= entry->lifetime_s)
+            {
+                entry->used = false;
+                return NULL;
+            }
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_slot
+********************************************************************************
+* Summary:
+* This function returns the entry to store the session of a server in: the
+* server's entry, a free entry, or the least recently used one. Must be called
+* with the cache mutex held.
+*
+*******************************************************************************/
+static tls_session_entry_t* tls_session_slot(const char *server, cy_time_t now)
+{
+    tls_session_entry_t *slot = tls_session_find(server, now);
+
+    for(uint32_t i = 0; (slot == NULL) && (i < TLS_SESSION_CACHE_ENTRIES); i++)
+    {
+        if(!tls_session_cache[i].used)
+        {
+            slot = &tls_session_cache[i];
+        }
+    }
+
+    if(slot != NULL)
+    {
+        return slot;
+    }
+
+    slot = &tls_session_cache[0];
+    for(uint32_t i = 1; i < TLS_SESSION_CACHE_ENTRIES; i++)
+    {
+        if((now - tls_session_cache[i].last_used_ms) > (now - slot->last_used_ms))
+        {
+            slot = &tls_session_cache[i];
+        }
+    }
+
+    return slot;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_key
+********************************************************************************
+* Summary:
+* This function formats the cache key of a server.
+*
+*******************************************************************************/
+static void tls_session_key(char *key, const char *host, uint16_t port)
+{
+    snprintf(key, TLS_SESSION_SERVER_LEN, "%s:%u", host, (unsigned)port);
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_record
+********************************************************************************
+* Summary:
+* This function adds one handshake to the statistics.
+*
+*******************************************************************************/
+static void tls_session_record(bool resumed, uint32_t elapsed_ms)
+{
+    lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    if(resumed)
+    {
+        tls_session_stats.resumed_handshakes++;
+        tls_session_stats.resumed_ms_total += elapsed_ms;
+        if(elapsed_ms > tls_session_stats.resumed_ms_max)
+        {
+            tls_session_stats.resumed_ms_max = elapsed_ms;
+        }
+    }
+    else
+    {
+        tls_session_stats.full_handshakes++;
+        tls_session_stats.full_ms_total += elapsed_ms;
+        if(elapsed_ms > tls_session_stats.full_ms_max)
+        {
+            tls_session_stats.full_ms_max = elapsed_ms;
+        }
+    }
+
+    lock_prof_set(&tls_session_mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_create_socket
+********************************************************************************
+* Summary:
+* This function creates a TLS socket with SNI, authentication mode and I/O
+* timeouts set.
+*
+*******************************************************************************/
+static cy_rslt_t tls_session_create_socket(const char *host, cy_socket_tls_auth_mode_t auth_mode,
+                                           cy_socket_t *socket)
+{
+    uint32_t timeout = TLS_SESSION_IO_TIMEOUT_MS;
+    cy_rslt_t result;
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TLS, socket);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    result = cy_socket_setsockopt(*socket, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_SERVER_NAME_INDICATION,
+                                  host, (uint32_t)strlen(host));
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_setsockopt(*socket, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TLS_AUTH_MODE,
+                                      &auth_mode, sizeof(auth_mode));
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_setsockopt(*socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO,
+                                      &timeout, sizeof(timeout));
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_setsockopt(*socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO,
+                                      &timeout, sizeof(timeout));
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        cy_socket_delete(*socket);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_connect
+********************************************************************************
+* Summary:
+* This function connects a TLS socket to a server, offering the cached
+* session of the server if there is one. If the server rejects the handshake
+* with the cached session, the session is dropped and a full handshake is
+* done. After every handshake the session is exported again, so that the
+* cache holds the latest session or ticket the server issued.
+*
+* Parameters:
+*  const char *host                    : server name, also sent as SNI
+*  uint16_t port                       : server port
+*  cy_socket_tls_auth_mode_t auth_mode : server certificate verification. The
+*                                        root CA must be loaded with
+*                                        cy_tls_load_global_root_ca_certificates()
+*  cy_socket_t *socket                 : connected socket, to be deleted by
+*                                        the caller
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t tls_session_connect(const char *host, uint16_t port, cy_socket_tls_auth_mode_t auth_mode,
+                              cy_socket_t *socket)
+{
+    const tls_session_backend_t *backend = tls_session_backend;
+    uint8_t *blob = NULL;
+    bool connected = false;
+    char key[TLS_SESSION_SERVER_LEN];
+    cy_socket_sockaddr_t address;
+    cy_rslt_t result;
+
+    result = tls_session_init();
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    memset(&address, 0, sizeof(address));
+    result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address.ip_address);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+    address.port = port;
+
+    tls_session_key(key, host, port);
+
+    /* Session buffer of this connect, off the stack of the calling thread */
+    if(backend != NULL)
+    {
+        blob = malloc(TLS_SESSION_BLOB_SIZE);
+        if(blob == NULL)
+        {
+            backend = NULL;
+        }
+    }
+
+    for(uint32_t attempt = 0; !connected && (attempt < TLS_SESSION_MAX_ATTEMPTS); attempt++)
+    {
+        bool offered = false;
+        bool resumed;
+        cy_time_t start;
+        cy_time_t end;
+        size_t length = 0;
+        uint32_t lifetime_s = 0;
+
+        result = tls_session_create_socket(host, auth_mode, socket);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+
+        /* Copy the cached session out; the handshake runs without the
+         * cache mutex, so that other connects are not held up by it */
+        if((backend != NULL) && (attempt == 0u))
+        {
+            tls_session_entry_t *entry;
+
+            cy_rtos_get_time(&start);
+            lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+            entry = tls_session_find(key, start);
+            if(entry != NULL)
+            {
+                memcpy(blob, entry->blob, entry->length);
+                length = entry->length;
+                entry->last_used_ms = start;
+            }
+            lock_prof_set(&tls_session_mutex);
+
+            offered = (length != 0u) && (backend->import(*socket, blob, length) == CY_RSLT_SUCCESS);
+        }
+
+        cy_rtos_get_time(&start);
+        result = cy_socket_connect(*socket, &address, sizeof(address));
+        cy_rtos_get_time(&end);
+
+        resumed = offered && backend->resumed(*socket);
+
+        if(result != CY_RSLT_SUCCESS)
+        {
+            lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+            tls_session_stats.failed_handshakes++;
+            tls_session_stats.lookups += offered ? 1u : 0u;
+            lock_prof_set(&tls_session_mutex);
+            cy_socket_delete(*socket);
+
+            if(!offered)
+            {
+                break;
+            }
+
+            /* The server did not accept the cached session; retry in full */
+            tls_session_invalidate(host, port);
+            continue;
+        }
+
+        if(offered)
+        {
+            lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+            tls_session_stats.lookups++;
+            if(resumed)
+            {
+                tls_session_entry_t *entry = tls_session_find(key, end);
+
+                tls_session_stats.hits++;
+                if(entry != NULL)
+                {
+                    entry->hits++;
+                }
+            }
+            lock_prof_set(&tls_session_mutex);
+        }
+
+        if((backend != NULL) &&
+           (backend->export(*socket, blob, &length, &lifetime_s) == CY_RSLT_SUCCESS) &&
+           (length <= TLS_SESSION_BLOB_SIZE))
+        {
+            tls_session_entry_t *entry;
+            uint32_t hits;
+
+            /* The hits of the server carry over to its new session */
+            lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+            entry = tls_session_slot(key, end);
+            hits = (entry->used && !strcmp(entry->server, key)) ? entry->hits : 0u;
+            memset(entry, 0, sizeof(*entry));
+            entry->used = true;
+            entry->hits = hits;
+            strncpy(entry->server, key, sizeof(entry->server) - 1);
+            memcpy(entry->blob, blob, length);
+            entry->length = length;
+            entry->stored_ms = end;
+            entry->last_used_ms = end;
+            entry->lifetime_s = (lifetime_s != 0u) ? lifetime_s : TLS_SESSION_DEFAULT_LIFETIME_S;
+            lock_prof_set(&tls_session_mutex);
+        }
+
+        tls_session_record(resumed, (uint32_t)(end - start));
+        connected = true;
+    }
+
+    free(blob);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_invalidate
+********************************************************************************
+* Summary:
+* This function drops the cached session of a server.
+*
+*******************************************************************************/
+void tls_session_invalidate(const char *host, uint16_t port)
+{
+    char key[TLS_SESSION_SERVER_LEN];
+
+    if(!tls_session_initialized)
+    {
+        return;
+    }
+
+    tls_session_key(key, host, port);
+
+    lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+    for(uint32_t i = 0; i < TLS_SESSION_CACHE_ENTRIES; i++)
+    {
+        if(tls_session_cache[i].used && !strcmp(tls_session_cache[i].server, key))
+        {
+            tls_session_cache[i].used = false;
+        }
+    }
+    lock_prof_set(&tls_session_mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_clear
+********************************************************************************
+* Summary:
+* This function drops all cached sessions and resets the statistics.
+*
+*******************************************************************************/
+void tls_session_clear(void)
+{
+    if(!tls_session_initialized)
+    {
+        return;
+    }
+
+    lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+    memset(tls_session_cache, 0, sizeof(tls_session_cache));
+    memset(&tls_session_stats, 0, sizeof(tls_session_stats));
+    lock_prof_set(&tls_session_mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_get_stats
+********************************************************************************
+* Summary:
+* This function returns a copy of the handshake statistics.
+*
+*******************************************************************************/
+void tls_session_get_stats(tls_session_stats_t *stats)
+{
+    if(!tls_session_initialized)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+    *stats = tls_session_stats;
+    lock_prof_set(&tls_session_mutex);
+}
+
+
+/*******************************************************************************
+* Function Name: tls_connect_command
+********************************************************************************
+* Summary:
+* This function connects to a TLS server 'count' times (default 2, so that
+* the second handshake can be resumed) and prints the time of each handshake.
+* The server certificate is not verified; the command only measures the
+* handshake.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int tls_connect_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint16_t port = TLS_SESSION_DEFAULT_PORT;
+    uint32_t count = TLS_SESSION_DEFAULT_COUNT;
+    tls_session_stats_t before;
+    tls_session_stats_t after;
+    cy_socket_t socket;
+    cy_rslt_t result;
+
+    if(argc > 2)
+    {
+        port = (uint16_t)strtoul(argv[2], NULL, 0);
+    }
+    if(argc > 3)
+    {
+        count = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+
+    if(tls_session_backend == NULL)
+    {
+        printf("No TLS session backend registered, all handshakes are full handshakes\n");
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        tls_session_get_stats(&before);
+
+        result = tls_session_connect(argv[1], port, CY_SOCKET_TLS_VERIFY_NONE, &socket);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            printf("Connect %" PRIu32 " to %s:%u failed: 0x%08" PRIx32 "\n", i + 1u, argv[1], (unsigned)port, result);
+            return -1;
+        }
+
+        tls_session_get_stats(&after);
+
+        if(after.resumed_handshakes != before.resumed_handshakes)
+        {
+            printf("Connect %" PRIu32 ": resumed handshake in %" PRIu32 " ms\n", i + 1u,
+                   after.resumed_ms_total - before.resumed_ms_total);
+        }
+        else
+        {
+            printf("Connect %" PRIu32 ": full handshake in %" PRIu32 " ms\n", i + 1u,
+                   after.full_ms_total - before.full_ms_total);
+        }
+
+        cy_socket_disconnect(socket, 0);
+        cy_socket_delete(socket);
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_cache_command
+********************************************************************************
+* Summary:
+* This function prints the cached sessions and the handshake statistics, or
+* clears them with "clear".
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int tls_cache_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    tls_session_stats_t stats;
+    cy_time_t now;
+
+    if((argc > 1) && !strcmp(argv[1], "clear"))
+    {
+        tls_session_clear();
+        return 0;
+    }
+
+    tls_session_get_stats(&stats);
+
+    printf("Resumption hits    : %" PRIu32 " of %" PRIu32 " offered sessions\n", stats.hits, stats.lookups);
+    printf("Full handshakes    : %" PRIu32 ", avg %" PRIu32 " ms, max %" PRIu32 " ms\n",
+           stats.full_handshakes,
+           (stats.full_handshakes != 0u) ? (stats.full_ms_total / stats.full_handshakes) : 0u,
+           stats.full_ms_max);
+    printf("Resumed handshakes : %" PRIu32 ", avg %" PRIu32 " ms, max %" PRIu32 " ms\n",
+           stats.resumed_handshakes,
+           (stats.resumed_handshakes != 0u) ? (stats.resumed_ms_total / stats.resumed_handshakes) : 0u,
+           stats.resumed_ms_max);
+    printf("Failed handshakes  : %" PRIu32 "\n", stats.failed_handshakes);
+
+    if(!tls_session_initialized)
+    {
+        return 0;
+    }
+
+    cy_rtos_get_time(&now);
+
+    lock_prof_get(&tls_session_mutex, CY_RTOS_NEVER_TIMEOUT);
+    for(uint32_t i = 0; i < TLS_SESSION_CACHE_ENTRIES; i++)
+    {
+        const tls_session_entry_t *entry = &tls_session_cache[i];
+
+        if(entry->used)
+        {
+            printf("  %-40s %4u bytes, %" PRIu32 " hits, age %" PRIu32 " s of %" PRIu32 " s\n",
+                   entry->server, (unsigned)entry->length, entry->hits,
+                   (uint32_t)((now - entry->stored_ms) / 1000u), entry->lifetime_s);
+        }
+    }
+    lock_prof_set(&tls_session_mutex);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_add_commands
+********************************************************************************
+* Summary:
+* This function registers the TLS session commands table.
+*
+*******************************************************************************/
+cy_rslt_t tls_session_add_commands(void)
+{
+    return cy_command_console_add_table(tls_session_commands_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,134 @@
+/******************************************************************************
+* File Name:   tls_session.h
+*
+* Description: This file contains the declarations for the TLS session
+*              resumption cache and the TLS connect helper.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TLS_SESSION_H_
+#define TLS_SESSION_H_
+
+#include "cy_result.h"
+#include "cy_secure_sockets.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of servers whose session is cached */
+#define TLS_SESSION_CACHE_ENTRIES       (4u)
+
+/* Maximum size of a serialized session (session ID or ticket, master secret) */
+#define TLS_SESSION_BLOB_SIZE           (512u)
+
+/* Maximum length of the "host:port" key */
+#define TLS_SESSION_SERVER_LEN          (64u)
+
+/* Lifetime of a cached session when the server does not give one */
+#define TLS_SESSION_DEFAULT_LIFETIME_S  (3600u)
+
+#define TLS_SESSION_DEFAULT_PORT        (443u)
+#define TLS_SESSION_IO_TIMEOUT_MS       (10000u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+/* Session export/import of the TLS stack in use. The secure sockets library
+ * does not expose the sessions of its TLS contexts, so the TLS port provides
+ * these functions; tls_session_init() registers those of the Mbed TLS port
+ * (See tls_session_mbedtls.c). Without a backend every handshake is a full
+ * handshake; it is still timed and counted. */
+typedef struct
+{
+    /* Offers a cached session in the handshake of a TLS socket, called
+     * before the socket is connected. The blob stays valid until 'resumed'
+     * is called for the socket. */
+    cy_rslt_t (*import)(cy_socket_t socket, const uint8_t *blob, size_t length);
+
+    /* Serializes the session of a connected TLS socket. 'lifetime_s' is the
+     * ticket lifetime given by the server, or 0 if unknown. */
+    cy_rslt_t (*export)(cy_socket_t socket, uint8_t *blob, size_t *length, uint32_t *lifetime_s);
+
+    /* Tells whether the handshake of a socket a session was imported into
+     * was abbreviated, i.e. the server resumed the session. Called once after
+     * the connect, whether it succeeded or not. */
+    bool (*resumed)(cy_socket_t socket);
+} tls_session_backend_t;
+
+typedef struct
+{
+    uint32_t full_handshakes;
+    uint32_t resumed_handshakes;
+    uint32_t failed_handshakes;
+    uint32_t lookups;               /* Handshakes that offered a cached session */
+    uint32_t hits;                  /* Offered sessions the server resumed */
+    uint32_t full_ms_total;
+    uint32_t full_ms_max;
+    uint32_t resumed_ms_total;
+    uint32_t resumed_ms_max;
+} tls_session_stats_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+#if defined(COMPONENT_MBEDTLS)
+extern const tls_session_backend_t tls_session_mbedtls_backend;
+#endif
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t tls_session_init(void);
+void tls_session_set_backend(const tls_session_backend_t *backend);
+cy_rslt_t tls_session_connect(const char *host, uint16_t port, cy_socket_tls_auth_mode_t auth_mode,
+                              cy_socket_t *socket);
+void tls_session_invalidate(const char *host, uint16_t port);
+void tls_session_clear(void);
+void tls_session_get_stats(tls_session_stats_t *stats);
+cy_rslt_t tls_session_add_commands(void);
+
+#endif /* TLS_SESSION_H_ */
+
+/* [] END OF FILE */
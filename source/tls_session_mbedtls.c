@@ -0,0 +1,381 @@
+/******************************************************************************
+* File Name:   tls_session_mbedtls.c
+*
+* Description: This file implements the session export/import functions of
+*              the TLS session cache for the Mbed TLS port of the secure
+*              sockets library (COMPONENT_MBEDTLS). tls_session_init()
+*              registers them. The TLS context of a socket is only created
+*              by cy_socket_connect(), so an imported session is applied by
+*              a wrapper of mbedtls_ssl_handshake() (linked with
+*              -Wl,--wrap=mbedtls_ssl_handshake, See the Makefile), which
+*              also reads from the handshake whether it was resumed.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#if defined(COMPONENT_MBEDTLS)
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "tls_session.h"
+
+/* The secure sockets library keeps the TLS context of a socket, and the
+ * Mbed TLS context in it, in its private structures; these headers are not
+ * part of its API. Check tls_session_ssl() when updating the library. */
+#include "cy_secure_sockets_pvt.h"
+#include "cy_tls.h"
+
+/* Mbed TLS header files. The handshake parameters are internal to Mbed TLS;
+ * check tls_session_mbedtls_handshake_resumed() when updating it. */
+#include "mbedtls/ssl.h"
+#include "mbedtls/version.h"
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#include "ssl_misc.h"
+#else
+#include "mbedtls/ssl_internal.h"
+#endif
+
+/* Standard C header files. */
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Session fields are private from Mbed TLS 3.0 on */
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(member)         member
+#endif
+
+#if (MBEDTLS_VERSION_NUMBER >= 0x03020000)
+#define TLS_SESSION_HANDSHAKE_OVER(ssl) mbedtls_ssl_is_handshake_over(ssl)
+#else
+#define TLS_SESSION_HANDSHAKE_OVER(ssl) ((ssl)->MBEDTLS_PRIVATE(state) == MBEDTLS_SSL_HANDSHAKE_OVER)
+#endif
+
+/* Connects offering a session at the same time */
+#define TLS_SESSION_MBEDTLS_OFFERS      (TLS_SESSION_CACHE_ENTRIES)
+
+#define TLS_SESSION_MBEDTLS_ERROR       ((cy_rslt_t)-1)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+/* Session to offer in the next handshake of a socket */
+typedef struct
+{
+    cy_socket_t    socket;              /* NULL if the entry is free */
+    const uint8_t *blob;
+    size_t         length;
+    bool           applied;             /* Set in the Mbed TLS context */
+    bool           resumed;             /* The handshake was abbreviated */
+} tls_session_mbedtls_offer_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t tls_session_mbedtls_import(cy_socket_t socket, const uint8_t *blob, size_t length);
+static cy_rslt_t tls_session_mbedtls_export(cy_socket_t socket, uint8_t *blob, size_t *length,
+                                            uint32_t *lifetime_s);
+static bool tls_session_mbedtls_resumed(cy_socket_t socket);
+int __real_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+int __wrap_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+const tls_session_backend_t tls_session_mbedtls_backend =
+{
+    .import  = tls_session_mbedtls_import,
+    .export  = tls_session_mbedtls_export,
+    .resumed = tls_session_mbedtls_resumed
+};
+
+static tls_session_mbedtls_offer_t tls_session_mbedtls_offers[TLS_SESSION_MBEDTLS_OFFERS];
+
+
+/*******************************************************************************
+* Function Name: tls_session_ssl
+********************************************************************************
+* Summary:
+* This function returns the Mbed TLS context of a TLS socket, or NULL before
+* the TLS context is created.
+*
+*******************************************************************************/
+static mbedtls_ssl_context* tls_session_ssl(cy_socket_t socket)
+{
+    cy_socket_ctx_t *ctx = (cy_socket_ctx_t *)socket;
+
+    if((ctx == NULL) || (ctx->tls_ctx == NULL))
+    {
+        return NULL;
+    }
+
+    return &((cy_tls_context_mbedtls_t *)ctx->tls_ctx)->ssl_ctx;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_mbedtls_import
+********************************************************************************
+* Summary:
+* This function keeps a cached session to offer in the next handshake of a
+* socket, before it is connected. The blob must stay valid until
+* tls_session_mbedtls_resumed() is called for the socket.
+*
+*******************************************************************************/
+static cy_rslt_t tls_session_mbedtls_import(cy_socket_t socket, const uint8_t *blob, size_t length)
+{
+    cy_rslt_t result = TLS_SESSION_MBEDTLS_ERROR;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    for(uint32_t i = 0; i < TLS_SESSION_MBEDTLS_OFFERS; i++)
+    {
+        tls_session_mbedtls_offer_t *offer = &tls_session_mbedtls_offers[i];
+
+        if(offer->socket == NULL)
+        {
+            offer->socket  = socket;
+            offer->blob    = blob;
+            offer->length  = length;
+            offer->applied = false;
+            offer->resumed = false;
+            result = CY_RSLT_SUCCESS;
+            break;
+        }
+    }
+    cyhal_system_critical_section_exit(state);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_mbedtls_export
+********************************************************************************
+* Summary:
+* This function serializes the session negotiated by a connected socket.
+*
+*******************************************************************************/
+static cy_rslt_t tls_session_mbedtls_export(cy_socket_t socket, uint8_t *blob, size_t *length,
+                                            uint32_t *lifetime_s)
+{
+    mbedtls_ssl_context *ssl = tls_session_ssl(socket);
+    mbedtls_ssl_session session;
+    int ret;
+
+    if(ssl == NULL)
+    {
+        return TLS_SESSION_MBEDTLS_ERROR;
+    }
+
+    mbedtls_ssl_session_init(&session);
+    ret = mbedtls_ssl_get_session(ssl, &session);
+    if(ret == 0)
+    {
+        ret = mbedtls_ssl_session_save(&session, blob, TLS_SESSION_BLOB_SIZE, length);
+    }
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    *lifetime_s = session.MBEDTLS_PRIVATE(ticket_lifetime);
+#else
+    *lifetime_s = 0;
+#endif
+    mbedtls_ssl_session_free(&session);
+
+    return (ret == 0) ? CY_RSLT_SUCCESS : TLS_SESSION_MBEDTLS_ERROR;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_mbedtls_resumed
+********************************************************************************
+* Summary:
+* This function tells whether the handshake of a socket the session was
+* imported into resumed it, and forgets the socket. It is called once after
+* the connect, whether it succeeded or not.
+*
+*******************************************************************************/
+static bool tls_session_mbedtls_resumed(cy_socket_t socket)
+{
+    bool resumed = false;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    for(uint32_t i = 0; i < TLS_SESSION_MBEDTLS_OFFERS; i++)
+    {
+        tls_session_mbedtls_offer_t *offer = &tls_session_mbedtls_offers[i];
+
+        if(offer->socket == socket)
+        {
+            resumed = offer->applied && offer->resumed;
+            offer->socket = NULL;
+            break;
+        }
+    }
+    cyhal_system_critical_section_exit(state);
+
+    return resumed;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_mbedtls_find
+********************************************************************************
+* Summary:
+* This function returns the session offered in the handshake of an Mbed TLS
+* context, or NULL. Each offer is only used by the thread that connects its
+* socket, so the entry is not locked once found.
+*
+*******************************************************************************/
+static tls_session_mbedtls_offer_t* tls_session_mbedtls_find(const mbedtls_ssl_context *ssl)
+{
+    tls_session_mbedtls_offer_t *found = NULL;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    for(uint32_t i = 0; i < TLS_SESSION_MBEDTLS_OFFERS; i++)
+    {
+        if((tls_session_mbedtls_offers[i].socket != NULL) &&
+           (tls_session_ssl(tls_session_mbedtls_offers[i].socket) == ssl))
+        {
+            found = &tls_session_mbedtls_offers[i];
+            break;
+        }
+    }
+    cyhal_system_critical_section_exit(state);
+
+    return found;
+}
+
+
+/*******************************************************************************
+* Function Name: tls_session_mbedtls_handshake_resumed
+********************************************************************************
+* Summary:
+* This function tells whether the handshake in progress is abbreviated: in
+* TLS 1.3, the server selected the offered PSK (RFC 8446 4.2.11); in TLS 1.2,
+* Mbed TLS accepted the server's resumption of the session (RFC 5246 7.3,
+* RFC 5077 3.4). Valid once the ServerHello is parsed, until the handshake
+* parameters are freed at the end of the handshake.
+*
+*******************************************************************************/
+static bool tls_session_mbedtls_handshake_resumed(mbedtls_ssl_context *ssl)
+{
+    const mbedtls_ssl_handshake_params *handshake = ssl->MBEDTLS_PRIVATE(handshake);
+
+    if(handshake == NULL)
+    {
+        return false;
+    }
+
+#if defined(MBEDTLS_SSL_PROTO_TLS1_3)
+    if(ssl->MBEDTLS_PRIVATE(tls_version) == MBEDTLS_SSL_VERSION_TLS1_3)
+    {
+        return mbedtls_ssl_tls13_key_exchange_mode_with_psk(ssl);
+    }
+#endif
+
+    return (handshake->resume != 0);
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap_mbedtls_ssl_handshake
+********************************************************************************
+* Summary:
+* Wraps mbedtls_ssl_handshake(), which the secure sockets library calls once
+* it has set up the TLS context of a socket. If a session was imported for
+* the socket, it is set in the context before the first handshake step, and
+* the handshake is run step by step like mbedtls_ssl_handshake() does, to
+* read after each step whether the server resumed it.
+*
+* Parameters:
+*  mbedtls_ssl_context *ssl
+*
+* Return:
+*  int : as mbedtls_ssl_handshake()
+*
+*******************************************************************************/
+int __wrap_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl)
+{
+    tls_session_mbedtls_offer_t *offer = (ssl != NULL) ? tls_session_mbedtls_find(ssl) : NULL;
+    int ret = 0;
+
+    if(offer == NULL)
+    {
+        return __real_mbedtls_ssl_handshake(ssl);
+    }
+
+    if(ssl->MBEDTLS_PRIVATE(conf) == NULL)
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    if(!offer->applied && (ssl->MBEDTLS_PRIVATE(state) == MBEDTLS_SSL_HELLO_REQUEST))
+    {
+        mbedtls_ssl_session session;
+
+        mbedtls_ssl_session_init(&session);
+        offer->applied = (mbedtls_ssl_session_load(&session, offer->blob, offer->length) == 0) &&
+                         (mbedtls_ssl_set_session(ssl, &session) == 0);
+        mbedtls_ssl_session_free(&session);
+    }
+
+    while(!TLS_SESSION_HANDSHAKE_OVER(ssl))
+    {
+        ret = mbedtls_ssl_handshake_step(ssl);
+        if(ssl->MBEDTLS_PRIVATE(handshake) != NULL)
+        {
+            offer->resumed = tls_session_mbedtls_handshake_resumed(ssl);
+        }
+        if(ret != 0)
+        {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+#endif /* COMPONENT_MBEDTLS */
+
+
+/* [] END OF FILE */
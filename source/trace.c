@@ -0,0 +1,460 @@
+/******************************************************************************
+* File Name:   trace.c
+*
+* Description: This file implements the binary event tracer. Events are
+*              12-byte records in a RAM ring, time-stamped with the cycle
+*              counter. "trace dump" prints the ring as text lines which
+*              tools/trace2json.py converts to Chrome trace JSON.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cycle_counter.h"
+#include "trace.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#else
+#include "cyhal.h"
+#include "command_console.h"
+#include "bench.h"
+
+/* ThreadX header file. */
+#include "tx_api.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TRACE_STRING_NONE               (0xFFFFu)
+
+/* Scratch ring written by the trace_record benchmark */
+#define TRACE_BENCH_EVENTS              (16u)
+
+#if ((TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1u)) != 0u)
+#error "TRACE_BUFFER_EVENTS must be a power of two"
+#endif
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int trace_command(int argc, char* argv[], tlv_buffer_t** data);
+static void trace_bench_record(void *arg);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static trace_event_t trace_buffer[TRACE_BUFFER_EVENTS];
+static uint32_t trace_head;             /* Number of events ever recorded */
+static volatile bool trace_enabled;
+static const char *trace_strings[TRACE_MAX_STRINGS];
+static uint32_t trace_string_count;
+
+#if defined(__linux__)
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+#else
+/* ThreadX list of created threads, used to name the threads in a dump */
+extern TX_THREAD *_tx_thread_created_ptr;
+extern ULONG _tx_thread_created_count;
+
+static trace_event_t trace_bench_buffer[TRACE_BENCH_EVENTS];
+static uint32_t trace_bench_head;
+
+#define TRACE_COMMANDS \
+    { (char *) "trace", trace_command, 1, NULL, NULL, (char *) "<start|stop|clear|dump|status>", (char *) "Control the event tracer and dump events for tools/trace2json.py" }, \
+
+const cy_command_console_cmd_t trace_commands_table[] =
+{
+    TRACE_COMMANDS
+    CMD_TABLE_END
+};
+
+static const bench_case_t trace_bench_table[] =
+{
+    BENCH_CASE("trace_record", NULL, trace_bench_record, NULL, NULL)
+    BENCH_TABLE_END
+};
+#endif /* defined(__linux__) */
+
+
+/*******************************************************************************
+* Function Name: trace_lock / trace_unlock
+********************************************************************************
+* Summary:
+* Serialize the updates of the ring: a critical section on the kit, so that
+* ISRs and the context switch hooks can record, a mutex in the host build.
+*
+*******************************************************************************/
+static inline uint32_t trace_lock(void)
+{
+#if defined(__linux__)
+    pthread_mutex_lock(&trace_mutex);
+    return 0;
+#else
+    return cyhal_system_critical_section_enter();
+#endif
+}
+
+static inline void trace_unlock(uint32_t state)
+{
+#if defined(__linux__)
+    (void)state;
+    pthread_mutex_unlock(&trace_mutex);
+#else
+    cyhal_system_critical_section_exit(state);
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: trace_store
+********************************************************************************
+* Summary:
+* Writes one event at the head of a ring. Called with the ring locked.
+*
+*******************************************************************************/
+static inline void trace_store(trace_event_t *ring, uint32_t mask, uint32_t *head,
+                               trace_event_type_t type, uint16_t arg16, uint32_t arg32)
+{
+    trace_event_t *event = &ring[*head & mask];
+
+    event->timestamp = cycle_counter_get();
+    event->type      = (uint8_t)type;
+    event->reserved  = 0;
+    event->arg16     = arg16;
+    event->arg32     = arg32;
+    (*head)++;
+}
+
+
+/*******************************************************************************
+* Function Name: trace_init
+********************************************************************************
+* Summary:
+* This function resets the tracer. Tracing starts disabled.
+*
+*******************************************************************************/
+void trace_init(void)
+{
+    cycle_counter_init();
+    trace_enabled = false;
+    trace_head = 0;
+}
+
+
+/*******************************************************************************
+* Function Name: trace_enable
+********************************************************************************
+* Summary:
+* This function starts or stops recording. Stopping keeps the recorded events.
+*
+*******************************************************************************/
+void trace_enable(bool enable)
+{
+    cycle_counter_init();
+    trace_enabled = enable;
+}
+
+
+/*******************************************************************************
+* Function Name: trace_is_enabled
+********************************************************************************
+* Summary:
+* This function tells whether events are being recorded.
+*
+*******************************************************************************/
+bool trace_is_enabled(void)
+{
+    return trace_enabled;
+}
+
+
+/*******************************************************************************
+* Function Name: trace_clear
+********************************************************************************
+* Summary:
+* This function drops all recorded events.
+*
+*******************************************************************************/
+void trace_clear(void)
+{
+    uint32_t state = trace_lock();
+    trace_head = 0;
+    trace_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: trace_record
+********************************************************************************
+* Summary:
+* This function records one event. It may be called from threads, timers and
+* ISRs, including the context switch hooks. When the ring is full the oldest
+* events are overwritten.
+*
+* Parameters:
+*  trace_event_type_t type : event type
+*  uint16_t arg16          : event specific argument
+*  uint32_t arg32          : event specific argument
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_record(trace_event_type_t type, uint16_t arg16, uint32_t arg32)
+{
+    uint32_t state;
+
+    if(!trace_enabled)
+    {
+        return;
+    }
+
+    state = trace_lock();
+    trace_store(trace_buffer, TRACE_BUFFER_EVENTS - 1u, &trace_head, type, arg16, arg32);
+    trace_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: trace_string
+********************************************************************************
+* Summary:
+* This function returns the index of a string referenced by events, e.g. a
+* command name. Strings are kept by pointer and must stay valid.
+*
+* Parameters:
+*  const char *str : string to intern
+*
+* Return:
+*  uint16_t : string index, 0xFFFF if the string table is full
+*
+*******************************************************************************/
+uint16_t trace_string(const char *str)
+{
+    uint32_t state;
+    uint16_t index = TRACE_STRING_NONE;
+
+    state = trace_lock();
+    for(uint32_t i = 0; i < trace_string_count; i++)
+    {
+        if((trace_strings[i] == str) || !strcmp(trace_strings[i], str))
+        {
+            index = (uint16_t)i;
+            break;
+        }
+    }
+    if((index == TRACE_STRING_NONE) && (trace_string_count < TRACE_MAX_STRINGS))
+    {
+        trace_strings[trace_string_count] = str;
+        index = (uint16_t)trace_string_count++;
+    }
+    trace_unlock(state);
+
+    return index;
+}
+
+
+/*******************************************************************************
+* Function Name: trace_dump
+********************************************************************************
+* Summary:
+* This function prints the recorded events, oldest first. Recording is paused
+* while dumping. Format (one record per line):
+*    TRACE <version> <cycle counter Hz> <number of events> <events lost>
+*    N <thread id> <thread name>                (kit only)
+*    S <string index> <string>
+*    E <timestamp> <type> <arg16> <arg32>        (hexadecimal)
+*    END
+* The host build prints the same format, with timestamps in nanoseconds.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_dump(void)
+{
+    bool was_enabled = trace_enabled;
+    uint32_t count;
+    uint32_t first;
+
+    trace_enabled = false;
+
+    count = (trace_head > TRACE_BUFFER_EVENTS) ? TRACE_BUFFER_EVENTS : trace_head;
+    first = trace_head - count;
+
+    printf("TRACE %u %" PRIu32 " %" PRIu32 " %" PRIu32 "\n", (unsigned)TRACE_FORMAT_VERSION,
+           (uint32_t)CYCLE_COUNTER_HZ, count, trace_head - count);
+
+#if !defined(__linux__)
+    {
+        TX_THREAD *thread = _tx_thread_created_ptr;
+
+        for(ULONG i = 0; (i < _tx_thread_created_count) && (thread != NULL); i++)
+        {
+            printf("N %08" PRIx32 " %s\n", (uint32_t)(uintptr_t)thread,
+                   (thread->tx_thread_name != NULL) ? thread->tx_thread_name : "?");
+            thread = thread->tx_thread_created_next;
+        }
+    }
+#endif
+
+    for(uint32_t i = 0; i < trace_string_count; i++)
+    {
+        printf("S %" PRIu32 " %s\n", i, trace_strings[i]);
+    }
+
+    for(uint32_t i = first; i != trace_head; i++)
+    {
+        const trace_event_t *event = &trace_buffer[i & (TRACE_BUFFER_EVENTS - 1u)];
+        printf("E %08" PRIx32 " %02x %04x %08" PRIx32 "\n", event->timestamp,
+               event->type, event->arg16, event->arg32);
+    }
+
+    printf("END\n");
+
+    trace_enabled = was_enabled;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: trace_command
+********************************************************************************
+* Summary:
+* This function handles the trace command.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int trace_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    if(argc < 2)
+    {
+        printf("Insufficient number of arguments. Command format: trace <start|stop|clear|dump|status>\n");
+        return -1;
+    }
+
+    if(!strcmp(argv[1], "start"))
+    {
+        trace_enable(true);
+    }
+    else if(!strcmp(argv[1], "stop"))
+    {
+        trace_enable(false);
+    }
+    else if(!strcmp(argv[1], "clear"))
+    {
+        trace_clear();
+    }
+    else if(!strcmp(argv[1], "dump"))
+    {
+        trace_dump();
+    }
+    else if(!strcmp(argv[1], "status"))
+    {
+        printf("Tracing %s, %" PRIu32 " events recorded, ring of %u events\n",
+               trace_enabled ? "enabled" : "disabled", trace_head, (unsigned)TRACE_BUFFER_EVENTS);
+    }
+    else
+    {
+        printf("Invalid argument '%s'\n", argv[1]);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: trace_bench_record
+********************************************************************************
+* Summary:
+* Benchmark of the cost of recording one event while tracing is enabled. The
+* event goes to a scratch ring, so that benchmarking neither adds events to
+* the trace nor overwrites recorded ones.
+*
+*******************************************************************************/
+static void trace_bench_record(void *arg)
+{
+    uint32_t state = trace_lock();
+    trace_store(trace_bench_buffer, TRACE_BENCH_EVENTS - 1u, &trace_bench_head, TRACE_EVT_MARK, TRACE_STRING_NONE, 0);
+    trace_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: trace_add_commands
+********************************************************************************
+* Summary:
+* This function registers the trace commands table and benchmark.
+*
+*******************************************************************************/
+cy_rslt_t trace_add_commands(void)
+{
+    cy_rslt_t result = bench_add_table(trace_bench_table);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    return cy_command_console_add_table(trace_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   trace.h
+*
+* Description: This file contains the declarations for the low-overhead binary
+*              event tracer. Events are dumped over the console and converted
+*              to Chrome trace JSON by tools/trace2json.py.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of events kept in RAM; must be a power of two. 12 bytes per event. */
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS             (512u)
+#endif
+
+/* Maximum number of strings (command names, etc.) referenced by events */
+#define TRACE_MAX_STRINGS               (32u)
+
+#define TRACE_FORMAT_VERSION            (1u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    TRACE_EVT_THREAD_ENTER = 1,     /* arg32: thread id */
+    TRACE_EVT_THREAD_EXIT,          /* arg32: thread id */
+    TRACE_EVT_ISR_ENTER,            /* arg16: exception number */
+    TRACE_EVT_ISR_EXIT,             /* arg16: exception number */
+    TRACE_EVT_SP_START,             /* arg16: TWT flow id, arg32: SP duration in us */
+    TRACE_EVT_SP_END,               /* arg16: TWT flow id */
+    TRACE_EVT_PKT_ENQUEUE,          /* arg16: queue id, arg32: length */
+    TRACE_EVT_PKT_DEQUEUE,          /* arg16: queue id, arg32: length */
+    TRACE_EVT_CMD_START,            /* arg16: string index */
+    TRACE_EVT_CMD_END,              /* arg16: string index, arg32: result */
+    TRACE_EVT_TWT_SETUP,            /* arg16: profile, arg32: WI in us */
+    TRACE_EVT_TWT_TEARDOWN,         /* arg16: flow id */
+    TRACE_EVT_MARK                  /* arg16: string index, arg32: user value */
+} trace_event_type_t;
+
+/* Queue ids for packet events */
+typedef enum
+{
+    TRACE_QUEUE_WLAN_TX = 0,        /* Stack to WLAN */
+    TRACE_QUEUE_WLAN_RX,            /* WLAN to stack */
+    TRACE_QUEUE_APP
+} trace_queue_t;
+
+typedef struct
+{
+    uint32_t timestamp;             /* Cycle counter */
+    uint8_t  type;                  /* trace_event_type_t */
+    uint8_t  reserved;
+    uint16_t arg16;
+    uint32_t arg32;
+} trace_event_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void trace_init(void);
+void trace_enable(bool enable);
+bool trace_is_enabled(void);
+void trace_clear(void);
+void trace_record(trace_event_type_t type, uint16_t arg16, uint32_t arg32);
+uint16_t trace_string(const char *str);
+void trace_dump(void);
+
+#if !defined(__linux__)
+cy_rslt_t trace_add_commands(void);
+#endif
+
+#endif /* TRACE_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,1023 @@
+/******************************************************************************
+* File Name:   traffic_trace.c
+*
+* Description: This file implements the traffic trace. While recording, the
+*              secure sockets send/receive calls of the application are
+*              logged as (time, size, flow) events. The trace is exported in
+*              a compact binary format, and can be loaded back and replayed
+*              against the traffic generator sink, on the kit with a chosen
+*              iTWT agreement or in the host build: data sent is replayed as
+*              packets of the same size, data received as requests the sink
+*              answers with that many bytes.
+*
+*              The binary format and the replay source have no platform
+*              dependencies; the recording, transfer and console parts are
+*              target only.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "traffic_trace.h"
+
+#if !defined(__linux__)
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "awake_est.h"
+#include "cycle_counter.h"
+#include "socket_init.h"
+#include "twt_session.h"
+
+/* Wi-Fi connection manager header file. */
+#include "cy_wcm.h"
+
+/* Secure sockets header file. */
+#include "cy_secure_sockets.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TRAFFIC_TRACE_MAGIC             (0x43525454UL) /* "TTRC" little-endian */
+
+#define TRAFFIC_TRACE_SOCKET_TIMEOUT_MS (5000u)
+
+/* Above this gap the 32-bit cycle counter may have wrapped (after ~22 s at
+ * 192 MHz); the RTOS time is used. Half the wrap period leaves a margin for
+ * the resolution of the RTOS time. */
+#define TRAFFIC_TRACE_CYCLE_GAP_MS      ((uint32_t)((0xFFFFFFFFULL * 1000ULL / 2ULL) / CYCLE_COUNTER_HZ))
+
+/* Binary bytes per line of the dump */
+#define TRAFFIC_TRACE_DUMP_LINE         (32u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+#if !defined(__linux__)
+typedef struct
+{
+    bool               valid;
+    awake_est_mode_t   mode;
+    tgen_result_t      tgen;
+    awake_est_result_t awake;
+} traffic_trace_run_t;
+#endif
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#if !defined(__linux__)
+int traffic_trace_command(int argc, char* argv[], tlv_buffer_t** data);
+
+/* Defined in main.c */
+cy_rslt_t itwt_select(cy_wcm_itwt_profile_t profile);
+
+#if defined(APP_TRAFFIC_TRACE)
+cy_rslt_t __real_cy_socket_send(cy_socket_t handle, const void *buffer, uint32_t length, int flags,
+                                uint32_t *bytes_sent);
+cy_rslt_t __real_cy_socket_sendto(cy_socket_t handle, const void *buffer, uint32_t length, int flags,
+                                  const cy_socket_sockaddr_t *dest_addr, uint32_t address_length,
+                                  uint32_t *bytes_sent);
+cy_rslt_t __real_cy_socket_recv(cy_socket_t handle, void *buffer, uint32_t length, int flags,
+                                uint32_t *bytes_received);
+cy_rslt_t __real_cy_socket_recvfrom(cy_socket_t handle, void *buffer, uint32_t length, int flags,
+                                    cy_socket_sockaddr_t *src_addr, uint32_t *src_addr_length,
+                                    uint32_t *bytes_received);
+#endif
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+#if !defined(__linux__)
+/* Recorded or loaded trace */
+static traffic_trace_event_t traffic_trace_events[TRAFFIC_TRACE_EVENTS];
+static uint32_t traffic_trace_count;
+static uint32_t traffic_trace_dropped;
+static volatile bool traffic_trace_recording;
+
+static cy_socket_t traffic_trace_sockets[TRAFFIC_TRACE_MAX_FLOWS];
+static uint32_t traffic_trace_flows;
+static uint32_t traffic_trace_last_cycles;
+static cy_time_t traffic_trace_last_ms;
+
+/* Replay results per iTWT profile (none, idle, active) */
+static const char *traffic_trace_profile_names[] = { "none", "idle", "active" };
+static traffic_trace_run_t traffic_trace_runs[3];
+
+#define TRAFFIC_TRACE_COMMANDS \
+    { (char *) "ttrace", traffic_trace_command, 0, NULL, NULL, (char *) "<start|stop|clear|status|dump|send <host> [port]|load <host> [port]|replay <host> <current|none|idle|active> [port]|compare>", (char *) "Record, export, load and replay a trace of application traffic" }, \
+
+const cy_command_console_cmd_t traffic_trace_commands_table[] =
+{
+    TRAFFIC_TRACE_COMMANDS
+    CMD_TABLE_END
+};
+#endif
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_put_le
+********************************************************************************
+* Summary:
+* Stores a field in little-endian order.
+*
+*******************************************************************************/
+static void traffic_trace_put_le(uint8_t *p, uint32_t value, uint32_t bytes)
+{
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        p[i] = (uint8_t)(value >> (8u * i));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_get_le
+********************************************************************************
+* Summary:
+* Loads a little-endian field.
+*
+*******************************************************************************/
+static uint32_t traffic_trace_get_le(const uint8_t *p, uint32_t bytes)
+{
+    uint32_t value = 0;
+
+    for(uint32_t i = bytes; i > 0u; i--)
+    {
+        value = (value << 8) | p[i - 1u];
+    }
+
+    return value;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_encode_header
+********************************************************************************
+* Summary:
+* This function writes the TRAFFIC_TRACE_HEADER_LEN bytes of the trace
+* header: magic, version, flows, events and duration in milliseconds.
+*
+* Parameters:
+*  uint8_t *out                         : output buffer
+*  const traffic_trace_header_t *header : header fields
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void traffic_trace_encode_header(uint8_t *out, const traffic_trace_header_t *header)
+{
+    traffic_trace_put_le(&out[0], TRAFFIC_TRACE_MAGIC, 4u);
+    traffic_trace_put_le(&out[4], TRAFFIC_TRACE_VERSION, 2u);
+    traffic_trace_put_le(&out[6], header->flows, 2u);
+    traffic_trace_put_le(&out[8], header->events, 4u);
+    traffic_trace_put_le(&out[12], header->duration_ms, 4u);
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_decode_header
+********************************************************************************
+* Summary:
+* This function parses a trace header.
+*
+* Parameters:
+*  const uint8_t *in              : TRAFFIC_TRACE_HEADER_LEN bytes
+*  traffic_trace_header_t *header : header fields
+*
+* Return:
+*  bool : false if the magic or the version does not match
+*
+*******************************************************************************/
+bool traffic_trace_decode_header(const uint8_t *in, traffic_trace_header_t *header)
+{
+    header->flows = traffic_trace_get_le(&in[6], 2u);
+    header->events = traffic_trace_get_le(&in[8], 4u);
+    header->duration_ms = traffic_trace_get_le(&in[12], 4u);
+
+    return (traffic_trace_get_le(&in[0], 4u) == TRAFFIC_TRACE_MAGIC) &&
+           (traffic_trace_get_le(&in[4], 2u) == TRAFFIC_TRACE_VERSION);
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_encode_event
+********************************************************************************
+* Summary:
+* This function writes the TRAFFIC_TRACE_EVENT_LEN bytes of an event.
+*
+*******************************************************************************/
+void traffic_trace_encode_event(uint8_t *out, const traffic_trace_event_t *event)
+{
+    traffic_trace_put_le(&out[0], event->delta_us, 4u);
+    traffic_trace_put_le(&out[4], event->size, 2u);
+    out[6] = event->flow;
+    out[7] = 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_decode_event
+********************************************************************************
+* Summary:
+* This function parses an event.
+*
+*******************************************************************************/
+void traffic_trace_decode_event(const uint8_t *in, traffic_trace_event_t *event)
+{
+    event->delta_us = traffic_trace_get_le(&in[0], 4u);
+    event->size = (uint16_t)traffic_trace_get_le(&in[4], 2u);
+    event->flow = in[6];
+    event->reserved = 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_replay_init
+********************************************************************************
+* Summary:
+* This function prepares the replay of a trace.
+*
+* Parameters:
+*  traffic_trace_replay_t *replay      : replay state
+*  const traffic_trace_event_t *events : events of the trace
+*  uint32_t count                      : number of events
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void traffic_trace_replay_init(traffic_trace_replay_t *replay, const traffic_trace_event_t *events, uint32_t count)
+{
+    memset(replay, 0, sizeof(*replay));
+    replay->events = events;
+    replay->count = count;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_replay_next
+********************************************************************************
+* Summary:
+* Packet source for tgen_run_source(). Events larger than a datagram are
+* split into back-to-back datagrams at the time of the event. Data sent is
+* replayed as packets of its size answered with a bare header; data received
+* as bare headers answered with packets of its size.
+*
+*******************************************************************************/
+bool traffic_trace_replay_next(void *arg, tgen_packet_t *packet)
+{
+    traffic_trace_replay_t *replay = (traffic_trace_replay_t *)arg;
+    uint32_t chunk;
+
+    while(replay->remaining == 0u)
+    {
+        const traffic_trace_event_t *event;
+
+        if(replay->index == replay->count)
+        {
+            return false;
+        }
+
+        event = &replay->events[replay->index++];
+        replay->time_us += event->delta_us;
+        replay->remaining = event->size;
+        replay->rx = ((event->flow & TRAFFIC_TRACE_FLAG_RX) != 0u);
+        replay->flow = event->flow & (uint8_t)~TRAFFIC_TRACE_FLAG_RX;
+    }
+
+    chunk = (replay->remaining > TGEN_MAX_SIZE) ? TGEN_MAX_SIZE : replay->remaining;
+    replay->remaining -= chunk;
+
+    packet->time_us = replay->time_us;
+    packet->size = replay->rx ? TGEN_HEADER_LEN : chunk;
+    packet->echo_size = replay->rx ? chunk : TGEN_HEADER_LEN;
+    packet->flow = replay->flow;
+
+    return true;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: traffic_trace_record
+********************************************************************************
+* Summary:
+* This function appends an event while recording. Events past
+* TRAFFIC_TRACE_EVENTS are counted as dropped.
+*
+*******************************************************************************/
+static void traffic_trace_record(cy_socket_t socket, bool rx, uint32_t bytes)
+{
+    traffic_trace_event_t *event;
+    uint32_t cycles;
+    cy_time_t now;
+    uint32_t flow;
+    uint32_t state;
+
+    if(!traffic_trace_recording || (bytes == 0u))
+    {
+        return;
+    }
+
+    cy_rtos_get_time(&now);
+    cycles = cycle_counter_get();
+
+    state = cyhal_system_critical_section_enter();
+
+    if(traffic_trace_count == TRAFFIC_TRACE_EVENTS)
+    {
+        traffic_trace_dropped++;
+        cyhal_system_critical_section_exit(state);
+        return;
+    }
+
+    for(flow = 0; (flow < traffic_trace_flows) && (traffic_trace_sockets[flow] != socket); flow++)
+    {
+    }
+    if(flow == traffic_trace_flows)
+    {
+        if(traffic_trace_flows < TRAFFIC_TRACE_MAX_FLOWS)
+        {
+            traffic_trace_sockets[traffic_trace_flows++] = socket;
+        }
+        else
+        {
+            flow = TRAFFIC_TRACE_MAX_FLOWS - 1u;
+        }
+    }
+
+    event = &traffic_trace_events[traffic_trace_count++];
+    event->delta_us = ((uint32_t)(now - traffic_trace_last_ms) < TRAFFIC_TRACE_CYCLE_GAP_MS) ?
+                      (uint32_t)(cycle_counter_to_ns(cycles - traffic_trace_last_cycles) / 1000u) :
+                      (uint32_t)(now - traffic_trace_last_ms) * 1000u;
+    event->size = (bytes > UINT16_MAX) ? UINT16_MAX : (uint16_t)bytes;
+    event->flow = (uint8_t)(flow | (rx ? TRAFFIC_TRACE_FLAG_RX : 0u));
+    event->reserved = 0u;
+    traffic_trace_last_ms = now;
+    traffic_trace_last_cycles = cycles;
+
+    cyhal_system_critical_section_exit(state);
+}
+
+
+#if defined(APP_TRAFFIC_TRACE)
+/*******************************************************************************
+* Function Name: __wrap_cy_socket_send
+********************************************************************************
+* Summary:
+* Records the data sent on a connected socket.
+*
+*******************************************************************************/
+cy_rslt_t __wrap_cy_socket_send(cy_socket_t handle, const void *buffer, uint32_t length, int flags,
+                                uint32_t *bytes_sent)
+{
+    cy_rslt_t result = __real_cy_socket_send(handle, buffer, length, flags, bytes_sent);
+
+    if((result == CY_RSLT_SUCCESS) && (bytes_sent != NULL))
+    {
+        traffic_trace_record(handle, false, *bytes_sent);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap_cy_socket_sendto
+********************************************************************************
+* Summary:
+* Records a datagram sent.
+*
+*******************************************************************************/
+cy_rslt_t __wrap_cy_socket_sendto(cy_socket_t handle, const void *buffer, uint32_t length, int flags,
+                                  const cy_socket_sockaddr_t *dest_addr, uint32_t address_length,
+                                  uint32_t *bytes_sent)
+{
+    cy_rslt_t result = __real_cy_socket_sendto(handle, buffer, length, flags, dest_addr, address_length, bytes_sent);
+
+    if((result == CY_RSLT_SUCCESS) && (bytes_sent != NULL))
+    {
+        traffic_trace_record(handle, false, *bytes_sent);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap_cy_socket_recv
+********************************************************************************
+* Summary:
+* Records the data received on a connected socket.
+*
+*******************************************************************************/
+cy_rslt_t __wrap_cy_socket_recv(cy_socket_t handle, void *buffer, uint32_t length, int flags,
+                                uint32_t *bytes_received)
+{
+    cy_rslt_t result = __real_cy_socket_recv(handle, buffer, length, flags, bytes_received);
+
+    if((result == CY_RSLT_SUCCESS) && (bytes_received != NULL))
+    {
+        traffic_trace_record(handle, true, *bytes_received);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: __wrap_cy_socket_recvfrom
+********************************************************************************
+* Summary:
+* Records a datagram received.
+*
+*******************************************************************************/
+cy_rslt_t __wrap_cy_socket_recvfrom(cy_socket_t handle, void *buffer, uint32_t length, int flags,
+                                    cy_socket_sockaddr_t *src_addr, uint32_t *src_addr_length,
+                                    uint32_t *bytes_received)
+{
+    cy_rslt_t result = __real_cy_socket_recvfrom(handle, buffer, length, flags, src_addr, src_addr_length,
+                                                 bytes_received);
+
+    if((result == CY_RSLT_SUCCESS) && (bytes_received != NULL))
+    {
+        traffic_trace_record(handle, true, *bytes_received);
+    }
+
+    return result;
+}
+#endif /* APP_TRAFFIC_TRACE */
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_header
+********************************************************************************
+* Summary:
+* This function fills the header of the trace held on the target.
+*
+*******************************************************************************/
+static void traffic_trace_header(traffic_trace_header_t *header)
+{
+    uint64_t duration_us = 0;
+
+    for(uint32_t i = 0; i < traffic_trace_count; i++)
+    {
+        duration_us += traffic_trace_events[i].delta_us;
+    }
+
+    header->events = traffic_trace_count;
+    header->flows = traffic_trace_flows;
+    header->duration_ms = (uint32_t)(duration_us / 1000u);
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_dump
+********************************************************************************
+* Summary:
+* This function prints the binary trace as hex lines between "TTRACE" and
+* "END", for tools/ttrace.py.
+*
+*******************************************************************************/
+static void traffic_trace_dump(void)
+{
+    traffic_trace_header_t header;
+    uint8_t bytes[TRAFFIC_TRACE_DUMP_LINE];
+    uint32_t length;
+
+    traffic_trace_header(&header);
+    traffic_trace_encode_header(bytes, &header);
+
+    printf("TTRACE %u %" PRIu32 "\n", (unsigned)TRAFFIC_TRACE_VERSION, header.events);
+    for(uint32_t i = 0; i < TRAFFIC_TRACE_HEADER_LEN; i++)
+    {
+        printf("%02x", bytes[i]);
+    }
+    printf("\n");
+
+    for(uint32_t i = 0; i < traffic_trace_count; i += length / TRAFFIC_TRACE_EVENT_LEN)
+    {
+        length = 0;
+        while((length < sizeof(bytes)) && (i + length / TRAFFIC_TRACE_EVENT_LEN < traffic_trace_count))
+        {
+            traffic_trace_encode_event(&bytes[length], &traffic_trace_events[i + length / TRAFFIC_TRACE_EVENT_LEN]);
+            length += TRAFFIC_TRACE_EVENT_LEN;
+        }
+        for(uint32_t j = 0; j < length; j++)
+        {
+            printf("%02x", bytes[j]);
+        }
+        printf("\n");
+    }
+
+    printf("END\n");
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_connect
+********************************************************************************
+* Summary:
+* This function connects a TCP socket to tools/ttrace.py on a host.
+*
+*******************************************************************************/
+static cy_rslt_t traffic_trace_connect(const char *host, uint16_t port, cy_socket_t *socket)
+{
+    cy_socket_sockaddr_t address;
+    uint32_t timeout = TRAFFIC_TRACE_SOCKET_TIMEOUT_MS;
+    cy_rslt_t result;
+
+    memset(&address, 0, sizeof(address));
+
+    result = socket_init();
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &address.ip_address);
+        address.port = port;
+    }
+    if(result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP, socket);
+    }
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    cy_socket_setsockopt(*socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO, &timeout, sizeof(timeout));
+    cy_socket_setsockopt(*socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    result = cy_socket_connect(*socket, &address, sizeof(address));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        cy_socket_delete(*socket);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_send
+********************************************************************************
+* Summary:
+* This function sends the binary trace to tools/ttrace.py listening on a
+* host.
+*
+*******************************************************************************/
+static cy_rslt_t traffic_trace_send(const char *host, uint16_t port)
+{
+    traffic_trace_header_t header;
+    uint8_t bytes[TRAFFIC_TRACE_HEADER_LEN];
+    cy_socket_t socket;
+    uint32_t sent = 0;
+    cy_rslt_t result = traffic_trace_connect(host, port, &socket);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    traffic_trace_header(&header);
+    traffic_trace_encode_header(bytes, &header);
+    result = cy_socket_send(socket, bytes, TRAFFIC_TRACE_HEADER_LEN, CY_SOCKET_FLAGS_NONE, &sent);
+
+    for(uint32_t i = 0; (result == CY_RSLT_SUCCESS) && (i < traffic_trace_count); i++)
+    {
+        traffic_trace_encode_event(bytes, &traffic_trace_events[i]);
+        result = cy_socket_send(socket, bytes, TRAFFIC_TRACE_EVENT_LEN, CY_SOCKET_FLAGS_NONE, &sent);
+    }
+
+    cy_socket_disconnect(socket, 0);
+    cy_socket_delete(socket);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_receive
+********************************************************************************
+* Summary:
+* This function receives exactly 'length' bytes.
+*
+*******************************************************************************/
+static cy_rslt_t traffic_trace_receive(cy_socket_t socket, uint8_t *buffer, uint32_t length)
+{
+    uint32_t offset = 0;
+
+    while(offset < length)
+    {
+        uint32_t received = 0;
+        cy_rslt_t result = cy_socket_recv(socket, &buffer[offset], length - offset, CY_SOCKET_FLAGS_NONE, &received);
+
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        if(received == 0u)
+        {
+            return CY_RSLT_SOCKET_ERROR_TIMEOUT;
+        }
+        offset += received;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_load
+********************************************************************************
+* Summary:
+* This function loads a binary trace served by tools/ttrace.py, replacing
+* the one held on the target. Traces longer than TRAFFIC_TRACE_EVENTS are
+* truncated.
+*
+*******************************************************************************/
+static cy_rslt_t traffic_trace_load(const char *host, uint16_t port)
+{
+    traffic_trace_header_t header;
+    uint8_t bytes[TRAFFIC_TRACE_HEADER_LEN];
+    cy_socket_t socket;
+    uint32_t count = 0;
+    cy_rslt_t result = traffic_trace_connect(host, port, &socket);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    memset(&header, 0, sizeof(header));
+    result = traffic_trace_receive(socket, bytes, TRAFFIC_TRACE_HEADER_LEN);
+    if((result == CY_RSLT_SUCCESS) && !traffic_trace_decode_header(bytes, &header))
+    {
+        printf("Not a traffic trace\n");
+        result = (cy_rslt_t)-1;
+    }
+
+    while((result == CY_RSLT_SUCCESS) && (count < header.events) && (count < TRAFFIC_TRACE_EVENTS))
+    {
+        result = traffic_trace_receive(socket, bytes, TRAFFIC_TRACE_EVENT_LEN);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            traffic_trace_decode_event(bytes, &traffic_trace_events[count++]);
+        }
+    }
+
+    cy_socket_disconnect(socket, 0);
+    cy_socket_delete(socket);
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        traffic_trace_count = count;
+        traffic_trace_flows = (header.flows < TRAFFIC_TRACE_MAX_FLOWS) ? header.flows : TRAFFIC_TRACE_MAX_FLOWS;
+        traffic_trace_dropped = header.events - count;
+        memset(traffic_trace_sockets, 0, sizeof(traffic_trace_sockets));
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_replay
+********************************************************************************
+* Summary:
+* This function switches to the requested iTWT profile, replays the trace
+* against the sink on 'host' and stores the result under the agreement in
+* effect during the run.
+*
+*******************************************************************************/
+static int traffic_trace_replay(const char *host, const char *profile_name, uint16_t port)
+{
+    traffic_trace_replay_t replay;
+    twt_session_agreement_t agreement;
+    awake_est_config_t model;
+    traffic_trace_run_t *run;
+    tgen_config_t config;
+    uint32_t profile;
+
+    if(strcmp(profile_name, "current") != 0)
+    {
+        for(profile = 0; profile < 3u; profile++)
+        {
+            if(!strcmp(profile_name, traffic_trace_profile_names[profile]))
+            {
+                break;
+            }
+        }
+        if(profile == 3u)
+        {
+            printf("Unknown profile '%s'\n", profile_name);
+            return -1;
+        }
+        if(itwt_select((cy_wcm_itwt_profile_t)profile) != CY_RSLT_SUCCESS)
+        {
+            printf("Failed to switch to iTWT profile %s\n", profile_name);
+            return -1;
+        }
+    }
+
+    twt_session_get(&agreement);
+    profile = agreement.active ? (uint32_t)agreement.profile : (uint32_t)CY_WCM_ITWT_PROFILE_NONE;
+    run = &traffic_trace_runs[profile];
+
+    memset(&config, 0, sizeof(config));
+    strncpy(config.hosts[0], host, TGEN_HOST_LEN - 1u);
+    config.destinations = 1;
+    config.port = port;
+
+    traffic_trace_replay_init(&replay, traffic_trace_events, traffic_trace_count);
+    awake_est_detect(&model);
+    awake_est_start(&model);
+
+    if(tgen_run_source(&config, traffic_trace_replay_next, &replay, &run->tgen) != 0)
+    {
+        awake_est_stop(&run->awake);
+        printf("Replay failed\n");
+        return -1;
+    }
+
+    awake_est_stop(&run->awake);
+    run->mode = model.mode;
+    run->valid = true;
+
+    printf("Replayed %" PRIu32 " events with iTWT profile %s\n", traffic_trace_count,
+           traffic_trace_profile_names[profile]);
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_compare
+********************************************************************************
+* Summary:
+* This function prints the replay results side by side, with the changes in
+* throughput, median latency and awake time relative to the run without
+* iTWT, or to the first run if there is none.
+*
+*******************************************************************************/
+static void traffic_trace_compare(void)
+{
+    const traffic_trace_run_t *base = NULL;
+
+    for(uint32_t i = 0; (i < 3u) && (base == NULL); i++)
+    {
+        if(traffic_trace_runs[i].valid)
+        {
+            base = &traffic_trace_runs[i];
+        }
+    }
+    if(base == NULL)
+    {
+        printf("No replay results\n");
+        return;
+    }
+
+    printf("%-7s %-6s %6s %5s %7s %8s %8s %8s %6s %8s %8s %8s\n", "itwt", "ps", "sent", "lost", "kbit/s",
+           "p50(us)", "p95(us)", "awake ms", "awake%", "d kbit/s", "d p50", "d awake");
+
+    for(uint32_t i = 0; i < 3u; i++)
+    {
+        const traffic_trace_run_t *run = &traffic_trace_runs[i];
+        int32_t kbps;
+        int32_t base_kbps;
+        uint32_t permille;
+
+        if(!run->valid)
+        {
+            continue;
+        }
+
+        kbps = (run->tgen.duration_ms != 0u) ?
+               (int32_t)(((run->tgen.bytes + run->tgen.echo_bytes) * 8u) / run->tgen.duration_ms) : 0;
+        base_kbps = (base->tgen.duration_ms != 0u) ?
+                    (int32_t)(((base->tgen.bytes + base->tgen.echo_bytes) * 8u) / base->tgen.duration_ms) : 0;
+        permille = (run->awake.elapsed_ms != 0u) ?
+                   (uint32_t)(((uint64_t)run->awake.awake_ms * 1000u) / run->awake.elapsed_ms) : 0u;
+
+        printf("%-7s %-6s %6" PRIu32 " %5" PRIu32 " %7" PRId32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32
+               " %4" PRIu32 ".%" PRIu32 " %+8" PRId32 " %+8" PRId32 " %+8" PRId32 "\n",
+               traffic_trace_profile_names[i], awake_est_mode_name(run->mode), run->tgen.sent,
+               run->tgen.sent - run->tgen.received, kbps, run->tgen.rtt_p50_us, run->tgen.rtt_p95_us,
+               run->awake.awake_ms, permille / 10u, permille % 10u, kbps - base_kbps,
+               (int32_t)(run->tgen.rtt_p50_us - base->tgen.rtt_p50_us),
+               (int32_t)(run->awake.awake_ms - base->awake.awake_ms));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_status
+********************************************************************************
+* Summary:
+* This function prints the state of the trace held on the target.
+*
+*******************************************************************************/
+static void traffic_trace_status(void)
+{
+    traffic_trace_header_t header;
+    uint64_t tx_bytes = 0;
+    uint64_t rx_bytes = 0;
+
+    traffic_trace_header(&header);
+    for(uint32_t i = 0; i < traffic_trace_count; i++)
+    {
+        if((traffic_trace_events[i].flow & TRAFFIC_TRACE_FLAG_RX) != 0u)
+        {
+            rx_bytes += traffic_trace_events[i].size;
+        }
+        else
+        {
+            tx_bytes += traffic_trace_events[i].size;
+        }
+    }
+
+    printf("%s, %" PRIu32 "/%u events (%" PRIu32 " dropped), %" PRIu32 " flows, %" PRIu32 " ms\n",
+           traffic_trace_recording ? "recording" : "stopped", header.events, (unsigned)TRAFFIC_TRACE_EVENTS,
+           traffic_trace_dropped, header.flows, header.duration_ms);
+    printf("sent %" PRIu64 " bytes, received %" PRIu64 " bytes\n", tx_bytes, rx_bytes);
+#if !defined(APP_TRAFFIC_TRACE)
+    printf("Recording requires TRAFFIC_TRACE=1 in the Makefile\n");
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_command
+********************************************************************************
+* Summary:
+* This function controls the recording and the transfer of the trace, replays
+* it with a chosen iTWT profile and compares the replays.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int traffic_trace_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if(argc < 2)
+    {
+        printf("Usage: ttrace <start|stop|clear|status|dump|send <host> [port]|load <host> [port]|replay <host> <current|none|idle|active> [port]|compare>\n");
+        return -1;
+    }
+
+    if(!strcmp(argv[1], "status"))
+    {
+        traffic_trace_status();
+        return 0;
+    }
+    if(!strcmp(argv[1], "compare"))
+    {
+        traffic_trace_compare();
+        return 0;
+    }
+    if(!strcmp(argv[1], "stop"))
+    {
+        traffic_trace_recording = false;
+        traffic_trace_status();
+        return 0;
+    }
+
+    if(traffic_trace_recording)
+    {
+        printf("Stop the recording first\n");
+        return -1;
+    }
+
+    if(!strcmp(argv[1], "start") || !strcmp(argv[1], "clear"))
+    {
+        uint32_t state = cyhal_system_critical_section_enter();
+
+        traffic_trace_count = 0;
+        traffic_trace_dropped = 0;
+        traffic_trace_flows = 0;
+        memset(traffic_trace_sockets, 0, sizeof(traffic_trace_sockets));
+        cyhal_system_critical_section_exit(state);
+
+        if(!strcmp(argv[1], "start"))
+        {
+            cycle_counter_init();
+            cy_rtos_get_time(&traffic_trace_last_ms);
+            traffic_trace_last_cycles = cycle_counter_get();
+            traffic_trace_recording = true;
+        }
+        return 0;
+    }
+
+    if(!strcmp(argv[1], "dump"))
+    {
+        traffic_trace_dump();
+        return 0;
+    }
+
+    if(!strcmp(argv[1], "send") && (argc > 2))
+    {
+        result = traffic_trace_send(argv[2], (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) :
+                                                          (uint16_t)TRAFFIC_TRACE_DEFAULT_PORT);
+    }
+    else if(!strcmp(argv[1], "load") && (argc > 2))
+    {
+        result = traffic_trace_load(argv[2], (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) :
+                                                          (uint16_t)TRAFFIC_TRACE_DEFAULT_PORT);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            traffic_trace_status();
+        }
+    }
+    else if(!strcmp(argv[1], "replay") && (argc > 3))
+    {
+        if(traffic_trace_count == 0u)
+        {
+            printf("No trace to replay\n");
+            return -1;
+        }
+        return traffic_trace_replay(argv[2], argv[3], (argc > 4) ? (uint16_t)strtoul(argv[4], NULL, 0) :
+                                                                   (uint16_t)TGEN_DEFAULT_PORT);
+    }
+    else
+    {
+        printf("Unknown or incomplete command '%s'\n", argv[1]);
+        return -1;
+    }
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed: 0x%08" PRIx32 "\n", (uint32_t)result);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: traffic_trace_add_commands
+********************************************************************************
+* Summary:
+* This function registers the traffic trace commands.
+*
+*******************************************************************************/
+cy_rslt_t traffic_trace_add_commands(void)
+{
+    return cy_command_console_add_table(traffic_trace_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
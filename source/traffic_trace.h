@@ -0,0 +1,121 @@
+/******************************************************************************
+* File Name:   traffic_trace.h
+*
+* Description: This file contains the declarations for recording the
+*              application send/receive events into a binary traffic trace
+*              and replaying a trace through the traffic generator.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TRAFFIC_TRACE_H_
+#define TRAFFIC_TRACE_H_
+
+#include "tgen.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Events held on the target, recorded or loaded */
+#define TRAFFIC_TRACE_EVENTS            (512u)
+
+/* Sockets told apart; later ones share the last flow */
+#define TRAFFIC_TRACE_MAX_FLOWS         (16u)
+
+/* Set in the flow byte of events for data received by the application */
+#define TRAFFIC_TRACE_FLAG_RX           (0x80u)
+
+/* Binary trace: a header followed by the events, all little-endian */
+#define TRAFFIC_TRACE_VERSION           (1u)
+#define TRAFFIC_TRACE_HEADER_LEN        (16u)
+#define TRAFFIC_TRACE_EVENT_LEN         (8u)
+
+#define TRAFFIC_TRACE_DEFAULT_PORT      (19001u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t delta_us;  /* Since the previous event */
+    uint16_t size;      /* Bytes, saturated at 65535 */
+    uint8_t  flow;      /* Flow index, with TRAFFIC_TRACE_FLAG_RX for received data */
+    uint8_t  reserved;
+} traffic_trace_event_t;
+
+typedef struct
+{
+    uint32_t events;
+    uint32_t flows;
+    uint32_t duration_ms;
+} traffic_trace_header_t;
+
+/* Replay state; the packet source for tgen_run_source() */
+typedef struct
+{
+    const traffic_trace_event_t *events;
+    uint32_t                     count;
+    uint32_t                     index;
+    uint64_t                     time_us;
+    uint32_t                     remaining;  /* Bytes of the current event left to send */
+    bool                         rx;
+    uint32_t                     flow;
+} traffic_trace_replay_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void traffic_trace_encode_header(uint8_t *out, const traffic_trace_header_t *header);
+bool traffic_trace_decode_header(const uint8_t *in, traffic_trace_header_t *header);
+void traffic_trace_encode_event(uint8_t *out, const traffic_trace_event_t *event);
+void traffic_trace_decode_event(const uint8_t *in, traffic_trace_event_t *event);
+
+void traffic_trace_replay_init(traffic_trace_replay_t *replay, const traffic_trace_event_t *events, uint32_t count);
+bool traffic_trace_replay_next(void *arg, tgen_packet_t *packet);
+
+#if !defined(__linux__)
+cy_rslt_t traffic_trace_add_commands(void);
+#endif
+
+#endif /* TRAFFIC_TRACE_H_ */
+
+/* [] END OF FILE */
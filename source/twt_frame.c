@@ -0,0 +1,427 @@
+/******************************************************************************
+* File Name:   twt_frame.c
+*
+* Description: This file implements the decoder of the 802.11ax TWT Setup,
+*              TWT Teardown and TWT Information action frames. It has no
+*              platform dependencies, so that it can be built and checked
+*              against frame vectors in a host build.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "twt_frame.h"
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TWT_FRAME_WD_UNIT_US            (256u)
+#define TWT_FRAME_TU_US                 (1024u)
+
+/* TWT element Control field */
+#define TWT_CONTROL_NDP_PAGING          (0x01u)
+#define TWT_CONTROL_NEGOTIATION_SHIFT   (2u)
+#define TWT_CONTROL_NEGOTIATION_MASK    (0x03u)
+#define TWT_CONTROL_WD_UNIT             (0x20u)
+
+/* Request Type field */
+#define TWT_REQTYPE_REQUEST             (0x0001u)
+#define TWT_REQTYPE_COMMAND_SHIFT       (1u)
+#define TWT_REQTYPE_COMMAND_MASK        (0x07u)
+#define TWT_REQTYPE_TRIGGER             (0x0010u)
+#define TWT_REQTYPE_IMPLICIT            (0x0020u)
+#define TWT_REQTYPE_FLOW_TYPE           (0x0040u)
+#define TWT_REQTYPE_FLOW_ID_SHIFT       (7u)
+#define TWT_REQTYPE_FLOW_ID_MASK        (0x07u)
+#define TWT_REQTYPE_EXPONENT_SHIFT      (10u)
+#define TWT_REQTYPE_EXPONENT_MASK       (0x1Fu)
+
+/* Individual TWT Parameter Set without the optional fields: Request Type,
+ * Nominal Minimum TWT Wake Duration, Wake Interval Mantissa, TWT Channel */
+#define TWT_INDIVIDUAL_BASE_LEN         (6u)
+#define TWT_TARGET_WAKE_TIME_LEN        (8u)
+#define TWT_NDP_PAGING_LEN              (4u)
+
+/* Broadcast TWT Parameter Set: Request Type, Target Wake Time (2 octets),
+ * Nominal Minimum TWT Wake Duration, Wake Interval Mantissa, Broadcast TWT Info */
+#define TWT_BROADCAST_LEN               (9u)
+
+/* TWT Flow field of the TWT Teardown frame */
+#define TWT_TEARDOWN_FLOW_ID_MASK       (0x07u)
+#define TWT_TEARDOWN_BCAST_ID_MASK      (0x1Fu)
+#define TWT_TEARDOWN_NEGOTIATION_SHIFT  (5u)
+#define TWT_TEARDOWN_ALL                (0x80u)
+
+/* TWT Information field */
+#define TWT_INFO_FLOW_ID_MASK           (0x07u)
+#define TWT_INFO_NEXT_SIZE_SHIFT        (5u)
+#define TWT_INFO_NEXT_SIZE_MASK         (0x03u)
+#define TWT_INFO_ALL                    (0x80u)
+
+/* Data of the action frame event: wl_event_rx_frame_data_t (version,
+ * channel, RSSI, MAC time, rate) followed by the received 802.11 frame */
+#define TWT_EVENT_RX_FRAME_DATA_LEN     (16u)
+#define TWT_EVENT_DOT11_HEADER_LEN      (24u)
+
+/* First octet of the Frame Control field of Action and Action No Ack frames */
+#define TWT_EVENT_FC_ACTION             (0xD0u)
+#define TWT_EVENT_FC_ACTION_NO_ACK      (0xE0u)
+
+
+/*******************************************************************************
+* Function Name: twt_frame_get_le
+********************************************************************************
+* Summary:
+* Reads a little-endian field of 'bytes' octets.
+*
+*******************************************************************************/
+static uint64_t twt_frame_get_le(const uint8_t *p, uint32_t bytes)
+{
+    uint64_t value = 0;
+
+    while(bytes-- != 0u)
+    {
+        value = (value << 8) | p[bytes];
+    }
+
+    return value;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_frame_decode_element
+********************************************************************************
+* Summary:
+* Decodes the TWT element of a TWT Setup frame. Only the first parameter set
+* of a broadcast TWT element is decoded.
+*
+*******************************************************************************/
+static twt_frame_status_t twt_frame_decode_element(const uint8_t *element, size_t length, twt_frame_t *frame)
+{
+    const uint8_t *p;
+    size_t element_length;
+    size_t optional;
+    uint16_t request_type;
+    uint8_t control;
+
+    if(length < 3u)
+    {
+        return TWT_FRAME_TRUNCATED;
+    }
+    if(element[0] != TWT_FRAME_ELEMENT_ID)
+    {
+        return TWT_FRAME_MALFORMED;
+    }
+
+    element_length = element[1];
+    if(length < 2u + element_length)
+    {
+        return TWT_FRAME_TRUNCATED;
+    }
+    if(element_length < 1u + 2u)
+    {
+        return TWT_FRAME_MALFORMED;
+    }
+
+    control = element[2];
+    p = &element[3];
+    element_length -= 1u;
+
+    frame->negotiation_type = (control >> TWT_CONTROL_NEGOTIATION_SHIFT) & TWT_CONTROL_NEGOTIATION_MASK;
+    if((control & TWT_CONTROL_WD_UNIT) != 0u)
+    {
+        frame->flags |= TWT_FRAME_FLAG_WD_UNIT_TU;
+    }
+
+    request_type = (uint16_t)twt_frame_get_le(p, 2);
+    frame->setup_command = (request_type >> TWT_REQTYPE_COMMAND_SHIFT) & TWT_REQTYPE_COMMAND_MASK;
+    frame->wi_exponent   = (request_type >> TWT_REQTYPE_EXPONENT_SHIFT) & TWT_REQTYPE_EXPONENT_MASK;
+    frame->flags |= ((request_type & TWT_REQTYPE_REQUEST) ? TWT_FRAME_FLAG_REQUEST : 0u) |
+                    ((request_type & TWT_REQTYPE_TRIGGER) ? TWT_FRAME_FLAG_TRIGGER : 0u) |
+                    ((request_type & TWT_REQTYPE_IMPLICIT) ? TWT_FRAME_FLAG_IMPLICIT : 0u) |
+                    ((request_type & TWT_REQTYPE_FLOW_TYPE) ? TWT_FRAME_FLAG_UNANNOUNCED : 0u);
+
+    if(frame->negotiation_type >= 2u)
+    {
+        /* Broadcast TWT: the flow is identified by the broadcast TWT ID */
+        if(element_length < TWT_BROADCAST_LEN)
+        {
+            return TWT_FRAME_MALFORMED;
+        }
+        frame->flags           |= TWT_FRAME_FLAG_BROADCAST;
+        frame->target_wake_time = twt_frame_get_le(&p[2], 2);
+        frame->wake_duration    = p[4];
+        frame->wi_mantissa      = (uint16_t)twt_frame_get_le(&p[5], 2);
+        frame->flow_id          = (uint8_t)((twt_frame_get_le(&p[7], 2) >> 3) & 0x1Fu);
+        return TWT_FRAME_OK;
+    }
+
+    /* Individual TWT: the Target Wake Time and 802.11ah TWT Group Assignment
+     * fields are optional, their presence is told by the element length */
+    frame->flow_id = (request_type >> TWT_REQTYPE_FLOW_ID_SHIFT) & TWT_REQTYPE_FLOW_ID_MASK;
+
+    optional = TWT_INDIVIDUAL_BASE_LEN + (((control & TWT_CONTROL_NDP_PAGING) != 0u) ? TWT_NDP_PAGING_LEN : 0u);
+    if(element_length < optional)
+    {
+        return TWT_FRAME_MALFORMED;
+    }
+    optional = element_length - optional;
+    if((optional != 0u) && (optional != TWT_TARGET_WAKE_TIME_LEN) &&
+       (optional != TWT_TARGET_WAKE_TIME_LEN + 3u) && (optional != TWT_TARGET_WAKE_TIME_LEN + 9u))
+    {
+        return TWT_FRAME_MALFORMED;
+    }
+
+    p += 2;
+    if(optional != 0u)
+    {
+        frame->target_wake_time = twt_frame_get_le(p, TWT_TARGET_WAKE_TIME_LEN);
+        p += optional;
+    }
+    frame->wake_duration = p[0];
+    frame->wi_mantissa   = (uint16_t)twt_frame_get_le(&p[1], 2);
+
+    return TWT_FRAME_OK;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_frame_decode
+********************************************************************************
+* Summary:
+* This function decodes a TWT Setup, TWT Teardown or TWT Information frame.
+*
+* Parameters:
+*  const uint8_t *body : frame body, starting with the Category field
+*  size_t length       : body length
+*  twt_frame_t *frame  : decoded fields
+*
+* Return:
+*  twt_frame_status_t : TWT_FRAME_OK, or why the frame was not decoded
+*
+*******************************************************************************/
+twt_frame_status_t twt_frame_decode(const uint8_t *body, size_t length, twt_frame_t *frame)
+{
+    uint8_t field;
+
+    if(length < 2u)
+    {
+        return TWT_FRAME_NOT_TWT;
+    }
+    if((body[0] != TWT_FRAME_CATEGORY_UNPROTECTED_S1G) && (body[0] != TWT_FRAME_CATEGORY_S1G))
+    {
+        return TWT_FRAME_NOT_TWT;
+    }
+
+    *frame = (twt_frame_t){ 0 };
+
+    switch(body[1])
+    {
+        case TWT_FRAME_ACTION_SETUP:
+            if(length < 3u)
+            {
+                return TWT_FRAME_TRUNCATED;
+            }
+            frame->kind = TWT_FRAME_SETUP;
+            frame->dialog_token = body[2];
+            return twt_frame_decode_element(&body[3], length - 3u, frame);
+
+        case TWT_FRAME_ACTION_TEARDOWN:
+            if(length < 3u)
+            {
+                return TWT_FRAME_TRUNCATED;
+            }
+            field = body[2];
+            frame->kind = TWT_FRAME_TEARDOWN;
+            frame->negotiation_type = (field >> TWT_TEARDOWN_NEGOTIATION_SHIFT) & 0x03u;
+            if(frame->negotiation_type >= 2u)
+            {
+                frame->flags |= TWT_FRAME_FLAG_BROADCAST;
+                frame->flow_id = field & TWT_TEARDOWN_BCAST_ID_MASK;
+            }
+            else
+            {
+                frame->flow_id = field & TWT_TEARDOWN_FLOW_ID_MASK;
+            }
+            if((field & TWT_TEARDOWN_ALL) != 0u)
+            {
+                frame->flags |= TWT_FRAME_FLAG_ALL_TWT;
+            }
+            return TWT_FRAME_OK;
+
+        case TWT_FRAME_ACTION_INFORMATION:
+        {
+            static const uint8_t next_twt_bytes[] = { 0u, 4u, 6u, 8u };
+
+            if(length < 3u)
+            {
+                return TWT_FRAME_TRUNCATED;
+            }
+            field = body[2];
+            frame->kind = TWT_FRAME_INFORMATION;
+            frame->flow_id = field & TWT_INFO_FLOW_ID_MASK;
+            frame->next_twt_bits = (uint8_t)(8u * next_twt_bytes[(field >> TWT_INFO_NEXT_SIZE_SHIFT) & TWT_INFO_NEXT_SIZE_MASK]);
+            if((field & TWT_INFO_ALL) != 0u)
+            {
+                frame->flags |= TWT_FRAME_FLAG_ALL_TWT;
+            }
+            if(length < 3u + frame->next_twt_bits / 8u)
+            {
+                return TWT_FRAME_TRUNCATED;
+            }
+            frame->target_wake_time = twt_frame_get_le(&body[3], frame->next_twt_bits / 8u);
+            return TWT_FRAME_OK;
+        }
+
+        default:
+            return TWT_FRAME_NOT_TWT;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: twt_frame_decode_event
+********************************************************************************
+* Summary:
+* This function decodes the TWT frame carried by a WHD event. The layout of
+* the event data depends on the event:
+*  - TWT_FRAME_EVENT_ACTION_FRAME: wl_event_rx_frame_data_t, then the
+*    received Action frame, 802.11 management header included
+*  - TWT_FRAME_EVENT_SETUP/TEARDOWN/INFORMATION: the body of the frame the
+*    firmware sent or received, starting with the Category field. The frame
+*    must be of the kind the event reports.
+*
+* Parameters:
+*  uint32_t event_type : WHD event type
+*  const uint8_t *data : event data
+*  size_t length       : event data length
+*  twt_frame_t *frame  : decoded fields
+*
+* Return:
+*  twt_frame_status_t : TWT_FRAME_OK, or why the frame was not decoded
+*
+*******************************************************************************/
+twt_frame_status_t twt_frame_decode_event(uint32_t event_type, const uint8_t *data, size_t length,
+                                          twt_frame_t *frame)
+{
+    static const twt_frame_kind_t kinds[] = { TWT_FRAME_SETUP, TWT_FRAME_TEARDOWN, TWT_FRAME_INFORMATION };
+    twt_frame_status_t status;
+    uint8_t fc;
+
+    switch(event_type)
+    {
+        case TWT_FRAME_EVENT_ACTION_FRAME:
+            if(length < TWT_EVENT_RX_FRAME_DATA_LEN + TWT_EVENT_DOT11_HEADER_LEN)
+            {
+                return TWT_FRAME_TRUNCATED;
+            }
+            fc = data[TWT_EVENT_RX_FRAME_DATA_LEN];
+            if((fc != TWT_EVENT_FC_ACTION) && (fc != TWT_EVENT_FC_ACTION_NO_ACK))
+            {
+                return TWT_FRAME_NOT_TWT;
+            }
+            return twt_frame_decode(&data[TWT_EVENT_RX_FRAME_DATA_LEN + TWT_EVENT_DOT11_HEADER_LEN],
+                                    length - TWT_EVENT_RX_FRAME_DATA_LEN - TWT_EVENT_DOT11_HEADER_LEN, frame);
+
+        case TWT_FRAME_EVENT_SETUP:
+        case TWT_FRAME_EVENT_TEARDOWN:
+        case TWT_FRAME_EVENT_INFORMATION:
+            if(length < 2u)
+            {
+                return TWT_FRAME_TRUNCATED;
+            }
+            status = twt_frame_decode(data, length, frame);
+            if((status == TWT_FRAME_OK) && (frame->kind != kinds[event_type - TWT_FRAME_EVENT_SETUP]))
+            {
+                return TWT_FRAME_MALFORMED;
+            }
+            return status;
+
+        default:
+            return TWT_FRAME_NOT_TWT;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: twt_frame_wake_interval_us
+********************************************************************************
+* Summary:
+* This function returns the wake interval of a decoded TWT Setup frame,
+* mantissa * 2^exponent microseconds.
+*
+*******************************************************************************/
+uint64_t twt_frame_wake_interval_us(const twt_frame_t *frame)
+{
+    return (frame->wi_exponent < 48u) ? ((uint64_t)frame->wi_mantissa << frame->wi_exponent) : 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_frame_wake_duration_us
+********************************************************************************
+* Summary:
+* This function returns the nominal minimum wake duration of a decoded TWT
+* Setup frame in microseconds.
+*
+*******************************************************************************/
+uint32_t twt_frame_wake_duration_us(const twt_frame_t *frame)
+{
+    return (uint32_t)frame->wake_duration *
+           (((frame->flags & TWT_FRAME_FLAG_WD_UNIT_TU) != 0u) ? TWT_FRAME_TU_US : TWT_FRAME_WD_UNIT_US);
+}
+
+
+/*******************************************************************************
+* Function Name: twt_frame_command_name
+********************************************************************************
+* Summary:
+* This function returns the name of a TWT Setup Command value.
+*
+*******************************************************************************/
+const char* twt_frame_command_name(uint8_t setup_command)
+{
+    static const char *names[] =
+    {
+        "request", "suggest", "demand", "grouping", "accept", "alternate", "dictate", "reject"
+    };
+
+    return (setup_command < (sizeof(names) / sizeof(names[0]))) ? names[setup_command] : "?";
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,138 @@
+/******************************************************************************
+* File Name:   twt_frame.h
+*
+* Description: This file contains the declarations for the decoder of the
+*              802.11ax TWT Setup, TWT Teardown and TWT Information action
+*              frames.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TWT_FRAME_H_
+#define TWT_FRAME_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Action frame categories and S1G action codes (IEEE 802.11-2020 9.4.1.11, 9.6.24.1) */
+#define TWT_FRAME_CATEGORY_UNPROTECTED_S1G  (22u)
+#define TWT_FRAME_CATEGORY_S1G              (23u)
+#define TWT_FRAME_ACTION_SETUP              (6u)
+#define TWT_FRAME_ACTION_TEARDOWN           (7u)
+#define TWT_FRAME_ACTION_INFORMATION        (11u)
+
+#define TWT_FRAME_ELEMENT_ID                (216u)
+
+/* TWT Setup Command values */
+#define TWT_FRAME_CMD_REQUEST               (0u)
+#define TWT_FRAME_CMD_SUGGEST               (1u)
+#define TWT_FRAME_CMD_DEMAND                (2u)
+#define TWT_FRAME_CMD_GROUPING              (3u)
+#define TWT_FRAME_CMD_ACCEPT                (4u)
+#define TWT_FRAME_CMD_ALTERNATE             (5u)
+#define TWT_FRAME_CMD_DICTATE               (6u)
+#define TWT_FRAME_CMD_REJECT                (7u)
+
+/* Flags of twt_frame_t */
+#define TWT_FRAME_FLAG_REQUEST              (0x01u)     /* Sent by the TWT requesting STA */
+#define TWT_FRAME_FLAG_TRIGGER              (0x02u)
+#define TWT_FRAME_FLAG_IMPLICIT             (0x04u)
+#define TWT_FRAME_FLAG_UNANNOUNCED          (0x08u)
+#define TWT_FRAME_FLAG_WD_UNIT_TU           (0x10u)     /* Wake duration in TUs instead of 256 us */
+#define TWT_FRAME_FLAG_ALL_TWT              (0x20u)     /* Teardown or information for all flows */
+#define TWT_FRAME_FLAG_BROADCAST            (0x40u)
+
+/* WHD events carrying TWT frames (See twt_frame_decode_event()). The action
+ * frame event is not defined by every WHD release, the TWT events are those
+ * of the 11ax firmware. */
+#define TWT_FRAME_EVENT_ACTION_FRAME        (59u)
+#define TWT_FRAME_EVENT_SETUP               (157u)
+#define TWT_FRAME_EVENT_TEARDOWN            (158u)
+#define TWT_FRAME_EVENT_INFORMATION         (159u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    TWT_FRAME_OK = 0,
+    TWT_FRAME_NOT_TWT,              /* Not a TWT action frame */
+    TWT_FRAME_TRUNCATED,
+    TWT_FRAME_MALFORMED
+} twt_frame_status_t;
+
+typedef enum
+{
+    TWT_FRAME_SETUP = 0,
+    TWT_FRAME_TEARDOWN,
+    TWT_FRAME_INFORMATION
+} twt_frame_kind_t;
+
+typedef struct
+{
+    twt_frame_kind_t kind;
+    uint8_t          dialog_token;      /* Setup */
+    uint8_t          negotiation_type;  /* 0/1: individual, 2/3: broadcast */
+    uint8_t          setup_command;     /* Setup, TWT_FRAME_CMD_* */
+    uint8_t          flow_id;           /* Flow identifier, or broadcast TWT ID */
+    uint8_t          flags;             /* TWT_FRAME_FLAG_* */
+    uint8_t          wi_exponent;       /* Setup */
+    uint16_t         wi_mantissa;       /* Setup */
+    uint8_t          wake_duration;     /* Setup, nominal minimum, in units of the WD unit */
+    uint8_t          next_twt_bits;     /* Information: size of next_twt, 0/32/48/64 */
+    uint64_t         target_wake_time;  /* Setup: TWT in us (TSF); Information: next TWT */
+} twt_frame_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+twt_frame_status_t twt_frame_decode(const uint8_t *body, size_t length, twt_frame_t *frame);
+twt_frame_status_t twt_frame_decode_event(uint32_t event_type, const uint8_t *data, size_t length,
+                                          twt_frame_t *frame);
+uint64_t twt_frame_wake_interval_us(const twt_frame_t *frame);
+uint32_t twt_frame_wake_duration_us(const twt_frame_t *frame);
+const char* twt_frame_command_name(uint8_t setup_command);
+
+#endif /* TWT_FRAME_H_ */
+
+/* [] END OF FILE */
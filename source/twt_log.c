@@ -0,0 +1,405 @@
+/******************************************************************************
+* File Name:   twt_log.c
+*
+* Description: This file implements the log of TWT Setup, Teardown and
+*              Information frames. The frames are taken from the WHD events
+*              that carry them, decoded by twt_frame.c and kept in a small
+*              ring, so that the negotiation (request, suggest, accept,
+*              reject, ...) can be followed from the console.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "command_console.h"
+#include "bench.h"
+#include "twt_frame.h"
+#include "twt_log.h"
+#include "twt_session.h"
+#include "warm_boot.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#if ((TWT_LOG_ENTRIES & (TWT_LOG_ENTRIES - 1u)) != 0u)
+#error "TWT_LOG_ENTRIES must be a power of two"
+#endif
+
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t    time_ms;
+    uint8_t     direction;          /* twt_log_direction_t */
+    twt_frame_t frame;
+} twt_log_entry_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int twt_log_command(int argc, char* argv[], tlv_buffer_t** data);
+static void* twt_log_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                                   const uint8_t *event_data, void *handler_user_data);
+static void twt_log_bench_decode(void *arg);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static twt_log_entry_t twt_log_ring[TWT_LOG_ENTRIES];
+static uint32_t twt_log_head;           /* Number of frames ever logged */
+static uint32_t twt_log_undecoded;
+static uint16_t twt_log_event_index;
+
+static const uint32_t twt_log_events[] =
+{
+    TWT_FRAME_EVENT_ACTION_FRAME, TWT_FRAME_EVENT_SETUP, TWT_FRAME_EVENT_TEARDOWN, TWT_FRAME_EVENT_INFORMATION,
+    WLC_E_NONE
+};
+
+/* TWT Setup Accept for the active profile (WI 7 * 2^13 us, WD 32 * 256 us) */
+static const uint8_t twt_log_bench_frame[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01,
+    TWT_FRAME_ELEMENT_ID, 15, 0x00, 0x78, 0x34,
+    0x78, 0x56, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x07, 0x00, 0x00
+};
+
+static volatile uint32_t twt_log_bench_sink;
+
+#define TWT_LOG_COMMANDS \
+    { (char *) "twt_log", twt_log_command, 0, NULL, NULL, (char *) "[clear]", (char *) "Show the last decoded TWT Setup/Teardown/Information frames" }, \
+
+const cy_command_console_cmd_t twt_log_commands_table[] =
+{
+    TWT_LOG_COMMANDS
+    CMD_TABLE_END
+};
+
+static const bench_case_t twt_log_bench_table[] =
+{
+    BENCH_CASE("twt_frame_decode", NULL, twt_log_bench_decode, NULL, NULL)
+    BENCH_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: twt_log_add
+********************************************************************************
+* Summary:
+* This function adds a decoded frame to the log. When the ring is full the
+* oldest frames are overwritten. The frame is then passed to twt_session,
+* which tracks the agreement the AP accepted.
+*
+*******************************************************************************/
+static void twt_log_add(twt_log_direction_t direction, const twt_frame_t *frame)
+{
+    twt_log_entry_t *entry;
+    uint32_t state;
+    cy_time_t now;
+    bool was_active;
+
+    /* The TWT requesting STA is this STA */
+    if((direction == TWT_LOG_UNKNOWN) && (frame->kind == TWT_FRAME_SETUP))
+    {
+        direction = ((frame->flags & TWT_FRAME_FLAG_REQUEST) != 0u) ? TWT_LOG_TX : TWT_LOG_RX;
+    }
+
+    cy_rtos_get_time(&now);
+
+    state = cyhal_system_critical_section_enter();
+    entry = &twt_log_ring[twt_log_head & (TWT_LOG_ENTRIES - 1u)];
+    entry->time_ms   = (uint32_t)now;
+    entry->direction = (uint8_t)direction;
+    entry->frame     = *frame;
+    twt_log_head++;
+    cyhal_system_critical_section_exit(state);
+
+    was_active = twt_session_is_active();
+    twt_session_frame(frame, direction == TWT_LOG_RX);
+    if(twt_session_is_active() != was_active)
+    {
+        warm_boot_save_twt();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_frame
+********************************************************************************
+* Summary:
+* This function decodes a TWT frame and adds it to the log.
+*
+* Parameters:
+*  twt_log_direction_t direction : direction, if known
+*  const uint8_t *body           : frame body, starting with the Category field
+*  size_t length                 : body length
+*
+* Return:
+*  bool : true if the frame was a TWT frame and was logged
+*
+*******************************************************************************/
+bool twt_log_frame(twt_log_direction_t direction, const uint8_t *body, size_t length)
+{
+    twt_frame_t frame;
+
+    if(twt_frame_decode(body, length, &frame) != TWT_FRAME_OK)
+    {
+        return false;
+    }
+
+    twt_log_add(direction, &frame);
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_event_handler
+********************************************************************************
+* Summary:
+* WHD event handler logging the TWT frame carried by the event, as laid out
+* for its event type (See twt_frame_decode_event()). Action frame events
+* other than TWT ones are ignored; TWT events without a decodable frame are
+* counted.
+*
+*******************************************************************************/
+static void* twt_log_event_handler(whd_interface_t ifp, const whd_event_header_t *event_header,
+                                   const uint8_t *event_data, void *handler_user_data)
+{
+    twt_log_direction_t direction = (event_header->event_type == TWT_FRAME_EVENT_ACTION_FRAME) ? TWT_LOG_RX : TWT_LOG_UNKNOWN;
+    twt_frame_status_t status = TWT_FRAME_TRUNCATED;
+    twt_frame_t frame;
+
+    if(event_data != NULL)
+    {
+        status = twt_frame_decode_event(event_header->event_type, event_data, event_header->datalen, &frame);
+    }
+
+    if(status == TWT_FRAME_OK)
+    {
+        twt_log_add(direction, &frame);
+    }
+    else if(event_header->event_type != TWT_FRAME_EVENT_ACTION_FRAME)
+    {
+        twt_log_undecoded++;
+    }
+
+    return handler_user_data;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_init
+********************************************************************************
+* Summary:
+* This function registers the WHD event handler. Call it before the first
+* join so that the frames of the initial negotiation are logged.
+*
+* Parameters:
+*  whd_interface_t ifp : STA interface
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t twt_log_init(whd_interface_t ifp)
+{
+    whd_result_t result = whd_wifi_set_event_handler(ifp, twt_log_events, twt_log_event_handler, NULL,
+                                                     &twt_log_event_index);
+
+    return (result == WHD_SUCCESS) ? CY_RSLT_SUCCESS : (cy_rslt_t)result;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_print_entry
+********************************************************************************
+* Summary:
+* This function prints one logged frame.
+*
+*******************************************************************************/
+static void twt_log_print_entry(const twt_log_entry_t *entry)
+{
+    static const char *kinds[] = { "setup", "teardown", "info" };
+    static const char *directions[] = { "rx", "tx", "?" };
+    const twt_frame_t *frame = &entry->frame;
+    uint64_t wi_us = twt_frame_wake_interval_us(frame);
+    char flags[8];
+    uint32_t n = 0;
+
+    if(frame->flags & TWT_FRAME_FLAG_REQUEST)     { flags[n++] = 'R'; }
+    if(frame->flags & TWT_FRAME_FLAG_TRIGGER)     { flags[n++] = 'T'; }
+    if(frame->flags & TWT_FRAME_FLAG_IMPLICIT)    { flags[n++] = 'I'; }
+    if(frame->flags & TWT_FRAME_FLAG_UNANNOUNCED) { flags[n++] = 'U'; }
+    if(frame->flags & TWT_FRAME_FLAG_BROADCAST)   { flags[n++] = 'B'; }
+    if(frame->flags & TWT_FRAME_FLAG_ALL_TWT)     { flags[n++] = 'A'; }
+    flags[n] = '\0';
+
+    printf("%10" PRIu32 " %-3s %-8s %-9s %4u %3u ", entry->time_ms, directions[entry->direction],
+           kinds[frame->kind], (frame->kind == TWT_FRAME_SETUP) ? twt_frame_command_name(frame->setup_command) : "-",
+           frame->flow_id, frame->negotiation_type);
+
+    if(frame->kind == TWT_FRAME_SETUP)
+    {
+        printf("%5u %3u %10" PRIu32 " %3u %8" PRIu32 " ", frame->wi_mantissa, frame->wi_exponent,
+               (wi_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)wi_us, frame->wake_duration,
+               twt_frame_wake_duration_us(frame));
+    }
+    else
+    {
+        printf("%5s %3s %10s %3s %8s ", "-", "-", "-", "-", "-");
+    }
+
+    if((frame->kind == TWT_FRAME_SETUP) || (frame->next_twt_bits != 0u))
+    {
+        printf("%08" PRIx32 "%08" PRIx32 " ", (uint32_t)(frame->target_wake_time >> 32),
+               (uint32_t)frame->target_wake_time);
+    }
+    else
+    {
+        printf("%16s ", "-");
+    }
+
+    printf("%s\n", flags);
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_command
+********************************************************************************
+* Summary:
+* This function prints the logged frames, oldest first, or clears the log.
+* Flags: R TWT request (sent by the requester), T trigger-enabled, I implicit,
+* U unannounced, B broadcast TWT, A all TWT flows.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int twt_log_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    twt_log_entry_t entries[TWT_LOG_ENTRIES];
+    uint32_t head;
+    uint32_t count;
+    uint32_t state;
+
+    if((argc > 1) && !strcmp(argv[1], "clear"))
+    {
+        state = cyhal_system_critical_section_enter();
+        twt_log_head = 0;
+        twt_log_undecoded = 0;
+        cyhal_system_critical_section_exit(state);
+        return 0;
+    }
+
+    state = cyhal_system_critical_section_enter();
+    head = twt_log_head;
+    memcpy(entries, twt_log_ring, sizeof(entries));
+    cyhal_system_critical_section_exit(state);
+
+    count = (head > TWT_LOG_ENTRIES) ? TWT_LOG_ENTRIES : head;
+
+    printf("%10s %-3s %-8s %-9s %4s %3s %5s %3s %10s %3s %8s %16s %s\n", "time (ms)", "dir", "frame", "command",
+           "flow", "neg", "WI m", "exp", "WI (us)", "WD", "WD (us)", "TWT / next TWT", "flags");
+
+    for(uint32_t i = head - count; i != head; i++)
+    {
+        twt_log_print_entry(&entries[i & (TWT_LOG_ENTRIES - 1u)]);
+    }
+
+    printf("%" PRIu32 " frames logged, %" PRIu32 " overwritten, %" PRIu32 " TWT events without a decodable frame\n",
+           head, head - count, twt_log_undecoded);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_bench_decode
+********************************************************************************
+* Summary:
+* Benchmark of the cost of decoding a TWT Setup frame.
+*
+*******************************************************************************/
+static void twt_log_bench_decode(void *arg)
+{
+    twt_frame_t frame;
+
+    twt_frame_decode(twt_log_bench_frame, sizeof(twt_log_bench_frame), &frame);
+    twt_log_bench_sink = frame.wi_mantissa;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_log_add_commands
+********************************************************************************
+* Summary:
+* This function registers the twt_log commands table and benchmark.
+*
+*******************************************************************************/
+cy_rslt_t twt_log_add_commands(void)
+{
+    cy_rslt_t result = bench_add_table(twt_log_bench_table);
+
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    return cy_command_console_add_table(twt_log_commands_table);
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,735 @@
+/******************************************************************************
+* File Name:   twt_session.c
+*
+* Description: This file keeps track of the iTWT agreement currently in effect
+*              so that other modules can derive timing from WI and WD. It also
+*              predicts the SP boundaries from the time the agreement was
+*              established and notifies listeners at SP start and end.
+*
+*              The agreement tracking also builds on Linux, where
+*              tools/twt_session_host.c replays the frames of a join; no SP
+*              is predicted there.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "twt_session.h"
+#include "trace.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <time.h>
+#else
+#include "cyhal.h"
+#include "whd_prof.h"
+#endif
+
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Largest wake duration in units of TWT_WD_UNIT_US */
+#define TWT_SESSION_MAX_WD              (255u)
+
+/* Length of the "tsf" iovar: low and high 32 bits of the TSF timer */
+#define TWT_SESSION_TSF_LEN             (8u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    twt_sp_callback_t callback;
+    void             *arg;
+} twt_sp_listener_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static twt_session_agreement_t twt_agreement;
+static cy_wcm_itwt_profile_t twt_requested_profile = CY_WCM_ITWT_PROFILE_NONE;
+static volatile twt_session_support_t twt_ap_support;
+
+/* The accepted agreement is tracked right away, its SPs are predicted once
+ * the TWT has been related to the RTOS time with the TSF */
+static volatile bool twt_anchor_pending;
+static uint32_t twt_target_wake_time;   /* Low 32 bits of the accepted TWT (TSF, us) */
+
+#if defined(__linux__)
+static pthread_mutex_t twt_session_mutex = PTHREAD_MUTEX_INITIALIZER;
+#else
+static cy_timer_t twt_sp_timer;
+static bool twt_sp_timer_initialized;
+static volatile bool twt_sp_in_progress;
+static twt_sp_listener_t twt_sp_listeners[TWT_SESSION_MAX_SP_CALLBACKS];
+static uint32_t twt_sp_listener_count;
+#endif /* defined(__linux__) */
+
+
+/*******************************************************************************
+* Function Name: twt_session_lock / twt_session_unlock
+********************************************************************************
+* Summary:
+* Serialize the accesses to the agreement: a critical section on the kit, as
+* the frames are reported from the WHD event thread and the SPs predicted
+* from the timer context, a mutex in the host build.
+*
+*******************************************************************************/
+static inline uint32_t twt_session_lock(void)
+{
+#if defined(__linux__)
+    pthread_mutex_lock(&twt_session_mutex);
+    return 0;
+#else
+    return cyhal_system_critical_section_enter();
+#endif
+}
+
+static inline void twt_session_unlock(uint32_t state)
+{
+#if defined(__linux__)
+    (void)state;
+    pthread_mutex_unlock(&twt_session_mutex);
+#else
+    cyhal_system_critical_section_exit(state);
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_now
+********************************************************************************
+* Summary:
+* Returns the RTOS time in milliseconds, the monotonic clock in the host
+* build.
+*
+*******************************************************************************/
+static cy_time_t twt_session_now(void)
+{
+    cy_time_t now;
+#if defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = (cy_time_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+#else
+    cy_rtos_get_time(&now);
+#endif
+    return now;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: twt_session_delay_to_next_sp
+********************************************************************************
+* Summary:
+* This function computes the time until the next predicted SP start. SPs start
+* at established_ms + k * WI, established_ms being possibly still ahead; the
+* arithmetic is done in microseconds so that the prediction does not drift
+* when WI is not a multiple of 1 ms.
+*
+*******************************************************************************/
+static uint32_t twt_session_delay_to_next_sp(const twt_session_agreement_t *agreement)
+{
+    cy_time_t now;
+    int32_t ahead_ms;
+    uint64_t elapsed_us;
+    uint64_t next_us;
+    uint32_t wi_us = twt_session_wake_interval_us(agreement);
+
+    if((wi_us == 0u) || twt_anchor_pending)
+    {
+        return 0;
+    }
+
+    cy_rtos_get_time(&now);
+    ahead_ms = (int32_t)(agreement->established_ms - now);
+    if(ahead_ms >= 0)
+    {
+        return (uint32_t)ahead_ms;
+    }
+
+    elapsed_us = (uint64_t)(uint32_t)(-ahead_ms) * 1000u;
+    next_us    = ((elapsed_us / wi_us) + 1u) * wi_us - elapsed_us;
+
+    return (uint32_t)((next_us + 999u) / 1000u);
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_notify
+********************************************************************************
+* Summary:
+* This function calls the SP listeners.
+*
+*******************************************************************************/
+static void twt_session_notify(twt_sp_event_t event)
+{
+    for(uint32_t i = 0; i < twt_sp_listener_count; i++)
+    {
+        twt_sp_listeners[i].callback(event, twt_sp_listeners[i].arg);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_sp_timer_handler
+********************************************************************************
+* Summary:
+* This function runs at the predicted SP boundaries and re-arms the timer for
+* the next boundary: SP end after WD, next SP start at the next multiple of WI.
+*
+*******************************************************************************/
+static void twt_session_sp_timer_handler(cy_timer_callback_arg_t arg)
+{
+    twt_session_agreement_t agreement;
+    uint32_t delay_ms;
+
+    twt_session_get(&agreement);
+    if(!agreement.active)
+    {
+        twt_sp_in_progress = false;
+        return;
+    }
+
+    if(!twt_sp_in_progress)
+    {
+        twt_sp_in_progress = true;
+        trace_record(TRACE_EVT_SP_START, agreement.flow_id, twt_session_wake_duration_us(&agreement));
+        twt_session_notify(TWT_SP_START);
+        delay_ms = (twt_session_wake_duration_us(&agreement) + 999u) / 1000u;
+    }
+    else
+    {
+        twt_sp_in_progress = false;
+        trace_record(TRACE_EVT_SP_END, agreement.flow_id, 0);
+        twt_session_notify(TWT_SP_END);
+        delay_ms = twt_session_delay_to_next_sp(&agreement);
+    }
+
+    cy_rtos_start_timer(&twt_sp_timer, (delay_ms == 0u) ? 1u : delay_ms);
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_schedule
+********************************************************************************
+* Summary:
+* This function (re)starts or stops the SP prediction for the tracked
+* agreement.
+*
+*******************************************************************************/
+static void twt_session_schedule(void)
+{
+    twt_session_agreement_t agreement;
+    uint32_t delay_ms;
+
+    if(!twt_sp_timer_initialized)
+    {
+        if(cy_rtos_init_timer(&twt_sp_timer, CY_TIMER_TYPE_ONCE, twt_session_sp_timer_handler, 0) != CY_RSLT_SUCCESS)
+        {
+            return;
+        }
+        twt_sp_timer_initialized = true;
+    }
+
+    cy_rtos_stop_timer(&twt_sp_timer);
+    twt_sp_in_progress = false;
+
+    twt_session_get(&agreement);
+    if(agreement.active && !twt_anchor_pending)
+    {
+        delay_ms = twt_session_delay_to_next_sp(&agreement);
+        cy_rtos_start_timer(&twt_sp_timer, (delay_ms == 0u) ? 1u : delay_ms);
+    }
+}
+#else
+/* Host builds track the agreement only */
+static void twt_session_schedule(void)
+{
+}
+#endif /* !defined(__linux__) */
+
+
+/*******************************************************************************
+* Function Name: twt_session_join_start
+********************************************************************************
+* Summary:
+* This function is called before a join requesting the given iTWT profile
+* from WCM. The agreement in effect, if any, ends with the association; the
+* new one is tracked as soon as the AP accepts it, which happens during the
+* join (See twt_session_frame).
+*
+* Parameters:
+*  cy_wcm_itwt_profile_t profile : iTWT profile requested from WCM, or
+*                                  CY_WCM_ITWT_PROFILE_NONE
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_join_start(cy_wcm_itwt_profile_t profile)
+{
+    twt_session_stop();
+    twt_requested_profile = profile;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_join_done
+********************************************************************************
+* Summary:
+* This function is called once the join started with twt_session_join_start()
+* returns. An agreement accepted during a failed join is dropped; after a
+* successful join, the agreement accepted during the join is kept, and one
+* accepted later is still tracked.
+*
+* Parameters:
+*  bool joined : the join succeeded
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_join_done(bool joined)
+{
+    if(!joined)
+    {
+        twt_session_stop();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_frame
+********************************************************************************
+* Summary:
+* This function updates the agreement from a decoded TWT frame exchanged with
+* the AP. An individual TWT Setup Accept from the AP becomes the agreement in
+* effect, with the accepted flow, WI and WD; its SPs are predicted from the
+* accepted target wake time once twt_session_update() has read the TSF. A
+* Teardown of that flow, or of all flows, ends it. Other frames are ignored.
+* The Accept, a Reject from the AP, or a Teardown received from the AP also
+* tell whether the AP supports the agreements (See twt_session_support()).
+*
+* Parameters:
+*  const twt_frame_t *frame : decoded frame
+*  bool from_ap             : the frame is known to be received from the AP
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_frame(const twt_frame_t *frame, bool from_ap)
+{
+    twt_session_agreement_t agreement;
+    uint32_t wd;
+
+    if(frame->kind == TWT_FRAME_TEARDOWN)
+    {
+        if(twt_agreement.active && (((frame->flags & TWT_FRAME_FLAG_ALL_TWT) != 0u) ||
+                                    (frame->flow_id == twt_agreement.flow_id)))
+        {
+            if(from_ap)
+            {
+                twt_ap_support = TWT_SESSION_SUPPORT_REFUSED;
+            }
+            twt_session_stop();
+        }
+        return;
+    }
+
+    if((frame->kind != TWT_FRAME_SETUP) ||
+       ((frame->flags & (TWT_FRAME_FLAG_REQUEST | TWT_FRAME_FLAG_BROADCAST)) != 0u))
+    {
+        return;
+    }
+    if(frame->setup_command == TWT_FRAME_CMD_REJECT)
+    {
+        twt_ap_support = TWT_SESSION_SUPPORT_REFUSED;
+        return;
+    }
+    if(frame->setup_command != TWT_FRAME_CMD_ACCEPT)
+    {
+        return;
+    }
+    twt_ap_support = TWT_SESSION_SUPPORT_ACCEPTED;
+
+    /* Wake duration in units of 256 us, also when the AP used TUs */
+    wd = twt_frame_wake_duration_us(frame) / TWT_WD_UNIT_US;
+
+    memset(&agreement, 0, sizeof(agreement));
+    agreement.active      = true;
+    agreement.profile     = twt_requested_profile;
+    agreement.flow_id     = frame->flow_id;
+    agreement.wi_mantissa = frame->wi_mantissa;
+    agreement.wi_exponent = frame->wi_exponent;
+    agreement.wd          = (uint8_t)((wd > TWT_SESSION_MAX_WD) ? TWT_SESSION_MAX_WD : wd);
+    agreement.established_ms = twt_session_now();
+
+    twt_target_wake_time = (uint32_t)frame->target_wake_time;
+    twt_anchor_pending = true;
+
+    twt_session_restore(&agreement);
+    trace_record(TRACE_EVT_TWT_SETUP, (uint16_t)agreement.profile, twt_session_wake_interval_us(&agreement));
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: twt_session_update
+********************************************************************************
+* Summary:
+* This function relates the TWT of a newly accepted agreement to the RTOS time
+* by reading the TSF, and starts the SP prediction. The TWT and the TSF are
+* compared in their low 32 bits, which is exact while the TWT is within 35
+* minutes of the TSF. Call it periodically from a thread that may issue
+* iovars; the WHD event handlers that report the Accept cannot.
+*
+* Parameters:
+*  whd_interface_t ifp : STA interface
+*
+* Return:
+*  bool : true if the SPs of a new agreement were anchored
+*
+*******************************************************************************/
+bool twt_session_update(whd_interface_t ifp)
+{
+    twt_session_agreement_t agreement;
+    uint8_t tsf[TWT_SESSION_TSF_LEN];
+    uint32_t tsf_low;
+    uint32_t wi_us;
+    int64_t offset_us;
+    cy_time_t now;
+    uint32_t state;
+
+    if(!twt_anchor_pending)
+    {
+        return false;
+    }
+
+    cy_rtos_get_time(&now);
+    if(whd_prof_get_iovar_buffer(ifp, "tsf", tsf, sizeof(tsf)) != WHD_SUCCESS)
+    {
+        return false;
+    }
+    tsf_low = (uint32_t)tsf[0] | ((uint32_t)tsf[1] << 8) | ((uint32_t)tsf[2] << 16) | ((uint32_t)tsf[3] << 24);
+
+    state = twt_session_lock();
+    agreement = twt_agreement;
+    wi_us = twt_session_wake_interval_us(&agreement);
+    if(twt_anchor_pending && (wi_us != 0u))
+    {
+        /* Next SP start at or after now: TWT + k * WI */
+        offset_us = (int64_t)(int32_t)(twt_target_wake_time - tsf_low) % (int64_t)wi_us;
+        if(offset_us < 0)
+        {
+            offset_us += wi_us;
+        }
+        twt_agreement.established_ms = now + (cy_time_t)((offset_us + 500) / 1000);
+    }
+    twt_anchor_pending = false;
+    twt_session_unlock(state);
+
+    twt_session_schedule();
+    return true;
+}
+#endif /* !defined(__linux__) */
+
+
+/*******************************************************************************
+* Function Name: twt_session_stop
+********************************************************************************
+* Summary:
+* This function marks the iTWT agreement as torn down.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_stop(void)
+{
+    uint32_t state = twt_session_lock();
+    bool was_active = twt_agreement.active;
+    memset(&twt_agreement, 0, sizeof(twt_agreement));
+    twt_agreement.profile = CY_WCM_ITWT_PROFILE_NONE;
+    twt_anchor_pending = false;
+    twt_session_unlock(state);
+
+    if(was_active)
+    {
+        trace_record(TRACE_EVT_TWT_TEARDOWN, 0, 0);
+        twt_session_schedule();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_restore
+********************************************************************************
+* Summary:
+* This function replaces the tracked agreement, e.g. with one restored from
+* retention RAM. Its SPs are predicted from established_ms, unless the
+* agreement was just accepted and waits for the TSF.
+*
+* Parameters:
+*  const twt_session_agreement_t *agreement : agreement to track
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_restore(const twt_session_agreement_t *agreement)
+{
+    uint32_t state = twt_session_lock();
+    twt_agreement = *agreement;
+    twt_session_unlock(state);
+
+    twt_session_schedule();
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_get
+********************************************************************************
+* Summary:
+* This function returns a copy of the tracked agreement.
+*
+* Parameters:
+*  twt_session_agreement_t *agreement : buffer to copy the agreement to
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_get(twt_session_agreement_t *agreement)
+{
+    uint32_t state = twt_session_lock();
+    *agreement = twt_agreement;
+    twt_session_unlock(state);
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_is_active
+********************************************************************************
+* Summary:
+* This function tells whether an iTWT agreement is in effect.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  bool : true if an agreement is in effect
+*
+*******************************************************************************/
+bool twt_session_is_active(void)
+{
+    return twt_agreement.active;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_support
+********************************************************************************
+* Summary:
+* This function tells what the AP answered to the iTWT agreements of this
+* STA: the last TWT Setup from the AP, or a Teardown received from the AP.
+* Unlike twt_session_is_active(), it does not depend on when the answer
+* arrives relative to the join that requested the agreement.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  twt_session_support_t
+*
+*******************************************************************************/
+twt_session_support_t twt_session_support(void)
+{
+    return twt_ap_support;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_reset_support
+********************************************************************************
+* Summary:
+* This function forgets the answer of the AP, e.g. when moving to another AP.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void twt_session_reset_support(void)
+{
+    twt_ap_support = TWT_SESSION_SUPPORT_UNKNOWN;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_wake_interval_us
+********************************************************************************
+* Summary:
+* This function computes the wake interval as WI = mantissa * 2 ^ exponent.
+*
+* Parameters:
+*  const twt_session_agreement_t *agreement : agreement to evaluate
+*
+* Return:
+*  uint32_t : wake interval in microseconds, 0 if no agreement is active
+*
+*******************************************************************************/
+uint32_t twt_session_wake_interval_us(const twt_session_agreement_t *agreement)
+{
+    uint64_t wi_us;
+
+    if(!agreement->active || (agreement->wi_exponent > 31u))
+    {
+        return 0;
+    }
+
+    wi_us = (uint64_t)agreement->wi_mantissa << agreement->wi_exponent;
+
+    return (wi_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)wi_us;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_wake_duration_us
+********************************************************************************
+* Summary:
+* This function computes the wake duration as WD = WD * 256.
+*
+* Parameters:
+*  const twt_session_agreement_t *agreement : agreement to evaluate
+*
+* Return:
+*  uint32_t : wake duration in microseconds, 0 if no agreement is active
+*
+*******************************************************************************/
+uint32_t twt_session_wake_duration_us(const twt_session_agreement_t *agreement)
+{
+    if(!agreement->active)
+    {
+        return 0;
+    }
+
+    return (uint32_t)agreement->wd * TWT_WD_UNIT_US;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: twt_session_register_sp_callback
+********************************************************************************
+* Summary:
+* This function registers a listener for predicted SP start and end. The
+* listener runs in the RTOS timer context and must not block.
+*
+* Parameters:
+*  twt_sp_callback_t callback : function to call
+*  void *arg                  : argument passed to the function
+*
+* Return:
+*  cy_rslt_t : CY_RSLT_SUCCESS, or -1 if too many listeners are registered
+*
+*******************************************************************************/
+cy_rslt_t twt_session_register_sp_callback(twt_sp_callback_t callback, void *arg)
+{
+    if(twt_sp_listener_count >= TWT_SESSION_MAX_SP_CALLBACKS)
+    {
+        return (cy_rslt_t)-1;
+    }
+
+    twt_sp_listeners[twt_sp_listener_count].callback = callback;
+    twt_sp_listeners[twt_sp_listener_count].arg      = arg;
+    twt_sp_listener_count++;
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_ms_to_next_sp
+********************************************************************************
+* Summary:
+* This function returns the time until the next predicted SP start.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t : milliseconds to the next SP, 0 if no agreement is active
+*
+*******************************************************************************/
+uint32_t twt_session_ms_to_next_sp(void)
+{
+    twt_session_agreement_t agreement;
+
+    twt_session_get(&agreement);
+
+    return twt_session_delay_to_next_sp(&agreement);
+}
+
+
+/*******************************************************************************
+* Function Name: twt_session_in_sp
+********************************************************************************
+* Summary:
+* This function tells whether a predicted SP is in progress.
+*
+*******************************************************************************/
+bool twt_session_in_sp(void)
+{
+    return twt_sp_in_progress;
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
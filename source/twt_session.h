@@ -0,0 +1,145 @@
+/******************************************************************************
+* File Name:   twt_session.h
+*
+* Description: This file contains the declarations for tracking the iTWT
+*              agreement currently in effect between the STA and the AP.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TWT_SESSION_H_
+#define TWT_SESSION_H_
+
+#include "twt_frame.h"
+
+#if !defined(__linux__)
+#include "cy_wcm.h"
+#include "cyabs_rtos.h"
+
+/* WHD header file. */
+#include "whd_wifi_api.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+/* Host builds (tools/): the WCM and RTOS types of the agreement */
+typedef uint32_t cy_time_t;
+typedef enum { CY_WCM_ITWT_PROFILE_NONE = 0, CY_WCM_ITWT_PROFILE_IDLE, CY_WCM_ITWT_PROFILE_ACTIVE } cy_wcm_itwt_profile_t;
+#endif
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* TWT Wake Duration unit as per 802.11ax (256 us) */
+#define TWT_WD_UNIT_US                  (256u)
+
+/* Parameters the AP of the README captures accepted for the WCM active
+ * profile; nominal values where no agreement is in effect */
+#define TWT_ACTIVE_WI_MANTISSA          (7u)
+#define TWT_ACTIVE_WI_EXPONENT          (13u)
+#define TWT_ACTIVE_WD                   (32u)
+
+/* Same for the WCM idle profile (See README.md) */
+#define TWT_IDLE_WI_MANTISSA            (75u)
+#define TWT_IDLE_WI_EXPONENT            (13u)
+#define TWT_IDLE_WD                     (32u)
+
+
+/* Maximum number of SP listeners */
+#define TWT_SESSION_MAX_SP_CALLBACKS    (4u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    TWT_SP_START = 0,
+    TWT_SP_END
+} twt_sp_event_t;
+
+/* What the AP answered to the iTWT agreements of this STA */
+typedef enum
+{
+    TWT_SESSION_SUPPORT_UNKNOWN = 0,    /* No setup answered yet */
+    TWT_SESSION_SUPPORT_ACCEPTED,       /* Last setup accepted */
+    TWT_SESSION_SUPPORT_REFUSED         /* Last setup rejected, or the agreement torn down by the AP */
+} twt_session_support_t;
+
+/* Called from the RTOS timer context at the predicted SP boundaries */
+typedef void (*twt_sp_callback_t)(twt_sp_event_t event, void *arg);
+
+typedef struct
+{
+    bool                  active;
+    cy_wcm_itwt_profile_t profile;
+    uint8_t               flow_id;
+    uint16_t              wi_mantissa;
+    uint8_t               wi_exponent;
+    uint8_t               wd;             /* In units of TWT_WD_UNIT_US */
+    cy_time_t             established_ms; /* RTOS time of an SP start; SPs start every WI from it */
+} twt_session_agreement_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void twt_session_join_start(cy_wcm_itwt_profile_t profile);
+void twt_session_join_done(bool joined);
+void twt_session_frame(const twt_frame_t *frame, bool from_ap);
+void twt_session_stop(void);
+void twt_session_restore(const twt_session_agreement_t *agreement);
+void twt_session_get(twt_session_agreement_t *agreement);
+bool twt_session_is_active(void);
+twt_session_support_t twt_session_support(void);
+void twt_session_reset_support(void);
+
+uint32_t twt_session_wake_interval_us(const twt_session_agreement_t *agreement);
+uint32_t twt_session_wake_duration_us(const twt_session_agreement_t *agreement);
+
+#if !defined(__linux__)
+bool twt_session_update(whd_interface_t ifp);
+cy_rslt_t twt_session_register_sp_callback(twt_sp_callback_t callback, void *arg);
+uint32_t twt_session_ms_to_next_sp(void);
+bool twt_session_in_sp(void);
+#endif
+
+#endif /* TWT_SESSION_H_ */
+
+/* [] END OF FILE */
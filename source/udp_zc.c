@@ -0,0 +1,777 @@
+/******************************************************************************
+* File Name:   udp_zc.c
+*
+* Description: This file implements the zero-copy UDP send API. A send
+*              through secure sockets allocates a NetX Duo packet and copies
+*              the application buffer into it. Here, the application
+*              allocates the packet from the pool the IP instance sends from,
+*              writes the payload at its final place behind the room reserved
+*              for the UDP, IP and link headers, and the packet itself is
+*              passed to nx_udp_socket_send().
+*
+*              Packets are reference counted. The application may hold more
+*              references to keep a packet for a later resend; the send then
+*              passes a copy, since the stack releases the packet it is given
+*              once it has been transmitted. The send of the last reference
+*              passes the packet itself.
+*
+*              "udp_zc bench" compares the CPU cycles per packet and the
+*              throughput of both paths on the same workload.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "udp_zc.h"
+#include "cycle_counter.h"
+#include "socket_init.h"
+
+#include "cyabs_rtos.h"
+#include "cyhal.h"
+#include "command_console.h"
+
+/* NetX Duo header files. */
+#include "cy_network_mw_core.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define UDP_ZC_ERROR                    ((cy_rslt_t)-1)
+
+/* iperf 2 UDP header: sequence number and send time; a negative sequence
+ * number ends the stream */
+#define UDP_ZC_IPERF_HEADER_LEN         (12u)
+#define UDP_ZC_BENCH_FIN_COUNT          (10u)
+#define UDP_ZC_BENCH_GAP_MS             (1000u)
+
+#define UDP_ZC_PUT_BE32(p, v)           do { (p)[0] = (uint8_t)((v) >> 24); (p)[1] = (uint8_t)((v) >> 16); \
+                                             (p)[2] = (uint8_t)((v) >> 8); (p)[3] = (uint8_t)(v); } while(0)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t allocs;
+    uint32_t alloc_failures;
+    uint32_t zero_copy_sends;
+    uint32_t copied_sends;          /* Sent while other references were held */
+    uint32_t send_errors;
+} udp_zc_stats_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int udp_zc_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static udp_zc_packet_t udp_zc_packets[UDP_ZC_MAX_PACKETS];
+static udp_zc_stats_t udp_zc_stats;
+
+/* Benchmark state: the copy path's application buffer, the cycle samples of
+ * the last packets of a run, and the results of the copy and zero-copy runs */
+static uint8_t udp_zc_bench_buffer[UDP_ZC_MAX_PAYLOAD];
+static uint32_t udp_zc_bench_samples[UDP_ZC_BENCH_SAMPLES];
+static udp_zc_bench_result_t udp_zc_bench_results[2];
+static bool udp_zc_bench_valid;
+
+#define UDP_ZC_COMMANDS \
+    { (char *) "udp_zc", udp_zc_command, 0, NULL, NULL, (char *) "[bench <host> [port] [count] [size]]", (char *) "Show the zero-copy UDP packets, or compare the cycles per packet and throughput with the copying send" }, \
+
+const cy_command_console_cmd_t udp_zc_commands_table[] =
+{
+    UDP_ZC_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: udp_zc_ip
+********************************************************************************
+* Summary:
+* Returns the IP instance of the STA interface.
+*
+*******************************************************************************/
+static NX_IP *udp_zc_ip(void)
+{
+    return (NX_IP *)cy_network_get_nw_interface(CY_NETWORK_WIFI_STA_INTERFACE, 0);
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_count
+********************************************************************************
+* Summary:
+* Increments a counter of udp_zc_stats in the critical section that guards
+* the references, as the senders may run in several threads.
+*
+*******************************************************************************/
+static void udp_zc_count(uint32_t *counter)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    (*counter)++;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_socket_open
+********************************************************************************
+* Summary:
+* This function creates a UDP socket on the STA interface and binds it.
+*
+* Parameters:
+*  udp_zc_socket_t *socket : socket to open
+*  uint16_t local_port     : port to bind, 0 for any
+*
+* Return:
+*  cy_rslt_t
+*
+*******************************************************************************/
+cy_rslt_t udp_zc_socket_open(udp_zc_socket_t *socket, uint16_t local_port)
+{
+    NX_IP *ip_ptr = udp_zc_ip();
+    UINT status;
+
+    if(ip_ptr == NULL)
+    {
+        return UDP_ZC_ERROR;
+    }
+
+    status = nx_udp_socket_create(ip_ptr, &socket->socket, (CHAR *)"udp_zc", NX_IP_NORMAL, NX_DONT_FRAGMENT,
+                                  NX_IP_TIME_TO_LIVE, UDP_ZC_RX_QUEUE);
+    if(status != NX_SUCCESS)
+    {
+        return (cy_rslt_t)status;
+    }
+
+    status = nx_udp_socket_bind(&socket->socket, (local_port != 0u) ? local_port : NX_ANY_PORT, NX_NO_WAIT);
+    if(status != NX_SUCCESS)
+    {
+        nx_udp_socket_delete(&socket->socket);
+        return (cy_rslt_t)status;
+    }
+
+    socket->created = true;
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_socket_close
+********************************************************************************
+* Summary:
+* This function unbinds and deletes a socket opened by udp_zc_socket_open().
+*
+* Parameters:
+*  udp_zc_socket_t *socket
+*
+*******************************************************************************/
+void udp_zc_socket_close(udp_zc_socket_t *socket)
+{
+    if(socket->created)
+    {
+        nx_udp_socket_unbind(&socket->socket);
+        nx_udp_socket_delete(&socket->socket);
+        socket->created = false;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_alloc
+********************************************************************************
+* Summary:
+* This function allocates a packet from the pool the IP instance sends from,
+* with room reserved for the headers, and returns it with one reference.
+*
+* Parameters:
+*  uint32_t timeout_ms : time to wait for a free packet
+*
+* Return:
+*  udp_zc_packet_t * : the packet, NULL if none is free
+*
+*******************************************************************************/
+udp_zc_packet_t *udp_zc_alloc(uint32_t timeout_ms)
+{
+    NX_IP *ip_ptr = udp_zc_ip();
+    udp_zc_packet_t *packet = NULL;
+    NX_PACKET *nx_packet;
+    uint32_t capacity;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    for(uint32_t i = 0; i < UDP_ZC_MAX_PACKETS; i++)
+    {
+        if(udp_zc_packets[i].refs == 0u)
+        {
+            packet = &udp_zc_packets[i];
+            packet->refs = 1u;
+            break;
+        }
+    }
+    if(packet == NULL)
+    {
+        udp_zc_stats.alloc_failures++;
+    }
+    cyhal_system_critical_section_exit(state);
+
+    if(packet == NULL)
+    {
+        return NULL;
+    }
+
+    if((ip_ptr == NULL) ||
+       (nx_packet_allocate(ip_ptr->nx_ip_default_packet_pool, &nx_packet, NX_UDP_PACKET,
+                           (ULONG)((timeout_ms * NX_IP_PERIODIC_RATE + 999u) / 1000u)) != NX_SUCCESS))
+    {
+        state = cyhal_system_critical_section_enter();
+        packet->refs = 0u;
+        udp_zc_stats.alloc_failures++;
+        cyhal_system_critical_section_exit(state);
+        return NULL;
+    }
+
+    capacity = (uint32_t)(nx_packet->nx_packet_data_end - nx_packet->nx_packet_prepend_ptr);
+
+    packet->packet   = nx_packet;
+    packet->payload  = nx_packet->nx_packet_prepend_ptr;
+    packet->capacity = (capacity < UDP_ZC_MAX_PAYLOAD) ? capacity : UDP_ZC_MAX_PAYLOAD;
+    udp_zc_count(&udp_zc_stats.allocs);
+
+    return packet;
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_hold
+********************************************************************************
+* Summary:
+* This function takes one more reference to a packet.
+*
+* Parameters:
+*  udp_zc_packet_t *packet
+*
+*******************************************************************************/
+void udp_zc_hold(udp_zc_packet_t *packet)
+{
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    packet->refs++;
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_release
+********************************************************************************
+* Summary:
+* This function drops one reference to a packet, and returns the packet to
+* the pool with the last one.
+*
+* Parameters:
+*  udp_zc_packet_t *packet
+*
+*******************************************************************************/
+void udp_zc_release(udp_zc_packet_t *packet)
+{
+    NX_PACKET *nx_packet = NULL;
+    uint32_t state = cyhal_system_critical_section_enter();
+
+    if(packet->refs == 1u)
+    {
+        nx_packet = packet->packet;
+        packet->packet = NULL;
+    }
+    packet->refs--;
+    cyhal_system_critical_section_exit(state);
+
+    if(nx_packet != NULL)
+    {
+        nx_packet_release(nx_packet);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_send
+********************************************************************************
+* Summary:
+* This function sends the first 'length' bytes of the payload and drops the
+* caller's reference. With other references held, a copy of the packet is
+* sent and the packet stays valid for them.
+*
+* Parameters:
+*  udp_zc_socket_t *socket      : opened by udp_zc_socket_open()
+*  udp_zc_packet_t *packet      : from udp_zc_alloc()
+*  uint32_t length              : payload bytes, up to the packet capacity
+*  const cy_socket_sockaddr_t *to : IPv4 destination
+*
+* Return:
+*  cy_rslt_t : on failure, the caller keeps its reference
+*
+*******************************************************************************/
+cy_rslt_t udp_zc_send(udp_zc_socket_t *socket, udp_zc_packet_t *packet, uint32_t length,
+                      const cy_socket_sockaddr_t *to)
+{
+    NX_PACKET *nx_packet = packet->packet;
+    NX_IP *ip_ptr;
+    uint32_t ip = to->ip_address.ip.v4;
+    uint32_t state;
+    bool last;
+    UINT status;
+
+    if((length > packet->capacity) || (to->ip_address.version != CY_SOCKET_IP_VER_V4))
+    {
+        udp_zc_count(&udp_zc_stats.send_errors);
+        return UDP_ZC_ERROR;
+    }
+
+    nx_packet->nx_packet_append_ptr = nx_packet->nx_packet_prepend_ptr + length;
+    nx_packet->nx_packet_length = length;
+
+    /* The last reference detaches the packet in the same critical section
+     * that checks the count, so that no udp_zc_hold() or udp_zc_release()
+     * of another holder falls between the check and the hand-off. The slot
+     * keeps its reference until the send returns. */
+    state = cyhal_system_critical_section_enter();
+    last = (packet->refs == 1u);
+    if(last)
+    {
+        packet->packet = NULL;
+    }
+    cyhal_system_critical_section_exit(state);
+
+    if(!last)
+    {
+        /* The interface may be down, with no pool to copy to */
+        ip_ptr = udp_zc_ip();
+        if((ip_ptr == NULL) || (ip_ptr->nx_ip_default_packet_pool == NULL))
+        {
+            udp_zc_count(&udp_zc_stats.send_errors);
+            return UDP_ZC_ERROR;
+        }
+
+        status = nx_packet_copy(packet->packet, &nx_packet, ip_ptr->nx_ip_default_packet_pool, NX_NO_WAIT);
+        if(status != NX_SUCCESS)
+        {
+            udp_zc_count(&udp_zc_stats.send_errors);
+            return (cy_rslt_t)status;
+        }
+    }
+
+    /* Secure sockets keeps addresses in network order, NetX in host order */
+    status = nx_udp_socket_send(&socket->socket, nx_packet,
+                                (ULONG)((ip << 24) | ((ip & 0xff00u) << 8) | ((ip >> 8) & 0xff00u) | (ip >> 24)),
+                                to->port);
+    if(status != NX_SUCCESS)
+    {
+        if(last)
+        {
+            packet->packet = nx_packet;
+        }
+        else
+        {
+            nx_packet_release(nx_packet);
+        }
+        udp_zc_count(&udp_zc_stats.send_errors);
+        return (cy_rslt_t)status;
+    }
+
+    if(last)
+    {
+        /* The stack owns the packet now, the slot returns to the pool */
+        state = cyhal_system_critical_section_enter();
+        packet->refs = 0u;
+        udp_zc_stats.zero_copy_sends++;
+        cyhal_system_critical_section_exit(state);
+    }
+    else
+    {
+        udp_zc_count(&udp_zc_stats.copied_sends);
+        udp_zc_release(packet);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_bench_fill
+********************************************************************************
+* Summary:
+* Writes the payload of a benchmark packet: an iperf 2 UDP header followed by
+* a fill pattern.
+*
+*******************************************************************************/
+static void udp_zc_bench_fill(uint8_t *payload, uint32_t size, int32_t id)
+{
+    cy_time_t now;
+
+    cy_rtos_get_time(&now);
+    UDP_ZC_PUT_BE32(&payload[0], (uint32_t)id);
+    UDP_ZC_PUT_BE32(&payload[4], (uint32_t)(now / 1000u));
+    UDP_ZC_PUT_BE32(&payload[8], (uint32_t)((now % 1000u) * 1000u));
+    memset(&payload[UDP_ZC_IPERF_HEADER_LEN], (int)(id & 0xff), size - UDP_ZC_IPERF_HEADER_LEN);
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_compare_u32
+********************************************************************************
+* Summary:
+* qsort() comparison of uint32_t values.
+*
+*******************************************************************************/
+static int udp_zc_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_bench_finish
+********************************************************************************
+* Summary:
+* Computes the cycles per packet and the throughput of a run. The median is
+* taken over the last UDP_ZC_BENCH_SAMPLES packets, so that the packets that
+* waited for a free buffer do not skew it.
+*
+*******************************************************************************/
+static void udp_zc_bench_finish(udp_zc_bench_result_t *result, uint32_t count, uint32_t size,
+                                uint64_t total_cycles, uint32_t duration_ms)
+{
+    uint32_t samples = (count < UDP_ZC_BENCH_SAMPLES) ? count : UDP_ZC_BENCH_SAMPLES;
+
+    qsort(udp_zc_bench_samples, samples, sizeof(udp_zc_bench_samples[0]), udp_zc_compare_u32);
+
+    result->cycles_p50  = udp_zc_bench_samples[samples / 2u];
+    result->cycles_avg  = (uint32_t)(total_cycles / count);
+    result->duration_ms = (duration_ms != 0u) ? duration_ms : 1u;
+    result->kbps        = (uint32_t)(((uint64_t)result->sent * size * 8u) / result->duration_ms);
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_bench_copy
+********************************************************************************
+* Summary:
+* Sends 'count' packets through secure sockets, which copies the application
+* buffer into a packet of the stack.
+*
+*******************************************************************************/
+static void udp_zc_bench_copy(const cy_socket_sockaddr_t *to, uint32_t count, uint32_t size,
+                              udp_zc_bench_result_t *result)
+{
+    cy_socket_t s;
+    cy_time_t start;
+    cy_time_t end;
+    uint64_t total_cycles = 0;
+    uint32_t sent;
+
+    memset(result, 0, sizeof(*result));
+
+    if(cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP, &s) != CY_RSLT_SUCCESS)
+    {
+        result->errors = count;
+        return;
+    }
+
+    cy_rtos_get_time(&start);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t begin = cycle_counter_get();
+        bool ok;
+
+        udp_zc_bench_fill(udp_zc_bench_buffer, size, (int32_t)i);
+        ok = (cy_socket_sendto(s, udp_zc_bench_buffer, size, CY_SOCKET_FLAGS_NONE, to, sizeof(*to), &sent) ==
+              CY_RSLT_SUCCESS);
+
+        udp_zc_bench_samples[i % UDP_ZC_BENCH_SAMPLES] = cycle_counter_get() - begin;
+        total_cycles += udp_zc_bench_samples[i % UDP_ZC_BENCH_SAMPLES];
+        result->sent += ok ? 1u : 0u;
+        result->errors += ok ? 0u : 1u;
+    }
+    cy_rtos_get_time(&end);
+
+    for(uint32_t i = 0; i < UDP_ZC_BENCH_FIN_COUNT; i++)
+    {
+        udp_zc_bench_fill(udp_zc_bench_buffer, UDP_ZC_IPERF_HEADER_LEN, -(int32_t)count);
+        cy_socket_sendto(s, udp_zc_bench_buffer, UDP_ZC_IPERF_HEADER_LEN, CY_SOCKET_FLAGS_NONE, to, sizeof(*to), &sent);
+    }
+
+    cy_socket_delete(s);
+    udp_zc_bench_finish(result, count, size, total_cycles, (uint32_t)(end - start));
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_bench_zero_copy
+********************************************************************************
+* Summary:
+* Sends 'count' packets filled in place through udp_zc_send().
+*
+*******************************************************************************/
+static void udp_zc_bench_zero_copy(const cy_socket_sockaddr_t *to, uint32_t count, uint32_t size,
+                                   udp_zc_bench_result_t *result)
+{
+    udp_zc_socket_t socket;
+    udp_zc_packet_t *packet;
+    cy_time_t start;
+    cy_time_t end;
+    uint64_t total_cycles = 0;
+
+    memset(result, 0, sizeof(*result));
+    memset(&socket, 0, sizeof(socket));
+
+    if(udp_zc_socket_open(&socket, 0u) != CY_RSLT_SUCCESS)
+    {
+        result->errors = count;
+        return;
+    }
+
+    cy_rtos_get_time(&start);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t begin = cycle_counter_get();
+        bool ok = false;
+
+        packet = udp_zc_alloc(UDP_ZC_ALLOC_TIMEOUT_MS);
+        if(packet != NULL)
+        {
+            udp_zc_bench_fill(packet->payload, size, (int32_t)i);
+            ok = (udp_zc_send(&socket, packet, size, to) == CY_RSLT_SUCCESS);
+            if(!ok)
+            {
+                udp_zc_release(packet);
+            }
+        }
+
+        udp_zc_bench_samples[i % UDP_ZC_BENCH_SAMPLES] = cycle_counter_get() - begin;
+        total_cycles += udp_zc_bench_samples[i % UDP_ZC_BENCH_SAMPLES];
+        result->sent += ok ? 1u : 0u;
+        result->errors += ok ? 0u : 1u;
+    }
+    cy_rtos_get_time(&end);
+
+    for(uint32_t i = 0; i < UDP_ZC_BENCH_FIN_COUNT; i++)
+    {
+        packet = udp_zc_alloc(UDP_ZC_ALLOC_TIMEOUT_MS);
+        if(packet != NULL)
+        {
+            udp_zc_bench_fill(packet->payload, UDP_ZC_IPERF_HEADER_LEN, -(int32_t)count);
+            if(udp_zc_send(&socket, packet, UDP_ZC_IPERF_HEADER_LEN, to) != CY_RSLT_SUCCESS)
+            {
+                udp_zc_release(packet);
+            }
+        }
+    }
+
+    udp_zc_socket_close(&socket);
+    udp_zc_bench_finish(result, count, size, total_cycles, (uint32_t)(end - start));
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_bench_print
+********************************************************************************
+* Summary:
+* Prints the results of the copy and zero-copy runs.
+*
+*******************************************************************************/
+static void udp_zc_bench_print(void)
+{
+    static const char *names[2] = { "copy", "zero-copy" };
+    const udp_zc_bench_result_t *copy = &udp_zc_bench_results[0];
+    const udp_zc_bench_result_t *zc = &udp_zc_bench_results[1];
+
+    printf("%-10s %6s %6s %10s %10s %7s %8s\n", "path", "sent", "errors", "cycles p50", "cycles avg", "ms", "kbit/s");
+    for(uint32_t i = 0; i < 2u; i++)
+    {
+        const udp_zc_bench_result_t *result = &udp_zc_bench_results[i];
+
+        printf("%-10s %6" PRIu32 " %6" PRIu32 " %10" PRIu32 " %10" PRIu32 " %7" PRIu32 " %8" PRIu32 "\n", names[i],
+               result->sent, result->errors, result->cycles_p50, result->cycles_avg, result->duration_ms, result->kbps);
+    }
+
+    if((copy->cycles_p50 > zc->cycles_p50) && (copy->cycles_p50 != 0u))
+    {
+        uint32_t permille = ((copy->cycles_p50 - zc->cycles_p50) * 1000u) / copy->cycles_p50;
+
+        printf("Zero-copy saves %" PRIu32 " cycles per packet (%" PRIu32 ".%" PRIu32 "%%)\n",
+               copy->cycles_p50 - zc->cycles_p50, permille / 10u, permille % 10u);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_bench
+********************************************************************************
+* Summary:
+* Runs the same workload through the copying send and the zero-copy send.
+*
+*******************************************************************************/
+static int udp_zc_bench(const char *host, uint16_t port, uint32_t count, uint32_t size)
+{
+    cy_socket_sockaddr_t to;
+
+    if((count == 0u) || (size < UDP_ZC_IPERF_HEADER_LEN) || (size > UDP_ZC_MAX_PAYLOAD))
+    {
+        printf("count must be at least 1 and size %u to %u bytes\n", (unsigned)UDP_ZC_IPERF_HEADER_LEN,
+               (unsigned)UDP_ZC_MAX_PAYLOAD);
+        return -1;
+    }
+
+    if(socket_init() != CY_RSLT_SUCCESS)
+    {
+        return -1;
+    }
+
+    memset(&to, 0, sizeof(to));
+    to.port = port;
+    if(cy_socket_gethostbyname(host, CY_SOCKET_IP_VER_V4, &to.ip_address) != CY_RSLT_SUCCESS)
+    {
+        printf("Cannot resolve %s\n", host);
+        return -1;
+    }
+
+    cycle_counter_init();
+
+    printf("Sending %" PRIu32 " packets of %" PRIu32 " bytes to %s:%u with each path\n", count, size, host,
+           (unsigned)port);
+    udp_zc_bench_copy(&to, count, size, &udp_zc_bench_results[0]);
+    cy_rtos_delay_milliseconds(UDP_ZC_BENCH_GAP_MS);
+    udp_zc_bench_zero_copy(&to, count, size, &udp_zc_bench_results[1]);
+    udp_zc_bench_valid = true;
+
+    udp_zc_bench_print();
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_command
+********************************************************************************
+* Summary:
+* This function shows the zero-copy packets allocated and sent and the state
+* of the packet pool, or runs the benchmark against a UDP receiver such as
+* an iperf 2 UDP server.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int udp_zc_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    NX_IP *ip_ptr = udp_zc_ip();
+    uint32_t held = 0;
+
+    if((argc >= 3) && !strcmp(argv[1], "bench"))
+    {
+        return udp_zc_bench(argv[2],
+                            (argc > 3) ? (uint16_t)strtoul(argv[3], NULL, 0) : UDP_ZC_BENCH_PORT,
+                            (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 0) : UDP_ZC_BENCH_COUNT,
+                            (argc > 5) ? (uint32_t)strtoul(argv[5], NULL, 0) : UDP_ZC_BENCH_SIZE);
+    }
+
+    if(argc >= 2)
+    {
+        printf("Usage: udp_zc [bench <host> [port] [count] [size]]\n");
+        return -1;
+    }
+
+    for(uint32_t i = 0; i < UDP_ZC_MAX_PACKETS; i++)
+    {
+        held += (udp_zc_packets[i].refs != 0u) ? 1u : 0u;
+    }
+
+    printf("Allocated: %" PRIu32 ", allocation failures: %" PRIu32 ", held now: %" PRIu32 "\n",
+           udp_zc_stats.allocs, udp_zc_stats.alloc_failures, held);
+    printf("Sent without copy: %" PRIu32 ", copied (references held): %" PRIu32 ", send errors: %" PRIu32 "\n",
+           udp_zc_stats.zero_copy_sends, udp_zc_stats.copied_sends, udp_zc_stats.send_errors);
+
+    if(ip_ptr != NULL)
+    {
+        printf("Packet pool: %lu of %lu free, %lu empty requests\n",
+               (unsigned long)ip_ptr->nx_ip_default_packet_pool->nx_packet_pool_available,
+               (unsigned long)ip_ptr->nx_ip_default_packet_pool->nx_packet_pool_total,
+               (unsigned long)ip_ptr->nx_ip_default_packet_pool->nx_packet_pool_empty_requests);
+    }
+
+    if(udp_zc_bench_valid)
+    {
+        udp_zc_bench_print();
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: udp_zc_add_commands
+********************************************************************************
+* Summary:
+* This function registers the zero-copy UDP command.
+*
+*******************************************************************************/
+cy_rslt_t udp_zc_add_commands(void)
+{
+    return cy_command_console_add_table(udp_zc_commands_table);
+}
+
+
+/* [] END OF FILE */
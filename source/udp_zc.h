@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name:   udp_zc.h
+*
+* Description: This file contains the declarations for the zero-copy UDP send
+*              API: the application fills its payload directly in a packet of
+*              the network stack and hands the packet over.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef UDP_ZC_H_
+#define UDP_ZC_H_
+
+#include "cy_result.h"
+#include "cy_secure_sockets.h"
+
+/* NetX Duo header files. */
+#include "nx_api.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Packets the application can hold at once */
+#define UDP_ZC_MAX_PACKETS              (16u)
+
+/* Largest payload that is not fragmented on a 1500-byte MTU */
+#define UDP_ZC_MAX_PAYLOAD              (1472u)
+
+#define UDP_ZC_RX_QUEUE                 (4u)
+
+/* Benchmark: default destination (iperf UDP server), packets and size */
+#define UDP_ZC_BENCH_PORT               (5001u)
+#define UDP_ZC_BENCH_COUNT              (2000u)
+#define UDP_ZC_BENCH_SIZE               (1400u)
+#define UDP_ZC_BENCH_SAMPLES            (256u)
+#define UDP_ZC_ALLOC_TIMEOUT_MS         (100u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    NX_UDP_SOCKET socket;
+    bool          created;
+} udp_zc_socket_t;
+
+/* A packet held by the application. The payload is written in place and
+ * sent with udp_zc_send(); the packet returns to the pool when the last
+ * reference is dropped, by udp_zc_release() or by the send */
+typedef struct
+{
+    NX_PACKET *packet;
+    uint8_t   *payload;
+    uint32_t   capacity;            /* Bytes available at payload */
+    uint32_t   refs;
+} udp_zc_packet_t;
+
+typedef struct
+{
+    uint32_t sent;
+    uint32_t errors;                /* Send or allocation failures */
+    uint32_t cycles_p50;            /* CPU cycles per packet: fill, allocation and send */
+    uint32_t cycles_avg;
+    uint32_t duration_ms;
+    uint32_t kbps;                  /* UDP payload handed to the stack */
+} udp_zc_bench_result_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t udp_zc_socket_open(udp_zc_socket_t *socket, uint16_t local_port);
+void udp_zc_socket_close(udp_zc_socket_t *socket);
+
+udp_zc_packet_t *udp_zc_alloc(uint32_t timeout_ms);
+void udp_zc_hold(udp_zc_packet_t *packet);
+void udp_zc_release(udp_zc_packet_t *packet);
+cy_rslt_t udp_zc_send(udp_zc_socket_t *socket, udp_zc_packet_t *packet, uint32_t length,
+                      const cy_socket_sockaddr_t *to);
+
+cy_rslt_t udp_zc_add_commands(void);
+
+#endif /* UDP_ZC_H_ */
+
+/* [] END OF FILE */
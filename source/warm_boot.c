@@ -0,0 +1,708 @@
+/******************************************************************************
+* File Name:   warm_boot.c
+*
+* Description: This file implements the warm-boot state block. The block holds
+*              the connection cache, the iTWT agreement and boot/heap
+*              statistics in retention RAM, protected by a CRC, so that after a
+*              watchdog or software reset the application can skip the steps
+*              that are still valid.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "warm_boot.h"
+
+#if !defined(__linux__)
+#include "cyhal.h"
+#include "cyabs_rtos.h"
+#include "command_console.h"
+
+/* WHD header file. */
+#include "whd_wlioctl.h"
+#endif
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#if !defined(__linux__)
+#include <malloc.h>
+#endif
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define WARM_BOOT_HEADER_LEN            (8u)
+#define WARM_BOOT_CRC_LEN               (4u)
+
+/* Serialized payload sizes of version 1.0 */
+#define WARM_BOOT_STATS_LEN             (20u)
+#define WARM_BOOT_CONN_LEN              (58u)
+#define WARM_BOOT_TWT_LEN               (8u)
+#define WARM_BOOT_PAYLOAD_LEN           (WARM_BOOT_STATS_LEN + WARM_BOOT_CONN_LEN + WARM_BOOT_TWT_LEN)
+
+#if ((WARM_BOOT_HEADER_LEN + WARM_BOOT_PAYLOAD_LEN + WARM_BOOT_CRC_LEN) > WARM_BOOT_BLOB_SIZE)
+#error "WARM_BOOT_BLOB_SIZE is too small for the warm-boot payload"
+#endif
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int warm_boot_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Not zeroed by the startup code, hence survives watchdog and software resets */
+CY_NOINIT static uint8_t warm_boot_retention[WARM_BOOT_BLOB_SIZE];
+
+static warm_boot_state_t warm_boot_state;
+static bool warm_boot_warm;
+
+/* Set by "warm_boot clear": nothing is written back until the next reset */
+static bool warm_boot_cleared;
+
+/* Commits started and the last one written to retention RAM, so that a
+ * commit preempted while serializing does not overwrite a newer one */
+static uint32_t warm_boot_commit_seq;
+static uint32_t warm_boot_written_seq;
+
+#define WARM_BOOT_COMMANDS \
+    { (char *) "warm_boot", warm_boot_command, 0, NULL, NULL, (char *) "[clear]", (char *) "Show or clear the warm-boot state kept in retention RAM" }, \
+
+const cy_command_console_cmd_t warm_boot_commands_table[] =
+{
+    WARM_BOOT_COMMANDS
+    CMD_TABLE_END
+};
+#endif /* !defined(__linux__) */
+
+
+/* CRC-32 of every byte value, reflected polynomial 0xEDB88320 */
+static const uint32_t warm_boot_crc32_table[256] =
+{
+    0x00000000UL, 0x77073096UL, 0xEE0E612CUL, 0x990951BAUL, 0x076DC419UL, 0x706AF48FUL,
+    0xE963A535UL, 0x9E6495A3UL, 0x0EDB8832UL, 0x79DCB8A4UL, 0xE0D5E91EUL, 0x97D2D988UL,
+    0x09B64C2BUL, 0x7EB17CBDUL, 0xE7B82D07UL, 0x90BF1D91UL, 0x1DB71064UL, 0x6AB020F2UL,
+    0xF3B97148UL, 0x84BE41DEUL, 0x1ADAD47DUL, 0x6DDDE4EBUL, 0xF4D4B551UL, 0x83D385C7UL,
+    0x136C9856UL, 0x646BA8C0UL, 0xFD62F97AUL, 0x8A65C9ECUL, 0x14015C4FUL, 0x63066CD9UL,
+    0xFA0F3D63UL, 0x8D080DF5UL, 0x3B6E20C8UL, 0x4C69105EUL, 0xD56041E4UL, 0xA2677172UL,
+    0x3C03E4D1UL, 0x4B04D447UL, 0xD20D85FDUL, 0xA50AB56BUL, 0x35B5A8FAUL, 0x42B2986CUL,
+    0xDBBBC9D6UL, 0xACBCF940UL, 0x32D86CE3UL, 0x45DF5C75UL, 0xDCD60DCFUL, 0xABD13D59UL,
+    0x26D930ACUL, 0x51DE003AUL, 0xC8D75180UL, 0xBFD06116UL, 0x21B4F4B5UL, 0x56B3C423UL,
+    0xCFBA9599UL, 0xB8BDA50FUL, 0x2802B89EUL, 0x5F058808UL, 0xC60CD9B2UL, 0xB10BE924UL,
+    0x2F6F7C87UL, 0x58684C11UL, 0xC1611DABUL, 0xB6662D3DUL, 0x76DC4190UL, 0x01DB7106UL,
+    0x98D220BCUL, 0xEFD5102AUL, 0x71B18589UL, 0x06B6B51FUL, 0x9FBFE4A5UL, 0xE8B8D433UL,
+    0x7807C9A2UL, 0x0F00F934UL, 0x9609A88EUL, 0xE10E9818UL, 0x7F6A0DBBUL, 0x086D3D2DUL,
+    0x91646C97UL, 0xE6635C01UL, 0x6B6B51F4UL, 0x1C6C6162UL, 0x856530D8UL, 0xF262004EUL,
+    0x6C0695EDUL, 0x1B01A57BUL, 0x8208F4C1UL, 0xF50FC457UL, 0x65B0D9C6UL, 0x12B7E950UL,
+    0x8BBEB8EAUL, 0xFCB9887CUL, 0x62DD1DDFUL, 0x15DA2D49UL, 0x8CD37CF3UL, 0xFBD44C65UL,
+    0x4DB26158UL, 0x3AB551CEUL, 0xA3BC0074UL, 0xD4BB30E2UL, 0x4ADFA541UL, 0x3DD895D7UL,
+    0xA4D1C46DUL, 0xD3D6F4FBUL, 0x4369E96AUL, 0x346ED9FCUL, 0xAD678846UL, 0xDA60B8D0UL,
+    0x44042D73UL, 0x33031DE5UL, 0xAA0A4C5FUL, 0xDD0D7CC9UL, 0x5005713CUL, 0x270241AAUL,
+    0xBE0B1010UL, 0xC90C2086UL, 0x5768B525UL, 0x206F85B3UL, 0xB966D409UL, 0xCE61E49FUL,
+    0x5EDEF90EUL, 0x29D9C998UL, 0xB0D09822UL, 0xC7D7A8B4UL, 0x59B33D17UL, 0x2EB40D81UL,
+    0xB7BD5C3BUL, 0xC0BA6CADUL, 0xEDB88320UL, 0x9ABFB3B6UL, 0x03B6E20CUL, 0x74B1D29AUL,
+    0xEAD54739UL, 0x9DD277AFUL, 0x04DB2615UL, 0x73DC1683UL, 0xE3630B12UL, 0x94643B84UL,
+    0x0D6D6A3EUL, 0x7A6A5AA8UL, 0xE40ECF0BUL, 0x9309FF9DUL, 0x0A00AE27UL, 0x7D079EB1UL,
+    0xF00F9344UL, 0x8708A3D2UL, 0x1E01F268UL, 0x6906C2FEUL, 0xF762575DUL, 0x806567CBUL,
+    0x196C3671UL, 0x6E6B06E7UL, 0xFED41B76UL, 0x89D32BE0UL, 0x10DA7A5AUL, 0x67DD4ACCUL,
+    0xF9B9DF6FUL, 0x8EBEEFF9UL, 0x17B7BE43UL, 0x60B08ED5UL, 0xD6D6A3E8UL, 0xA1D1937EUL,
+    0x38D8C2C4UL, 0x4FDFF252UL, 0xD1BB67F1UL, 0xA6BC5767UL, 0x3FB506DDUL, 0x48B2364BUL,
+    0xD80D2BDAUL, 0xAF0A1B4CUL, 0x36034AF6UL, 0x41047A60UL, 0xDF60EFC3UL, 0xA867DF55UL,
+    0x316E8EEFUL, 0x4669BE79UL, 0xCB61B38CUL, 0xBC66831AUL, 0x256FD2A0UL, 0x5268E236UL,
+    0xCC0C7795UL, 0xBB0B4703UL, 0x220216B9UL, 0x5505262FUL, 0xC5BA3BBEUL, 0xB2BD0B28UL,
+    0x2BB45A92UL, 0x5CB36A04UL, 0xC2D7FFA7UL, 0xB5D0CF31UL, 0x2CD99E8BUL, 0x5BDEAE1DUL,
+    0x9B64C2B0UL, 0xEC63F226UL, 0x756AA39CUL, 0x026D930AUL, 0x9C0906A9UL, 0xEB0E363FUL,
+    0x72076785UL, 0x05005713UL, 0x95BF4A82UL, 0xE2B87A14UL, 0x7BB12BAEUL, 0x0CB61B38UL,
+    0x92D28E9BUL, 0xE5D5BE0DUL, 0x7CDCEFB7UL, 0x0BDBDF21UL, 0x86D3D2D4UL, 0xF1D4E242UL,
+    0x68DDB3F8UL, 0x1FDA836EUL, 0x81BE16CDUL, 0xF6B9265BUL, 0x6FB077E1UL, 0x18B74777UL,
+    0x88085AE6UL, 0xFF0F6A70UL, 0x66063BCAUL, 0x11010B5CUL, 0x8F659EFFUL, 0xF862AE69UL,
+    0x616BFFD3UL, 0x166CCF45UL, 0xA00AE278UL, 0xD70DD2EEUL, 0x4E048354UL, 0x3903B3C2UL,
+    0xA7672661UL, 0xD06016F7UL, 0x4969474DUL, 0x3E6E77DBUL, 0xAED16A4AUL, 0xD9D65ADCUL,
+    0x40DF0B66UL, 0x37D83BF0UL, 0xA9BCAE53UL, 0xDEBB9EC5UL, 0x47B2CF7FUL, 0x30B5FFE9UL,
+    0xBDBDF21CUL, 0xCABAC28AUL, 0x53B39330UL, 0x24B4A3A6UL, 0xBAD03605UL, 0xCDD70693UL,
+    0x54DE5729UL, 0x23D967BFUL, 0xB3667A2EUL, 0xC4614AB8UL, 0x5D681B02UL, 0x2A6F2B94UL,
+    0xB40BBE37UL, 0xC30C8EA1UL, 0x5A05DF1BUL, 0x2D02EF8DUL
+};
+
+
+/*******************************************************************************
+* Function Name: put_u16 / put_u32 / get_u16 / get_u32
+********************************************************************************
+* Summary:
+* Little-endian helpers so that the serialized format does not depend on the
+* compiler's structure layout.
+*
+*******************************************************************************/
+static uint8_t* put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value);
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+static uint8_t* put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value);
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_crc32
+********************************************************************************
+* Summary:
+* This function computes the IEEE 802.3 CRC-32 of a buffer, one byte per
+* table lookup, as the block is written back every heap statistics update.
+*
+* Parameters:
+*  const uint8_t *data : data to checksum
+*  size_t length       : number of bytes
+*
+* Return:
+*  uint32_t : CRC-32
+*
+*******************************************************************************/
+uint32_t warm_boot_crc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    while(length--)
+    {
+        crc = (crc >> 8) ^ warm_boot_crc32_table[(crc ^ *data++) & 0xFFu];
+    }
+
+    return ~crc;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_serialize
+********************************************************************************
+* Summary:
+* This function serializes the warm-boot state. The layout is:
+*    magic (4) | version major (1) | version minor (1) | payload length (2) |
+*    payload | CRC-32 over header and payload (4)
+* All fields are little-endian.
+*
+* Parameters:
+*  const warm_boot_state_t *state : state to serialize
+*  uint8_t *buffer                : output buffer
+*  size_t length                  : size of output buffer
+*
+* Return:
+*  size_t : number of bytes written, 0 if the buffer is too small
+*
+*******************************************************************************/
+size_t warm_boot_serialize(const warm_boot_state_t *state, uint8_t *buffer, size_t length)
+{
+    const size_t total = WARM_BOOT_HEADER_LEN + WARM_BOOT_PAYLOAD_LEN + WARM_BOOT_CRC_LEN;
+    uint8_t *p = buffer;
+    size_t ssid_len;
+
+    if(length < total)
+    {
+        return 0;
+    }
+
+    memset(buffer, 0, total);
+
+    /* Header */
+    p = put_u32(p, WARM_BOOT_MAGIC);
+    *p++ = WARM_BOOT_VERSION_MAJOR;
+    *p++ = WARM_BOOT_VERSION_MINOR;
+    p = put_u16(p, WARM_BOOT_PAYLOAD_LEN);
+
+    /* Statistics */
+    p = put_u32(p, state->stats.boot_count);
+    p = put_u32(p, state->stats.warm_boot_count);
+    p = put_u32(p, state->stats.last_reset_reason);
+    p = put_u32(p, state->stats.heap_used);
+    p = put_u32(p, state->stats.heap_peak_used);
+
+    /* Connection cache */
+    ssid_len = strnlen(state->conn.ssid, CY_WCM_MAX_SSID_LEN);
+    *p++ = state->conn.valid ? 1u : 0u;
+    *p++ = (uint8_t)state->conn.band;
+    *p++ = state->conn.channel;
+    *p++ = (uint8_t)ssid_len;
+    memcpy(p, state->conn.ssid, ssid_len);
+    p += CY_WCM_MAX_SSID_LEN;
+    memcpy(p, state->conn.bssid, CY_WCM_MAC_ADDR_LEN);
+    p += CY_WCM_MAC_ADDR_LEN;
+    p = put_u32(p, state->conn.security);
+    p = put_u32(p, state->conn.ip);
+    p = put_u32(p, state->conn.netmask);
+    p = put_u32(p, state->conn.gateway);
+
+    /* iTWT agreement */
+    *p++ = state->twt.active ? 1u : 0u;
+    *p++ = (uint8_t)state->twt.profile;
+    *p++ = state->twt.flow_id;
+    *p++ = state->twt.wi_exponent;
+    p = put_u16(p, state->twt.wi_mantissa);
+    *p++ = state->twt.wd;
+    p++; /* reserved */
+
+    put_u32(p, warm_boot_crc32(buffer, (size_t)(p - buffer)));
+
+    return total;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_deserialize
+********************************************************************************
+* Summary:
+* This function validates and parses a serialized warm-boot block. A block with
+* a different major version is rejected. A block with a newer minor version is
+* accepted as long as it carries at least the fields known to this version;
+* trailing fields are ignored.
+*
+* Parameters:
+*  const uint8_t *buffer    : serialized block
+*  size_t length            : size of the buffer
+*  warm_boot_state_t *state : parsed state, only written on success
+*
+* Return:
+*  warm_boot_status_t : WARM_BOOT_STATUS_OK if the block is valid
+*
+*******************************************************************************/
+warm_boot_status_t warm_boot_deserialize(const uint8_t *buffer, size_t length, warm_boot_state_t *state)
+{
+    const uint8_t *p;
+    uint16_t payload_len;
+    size_t ssid_len;
+    warm_boot_state_t parsed;
+
+    if(length < WARM_BOOT_HEADER_LEN + WARM_BOOT_CRC_LEN)
+    {
+        return WARM_BOOT_STATUS_BAD_LENGTH;
+    }
+
+    if(get_u32(buffer) != WARM_BOOT_MAGIC)
+    {
+        return WARM_BOOT_STATUS_BAD_MAGIC;
+    }
+
+    if(buffer[4] != WARM_BOOT_VERSION_MAJOR)
+    {
+        return WARM_BOOT_STATUS_BAD_VERSION;
+    }
+
+    payload_len = get_u16(&buffer[6]);
+    if((payload_len < WARM_BOOT_PAYLOAD_LEN) ||
+       ((size_t)payload_len > length - WARM_BOOT_HEADER_LEN - WARM_BOOT_CRC_LEN))
+    {
+        return WARM_BOOT_STATUS_BAD_LENGTH;
+    }
+
+    if(warm_boot_crc32(buffer, WARM_BOOT_HEADER_LEN + payload_len) !=
+       get_u32(&buffer[WARM_BOOT_HEADER_LEN + payload_len]))
+    {
+        return WARM_BOOT_STATUS_BAD_CRC;
+    }
+
+    memset(&parsed, 0, sizeof(parsed));
+    p = &buffer[WARM_BOOT_HEADER_LEN];
+
+    parsed.stats.boot_count        = get_u32(p);      p += 4;
+    parsed.stats.warm_boot_count   = get_u32(p);      p += 4;
+    parsed.stats.last_reset_reason = get_u32(p);      p += 4;
+    parsed.stats.heap_used         = get_u32(p);      p += 4;
+    parsed.stats.heap_peak_used    = get_u32(p);      p += 4;
+
+    parsed.conn.valid   = (p[0] != 0u);
+    parsed.conn.band    = (cy_wcm_wifi_band_t)p[1];
+    parsed.conn.channel = p[2];
+    ssid_len            = (p[3] > CY_WCM_MAX_SSID_LEN) ? CY_WCM_MAX_SSID_LEN : p[3];
+    p += 4;
+    memcpy(parsed.conn.ssid, p, ssid_len);
+    parsed.conn.ssid[ssid_len] = '\0';
+    p += CY_WCM_MAX_SSID_LEN;
+    memcpy(parsed.conn.bssid, p, CY_WCM_MAC_ADDR_LEN);
+    p += CY_WCM_MAC_ADDR_LEN;
+    parsed.conn.security = get_u32(p);             p += 4;
+    parsed.conn.ip       = get_u32(p);             p += 4;
+    parsed.conn.netmask  = get_u32(p);             p += 4;
+    parsed.conn.gateway  = get_u32(p);             p += 4;
+
+    parsed.twt.active      = (p[0] != 0u);
+    parsed.twt.profile     = (cy_wcm_itwt_profile_t)p[1];
+    parsed.twt.flow_id     = p[2];
+    parsed.twt.wi_exponent = p[3];
+    parsed.twt.wi_mantissa = get_u16(&p[4]);
+    parsed.twt.wd          = p[6];
+
+    *state = parsed;
+
+    return WARM_BOOT_STATUS_OK;
+}
+
+
+#if !defined(__linux__)
+/*******************************************************************************
+* Function Name: warm_boot_commit
+********************************************************************************
+* Summary:
+* This function writes the in-memory state back to retention RAM, unless the
+* block was cleared for this boot. The block is serialized and checksummed
+* outside the critical section; only the copy into retention RAM runs with
+* interrupts disabled, so that the block is never seen half written.
+*
+*******************************************************************************/
+static void warm_boot_commit(void)
+{
+    uint8_t block[WARM_BOOT_BLOB_SIZE];
+    uint32_t seq;
+    size_t length;
+    uint32_t state;
+
+    state = cyhal_system_critical_section_enter();
+    seq = ++warm_boot_commit_seq;
+    cyhal_system_critical_section_exit(state);
+
+    length = warm_boot_serialize(&warm_boot_state, block, sizeof(block));
+
+    state = cyhal_system_critical_section_enter();
+    if(!warm_boot_cleared && (length != 0u) && ((int32_t)(seq - warm_boot_written_seq) > 0))
+    {
+        memcpy(warm_boot_retention, block, length);
+        warm_boot_written_seq = seq;
+    }
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_init
+********************************************************************************
+* Summary:
+* This function validates the retention block left by the previous boot. On a
+* cold boot (power-on, or the block is corrupt) the state starts from scratch.
+* In both cases the boot counters are updated and the block is rewritten.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  bool : true if valid state was carried over from the previous boot
+*
+*******************************************************************************/
+bool warm_boot_init(void)
+{
+    warm_boot_status_t status;
+
+    status = warm_boot_deserialize(warm_boot_retention, sizeof(warm_boot_retention), &warm_boot_state);
+    warm_boot_warm = (status == WARM_BOOT_STATUS_OK);
+
+    if(!warm_boot_warm)
+    {
+        memset(&warm_boot_state, 0, sizeof(warm_boot_state));
+    }
+    else
+    {
+        warm_boot_state.stats.warm_boot_count++;
+    }
+
+    warm_boot_state.stats.boot_count++;
+    warm_boot_state.stats.last_reset_reason = cyhal_system_get_reset_reason();
+    cyhal_system_clear_reset_reason();
+
+    warm_boot_commit();
+
+    return warm_boot_warm;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_is_warm
+********************************************************************************
+* Summary:
+* This function tells whether state was carried over from the previous boot.
+*
+*******************************************************************************/
+bool warm_boot_is_warm(void)
+{
+    return warm_boot_warm;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_get_conn_cache
+********************************************************************************
+* Summary:
+* This function returns the cached connection parameters if they were saved
+* for the given SSID.
+*
+* Parameters:
+*  const char *ssid               : SSID about to be joined
+*  warm_boot_conn_cache_t *cache  : buffer for the cached parameters
+*
+* Return:
+*  bool : true if a valid cache entry exists for the SSID
+*
+*******************************************************************************/
+bool warm_boot_get_conn_cache(const char *ssid, warm_boot_conn_cache_t *cache)
+{
+    if(!warm_boot_state.conn.valid || (strcmp(warm_boot_state.conn.ssid, ssid) != 0))
+    {
+        return false;
+    }
+
+    *cache = warm_boot_state.conn;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_get_twt
+********************************************************************************
+* Summary:
+* This function returns the iTWT agreement saved in the warm-boot block.
+*
+*******************************************************************************/
+void warm_boot_get_twt(twt_session_agreement_t *agreement)
+{
+    *agreement = warm_boot_state.twt;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_save_connection
+********************************************************************************
+* Summary:
+* This function caches the parameters of the current association.
+*
+* Parameters:
+*  const char *ssid                     : SSID that was joined
+*  uint32_t security                    : security type used for the join
+*  const cy_wcm_ip_address_t *ip_addr   : IP address assigned by DHCP
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void warm_boot_save_connection(const char *ssid, uint32_t security, const cy_wcm_ip_address_t *ip_addr)
+{
+    cy_wcm_associated_ap_info_t ap_info;
+    cy_wcm_ip_address_t addr;
+    warm_boot_conn_cache_t *conn = &warm_boot_state.conn;
+
+    if(cy_wcm_get_associated_ap_info(&ap_info) != CY_RSLT_SUCCESS)
+    {
+        warm_boot_invalidate_connection();
+        return;
+    }
+
+    memset(conn, 0, sizeof(*conn));
+    strncpy(conn->ssid, ssid, CY_WCM_MAX_SSID_LEN);
+    memcpy(conn->bssid, ap_info.BSSID, CY_WCM_MAC_ADDR_LEN);
+    conn->channel  = ap_info.channel;
+    conn->band     = (ap_info.channel > 14u) ? CY_WCM_WIFI_BAND_5GHZ : CY_WCM_WIFI_BAND_2_4GHZ;
+    conn->security = security;
+    conn->ip       = ip_addr->ip.v4;
+
+    if(cy_wcm_get_ip_netmask(CY_WCM_INTERFACE_TYPE_STA, &addr) == CY_RSLT_SUCCESS)
+    {
+        conn->netmask = addr.ip.v4;
+    }
+    if(cy_wcm_get_gateway_ip_address(CY_WCM_INTERFACE_TYPE_STA, &addr) == CY_RSLT_SUCCESS)
+    {
+        conn->gateway = addr.ip.v4;
+    }
+
+    conn->valid = true;
+
+    warm_boot_commit();
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_invalidate_connection
+********************************************************************************
+* Summary:
+* This function drops the connection cache, e.g. when a join using the cached
+* BSSID failed.
+*
+*******************************************************************************/
+void warm_boot_invalidate_connection(void)
+{
+    memset(&warm_boot_state.conn, 0, sizeof(warm_boot_state.conn));
+    warm_boot_commit();
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_save_twt
+********************************************************************************
+* Summary:
+* This function stores the iTWT agreement currently tracked by twt_session.
+*
+*******************************************************************************/
+void warm_boot_save_twt(void)
+{
+    twt_session_get(&warm_boot_state.twt);
+    warm_boot_commit();
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_update_heap_stats
+********************************************************************************
+* Summary:
+* This function samples heap usage and records the high-water mark so that
+* it can be inspected after an unexpected reset.
+*
+*******************************************************************************/
+void warm_boot_update_heap_stats(void)
+{
+    struct mallinfo info = mallinfo();
+    uint32_t used = (uint32_t)info.uordblks;
+
+    warm_boot_state.stats.heap_used = used;
+    if(used > warm_boot_state.stats.heap_peak_used)
+    {
+        warm_boot_state.stats.heap_peak_used = used;
+    }
+
+    warm_boot_commit();
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_command
+********************************************************************************
+* Summary:
+* This function prints the warm-boot state, or clears it with "clear" so that
+* the next reset behaves as a cold boot.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int warm_boot_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    const warm_boot_conn_cache_t *conn = &warm_boot_state.conn;
+    const twt_session_agreement_t *twt = &warm_boot_state.twt;
+
+    if((argc > 1) && !strcmp(argv[1], "clear"))
+    {
+        /* Also stop the periodic heap statistics update from writing the
+         * in-memory state back */
+        uint32_t state = cyhal_system_critical_section_enter();
+        memset(&warm_boot_state, 0, sizeof(warm_boot_state));
+        memset(warm_boot_retention, 0, sizeof(warm_boot_retention));
+        warm_boot_warm = false;
+        warm_boot_cleared = true;
+        cyhal_system_critical_section_exit(state);
+        printf("Warm-boot state cleared. Next reset is a cold boot.\n");
+        return 0;
+    }
+
+    printf("Boot            : %s\n", warm_boot_warm ? "warm" : "cold");
+    printf("Boot count      : %" PRIu32 " (warm: %" PRIu32 ")\n",
+           warm_boot_state.stats.boot_count, warm_boot_state.stats.warm_boot_count);
+    printf("Reset reason    : 0x%08" PRIx32 "\n", warm_boot_state.stats.last_reset_reason);
+    printf("Heap used       : %" PRIu32 " bytes (peak: %" PRIu32 ")\n",
+           warm_boot_state.stats.heap_used, warm_boot_state.stats.heap_peak_used);
+
+    if(conn->valid)
+    {
+        printf("Cached AP       : '%s' %02X:%02X:%02X:%02X:%02X:%02X channel %u\n", conn->ssid,
+               conn->bssid[0], conn->bssid[1], conn->bssid[2],
+               conn->bssid[3], conn->bssid[4], conn->bssid[5], conn->channel);
+    }
+    else
+    {
+        printf("Cached AP       : none\n");
+    }
+
+    if(twt->active)
+    {
+        printf("Cached iTWT     : %s, WI %" PRIu32 " us, WD %" PRIu32 " us\n",
+               (twt->profile == CY_WCM_ITWT_PROFILE_ACTIVE) ? "active" : "idle",
+               twt_session_wake_interval_us(twt), twt_session_wake_duration_us(twt));
+    }
+    else
+    {
+        printf("Cached iTWT     : none\n");
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: warm_boot_add_commands
+********************************************************************************
+* Summary:
+* This function registers the warm-boot commands table.
+*
+*******************************************************************************/
+cy_rslt_t warm_boot_add_commands(void)
+{
+    return cy_command_console_add_table(warm_boot_commands_table);
+}
+#endif /* !defined(__linux__) */
+
+
+/* [] END OF FILE */
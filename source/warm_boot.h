@@ -0,0 +1,145 @@
+/******************************************************************************
+* File Name:   warm_boot.h
+*
+* Description: This file contains the declarations for the warm-boot state
+*              block kept in retention RAM across watchdog and software resets.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef WARM_BOOT_H_
+#define WARM_BOOT_H_
+
+#if !defined(__linux__)
+#include "cy_result.h"
+#include "cy_wcm.h"
+#endif
+#include "twt_session.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+/* Host builds (tools/warm_boot_host.c): the WCM types of the connection cache */
+#define CY_WCM_MAX_SSID_LEN             (32u)
+#define CY_WCM_MAC_ADDR_LEN             (6u)
+typedef uint8_t cy_wcm_mac_t[CY_WCM_MAC_ADDR_LEN];
+typedef enum { CY_WCM_WIFI_BAND_ANY = 0, CY_WCM_WIFI_BAND_5GHZ, CY_WCM_WIFI_BAND_2_4GHZ } cy_wcm_wifi_band_t;
+#endif
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define WARM_BOOT_MAGIC                 (0x54534257UL)  /* "WBST" */
+#define WARM_BOOT_VERSION_MAJOR         (1u)
+#define WARM_BOOT_VERSION_MINOR         (0u)
+
+/* Size of the retention RAM block, including header and CRC */
+#define WARM_BOOT_BLOB_SIZE             (128u)
+
+/* Set to 1 to reuse the cached IP configuration and skip DHCP on a warm boot.
+ * Only enable this when the DHCP server hands out stable leases. */
+#ifndef WARM_BOOT_REUSE_IP
+#define WARM_BOOT_REUSE_IP              (0)
+#endif
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    WARM_BOOT_STATUS_OK = 0,
+    WARM_BOOT_STATUS_BAD_MAGIC,
+    WARM_BOOT_STATUS_BAD_VERSION,
+    WARM_BOOT_STATUS_BAD_LENGTH,
+    WARM_BOOT_STATUS_BAD_CRC
+} warm_boot_status_t;
+
+typedef struct
+{
+    bool               valid;
+    char               ssid[CY_WCM_MAX_SSID_LEN + 1];
+    cy_wcm_mac_t       bssid;
+    cy_wcm_wifi_band_t band;
+    uint8_t            channel;
+    uint32_t           security;
+    uint32_t           ip;
+    uint32_t           netmask;
+    uint32_t           gateway;
+} warm_boot_conn_cache_t;
+
+typedef struct
+{
+    uint32_t boot_count;
+    uint32_t warm_boot_count;
+    uint32_t last_reset_reason;
+    uint32_t heap_used;
+    uint32_t heap_peak_used;
+} warm_boot_stats_t;
+
+typedef struct
+{
+    warm_boot_stats_t       stats;
+    warm_boot_conn_cache_t  conn;
+    twt_session_agreement_t twt;
+} warm_boot_state_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+size_t warm_boot_serialize(const warm_boot_state_t *state, uint8_t *buffer, size_t length);
+warm_boot_status_t warm_boot_deserialize(const uint8_t *buffer, size_t length, warm_boot_state_t *state);
+uint32_t warm_boot_crc32(const uint8_t *data, size_t length);
+
+#if !defined(__linux__)
+bool warm_boot_init(void);
+bool warm_boot_is_warm(void);
+bool warm_boot_get_conn_cache(const char *ssid, warm_boot_conn_cache_t *cache);
+void warm_boot_get_twt(twt_session_agreement_t *agreement);
+void warm_boot_save_connection(const char *ssid, uint32_t security, const cy_wcm_ip_address_t *ip_addr);
+void warm_boot_invalidate_connection(void);
+void warm_boot_save_twt(void);
+void warm_boot_update_heap_stats(void);
+cy_rslt_t warm_boot_add_commands(void);
+#endif
+
+#endif /* WARM_BOOT_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,689 @@
+/******************************************************************************
+* File Name:   whd_prof.c
+*
+* Description: This file implements the latency profiler of the WHD ioctls
+*              and iovars. Each call crosses to the WLAN core and waits for
+*              its reply; its duration is recorded per command (ioctl number
+*              or iovar name) as a count, average, maximum and a log2
+*              histogram.
+*
+*              Calls of the application are profiled through the whd_prof_*()
+*              wrappers. Building with WHD_PROFILE=1 also wraps the generic
+*              WHD ioctl/iovar functions and the TWT teardown at link time,
+*              so that the calls of WCM and the other libraries are profiled
+*              as well.
+*
+*              whd_prof_batch() runs several requests back to back. The
+*              firmware interface has no multi-iovar transaction, so a batch
+*              still costs one round trip per request, but a GET that repeats
+*              an earlier one of the batch is answered from it instead.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "whd_prof.h"
+#include "cycle_counter.h"
+
+#include "cyhal.h"
+#include "command_console.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#if defined(WHD_PROFILE_WRAP)
+#define WHD_PROF_REAL(sym)              __real_##sym
+#else
+#define WHD_PROF_REAL(sym)              sym
+#endif
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    char     name[WHD_PROF_NAME_LEN];
+    uint32_t calls;
+    uint32_t errors;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t buckets[WHD_PROF_BUCKETS];
+} whd_prof_entry_t;
+
+typedef struct
+{
+    uint32_t    ioctl;
+    const char *name;
+} whd_prof_ioctl_name_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int whd_prof_command(int argc, char* argv[], tlv_buffer_t** data);
+
+#if defined(WHD_PROFILE_WRAP)
+whd_result_t __real_whd_wifi_get_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t *value);
+whd_result_t __real_whd_wifi_set_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t value);
+whd_result_t __real_whd_wifi_get_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, uint8_t *buffer, uint16_t len);
+whd_result_t __real_whd_wifi_set_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, void *buffer, uint16_t len);
+whd_result_t __real_whd_wifi_get_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t *value);
+whd_result_t __real_whd_wifi_set_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t value);
+whd_result_t __real_whd_wifi_get_iovar_buffer(whd_interface_t ifp, const char *iovar, uint8_t *buffer, uint16_t len);
+whd_result_t __real_whd_wifi_set_iovar_buffer(whd_interface_t ifp, const char *iovar, void *buffer, uint16_t len);
+whd_result_t __real_whd_wifi_twt_setup(whd_interface_t ifp, whd_twt_setup_params_t *params);
+whd_result_t __real_whd_wifi_twt_teardown(whd_interface_t ifp, whd_twt_teardown_params_t *params);
+#endif
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const whd_prof_ioctl_name_t whd_prof_ioctl_names[] =
+{
+    { WLC_GET_RATE,    "WLC_GET_RATE" },
+    { WLC_GET_PM,      "WLC_GET_PM" },
+    { WLC_SET_PM,      "WLC_SET_PM" },
+    { WLC_GET_BCNPRD,  "WLC_GET_BCNPRD" },
+    { WLC_GET_DTIMPRD, "WLC_GET_DTIMPRD" },
+    { WLC_GET_RSSI,    "WLC_GET_RSSI" },
+    { WLC_GET_PKTCNTS, "WLC_GET_PKTCNTS" },
+};
+
+static whd_prof_entry_t whd_prof_entries[WHD_PROF_MAX_COMMANDS];
+static uint32_t whd_prof_count;
+static uint32_t whd_prof_dropped;
+static bool whd_prof_initialized;
+
+static uint32_t whd_prof_batches;
+static uint32_t whd_prof_batch_requests;
+static uint32_t whd_prof_batch_coalesced;
+static uint64_t whd_prof_batch_total_us;
+
+#define WHD_PROF_COMMANDS \
+    { (char *) "whd_prof", whd_prof_command, 0, NULL, NULL, (char *) "[reset]", (char *) "Show the latency of the WHD ioctls and iovars" }, \
+
+const cy_command_console_cmd_t whd_prof_commands_table[] =
+{
+    WHD_PROF_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: whd_prof_begin
+********************************************************************************
+* Summary:
+* This function starts the measurement of a WHD call.
+*
+* Return:
+*  uint32_t : cycle count to pass to whd_prof_end()
+*
+*******************************************************************************/
+uint32_t whd_prof_begin(void)
+{
+    if(!whd_prof_initialized)
+    {
+        cycle_counter_init();
+        whd_prof_initialized = true;
+    }
+
+    return cycle_counter_get();
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_end
+********************************************************************************
+* Summary:
+* This function records the latency of a WHD call under 'name'.
+*
+* Parameters:
+*  const char *name    : command name, truncated to WHD_PROF_NAME_LEN - 1
+*  uint32_t begin      : value returned by whd_prof_begin()
+*  whd_result_t result : result of the call
+*
+*******************************************************************************/
+void whd_prof_end(const char *name, uint32_t begin, whd_result_t result)
+{
+    uint32_t us = (uint32_t)(cycle_counter_to_ns(cycle_counter_get() - begin) / 1000u);
+    whd_prof_entry_t *entry = NULL;
+    uint32_t bucket = 0;
+    uint32_t state;
+
+    while((bucket < WHD_PROF_BUCKETS - 1u) && (us >= (WHD_PROF_BUCKET0_US << bucket)))
+    {
+        bucket++;
+    }
+
+    state = cyhal_system_critical_section_enter();
+
+    for(uint32_t i = 0; i < whd_prof_count; i++)
+    {
+        if(!strncmp(whd_prof_entries[i].name, name, WHD_PROF_NAME_LEN - 1u))
+        {
+            entry = &whd_prof_entries[i];
+            break;
+        }
+    }
+
+    if((entry == NULL) && (whd_prof_count < WHD_PROF_MAX_COMMANDS))
+    {
+        entry = &whd_prof_entries[whd_prof_count++];
+        strncpy(entry->name, name, WHD_PROF_NAME_LEN - 1u);
+    }
+
+    if(entry == NULL)
+    {
+        whd_prof_dropped++;
+    }
+    else
+    {
+        entry->calls++;
+        entry->errors += (result != WHD_SUCCESS) ? 1u : 0u;
+        entry->total_us += us;
+        entry->max_us = (us > entry->max_us) ? us : entry->max_us;
+        entry->buckets[bucket]++;
+    }
+
+    cyhal_system_critical_section_exit(state);
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_ioctl_name
+********************************************************************************
+* Summary:
+* Formats the name under which an ioctl is recorded.
+*
+*******************************************************************************/
+static const char *whd_prof_ioctl_name(char *buffer, bool set, uint32_t ioctl)
+{
+    for(uint32_t i = 0; i < sizeof(whd_prof_ioctl_names) / sizeof(whd_prof_ioctl_names[0]); i++)
+    {
+        if(whd_prof_ioctl_names[i].ioctl == ioctl)
+        {
+            return whd_prof_ioctl_names[i].name;
+        }
+    }
+
+    snprintf(buffer, WHD_PROF_NAME_LEN, "ioctl %s %" PRIu32, set ? "set" : "get", ioctl);
+    return buffer;
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_iovar_name
+********************************************************************************
+* Summary:
+* Formats the name under which an iovar is recorded.
+*
+*******************************************************************************/
+static const char *whd_prof_iovar_name(char *buffer, bool set, const char *iovar)
+{
+    snprintf(buffer, WHD_PROF_NAME_LEN, "%s %s", set ? "set" : "get", iovar);
+    return buffer;
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_get_ioctl_value ... whd_prof_twt_teardown
+********************************************************************************
+* Summary:
+* Profiled replacements of the WHD functions of the same name.
+*
+*******************************************************************************/
+whd_result_t whd_prof_get_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t *value)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_get_ioctl_value)(ifp, ioctl, value);
+
+    whd_prof_end(whd_prof_ioctl_name(name, false, ioctl), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_set_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t value)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_set_ioctl_value)(ifp, ioctl, value);
+
+    whd_prof_end(whd_prof_ioctl_name(name, true, ioctl), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_get_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, uint8_t *buffer, uint16_t len)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_get_ioctl_buffer)(ifp, ioctl, buffer, len);
+
+    whd_prof_end(whd_prof_ioctl_name(name, false, ioctl), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_set_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, void *buffer, uint16_t len)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_set_ioctl_buffer)(ifp, ioctl, buffer, len);
+
+    whd_prof_end(whd_prof_ioctl_name(name, true, ioctl), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_get_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t *value)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_get_iovar_value)(ifp, iovar, value);
+
+    whd_prof_end(whd_prof_iovar_name(name, false, iovar), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_set_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t value)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_set_iovar_value)(ifp, iovar, value);
+
+    whd_prof_end(whd_prof_iovar_name(name, true, iovar), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_get_iovar_buffer(whd_interface_t ifp, const char *iovar, uint8_t *buffer, uint16_t len)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_get_iovar_buffer)(ifp, iovar, buffer, len);
+
+    whd_prof_end(whd_prof_iovar_name(name, false, iovar), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_set_iovar_buffer(whd_interface_t ifp, const char *iovar, void *buffer, uint16_t len)
+{
+    char name[WHD_PROF_NAME_LEN];
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_set_iovar_buffer)(ifp, iovar, buffer, len);
+
+    whd_prof_end(whd_prof_iovar_name(name, true, iovar), begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_get_rssi(whd_interface_t ifp, int32_t *rssi_dbm)
+{
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = whd_wifi_get_rssi(ifp, rssi_dbm);
+
+    whd_prof_end("WLC_GET_RSSI", begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_twt_setup(whd_interface_t ifp, whd_twt_setup_params_t *params)
+{
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_twt_setup)(ifp, params);
+
+    whd_prof_end("twt_setup", begin, result);
+    return result;
+}
+
+whd_result_t whd_prof_twt_teardown(whd_interface_t ifp, whd_twt_teardown_params_t *params)
+{
+    uint32_t begin = whd_prof_begin();
+    whd_result_t result = WHD_PROF_REAL(whd_wifi_twt_teardown)(ifp, params);
+
+    whd_prof_end("twt_teardown", begin, result);
+    return result;
+}
+
+
+#if defined(WHD_PROFILE_WRAP)
+/*******************************************************************************
+* Function Name: __wrap_whd_wifi_get_ioctl_value ... __wrap_whd_wifi_twt_teardown
+********************************************************************************
+* Summary:
+* Link-time wrappers of the WHD functions (WHD_PROFILE=1).
+*
+*******************************************************************************/
+whd_result_t __wrap_whd_wifi_get_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t *value)
+{
+    return whd_prof_get_ioctl_value(ifp, ioctl, value);
+}
+
+whd_result_t __wrap_whd_wifi_set_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t value)
+{
+    return whd_prof_set_ioctl_value(ifp, ioctl, value);
+}
+
+whd_result_t __wrap_whd_wifi_get_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, uint8_t *buffer, uint16_t len)
+{
+    return whd_prof_get_ioctl_buffer(ifp, ioctl, buffer, len);
+}
+
+whd_result_t __wrap_whd_wifi_set_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, void *buffer, uint16_t len)
+{
+    return whd_prof_set_ioctl_buffer(ifp, ioctl, buffer, len);
+}
+
+whd_result_t __wrap_whd_wifi_get_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t *value)
+{
+    return whd_prof_get_iovar_value(ifp, iovar, value);
+}
+
+whd_result_t __wrap_whd_wifi_set_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t value)
+{
+    return whd_prof_set_iovar_value(ifp, iovar, value);
+}
+
+whd_result_t __wrap_whd_wifi_get_iovar_buffer(whd_interface_t ifp, const char *iovar, uint8_t *buffer, uint16_t len)
+{
+    return whd_prof_get_iovar_buffer(ifp, iovar, buffer, len);
+}
+
+whd_result_t __wrap_whd_wifi_set_iovar_buffer(whd_interface_t ifp, const char *iovar, void *buffer, uint16_t len)
+{
+    return whd_prof_set_iovar_buffer(ifp, iovar, buffer, len);
+}
+
+whd_result_t __wrap_whd_wifi_twt_setup(whd_interface_t ifp, whd_twt_setup_params_t *params)
+{
+    return whd_prof_twt_setup(ifp, params);
+}
+
+whd_result_t __wrap_whd_wifi_twt_teardown(whd_interface_t ifp, whd_twt_teardown_params_t *params)
+{
+    return whd_prof_twt_teardown(ifp, params);
+}
+#endif /* WHD_PROFILE_WRAP */
+
+
+/*******************************************************************************
+* Function Name: whd_prof_same_target
+********************************************************************************
+* Summary:
+* Returns whether two requests address the same ioctl or iovar.
+*
+*******************************************************************************/
+static bool whd_prof_same_target(const whd_prof_request_t *a, const whd_prof_request_t *b)
+{
+    bool a_ioctl = (a->op == WHD_PROF_GET_IOCTL) || (a->op == WHD_PROF_SET_IOCTL);
+    bool b_ioctl = (b->op == WHD_PROF_GET_IOCTL) || (b->op == WHD_PROF_SET_IOCTL);
+
+    if(a_ioctl != b_ioctl)
+    {
+        return false;
+    }
+
+    return a_ioctl ? (a->ioctl == b->ioctl) : !strcmp(a->iovar, b->iovar);
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_batch
+********************************************************************************
+* Summary:
+* This function runs the requests in order. A GET that repeats an earlier
+* successful GET of the batch, with no SET of the same ioctl or iovar in
+* between, is answered with its data without another round trip.
+*
+* Parameters:
+*  whd_interface_t ifp
+*  whd_prof_request_t *requests : the result of each is filled in
+*  uint32_t count
+*
+* Return:
+*  whd_result_t : WHD_SUCCESS, or the result of the first failed request
+*
+*******************************************************************************/
+whd_result_t whd_prof_batch(whd_interface_t ifp, whd_prof_request_t *requests, uint32_t count)
+{
+    whd_result_t result = WHD_SUCCESS;
+    uint32_t begin = whd_prof_begin();
+    uint32_t coalesced = 0;
+    uint32_t us;
+    uint32_t state;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        whd_prof_request_t *request = &requests[i];
+        const whd_prof_request_t *same = NULL;
+
+        for(uint32_t j = 0; (j < i) && ((request->op == WHD_PROF_GET_IOCTL) || (request->op == WHD_PROF_GET_IOVAR)); j++)
+        {
+            if(!whd_prof_same_target(&requests[j], request))
+            {
+                continue;
+            }
+
+            if(requests[j].op != request->op)
+            {
+                same = NULL;    /* Written since */
+            }
+            else if((requests[j].len == request->len) && (requests[j].result == WHD_SUCCESS))
+            {
+                same = &requests[j];
+            }
+        }
+
+        if(same != NULL)
+        {
+            memcpy(request->buffer, same->buffer, request->len);
+            request->result = WHD_SUCCESS;
+            coalesced++;
+            continue;
+        }
+
+        switch(request->op)
+        {
+            case WHD_PROF_GET_IOCTL:
+                request->result = whd_prof_get_ioctl_buffer(ifp, request->ioctl, request->buffer, request->len);
+                break;
+
+            case WHD_PROF_SET_IOCTL:
+                request->result = whd_prof_set_ioctl_buffer(ifp, request->ioctl, request->buffer, request->len);
+                break;
+
+            case WHD_PROF_GET_IOVAR:
+                request->result = whd_prof_get_iovar_buffer(ifp, request->iovar, request->buffer, request->len);
+                break;
+
+            default:
+                request->result = whd_prof_set_iovar_buffer(ifp, request->iovar, request->buffer, request->len);
+                break;
+        }
+
+        if((request->result != WHD_SUCCESS) && (result == WHD_SUCCESS))
+        {
+            result = request->result;
+        }
+    }
+
+    us = (uint32_t)(cycle_counter_to_ns(cycle_counter_get() - begin) / 1000u);
+
+    state = cyhal_system_critical_section_enter();
+    whd_prof_batches++;
+    whd_prof_batch_requests += count;
+    whd_prof_batch_coalesced += coalesced;
+    whd_prof_batch_total_us += us;
+    cyhal_system_critical_section_exit(state);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_percentile_us
+********************************************************************************
+* Summary:
+* Returns the upper bound of the histogram bucket holding the given
+* percentile, or the maximum for the last bucket.
+*
+*******************************************************************************/
+static uint32_t whd_prof_percentile_us(const whd_prof_entry_t *entry, uint32_t percent)
+{
+    uint32_t target = (entry->calls * percent + 99u) / 100u;
+    uint32_t seen = 0;
+
+    for(uint32_t bucket = 0; bucket < WHD_PROF_BUCKETS - 1u; bucket++)
+    {
+        seen += entry->buckets[bucket];
+        if(seen >= target)
+        {
+            return WHD_PROF_BUCKET0_US << bucket;
+        }
+    }
+
+    return entry->max_us;
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_command
+********************************************************************************
+* Summary:
+* This function prints, per ioctl or iovar, the calls, errors, average,
+* median and 99th percentile (histogram bucket bounds) and maximum latency
+* in microseconds and the non-empty histogram buckets, then the batches.
+* "reset" clears the statistics.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int whd_prof_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    uint32_t state;
+
+    if((argc > 1) && !strcmp(argv[1], "reset"))
+    {
+        state = cyhal_system_critical_section_enter();
+        memset(whd_prof_entries, 0, sizeof(whd_prof_entries));
+        whd_prof_count = 0;
+        whd_prof_dropped = 0;
+        whd_prof_batches = whd_prof_batch_requests = whd_prof_batch_coalesced = 0;
+        whd_prof_batch_total_us = 0;
+        cyhal_system_critical_section_exit(state);
+        return 0;
+    }
+
+#if !defined(WHD_PROFILE_WRAP)
+    printf("Only calls of the application are profiled. Build with WHD_PROFILE=1 to profile the WHD calls of the libraries.\n");
+#endif
+
+    printf("%-23s %7s %5s %7s %7s %7s %7s\n", "command", "calls", "err", "avg us", "p50 <", "p99 <", "max us");
+
+    for(uint32_t i = 0; i < whd_prof_count; i++)
+    {
+        whd_prof_entry_t entry;
+
+        state = cyhal_system_critical_section_enter();
+        entry = whd_prof_entries[i];
+        cyhal_system_critical_section_exit(state);
+
+        if(entry.calls == 0u)
+        {
+            continue;
+        }
+
+        printf("%-23s %7" PRIu32 " %5" PRIu32 " %7" PRIu32 " %7" PRIu32 " %7" PRIu32 " %7" PRIu32 "\n  ", entry.name,
+               entry.calls, entry.errors, (uint32_t)(entry.total_us / entry.calls), whd_prof_percentile_us(&entry, 50u),
+               whd_prof_percentile_us(&entry, 99u), entry.max_us);
+
+        for(uint32_t bucket = 0; bucket < WHD_PROF_BUCKETS; bucket++)
+        {
+            if(entry.buckets[bucket] == 0u)
+            {
+                continue;
+            }
+
+            if(bucket < WHD_PROF_BUCKETS - 1u)
+            {
+                printf(" <%" PRIu32 ":%" PRIu32, WHD_PROF_BUCKET0_US << bucket, entry.buckets[bucket]);
+            }
+            else
+            {
+                printf(" >=%" PRIu32 ":%" PRIu32, WHD_PROF_BUCKET0_US << (bucket - 1u), entry.buckets[bucket]);
+            }
+        }
+        printf("\n");
+    }
+
+    if(whd_prof_dropped != 0u)
+    {
+        printf("%" PRIu32 " calls not recorded: more than %u commands\n", whd_prof_dropped, (unsigned)WHD_PROF_MAX_COMMANDS);
+    }
+
+    if(whd_prof_batches != 0u)
+    {
+        printf("Batches: %" PRIu32 ", %" PRIu32 " requests, %" PRIu32 " answered without a round trip, average %" PRIu32
+               " us per batch\n", whd_prof_batches, whd_prof_batch_requests, whd_prof_batch_coalesced,
+               (uint32_t)(whd_prof_batch_total_us / whd_prof_batches));
+    }
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: whd_prof_add_commands
+********************************************************************************
+* Summary:
+* This function registers the WHD profiler command.
+*
+*******************************************************************************/
+cy_rslt_t whd_prof_add_commands(void)
+{
+    return cy_command_console_add_table(whd_prof_commands_table);
+}
+
+
+/* [] END OF FILE */
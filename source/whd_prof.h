@@ -0,0 +1,117 @@
+/******************************************************************************
+* File Name:   whd_prof.h
+*
+* Description: This file contains the declarations for the latency profiler
+*              of the WHD ioctls and iovars, and for running several of them
+*              as a batch.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef WHD_PROF_H_
+#define WHD_PROF_H_
+
+#include "cy_result.h"
+
+/* WHD header files. */
+#include "whd_wifi_api.h"
+#include "whd_wlioctl.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define WHD_PROF_MAX_COMMANDS           (32u)
+#define WHD_PROF_NAME_LEN               (24u)
+
+/* Latency histogram: bucket 0 below WHD_PROF_BUCKET0_US, each next bucket
+ * twice as wide, the last one unbounded */
+#define WHD_PROF_BUCKETS                (12u)
+#define WHD_PROF_BUCKET0_US             (32u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    WHD_PROF_GET_IOCTL = 0,
+    WHD_PROF_SET_IOCTL,
+    WHD_PROF_GET_IOVAR,
+    WHD_PROF_SET_IOVAR
+} whd_prof_op_t;
+
+/* One request of a batch; values are read and written as 4-byte buffers */
+typedef struct
+{
+    whd_prof_op_t op;
+    uint32_t      ioctl;        /* WHD_PROF_GET_IOCTL, WHD_PROF_SET_IOCTL */
+    const char   *iovar;        /* WHD_PROF_GET_IOVAR, WHD_PROF_SET_IOVAR */
+    uint8_t      *buffer;
+    uint16_t      len;
+    whd_result_t  result;
+} whd_prof_request_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+whd_result_t whd_prof_get_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t *value);
+whd_result_t whd_prof_set_ioctl_value(whd_interface_t ifp, uint32_t ioctl, uint32_t value);
+whd_result_t whd_prof_get_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, uint8_t *buffer, uint16_t len);
+whd_result_t whd_prof_set_ioctl_buffer(whd_interface_t ifp, uint32_t ioctl, void *buffer, uint16_t len);
+whd_result_t whd_prof_get_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t *value);
+whd_result_t whd_prof_set_iovar_value(whd_interface_t ifp, const char *iovar, uint32_t value);
+whd_result_t whd_prof_get_iovar_buffer(whd_interface_t ifp, const char *iovar, uint8_t *buffer, uint16_t len);
+whd_result_t whd_prof_set_iovar_buffer(whd_interface_t ifp, const char *iovar, void *buffer, uint16_t len);
+whd_result_t whd_prof_get_rssi(whd_interface_t ifp, int32_t *rssi_dbm);
+whd_result_t whd_prof_twt_setup(whd_interface_t ifp, whd_twt_setup_params_t *params);
+whd_result_t whd_prof_twt_teardown(whd_interface_t ifp, whd_twt_teardown_params_t *params);
+
+/* Profiles a WHD call that has no wrapper */
+uint32_t whd_prof_begin(void);
+void whd_prof_end(const char *name, uint32_t begin, whd_result_t result);
+
+whd_result_t whd_prof_batch(whd_interface_t ifp, whd_prof_request_t *requests, uint32_t count);
+
+cy_rslt_t whd_prof_add_commands(void);
+
+#endif /* WHD_PROF_H_ */
+
+/* [] END OF FILE */
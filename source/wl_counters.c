@@ -0,0 +1,679 @@
+/******************************************************************************
+* File Name:   wl_counters.c
+*
+* Description: This file implements the WLAN link-layer counters. The MAC
+*              counters come from the "counters" iovar (the wl_cnt_wlc_t
+*              block of the XTLV format), with the TX/RX totals of the
+*              connection manager as a fallback on firmware using the older
+*              layouts; the per-AC counters come from the "wme_counters"
+*              iovar. 'wl_counters' prints the deltas since the previous call.
+*              The background sampler keeps the deltas of every period in a
+*              ring, and counts the frames sent at each TX rate.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "wl_counters.h"
+#include "link_monitor.h"
+#include "lock_prof.h"
+#include "whd_prof.h"
+
+#include "cyabs_rtos.h"
+#include "cyhal.h"
+#include "command_console.h"
+
+/* Wi-Fi connection manager header file. */
+#include "cy_wcm.h"
+#include "whd_wlioctl.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define WL_COUNTERS_THREAD_STACK        (2048u)
+#define WL_COUNTERS_BUFFER_LEN          (2048u)
+
+/* Version of the XTLV "counters" layout, and ID of the wl_cnt_wlc_t block */
+#define WL_COUNTERS_XTLV_VERSION        (30u)
+#define WL_COUNTERS_XTLV_WLC            (0x100u)
+
+/* Word offsets in wl_cnt_wlc_t */
+#define WL_CNT_WLC_TXFRAME              (0u)
+#define WL_CNT_WLC_TXBYTE               (1u)
+#define WL_CNT_WLC_TXRETRANS            (2u)
+#define WL_CNT_WLC_TXNOBUF              (7u)
+#define WL_CNT_WLC_RXFRAME              (15u)
+#define WL_CNT_WLC_RXBYTE               (16u)
+#define WL_CNT_WLC_RXNOBUF              (19u)
+#define WL_CNT_WLC_TXFAIL               (50u)
+#define WL_CNT_WLC_TXRETRY              (51u)
+#define WL_CNT_WLC_TXRETRIE             (52u)
+#define WL_CNT_WLC_RXDUP                (53u)
+#define WL_CNT_WLC_TXNOACK              (56u)
+#define WL_CNT_WLC_RXCRC                (59u)
+#define WL_CNT_WLC_WORDS                (60u)
+
+/* wl_wme_cnt_t: version, length, then arrays of per-AC {packets, bytes} */
+#define WL_WME_CNT_HEADER               (4u)
+#define WL_WME_CNT_ARRAY                (WL_COUNTERS_ACS * 8u)
+#define WL_WME_CNT_TX                   (0u)
+#define WL_WME_CNT_TX_FAILED            (1u)
+#define WL_WME_CNT_RX                   (2u)
+#define WL_WME_CNT_TX_EXPIRED           (5u)
+#define WL_WME_CNT_LEN                  (WL_WME_CNT_HEADER + (6u * WL_WME_CNT_ARRAY))
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int wl_counters_command(int argc, char* argv[], tlv_buffer_t** data);
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern whd_interface_t whd_ifs[2];
+
+static const char *wl_counters_ac_names[WL_COUNTERS_ACS] = { "BE", "BK", "VI", "VO" };
+
+/* Iovar buffers, shared by the readers under the mutex */
+static uint8_t wl_counters_buffer[WL_COUNTERS_BUFFER_LEN];
+static uint8_t wl_counters_wme_buffer[WL_WME_CNT_LEN];
+static cy_mutex_t wl_counters_mutex;
+static bool wl_counters_mutex_initialized;
+
+static volatile bool wl_counters_enabled;
+static bool wl_counters_initialized;
+static uint32_t wl_counters_period_ms = WL_COUNTERS_PERIOD_MS;
+
+/* Counters at the previous command and at the previous background sample */
+static wl_counters_t wl_counters_cmd_prev;
+static cy_time_t wl_counters_cmd_prev_ms;
+static bool wl_counters_cmd_prev_valid;
+static wl_counters_t wl_counters_sampler_prev;
+static cy_time_t wl_counters_sampler_prev_ms;
+static bool wl_counters_sampler_prev_valid;
+
+static wl_counters_sample_t wl_counters_history[WL_COUNTERS_HISTORY];
+static uint32_t wl_counters_count;
+
+/* Frames sent per HE MCS of the TX rate, from the background samples */
+static uint32_t wl_counters_rate_frames[LINK_MONITOR_MCS_COUNT];
+
+static cy_thread_t wl_counters_thread;
+static cy_semaphore_t wl_counters_wake;
+
+#define WL_COUNTERS_COMMANDS \
+    { (char *) "wl_counters", wl_counters_command, 0, NULL, NULL, (char *) "[start [period_ms]|stop|dump|reset]", (char *) "Show the WLAN counter deltas since the previous call, or sample them in the background" }, \
+
+const cy_command_console_cmd_t wl_counters_commands_table[] =
+{
+    WL_COUNTERS_COMMANDS
+    CMD_TABLE_END
+};
+
+
+/*******************************************************************************
+* Function Name: wl_counters_get16
+********************************************************************************
+* Summary:
+* Reads a little-endian 16-bit value.
+*
+*******************************************************************************/
+static uint32_t wl_counters_get16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_get32
+********************************************************************************
+* Summary:
+* Reads a little-endian 32-bit value.
+*
+*******************************************************************************/
+static uint32_t wl_counters_get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_parse_wlc
+********************************************************************************
+* Summary:
+* Finds the wl_cnt_wlc_t block in an XTLV "counters" reply and copies the MAC
+* counters. Returns false for the older layouts.
+*
+*******************************************************************************/
+static bool wl_counters_parse_wlc(const uint8_t *buffer, uint32_t len, wl_counters_t *counters)
+{
+    uint32_t end;
+    uint32_t offset = 4u;
+
+    if((len < 4u) || (wl_counters_get16(buffer) != WL_COUNTERS_XTLV_VERSION))
+    {
+        return false;
+    }
+
+    end = 4u + wl_counters_get16(&buffer[2]);
+    if(end > len)
+    {
+        return false;
+    }
+
+    while(offset + 4u <= end)
+    {
+        uint32_t id = wl_counters_get16(&buffer[offset]);
+        uint32_t xtlv_len = wl_counters_get16(&buffer[offset + 2u]);
+        const uint8_t *words = &buffer[offset + 4u];
+
+        if(offset + 4u + xtlv_len > end)
+        {
+            break;
+        }
+
+        if((id == WL_COUNTERS_XTLV_WLC) && (xtlv_len >= WL_CNT_WLC_WORDS * 4u))
+        {
+            counters->tx_frames        = wl_counters_get32(&words[WL_CNT_WLC_TXFRAME * 4u]);
+            counters->tx_bytes         = wl_counters_get32(&words[WL_CNT_WLC_TXBYTE * 4u]);
+            counters->tx_retrans       = wl_counters_get32(&words[WL_CNT_WLC_TXRETRANS * 4u]);
+            counters->tx_retried       = wl_counters_get32(&words[WL_CNT_WLC_TXRETRY * 4u]);
+            counters->tx_multi_retried = wl_counters_get32(&words[WL_CNT_WLC_TXRETRIE * 4u]);
+            counters->tx_failed        = wl_counters_get32(&words[WL_CNT_WLC_TXFAIL * 4u]);
+            counters->tx_noack         = wl_counters_get32(&words[WL_CNT_WLC_TXNOACK * 4u]);
+            counters->tx_nobuf         = wl_counters_get32(&words[WL_CNT_WLC_TXNOBUF * 4u]);
+            counters->rx_frames        = wl_counters_get32(&words[WL_CNT_WLC_RXFRAME * 4u]);
+            counters->rx_bytes         = wl_counters_get32(&words[WL_CNT_WLC_RXBYTE * 4u]);
+            counters->rx_dup           = wl_counters_get32(&words[WL_CNT_WLC_RXDUP * 4u]);
+            counters->rx_crc           = wl_counters_get32(&words[WL_CNT_WLC_RXCRC * 4u]);
+            counters->rx_nobuf         = wl_counters_get32(&words[WL_CNT_WLC_RXNOBUF * 4u]);
+            return true;
+        }
+
+        /* XTLVs are padded to 32 bits */
+        offset += 4u + ((xtlv_len + 3u) & ~3u);
+    }
+
+    return false;
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_read
+********************************************************************************
+* Summary:
+* This function reads the counters from the firmware. When the firmware
+* does not report the MAC counters in the XTLV layout, the TX/RX totals,
+* failures and retries come from the connection manager and wlc_valid is
+* false.
+*
+* Parameters:
+*  wl_counters_t *counters : receives the counters since the firmware started
+*
+* Return:
+*  cy_rslt_t : CY_RSLT_SUCCESS if the MAC counters or the totals were read
+*
+*******************************************************************************/
+cy_rslt_t wl_counters_read(wl_counters_t *counters)
+{
+    whd_interface_t ifp = whd_ifs[CY_WCM_INTERFACE_TYPE_STA];
+    cy_wcm_wlan_statistics_t stats;
+    whd_prof_request_t requests[2];
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    memset(counters, 0, sizeof(*counters));
+
+    if(!wl_counters_mutex_initialized)
+    {
+        result = cy_rtos_init_mutex(&wl_counters_mutex);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        lock_prof_name(&wl_counters_mutex, "wl_counters");
+        wl_counters_mutex_initialized = true;
+    }
+
+    lock_prof_get(&wl_counters_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    /* Both blocks are read back to back */
+    memset(requests, 0, sizeof(requests));
+    requests[0].op     = WHD_PROF_GET_IOVAR;
+    requests[0].iovar  = "counters";
+    requests[0].buffer = wl_counters_buffer;
+    requests[0].len    = sizeof(wl_counters_buffer);
+    requests[1].op     = WHD_PROF_GET_IOVAR;
+    requests[1].iovar  = "wme_counters";
+    requests[1].buffer = wl_counters_wme_buffer;
+    requests[1].len    = sizeof(wl_counters_wme_buffer);
+    whd_prof_batch(ifp, requests, 2u);
+
+    if(requests[0].result == WHD_SUCCESS)
+    {
+        counters->wlc_valid = wl_counters_parse_wlc(wl_counters_buffer, sizeof(wl_counters_buffer), counters);
+    }
+
+    if(!counters->wlc_valid)
+    {
+        result = cy_wcm_get_wlan_statistics(CY_WCM_INTERFACE_TYPE_STA, &stats);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            counters->tx_frames  = stats.tx_packets;
+            counters->tx_bytes   = stats.tx_bytes;
+            counters->tx_retrans = stats.tx_retries;
+            counters->tx_failed  = stats.tx_failed;
+            counters->rx_frames  = stats.rx_packets;
+            counters->rx_bytes   = stats.rx_bytes;
+        }
+    }
+
+    if((requests[1].result == WHD_SUCCESS) && (wl_counters_get16(&wl_counters_wme_buffer[2]) >= WL_WME_CNT_LEN))
+    {
+        for(uint32_t ac = 0; ac < WL_COUNTERS_ACS; ac++)
+        {
+            const uint8_t *packets = &wl_counters_wme_buffer[WL_WME_CNT_HEADER + (ac * 8u)];
+
+            counters->ac_tx[ac]         = wl_counters_get32(&packets[WL_WME_CNT_TX * WL_WME_CNT_ARRAY]);
+            counters->ac_tx_failed[ac]  = wl_counters_get32(&packets[WL_WME_CNT_TX_FAILED * WL_WME_CNT_ARRAY]);
+            counters->ac_rx[ac]         = wl_counters_get32(&packets[WL_WME_CNT_RX * WL_WME_CNT_ARRAY]);
+            counters->ac_tx_expired[ac] = wl_counters_get32(&packets[WL_WME_CNT_TX_EXPIRED * WL_WME_CNT_ARRAY]);
+        }
+        counters->wme_valid = true;
+    }
+
+    lock_prof_set(&wl_counters_mutex);
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_delta
+********************************************************************************
+* Summary:
+* This function computes the counter deltas between two reads. The 32-bit
+* counters wrap around, which unsigned subtraction absorbs.
+*
+* Parameters:
+*  const wl_counters_t *now
+*  const wl_counters_t *prev
+*  wl_counters_t *delta
+*
+*******************************************************************************/
+void wl_counters_delta(const wl_counters_t *now, const wl_counters_t *prev, wl_counters_t *delta)
+{
+    delta->wlc_valid        = now->wlc_valid;
+    delta->wme_valid        = now->wme_valid && prev->wme_valid;
+    delta->tx_frames        = now->tx_frames - prev->tx_frames;
+    delta->tx_bytes         = now->tx_bytes - prev->tx_bytes;
+    delta->tx_retrans       = now->tx_retrans - prev->tx_retrans;
+    delta->tx_retried       = now->tx_retried - prev->tx_retried;
+    delta->tx_multi_retried = now->tx_multi_retried - prev->tx_multi_retried;
+    delta->tx_failed        = now->tx_failed - prev->tx_failed;
+    delta->tx_noack         = now->tx_noack - prev->tx_noack;
+    delta->tx_nobuf         = now->tx_nobuf - prev->tx_nobuf;
+    delta->rx_frames        = now->rx_frames - prev->rx_frames;
+    delta->rx_bytes         = now->rx_bytes - prev->rx_bytes;
+    delta->rx_dup           = now->rx_dup - prev->rx_dup;
+    delta->rx_crc           = now->rx_crc - prev->rx_crc;
+    delta->rx_nobuf         = now->rx_nobuf - prev->rx_nobuf;
+
+    for(uint32_t ac = 0; ac < WL_COUNTERS_ACS; ac++)
+    {
+        delta->ac_tx[ac]         = now->ac_tx[ac] - prev->ac_tx[ac];
+        delta->ac_tx_failed[ac]  = now->ac_tx_failed[ac] - prev->ac_tx_failed[ac];
+        delta->ac_tx_expired[ac] = now->ac_tx_expired[ac] - prev->ac_tx_expired[ac];
+        delta->ac_rx[ac]         = now->ac_rx[ac] - prev->ac_rx[ac];
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_rate_kbps
+********************************************************************************
+* Summary:
+* Returns the current TX rate, 0 if unknown.
+*
+*******************************************************************************/
+static uint32_t wl_counters_rate_kbps(void)
+{
+    uint32_t value = 0;
+
+    /* WLC_GET_RATE reports the rate in units of 500 kbit/s */
+    if(whd_prof_get_ioctl_value(whd_ifs[CY_WCM_INTERFACE_TYPE_STA], WLC_GET_RATE, &value) != WHD_SUCCESS)
+    {
+        return 0u;
+    }
+
+    return value * 500u;
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_thread_function
+********************************************************************************
+* Summary:
+* Stores the counter deltas every period while the sampler is started, and
+* adds the frames sent to the bin of the current TX rate.
+*
+*******************************************************************************/
+static void wl_counters_thread_function(cy_thread_arg_t arg)
+{
+    for(;;)
+    {
+        cy_rslt_t result = cy_rtos_get_semaphore(&wl_counters_wake,
+                                                 wl_counters_enabled ? wl_counters_period_ms : CY_RTOS_NEVER_TIMEOUT,
+                                                 false);
+        wl_counters_t counters;
+        wl_counters_sample_t sample;
+        cy_time_t now;
+        uint32_t state;
+
+        if((result == CY_RSLT_SUCCESS) || !wl_counters_enabled || !cy_wcm_is_connected_to_ap() ||
+           (wl_counters_read(&counters) != CY_RSLT_SUCCESS))
+        {
+            continue;
+        }
+        cy_rtos_get_time(&now);
+
+        if(wl_counters_sampler_prev_valid)
+        {
+            memset(&sample, 0, sizeof(sample));
+            sample.time_ms = (uint32_t)now;
+            sample.interval_ms = (uint32_t)(now - wl_counters_sampler_prev_ms);
+            sample.rate_kbps = wl_counters_rate_kbps();
+            wl_counters_delta(&counters, &wl_counters_sampler_prev, &sample.delta);
+
+            state = cyhal_system_critical_section_enter();
+            wl_counters_history[wl_counters_count % WL_COUNTERS_HISTORY] = sample;
+            wl_counters_count++;
+            if(sample.rate_kbps != 0u)
+            {
+                wl_counters_rate_frames[link_monitor_rate_to_mcs(sample.rate_kbps)] += sample.delta.tx_frames;
+            }
+            cyhal_system_critical_section_exit(state);
+        }
+
+        wl_counters_sampler_prev = counters;
+        wl_counters_sampler_prev_ms = now;
+        wl_counters_sampler_prev_valid = true;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_print_value
+********************************************************************************
+* Summary:
+* Prints a MAC counter, or '-' when the firmware did not report it.
+*
+*******************************************************************************/
+static void wl_counters_print_value(const char *name, uint32_t value, bool valid)
+{
+    if(valid)
+    {
+        printf(" %s %" PRIu32, name, value);
+    }
+    else
+    {
+        printf(" %s -", name);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_print_delta
+********************************************************************************
+* Summary:
+* Prints the deltas of one interval over a few lines.
+*
+*******************************************************************************/
+static void wl_counters_print_delta(const wl_counters_t *delta)
+{
+    printf("tx: frm %" PRIu32 " byt %" PRIu32 " rtx %" PRIu32, delta->tx_frames, delta->tx_bytes, delta->tx_retrans);
+    wl_counters_print_value("rtry", delta->tx_retried, delta->wlc_valid);
+    wl_counters_print_value("mrtry", delta->tx_multi_retried, delta->wlc_valid);
+    printf(" fail %" PRIu32, delta->tx_failed);
+    wl_counters_print_value("noack", delta->tx_noack, delta->wlc_valid);
+    wl_counters_print_value("nobuf", delta->tx_nobuf, delta->wlc_valid);
+    printf("\nrx: frm %" PRIu32 " byt %" PRIu32, delta->rx_frames, delta->rx_bytes);
+    wl_counters_print_value("dup", delta->rx_dup, delta->wlc_valid);
+    wl_counters_print_value("crc", delta->rx_crc, delta->wlc_valid);
+    wl_counters_print_value("nobuf", delta->rx_nobuf, delta->wlc_valid);
+    printf("\n");
+
+    if(!delta->wme_valid)
+    {
+        printf("per-AC counters not reported\n");
+        return;
+    }
+
+    printf("%-8s %8s %8s %8s %8s\n", "ac", "tx", "fail", "expired", "rx");
+    for(uint32_t ac = 0; ac < WL_COUNTERS_ACS; ac++)
+    {
+        printf("%-8s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 "\n", wl_counters_ac_names[ac],
+               delta->ac_tx[ac], delta->ac_tx_failed[ac], delta->ac_tx_expired[ac], delta->ac_rx[ac]);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_dump
+********************************************************************************
+* Summary:
+* Prints the stored deltas, one line each, oldest first, then the TX rate
+* histogram.
+*
+*******************************************************************************/
+static void wl_counters_dump(void)
+{
+    uint32_t count = (wl_counters_count < WL_COUNTERS_HISTORY) ? wl_counters_count : WL_COUNTERS_HISTORY;
+    uint32_t total = 0;
+
+    printf("  time(ms)    ms   txfrm   rtx  rtry  fail noack   rxfrm   dup   crc  drops BE/BK/VI/VO     kbit/s\n");
+    for(uint32_t i = wl_counters_count - count; i < wl_counters_count; i++)
+    {
+        wl_counters_sample_t sample;
+        const wl_counters_t *d = &sample.delta;
+        uint32_t state = cyhal_system_critical_section_enter();
+
+        sample = wl_counters_history[i % WL_COUNTERS_HISTORY];
+        cyhal_system_critical_section_exit(state);
+
+        printf("%10" PRIu32 " %5" PRIu32 " %7" PRIu32 " %5" PRIu32 " %5" PRIu32 " %5" PRIu32 " %5" PRIu32 " %7" PRIu32
+               " %5" PRIu32 " %5" PRIu32 "  %4" PRIu32 "/%" PRIu32 "/%" PRIu32 "/%" PRIu32 "  %10" PRIu32 "\n",
+               sample.time_ms, sample.interval_ms, d->tx_frames, d->tx_retrans, d->tx_retried, d->tx_failed,
+               d->tx_noack, d->rx_frames, d->rx_dup, d->rx_crc, d->ac_tx_failed[0] + d->ac_tx_expired[0],
+               d->ac_tx_failed[1] + d->ac_tx_expired[1], d->ac_tx_failed[2] + d->ac_tx_expired[2],
+               d->ac_tx_failed[3] + d->ac_tx_expired[3], sample.rate_kbps);
+    }
+
+    for(uint32_t mcs = 0; mcs < LINK_MONITOR_MCS_COUNT; mcs++)
+    {
+        total += wl_counters_rate_frames[mcs];
+    }
+
+    printf("TX frames per MCS of the TX rate (%" PRIu32 " frames):", total);
+    for(uint32_t mcs = 0; mcs < LINK_MONITOR_MCS_COUNT; mcs++)
+    {
+        uint32_t permille = (total != 0u) ? (uint32_t)(((uint64_t)wl_counters_rate_frames[mcs] * 1000u) / total) : 0u;
+
+        printf(" %" PRIu32 ":%" PRIu32 ".%" PRIu32 "%%", mcs, permille / 10u, permille % 10u);
+    }
+    printf("\n");
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_command
+********************************************************************************
+* Summary:
+* This function prints the counter deltas since the previous call, starts or
+* stops the background sampler, dumps the stored deltas with the TX rate
+* histogram, or resets the deltas and the history.
+*
+* Parameters:
+*  int argc
+*  char* argv[]
+*  tlv_buffer_t** data
+*
+* Return:
+*  int
+*
+*******************************************************************************/
+int wl_counters_command(int argc, char* argv[], tlv_buffer_t** data)
+{
+    wl_counters_t counters;
+    wl_counters_t delta;
+    cy_time_t now;
+
+    if((argc >= 2) && !strcmp(argv[1], "start"))
+    {
+        uint32_t period_ms = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : WL_COUNTERS_PERIOD_MS;
+
+        if(period_ms < 100u)
+        {
+            printf("The period must be at least 100 ms\n");
+            return -1;
+        }
+
+        if(!wl_counters_initialized)
+        {
+            if((cy_rtos_init_semaphore(&wl_counters_wake, 1, 0) != CY_RSLT_SUCCESS) ||
+               (cy_rtos_thread_create(&wl_counters_thread, wl_counters_thread_function, "WlCounters", NULL,
+                                      WL_COUNTERS_THREAD_STACK, CY_RTOS_PRIORITY_LOW, NULL) != CY_RSLT_SUCCESS))
+            {
+                printf("Failed to start the counter sampler thread\n");
+                return -1;
+            }
+            wl_counters_initialized = true;
+        }
+
+        wl_counters_period_ms = period_ms;
+        wl_counters_sampler_prev_valid = false;
+        wl_counters_enabled = true;
+        cy_rtos_set_semaphore(&wl_counters_wake, false);
+        printf("Sampling the counters every %" PRIu32 " ms\n", period_ms);
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "stop"))
+    {
+        wl_counters_enabled = false;
+        if(wl_counters_initialized)
+        {
+            cy_rtos_set_semaphore(&wl_counters_wake, false);
+        }
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "dump"))
+    {
+        wl_counters_dump();
+        return 0;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "reset"))
+    {
+        uint32_t state = cyhal_system_critical_section_enter();
+
+        wl_counters_count = 0;
+        memset(wl_counters_rate_frames, 0, sizeof(wl_counters_rate_frames));
+        cyhal_system_critical_section_exit(state);
+        wl_counters_cmd_prev_valid = false;
+        wl_counters_sampler_prev_valid = false;
+        return 0;
+    }
+
+    if(argc >= 2)
+    {
+        printf("Usage: wl_counters [start [period_ms]|stop|dump|reset]\n");
+        return -1;
+    }
+
+    if(wl_counters_read(&counters) != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to read the counters\n");
+        return -1;
+    }
+    cy_rtos_get_time(&now);
+
+    if(!wl_counters_cmd_prev_valid)
+    {
+        memset(&wl_counters_cmd_prev, 0, sizeof(wl_counters_cmd_prev));
+        wl_counters_cmd_prev.wme_valid = counters.wme_valid;
+        printf("Since the firmware started, TX rate %" PRIu32 " kbit/s\n", wl_counters_rate_kbps());
+    }
+    else
+    {
+        printf("Over %" PRIu32 " ms, TX rate %" PRIu32 " kbit/s\n", (uint32_t)(now - wl_counters_cmd_prev_ms),
+               wl_counters_rate_kbps());
+    }
+
+    wl_counters_delta(&counters, &wl_counters_cmd_prev, &delta);
+    wl_counters_print_delta(&delta);
+
+    wl_counters_cmd_prev = counters;
+    wl_counters_cmd_prev_ms = now;
+    wl_counters_cmd_prev_valid = true;
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: wl_counters_add_commands
+********************************************************************************
+* Summary:
+* This function registers the WLAN counters command.
+*
+*******************************************************************************/
+cy_rslt_t wl_counters_add_commands(void)
+{
+    return cy_command_console_add_table(wl_counters_commands_table);
+}
+
+
+/* [] END OF FILE */
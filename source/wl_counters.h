@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name:   wl_counters.h
+*
+* Description: This file contains the declarations for the WLAN link-layer
+*              counters read from the firmware: retries, failures, RX
+*              duplicates, per-AC counters and a TX rate histogram.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef WL_COUNTERS_H_
+#define WL_COUNTERS_H_
+
+#include "cy_result.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Sampling period of the background sampler and deltas kept */
+#define WL_COUNTERS_PERIOD_MS           (1000u)
+#define WL_COUNTERS_HISTORY             (32u)
+
+/* Access categories, in the firmware order: BE, BK, VI, VO */
+#define WL_COUNTERS_ACS                 (4u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    bool     wlc_valid;                         /* MAC counters read */
+    bool     wme_valid;                         /* Per-AC counters read */
+    uint32_t tx_frames;                         /* Data frames */
+    uint32_t tx_bytes;
+    uint32_t tx_retrans;                        /* MAC retransmissions */
+    uint32_t tx_retried;                        /* Frames sent after one or more retries */
+    uint32_t tx_multi_retried;                  /* Frames sent after more than one retry */
+    uint32_t tx_failed;                         /* Frames dropped after all retries */
+    uint32_t tx_noack;
+    uint32_t tx_nobuf;                          /* Dropped for lack of buffers */
+    uint32_t rx_frames;
+    uint32_t rx_bytes;
+    uint32_t rx_dup;                            /* Duplicates (retries of frames already received) */
+    uint32_t rx_crc;                            /* FCS errors */
+    uint32_t rx_nobuf;
+    uint32_t ac_tx[WL_COUNTERS_ACS];
+    uint32_t ac_tx_failed[WL_COUNTERS_ACS];     /* Dropped or failed */
+    uint32_t ac_tx_expired[WL_COUNTERS_ACS];    /* Dropped from the queue on lifetime expiry */
+    uint32_t ac_rx[WL_COUNTERS_ACS];
+} wl_counters_t;
+
+typedef struct
+{
+    uint32_t      time_ms;
+    uint32_t      interval_ms;
+    uint32_t      rate_kbps;                    /* TX rate at the end of the interval */
+    wl_counters_t delta;
+} wl_counters_sample_t;
+
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t wl_counters_read(wl_counters_t *counters);
+void wl_counters_delta(const wl_counters_t *now, const wl_counters_t *prev, wl_counters_t *delta);
+cy_rslt_t wl_counters_add_commands(void);
+
+#endif /* WL_COUNTERS_H_ */
+
+/* [] END OF FILE */
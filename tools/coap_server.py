@@ -0,0 +1,390 @@
+#!/usr/bin/env python3
+################################################################################
+# \file coap_server.py
+# \version 1.0
+#
+# \brief
+# CoAP server stand-in for the CoAP client (source/coap_client.c). It serves
+# GET and PUT over UDP with block-wise transfers (Block2, Block1), stores
+# what is PUT, and checks that uploads hold the test data of "coap put".
+#
+# Usage: python3 coap_server.py [--port 5683] [--size 2048] [--szx 6]
+#                               [--drop N] [--malformed] [--expect-put BYTES]
+#        python3 coap_server.py --self-test
+#
+# GET of a path that was not PUT returns --size bytes of the "coap put" test
+# data. --szx caps the block size the server accepts and sends (16 << szx),
+# so that the client has to switch to smaller blocks. --drop N leaves every
+# Nth request unanswered, for the client to retransmit. With --malformed,
+# every response is preceded by datagrams the client must ignore: a reset
+# with a reserved token length (9), options whose extended delta or length
+# bytes are cut off by the end of the datagram, and a payload marker with no
+# payload; all carry the message ID and token of the request, and an error
+# code where they have one. With --expect-put, the server exits after an
+# upload of that many bytes, with status 1 if the data is wrong. --self-test
+# runs a Python client against the server with all of the above.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import socket
+import sys
+import threading
+
+DEFAULT_PORT = 5683
+
+# Receive buffer of the client (COAP_CLIENT_MESSAGE_LEN)
+CLIENT_MESSAGE_LEN = 1024 + 128
+
+TYPE_CON, TYPE_NON, TYPE_ACK, TYPE_RST = 0, 1, 2, 3
+
+CODE_EMPTY = 0x00
+CODE_GET = 0x01
+CODE_PUT = 0x03
+CODE_CHANGED = 0x44     # 2.04
+CODE_CONTENT = 0x45     # 2.05
+CODE_CONTINUE = 0x5F    # 2.31
+CODE_BAD_REQUEST = 0x80  # 4.00
+
+OPTION_URI_PATH = 11
+OPTION_BLOCK2 = 23
+OPTION_BLOCK1 = 27
+
+BLOCK_MORE = 0x08
+
+
+def test_data(length):
+    """Test data of the "coap put" command."""
+    return bytes(ord("a") + (i % 26) for i in range(length))
+
+
+def encode_uint(value):
+    """Unsigned integer option value in the fewest bytes."""
+    return value.to_bytes((value.bit_length() + 7) // 8, "big")
+
+
+def encode_option_field(value):
+    """Returns (nibble, extended bytes) of an option delta or length."""
+    if value < 13:
+        return value, b""
+    if value < 269:
+        return 13, bytes([value - 13])
+    return 14, (value - 269).to_bytes(2, "big")
+
+
+def encode(kind, code, message_id, token, options=(), payload=b""):
+    """Encodes a message; options are (number, value) pairs."""
+    data = bytearray([0x40 | (kind << 4) | len(token), code, message_id >> 8, message_id & 0xFF])
+    data += token
+    last = 0
+    for number, value in sorted(options, key=lambda option: option[0]):
+        delta, delta_ext = encode_option_field(number - last)
+        length, length_ext = encode_option_field(len(value))
+        data += bytes([(delta << 4) | length]) + delta_ext + length_ext + value
+        last = number
+    if payload:
+        data += b"\xff" + payload
+    return bytes(data)
+
+
+def parse(data):
+    """Parses a message with the checks of coap_parse() in
+    source/coap_client.c; returns None for a malformed one."""
+    if len(data) < 4 or data[0] >> 6 != 1:
+        return None
+    token_length = data[0] & 0x0F
+    offset = 4 + token_length
+    if token_length > 8 or offset > len(data):
+        return None
+    message = {"type": (data[0] >> 4) & 0x03, "code": data[1], "id": (data[2] << 8) | data[3],
+               "token": data[4:offset], "options": [], "payload": b""}
+    number = 0
+    while offset < len(data):
+        if data[offset] == 0xFF:
+            if offset + 1 == len(data):
+                return None
+            message["payload"] = data[offset + 1:]
+            return message
+        fields = [data[offset] >> 4, data[offset] & 0x0F]
+        offset += 1
+        for i in range(2):
+            if fields[i] == 13:
+                if offset + 1 > len(data):
+                    return None
+                fields[i] = 13 + data[offset]
+                offset += 1
+            elif fields[i] == 14:
+                if offset + 2 > len(data):
+                    return None
+                fields[i] = 269 + ((data[offset] << 8) | data[offset + 1])
+                offset += 2
+            elif fields[i] == 15:
+                return None
+        if offset + fields[1] > len(data):
+            return None
+        number += fields[0]
+        message["options"].append((number, data[offset:offset + fields[1]]))
+        offset += fields[1]
+    return message
+
+
+def option_uint(message, number):
+    """Value of an unsigned integer option, or None."""
+    for option, value in message["options"]:
+        if option == number:
+            return int.from_bytes(value, "big")
+    return None
+
+
+def malformed(message_id, token):
+    """Datagrams the client must reject, with the ID and token of a request."""
+    head = encode(TYPE_ACK, CODE_BAD_REQUEST, message_id, token)
+    # Fills a datagram up to the client buffer, so that reading past its end
+    # would also read past the buffer
+    filler_length = CLIENT_MESSAGE_LEN - len(head) - 3 - 1 - 2
+    filler = encode(TYPE_ACK, CODE_BAD_REQUEST, message_id, token, [(60, b"x" * filler_length)])
+    return [
+        ("reserved token length",
+         bytes([0x40 | (TYPE_RST << 4) | 9, CODE_EMPTY, message_id >> 8, message_id & 0xFF]) + token + b"\0" * 5),
+        ("truncated extended delta", head + bytes([0xD0])),
+        ("truncated extended length", head + bytes([0x0E, 0x01])),
+        ("truncated delta, full datagram", filler + bytes([0xE0])),
+        ("payload marker without payload", head + b"\xff"),
+    ]
+
+
+class Server:
+    """Serves requests until stopped or until the expected upload is done."""
+
+    def __init__(self, sock, size, szx, drop, send_malformed, expect_put):
+        self.sock = sock
+        self.size = size
+        self.szx = szx
+        self.drop = drop
+        self.send_malformed = send_malformed
+        self.expect_put = expect_put
+        self.resources = {}
+        self.uploads = {}
+        self.requests = 0
+        self.malformed_sent = 0
+        self.failures = 0
+        self.done = False
+
+    def handle(self, message, peer):
+        """Answers one confirmable request with a piggybacked response."""
+        path = "/".join(value.decode(errors="replace") for number, value in message["options"]
+                        if number == OPTION_URI_PATH)
+        options = []
+        payload = b""
+
+        if message["code"] == CODE_GET:
+            block2 = option_uint(message, OPTION_BLOCK2) or 0
+            szx = min(block2 & 0x07, self.szx)
+            block = 16 << szx
+            offset = (block2 >> 4) * (16 << (block2 & 0x07))
+            representation = self.resources.get(path, test_data(self.size))
+            payload = representation[offset:offset + block]
+            more = offset + block < len(representation)
+            options.append((OPTION_BLOCK2, encode_uint((offset // block) << 4 | (BLOCK_MORE if more else 0) | szx)))
+            code = CODE_CONTENT
+            print("GET /%s block %d (%d bytes)%s" % (path, offset // block, len(payload), "" if more else ", last"),
+                  flush=True)
+        elif message["code"] == CODE_PUT:
+            block1 = option_uint(message, OPTION_BLOCK1) or 0
+            offset = (block1 >> 4) * (16 << (block1 & 0x07))
+            more = bool(block1 & BLOCK_MORE)
+            upload = self.uploads.setdefault(path, bytearray())
+            del upload[offset:]
+            upload += message["payload"]
+            options.append((OPTION_BLOCK1, encode_uint(block1 & ~0x07 | min(block1 & 0x07, self.szx))))
+            code = CODE_CONTINUE if more else CODE_CHANGED
+            print("PUT /%s block %d (%d bytes)%s" % (path, block1 >> 4, len(message["payload"]),
+                                                     "" if more else ", last"), flush=True)
+            if not more:
+                data = bytes(self.uploads.pop(path))
+                self.resources[path] = data
+                ok = data == test_data(len(data))
+                self.failures += 0 if ok else 1
+                print("%s PUT /%s: %d bytes, test data %s" % ("PASS" if ok else "FAIL", path, len(data),
+                                                             "intact" if ok else "corrupted"), flush=True)
+                if self.expect_put is not None:
+                    ok = len(data) == self.expect_put
+                    self.failures += 0 if ok else 1
+                    print("%s upload size %d (expected %d)" % ("PASS" if ok else "FAIL", len(data),
+                                                              self.expect_put), flush=True)
+                    self.done = True
+        else:
+            code = CODE_BAD_REQUEST
+
+        if self.send_malformed:
+            for _, datagram in malformed(message["id"], message["token"]):
+                self.sock.sendto(datagram, peer)
+                self.malformed_sent += 1
+        self.sock.sendto(encode(TYPE_ACK, code, message["id"], message["token"], options, payload), peer)
+
+    def serve(self, stop):
+        """Receives requests until stop is set or the expected upload is done."""
+        self.sock.settimeout(0.2)
+        while not stop.is_set() and not self.done:
+            try:
+                data, peer = self.sock.recvfrom(2048)
+            except socket.timeout:
+                continue
+            message = parse(data)
+            if message is None or message["type"] != TYPE_CON:
+                continue
+            self.requests += 1
+            if self.drop and self.requests % self.drop == 0:
+                print("Request %d dropped" % self.requests, flush=True)
+                continue
+            self.handle(message, peer)
+
+
+class Client:
+    """Client sending confirmable requests as source/coap_client.c does."""
+
+    def __init__(self, port):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.settimeout(0.2)
+        self.server = ("127.0.0.1", port)
+        self.message_id = 0
+        self.rejected = 0
+
+    def exchange(self, code, path, option, value, payload=b""):
+        """Sends a request until its response arrives, ignoring malformed
+        datagrams; returns the response."""
+        self.message_id += 1
+        token = self.message_id.to_bytes(4, "little")
+        options = [(OPTION_URI_PATH, segment.encode()) for segment in path.split("/") if segment]
+        options.append((option, encode_uint(value)))
+        request = encode(TYPE_CON, code, self.message_id, token, options, payload)
+        for _ in range(5):
+            self.sock.sendto(request, self.server)
+            try:
+                while True:
+                    data = self.sock.recv(2048)
+                    response = parse(data)
+                    if response is None:
+                        self.rejected += 1
+                    elif response["id"] == self.message_id and response["type"] == TYPE_RST:
+                        raise RuntimeError("reset")
+                    elif response["token"] == token and response["code"] != CODE_EMPTY:
+                        return response
+            except socket.timeout:
+                pass
+        raise RuntimeError("no response")
+
+    def put(self, path, data, szx):
+        """Writes in Block1 blocks, taking smaller blocks when asked."""
+        offset = 0
+        while offset < len(data):
+            block = 16 << szx
+            chunk = data[offset:offset + block]
+            more = offset + len(chunk) < len(data)
+            response = self.exchange(CODE_PUT, path, OPTION_BLOCK1,
+                                     (offset // block) << 4 | (BLOCK_MORE if more else 0) | szx, chunk)
+            offset += len(chunk)
+            block1 = option_uint(response, OPTION_BLOCK1)
+            if block1 is not None and block1 & 0x07 < szx:
+                szx = block1 & 0x07
+
+    def get(self, path, szx):
+        """Reads in Block2 blocks."""
+        data = b""
+        more = True
+        while more:
+            response = self.exchange(CODE_GET, path, OPTION_BLOCK2, (len(data) // (16 << szx)) << 4 | szx)
+            data += response["payload"]
+            block2 = option_uint(response, OPTION_BLOCK2) or 0
+            more = bool(block2 & BLOCK_MORE)
+            szx = min(szx, block2 & 0x07)
+        return data
+
+
+def expect(name, ok, value, expected):
+    """Prints a PASS/FAIL line, returns 1 on failure."""
+    print("%s %-40s %s (expected %s)" % ("PASS" if ok else "FAIL", name, value, expected), flush=True)
+    return 0 if ok else 1
+
+
+def self_test():
+    """Uploads and reads back through drops, malformed datagrams and a block
+    size the server caps."""
+    failures = 0
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("127.0.0.1", 0))
+    server = Server(sock, 2048, 5, 4, True, None)
+    stop = threading.Event()
+    thread = threading.Thread(target=server.serve, args=(stop,))
+    thread.start()
+
+    client = Client(sock.getsockname()[1])
+    data = test_data(3000)
+    try:
+        client.put("self/test", data, 6)
+        read = client.get("self/test", 6)
+        default = client.get("other", 6)
+    except RuntimeError as error:
+        read = default = b""
+        failures += expect("transfers", False, str(error), "complete")
+    stop.set()
+    thread.join()
+    sock.close()
+
+    failures += server.failures
+    failures += expect("resource read back", read == data, len(read), len(data))
+    failures += expect("default resource", default == test_data(2048), len(default), 2048)
+    failures += expect("malformed datagrams rejected", client.rejected == server.malformed_sent,
+                       client.rejected, server.malformed_sent)
+    failures += expect("malformed datagrams sent", server.malformed_sent > 0, server.malformed_sent, "> 0")
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CoAP server stand-in with block-wise transfers")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--size", type=int, default=2048, help="size of the default GET representation")
+    parser.add_argument("--szx", type=int, default=6, choices=range(7), help="largest block size exponent")
+    parser.add_argument("--drop", type=int, default=0, help="leave every Nth request unanswered")
+    parser.add_argument("--malformed", action="store_true", help="precede responses with malformed datagrams")
+    parser.add_argument("--expect-put", type=int, help="exit after an upload of this many bytes")
+    parser.add_argument("--self-test", action="store_true", help="check the server with a Python client")
+    args = parser.parse_args()
+
+    if args.self_test:
+        failures = self_test()
+    else:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.bind(("", args.port))
+        print("Listening on UDP port %d" % args.port, flush=True)
+        server = Server(sock, args.size, args.szx, args.drop, args.malformed, args.expect_put)
+        try:
+            server.serve(threading.Event())
+        except KeyboardInterrupt:
+            pass
+        failures = server.failures
+        if args.expect_put is None:
+            return 1 if failures else 0
+
+    print("All checks passed" if failures == 0 else "Some checks failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
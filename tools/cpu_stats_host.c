@@ -0,0 +1,274 @@
+/******************************************************************************
+* File Name:   cpu_stats_host.c
+*
+* Description: This file checks the CPU accounting of source/cpu_stats.c on a
+*              Linux machine by replaying synthetic traces of context
+*              switches and interrupts and comparing the per-entry usage with
+*              the expected one:
+*
+*                gcc -O2 -Isource -o cpu_stats tools/cpu_stats_host.c \
+*                    source/cpu_stats.c
+*                ./cpu_stats
+*
+*              The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cpu_stats.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* One accounting window; usage is reported in tenths of a percent, so one
+ * cycle of a 1000-cycle window is one unit */
+#define WINDOW                          (1000u)
+
+#define THREAD_A                        ((uintptr_t)0x1000)
+#define THREAD_B                        ((uintptr_t)0x2000)
+
+#define EV(t, type, id)                 { (t), (type), (id) }
+#define TRACE_LEN(trace)                (sizeof(trace) / sizeof((trace)[0]))
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef enum
+{
+    EV_SWITCH,                      /* Switch to thread id, idle for 0 */
+    EV_ISR_ENTER,
+    EV_ISR_EXIT,
+    EV_UPDATE                       /* Timer: charge up to now */
+} event_type_t;
+
+typedef struct
+{
+    uint32_t     t;                 /* Cycles since the start of the trace */
+    event_type_t type;
+    uintptr_t    id;
+} event_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static uint32_t failures;
+
+/* A runs 300 cycles, B 500, idle 200 */
+static const event_t trace_two_threads[] =
+{
+    EV(0,    EV_SWITCH, THREAD_A),
+    EV(300,  EV_SWITCH, THREAD_B),
+    EV(800,  EV_SWITCH, 0),
+    EV(1000, EV_UPDATE, 0),
+};
+
+/* An ISR of 100 cycles preempts A, which resumes afterwards */
+static const event_t trace_isr[] =
+{
+    EV(0,    EV_SWITCH, THREAD_A),
+    EV(200,  EV_ISR_ENTER, 0),
+    EV(300,  EV_ISR_EXIT, 0),
+    EV(600,  EV_SWITCH, 0),
+    EV(1000, EV_UPDATE, 0),
+};
+
+/* The ISR readies B: the switch is seen inside the ISR and takes effect at
+ * its exit. A nested ISR is charged once */
+static const event_t trace_switch_in_isr[] =
+{
+    EV(0,    EV_SWITCH, THREAD_A),
+    EV(100,  EV_ISR_ENTER, 0),
+    EV(150,  EV_ISR_ENTER, 0),
+    EV(200,  EV_ISR_EXIT, 0),
+    EV(250,  EV_SWITCH, THREAD_B),
+    EV(300,  EV_ISR_EXIT, 0),
+    EV(1000, EV_UPDATE, 0),
+};
+
+/* A runs the whole first window, then the system is idle for two windows
+ * closed by the timer only */
+static const event_t trace_idle_windows[] =
+{
+    EV(0,    EV_SWITCH, THREAD_A),
+    EV(1000, EV_SWITCH, 0),
+    EV(2000, EV_UPDATE, 0),
+    EV(3000, EV_UPDATE, 0),
+};
+
+
+/*******************************************************************************
+* Function Name: replay
+********************************************************************************
+* Summary:
+* Feeds a trace to a fresh accounting state, with the cycle counter starting
+* at start.
+*
+*******************************************************************************/
+static void replay(cpu_stats_t *stats, const event_t *trace, size_t length, uint32_t start)
+{
+    cpu_stats_init(stats, WINDOW, start);
+
+    for(size_t i = 0; i < length; i++)
+    {
+        uint32_t now = start + trace[i].t;
+
+        switch(trace[i].type)
+        {
+            case EV_SWITCH:
+                cpu_stats_switch(stats, now, trace[i].id, (trace[i].id == THREAD_A) ? "A" : "B");
+                break;
+            case EV_ISR_ENTER:
+                cpu_stats_isr_enter(stats, now);
+                break;
+            case EV_ISR_EXIT:
+                cpu_stats_isr_exit(stats, now);
+                break;
+            case EV_UPDATE:
+            default:
+                cpu_stats_update(stats, now);
+                break;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: entry_of
+********************************************************************************
+* Summary:
+* Returns the entry index of a thread, or of the idle entry for 0.
+*
+*******************************************************************************/
+static uint32_t entry_of(const cpu_stats_t *stats, uintptr_t id)
+{
+    if(id == CPU_STATS_IDLE_ID)
+    {
+        return CPU_STATS_ENTRY_IDLE;
+    }
+
+    for(uint32_t i = CPU_STATS_FIRST_THREAD; i < stats->count; i++)
+    {
+        if(stats->entries[i].id == id)
+        {
+            return i;
+        }
+    }
+    return CPU_STATS_ENTRY_OTHER;
+}
+
+
+/*******************************************************************************
+* Function Name: expect
+********************************************************************************
+* Summary:
+* Compares the usage of an entry over the last windows with the expected
+* value in tenths of a percent.
+*
+*******************************************************************************/
+static void expect(const char *name, const cpu_stats_t *stats, uint32_t entry, uint32_t windows,
+                   uint32_t expected)
+{
+    uint32_t usage = cpu_stats_usage(stats, entry, windows);
+    bool ok = (usage == expected);
+
+    printf("%s %-36s %4" PRIu32 " (expected %4" PRIu32 ")\n", ok ? "PASS" : "FAIL", name, usage, expected);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Runs the checks.
+*
+*******************************************************************************/
+int main(void)
+{
+    cpu_stats_t stats;
+
+    replay(&stats, trace_two_threads, TRACE_LEN(trace_two_threads), 0u);
+    expect("two threads: A", &stats, entry_of(&stats, THREAD_A), 1u, 300u);
+    expect("two threads: B", &stats, entry_of(&stats, THREAD_B), 1u, 500u);
+    expect("two threads: idle", &stats, CPU_STATS_ENTRY_IDLE, 1u, 200u);
+
+    replay(&stats, trace_isr, TRACE_LEN(trace_isr), 0u);
+    expect("ISR: A", &stats, entry_of(&stats, THREAD_A), 1u, 500u);
+    expect("ISR: isr", &stats, CPU_STATS_ENTRY_ISR, 1u, 100u);
+    expect("ISR: idle", &stats, CPU_STATS_ENTRY_IDLE, 1u, 400u);
+
+    replay(&stats, trace_switch_in_isr, TRACE_LEN(trace_switch_in_isr), 0u);
+    expect("switch in nested ISR: A", &stats, entry_of(&stats, THREAD_A), 1u, 100u);
+    expect("switch in nested ISR: isr", &stats, CPU_STATS_ENTRY_ISR, 1u, 200u);
+    expect("switch in nested ISR: B", &stats, entry_of(&stats, THREAD_B), 1u, 700u);
+
+    replay(&stats, trace_idle_windows, TRACE_LEN(trace_idle_windows), 0u);
+    expect("idle windows: A last window", &stats, entry_of(&stats, THREAD_A), 1u, 0u);
+    expect("idle windows: A over 3 windows", &stats, entry_of(&stats, THREAD_A), 3u, 333u);
+    expect("idle windows: A over 10 windows", &stats, entry_of(&stats, THREAD_A), 10u, 333u);
+    expect("idle windows: idle over 3 windows", &stats, CPU_STATS_ENTRY_IDLE, 3u, 666u);
+
+    /* Same trace across the wrap of the 32-bit cycle counter */
+    replay(&stats, trace_two_threads, TRACE_LEN(trace_two_threads), 0xFFFFFE00u);
+    expect("counter wrap: A", &stats, entry_of(&stats, THREAD_A), 1u, 300u);
+    expect("counter wrap: B", &stats, entry_of(&stats, THREAD_B), 1u, 500u);
+
+    /* More threads than entries: the rest is charged to "other" */
+    cpu_stats_init(&stats, WINDOW, 0u);
+    for(uint32_t i = 0; i < 20u; i++)
+    {
+        cpu_stats_switch(&stats, i * 50u, (uintptr_t)(0x100u + i), "T");
+    }
+    cpu_stats_update(&stats, WINDOW);
+    expect("table full: other", &stats, CPU_STATS_ENTRY_OTHER, 1u,
+           (20u - (CPU_STATS_MAX_ENTRIES - CPU_STATS_FIRST_THREAD)) * 50u);
+    expect("table full: first thread", &stats, CPU_STATS_FIRST_THREAD, 1u, 50u);
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */
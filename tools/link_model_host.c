@@ -0,0 +1,239 @@
+/******************************************************************************
+* File Name:   link_model_host.c
+*
+* Description: This file prints the link model of source/link_monitor.c on a
+*              Linux machine: for each RSSI, the HE MCS and PHY rate the model
+*              expects, the data one SP carries, and the load each WCM iTWT
+*              profile sustains, with the profiles that carry a given load
+*              and the time the active profile takes to send a burst:
+*
+*                gcc -O2 -Isource -o link_model tools/link_model_host.c \
+*                    source/link_monitor.c source/ps_policy.c
+*                ./link_model [load_kbps] [per_permille] [retry_permille]
+*
+*              It then checks that the model never does worse at a higher
+*              RSSI (MCS, SP capacity, burst time and profile chosen for the
+*              load), and the profiles chosen for reference loads at both
+*              ends of the sweep. The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "link_monitor.h"
+#include "ps_policy.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define RSSI_MIN_DBM                    (-90)
+#define RSSI_MAX_DBM                    (-40)
+#define RSSI_STEP_DB                    (2)
+
+/* Burst whose sending time is modelled, e.g. a picture of a camera */
+#define BURST_BYTES                     (16384u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+/* Profiles that carry a load, from the busiest to the most frugal */
+typedef enum
+{
+    LINK_NONE = 0,                      /* Neither, PM2 */
+    LINK_ACTIVE,
+    LINK_IDLE                           /* Idle, and active as well */
+} link_choice_t;
+
+typedef struct
+{
+    uint32_t      mcs;
+    uint32_t      rate_kbps;
+    uint32_t      sp_bytes;
+    uint32_t      active_kbps;
+    uint32_t      idle_kbps;
+    uint32_t      burst_ms;             /* Sending BURST_BYTES with the active profile */
+    link_choice_t choice;
+} link_row_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const char *const link_choice_names[] = { "none (PM2)", "active", "idle, active" };
+
+static uint32_t failures;
+
+
+/*******************************************************************************
+* Function Name: model
+********************************************************************************
+* Summary:
+* Evaluates the model at one RSSI for a load.
+*
+*******************************************************************************/
+static void model(int32_t rssi, uint32_t load_kbps, uint32_t per_permille, uint32_t retry_permille, link_row_t *row)
+{
+    uint32_t sps;
+
+    row->mcs         = link_monitor_model_mcs(rssi);
+    row->rate_kbps   = link_monitor_mcs_rate_kbps(row->mcs);
+    row->sp_bytes    = link_monitor_sp_bytes(row->rate_kbps, per_permille, retry_permille, PS_POLICY_SP_WD_US);
+    row->active_kbps = link_monitor_sustained_kbps(row->sp_bytes, PS_POLICY_ITWT_ACTIVE_GAP_MS * 1000u);
+    row->idle_kbps   = link_monitor_sustained_kbps(row->sp_bytes, PS_POLICY_ITWT_IDLE_GAP_MS * 1000u);
+
+    /* The burst waits for as many SPs as it fills; the last one may be short */
+    sps = (row->sp_bytes != 0u) ? ((BURST_BYTES + row->sp_bytes - 1u) / row->sp_bytes) : UINT32_MAX / PS_POLICY_ITWT_ACTIVE_GAP_MS;
+    row->burst_ms = (sps - 1u) * PS_POLICY_ITWT_ACTIVE_GAP_MS + (PS_POLICY_SP_WD_US / 1000u);
+
+    row->choice = (load_kbps <= row->idle_kbps) ? LINK_IDLE : (load_kbps <= row->active_kbps) ? LINK_ACTIVE : LINK_NONE;
+}
+
+
+/*******************************************************************************
+* Function Name: expect
+********************************************************************************
+* Summary:
+* Compares a value with the expected one.
+*
+*******************************************************************************/
+static void expect(const char *name, uint32_t value, uint32_t expected)
+{
+    bool ok = (value == expected);
+
+    printf("%s %-44s %6" PRIu32 " (expected %6" PRIu32 ")\n", ok ? "PASS" : "FAIL", name, value, expected);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: expect_choice
+********************************************************************************
+* Summary:
+* Checks the profiles chosen for a load at one RSSI, with no frame errors.
+*
+*******************************************************************************/
+static void expect_choice(const char *name, int32_t rssi, uint32_t load_kbps, link_choice_t expected)
+{
+    link_row_t row;
+    bool ok;
+
+    model(rssi, load_kbps, 0u, 0u, &row);
+    ok = (row.choice == expected);
+
+    printf("%s %-44s %s (expected %s)\n", ok ? "PASS" : "FAIL", name, link_choice_names[row.choice],
+           link_choice_names[expected]);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Sweeps the RSSI and prints one line of the model per step, then runs the
+* checks. The monotonicity checks report the number of steps that do worse
+* than the previous, lower, RSSI.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t load_kbps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 0u;
+    uint32_t per_permille = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 0u;
+    uint32_t retry_permille = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 0u;
+    uint32_t mcs_drops = 0;
+    uint32_t capacity_drops = 0;
+    uint32_t burst_rises = 0;
+    uint32_t choice_drops = 0;
+    uint32_t mcs_mismatches = 0;
+    link_row_t previous = { 0 };
+    link_row_t row;
+
+    printf("%5s %4s %7s %8s %10s %10s %8s  %s\n", "rssi", "mcs", "kbit/s", "SP bytes", "active", "idle", "burst ms",
+           (load_kbps != 0u) ? "carries the load" : "");
+
+    for(int32_t rssi = RSSI_MIN_DBM; rssi <= RSSI_MAX_DBM; rssi += RSSI_STEP_DB)
+    {
+        model(rssi, load_kbps, per_permille, retry_permille, &row);
+
+        printf("%5d %4u %7u %8u %10u %10u %8u  %s\n", (int)rssi, (unsigned)row.mcs, (unsigned)row.rate_kbps,
+               (unsigned)row.sp_bytes, (unsigned)row.active_kbps, (unsigned)row.idle_kbps, (unsigned)row.burst_ms,
+               (load_kbps != 0u) ? link_choice_names[row.choice] : "");
+
+        if(rssi != RSSI_MIN_DBM)
+        {
+            mcs_drops      += (row.mcs < previous.mcs) ? 1u : 0u;
+            capacity_drops += ((row.sp_bytes < previous.sp_bytes) || (row.active_kbps < previous.active_kbps) ||
+                               (row.idle_kbps < previous.idle_kbps)) ? 1u : 0u;
+            burst_rises    += (row.burst_ms > previous.burst_ms) ? 1u : 0u;
+            choice_drops   += (row.choice < previous.choice) ? 1u : 0u;
+        }
+        previous = row;
+    }
+
+    for(uint32_t mcs = 0; mcs < LINK_MONITOR_MCS_COUNT; mcs++)
+    {
+        mcs_mismatches += (link_monitor_rate_to_mcs(link_monitor_mcs_rate_kbps(mcs)) != mcs) ? 1u : 0u;
+    }
+
+    printf("\n");
+    expect("MCS lower at a higher RSSI", mcs_drops, 0u);
+    expect("SP capacity lower at a higher RSSI", capacity_drops, 0u);
+    expect("burst time longer at a higher RSSI", burst_rises, 0u);
+    expect("busier profile chosen at a higher RSSI", choice_drops, 0u);
+    expect("MCS not found back from its rate", mcs_mismatches, 0u);
+
+    /* A 100 kbit/s sensor fits the idle profile once the MCS exceeds 0, a
+     * 2 Mbit/s stream the active one from MCS 2 on */
+    expect_choice("100 kbit/s at -90 dBm", -90, 100u, LINK_ACTIVE);
+    expect_choice("100 kbit/s at -70 dBm", -70, 100u, LINK_IDLE);
+    expect_choice("2 Mbit/s at -90 dBm", -90, 2000u, LINK_NONE);
+    expect_choice("2 Mbit/s at -40 dBm", -40, 2000u, LINK_ACTIVE);
+    expect_choice("20 Mbit/s at -40 dBm", -40, 20000u, LINK_NONE);
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,325 @@
+/******************************************************************************
+* File Name:   lock_prof_host.c
+*
+* Description: This file checks the contention and priority-inversion
+*              accounting of source/lock_prof.c on a Linux machine with POSIX
+*              threads and mutexes. The test plays the scheduler: it sets
+*              the priority and the ready state of each thread, and reports
+*              the context switches of each scenario to the profiler:
+*
+*                gcc -O2 -Isource -o lock_prof tools/lock_prof_host.c \
+*                    source/lock_prof.c -lpthread
+*                ./lock_prof
+*
+*              The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "lock_prof.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* ThreadX priorities: a lower value is a higher priority */
+#define PRIORITY_HIGH                   (5u)
+#define PRIORITY_ABOVE_HIGH             (2u)
+#define PRIORITY_MEDIUM                 (10u)
+#define PRIORITY_MEDIUM_LOW             (15u)
+#define PRIORITY_LOW                    (20u)
+#define PRIORITY_IDLE                   (30u)
+
+/* Time given to a thread to block on a mutex */
+#define BLOCK_TIMEOUT_MS                (2000u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    lock_prof_thread_t  thread;
+    lock_prof_mutex_t  *mutex;
+    uint32_t            timeout_ms;
+    lock_prof_result_t  result;
+    pthread_t           handle;
+} waiter_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static uint32_t failures;
+
+
+/*******************************************************************************
+* Function Name: waiter_main
+********************************************************************************
+* Summary:
+* Thread that takes the mutex through the profiler, then releases it.
+*
+*******************************************************************************/
+static void *waiter_main(void *arg)
+{
+    waiter_t *waiter = (waiter_t *)arg;
+
+    lock_prof_thread_attach(&waiter->thread);
+    waiter->result = lock_prof_get(waiter->mutex, waiter->timeout_ms);
+    if(waiter->result == 0u)
+    {
+        lock_prof_set(waiter->mutex);
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+* Function Name: waiter_start
+********************************************************************************
+* Summary:
+* Starts a waiter thread and returns once it is blocked on the mutex, i.e.
+* once the profiler lists one more waiter.
+*
+*******************************************************************************/
+static void waiter_start(waiter_t *waiter, const char *name, uint32_t priority, lock_prof_mutex_t *mutex,
+                         uint32_t timeout_ms)
+{
+    lock_prof_entry_t entry;
+    uint32_t waiters = lock_prof_find(mutex, &entry) ? entry.waiters : 0u;
+    struct timespec pause = { 0, 1000000L };
+
+    memset(waiter, 0, sizeof(*waiter));
+    waiter->thread.name     = name;
+    waiter->thread.priority = priority;
+    waiter->thread.ready    = true;
+    waiter->mutex           = mutex;
+    waiter->timeout_ms      = timeout_ms;
+    pthread_create(&waiter->handle, NULL, waiter_main, waiter);
+
+    for(uint32_t i = 0; i < BLOCK_TIMEOUT_MS; i++)
+    {
+        if(lock_prof_find(mutex, &entry) && (entry.waiters > waiters))
+        {
+            /* The waiter is blocked in pthread_mutex_lock() */
+            waiter->thread.ready = false;
+            return;
+        }
+        nanosleep(&pause, NULL);
+    }
+    printf("FAIL %s did not block\n", name);
+    failures++;
+}
+
+
+/*******************************************************************************
+* Function Name: expect
+********************************************************************************
+* Summary:
+* Compares a counter with the expected value.
+*
+*******************************************************************************/
+static void expect(const char *name, uint32_t value, uint32_t expected)
+{
+    bool ok = (value == expected);
+
+    printf("%s %-44s %4" PRIu32 " (expected %4" PRIu32 ")\n", ok ? "PASS" : "FAIL", name, value, expected);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: expect_name
+********************************************************************************
+* Summary:
+* Compares a thread name of the report with the expected one.
+*
+*******************************************************************************/
+static void expect_name(const char *name, const char *value, const char *expected)
+{
+    bool ok = (value != NULL) && !strcmp(value, expected);
+
+    printf("%s %-44s %4s (expected %4s)\n", ok ? "PASS" : "FAIL", name, (value != NULL) ? value : "-", expected);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: run_inversion
+********************************************************************************
+* Summary:
+* The low-priority owner holds the mutex while a high-priority thread blocks
+* on it, and the given thread is switched in. The owner is ready or blocked
+* on something else. Each scenario uses its own mutex, whose statistics are
+* returned.
+*
+*******************************************************************************/
+static void run_inversion(lock_prof_mutex_t *mutex, lock_prof_thread_t *owner, lock_prof_thread_t *other,
+                          bool owner_ready, lock_prof_entry_t *entry)
+{
+    waiter_t high;
+
+    lock_prof_thread_attach(owner);
+    lock_prof_get(mutex, LOCK_PROF_NEVER_TIMEOUT);
+
+    waiter_start(&high, "high", PRIORITY_HIGH, mutex, LOCK_PROF_NEVER_TIMEOUT);
+
+    owner->ready = owner_ready;
+    lock_prof_thread_switch(other);
+    lock_prof_thread_switch(owner);
+    lock_prof_thread_switch(other);
+    owner->ready = true;
+
+    lock_prof_set(mutex);
+    pthread_join(high.handle, NULL);
+
+    lock_prof_find(mutex, entry);
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Runs the checks.
+*
+*******************************************************************************/
+int main(void)
+{
+    lock_prof_thread_t low      = { "low", PRIORITY_LOW, true };
+    lock_prof_thread_t medium   = { "medium", PRIORITY_MEDIUM, true };
+    lock_prof_thread_t idle     = { "idle", PRIORITY_IDLE, true };
+    lock_prof_thread_t urgent   = { "urgent", PRIORITY_ABOVE_HIGH, true };
+    lock_prof_mutex_t scenario[6];
+    lock_prof_mutex_t mutex     = PTHREAD_MUTEX_INITIALIZER;
+    lock_prof_entry_t entry;
+    waiter_t high;
+    waiter_t second;
+
+    for(uint32_t i = 0; i < sizeof(scenario) / sizeof(scenario[0]); i++)
+    {
+        pthread_mutex_init(&scenario[i], NULL);
+    }
+
+    /* Medium preempts the owner while high waits: one inversion per wait */
+    run_inversion(&scenario[0], &low, &medium, true, &entry);
+    expect("medium preempts owner: acquisitions", entry.acquisitions, 2u);
+    expect("medium preempts owner: contended", entry.contended, 1u);
+    expect("medium preempts owner: inversions", entry.inversions, 1u);
+    expect_name("medium preempts owner: waiter", entry.inversion_waiter, "high");
+    expect_name("medium preempts owner: owner", entry.inversion_owner, "low");
+    expect_name("medium preempts owner: preempter", entry.inversion_preempter, "medium");
+    expect("medium preempts owner: inverted waits", entry.inverted_waits, 1u);
+    expect_name("medium preempts owner: inverted waiter", entry.inverted_waiter, "high");
+    expect("medium preempts owner: waiter priority", entry.inverted_waiter_priority, PRIORITY_HIGH);
+    expect_name("medium preempts owner: inverted owner", entry.inverted_owner, "low");
+    expect("medium preempts owner: owner priority", entry.inverted_owner_priority, PRIORITY_LOW);
+
+    /* The owner waits for something else: medium does not delay it */
+    run_inversion(&scenario[1], &low, &medium, false, &entry);
+    expect("owner not ready: contended", entry.contended, 1u);
+    expect("owner not ready: inversions", entry.inversions, 0u);
+    expect("owner not ready: inverted waits", entry.inverted_waits, 1u);
+
+    /* Threads of lower priority than the owner cannot preempt it, and one
+     * of higher priority than the waiter would delay it anyway */
+    run_inversion(&scenario[2], &low, &idle, true, &entry);
+    expect("lower than owner: inversions", entry.inversions, 0u);
+    run_inversion(&scenario[3], &low, &urgent, true, &entry);
+    expect("higher than waiter: inversions", entry.inversions, 0u);
+
+    /* A high-priority owner is no inversion, whoever runs */
+    run_inversion(&scenario[4], &medium, &low, true, &entry);
+    expect("owner above preempter: inversions", entry.inversions, 0u);
+
+    /* Waiting for an owner of higher priority is no inversion either */
+    run_inversion(&scenario[5], &urgent, &medium, true, &entry);
+    expect("owner above waiter: contended", entry.contended, 1u);
+    expect("owner above waiter: inverted waits", entry.inverted_waits, 0u);
+
+    /* Without a blocked thread, preempting the owner is no inversion */
+    lock_prof_thread_attach(&low);
+    lock_prof_get(&mutex, LOCK_PROF_NEVER_TIMEOUT);
+    lock_prof_thread_switch(&medium);
+    lock_prof_set(&mutex);
+    lock_prof_find(&mutex, &entry);
+    expect("no waiter: contended", entry.contended, 0u);
+    expect("no waiter: inversions", entry.inversions, 0u);
+
+    /* Only the waiter of higher priority than medium is delayed by it */
+    lock_prof_get(&mutex, LOCK_PROF_NEVER_TIMEOUT);
+    waiter_start(&second, "second", PRIORITY_MEDIUM_LOW, &mutex, LOCK_PROF_NEVER_TIMEOUT);
+    waiter_start(&high, "high", PRIORITY_HIGH, &mutex, LOCK_PROF_NEVER_TIMEOUT);
+    lock_prof_thread_switch(&medium);
+    lock_prof_set(&mutex);
+    pthread_join(high.handle, NULL);
+    pthread_join(second.handle, NULL);
+    lock_prof_find(&mutex, &entry);
+    expect("two waiters: contended", entry.contended, 2u);
+    expect("two waiters: inversions", entry.inversions, 1u);
+    expect_name("two waiters: waiter", entry.inversion_waiter, "high");
+    expect("two waiters: waiters left", entry.waiters, 0u);
+    expect("two waiters: inverted waits", entry.inverted_waits, 2u);
+    expect_name("two waiters: inverted owner", entry.inverted_owner, "low");
+
+    /* A timed-out wait is counted and no longer listed */
+    lock_prof_get(&mutex, LOCK_PROF_NEVER_TIMEOUT);
+    waiter_start(&high, "high", PRIORITY_HIGH, &mutex, 20u);
+    pthread_join(high.handle, NULL);
+    lock_prof_thread_switch(&medium);
+    lock_prof_set(&mutex);
+    lock_prof_find(&mutex, &entry);
+    expect("timeout: timeouts", entry.timeouts, 1u);
+    expect("timeout: waiters left", entry.waiters, 0u);
+    expect("timeout: inversions after the wait", entry.inversions, 1u);
+    expect("timeout: inverted waits", entry.inverted_waits, 3u);
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+################################################################################
+# \file mqtt_broker.py
+# \version 1.0
+#
+# \brief
+# MQTT 3.1.1 broker stand-in for the keepalive of the MQTT client
+# (source/mqtt_client.c). It answers CONNECT, QoS 1 PUBLISH and PINGREQ, and
+# with --drop-pingresp it leaves the PINGREQs of the first connection
+# unanswered and checks that the client closes that connection within a
+# keepalive of the first PINGREQ, sends no further PINGREQ on it, and
+# reconnects.
+#
+# Usage: python3 mqtt_broker.py [--port 1883] [--drop-pingresp]
+#        python3 mqtt_broker.py --self-test
+#
+# Run "mqtt connect <host IP>" on the kit against "--drop-pingresp". The check
+# takes about two keepalives (see "mqtt stats" for the keepalive in use); the
+# broker exits with status 1 if a check fails. Without --drop-pingresp, the
+# broker answers everything and prints the packets until interrupted.
+# --self-test runs Python clients against the check: one following the
+# keepalive rules of the MQTT client, which must pass, and one that never
+# gives up on a PINGREQ, which must fail.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import select
+import socket
+import sys
+import threading
+import time
+
+DEFAULT_PORT = 1883
+
+CONNECT = 0x10
+CONNACK = 0x20
+PUBLISH = 0x30
+PUBACK = 0x40
+PINGREQ = 0xC0
+PINGRESP = 0xD0
+DISCONNECT = 0xE0
+
+# Time for a lost connection to be reopened (MQTT_CLIENT_RECONNECT_MS plus the
+# poll period of the client thread), in seconds
+RECONNECT_S = 10.0
+
+# Keepalive of the self-test clients, in seconds
+SELF_TEST_KEEPALIVE_S = 2
+
+
+def recv_exact(connection, length):
+    """Returns 'length' bytes, or None when the peer closed the connection."""
+    data = b""
+    while len(data) < length:
+        chunk = connection.recv(length - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def recv_packet(connection, timeout):
+    """Returns (type, payload), None on close, or () if nothing arrived."""
+    if not select.select([connection], [], [], timeout)[0]:
+        return ()
+    try:
+        header = recv_exact(connection, 1)
+        if header is None:
+            return None
+        remaining = 0
+        shift = 0
+        while True:
+            byte = recv_exact(connection, 1)
+            if byte is None:
+                return None
+            remaining |= (byte[0] & 0x7F) << shift
+            shift += 7
+            if not byte[0] & 0x80:
+                break
+        payload = recv_exact(connection, remaining) if remaining else b""
+    except OSError:
+        return None
+    if payload is None:
+        return None
+    return header[0], payload
+
+
+def connect_packet(client_id, keepalive_s):
+    """CONNECT with a clean session."""
+    body = (b"\x00\x04MQTT\x04\x02" + keepalive_s.to_bytes(2, "big") +
+            len(client_id).to_bytes(2, "big") + client_id.encode())
+    return bytes([CONNECT, len(body)]) + body
+
+
+def serve_connection(connection, answer_pings, stop_after_pingresp):
+    """Serves one connection and returns what the client did on it."""
+    info = {"keepalive": None, "client_id": "", "pingreqs": 0, "first_ping": None, "closed": None}
+
+    while True:
+        now = time.monotonic()
+        keepalive = info["keepalive"] or SELF_TEST_KEEPALIVE_S
+        if info["first_ping"] is not None and not answer_pings and now - info["first_ping"] > 2 * keepalive:
+            # The client did not give up on the PINGREQ
+            break
+
+        packet = recv_packet(connection, 0.2)
+        if packet == ():
+            continue
+        if packet is None:
+            info["closed"] = time.monotonic()
+            break
+
+        kind, payload = packet[0] & 0xF0, packet[1]
+        if kind == CONNECT and len(payload) >= 12:
+            info["keepalive"] = int.from_bytes(payload[8:10], "big")
+            length = int.from_bytes(payload[10:12], "big")
+            info["client_id"] = payload[12:12 + length].decode(errors="replace")
+            print("CONNECT %s, keepalive %d s" % (info["client_id"], info["keepalive"]), flush=True)
+            connection.sendall(bytes([CONNACK, 2, 0, 0]))
+        elif kind == PUBLISH:
+            qos = (packet[0] >> 1) & 0x03
+            topic_length = int.from_bytes(payload[0:2], "big")
+            print("PUBLISH %s QoS %d%s" % (payload[2:2 + topic_length].decode(errors="replace"), qos,
+                                           " DUP" if packet[0] & 0x08 else ""), flush=True)
+            if qos == 1:
+                connection.sendall(bytes([PUBACK, 2]) + payload[2 + topic_length:4 + topic_length])
+        elif kind == PINGREQ:
+            info["pingreqs"] += 1
+            if info["first_ping"] is None:
+                info["first_ping"] = time.monotonic()
+            if answer_pings:
+                print("PINGREQ, PINGRESP sent", flush=True)
+                connection.sendall(bytes([PINGRESP, 0]))
+                if stop_after_pingresp:
+                    break
+            else:
+                print("PINGREQ, no answer", flush=True)
+        elif kind == DISCONNECT:
+            print("DISCONNECT", flush=True)
+            info["closed"] = time.monotonic()
+            break
+
+    connection.close()
+    return info
+
+
+def expect(name, ok, value, expected):
+    """Prints a PASS/FAIL line, returns 1 on failure."""
+    print("%s %-40s %s (expected %s)" % ("PASS" if ok else "FAIL", name, value, expected), flush=True)
+    return 0 if ok else 1
+
+
+def check_reconnect(listener):
+    """Drops the PINGRESPs of the first connection, returns the failure count."""
+    failures = 0
+
+    connection, peer = listener.accept()
+    print("%s:%d connected" % peer, flush=True)
+    first = serve_connection(connection, False, False)
+    keepalive = first["keepalive"] or 0
+
+    failures += expect("PINGREQs sent", first["pingreqs"] >= 1, first["pingreqs"], ">= 1")
+    failures += expect("PINGREQs while one is unanswered", first["pingreqs"] <= 1, first["pingreqs"] - 1, 0)
+    closed = first["closed"] is not None and first["first_ping"] is not None
+    delay = (first["closed"] - first["first_ping"]) if closed else None
+    failures += expect("connection closed after the PINGREQ",
+                       closed and delay <= 1.5 * keepalive,
+                       "%.1f s" % delay if closed else "never", "<= %.1f s" % (1.5 * keepalive))
+    if not closed:
+        return failures
+
+    listener.settimeout(RECONNECT_S)
+    try:
+        connection, peer = listener.accept()
+    except socket.timeout:
+        return failures + expect("reconnection", False, "none", "within %.0f s" % RECONNECT_S)
+    failures += expect("reconnection", True, "%.1f s" % (time.monotonic() - first["closed"]),
+                       "within %.0f s" % RECONNECT_S)
+
+    second = serve_connection(connection, True, True)
+    failures += expect("client identifier kept", second["client_id"] == first["client_id"],
+                       second["client_id"], first["client_id"])
+    failures += expect("PINGREQ answered on the new connection", second["pingreqs"] == 1, second["pingreqs"], 1)
+    return failures
+
+
+def run_client(port, keepalive_s, give_up, stop):
+    """Client following the keepalive rules of source/mqtt_client.c, or
+    never giving up on an unanswered PINGREQ if give_up is False."""
+    while not stop.is_set():
+        try:
+            connection = socket.create_connection(("127.0.0.1", port), timeout=1)
+        except OSError:
+            time.sleep(0.2)
+            continue
+        connection.sendall(connect_packet("self-test", keepalive_s))
+        if recv_packet(connection, 1.0) in (None, ()):
+            connection.close()
+            continue
+        last_tx = time.monotonic()
+        ping_sent = None
+
+        while not stop.is_set():
+            packet = recv_packet(connection, 0.1)
+            if packet is None:
+                break
+            if packet and packet[0] & 0xF0 == PINGRESP:
+                ping_sent = None
+            now = time.monotonic()
+            if ping_sent is not None and now - ping_sent >= keepalive_s and give_up:
+                break
+            if now - last_tx >= keepalive_s and (ping_sent is None or not give_up):
+                try:
+                    connection.sendall(bytes([PINGREQ, 0]))
+                except OSError:
+                    break
+                last_tx = now
+                ping_sent = now if ping_sent is None else ping_sent
+        connection.close()
+        time.sleep(0.5)
+
+
+def self_test():
+    """Checks that the check passes a correct client and fails a stuck one."""
+    failures = 0
+    for give_up in (True, False):
+        listener = socket.create_server(("127.0.0.1", 0))
+        stop = threading.Event()
+        client = threading.Thread(target=run_client,
+                                  args=(listener.getsockname()[1], SELF_TEST_KEEPALIVE_S, give_up, stop))
+        client.start()
+        print("Client %s an unanswered PINGREQ" % ("giving up on" if give_up else "ignoring"), flush=True)
+        result = check_reconnect(listener)
+        stop.set()
+        client.join()
+        listener.close()
+        failures += expect("check verdict", (result == 0) == give_up,
+                           "pass" if result == 0 else "fail", "pass" if give_up else "fail")
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MQTT broker stand-in checking the client keepalive")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--drop-pingresp", action="store_true",
+                        help="leave the PINGREQs of the first connection unanswered and check the reconnection")
+    parser.add_argument("--self-test", action="store_true", help="check the stand-in with Python clients")
+    args = parser.parse_args()
+
+    if args.self_test:
+        failures = self_test()
+    else:
+        listener = socket.create_server(("", args.port))
+        print("Listening on port %d" % args.port, flush=True)
+        if args.drop_pingresp:
+            failures = check_reconnect(listener)
+        else:
+            try:
+                while True:
+                    connection, peer = listener.accept()
+                    print("%s:%d connected" % peer, flush=True)
+                    serve_connection(connection, True, False)
+            except KeyboardInterrupt:
+                pass
+            return 0
+
+    print("All checks passed" if failures == 0 else "Some checks failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+################################################################################
+# \file pcap_export.py
+# \version 1.0
+#
+# \brief
+# Writes the records of the on-device packet capture ("pcap dump" or
+# "pcap send") to a .pcap file that can be opened in Wireshark.
+#
+# Usage: python3 pcap_export.py <console log> [-o capture.pcap]
+#        python3 pcap_export.py --listen 19000 [-o capture.pcap]
+#
+# With a console log, lines that are not part of a dump are ignored and the
+# last dump is converted. With --listen, the tool waits for the kit to connect
+# ("pcap send <host IP> 19000") and converts the dump it receives.
+#
+# Ethernet frames are written as they were captured. WHD events are written as
+# Broadcom event frames (Ethertype 0x886C) built from the recorded event
+# header and data.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import socket
+import struct
+import sys
+
+# Record types, see pcap_capture_type_t in source/pcap_capture.h
+TYPE_TX, TYPE_RX, TYPE_EVENT = range(3)
+
+LINKTYPE_ETHERNET = 1
+PCAP_SNAPLEN = 65535
+
+# Event record header: type, status, reason, data length, address
+EVENT_HEADER = struct.Struct(">IIII6s")
+
+# Broadcom event frame: bcmeth_hdr_t and wl_event_msg_t (big endian)
+ETHERTYPE_BRCM = 0x886C
+BCMETH_HEADER = struct.Struct(">HHB3sH")
+WL_EVENT_MSG = struct.Struct(">HHIIIII6s16sBB")
+BCMILCP_SUBTYPE_VENDOR_LONG = 0x8001
+BRCM_OUI = b"\x00\x10\x18"
+BCMILCP_BCM_SUBTYPE_EVENT = 1
+WL_EVENT_MSG_VERSION = 2
+
+
+def parse_dump(lines):
+    """Yields (hz, lost, records) for every complete dump in the lines."""
+    dump = None
+    for line in lines:
+        parts = line.strip().split()
+        if not parts:
+            continue
+        if parts[0] == "PCAP" and len(parts) == 5:
+            dump = {"hz": int(parts[2]), "lost": int(parts[4]), "records": []}
+        elif dump is None:
+            continue
+        elif parts[0] == "F" and len(parts) in (5, 6):
+            data = bytes.fromhex(parts[5]) if len(parts) == 6 else b""
+            dump["records"].append((int(parts[1]), int(parts[2]), int(parts[3], 16), int(parts[4]), data))
+        elif parts[0] == "END":
+            yield dump["hz"], dump["lost"], dump["records"]
+            dump = None
+
+
+def timestamps_us(records, hz):
+    """Returns a microsecond timestamp per record. The cycle counter gives the
+    resolution; the RTOS time in ms resolves its 32-bit wraparounds."""
+    wrap_ms = (1 << 32) * 1000 // hz
+    out = []
+    prev = None
+    for _, time_ms, cycles, _, _ in records:
+        if prev is None or time_ms - prev[0] >= wrap_ms - 1000 or time_ms < prev[0]:
+            us = time_ms * 1000
+        else:
+            us = prev[2] + ((cycles - prev[1]) & 0xFFFFFFFF) * 1000000 // hz
+            # Stay within one tick of the RTOS time
+            us = min(max(us, time_ms * 1000), time_ms * 1000 + 999)
+        out.append(us)
+        prev = (time_ms, cycles, us)
+    return out
+
+
+def event_frame(data, orig_len):
+    """Builds a Broadcom event frame from an event record.
+    Returns (frame, original frame length)."""
+    if len(data) < EVENT_HEADER.size:
+        return data, orig_len
+    event_type, status, reason, datalen, addr = EVENT_HEADER.unpack_from(data)
+    body = data[EVENT_HEADER.size:]
+    msg = WL_EVENT_MSG.pack(WL_EVENT_MSG_VERSION, 0, event_type, status, reason, 0, datalen,
+                            addr, b"wlan0".ljust(16, b"\0"), 0, 0)
+    length = BCMETH_HEADER.size - 4 + len(msg) + datalen
+    bcmeth = BCMETH_HEADER.pack(BCMILCP_SUBTYPE_VENDOR_LONG, length, 0, BRCM_OUI, BCMILCP_BCM_SUBTYPE_EVENT)
+    eth = b"\xff" * 6 + addr + struct.pack(">H", ETHERTYPE_BRCM)
+    header = eth + bcmeth + msg
+    return header + body, len(header) + datalen
+
+
+def write_pcap(path, hz, records):
+    with open(path, "wb") as f:
+        f.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, PCAP_SNAPLEN, LINKTYPE_ETHERNET))
+        for us, (rtype, _, _, orig_len, data) in zip(timestamps_us(records, hz), records):
+            if rtype == TYPE_EVENT:
+                data, orig_len = event_frame(data, orig_len)
+            f.write(struct.pack("<IIII", us // 1000000, us % 1000000, len(data), max(orig_len, len(data))))
+            f.write(data)
+
+
+def receive(port):
+    """Waits for one connection from the kit and returns the received lines."""
+    with socket.create_server(("", port)) as server:
+        print("Waiting for 'pcap send <host IP> %d' on the kit..." % port)
+        conn, peer = server.accept()
+        chunks = []
+        with conn:
+            while True:
+                chunk = conn.recv(4096)
+                if not chunk:
+                    break
+                chunks.append(chunk)
+    print("Received %d bytes from %s" % (sum(len(c) for c in chunks), peer[0]))
+    return b"".join(chunks).decode("ascii", errors="replace").splitlines()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert an on-device capture dump to a .pcap file")
+    parser.add_argument("log", nargs="?", help="console log holding the output of 'pcap dump'")
+    parser.add_argument("--listen", type=int, metavar="PORT", help="receive the dump from 'pcap send' instead")
+    parser.add_argument("-o", "--output", default="capture.pcap", help="pcap file to write")
+    args = parser.parse_args()
+
+    if args.listen is not None:
+        lines = receive(args.listen)
+    elif args.log is not None:
+        with open(args.log, "r", encoding="utf-8", errors="replace") as f:
+            lines = f.readlines()
+    else:
+        parser.error("a console log or --listen is required")
+
+    dumps = list(parse_dump(lines))
+    if not dumps:
+        sys.exit("No complete capture dump found")
+
+    hz, lost, records = dumps[-1]
+    write_pcap(args.output, hz, records)
+
+    print("Wrote %s (%d records, %d lost)" % (args.output, len(records), lost))
+
+
+if __name__ == "__main__":
+    main()
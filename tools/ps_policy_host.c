@@ -0,0 +1,267 @@
+/******************************************************************************
+* File Name:   ps_policy_host.c
+*
+* Description: This file runs the power-save policy classifier of
+*              source/ps_policy.c on a recorded traffic trace (see
+*              tools/ttrace.py) on a Linux machine, and prints the decision
+*              taken for every window:
+*
+*                gcc -O2 -Isource -o ps_policy tools/ps_policy_host.c \
+*                    source/ps_policy.c source/link_monitor.c \
+*                    source/traffic_trace.c source/tgen.c source/trace.c \
+*                    -lpthread
+*                ./ps_policy <trace.ttr> [window_s] [--no-twt] [--twt-refused]
+*                            [--rssi <dBm>] [--per <permille>] [--expect <mode>]
+*
+*              --no-twt classifies as for an AP without iTWT. With
+*              --twt-refused, the AP rejects the first iTWT setup: the mode
+*              in effect is kept and iTWT is not selected again, as on the
+*              target once the AP refused a setup.
+*
+*              --rssi and --per size the SP from the rate the link model
+*              expects at that RSSI and the given TX frame error rate, as the
+*              link monitor does on the target.
+*
+*              With --expect, the exit status is 1 when the mode in effect
+*              at the end of the trace is not the expected one (pm0, pm1,
+*              pm2, idle or active).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "link_monitor.h"
+#include "ps_policy.h"
+#include "traffic_trace.h"
+
+/* Standard C header files. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Function Name: parse_mode
+********************************************************************************
+* Summary:
+* Returns the mode named on the command line, or PS_POLICY_MODES.
+*
+*******************************************************************************/
+static ps_policy_mode_t parse_mode(const char *name)
+{
+    static const char *names[PS_POLICY_MODES] = { "pm0", "pm1", "pm2", "idle", "active" };
+
+    for(uint32_t i = 0; i < PS_POLICY_MODES; i++)
+    {
+        if(!strcmp(name, names[i]))
+        {
+            return (ps_policy_mode_t)i;
+        }
+    }
+
+    return PS_POLICY_MODES;
+}
+
+
+/*******************************************************************************
+* Function Name: print_decision
+********************************************************************************
+* Summary:
+* Prints the decision for the window ending at 'end_ms'.
+*
+*******************************************************************************/
+static void print_decision(uint32_t end_ms, const ps_policy_decision_t *decision, bool changed,
+                           ps_policy_mode_t current)
+{
+    printf("%10u %7u %7u %8u %9u %6u  %-12s %-20s %s%s\n", (unsigned)end_ms, (unsigned)decision->frames,
+           (unsigned)decision->load_kbps, (unsigned)decision->mean_gap_ms, (unsigned)decision->max_burst_bytes,
+           (unsigned)decision->sp_bytes,
+           ps_policy_mode_name(decision->mode), ps_policy_reason_name(decision->reason),
+           changed ? "-> " : "", ps_policy_mode_name(current));
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Feeds the sent and received events of the trace to the classifier, one
+* window at a time, starting in PM2 as after the connection manager joins.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint8_t bytes[TRAFFIC_TRACE_HEADER_LEN];
+    traffic_trace_header_t header;
+    traffic_trace_event_t event;
+    ps_policy_window_t window;
+    ps_policy_decision_t decision;
+    ps_policy_state_t state;
+    ps_policy_mode_t expect = PS_POLICY_MODES;
+    uint32_t window_ms = PS_POLICY_WINDOW_MS;
+    bool twt_capable = true;
+    bool twt_refused = false;
+    bool rssi_given = false;
+    int32_t rssi_dbm = -40;
+    uint32_t per_permille = 0;
+    uint32_t sp_bytes = 0;
+    uint64_t time_us = 0;
+    uint32_t windows = 0;
+    uint32_t changes = 0;
+    FILE *file;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace.ttr> [window_s] [--no-twt] [--twt-refused] [--rssi <dBm>]\n"
+                        "       [--per <permille>] [--expect <pm0|pm1|pm2|idle|active>]\n", argv[0]);
+        return 2;
+    }
+
+    for(int i = 2; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--no-twt"))
+        {
+            twt_capable = false;
+        }
+        else if(!strcmp(argv[i], "--twt-refused"))
+        {
+            twt_refused = true;
+        }
+        else if(!strcmp(argv[i], "--rssi") && (i + 1 < argc))
+        {
+            rssi_dbm = (int32_t)strtol(argv[++i], NULL, 0);
+            rssi_given = true;
+        }
+        else if(!strcmp(argv[i], "--per") && (i + 1 < argc))
+        {
+            per_permille = (uint32_t)strtoul(argv[++i], NULL, 0);
+            rssi_given = true;
+        }
+        else if(!strcmp(argv[i], "--expect") && (i + 1 < argc))
+        {
+            expect = parse_mode(argv[++i]);
+            if(expect == PS_POLICY_MODES)
+            {
+                fprintf(stderr, "Unknown mode %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if(strtoul(argv[i], NULL, 0) != 0u)
+        {
+            window_ms = (uint32_t)strtoul(argv[i], NULL, 0) * 1000u;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    file = fopen(argv[1], "rb");
+    if(file == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    if((fread(bytes, 1, TRAFFIC_TRACE_HEADER_LEN, file) != TRAFFIC_TRACE_HEADER_LEN) ||
+       !traffic_trace_decode_header(bytes, &header))
+    {
+        fprintf(stderr, "%s: not a traffic trace\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    if(rssi_given)
+    {
+        uint32_t rate_kbps = link_monitor_mcs_rate_kbps(link_monitor_model_mcs(rssi_dbm));
+
+        sp_bytes = link_monitor_sp_bytes(rate_kbps, per_permille, 0, PS_POLICY_SP_WD_US);
+        printf("SP: %u bytes at %u kbit/s, %u.%u%% frames lost\n", (unsigned)sp_bytes, (unsigned)rate_kbps,
+               (unsigned)(per_permille / 10u), (unsigned)(per_permille % 10u));
+    }
+
+    ps_policy_window_reset(&window, 0);
+    ps_policy_state_init(&state, PS_POLICY_PM2);
+
+    printf("%10s %7s %7s %8s %9s %6s  %-12s %-20s %s\n", "time(ms)", "frames", "kbit/s", "gap(ms)", "burst(B)",
+           "SP(B)", "decision", "reason", "mode");
+
+    for(uint32_t i = 0; (i < header.events) && (fread(bytes, 1, TRAFFIC_TRACE_EVENT_LEN, file) == TRAFFIC_TRACE_EVENT_LEN); i++)
+    {
+        traffic_trace_decode_event(bytes, &event);
+        time_us += event.delta_us;
+
+        /* Close the windows that ended before this event */
+        while((uint32_t)(time_us / 1000u) >= window.start_ms + window_ms)
+        {
+            uint32_t end_ms = window.start_ms + window_ms;
+            ps_policy_mode_t previous = state.current;
+            bool changed;
+
+            ps_policy_classify(&window, end_ms, twt_capable, sp_bytes, &decision);
+            changed = ps_policy_hold(&state, decision.mode);
+            changes += changed ? 1u : 0u;
+            windows++;
+            print_decision(end_ms, &decision, changed, state.current);
+
+            if(changed && twt_refused && twt_capable && (state.current >= PS_POLICY_ITWT_IDLE))
+            {
+                printf("%10s iTWT setup refused by the AP, %s kept\n", "", ps_policy_mode_name(previous));
+                ps_policy_state_init(&state, previous);
+                twt_capable = false;
+            }
+            ps_policy_window_reset(&window, end_ms);
+        }
+
+        ps_policy_observe(&window, (uint32_t)(time_us / 1000u), event.size);
+    }
+    fclose(file);
+
+    printf("%u windows of %u ms, %u mode changes, ending in %s\n", (unsigned)windows, (unsigned)window_ms,
+           (unsigned)changes, ps_policy_mode_name(state.current));
+
+    if((expect != PS_POLICY_MODES) && (expect != state.current))
+    {
+        printf("expected %s\n", ps_policy_mode_name(expect));
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/* [] END OF FILE */
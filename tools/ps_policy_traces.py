@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+################################################################################
+# \file ps_policy_traces.py
+# \version 1.0
+#
+# \brief
+# Reference traffic traces for the power-save mode selection
+# (source/ps_policy.c), with the mode each one must end in. It runs the host
+# build of the policy (tools/ps_policy_host.c) on every trace of
+# tools/traces and checks the mode in effect at the end.
+#
+# Usage: python3 ps_policy_traces.py [--policy ./ps_policy] [--traces dir]
+#        python3 ps_policy_traces.py --generate [--traces dir]
+#
+# --generate writes the .ttr files of the table below; the committed traces
+# are its output, and must be regenerated when the table changes. The exit
+# status is 1 when a trace does not end in its expected mode.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+# .ttr layout (source/traffic_trace.h, see tools/ttrace.py)
+HEADER = struct.Struct("<4sHHII")
+MAGIC = b"TTRC"
+VERSION = 1
+EVENT = struct.Struct("<IHBB")
+FLAG_RX = 0x80
+
+# Length of every trace: six windows of the default 10 s
+DURATION_MS = 60000
+
+TRACES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "traces")
+
+
+def periodic(period_ms, packets, duration_ms=DURATION_MS):
+    """Events (time in us, size, flow) of 'packets' repeated every period.
+    'packets' holds (offset in us, size, flow) from the start of the period."""
+    events = []
+    for start in range(0, duration_ms * 1000, period_ms * 1000):
+        events.extend((start + offset, size, flow) for offset, size, flow in packets)
+    return events
+
+
+# Name, events, ps_policy options, expected mode
+TRACES = [
+    # Sensor report of 100 bytes every 2 s, acknowledged by the server
+    ("sensor", periodic(2000, [(0, 100, 0), (5000, 60, FLAG_RX)]), [], "idle"),
+    # Telemetry of 200 bytes every 200 ms
+    ("telemetry", periodic(200, [(0, 200, 0)]), [], "active"),
+    # Voice: 160 bytes each way every 30 ms, too frequent for the iTWT modes
+    ("voice", periodic(30, [(0, 160, 0), (1000, 160, FLAG_RX)]), [], "pm2"),
+    # Camera: a 21 kB picture every 2 s, larger than a service period
+    ("camera", periodic(2000, [(i * 1000, 1400, 0) for i in range(15)]), [], "pm2"),
+    # Bulk upload at 320 kbit/s
+    ("upload", periodic(25, [(0, 1000, 0)]), [], "pm2"),
+    # Video stream at 2.8 Mbit/s
+    ("stream", periodic(4, [(0, 1400, FLAG_RX)]), [], "pm0"),
+    # The sensor behind an AP without iTWT, and behind one refusing the setup
+    ("sensor", None, ["--no-twt"], "pm1"),
+    ("sensor", None, ["--twt-refused"], "pm1"),
+]
+
+
+def encode(events):
+    """Returns the .ttr file of the events."""
+    events = sorted(events)
+    flows = len({flow & ~FLAG_RX for _, _, flow in events})
+    data = bytearray(HEADER.pack(MAGIC, VERSION, flows, len(events), DURATION_MS))
+    previous = 0
+    for time_us, size, flow in events:
+        data += EVENT.pack(time_us - previous, size, flow, 0)
+        previous = time_us
+    return bytes(data)
+
+
+def generate(directory):
+    """Writes the .ttr file of every trace of the table."""
+    os.makedirs(directory, exist_ok=True)
+    for name, events, _, _ in TRACES:
+        if events is None:
+            continue
+        path = os.path.join(directory, name + ".ttr")
+        with open(path, "wb") as file:
+            file.write(encode(events))
+        print("%s: %d events" % (path, len(events)))
+    return 0
+
+
+def check(policy, directory):
+    """Runs the policy on every trace, returns the failure count."""
+    failures = 0
+    for name, _, options, expected in TRACES:
+        path = os.path.join(directory, name + ".ttr")
+        result = subprocess.run([policy, path] + options + ["--expect", expected],
+                                stdout=subprocess.PIPE, universal_newlines=True)
+        lines = result.stdout.strip().splitlines()
+        summary = lines[-1] if lines else "no output"
+        if result.returncode != 0 and len(lines) >= 2:
+            summary = lines[-2]
+        mode = summary.split("ending in ", 1)[-1]
+        ok = result.returncode == 0
+        failures += 0 if ok else 1
+        print("%s %-40s %s (expected %s)" % ("PASS" if ok else "FAIL", " ".join([name] + options), mode, expected))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reference traces of the power-save mode selection")
+    parser.add_argument("--policy", default="./ps_policy", help="host build of tools/ps_policy_host.c")
+    parser.add_argument("--traces", default=TRACES_DIR, help="directory of the .ttr files")
+    parser.add_argument("--generate", action="store_true", help="write the .ttr files")
+    args = parser.parse_args()
+
+    if args.generate:
+        return generate(args.traces)
+
+    failures = check(args.policy, args.traces)
+    print("All checks passed" if failures == 0 else "Some checks failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,379 @@
+/******************************************************************************
+* File Name:   roam_host.c
+*
+* Description: This file runs the roaming logic of source/roam.c against mock
+*              APs on a Linux machine. The APs of one network stand along a
+*              line, each advertising its capabilities in IEs built here and
+*              parsed back by roam_parse_ies(). The STA walks along the line;
+*              its RSSI follows a log-distance path loss model. The RSSI is
+*              checked every ROAM_CHECK_MS as on the target and, below the
+*              trigger, the candidates are scanned and roam_select() decides.
+*              Each roam is printed with its modelled latency and TWT gap:
+*
+*                gcc -O2 -Isource -o roam tools/roam_host.c source/roam.c -lm
+*                ./roam [--trigger <dBm>] [--speed <cm/s>] [--no-twt]
+*                       [--expect <roams>]
+*
+*              --no-twt walks without an iTWT agreement, so that TWT support
+*              no longer weighs in the selection. With --expect, the exit
+*              status is 1 when the number of roams differs.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "roam.h"
+
+/* Standard C header files. */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Log-distance path loss: RSSI at 1 m and exponent (indoor, walls) */
+#define MOCK_RSSI_1M_DBM                (-40.0)
+#define MOCK_PATH_LOSS_EXPONENT         (2.7)
+
+#define MOCK_WALK_M                     (150u)
+#define MOCK_SPEED_CM_S                 (100u)
+
+/* Latency model of a roam: active scan dwell per channel, BSSID-targeted
+ * join (authentication, association, 4-way handshake), IP address, and the
+ * TWT setup exchange carried by the association */
+#define MOCK_SCAN_CHANNEL_MS            (110u)
+#define MOCK_JOIN_MS                    (90u)
+#define MOCK_IP_MS                      (250u)
+#define MOCK_TWT_SETUP_MS               (15u)
+
+#define MOCK_IE_MAX                     (64u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    const char *name;
+    uint32_t    x_m;            /* Position along the walk */
+    int32_t     tx_offset_db;   /* Relative to the path loss model */
+    uint8_t     channel;
+    uint32_t    caps;           /* ROAM_CAP_* advertised */
+    uint8_t     bssid[6];
+    uint8_t     ies[MOCK_IE_MAX];
+    uint32_t    ie_len;
+} mock_ap_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* B is the strongest past A but is not a TWT responder; C, a little weaker,
+ * keeps the agreement */
+static mock_ap_t mock_aps[] =
+{
+    { "A",   0u,  0,  1, ROAM_CAP_FT | ROAM_CAP_RRM | ROAM_CAP_BTM | ROAM_CAP_TWT, {0}, {0}, 0 },
+    { "B",  45u,  3,  6, ROAM_CAP_RRM,                                             {0}, {0}, 0 },
+    { "C",  48u,  0, 11, ROAM_CAP_FT | ROAM_CAP_BTM | ROAM_CAP_TWT,                {0}, {0}, 0 },
+    { "D", 100u,  0,  1, ROAM_CAP_TWT,                                             {0}, {0}, 0 },
+    { "E", 140u, -2,  6, ROAM_CAP_FT | ROAM_CAP_RRM | ROAM_CAP_BTM | ROAM_CAP_TWT, {0}, {0}, 0 },
+};
+
+#define MOCK_APS                        (sizeof(mock_aps) / sizeof(mock_aps[0]))
+
+
+/*******************************************************************************
+* Function Name: mock_build_ies
+********************************************************************************
+* Summary:
+* Builds the IEs a beacon of 'ap' carries for its capabilities: RSN with a
+* PSK or FT-PSK AKM and a Mobility Domain element for 802.11r, RM Enabled
+* Capabilities for 802.11k, Extended Capabilities for 802.11v and HE
+* Capabilities for the TWT responder.
+*
+*******************************************************************************/
+static void mock_build_ies(mock_ap_t *ap)
+{
+    static const uint8_t rsn_head[] = { 48, 20, 1, 0, 0x00, 0x0F, 0xAC, 4, 1, 0, 0x00, 0x0F, 0xAC, 4, 1, 0,
+                                        0x00, 0x0F, 0xAC };
+    uint8_t *p = ap->ies;
+
+    memcpy(p, rsn_head, sizeof(rsn_head));
+    p += sizeof(rsn_head);
+    *p++ = (ap->caps & ROAM_CAP_FT) ? 4u : 2u;
+    *p++ = 0;
+    *p++ = 0;
+
+    if(ap->caps & ROAM_CAP_FT)
+    {
+        *p++ = 54;
+        *p++ = 3;
+        *p++ = 0x34;
+        *p++ = 0x12;
+        *p++ = 0x01;
+    }
+
+    if(ap->caps & ROAM_CAP_RRM)
+    {
+        *p++ = 70;
+        *p++ = 5;
+        *p++ = 0x02;
+        memset(p, 0, 4);
+        p += 4;
+    }
+
+    *p++ = 127;
+    *p++ = 8;
+    memset(p, 0, 8);
+    p[2] = (ap->caps & ROAM_CAP_BTM) ? 0x08u : 0u;
+    p += 8;
+
+    *p++ = 255;
+    *p++ = 7;
+    *p++ = 35;
+    memset(p, 0, 6);
+    p[0] = (ap->caps & ROAM_CAP_TWT) ? 0x04u : 0u;
+    p += 6;
+
+    ap->ie_len = (uint32_t)(p - ap->ies);
+}
+
+
+/*******************************************************************************
+* Function Name: mock_rssi
+********************************************************************************
+* Summary:
+* Returns the RSSI of 'ap' at 'x_cm'.
+*
+*******************************************************************************/
+static int32_t mock_rssi(const mock_ap_t *ap, uint32_t x_cm)
+{
+    double d = fabs((double)x_cm / 100.0 - (double)ap->x_m);
+
+    if(d < 1.0)
+    {
+        d = 1.0;
+    }
+
+    return (int32_t)lround(MOCK_RSSI_1M_DBM - 10.0 * MOCK_PATH_LOSS_EXPONENT * log10(d)) + ap->tx_offset_db;
+}
+
+
+/*******************************************************************************
+* Function Name: mock_scan
+********************************************************************************
+* Summary:
+* Fills 'candidates' as the scan callback does on the target, the
+* capabilities coming from the IEs. Returns the number of distinct channels.
+*
+*******************************************************************************/
+static uint32_t mock_scan(roam_candidate_t *candidates, uint32_t x_cm)
+{
+    uint32_t channels = 0;
+    uint32_t seen = 0;
+
+    for(uint32_t i = 0; i < MOCK_APS; i++)
+    {
+        memcpy(candidates[i].bssid, mock_aps[i].bssid, sizeof(candidates[i].bssid));
+        candidates[i].rssi_dbm = mock_rssi(&mock_aps[i], x_cm);
+        candidates[i].channel = mock_aps[i].channel;
+        candidates[i].band = 0;
+        candidates[i].caps = roam_parse_ies(mock_aps[i].ies, mock_aps[i].ie_len);
+
+        if(!(seen & (1u << mock_aps[i].channel)))
+        {
+            seen |= 1u << mock_aps[i].channel;
+            channels++;
+        }
+    }
+
+    return channels;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Walks the STA past the mock APs and prints the roams and a summary.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    roam_candidate_t candidates[MOCK_APS];
+    int32_t trigger_dbm = ROAM_TRIGGER_DBM;
+    uint32_t speed_cm_s = MOCK_SPEED_CM_S;
+    bool twt = true;
+    long expect = -1;
+    uint32_t current = 0;
+    bool agreement = true;
+    uint32_t roams = 0;
+    uint32_t scans = 0;
+    uint32_t roam_ms_sum = 0;
+    uint32_t gap_ms_sum = 0;
+    uint32_t gaps = 0;
+    uint32_t lost_ms = 0;
+    uint32_t low_ms = 0;
+    uint32_t time_ms = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--trigger") && (i + 1 < argc))
+        {
+            trigger_dbm = (int32_t)strtol(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "--speed") && (i + 1 < argc))
+        {
+            speed_cm_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "--no-twt"))
+        {
+            twt = false;
+        }
+        else if(!strcmp(argv[i], "--expect") && (i + 1 < argc))
+        {
+            expect = strtol(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--trigger <dBm>] [--speed <cm/s>] [--no-twt] [--expect <roams>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if(speed_cm_s == 0u)
+    {
+        speed_cm_s = MOCK_SPEED_CM_S;
+    }
+    agreement = twt;
+
+    for(uint32_t i = 0; i < MOCK_APS; i++)
+    {
+        uint8_t bssid[6] = { 0x02, 0x00, 0x5e, 0x00, 0x01, (uint8_t)(0xa0u + i) };
+
+        memcpy(mock_aps[i].bssid, bssid, sizeof(bssid));
+        mock_build_ies(&mock_aps[i]);
+    }
+
+    printf("%8s %6s %4s %4s %5s %5s %8s %8s %s\n", "time(s)", "x(m)", "from", "to", "rssi", "after", "roam ms",
+           "gap ms", "caps");
+
+    for(uint32_t x_cm = 0; x_cm <= MOCK_WALK_M * 100u;
+        x_cm += speed_cm_s * ROAM_CHECK_MS / 1000u, time_ms += ROAM_CHECK_MS)
+    {
+        int32_t rssi_dbm = mock_rssi(&mock_aps[current], x_cm);
+        uint32_t channels;
+        uint32_t roam_ms;
+        int index;
+
+        if(twt && !agreement)
+        {
+            lost_ms += ROAM_CHECK_MS;
+        }
+        if(rssi_dbm >= trigger_dbm)
+        {
+            continue;
+        }
+
+        low_ms += ROAM_CHECK_MS;
+        channels = mock_scan(candidates, x_cm);
+        scans++;
+
+        index = roam_select(candidates, MOCK_APS, mock_aps[current].bssid, rssi_dbm, agreement);
+        if(index < 0)
+        {
+            continue;
+        }
+
+        roam_ms = channels * MOCK_SCAN_CHANNEL_MS + MOCK_JOIN_MS + MOCK_IP_MS;
+        printf("%4u.%03u %6u %4s %4s %5d %5d %8u ", (unsigned)(time_ms / 1000u), (unsigned)(time_ms % 1000u),
+               (unsigned)(x_cm / 100u), mock_aps[current].name, mock_aps[index].name, (int)rssi_dbm,
+               (int)candidates[index].rssi_dbm, (unsigned)roam_ms);
+
+        /* The agreement is asked for in the association to the new AP; it
+         * is lost on an AP that is not a TWT responder */
+        if(!twt)
+        {
+            printf("%8s ", "-");
+        }
+        else if(candidates[index].caps & ROAM_CAP_TWT)
+        {
+            uint32_t gap_ms = roam_ms + MOCK_TWT_SETUP_MS;
+
+            printf("%8u ", (unsigned)gap_ms);
+            gap_ms_sum += gap_ms;
+            gaps++;
+            agreement = true;
+        }
+        else
+        {
+            printf("%8s ", "lost");
+            agreement = false;
+        }
+
+        printf("%c%c%c%c\n", (candidates[index].caps & ROAM_CAP_FT) ? 'r' : '-',
+               (candidates[index].caps & ROAM_CAP_RRM) ? 'k' : '-', (candidates[index].caps & ROAM_CAP_BTM) ? 'v' : '-',
+               (candidates[index].caps & ROAM_CAP_TWT) ? 'T' : '-');
+
+        roam_ms_sum += roam_ms;
+        roams++;
+        current = (uint32_t)index;
+    }
+
+    printf("\n%u roams, %u scans, %u s below %d dBm", (unsigned)roams, (unsigned)scans, (unsigned)(low_ms / 1000u),
+           (int)trigger_dbm);
+    if(roams != 0u)
+    {
+        printf(", average roam %u ms", (unsigned)(roam_ms_sum / roams));
+    }
+    if(gaps != 0u)
+    {
+        printf(", average TWT gap %u ms", (unsigned)(gap_ms_sum / gaps));
+    }
+    if(twt)
+    {
+        printf(", %u s without an agreement", (unsigned)(lost_ms / 1000u));
+    }
+    printf("\n");
+
+    return ((expect >= 0) && ((long)roams != expect)) ? 1 : 0;
+}
+
+
+/* [] END OF FILE */
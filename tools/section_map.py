@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+################################################################################
+# \file section_map.py
+# \version 1.0
+#
+# \brief
+# Generates a linker script fragment that keeps the hottest functions in RAM
+# when the application executes from flash (CODE_PLACEMENT=profile).
+#
+# The call-frequency profile is either a gprof flat profile ("gprof -b -p")
+# or a CSV file with "name,calls,cycles" lines, such as the output of the
+# "func_prof" command of a FUNC_PROFILE=1 build, which names functions by
+# address. Function sizes and addresses are taken from the application ELF
+# file with "nm". With --after, the self cycles per call of the selected
+# functions are compared with a profile of the CODE_PLACEMENT=profile build.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import re
+import subprocess
+import sys
+
+# Functions that run before the hot section is copied to RAM, or that must
+# never move: startup code, vector table and the copy routine itself.
+DEFAULT_EXCLUDES = [
+    r"^Reset_Handler$", r"^SystemInit", r"^__libc_init_array$", r"^main$",
+    r"^cybsp_init", r"^Cy_SysLib", r"^code_placement_",
+]
+
+
+def parse_profile(path):
+    """Returns {name: (calls, weight)} from a gprof flat profile or a CSV."""
+    profile = {}
+    gprof_line = re.compile(
+        r"^\s*([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+(\d+)?\s*([\d.]+)?\s*([\d.]+)?\s+(\S+)\s*$")
+
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("#"):
+                continue
+            if "," in line:
+                fields = [x.strip() for x in line.split(",")]
+                if len(fields) >= 3 and fields[1].isdigit() and fields[2].isdigit():
+                    name, calls, cycles = fields[0], int(fields[1]), int(fields[2])
+                    old = profile.get(name, (0, 0))
+                    profile[name] = (old[0] + calls, old[1] + cycles)
+                continue
+
+            match = gprof_line.match(line)
+            if match:
+                self_seconds = float(match.group(3))
+                calls = int(match.group(4)) if match.group(4) else 0
+                name = match.group(7)
+                old = profile.get(name, (0, 0))
+                # Weight by self time; calls break ties for functions below
+                # the sampling resolution.
+                profile[name] = (old[0] + calls, old[1] + int(self_seconds * 1e6))
+
+    return profile
+
+
+def read_symbols(elf, nm):
+    """Returns {name: size} and {address: name} for the text symbols of the ELF file."""
+    sizes, names = {}, {}
+    output = subprocess.run([nm, "-S", "--size-sort", elf],
+                            check=True, capture_output=True, text=True).stdout
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in ("T", "t"):
+            sizes[fields[3]] = int(fields[1], 16)
+            # Clear the Thumb bit; func_prof reports the same address
+            names[int(fields[0], 16) & ~1] = fields[3]
+    return sizes, names
+
+
+def resolve_addresses(profile, names):
+    """Replaces "0x..." function addresses of the profile by symbol names."""
+    resolved = {}
+    for key, (calls, weight) in profile.items():
+        name = key
+        if key.startswith("0x"):
+            name = names.get(int(key, 16) & ~1, key)
+        old = resolved.get(name, (0, 0))
+        resolved[name] = (old[0] + calls, old[1] + weight)
+    return resolved
+
+
+def select_hot(profile, sizes, budget, excludes):
+    """Picks functions by descending weight until the RAM budget is used up."""
+    patterns = [re.compile(x) for x in excludes]
+    ranked = sorted(profile.items(), key=lambda kv: (kv[1][1], kv[1][0]), reverse=True)
+    total_weight = sum(w for _, (_, w) in ranked) or 1
+    hot, used, covered = [], 0, 0
+
+    for name, (calls, weight) in ranked:
+        if weight == 0 and calls == 0:
+            continue
+        if any(p.search(name) for p in patterns):
+            continue
+        size = sizes.get(name)
+        if size is None:
+            # Host-only symbol or inlined away on target
+            continue
+        if used + size > budget:
+            continue
+        hot.append(name)
+        used += size
+        covered += weight
+
+    return hot, used, covered * 100.0 / total_weight
+
+
+def write_fragment(path, hot, ram_region, flash_region):
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("/* Generated by tools/section_map.py. Do not edit. */\n")
+        f.write("SECTIONS\n{\n")
+        f.write("    .app_hot_text :\n    {\n")
+        f.write("        . = ALIGN(4);\n")
+        f.write("        __app_hot_text_start = .;\n")
+        for name in hot:
+            f.write("        *(.text.%s)\n" % name)
+        f.write("        . = ALIGN(4);\n")
+        f.write("        __app_hot_text_end = .;\n")
+        f.write("    } > %s AT > %s\n" % (ram_region, flash_region))
+        f.write("    __app_hot_text_load = LOADADDR(.app_hot_text);\n")
+        f.write("}\nINSERT BEFORE .text;\n")
+
+
+def compare(before, after, hot):
+    """Prints the self cycles per call of the hot functions in both profiles."""
+    ranked = sorted(hot, key=lambda name: before.get(name, (0, 0))[1], reverse=True)
+    print("%-40s %12s %12s %8s" % ("function", "cycles/call", "after", "change"))
+    total_before, total_after = 0, 0
+    for name in ranked:
+        calls_b, cycles_b = before.get(name, (0, 0))
+        calls_a, cycles_a = after.get(name, (0, 0))
+        if calls_b == 0 or calls_a == 0:
+            print("%-40s %12s %12s %8s" % (name, calls_b and cycles_b // calls_b or "-",
+                                           calls_a and cycles_a // calls_a or "-", "-"))
+            continue
+        per_b, per_a = cycles_b / calls_b, cycles_a / calls_a
+        total_before += cycles_b
+        # Same number of calls as the first run, for the totals
+        total_after += per_a * calls_b
+        print("%-40s %12d %12d %+7.1f%%" % (name, per_b, per_a, (per_a - per_b) * 100.0 / per_b))
+    if total_before:
+        print("Hot functions, cycles of the first run: %d before, %d after (%+.1f%%)" %
+              (total_before, total_after, (total_after - total_before) * 100.0 / total_before))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the hot code linker script fragment")
+    parser.add_argument("--profile", required=True, help="gprof flat profile or name,calls,cycles CSV")
+    parser.add_argument("--after", help="profile of the CODE_PLACEMENT=profile build to compare with")
+    parser.add_argument("--after-elf", help="ELF file of the build profiled for --after")
+    parser.add_argument("--elf", required=True, help="application ELF file")
+    parser.add_argument("--nm", default="arm-none-eabi-nm", help="nm executable")
+    parser.add_argument("--budget", type=lambda x: int(x, 0), default=0x8000,
+                        help="RAM bytes available for hot code (default 0x8000)")
+    parser.add_argument("--ram-region", default="ram", help="linker memory region for hot code")
+    parser.add_argument("--flash-region", default="flash", help="linker memory region holding the load image")
+    parser.add_argument("--exclude", action="append", default=[], help="regex of functions to keep in place")
+    parser.add_argument("-o", "--output", default="hot_sections.ld", help="linker script fragment to write")
+    args = parser.parse_args()
+
+    profile = parse_profile(args.profile)
+    if not profile:
+        sys.exit("No profile entries found in %s" % args.profile)
+
+    sizes, names = read_symbols(args.elf, args.nm)
+    profile = resolve_addresses(profile, names)
+    hot, used, coverage = select_hot(profile, sizes, args.budget, DEFAULT_EXCLUDES + args.exclude)
+    write_fragment(args.output, hot, args.ram_region, args.flash_region)
+
+    text_total = sum(sizes.values())
+    print("Profiled functions      : %d" % len(profile))
+    print("Hot functions in RAM    : %d (%d bytes, %.1f%% of profile weight)" % (len(hot), used, coverage))
+    print("Code in RAM, APPEXEC=ram: %d bytes" % text_total)
+    print("RAM reclaimed           : %d bytes" % (text_total - used))
+    print("Wrote %s" % args.output)
+
+    if args.after:
+        # Functions moved, so the addresses of the second profile are
+        # resolved with the ELF file of its own build
+        after_names = names
+        if args.after_elf:
+            _, after_names = read_symbols(args.after_elf, args.nm)
+        after = resolve_addresses(parse_profile(args.after), after_names)
+        compare(profile, after, hot)
+
+
+if __name__ == "__main__":
+    main()
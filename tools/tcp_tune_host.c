@@ -0,0 +1,423 @@
+/******************************************************************************
+* File Name:   tcp_tune_host.c
+*
+* Description: This file checks the TCP timer tuning of source/tcp_tune.c on
+*              a Linux machine against a simulated iTWT link. The kit sends
+*              a report over TCP every 1.5 s. Each one waits in WHD for the
+*              next SP, the server acknowledges it after the WAN delay, and
+*              the ACKs that miss the SP stay buffered at the AP until the
+*              next one. The sender retransmits on its retransmission timeout
+*              with exponential backoff, as NetX Duo does, with the default
+*              timeout or the one tcp_tune_min_rto_ms() sets. The frames
+*              handed to WHD and received from it are passed to the
+*              accounting of source/tcp_tune.c at their simulated times:
+*
+*                gcc -O2 -Isource -o tcp_tune tools/tcp_tune_host.c \
+*                    source/tcp_tune.c -lpthread
+*                ./tcp_tune
+*
+*              The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "tcp_tune.h"
+#include "twt_session.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Simulation step; the simulated cycle counter counts microseconds */
+#define STEP_US                         (100u)
+
+/* WCM idle profile, as accepted by the AP of the README captures */
+#define IDLE_WI_US                      (TWT_IDLE_WI_MANTISSA << TWT_IDLE_WI_EXPONENT)
+#define IDLE_WD_US                      (TWT_IDLE_WD * TWT_WD_UNIT_US)
+
+/* Retransmission timeout of NetX Duo, and the upper bound of its backoff */
+#define DEFAULT_RTO_MS                  (1000u)
+#define MAX_RTO_MS                      (64000u)
+
+/* One-way delay between the AP and the server */
+#define WAN_DELAY_US                    (10000u)
+
+/* The application sends SEGMENT_LEN bytes every SEND_PERIOD_US, longer
+ * than a round trip: each segment is sent with no other one outstanding,
+ * at a different offset from the SPs */
+#define SEGMENT_LEN                     (100u)
+#define SEND_PERIOD_US                  (1500000u)
+#define SEGMENTS                        (20u)
+
+/* Frames in flight in one direction */
+#define MAX_FRAMES                      (64u)
+
+#define FRAME_LEN                       (14u + 20u + 20u)
+#define FLAG_ACK                        (0x10u)
+
+#define KIT_IP                          (0xC0A80002u)
+#define SERVER_IP                       (0xC0A80001u)
+#define SERVER_PORT                     (5001u)
+
+
+/*******************************************************************************
+* Data Structures
+********************************************************************************/
+typedef struct
+{
+    uint32_t wake_interval_us;      /* 0 without iTWT */
+    uint32_t wake_duration_us;
+    uint32_t rto_ms;
+    uint32_t drop_segment;          /* Segment lost on its first transmission, 0 for none */
+    uint16_t local_port;
+} link_config_t;
+
+typedef struct
+{
+    uint32_t time_us;               /* Time at which the frame reaches the next hop */
+    uint32_t seq;                   /* Sequence number, or ACK number for ACKs */
+    bool     drop;
+} link_frame_t;
+
+typedef struct
+{
+    link_frame_t frames[MAX_FRAMES];
+    uint32_t     count;
+} link_queue_t;
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static uint32_t failures;
+
+
+/*******************************************************************************
+* Function Name: queue_push / queue_pop
+********************************************************************************
+* Summary:
+* FIFO of the frames waiting in one place of the link.
+*
+*******************************************************************************/
+static void queue_push(link_queue_t *queue, uint32_t time_us, uint32_t seq, bool drop)
+{
+    if(queue->count < MAX_FRAMES)
+    {
+        queue->frames[queue->count].time_us = time_us;
+        queue->frames[queue->count].seq = seq;
+        queue->frames[queue->count].drop = drop;
+        queue->count++;
+    }
+}
+
+static link_frame_t queue_pop(link_queue_t *queue)
+{
+    link_frame_t frame = queue->frames[0];
+
+    queue->count--;
+    memmove(&queue->frames[0], &queue->frames[1], queue->count * sizeof(queue->frames[0]));
+
+    return frame;
+}
+
+
+/*******************************************************************************
+* Function Name: in_sp
+********************************************************************************
+* Summary:
+* Tells whether the kit is awake; always without iTWT.
+*
+*******************************************************************************/
+static bool in_sp(const link_config_t *config, uint32_t now)
+{
+    return (config->wake_interval_us == 0u) || ((now % config->wake_interval_us) < config->wake_duration_us);
+}
+
+
+/*******************************************************************************
+* Function Name: frame_build
+********************************************************************************
+* Summary:
+* Builds the Ethernet, IPv4 and TCP headers of a segment between the kit and
+* the server. The payload itself is not needed by the accounting.
+*
+*******************************************************************************/
+static void frame_build(uint8_t *frame, bool from_kit, uint16_t local_port, uint32_t seq, uint32_t ack,
+                        uint32_t payload)
+{
+    uint8_t *ip = &frame[14];
+    uint8_t *tcp = &frame[34];
+    uint32_t src = from_kit ? KIT_IP : SERVER_IP;
+    uint32_t dst = from_kit ? SERVER_IP : KIT_IP;
+    uint16_t sport = from_kit ? local_port : SERVER_PORT;
+    uint16_t dport = from_kit ? SERVER_PORT : local_port;
+    uint32_t total = 40u + payload;
+
+    memset(frame, 0, FRAME_LEN);
+    frame[12] = 0x08u;
+    ip[0] = 0x45u;
+    ip[2] = (uint8_t)(total >> 8);
+    ip[3] = (uint8_t)total;
+    ip[9] = 6u;
+    for(uint32_t i = 0; i < 4u; i++)
+    {
+        ip[12u + i] = (uint8_t)(src >> (24u - (8u * i)));
+        ip[16u + i] = (uint8_t)(dst >> (24u - (8u * i)));
+        tcp[4u + i] = (uint8_t)(seq >> (24u - (8u * i)));
+        tcp[8u + i] = (uint8_t)(ack >> (24u - (8u * i)));
+    }
+    tcp[0] = (uint8_t)(sport >> 8);
+    tcp[1] = (uint8_t)sport;
+    tcp[2] = (uint8_t)(dport >> 8);
+    tcp[3] = (uint8_t)dport;
+    tcp[12] = 0x50u;
+    tcp[13] = FLAG_ACK;
+}
+
+
+/*******************************************************************************
+* Function Name: simulate
+********************************************************************************
+* Summary:
+* Runs the stream over the link and returns once every segment is
+* acknowledged. Segments are numbered from 1 in order of sequence.
+*
+*******************************************************************************/
+static void simulate(const link_config_t *config)
+{
+    link_queue_t whd = { .count = 0 };          /* Kit to AP, waiting for an SP */
+    link_queue_t wan_up = { .count = 0 };       /* AP to server */
+    link_queue_t wan_down = { .count = 0 };     /* Server to AP */
+    link_queue_t ap = { .count = 0 };           /* ACKs buffered at the AP */
+    uint8_t frame[FRAME_LEN];
+    uint32_t snd_nxt = 0;
+    uint32_t snd_una = 0;
+    uint32_t rcv_nxt = 0;
+    bool received[SEGMENTS + 1u] = { false };
+    uint32_t timer_start = 0;
+    uint32_t rto_ms = config->rto_ms;
+    uint32_t sent = 0;
+    bool dropped = false;
+
+    for(uint32_t now = 0; (sent < SEGMENTS) || (snd_una != snd_nxt); now += STEP_US)
+    {
+        /* Application: a new segment, which starts the timer if it is idle */
+        if((sent < SEGMENTS) && (now >= sent * SEND_PERIOD_US))
+        {
+            bool drop = (config->drop_segment == sent + 1u);
+
+            if(snd_una == snd_nxt)
+            {
+                timer_start = now;
+            }
+            frame_build(frame, true, config->local_port, snd_nxt, rcv_nxt, SEGMENT_LEN);
+            tcp_tune_frame_at(true, frame, FRAME_LEN, now);
+            queue_push(&whd, now, snd_nxt, drop);
+            dropped |= drop;
+            snd_nxt += SEGMENT_LEN;
+            sent++;
+        }
+
+        /* Retransmission of the oldest segment not acknowledged */
+        if((snd_una != snd_nxt) && ((now - timer_start) >= (rto_ms * 1000u)))
+        {
+            frame_build(frame, true, config->local_port, snd_una, rcv_nxt, SEGMENT_LEN);
+            tcp_tune_frame_at(true, frame, FRAME_LEN, now);
+            queue_push(&whd, now, snd_una, false);
+            timer_start = now;
+            rto_ms = ((2u * rto_ms) < MAX_RTO_MS) ? (2u * rto_ms) : MAX_RTO_MS;
+        }
+
+        /* The kit sends and receives in SPs only */
+        while((whd.count != 0u) && in_sp(config, now))
+        {
+            link_frame_t segment = queue_pop(&whd);
+
+            if(!segment.drop)
+            {
+                queue_push(&wan_up, now + WAN_DELAY_US, segment.seq, false);
+            }
+        }
+        while((ap.count != 0u) && in_sp(config, now))
+        {
+            link_frame_t ack = queue_pop(&ap);
+
+            frame_build(frame, false, config->local_port, 0u, ack.seq, 0u);
+            tcp_tune_frame_at(false, frame, FRAME_LEN, now);
+            if((int32_t)(ack.seq - snd_una) > 0)
+            {
+                snd_una = ack.seq;
+                timer_start = now;
+                rto_ms = config->rto_ms;
+            }
+        }
+
+        /* Server: cumulative ACK of every segment received, out of order
+         * segments being kept */
+        while((wan_up.count != 0u) && (wan_up.frames[0].time_us <= now))
+        {
+            link_frame_t segment = queue_pop(&wan_up);
+
+            received[segment.seq / SEGMENT_LEN] = true;
+            while(received[rcv_nxt / SEGMENT_LEN])
+            {
+                rcv_nxt += SEGMENT_LEN;
+            }
+            queue_push(&wan_down, now + WAN_DELAY_US, rcv_nxt, false);
+        }
+        while((wan_down.count != 0u) && (wan_down.frames[0].time_us <= now))
+        {
+            link_frame_t ack = queue_pop(&wan_down);
+
+            queue_push(&ap, now, ack.seq, false);
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: run
+********************************************************************************
+* Summary:
+* Runs one scenario on fresh counters and returns the counters of the set it
+* was counted in.
+*
+*******************************************************************************/
+static tcp_tune_counters_t run(const link_config_t *config, bool enabled, bool twt)
+{
+    tcp_tune_counters_t default_timers;
+    tcp_tune_counters_t twt_timers;
+
+    tcp_tune_reset_counters();
+    tcp_tune_select(enabled, twt);
+    simulate(config);
+    tcp_tune_get_counters(&default_timers, &twt_timers);
+
+    return twt ? twt_timers : default_timers;
+}
+
+
+/*******************************************************************************
+* Function Name: expect
+********************************************************************************
+* Summary:
+* Compares a counter with the expected value.
+*
+*******************************************************************************/
+static void expect(const char *name, uint32_t value, uint32_t expected)
+{
+    bool ok = (value == expected);
+
+    printf("%s %-44s %4" PRIu32 " (expected %4" PRIu32 ")\n", ok ? "PASS" : "FAIL", name, value, expected);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: expect_some
+********************************************************************************
+* Summary:
+* Checks that a counter is not zero.
+*
+*******************************************************************************/
+static void expect_some(const char *name, uint32_t value)
+{
+    bool ok = (value != 0u);
+
+    printf("%s %-44s %4" PRIu32 " (expected  > 0)\n", ok ? "PASS" : "FAIL", name, value);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Runs the checks.
+*
+*******************************************************************************/
+int main(void)
+{
+    uint32_t tuned_ms = tcp_tune_min_rto_ms(IDLE_WI_US, IDLE_WD_US, DEFAULT_RTO_MS);
+    link_config_t config;
+    tcp_tune_counters_t counters;
+
+    printf("Idle profile: WI %" PRIu32 " us, WD %" PRIu32 " us, retransmission timeout %" PRIu32 " ms "
+           "(default %u ms)\n", (uint32_t)IDLE_WI_US, (uint32_t)IDLE_WD_US, tuned_ms, DEFAULT_RTO_MS);
+
+    /* Without iTWT, the default timeout is long enough */
+    config = (link_config_t){ 0u, 0u, DEFAULT_RTO_MS, 0u, 49152u };
+    counters = run(&config, true, false);
+    expect("no iTWT: segments", counters.segments, SEGMENTS);
+    expect("no iTWT: retransmits", counters.retransmits, 0u);
+
+    /* Idle profile with the default timeout: the ACKs buffered at the AP
+     * arrive after the timeout, and every retransmission is spurious */
+    config = (link_config_t){ IDLE_WI_US, IDLE_WD_US, DEFAULT_RTO_MS, 0u, 49153u };
+    counters = run(&config, true, false);
+    expect_some("iTWT, default timers: retransmits", counters.retransmits);
+    expect("iTWT, default timers: spurious", counters.spurious, counters.retransmits);
+
+    /* Same link with the tuned timeout */
+    config = (link_config_t){ IDLE_WI_US, IDLE_WD_US, tuned_ms, 0u, 49154u };
+    counters = run(&config, true, true);
+    expect("iTWT, tuned timers: segments", counters.segments, SEGMENTS);
+    expect("iTWT, tuned timers: retransmits", counters.retransmits, 0u);
+
+    /* A segment lost over the air is retransmitted once, and not spurious */
+    config = (link_config_t){ IDLE_WI_US, IDLE_WD_US, tuned_ms, 10u, 49155u };
+    counters = run(&config, true, true);
+    expect("iTWT, tuned timers, loss: retransmits", counters.retransmits, 1u);
+    expect("iTWT, tuned timers, loss: spurious", counters.spurious, 0u);
+
+    /* With the tuning off, frames are not inspected */
+    config = (link_config_t){ IDLE_WI_US, IDLE_WD_US, DEFAULT_RTO_MS, 0u, 49156u };
+    counters = run(&config, false, false);
+    expect("tuning off: segments", counters.segments, 0u);
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,225 @@
+/******************************************************************************
+* File Name:   tgen_host.c
+*
+* Description: This file is the entry point of the host build of the traffic
+*              generator, which runs the same generator and echo sink as the
+*              tgen console command on a Linux machine:
+*
+*                gcc -O2 -Isource -o tgen tools/tgen_host.c source/tgen.c \
+*                    source/traffic_trace.c source/trace.c -lpthread
+*                ./tgen sink [port]
+*                ./tgen [--trace] <profile> <host[,host]> <interval_ms> <size|min-max> <count> [burst] [port]
+*                ./tgen [--trace] replay <trace.ttr> <host> [port]
+*
+*              With --trace, the packets sent and echoed are recorded by
+*              the event tracer and printed at the end in the format of
+*              "trace dump" on the kit, for tools/trace2json.py.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "tgen.h"
+#include "trace.h"
+#include "traffic_trace.h"
+
+/* Standard C header files. */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Function Name: replay
+********************************************************************************
+* Summary:
+* Replays a binary traffic trace (see tools/ttrace.py) against a sink.
+*
+*******************************************************************************/
+static int replay(const char *path, const char *host, uint16_t port)
+{
+    uint8_t bytes[TRAFFIC_TRACE_HEADER_LEN];
+    traffic_trace_header_t header;
+    traffic_trace_event_t *events;
+    traffic_trace_replay_t state;
+    tgen_config_t config;
+    tgen_result_t result;
+    uint32_t count = 0;
+    FILE *file = fopen(path, "rb");
+
+    if(file == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+
+    if((fread(bytes, 1, TRAFFIC_TRACE_HEADER_LEN, file) != TRAFFIC_TRACE_HEADER_LEN) ||
+       !traffic_trace_decode_header(bytes, &header))
+    {
+        fprintf(stderr, "%s: not a traffic trace\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    events = calloc(header.events + 1u, sizeof(*events));
+    while((events != NULL) && (count < header.events) &&
+          (fread(bytes, 1, TRAFFIC_TRACE_EVENT_LEN, file) == TRAFFIC_TRACE_EVENT_LEN))
+    {
+        traffic_trace_decode_event(bytes, &events[count++]);
+    }
+    fclose(file);
+
+    if(events == NULL)
+    {
+        return 1;
+    }
+
+    memset(&config, 0, sizeof(config));
+    strncpy(config.hosts[0], host, TGEN_HOST_LEN - 1u);
+    config.destinations = 1;
+    config.port = port;
+
+    traffic_trace_replay_init(&state, events, count);
+    if(tgen_run_source(&config, traffic_trace_replay_next, &state, &result) != 0)
+    {
+        free(events);
+        return 1;
+    }
+
+    printf("replay: %u events, %u flows, %u ms\n", (unsigned)count, (unsigned)header.flows,
+           (unsigned)header.duration_ms);
+    printf("  sent %u, echoed %u, lost %u, %u kbit/s\n", (unsigned)result.sent, (unsigned)result.received,
+           (unsigned)(result.sent - result.received),
+           (result.duration_ms != 0u) ? (unsigned)(((result.bytes + result.echo_bytes) * 8u) / result.duration_ms) : 0u);
+    printf("  rtt us: min %u p50 %u p95 %u max %u avg %u\n", (unsigned)result.rtt_min_us, (unsigned)result.rtt_p50_us,
+           (unsigned)result.rtt_p95_us, (unsigned)result.rtt_max_us, (unsigned)result.rtt_avg_us);
+
+    free(events);
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: run
+********************************************************************************
+* Summary:
+* Runs a trace replay, or one generator profile followed by its report.
+*
+*******************************************************************************/
+static int run(int argc, char *argv[], const char *program)
+{
+    tgen_config_t config;
+    tgen_result_t result;
+
+    if((argc >= 4) && !strcmp(argv[1], "replay"))
+    {
+        return replay(argv[2], argv[3], (argc > 4) ? (uint16_t)strtoul(argv[4], NULL, 0) : (uint16_t)TGEN_DEFAULT_PORT);
+    }
+
+    if(!tgen_parse(argc - 1, &argv[1], &config))
+    {
+        fprintf(stderr, "Usage: %s sink [port]\n", program);
+        fprintf(stderr, "       %s [--trace] <periodic|bursty|poisson> <host[,host]> <interval_ms> <size|min-max> <count> [burst] [port]\n",
+                program);
+        fprintf(stderr, "       %s [--trace] replay <trace.ttr> <host> [port]\n", program);
+        return 2;
+    }
+
+    if(tgen_run(&config, &result) != 0)
+    {
+        return 1;
+    }
+
+    tgen_print_result(&config, &result);
+
+    return 0;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Runs the sink, or a replay or generator profile, optionally traced as the
+* tgen console command is on the kit.
+*
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *program = argv[0];
+    bool traced = false;
+    uint16_t command = 0;
+    int status;
+
+    if((argc >= 2) && !strcmp(argv[1], "sink"))
+    {
+        uint16_t port = (argc > 2) ? (uint16_t)strtoul(argv[2], NULL, 0) : (uint16_t)TGEN_DEFAULT_PORT;
+
+        printf("Sink listening on UDP port %u\n", (unsigned)port);
+        fflush(stdout);
+        if(tgen_sink(port) != 0)
+        {
+            perror("sink");
+        }
+        return 1;
+    }
+
+    if((argc >= 2) && !strcmp(argv[1], "--trace"))
+    {
+        traced = true;
+        argc--;
+        argv++;
+
+        trace_init();
+        trace_enable(true);
+        command = trace_string("tgen");
+        trace_record(TRACE_EVT_CMD_START, command, 0);
+    }
+
+    status = run(argc, argv, program);
+
+    if(traced)
+    {
+        trace_record(TRACE_EVT_CMD_END, command, (uint32_t)status);
+        trace_dump();
+    }
+
+    return status;
+}
+
+
+/* [] END OF FILE */
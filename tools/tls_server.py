@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+################################################################################
+# \file tls_server.py
+# \version 1.0
+#
+# \brief
+# TLS server stand-in for the session resumption cache (source/tls_session.c).
+# It reports, for every handshake, whether the session offered by the client
+# was resumed, and checks the sequence against the expected one.
+#
+# Usage: python3 tls_server.py [--port 4433] [--cert cert.pem --key key.pem]
+#                              [--tls12] [--expect full,resumed,...]
+#        python3 tls_server.py --self-test
+#
+# Without --cert, a self-signed certificate is generated with the openssl
+# command. Run "tls_connect <host IP> 4433 3" on the kit against
+# "--expect full,resumed,resumed": the server exits once the expected number
+# of handshakes is reached, with status 1 if a handshake was not the expected
+# one. What the kit prints for each connect must match the server's lines.
+# --tls12 limits the server to TLS 1.2, for TLS ports without TLS 1.3
+# resumption. --self-test runs a Python client against the server.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import threading
+
+DEFAULT_PORT = 4433
+
+
+def make_certificate(directory):
+    """Generates a self-signed certificate, returns (cert, key) paths."""
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:P-256",
+                    "-nodes", "-days", "1", "-subj", "/CN=tls-server-stand-in",
+                    "-keyout", key, "-out", cert],
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return cert, key
+
+
+def server_context(cert, key, tls12):
+    """Server context with the session cache and session tickets enabled."""
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(cert, key)
+    if tls12:
+        context.maximum_version = ssl.TLSVersion.TLSv1_2
+    return context
+
+
+def serve(listener, context, count, results):
+    """Accepts 'count' handshakes and appends "full" or "resumed" for each."""
+    while len(results) < count:
+        connection, peer = listener.accept()
+        try:
+            with context.wrap_socket(connection, server_side=True) as tls:
+                kind = "resumed" if tls.session_reused else "full"
+                print("%s:%d %s %s handshake" % (peer[0], peer[1], tls.version(), kind), flush=True)
+                results.append(kind)
+                # Echo one byte: a TLS 1.3 client reads its tickets then
+                try:
+                    if tls.recv(1):
+                        tls.sendall(b"x")
+                except (OSError, ssl.SSLError):
+                    pass
+        except (OSError, ssl.SSLError) as error:
+            print("%s:%d handshake failed: %s" % (peer[0], peer[1], error), flush=True)
+            results.append("failed")
+
+
+def check(results, expected):
+    """Prints one PASS/FAIL line per handshake, returns the failure count."""
+    failures = 0
+    for i, kind in enumerate(expected):
+        got = results[i] if i < len(results) else "-"
+        ok = got == kind
+        failures += 0 if ok else 1
+        print("%s handshake %d: %s (expected %s)" % ("PASS" if ok else "FAIL", i + 1, got, kind))
+    return failures
+
+
+def self_test(cert, key):
+    """Connects a Python client three times, offering the previous session."""
+    failures = 0
+    for tls12 in (True, False):
+        listener = socket.create_server(("127.0.0.1", 0))
+        port = listener.getsockname()[1]
+        results = []
+        server = threading.Thread(target=serve, args=(listener, server_context(cert, key, tls12), 3, results))
+        server.start()
+
+        client = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        client.check_hostname = False
+        client.verify_mode = ssl.CERT_NONE
+        session = None
+        for _ in range(3):
+            with socket.create_connection(("127.0.0.1", port)) as raw:
+                with client.wrap_socket(raw, server_hostname="localhost", session=session) as tls:
+                    # TLS 1.3 tickets arrive after the handshake
+                    tls.sendall(b"x")
+                    tls.recv(1)
+                    session = tls.session
+        server.join()
+        listener.close()
+
+        print("TLS 1.2 only" if tls12 else "TLS 1.3")
+        failures += check(results, ["full", "resumed", "resumed"])
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TLS server stand-in reporting session resumption")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--cert")
+    parser.add_argument("--key")
+    parser.add_argument("--tls12", action="store_true", help="limit the server to TLS 1.2")
+    parser.add_argument("--expect", help="comma-separated sequence of full/resumed handshakes")
+    parser.add_argument("--self-test", action="store_true", help="check the server with a Python client")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as directory:
+        cert, key = (args.cert, args.key) if args.cert else make_certificate(directory)
+
+        if args.self_test:
+            failures = self_test(cert, key)
+        else:
+            expected = args.expect.split(",") if args.expect else []
+            listener = socket.create_server(("", args.port))
+            print("Listening on port %d" % args.port, flush=True)
+            results = []
+            try:
+                serve(listener, server_context(cert, key, args.tls12), len(expected) or sys.maxsize, results)
+            except KeyboardInterrupt:
+                pass
+            failures = check(results, expected)
+
+    if args.self_test or args.expect:
+        print("All checks passed" if failures == 0 else "Some checks failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
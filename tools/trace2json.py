@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+################################################################################
+# \file trace2json.py
+# \version 1.0
+#
+# \brief
+# Converts the output of the "trace dump" console command into Chrome trace
+# JSON, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+#
+# Usage: python3 trace2json.py <console log> [-o trace.json]
+#
+# Lines that are not part of a dump are ignored, so a complete terminal log
+# can be passed. If the log holds several dumps, the last one is converted.
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import json
+import sys
+
+# Event types, see trace_event_type_t in source/trace.h
+THREAD_ENTER, THREAD_EXIT, ISR_ENTER, ISR_EXIT, SP_START, SP_END, \
+    PKT_ENQUEUE, PKT_DEQUEUE, CMD_START, CMD_END, TWT_SETUP, TWT_TEARDOWN, MARK = range(1, 14)
+
+QUEUE_NAMES = {0: "wlan_tx", 1: "wlan_rx", 2: "app"}
+PROFILE_NAMES = {1: "idle", 2: "active"}
+
+# Fixed tracks; threads use their control block address as tid
+TID_ISR, TID_TWT, TID_NET, TID_CONSOLE = 1, 2, 3, 4
+
+
+def parse_dump(lines):
+    """Returns (hz, lost, threads, strings, events) of the last dump in the log."""
+    dump = None
+    for line in lines:
+        fields = line.strip().split(" ", 2)
+        if not fields or not fields[0]:
+            continue
+        tag = fields[0]
+        if tag == "TRACE":
+            parts = line.split()
+            dump = {"hz": int(parts[2]), "lost": int(parts[4]), "threads": {}, "strings": {}, "events": []}
+        elif dump is None:
+            continue
+        elif tag == "N" and len(fields) == 3:
+            dump["threads"][int(fields[1], 16)] = fields[2]
+        elif tag == "S" and len(fields) == 3:
+            dump["strings"][int(fields[1])] = fields[2]
+        elif tag == "E":
+            parts = line.split()
+            dump["events"].append((int(parts[1], 16), int(parts[2], 16), int(parts[3], 16), int(parts[4], 16)))
+        elif tag == "END":
+            last = dump
+            dump = None
+            yield last
+
+
+def to_us(events, hz):
+    """Unwraps the 32-bit cycle counter and converts timestamps to microseconds."""
+    base, prev, high = None, None, 0
+    for ts, etype, arg16, arg32 in events:
+        if prev is not None and ts < prev:
+            high += 1 << 32
+        prev = ts
+        absolute = high + ts
+        if base is None:
+            base = absolute
+        yield (absolute - base) * 1e6 / hz, etype, arg16, arg32
+
+
+def convert(dump):
+    out = []
+    strings = dump["strings"]
+    threads = dict(dump["threads"])
+    open_thread, open_isr, open_sp, open_cmd = {}, None, None, {}
+
+    def meta(tid, name):
+        out.append({"ph": "M", "name": "thread_name", "pid": 0, "tid": tid, "args": {"name": name}})
+
+    meta(TID_ISR, "ISR")
+    meta(TID_TWT, "TWT SP (predicted)")
+    meta(TID_NET, "WLAN packets")
+    meta(TID_CONSOLE, "Console commands")
+
+    seen_threads = set()
+    for us, etype, arg16, arg32 in to_us(dump["events"], dump["hz"]):
+        if etype == THREAD_ENTER:
+            open_thread[arg32] = us
+            seen_threads.add(arg32)
+        elif etype == THREAD_EXIT and arg32 in open_thread:
+            start = open_thread.pop(arg32)
+            out.append({"ph": "X", "name": threads.get(arg32, "0x%08x" % arg32), "pid": 0,
+                        "tid": arg32, "ts": start, "dur": us - start})
+        elif etype == ISR_ENTER:
+            open_isr = (us, arg16)
+        elif etype == ISR_EXIT and open_isr is not None:
+            out.append({"ph": "X", "name": "IRQ %d" % (open_isr[1] - 16), "pid": 0,
+                        "tid": TID_ISR, "ts": open_isr[0], "dur": us - open_isr[0]})
+            open_isr = None
+        elif etype == SP_START:
+            open_sp = us
+        elif etype == SP_END and open_sp is not None:
+            out.append({"ph": "X", "name": "SP flow %d" % arg16, "pid": 0,
+                        "tid": TID_TWT, "ts": open_sp, "dur": us - open_sp})
+            open_sp = None
+        elif etype in (PKT_ENQUEUE, PKT_DEQUEUE):
+            out.append({"ph": "i", "s": "t", "name": QUEUE_NAMES.get(arg16, "queue %d" % arg16),
+                        "pid": 0, "tid": TID_NET, "ts": us, "args": {"len": arg32}})
+        elif etype == CMD_START:
+            open_cmd[arg16] = us
+        elif etype == CMD_END and arg16 in open_cmd:
+            start = open_cmd.pop(arg16)
+            out.append({"ph": "X", "name": strings.get(arg16, "cmd %d" % arg16), "pid": 0,
+                        "tid": TID_CONSOLE, "ts": start, "dur": us - start,
+                        "args": {"result": "0x%08x" % arg32}})
+        elif etype == TWT_SETUP:
+            out.append({"ph": "i", "s": "g", "name": "iTWT setup (%s, WI %d us)" %
+                        (PROFILE_NAMES.get(arg16, arg16), arg32), "pid": 0, "tid": TID_TWT, "ts": us})
+        elif etype == TWT_TEARDOWN:
+            out.append({"ph": "i", "s": "g", "name": "iTWT teardown", "pid": 0, "tid": TID_TWT, "ts": us})
+        elif etype == MARK:
+            out.append({"ph": "i", "s": "t", "name": strings.get(arg16, "mark"), "pid": 0,
+                        "tid": TID_CONSOLE, "ts": us, "args": {"value": arg32}})
+
+    for tid in seen_threads:
+        meta(tid, threads.get(tid, "0x%08x" % tid))
+
+    return {"traceEvents": out, "displayTimeUnit": "ms",
+            "otherData": {"events_lost": dump["lost"], "cycle_counter_hz": dump["hz"]}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a trace dump to Chrome trace JSON")
+    parser.add_argument("log", help="console log holding the output of 'trace dump'")
+    parser.add_argument("-o", "--output", default="trace.json", help="JSON file to write")
+    args = parser.parse_args()
+
+    with open(args.log, "r", encoding="utf-8", errors="replace") as f:
+        dumps = list(parse_dump(f))
+    if not dumps:
+        sys.exit("No complete trace dump found in %s" % args.log)
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        json.dump(convert(dumps[-1]), f)
+
+    print("Wrote %s (%d events, %d lost)" % (args.output, len(dumps[-1]["events"]), dumps[-1]["lost"]))
+
+
+if __name__ == "__main__":
+    main()
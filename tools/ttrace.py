@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+################################################################################
+# \file ttrace.py
+# \version 1.0
+#
+# \brief
+# Moves binary traffic traces (source/traffic_trace.h) between the kit and a
+# host, and summarizes them.
+#
+# Usage: python3 ttrace.py <console log> [-o trace.ttr]
+#        python3 ttrace.py --listen 19001 [-o trace.ttr]
+#        python3 ttrace.py --serve 19001 trace.ttr
+#        python3 ttrace.py --info trace.ttr
+#
+# A console log holding the output of "ttrace dump", or a trace received from
+# "ttrace send <host IP> 19001", is written as a .ttr file. --serve sends a
+# .ttr file to every kit running "ttrace load <host IP> 19001". A .ttr file is
+# replayed on a host with "tgen replay" (see tools/tgen_host.c).
+#
+################################################################################
+# \copyright
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+import argparse
+import binascii
+import socket
+import struct
+import sys
+
+# Header: magic, version, flows, events, duration in ms (little endian)
+HEADER = struct.Struct("<4sHHII")
+MAGIC = b"TTRC"
+VERSION = 1
+
+# Event: delta in us, size, flow (bit 7 set for data received), reserved
+EVENT = struct.Struct("<IHBB")
+FLAG_RX = 0x80
+
+
+def parse_dump(lines):
+    """Yields the binary trace of every complete "ttrace dump" in the log."""
+    data = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TTRACE "):
+            data = bytearray()
+        elif data is not None and line == "END":
+            yield bytes(data)
+            data = None
+        elif data is not None:
+            try:
+                data += binascii.unhexlify(line)
+            except (binascii.Error, ValueError):
+                data = None
+
+
+def decode(data):
+    """Returns (flows, duration_ms, events) of a binary trace."""
+    if len(data) < HEADER.size:
+        raise ValueError("trace too short")
+    magic, version, flows, count, duration_ms = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a traffic trace")
+    events = [EVENT.unpack_from(data, HEADER.size + i * EVENT.size)
+              for i in range(min(count, (len(data) - HEADER.size) // EVENT.size))]
+    return flows, duration_ms, events
+
+
+def receive(port):
+    """Waits for one connection from the kit and returns the received bytes."""
+    with socket.create_server(("", port)) as server:
+        print("Waiting for 'ttrace send <host IP> %d' on the kit..." % port)
+        conn, peer = server.accept()
+        chunks = []
+        with conn:
+            while True:
+                chunk = conn.recv(4096)
+                if not chunk:
+                    break
+                chunks.append(chunk)
+    print("Received %d bytes from %s" % (sum(len(c) for c in chunks), peer[0]))
+    return b"".join(chunks)
+
+
+def serve(port, data):
+    """Sends the trace to every kit that connects, until interrupted."""
+    with socket.create_server(("", port)) as server:
+        print("Serving %d bytes; run 'ttrace load <host IP> %d' on the kit (Ctrl+C to stop)" % (len(data), port))
+        while True:
+            conn, peer = server.accept()
+            with conn:
+                conn.sendall(data)
+            print("Sent to %s" % peer[0])
+
+
+def info(data):
+    flows, duration_ms, events = decode(data)
+    print("Events  : %d" % len(events))
+    print("Duration: %d ms" % duration_ms)
+    print("Flows   : %d" % flows)
+    print("%-6s %8s %10s %8s %10s" % ("flow", "sent", "bytes", "recv", "bytes"))
+    for flow in range(flows):
+        tx = [size for _, size, f, _ in events if f == flow]
+        rx = [size for _, size, f, _ in events if f == (flow | FLAG_RX)]
+        print("%-6d %8d %10d %8d %10d" % (flow, len(tx), sum(tx), len(rx), sum(rx)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert, transfer and summarize traffic traces")
+    parser.add_argument("log", nargs="?", help="console log holding the output of 'ttrace dump', or a .ttr file")
+    parser.add_argument("--listen", type=int, metavar="PORT", help="receive the trace from 'ttrace send'")
+    parser.add_argument("--serve", type=int, metavar="PORT", help="send the .ttr file to 'ttrace load'")
+    parser.add_argument("--info", action="store_true", help="summarize the .ttr file")
+    parser.add_argument("-o", "--output", default="trace.ttr", help=".ttr file to write")
+    args = parser.parse_args()
+
+    if args.serve is not None or args.info:
+        if args.log is None:
+            parser.error("a .ttr file is required")
+        with open(args.log, "rb") as f:
+            data = f.read()
+        try:
+            decode(data)
+        except ValueError as e:
+            sys.exit("%s: %s" % (args.log, e))
+        if args.info:
+            info(data)
+        else:
+            serve(args.serve, data)
+        return
+
+    if args.listen is not None:
+        data = receive(args.listen)
+    elif args.log is not None:
+        with open(args.log, "r", encoding="utf-8", errors="replace") as f:
+            dumps = list(parse_dump(f))
+        if not dumps:
+            sys.exit("No complete trace dump found")
+        data = dumps[-1]
+    else:
+        parser.error("a console log, --listen, --serve or --info is required")
+
+    try:
+        _, _, events = decode(data)
+    except ValueError as e:
+        sys.exit(str(e))
+
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    print("Wrote %s (%d events)" % (args.output, len(events)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,321 @@
+/******************************************************************************
+* File Name:   twt_frame_host.c
+*
+* Description: This file checks the TWT action frame decoder of
+*              source/twt_frame.c on a Linux machine against frame vectors:
+*              TWT Setup suggest, accept and reject, TWT Teardown and TWT
+*              Information frames, truncated and malformed variants, and the
+*              same frames as carried by the WHD events:
+*
+*                gcc -O2 -Isource -o twt_frame tools/twt_frame_host.c \
+*                    source/twt_frame.c
+*                ./twt_frame
+*
+*              The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "twt_frame.h"
+
+/* Standard C header files. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Bare frame body, not carried by an event */
+#define BODY                            (0u)
+
+/* wl_event_rx_frame_data_t and 802.11 management header of the action frame event */
+#define RX_FRAME_DATA_LEN               (16u)
+#define DOT11_HEADER_LEN                (24u)
+#define EVENT_DATA_MAX                  (128u)
+
+/* Event not carrying a TWT frame (WLC_E_LINK) */
+#define WHD_EVENT_LINK                  (16u)
+
+#define VECTOR(bytes)                   (bytes), sizeof(bytes)
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static uint32_t failures;
+
+static const char *status_names[] = { "ok", "not TWT", "truncated", "malformed" };
+
+/* TWT Setup suggest sent by the STA: request, trigger-enabled, implicit, flow
+ * 0, WI 7 * 2^13 us, WD 32 * 256 us, TWT 0x12345678 */
+static const uint8_t frame_suggest[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01,
+    TWT_FRAME_ELEMENT_ID, 15, 0x00, 0x33, 0x34,
+    0x78, 0x56, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x07, 0x00, 0x00
+};
+
+static const twt_frame_t decoded_suggest =
+{
+    .kind = TWT_FRAME_SETUP, .dialog_token = 1, .setup_command = TWT_FRAME_CMD_SUGGEST,
+    .flags = TWT_FRAME_FLAG_REQUEST | TWT_FRAME_FLAG_TRIGGER | TWT_FRAME_FLAG_IMPLICIT,
+    .wi_exponent = 13, .wi_mantissa = 7, .wake_duration = 32, .target_wake_time = 0x12345678u
+};
+
+/* TWT Setup accept sent by the AP: flow 1, WI 256 * 2^13 us, WD 64 TUs,
+ * TWT 0x504030201000 */
+static const uint8_t frame_accept[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01,
+    TWT_FRAME_ELEMENT_ID, 15, 0x20, 0xB8, 0x34,
+    0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x00, 0x00,
+    0x40, 0x00, 0x01, 0x00
+};
+
+static const twt_frame_t decoded_accept =
+{
+    .kind = TWT_FRAME_SETUP, .dialog_token = 1, .setup_command = TWT_FRAME_CMD_ACCEPT, .flow_id = 1,
+    .flags = TWT_FRAME_FLAG_TRIGGER | TWT_FRAME_FLAG_IMPLICIT | TWT_FRAME_FLAG_WD_UNIT_TU,
+    .wi_exponent = 13, .wi_mantissa = 256, .wake_duration = 64, .target_wake_time = 0x504030201000u
+};
+
+/* TWT Setup reject sent by the AP, without the Target Wake Time field */
+static const uint8_t frame_reject[] =
+{
+    TWT_FRAME_CATEGORY_S1G, TWT_FRAME_ACTION_SETUP, 0x02,
+    TWT_FRAME_ELEMENT_ID, 7, 0x00, 0x0E, 0x28,
+    0x10, 0x10, 0x00, 0x00
+};
+
+static const twt_frame_t decoded_reject =
+{
+    .kind = TWT_FRAME_SETUP, .dialog_token = 2, .setup_command = TWT_FRAME_CMD_REJECT,
+    .wi_exponent = 10, .wi_mantissa = 16, .wake_duration = 16
+};
+
+/* TWT Setup accept of a broadcast TWT: ID 5, WI 100 * 2^10 us */
+static const uint8_t frame_broadcast_accept[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x03,
+    TWT_FRAME_ELEMENT_ID, 10, 0x08, 0x08, 0x28,
+    0x34, 0x12, 0x10, 0x64, 0x00, 0x28, 0x00
+};
+
+static const twt_frame_t decoded_broadcast_accept =
+{
+    .kind = TWT_FRAME_SETUP, .dialog_token = 3, .negotiation_type = 2, .setup_command = TWT_FRAME_CMD_ACCEPT,
+    .flow_id = 5, .flags = TWT_FRAME_FLAG_BROADCAST,
+    .wi_exponent = 10, .wi_mantissa = 100, .wake_duration = 16, .target_wake_time = 0x1234u
+};
+
+/* TWT Teardown of flow 1, of all flows, and of broadcast TWT 5 */
+static const uint8_t frame_teardown[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_TEARDOWN, 0x01 };
+static const uint8_t frame_teardown_all[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_TEARDOWN, 0x80 };
+static const uint8_t frame_teardown_broadcast[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_TEARDOWN, 0x45 };
+
+static const twt_frame_t decoded_teardown = { .kind = TWT_FRAME_TEARDOWN, .flow_id = 1 };
+static const twt_frame_t decoded_teardown_all = { .kind = TWT_FRAME_TEARDOWN, .flags = TWT_FRAME_FLAG_ALL_TWT };
+static const twt_frame_t decoded_teardown_broadcast =
+{
+    .kind = TWT_FRAME_TEARDOWN, .negotiation_type = 2, .flow_id = 5, .flags = TWT_FRAME_FLAG_BROADCAST
+};
+
+/* TWT Information of flow 2 with a 64-bit next TWT, and of all flows without one */
+static const uint8_t frame_info[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_INFORMATION, 0x62,
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+};
+static const uint8_t frame_info_all[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_INFORMATION, 0x82 };
+
+static const twt_frame_t decoded_info =
+{
+    .kind = TWT_FRAME_INFORMATION, .flow_id = 2, .next_twt_bits = 64, .target_wake_time = 0x0807060504030201u
+};
+static const twt_frame_t decoded_info_all = { .kind = TWT_FRAME_INFORMATION, .flow_id = 2, .flags = TWT_FRAME_FLAG_ALL_TWT };
+
+/* Frames that must not be decoded */
+static const uint8_t frame_setup_no_token[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP };
+static const uint8_t frame_setup_no_element[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01 };
+static const uint8_t frame_setup_short_element[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01,
+    TWT_FRAME_ELEMENT_ID, 2, 0x00, 0x33
+};
+/* Target Wake Time field of 4 octets */
+static const uint8_t frame_setup_bad_length[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01,
+    TWT_FRAME_ELEMENT_ID, 11, 0x00, 0x33, 0x34,
+    0x78, 0x56, 0x34, 0x12, 0x20, 0x07, 0x00, 0x00
+};
+static const uint8_t frame_teardown_short[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_TEARDOWN };
+static const uint8_t frame_info_short[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_INFORMATION, 0x62, 0x01, 0x02, 0x03, 0x04
+};
+static const uint8_t frame_public[] = { 4u, 0u, 0x01 };
+
+
+/*******************************************************************************
+* Function Name: check
+********************************************************************************
+* Summary:
+* Decodes a frame, or the data of an event if 'event' is not BODY, and
+* compares the status and, if decoded, the fields with the expected ones.
+*
+*******************************************************************************/
+static void check(const char *name, uint32_t event, const uint8_t *data, size_t length,
+                  twt_frame_status_t expected_status, const twt_frame_t *expected)
+{
+    twt_frame_t frame;
+    twt_frame_status_t status = (event == BODY) ? twt_frame_decode(data, length, &frame) :
+                                                  twt_frame_decode_event(event, data, length, &frame);
+    bool ok = (status == expected_status);
+
+    if(ok && (status == TWT_FRAME_OK))
+    {
+        ok = (frame.kind == expected->kind) && (frame.dialog_token == expected->dialog_token) &&
+             (frame.negotiation_type == expected->negotiation_type) &&
+             (frame.setup_command == expected->setup_command) && (frame.flow_id == expected->flow_id) &&
+             (frame.flags == expected->flags) && (frame.wi_exponent == expected->wi_exponent) &&
+             (frame.wi_mantissa == expected->wi_mantissa) && (frame.wake_duration == expected->wake_duration) &&
+             (frame.next_twt_bits == expected->next_twt_bits) &&
+             (frame.target_wake_time == expected->target_wake_time);
+    }
+
+    printf("%s %-40s %-9s (expected %s)\n", ok ? "PASS" : "FAIL", name, status_names[status],
+           status_names[expected_status]);
+
+    if(!ok && (status == TWT_FRAME_OK))
+    {
+        printf("     command %u flow %u flags 0x%02x WI %u * 2^%u WD %u TWT 0x%" PRIx64 " next TWT bits %u\n",
+               frame.setup_command, frame.flow_id, frame.flags, frame.wi_mantissa, frame.wi_exponent,
+               frame.wake_duration, frame.target_wake_time, frame.next_twt_bits);
+    }
+
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: action_frame_event
+********************************************************************************
+* Summary:
+* Builds the data of the action frame event carrying a frame body: the
+* received frame information, then the 802.11 management header with the
+* given first Frame Control octet.
+*
+*******************************************************************************/
+static size_t action_frame_event(uint8_t *data, uint8_t fc, const uint8_t *body, size_t length)
+{
+    memset(data, 0, RX_FRAME_DATA_LEN + DOT11_HEADER_LEN);
+    data[0] = 1u;                               /* Version */
+    data[2] = 36u;                              /* Channel */
+    data[RX_FRAME_DATA_LEN] = fc;
+    memcpy(&data[RX_FRAME_DATA_LEN + DOT11_HEADER_LEN], body, length);
+
+    return RX_FRAME_DATA_LEN + DOT11_HEADER_LEN + length;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Runs the checks.
+*
+*******************************************************************************/
+int main(void)
+{
+    uint8_t event[EVENT_DATA_MAX];
+    size_t length;
+
+    check("setup suggest", BODY, VECTOR(frame_suggest), TWT_FRAME_OK, &decoded_suggest);
+    check("setup accept", BODY, VECTOR(frame_accept), TWT_FRAME_OK, &decoded_accept);
+    check("setup reject", BODY, VECTOR(frame_reject), TWT_FRAME_OK, &decoded_reject);
+    check("setup accept, broadcast", BODY, VECTOR(frame_broadcast_accept), TWT_FRAME_OK, &decoded_broadcast_accept);
+    check("teardown", BODY, VECTOR(frame_teardown), TWT_FRAME_OK, &decoded_teardown);
+    check("teardown, all flows", BODY, VECTOR(frame_teardown_all), TWT_FRAME_OK, &decoded_teardown_all);
+    check("teardown, broadcast", BODY, VECTOR(frame_teardown_broadcast), TWT_FRAME_OK, &decoded_teardown_broadcast);
+    check("info, next TWT", BODY, VECTOR(frame_info), TWT_FRAME_OK, &decoded_info);
+    check("info, all flows", BODY, VECTOR(frame_info_all), TWT_FRAME_OK, &decoded_info_all);
+
+    check("setup without dialog token", BODY, VECTOR(frame_setup_no_token), TWT_FRAME_TRUNCATED, NULL);
+    check("setup without element", BODY, VECTOR(frame_setup_no_element), TWT_FRAME_TRUNCATED, NULL);
+    check("setup suggest, element cut", BODY, frame_suggest, sizeof(frame_suggest) - 3u, TWT_FRAME_TRUNCATED, NULL);
+    check("setup accept, element cut", BODY, frame_accept, 10u, TWT_FRAME_TRUNCATED, NULL);
+    check("setup reject, element cut", BODY, frame_reject, sizeof(frame_reject) - 1u, TWT_FRAME_TRUNCATED, NULL);
+    check("setup, element too short", BODY, VECTOR(frame_setup_short_element), TWT_FRAME_MALFORMED, NULL);
+    check("setup, bad optional fields", BODY, VECTOR(frame_setup_bad_length), TWT_FRAME_MALFORMED, NULL);
+    check("teardown without flow", BODY, VECTOR(frame_teardown_short), TWT_FRAME_TRUNCATED, NULL);
+    check("info, next TWT cut", BODY, VECTOR(frame_info_short), TWT_FRAME_TRUNCATED, NULL);
+    check("public action frame", BODY, VECTOR(frame_public), TWT_FRAME_NOT_TWT, NULL);
+
+    check("setup event, accept", TWT_FRAME_EVENT_SETUP, VECTOR(frame_accept), TWT_FRAME_OK, &decoded_accept);
+    check("setup event, suggest cut", TWT_FRAME_EVENT_SETUP, frame_suggest, 12u, TWT_FRAME_TRUNCATED, NULL);
+    check("teardown event, teardown", TWT_FRAME_EVENT_TEARDOWN, VECTOR(frame_teardown), TWT_FRAME_OK,
+          &decoded_teardown);
+    check("teardown event, setup frame", TWT_FRAME_EVENT_TEARDOWN, VECTOR(frame_accept), TWT_FRAME_MALFORMED, NULL);
+    check("info event, info", TWT_FRAME_EVENT_INFORMATION, VECTOR(frame_info), TWT_FRAME_OK, &decoded_info);
+    check("info event, one octet", TWT_FRAME_EVENT_INFORMATION, frame_info, 1u, TWT_FRAME_TRUNCATED, NULL);
+
+    length = action_frame_event(event, 0xD0u, VECTOR(frame_reject));
+    check("action frame event, reject", TWT_FRAME_EVENT_ACTION_FRAME, event, length, TWT_FRAME_OK, &decoded_reject);
+    length = action_frame_event(event, 0xE0u, VECTOR(frame_teardown));
+    check("action no ack event, teardown", TWT_FRAME_EVENT_ACTION_FRAME, event, length, TWT_FRAME_OK,
+          &decoded_teardown);
+    length = action_frame_event(event, 0xD0u, VECTOR(frame_accept));
+    check("action frame event, accept cut", TWT_FRAME_EVENT_ACTION_FRAME, event, length - 4u, TWT_FRAME_TRUNCATED,
+          NULL);
+    check("action frame event, header cut", TWT_FRAME_EVENT_ACTION_FRAME, event, RX_FRAME_DATA_LEN + 10u,
+          TWT_FRAME_TRUNCATED, NULL);
+    length = action_frame_event(event, 0xD0u, VECTOR(frame_public));
+    check("action frame event, public action", TWT_FRAME_EVENT_ACTION_FRAME, event, length, TWT_FRAME_NOT_TWT, NULL);
+    length = action_frame_event(event, 0x80u, VECTOR(frame_accept));
+    check("action frame event, beacon", TWT_FRAME_EVENT_ACTION_FRAME, event, length, TWT_FRAME_NOT_TWT, NULL);
+    check("link event", WHD_EVENT_LINK, VECTOR(frame_accept), TWT_FRAME_NOT_TWT, NULL);
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */
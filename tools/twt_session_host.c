@@ -0,0 +1,228 @@
+/******************************************************************************
+* File Name:   twt_session_host.c
+*
+* Description: This file checks the iTWT agreement tracking of
+*              source/twt_session.c on a Linux machine by replaying the
+*              TWT events of joins, as twt_log reports them: an Accept
+*              during the join, after it, during a join that fails, a
+*              Reject, a Teardown by the AP, and a join without iTWT:
+*
+*                gcc -O2 -Isource -o twt_session tools/twt_session_host.c \
+*                    source/twt_session.c source/twt_frame.c source/trace.c \
+*                    -lpthread
+*                ./twt_session
+*
+*              The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "twt_session.h"
+
+/* Standard C header files. */
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define VECTOR(bytes)                   (bytes), sizeof(bytes)
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static uint32_t failures;
+
+static const char *profile_names[] = { "none", "idle", "active" };
+static const char *support_names[] = { "unknown", "accepted", "refused" };
+
+/* TWT Setup accept of the idle profile, as in the README captures: flow 0,
+ * trigger-enabled, implicit, WI 75 * 2^13 us, WD 32 * 256 us */
+static const uint8_t setup_accept_idle[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x01,
+    TWT_FRAME_ELEMENT_ID, 15, 0x00, 0x38, 0x34,
+    0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x00, 0x00,
+    0x20, 0x4B, 0x00, 0x00
+};
+
+/* Same for the active profile: WI 7 * 2^13 us */
+static const uint8_t setup_accept_active[] =
+{
+    TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_SETUP, 0x02,
+    TWT_FRAME_ELEMENT_ID, 15, 0x00, 0x38, 0x34,
+    0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x00, 0x00,
+    0x20, 0x07, 0x00, 0x00
+};
+
+/* TWT Setup reject, without the Target Wake Time field */
+static const uint8_t setup_reject[] =
+{
+    TWT_FRAME_CATEGORY_S1G, TWT_FRAME_ACTION_SETUP, 0x03,
+    TWT_FRAME_ELEMENT_ID, 7, 0x00, 0x0E, 0x28,
+    0x10, 0x10, 0x00, 0x00
+};
+
+/* TWT Teardown of all flows */
+static const uint8_t teardown_all[] = { TWT_FRAME_CATEGORY_UNPROTECTED_S1G, TWT_FRAME_ACTION_TEARDOWN, 0x80 };
+
+
+/*******************************************************************************
+* Function Name: event
+********************************************************************************
+* Summary:
+* Reports a TWT event received from the AP, as the twt_log event handler does.
+*
+*******************************************************************************/
+static void event(uint32_t event_type, const uint8_t *data, size_t length)
+{
+    twt_frame_t frame;
+
+    if(twt_frame_decode_event(event_type, data, length, &frame) == TWT_FRAME_OK)
+    {
+        twt_session_frame(&frame, true);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: check
+********************************************************************************
+* Summary:
+* Compares the profile of the tracked agreement, "none" without one, and its
+* wake interval with the expected ones.
+*
+*******************************************************************************/
+static void check(const char *name, bool active, cy_wcm_itwt_profile_t profile, uint32_t wi_us)
+{
+    twt_session_agreement_t agreement;
+    bool ok;
+
+    twt_session_get(&agreement);
+    ok = (agreement.active == active) &&
+         (!active || ((agreement.profile == profile) && (twt_session_wake_interval_us(&agreement) == wi_us)));
+
+    printf("%s %-40s %s (expected %s)\n", ok ? "PASS" : "FAIL", name,
+           agreement.active ? profile_names[agreement.profile] : "none", active ? profile_names[profile] : "none");
+
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: check_support
+********************************************************************************
+* Summary:
+* Compares what the AP answered with the expected answer.
+*
+*******************************************************************************/
+static void check_support(const char *name, twt_session_support_t expected)
+{
+    twt_session_support_t support = twt_session_support();
+    bool ok = (support == expected);
+
+    printf("%s %-40s %s (expected %s)\n", ok ? "PASS" : "FAIL", name, support_names[support],
+           support_names[expected]);
+
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Replays the joins and runs the checks.
+*
+*******************************************************************************/
+int main(void)
+{
+    const uint32_t idle_wi_us   = 75u << 13;
+    const uint32_t active_wi_us = 7u << 13;
+
+    /* The Accept arrives while WCM is still joining */
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_IDLE);
+    event(TWT_FRAME_EVENT_SETUP, VECTOR(setup_accept_idle));
+    twt_session_join_done(true);
+    check("accept during the join", true, CY_WCM_ITWT_PROFILE_IDLE, idle_wi_us);
+    check_support("AP answer", TWT_SESSION_SUPPORT_ACCEPTED);
+
+    /* Rejoin with the other profile, the Accept arriving after the join */
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_ACTIVE);
+    check("previous agreement ends with the join", false, CY_WCM_ITWT_PROFILE_NONE, 0u);
+    twt_session_join_done(true);
+    event(TWT_FRAME_EVENT_SETUP, VECTOR(setup_accept_active));
+    check("accept after the join", true, CY_WCM_ITWT_PROFILE_ACTIVE, active_wi_us);
+
+    /* The join fails after the Accept */
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_IDLE);
+    event(TWT_FRAME_EVENT_SETUP, VECTOR(setup_accept_idle));
+    twt_session_join_done(false);
+    check("accept during a failed join", false, CY_WCM_ITWT_PROFILE_NONE, 0u);
+
+    /* A join without iTWT */
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_IDLE);
+    event(TWT_FRAME_EVENT_SETUP, VECTOR(setup_accept_idle));
+    twt_session_join_done(true);
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_NONE);
+    twt_session_join_done(true);
+    check("join without iTWT", false, CY_WCM_ITWT_PROFILE_NONE, 0u);
+
+    /* The AP tears the agreement down */
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_ACTIVE);
+    event(TWT_FRAME_EVENT_SETUP, VECTOR(setup_accept_active));
+    twt_session_join_done(true);
+    event(TWT_FRAME_EVENT_TEARDOWN, VECTOR(teardown_all));
+    check("teardown by the AP", false, CY_WCM_ITWT_PROFILE_NONE, 0u);
+    check_support("AP answer after the teardown", TWT_SESSION_SUPPORT_REFUSED);
+
+    /* The AP rejects the setup during the join */
+    twt_session_reset_support();
+    twt_session_join_start(CY_WCM_ITWT_PROFILE_IDLE);
+    event(TWT_FRAME_EVENT_SETUP, VECTOR(setup_reject));
+    twt_session_join_done(true);
+    check("reject during the join", false, CY_WCM_ITWT_PROFILE_NONE, 0u);
+    check_support("AP answer after the reject", TWT_SESSION_SUPPORT_REFUSED);
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,278 @@
+/******************************************************************************
+* File Name:   warm_boot_host.c
+*
+* Description: This file checks the serialization of the warm-boot block of
+*              source/warm_boot.c on a Linux machine: the byte layout, the
+*              round trip of every field, and the handling of a corrupt
+*              block, another major version and a newer minor version with
+*              more fields:
+*
+*                gcc -O2 -Isource -o warm_boot tools/warm_boot_host.c \
+*                    source/warm_boot.c
+*                ./warm_boot
+*
+*              The exit status is 1 when a check fails.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "warm_boot.h"
+
+/* Standard C header files. */
+#include <stdio.h>
+#include <string.h>
+
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define BLOCK_LEN                       (98u)   /* Header 8, payload 86, CRC 4 */
+#define HEADER_LEN                      (8u)
+#define PAYLOAD_LEN                     (86u)
+#define EXTRA_LEN                       (6u)    /* Fields of a future minor version */
+
+/* CRC-32 of the version 1.0 block of make_state(); pins the whole layout */
+#define EXPECTED_BLOCK_CRC              (0x4CA4F003UL)
+
+#define CHECK(cond, name)               check((cond), (name))
+
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static uint32_t failures;
+
+
+/*******************************************************************************
+* Function Name: check
+********************************************************************************
+* Summary:
+* Prints the result of a check.
+*
+*******************************************************************************/
+static void check(bool ok, const char *name)
+{
+    printf("%s %s\n", ok ? "PASS" : "FAIL", name);
+    failures += ok ? 0u : 1u;
+}
+
+
+/*******************************************************************************
+* Function Name: make_state
+********************************************************************************
+* Summary:
+* Fills a state with a distinct value in every field.
+*
+*******************************************************************************/
+static void make_state(warm_boot_state_t *state)
+{
+    static const uint8_t bssid[CY_WCM_MAC_ADDR_LEN] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+
+    memset(state, 0, sizeof(*state));
+    state->stats.boot_count        = 7u;
+    state->stats.warm_boot_count   = 5u;
+    state->stats.last_reset_reason = 0x00000010u;
+    state->stats.heap_used         = 40960u;
+    state->stats.heap_peak_used    = 51200u;
+
+    state->conn.valid    = true;
+    strcpy(state->conn.ssid, "WIFI_SSID");
+    memcpy(state->conn.bssid, bssid, sizeof(bssid));
+    state->conn.band     = CY_WCM_WIFI_BAND_5GHZ;
+    state->conn.channel  = 36u;
+    state->conn.security = 0x00400004u;
+    state->conn.ip       = 0x6401a8c0u;
+    state->conn.netmask  = 0x00ffffffu;
+    state->conn.gateway  = 0x0101a8c0u;
+
+    state->twt.active      = true;
+    state->twt.profile     = CY_WCM_ITWT_PROFILE_IDLE;
+    state->twt.flow_id     = 1u;
+    state->twt.wi_mantissa = 75u;
+    state->twt.wi_exponent = 13u;
+    state->twt.wd          = 32u;
+}
+
+
+/*******************************************************************************
+* Function Name: same_state
+********************************************************************************
+* Summary:
+* Compares the serialized fields of two states.
+*
+*******************************************************************************/
+static bool same_state(const warm_boot_state_t *a, const warm_boot_state_t *b)
+{
+    return !memcmp(&a->stats, &b->stats, sizeof(a->stats)) &&
+           (a->conn.valid == b->conn.valid) && !strcmp(a->conn.ssid, b->conn.ssid) &&
+           !memcmp(a->conn.bssid, b->conn.bssid, CY_WCM_MAC_ADDR_LEN) && (a->conn.band == b->conn.band) &&
+           (a->conn.channel == b->conn.channel) && (a->conn.security == b->conn.security) &&
+           (a->conn.ip == b->conn.ip) && (a->conn.netmask == b->conn.netmask) &&
+           (a->conn.gateway == b->conn.gateway) &&
+           (a->twt.active == b->twt.active) && (a->twt.profile == b->twt.profile) &&
+           (a->twt.flow_id == b->twt.flow_id) && (a->twt.wi_mantissa == b->twt.wi_mantissa) &&
+           (a->twt.wi_exponent == b->twt.wi_exponent) && (a->twt.wd == b->twt.wd);
+}
+
+
+/*******************************************************************************
+* Function Name: put_le / get_le / reseal
+********************************************************************************
+* Summary:
+* Little-endian field access and recomputation of the CRC of a block edited
+* by a check.
+*
+*******************************************************************************/
+static void put_le(uint8_t *p, uint32_t value, uint32_t bytes)
+{
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        p[i] = (uint8_t)(value >> (8u * i));
+    }
+}
+
+static uint32_t get_le(const uint8_t *p, uint32_t bytes)
+{
+    uint32_t value = 0;
+
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        value |= (uint32_t)p[i] << (8u * i);
+    }
+    return value;
+}
+
+static void reseal(uint8_t *block)
+{
+    uint32_t payload_len = get_le(&block[6], 2u);
+
+    put_le(&block[HEADER_LEN + payload_len], warm_boot_crc32(block, HEADER_LEN + payload_len), 4u);
+}
+
+
+/*******************************************************************************
+* Function Name: main
+********************************************************************************
+* Summary:
+* Runs the checks.
+*
+*******************************************************************************/
+int main(void)
+{
+    uint8_t block[BLOCK_LEN + EXTRA_LEN];
+    uint8_t edited[BLOCK_LEN + EXTRA_LEN];
+    warm_boot_state_t state;
+    warm_boot_state_t parsed;
+    size_t length;
+
+    CHECK(warm_boot_crc32((const uint8_t *)"123456789", 9u) == 0xCBF43926UL, "CRC-32 check value");
+
+    /* Layout */
+    make_state(&state);
+    memset(block, 0xA5, sizeof(block));
+    length = warm_boot_serialize(&state, block, sizeof(block));
+    CHECK(length == BLOCK_LEN, "block length");
+    CHECK(!memcmp(block, "WBST", 4u), "magic");
+    CHECK((block[4] == WARM_BOOT_VERSION_MAJOR) && (block[5] == WARM_BOOT_VERSION_MINOR), "version");
+    CHECK(get_le(&block[6], 2u) == PAYLOAD_LEN, "payload length");
+    CHECK(get_le(&block[HEADER_LEN], 4u) == 7u, "first field little-endian");
+    CHECK(get_le(&block[HEADER_LEN + PAYLOAD_LEN], 4u) == EXPECTED_BLOCK_CRC, "layout of version 1.0");
+    CHECK(warm_boot_serialize(&state, block, BLOCK_LEN - 1u) == 0u, "short buffer refused");
+
+    /* Round trip */
+    length = warm_boot_serialize(&state, block, sizeof(block));
+    memset(&parsed, 0, sizeof(parsed));
+    CHECK((warm_boot_deserialize(block, length, &parsed) == WARM_BOOT_STATUS_OK) && same_state(&state, &parsed),
+          "round trip");
+
+    /* Corruption */
+    memcpy(edited, block, BLOCK_LEN);
+    edited[HEADER_LEN + 10u] ^= 0x01u;
+    CHECK(warm_boot_deserialize(edited, BLOCK_LEN, &parsed) == WARM_BOOT_STATUS_BAD_CRC, "flipped bit");
+
+    memcpy(edited, block, BLOCK_LEN);
+    edited[0] = 0u;
+    CHECK(warm_boot_deserialize(edited, BLOCK_LEN, &parsed) == WARM_BOOT_STATUS_BAD_MAGIC, "bad magic");
+
+    memset(edited, 0, sizeof(edited));
+    CHECK(warm_boot_deserialize(edited, BLOCK_LEN, &parsed) == WARM_BOOT_STATUS_BAD_MAGIC, "zeroed block");
+
+    CHECK(warm_boot_deserialize(block, HEADER_LEN, &parsed) == WARM_BOOT_STATUS_BAD_LENGTH, "truncated header");
+    CHECK(warm_boot_deserialize(block, BLOCK_LEN - 1u, &parsed) == WARM_BOOT_STATUS_BAD_LENGTH,
+          "truncated block");
+
+    /* Versions */
+    memcpy(edited, block, BLOCK_LEN);
+    edited[4] = WARM_BOOT_VERSION_MAJOR + 1u;
+    reseal(edited);
+    CHECK(warm_boot_deserialize(edited, BLOCK_LEN, &parsed) == WARM_BOOT_STATUS_BAD_VERSION, "newer major");
+
+    memcpy(edited, block, BLOCK_LEN);
+    edited[5] = WARM_BOOT_VERSION_MINOR + 1u;
+    put_le(&edited[6], PAYLOAD_LEN + EXTRA_LEN, 2u);
+    memset(&edited[HEADER_LEN + PAYLOAD_LEN], 0x5A, EXTRA_LEN);
+    reseal(edited);
+    memset(&parsed, 0, sizeof(parsed));
+    CHECK((warm_boot_deserialize(edited, sizeof(edited), &parsed) == WARM_BOOT_STATUS_OK) &&
+          same_state(&state, &parsed), "newer minor with more fields");
+
+    memcpy(edited, block, BLOCK_LEN);
+    put_le(&edited[6], PAYLOAD_LEN - 8u, 2u);
+    reseal(edited);
+    CHECK(warm_boot_deserialize(edited, BLOCK_LEN, &parsed) == WARM_BOOT_STATUS_BAD_LENGTH,
+          "older layout with fewer fields");
+
+    /* Field bounds */
+    memcpy(edited, block, BLOCK_LEN);
+    edited[HEADER_LEN + 20u + 3u] = 200u;   /* SSID length */
+    reseal(edited);
+    CHECK((warm_boot_deserialize(edited, BLOCK_LEN, &parsed) == WARM_BOOT_STATUS_OK) &&
+          (strlen(parsed.conn.ssid) <= CY_WCM_MAX_SSID_LEN), "SSID length bounded");
+
+    make_state(&state);
+    memset(state.conn.ssid, 'x', CY_WCM_MAX_SSID_LEN);
+    state.conn.ssid[CY_WCM_MAX_SSID_LEN] = '\0';
+    length = warm_boot_serialize(&state, block, sizeof(block));
+    CHECK((warm_boot_deserialize(block, length, &parsed) == WARM_BOOT_STATUS_OK) && same_state(&state, &parsed),
+          "32-character SSID");
+
+    printf("%s\n", (failures == 0u) ? "All checks passed" : "Some checks failed");
+    return (failures == 0u) ? 0 : 1;
+}
+
+
+/* [] END OF FILE */